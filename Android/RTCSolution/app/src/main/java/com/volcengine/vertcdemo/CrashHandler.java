@@ -14,6 +14,7 @@ import android.widget.Toast;
 import androidx.annotation.NonNull;
 import androidx.annotation.Nullable;
 
+import com.volcengine.vertcdemo.common.MainThreadWatchdog;
 import com.volcengine.vertcdemo.common.SolutionToast;
 
 import java.util.HashSet;
@@ -73,6 +74,11 @@ public class CrashHandler implements Thread.UncaughtExceptionHandler {
      */
     @Override
     public void uncaughtException(@NonNull Thread thread, @NonNull Throwable ex) {
+        // 崩溃前的主线程卡顿一并写入日志
+        final MainThreadWatchdog watchdog = MainThreadWatchdog.installed();
+        if (watchdog != null) {
+            watchdog.persistReport();
+        }
         //如果自己没有处理，则让系统默认的异常处理器来处理
         if (!handleException(ex) && mDefaultHandler != null) {
             mDefaultHandler.uncaughtException(thread, ex);
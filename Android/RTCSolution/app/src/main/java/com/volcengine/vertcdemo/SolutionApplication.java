@@ -6,6 +6,7 @@ package com.volcengine.vertcdemo;
 import android.app.Application;
 import android.text.TextUtils;
 
+import com.volcengine.vertcdemo.common.MainThreadWatchdog;
 import com.volcengine.vertcdemo.core.SolutionDataManager;
 import com.volcengine.vertcdemo.core.net.http.AppNetworkStatusUtil;
 import com.volcengine.vertcdemo.utils.ActivityDataManager;
@@ -19,6 +20,10 @@ public class SolutionApplication extends Application {
         AppUtil.initApp(this);
         ActivityDataManager.getInstance().init(this);
         new CrashHandler(this);
+        if (BuildConfig.DEBUG) {
+            // 调试包监测主线程卡顿，结果写入日志
+            MainThreadWatchdog.install(MainThreadWatchdog.DEFAULT_THRESHOLD_MS);
+        }
         AppNetworkStatusUtil.registerNetworkCallback(this);
     }
 }
@@ -18,6 +18,17 @@ public class AppExecutors {
     private final ExecutorService mNetworkIO = Executors.newFixedThreadPool(Runtime.getRuntime().availableProcessors());
     private final Handler mMainHandler = new Handler(Looper.getMainLooper());
     private final Executor mMainThread = mMainHandler::post;
+    private final Scheduler mMainScheduler = new Scheduler() {
+        @Override
+        public void schedule(@NonNull Runnable task, long delayMs) {
+            mMainHandler.postDelayed(task, delayMs);
+        }
+
+        @Override
+        public void cancel(@NonNull Runnable task) {
+            mMainHandler.removeCallbacks(task);
+        }
+    };
 
     private AppExecutors() {
     }
@@ -34,6 +45,13 @@ public class AppExecutors {
         return sInstance.mMainHandler;
     }
 
+    /**
+     * Delayed tasks on {@link #mainHandler()}.
+     */
+    public static Scheduler mainScheduler() {
+        return sInstance.mMainScheduler;
+    }
+
     public static void execRunnableInMainThread(@NonNull Runnable runnable) {
         if (Looper.getMainLooper() == Looper.myLooper()) {
             runnable.run();
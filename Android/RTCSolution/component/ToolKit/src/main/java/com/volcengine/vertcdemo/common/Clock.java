@@ -0,0 +1,11 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.common;
+
+/**
+ * Time source in ms, e.g. SystemClock::uptimeMillis, or a virtual clock in tests.
+ */
+public interface Clock {
+    long now();
+}
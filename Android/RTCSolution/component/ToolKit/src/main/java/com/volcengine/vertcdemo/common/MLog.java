@@ -25,6 +25,11 @@ public class MLog {
         persistenceLog(tag + ":" + msg);
     }
 
+    public static void w(String tag, String msg) {
+        Log.w(tag, msg);
+        persistenceLog(tag + ":" + msg);
+    }
+
     public static void e(String tag, String msg) {
         Log.e(tag, msg);
         persistenceLog(tag + ":" + msg);
@@ -0,0 +1,433 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.common;
+
+import android.os.Looper;
+import android.os.SystemClock;
+import android.util.Printer;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+import java.util.regex.Pattern;
+
+/**
+ * Finds main thread stalls: every message the main looper dispatches is timed, a sampler thread
+ * takes the stack of the main thread while a message runs past the threshold.
+ *
+ * Stalls are added up by what caused them: the operation entered with {@link #enter(String)},
+ * e.g. the vi* event of an RTS answer being decoded, else the first frame of the app in the
+ * stack, else the handler that dispatched the message. Every stall is written as one line to the
+ * reporter, {@link #persistReport()} writes the summary.
+ *
+ * The main looper has one message Printer. {@link #install(long, Printer)} takes over the one
+ * the app set before and forwards to it; a Printer set after install replaces the watchdog.
+ */
+public class MainThreadWatchdog {
+
+    private static final String TAG = "MainThreadWatchdog";
+    public static final long DEFAULT_THRESHOLD_MS = 200;
+    /*** Messages longer than a frame count as jank */
+    static final long FRAME_BUDGET_MS = 16;
+    static final int MAX_SAMPLES = 5;
+    static final int MAX_KINDS = 64;
+    static final String OTHER_KIND = "other";
+    private static final int REPORT_FRAMES = 4;
+    private static final String APP_PACKAGE = "com.volcengine.";
+    private static final Pattern HASH = Pattern.compile("\\{[0-9a-f]+\\}|@[0-9a-f]+|: -?\\d+$");
+    private static final Pattern SPACES = Pattern.compile("\\s+");
+
+    public interface Reporter {
+        void report(@NonNull String line);
+    }
+
+    /**
+     * Stalls of one kind
+     */
+    public static final class Stall {
+        @NonNull
+        public final String kind;
+        public int count;
+        public long totalMs;
+        public long maxMs;
+        /*** Stack sampled in the longest stall, innermost frame first */
+        @NonNull
+        public StackTraceElement[] stack = new StackTraceElement[0];
+
+        Stall(@NonNull String kind) {
+            this.kind = kind;
+        }
+    }
+
+    @Nullable
+    private static volatile MainThreadWatchdog sInstalled;
+
+    private final Clock mClock;
+    private final Thread mWatched;
+    private final long mThresholdMs;
+    private final long mSampleIntervalMs;
+    private final Reporter mReporter;
+
+    // Written on the watched thread, read by the sampler.
+    private volatile long mDispatchSeq;
+    private volatile long mDispatchStartMs = -1;
+    private volatile String mLabel;
+    // Watched thread only.
+    @Nullable
+    private String mDispatchTarget;
+    @Nullable
+    private String mDispatchLabel;
+    private long mDispatchCount;
+    private long mJankCount;
+
+    // Guarded by itself, samples of the message running at mSampledSeq.
+    private final List<StackTraceElement[]> mSamples = new ArrayList<>();
+    private final List<String> mSampleLabels = new ArrayList<>();
+    private long mSampledSeq = -1;
+
+    // Guarded by itself.
+    private final Map<String, Stall> mStalls = new LinkedHashMap<>();
+
+    @Nullable
+    private Thread mSampler;
+    private volatile boolean mRunning;
+
+    public MainThreadWatchdog(@NonNull Clock clock, @NonNull Thread watched,
+                              long thresholdMs, @NonNull Reporter reporter) {
+        mClock = clock;
+        mWatched = watched;
+        mThresholdMs = Math.max(1, thresholdMs);
+        mSampleIntervalMs = Math.max(1, mThresholdMs / 2);
+        mReporter = reporter;
+    }
+
+    /**
+     * Watch the main looper, reporting to logcat and the persisted log through MLog. Call once,
+     * e.g. in Application.onCreate.
+     */
+    @NonNull
+    public static MainThreadWatchdog install(long thresholdMs) {
+        return install(thresholdMs, null);
+    }
+
+    /**
+     * @param previous Printer the app set on the main looper, Looper has no getter for it; every
+     *                 line is forwarded to it
+     */
+    @NonNull
+    public static synchronized MainThreadWatchdog install(long thresholdMs, @Nullable Printer previous) {
+        MainThreadWatchdog watchdog = sInstalled;
+        if (watchdog != null) {
+            return watchdog;
+        }
+        Looper looper = Looper.getMainLooper();
+        watchdog = new MainThreadWatchdog(SystemClock::uptimeMillis, looper.getThread(), thresholdMs,
+                line -> MLog.w(TAG, line));
+        MainThreadWatchdog installed = watchdog;
+        looper.setMessageLogging(previous == null ? installed::onLooperLog : log -> {
+            installed.onLooperLog(log);
+            previous.println(log);
+        });
+        watchdog.start();
+        sInstalled = watchdog;
+        return watchdog;
+    }
+
+    @Nullable
+    public static MainThreadWatchdog installed() {
+        return sInstalled;
+    }
+
+    /**
+     * Name the operation the watched thread runs from now on, stalls in it are counted under the
+     * name. No-op on other threads or when no watchdog is installed.
+     *
+     * @return the name to give back to {@link #exit(String)}
+     */
+    @Nullable
+    public static String enter(@NonNull String operation) {
+        MainThreadWatchdog watchdog = sInstalled;
+        if (watchdog == null || Thread.currentThread() != watchdog.mWatched) {
+            return null;
+        }
+        return watchdog.label(operation);
+    }
+
+    public static void exit(@Nullable String previous) {
+        MainThreadWatchdog watchdog = sInstalled;
+        if (watchdog != null && Thread.currentThread() == watchdog.mWatched) {
+            watchdog.label(previous);
+        }
+    }
+
+    public void start() {
+        if (mRunning) {
+            return;
+        }
+        mRunning = true;
+        mSampler = new Thread(this::sampleLoop, TAG);
+        mSampler.setDaemon(true);
+        mSampler.start();
+    }
+
+    public void stop() {
+        mRunning = false;
+        if (mSampler != null) {
+            mSampler.interrupt();
+            mSampler = null;
+        }
+    }
+
+    /**
+     * Main looper Printer: called before and after every message.
+     */
+    void onLooperLog(@NonNull String log) {
+        if (log.startsWith(">>>>> Dispatching to ")) {
+            onDispatchStart(log);
+        } else if (log.startsWith("<<<<< Finished to ")) {
+            onDispatchEnd();
+        }
+    }
+
+    /**
+     * @param target what dispatches the message, e.g. the handler and callback
+     */
+    void onDispatchStart(@Nullable String target) {
+        mDispatchTarget = target;
+        mDispatchLabel = null;
+        mDispatchSeq++;
+        mDispatchStartMs = mClock.now();
+    }
+
+    void onDispatchEnd() {
+        long start = mDispatchStartMs;
+        if (start < 0) {
+            return;
+        }
+        long duration = mClock.now() - start;
+        mDispatchStartMs = -1;
+        mLabel = null;
+        mDispatchCount++;
+        if (duration > FRAME_BUDGET_MS) {
+            mJankCount++;
+        }
+        StackTraceElement[] stack = null;
+        String sampleLabel = null;
+        synchronized (mSamples) {
+            if (mSampledSeq == mDispatchSeq && !mSamples.isEmpty()) {
+                int last = mSamples.size() - 1;
+                stack = mSamples.get(last);
+                for (int i = last; i >= 0 && sampleLabel == null; i--) {
+                    sampleLabel = mSampleLabels.get(i);
+                }
+            }
+            mSamples.clear();
+            mSampleLabels.clear();
+            mSampledSeq = -1;
+        }
+        if (duration < mThresholdMs) {
+            return;
+        }
+        if (stack == null) {
+            stack = new StackTraceElement[0];
+        }
+        String kind = sampleLabel != null ? sampleLabel : mDispatchLabel;
+        if (kind == null) {
+            StackTraceElement frame = appFrame(stack);
+            kind = frame != null ? compact(frame) : normalizeTarget(mDispatchTarget);
+        }
+        record(kind, duration, stack);
+    }
+
+    /**
+     * Call on the watched thread.
+     */
+    @Nullable
+    String label(@Nullable String operation) {
+        String previous = mLabel;
+        mLabel = operation;
+        if (mDispatchLabel == null && mDispatchStartMs >= 0) {
+            mDispatchLabel = operation;
+        }
+        return previous;
+    }
+
+    private void record(@NonNull String kind, long duration, @NonNull StackTraceElement[] stack) {
+        synchronized (mStalls) {
+            Stall stall = mStalls.get(kind);
+            if (stall == null) {
+                if (mStalls.size() >= MAX_KINDS) {
+                    kind = OTHER_KIND;
+                    stall = mStalls.get(kind);
+                }
+                if (stall == null) {
+                    stall = new Stall(kind);
+                    mStalls.put(kind, stall);
+                }
+            }
+            stall.count++;
+            stall.totalMs += duration;
+            if (duration >= stall.maxMs) {
+                stall.maxMs = duration;
+                if (stack.length > 0 || stall.stack.length == 0) {
+                    stall.stack = stack;
+                }
+            }
+        }
+        mReporter.report("stall " + duration + "ms " + kind + frames(stack));
+    }
+
+    private void sampleLoop() {
+        while (mRunning) {
+            long waitMs = sampleOnce();
+            try {
+                Thread.sleep(waitMs);
+            } catch (InterruptedException e) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Sample the watched thread if its message runs past the threshold.
+     *
+     * @return how long to wait before the next look
+     */
+    long sampleOnce() {
+        long seq = mDispatchSeq;
+        long start = mDispatchStartMs;
+        if (start < 0) {
+            return mThresholdMs;
+        }
+        long age = mClock.now() - start;
+        if (age < mThresholdMs) {
+            return mThresholdMs - age;
+        }
+        String label = mLabel;
+        StackTraceElement[] stack = mWatched.getStackTrace();
+        synchronized (mSamples) {
+            // The message may have finished while the stack was taken.
+            if (seq != mDispatchSeq || start != mDispatchStartMs) {
+                return mSampleIntervalMs;
+            }
+            if (mSampledSeq != seq) {
+                mSamples.clear();
+                mSampleLabels.clear();
+                mSampledSeq = seq;
+            }
+            if (mSamples.size() < MAX_SAMPLES) {
+                mSamples.add(stack);
+                mSampleLabels.add(label);
+            }
+        }
+        return mSampleIntervalMs;
+    }
+
+    /**
+     * @return stalls by kind, the longest in total first
+     */
+    @NonNull
+    public List<Stall> getStalls() {
+        List<Stall> stalls;
+        synchronized (mStalls) {
+            stalls = new ArrayList<>(mStalls.values());
+        }
+        Collections.sort(stalls, (a, b) -> Long.compare(b.totalMs, a.totalMs));
+        return stalls;
+    }
+
+    /*** Messages dispatched since start */
+    public long getDispatchCount() {
+        return mDispatchCount;
+    }
+
+    /*** Messages longer than a frame */
+    public long getJankCount() {
+        return mJankCount;
+    }
+
+    /**
+     * One line per kind of stall, for the persisted log or a debug view.
+     */
+    @NonNull
+    public String getReport() {
+        StringBuilder report = new StringBuilder();
+        List<Stall> stalls = getStalls();
+        report.append(String.format(Locale.US, "main thread: %d messages, %d over %dms, stalls over %dms:",
+                mDispatchCount, mJankCount, FRAME_BUDGET_MS, mThresholdMs));
+        if (stalls.isEmpty()) {
+            report.append(" none");
+        }
+        for (Stall stall : stalls) {
+            report.append(String.format(Locale.US, "\n%s x%d total %dms max %dms", stall.kind, stall.count,
+                    stall.totalMs, stall.maxMs));
+            report.append(frames(stall.stack));
+        }
+        return report.toString();
+    }
+
+    public void persistReport() {
+        mReporter.report(getReport());
+    }
+
+    @Nullable
+    private static StackTraceElement appFrame(@NonNull StackTraceElement[] stack) {
+        for (StackTraceElement frame : stack) {
+            String className = frame.getClassName();
+            if (className.startsWith(APP_PACKAGE) && !className.equals(MainThreadWatchdog.class.getName())) {
+                return frame;
+            }
+        }
+        return null;
+    }
+
+    @NonNull
+    private static String compact(@NonNull StackTraceElement frame) {
+        String className = frame.getClassName();
+        return className.substring(className.lastIndexOf('.') + 1) + "." + frame.getMethodName()
+                + ":" + frame.getLineNumber();
+    }
+
+    @NonNull
+    private static String frames(@NonNull StackTraceElement[] stack) {
+        if (stack.length == 0) {
+            return "";
+        }
+        StringBuilder builder = new StringBuilder(" at ");
+        int count = Math.min(REPORT_FRAMES, stack.length);
+        for (int i = 0; i < count; i++) {
+            builder.append(i == 0 ? "" : " < ").append(compact(stack[i]));
+        }
+        StackTraceElement frame = appFrame(stack);
+        if (frame != null && indexOf(stack, frame) >= count) {
+            builder.append(" < ... < ").append(compact(frame));
+        }
+        return builder.toString();
+    }
+
+    private static int indexOf(StackTraceElement[] stack, StackTraceElement frame) {
+        for (int i = 0; i < stack.length; i++) {
+            if (stack[i] == frame) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    @NonNull
+    static String normalizeTarget(@Nullable String target) {
+        if (target == null) {
+            return "unknown";
+        }
+        String normalized = target.startsWith(">>>>> Dispatching to ")
+                ? target.substring(">>>>> Dispatching to ".length()) : target;
+        return SPACES.matcher(HASH.matcher(normalized).replaceAll("")).replaceAll(" ").trim();
+    }
+}
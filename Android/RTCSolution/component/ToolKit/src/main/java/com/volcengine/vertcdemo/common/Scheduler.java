@@ -0,0 +1,15 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.common;
+
+import androidx.annotation.NonNull;
+
+/**
+ * Runs delayed tasks, see {@link AppExecutors#mainScheduler()}; tests pass a virtual one.
+ */
+public interface Scheduler {
+    void schedule(@NonNull Runnable task, long delayMs);
+
+    void cancel(@NonNull Runnable task);
+}
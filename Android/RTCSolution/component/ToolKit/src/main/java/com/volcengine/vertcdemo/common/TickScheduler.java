@@ -0,0 +1,316 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.common;
+
+import android.os.SystemClock;
+import android.view.Choreographer;
+import android.view.View;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * One wakeup source for the periodic and one-shot work of the UI, instead of a postDelayed
+ * runnable per component.
+ *
+ * Only the earliest deadline is armed. Every task may run up to its tolerance late, so the wakeup
+ * is put off to the earliest deadline plus tolerance and every task due by then runs in it; two
+ * timers a few ms apart cost one wakeup. On the main thread the wakeup is a Choreographer frame
+ * callback, work lands on a frame instead of in the middle of one.
+ *
+ * Paused tasks, e.g. of a view that is not attached, cost no wakeups.
+ *
+ * Frames stop while the display is off, and so does {@link #main()}. It is meant for work that
+ * only matters while the UI is shown; deadlines that must fire regardless, e.g. a dialog or
+ * request timeout, go on {@link AppExecutors#mainHandler()}.
+ *
+ * Call on the main thread.
+ */
+public class TickScheduler {
+
+    /*** Part of the interval a periodic task may run late by default */
+    public static final int DEFAULT_TOLERANCE_PERCENT = 10;
+    static final long RATE_WINDOW_MS = 5_000;
+
+    public final class Task {
+        private final Runnable mAction;
+        // 0 for one-shot tasks.
+        private final long mIntervalMs;
+        private long mToleranceMs;
+        private long mDueMs;
+        private boolean mPaused;
+        private boolean mCancelled;
+        @Nullable
+        private View mAttachView;
+        @Nullable
+        private View.OnAttachStateChangeListener mAttachListener;
+
+        private Task(@NonNull Runnable action, long intervalMs, long dueMs, long toleranceMs) {
+            mAction = action;
+            mIntervalMs = intervalMs;
+            mDueMs = dueMs;
+            mToleranceMs = toleranceMs;
+        }
+
+        /**
+         * @param toleranceMs how late the task may run so it shares a wakeup with others
+         */
+        public Task setTolerance(long toleranceMs) {
+            mToleranceMs = Math.max(0, toleranceMs);
+            arm();
+            return this;
+        }
+
+        /**
+         * A paused task keeps its place, if it came due while paused it runs right after resuming.
+         */
+        public void setPaused(boolean paused) {
+            if (mPaused == paused || mCancelled) {
+                return;
+            }
+            mPaused = paused;
+            arm();
+        }
+
+        /**
+         * Pause the task while the view is not attached to a window. The attach listener is
+         * removed once the task is cancelled or, for a one-shot task, run; cancelling it once the
+         * view is gone for good is up to the owner.
+         */
+        public Task pauseWhileDetached(@NonNull View view) {
+            if (mCancelled) {
+                return this;
+            }
+            releaseView();
+            mAttachListener = new View.OnAttachStateChangeListener() {
+                @Override
+                public void onViewAttachedToWindow(View v) {
+                    setPaused(false);
+                }
+
+                @Override
+                public void onViewDetachedFromWindow(View v) {
+                    setPaused(true);
+                }
+            };
+            mAttachView = view;
+            view.addOnAttachStateChangeListener(mAttachListener);
+            setPaused(!view.isAttachedToWindow());
+            return this;
+        }
+
+        public void cancel() {
+            if (mCancelled) {
+                return;
+            }
+            mCancelled = true;
+            releaseView();
+            if (!mInWakeup) {
+                mTasks.remove(this);
+                arm();
+            }
+        }
+
+        public boolean isPaused() {
+            return mPaused;
+        }
+
+        /**
+         * @return false once cancelled or, for a one-shot task, run
+         */
+        public boolean isActive() {
+            return !mCancelled;
+        }
+
+        private void releaseView() {
+            if (mAttachView != null) {
+                mAttachView.removeOnAttachStateChangeListener(mAttachListener);
+                mAttachView = null;
+                mAttachListener = null;
+            }
+        }
+    }
+
+    @Nullable
+    private static TickScheduler sMain;
+
+    private final Clock mClock;
+    private final Scheduler mWaker;
+    private final List<Task> mTasks = new ArrayList<>();
+    private final Runnable mWakeupTask = this::onWakeup;
+    // Time the wakeup is armed for, -1 if none.
+    private long mArmedAtMs = -1;
+    private boolean mInWakeup;
+
+    private long mWakeupCount;
+    private long mRunCount;
+    private long mWindowStartMs = -1;
+    private long mWindowWakeups;
+    private float mWakeupsPerSecond;
+
+    public TickScheduler(@NonNull Clock clock, @NonNull Scheduler waker) {
+        mClock = clock;
+        mWaker = waker;
+    }
+
+    /**
+     * The scheduler of the main thread, woken by Choreographer frames, which stop while the
+     * display is off. Call on the main thread.
+     */
+    @NonNull
+    public static TickScheduler main() {
+        if (sMain == null) {
+            sMain = new TickScheduler(SystemClock::uptimeMillis, new FrameWaker());
+        }
+        return sMain;
+    }
+
+    /**
+     * Run the action every interval, the first time one interval from now.
+     */
+    @NonNull
+    public Task schedulePeriodic(long intervalMs, @NonNull Runnable action) {
+        long interval = Math.max(1, intervalMs);
+        return add(new Task(action, interval, mClock.now() + interval, interval * DEFAULT_TOLERANCE_PERCENT / 100));
+    }
+
+    /**
+     * Run the action once after the delay, not earlier and no later than the tolerance, 0 by default.
+     */
+    @NonNull
+    public Task scheduleOnce(long delayMs, @NonNull Runnable action) {
+        return add(new Task(action, 0, mClock.now() + Math.max(0, delayMs), 0));
+    }
+
+    /*** Wakeups since the scheduler was created */
+    public long getWakeupCount() {
+        return mWakeupCount;
+    }
+
+    /*** Task runs since the scheduler was created, more than the wakeups when tasks share them */
+    public long getRunCount() {
+        return mRunCount;
+    }
+
+    /**
+     * @return wakeups a second over the last {@link #RATE_WINDOW_MS}
+     */
+    public float getWakeupsPerSecond() {
+        long now = mClock.now();
+        if (mWindowStartMs >= 0 && now - mWindowStartMs >= RATE_WINDOW_MS) {
+            rollWindow(now);
+        }
+        return mWakeupsPerSecond;
+    }
+
+    /*** Tasks not cancelled, paused ones included */
+    public int getTaskCount() {
+        return mTasks.size();
+    }
+
+    private Task add(Task task) {
+        mTasks.add(task);
+        arm();
+        return task;
+    }
+
+    private void onWakeup() {
+        mArmedAtMs = -1;
+        long now = mClock.now();
+        mWakeupCount++;
+        if (mWindowStartMs < 0) {
+            mWindowStartMs = now;
+        } else if (now - mWindowStartMs >= RATE_WINDOW_MS) {
+            rollWindow(now);
+        }
+        mWindowWakeups++;
+
+        mInWakeup = true;
+        // Tasks added by a running task wait for the next wakeup.
+        int count = mTasks.size();
+        for (int i = 0; i < count; i++) {
+            Task task = mTasks.get(i);
+            if (task.mCancelled || task.mPaused || task.mDueMs > now) {
+                continue;
+            }
+            if (task.mIntervalMs > 0) {
+                // Missed ticks are skipped, not run in a burst.
+                long missed = (now - task.mDueMs) / task.mIntervalMs;
+                task.mDueMs += (missed + 1) * task.mIntervalMs;
+            } else {
+                task.mCancelled = true;
+                task.releaseView();
+            }
+            mRunCount++;
+            task.mAction.run();
+        }
+        mInWakeup = false;
+        for (int i = mTasks.size() - 1; i >= 0; i--) {
+            if (mTasks.get(i).mCancelled) {
+                mTasks.remove(i);
+            }
+        }
+        arm();
+    }
+
+    private void rollWindow(long now) {
+        long elapsed = now - mWindowStartMs;
+        mWakeupsPerSecond = mWindowWakeups * 1000f / elapsed;
+        mWindowStartMs = now;
+        mWindowWakeups = 0;
+    }
+
+    private void arm() {
+        if (mInWakeup) {
+            return;
+        }
+        long wakeAt = Long.MAX_VALUE;
+        for (int i = 0; i < mTasks.size(); i++) {
+            Task task = mTasks.get(i);
+            if (!task.mCancelled && !task.mPaused) {
+                wakeAt = Math.min(wakeAt, task.mDueMs + task.mToleranceMs);
+            }
+        }
+        if (wakeAt == mArmedAtMs) {
+            return;
+        }
+        mWaker.cancel(mWakeupTask);
+        if (wakeAt == Long.MAX_VALUE) {
+            mArmedAtMs = -1;
+            return;
+        }
+        mArmedAtMs = wakeAt;
+        mWaker.schedule(mWakeupTask, Math.max(0, wakeAt - mClock.now()));
+    }
+
+    /**
+     * Wakes on the first frame after the delay.
+     */
+    private static final class FrameWaker implements Scheduler {
+        private final Map<Runnable, Choreographer.FrameCallback> mCallbacks = new HashMap<>();
+
+        @Override
+        public void schedule(@NonNull Runnable task, long delayMs) {
+            Choreographer.FrameCallback callback = frameTimeNanos -> {
+                mCallbacks.remove(task);
+                task.run();
+            };
+            mCallbacks.put(task, callback);
+            Choreographer.getInstance().postFrameCallbackDelayed(callback, delayMs);
+        }
+
+        @Override
+        public void cancel(@NonNull Runnable task) {
+            Choreographer.FrameCallback callback = mCallbacks.remove(task);
+            if (callback != null) {
+                Choreographer.getInstance().removeFrameCallback(callback);
+            }
+        }
+    }
+}
@@ -19,16 +19,41 @@ public class AppNetworkStatusEvent {
     @Retention(RetentionPolicy.SOURCE)
     public @interface AppNetworkStatus {}
 
+    public static final int NETWORK_TYPE_NONE = 0;
+    public static final int NETWORK_TYPE_WIFI = 1;
+    public static final int NETWORK_TYPE_CELLULAR = 2;
+    public static final int NETWORK_TYPE_OTHER = 3;
+
+    @IntDef({NETWORK_TYPE_NONE, NETWORK_TYPE_WIFI, NETWORK_TYPE_CELLULAR, NETWORK_TYPE_OTHER})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface NetworkType {}
+
     public final @AppNetworkStatus int status;
+    /**
+     * Transport of the network now in use
+     */
+    public final @NetworkType int networkType;
+    /**
+     * The default network changed (e.g. Wi-Fi to cellular), connections opened on the old one may be dead
+     */
+    public final boolean switched;
 
     public AppNetworkStatusEvent(int status) {
+        this(status, NETWORK_TYPE_NONE, false);
+    }
+
+    public AppNetworkStatusEvent(int status, int networkType, boolean switched) {
         this.status = status;
+        this.networkType = networkType;
+        this.switched = switched;
     }
 
     @Override
     public String toString() {
         return "AppNetworkStatusEvent{" +
                 "status=" + status +
+                ", networkType=" + networkType +
+                ", switched=" + switched +
                 '}';
     }
 }
@@ -15,7 +15,11 @@ import android.util.Log;
 import androidx.annotation.NonNull;
 import androidx.annotation.Nullable;
 
+import com.volcengine.vertcdemo.common.AppExecutors;
 import com.volcengine.vertcdemo.core.eventbus.SolutionDemoEventManager;
+
+import java.util.concurrent.CopyOnWriteArrayList;
+
 /**
  * Application network status judgment
  *
@@ -30,6 +34,18 @@ public class AppNetworkStatusUtil {
     private static Context sContext;
     private static final String TAG = "AppNetworkStatus";
 
+    /**
+     * Called on the main thread, unlike AppNetworkStatusEvent it is delivered without an EventBus hop
+     * so the network layers can react as early as possible.
+     */
+    public interface NetworkStatusListener {
+        void onNetworkStatusChanged(@NonNull AppNetworkStatusEvent event);
+    }
+
+    private static final CopyOnWriteArrayList<NetworkStatusListener> sListeners = new CopyOnWriteArrayList<>();
+    @AppNetworkStatusEvent.NetworkType
+    private static int sLastNetworkType = AppNetworkStatusEvent.NETWORK_TYPE_NONE;
+
     private static final NetworkCallback sCallback = new NetworkCallback() {
         /**
          * Network connection successful
@@ -62,9 +78,32 @@ public class AppNetworkStatusUtil {
 
     private static void notifyNetStatus() {
         boolean netConnected = isConnected(sContext);
-        SolutionDemoEventManager.post(new AppNetworkStatusEvent(netConnected
+        int networkType = netConnected ? getNetworkType(sContext) : AppNetworkStatusEvent.NETWORK_TYPE_NONE;
+        boolean switched;
+        synchronized (AppNetworkStatusUtil.class) {
+            switched = netConnected
+                    && sLastNetworkType != AppNetworkStatusEvent.NETWORK_TYPE_NONE
+                    && sLastNetworkType != networkType;
+            sLastNetworkType = networkType;
+        }
+        final AppNetworkStatusEvent event = new AppNetworkStatusEvent(netConnected
                 ? AppNetworkStatusEvent.NETWORK_STATUS_CONNECTED
-                : AppNetworkStatusEvent.NETWORK_STATUS_DISCONNECTED));
+                : AppNetworkStatusEvent.NETWORK_STATUS_DISCONNECTED, networkType, switched);
+        Log.e(TAG, "notifyNetStatus " + event);
+        SolutionDemoEventManager.post(event);
+        AppExecutors.mainThread().execute(() -> {
+            for (NetworkStatusListener listener : sListeners) {
+                listener.onNetworkStatusChanged(event);
+            }
+        });
+    }
+
+    public static void addNetworkStatusListener(@NonNull NetworkStatusListener listener) {
+        sListeners.addIfAbsent(listener);
+    }
+
+    public static void removeNetworkStatusListener(@NonNull NetworkStatusListener listener) {
+        sListeners.remove(listener);
     }
     /**
      * Register network status monitoring
@@ -123,4 +162,29 @@ public class AppNetworkStatusUtil {
         NetworkInfo activeNetwork = cm.getActiveNetworkInfo();
         return activeNetwork != null && activeNetwork.isConnected();
     }
+
+    /**
+     * Transport of the active network
+     * @param context context object
+     * @return one of AppNetworkStatusEvent.NETWORK_TYPE_*
+     */
+    @AppNetworkStatusEvent.NetworkType
+    public static int getNetworkType(Context context) {
+        if (context == null) {
+            return AppNetworkStatusEvent.NETWORK_TYPE_NONE;
+        }
+        ConnectivityManager cm = (ConnectivityManager) context.getSystemService(Context.CONNECTIVITY_SERVICE);
+        NetworkInfo activeNetwork = cm.getActiveNetworkInfo();
+        if (activeNetwork == null || !activeNetwork.isConnected()) {
+            return AppNetworkStatusEvent.NETWORK_TYPE_NONE;
+        }
+        switch (activeNetwork.getType()) {
+            case ConnectivityManager.TYPE_WIFI:
+                return AppNetworkStatusEvent.NETWORK_TYPE_WIFI;
+            case ConnectivityManager.TYPE_MOBILE:
+                return AppNetworkStatusEvent.NETWORK_TYPE_CELLULAR;
+            default:
+                return AppNetworkStatusEvent.NETWORK_TYPE_OTHER;
+        }
+    }
 }
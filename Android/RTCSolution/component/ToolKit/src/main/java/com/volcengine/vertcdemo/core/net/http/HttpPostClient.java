@@ -0,0 +1,218 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.http;
+
+import androidx.annotation.AnyThread;
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.google.gson.Gson;
+import com.google.gson.JsonParseException;
+import com.google.gson.stream.JsonReader;
+import com.google.gson.stream.JsonToken;
+import com.volcengine.vertcdemo.core.net.ServerResponse;
+
+import java.io.IOException;
+import java.io.Reader;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.concurrent.atomic.AtomicLong;
+
+import okhttp3.Call;
+import okhttp3.Callback;
+import okhttp3.MediaType;
+import okhttp3.OkHttpClient;
+import okhttp3.Request;
+import okhttp3.RequestBody;
+import okhttp3.Response;
+import okhttp3.ResponseBody;
+
+/**
+ * Asynchronous JSON POST on a shared OkHttpClient.
+ *
+ * Identical requests (same url, body and result type) issued while one is in flight share
+ * its response instead of going out again. Every waiter gets its own copy of the result, and
+ * side effects of the answer belong in a {@link ResponseObserver}, which sees it once. The body
+ * is parsed straight from the response stream, {"code", "message", "timestamp", "response"}
+ * with "response" bound to the result class.
+ *
+ * Listeners are called on an OkHttp thread.
+ */
+public class HttpPostClient {
+
+    private static final MediaType JSON = MediaType.parse("application/json; charset=utf-8");
+
+    public interface Listener<T> {
+        /**
+         * The server answered, the code may still be an error code.
+         */
+        void onResponse(@NonNull ServerResponse<T> response);
+
+        void onFailure(@NonNull IOException e);
+    }
+
+    public interface ResponseObserver {
+        /**
+         * The server answered, called once per request sent however many callers were waiting.
+         */
+        void onServerResponse(@NonNull ServerResponse<?> response);
+    }
+
+    private final OkHttpClient mClient;
+    private final Gson mGson;
+    @Nullable
+    private final ResponseObserver mObserver;
+    // Key: url + result type + body; value: listeners waiting for that request.
+    private final HashMap<String, List<Listener<?>>> mInFlight = new HashMap<>();
+    private final AtomicLong mSentCount = new AtomicLong();
+    private final AtomicLong mCoalescedCount = new AtomicLong();
+
+    public HttpPostClient(@NonNull OkHttpClient client, @NonNull Gson gson) {
+        this(client, gson, null);
+    }
+
+    public HttpPostClient(@NonNull OkHttpClient client, @NonNull Gson gson, @Nullable ResponseObserver observer) {
+        mClient = client;
+        mGson = gson;
+        mObserver = observer;
+    }
+
+    @AnyThread
+    public <T> void post(@NonNull String url, @NonNull String body, @Nullable Class<T> resultClass,
+                         @NonNull Listener<T> listener) {
+        final String key = url + '\n' + (resultClass == null ? "" : resultClass.getName()) + '\n' + body;
+        synchronized (mInFlight) {
+            List<Listener<?>> waiting = mInFlight.get(key);
+            if (waiting != null) {
+                waiting.add(listener);
+                mCoalescedCount.incrementAndGet();
+                return;
+            }
+            waiting = new ArrayList<>(1);
+            waiting.add(listener);
+            mInFlight.put(key, waiting);
+        }
+        mSentCount.incrementAndGet();
+        Request request = new Request.Builder()
+                .url(url)
+                .post(RequestBody.create(body, JSON))
+                .build();
+        mClient.newCall(request).enqueue(new Callback() {
+            @Override
+            public void onFailure(@NonNull Call call, @NonNull IOException e) {
+                for (Listener<?> waiting : finish(key)) {
+                    waiting.onFailure(e);
+                }
+            }
+
+            @Override
+            public void onResponse(@NonNull Call call, @NonNull Response response) {
+                ServerResponse<T> result;
+                try (ResponseBody responseBody = response.body()) {
+                    if (!response.isSuccessful()) {
+                        throw new IOException("http code = " + response.code());
+                    }
+                    if (responseBody == null) {
+                        throw new IOException("ResponseBody is null");
+                    }
+                    result = parse(mGson, responseBody.charStream(), resultClass);
+                } catch (IOException e) {
+                    onFailure(call, e);
+                    return;
+                } catch (JsonParseException | IllegalStateException e) {
+                    onFailure(call, new IOException(e));
+                    return;
+                }
+                List<Listener<?>> waiting = finish(key);
+                if (mObserver != null) {
+                    mObserver.onServerResponse(result);
+                }
+                for (int i = 0; i < waiting.size(); i++) {
+                    //noinspection unchecked
+                    ((Listener<T>) waiting.get(i)).onResponse(i == 0 ? result : copy(result, resultClass));
+                }
+            }
+        });
+    }
+
+    /**
+     * @return requests actually sent to the server
+     */
+    public long getSentCount() {
+        return mSentCount.get();
+    }
+
+    /**
+     * @return requests answered by an identical one already in flight
+     */
+    public long getCoalescedCount() {
+        return mCoalescedCount.get();
+    }
+
+    /**
+     * The envelope is immutable, the bound result is a plain bean and is copied.
+     */
+    @NonNull
+    private <T> ServerResponse<T> copy(@NonNull ServerResponse<T> response, @Nullable Class<T> resultClass) {
+        T data = response.getData();
+        if (data == null || resultClass == null) {
+            return response;
+        }
+        return ServerResponse.create(response.getCode(), response.getMsg(),
+                mGson.fromJson(mGson.toJsonTree(data), resultClass), response.getTimestamp());
+    }
+
+    @NonNull
+    private List<Listener<?>> finish(String key) {
+        synchronized (mInFlight) {
+            List<Listener<?>> waiting = mInFlight.remove(key);
+            return waiting == null ? new ArrayList<>() : waiting;
+        }
+    }
+
+    /**
+     * Parse the common response envelope in one pass over the stream.
+     */
+    @NonNull
+    public static <T> ServerResponse<T> parse(@NonNull Gson gson, @NonNull Reader reader,
+                                              @Nullable Class<T> resultClass) throws IOException {
+        int code = -1;
+        String message = "";
+        long timestamp = 0;
+        T data = null;
+        JsonReader json = new JsonReader(reader);
+        json.beginObject();
+        while (json.hasNext()) {
+            String name = json.nextName();
+            if (json.peek() == JsonToken.NULL) {
+                json.nextNull();
+                continue;
+            }
+            switch (name) {
+                case "code":
+                    code = json.nextInt();
+                    break;
+                case "message":
+                    message = json.nextString();
+                    break;
+                case "timestamp":
+                    timestamp = json.nextLong();
+                    break;
+                case "response":
+                    if (resultClass == null || resultClass == Void.class) {
+                        json.skipValue();
+                    } else {
+                        data = gson.fromJson(json, resultClass);
+                    }
+                    break;
+                default:
+                    json.skipValue();
+                    break;
+            }
+        }
+        json.endObject();
+        return ServerResponse.create(code, message, data, timestamp);
+    }
+}
@@ -9,9 +9,7 @@ import android.util.Log;
 import androidx.annotation.AnyThread;
 import androidx.annotation.NonNull;
 import androidx.annotation.Nullable;
-import androidx.annotation.WorkerThread;
 
-import com.google.gson.JsonSyntaxException;
 import com.volcengine.vertcdemo.common.AppExecutors;
 import com.volcengine.vertcdemo.common.GsonUtils;
 import com.volcengine.vertcdemo.core.BuildConfig;
@@ -28,14 +26,12 @@ import org.json.JSONException;
 import org.json.JSONObject;
 
 import java.io.IOException;
+import java.util.Arrays;
+import java.util.concurrent.TimeUnit;
 
-import okhttp3.Call;
-import okhttp3.MediaType;
+import okhttp3.ConnectionPool;
 import okhttp3.OkHttpClient;
-import okhttp3.Request;
-import okhttp3.RequestBody;
-import okhttp3.Response;
-import okhttp3.ResponseBody;
+import okhttp3.Protocol;
 
 public class HttpRequestHelper {
     /*
@@ -47,26 +43,47 @@ public class HttpRequestHelper {
 
     private static final String TAG = "HttpRequestHelper";
 
+    /**
+     * Shared by every HTTP caller so connections (HTTP/2 where the server negotiates it) are reused.
+     */
     public static final OkHttpClient DEFAULT_OKHTTP_CLIENT = new OkHttpClient.Builder()
             .hostnameVerifier((hostname, session) -> true)
+            .protocols(Arrays.asList(Protocol.HTTP_2, Protocol.HTTP_1_1))
+            .connectionPool(new ConnectionPool(5, 5, TimeUnit.MINUTES))
+            .connectTimeout(10, TimeUnit.SECONDS)
+            .readTimeout(15, TimeUnit.SECONDS)
+            .writeTimeout(15, TimeUnit.SECONDS)
+            .retryOnConnectionFailure(true)
             .build();
 
+    // Coalesced requests share one answer, so the token is dropped once per answer, not per caller.
+    private static final HttpPostClient POST_CLIENT = new HttpPostClient(DEFAULT_OKHTTP_CLIENT, GsonUtils.gson(),
+            response -> {
+                if (isTokenError(response.getCode())) {
+                    SolutionDataManager.ins().setToken("");
+                    SolutionDemoEventManager.post(new AppTokenExpiredEvent());
+                }
+            });
+
     @AnyThread
     public static <T> void sendPost(JSONObject params,
                                     Class<T> resultClass,
                                     @NonNull IRequestCallback<ServerResponse<T>> callBack) {
-        AppExecutors.networkIO().execute(() -> sendPost(LOGIN_URL, params, resultClass, callBack));
+        sendPost(LOGIN_URL, params, resultClass, callBack);
     }
 
     @AnyThread
     public static <T> void sendCommonPost(JSONObject params,
                                     Class<T> resultClass,
                                     @NonNull IRequestCallback<ServerResponse<T>> callBack) {
-        AppExecutors.networkIO().execute(() -> sendPost(COMMON_URL, params, resultClass, callBack));
+        sendPost(COMMON_URL, params, resultClass, callBack);
     }
 
-
-    @WorkerThread
+    /**
+     * Does not block, the request runs on the OkHttp dispatcher and the callback is invoked
+     * on the main thread. Identical requests already in flight are not sent again.
+     */
+    @AnyThread
     public static <T> void sendPost(@NonNull String url,
                                     JSONObject params,
                                     @Nullable Class<T> resultClass,
@@ -78,60 +95,31 @@ public class HttpRequestHelper {
         } catch (JSONException ignored) {
 
         }
-        RequestBody body = RequestBody.create(params.toString(), MediaType.parse("application/json; charset=utf-8"));
-        Request request = new Request.Builder()
-                .url(url)
-                .post(body)
-                .build();
-        Call call = DEFAULT_OKHTTP_CLIENT.newCall(request);
-
-        try (final Response response = call.execute()) {
-            Log.d(TAG, "Request: " + params);
-            if (!response.isSuccessful()) {
-                throw new IOException("http code = " + response.code());
-            }
-
-            final ResponseBody responseBody = response.body();
-            if (responseBody == null) {
-                throw new IOException("ResponseBody is null");
+        Log.d(TAG, "Request: " + params);
+        POST_CLIENT.post(url, params.toString(), resultClass, new HttpPostClient.Listener<T>() {
+            @Override
+            public void onResponse(@NonNull ServerResponse<T> response) {
+                final int code = response.getCode();
+                final String message = response.getMsg();
+                Log.d(TAG, "Response: code=" + code + " message=" + message);
+                if (code != 200) {
+                    AppExecutors.mainThread().execute(() -> callBack.onError(code, message));
+                } else {
+                    AppExecutors.mainThread().execute(() -> callBack.onSuccess(response));
+                }
             }
 
-            JSONObject json = new JSONObject(responseBody.string());
-            Log.d(TAG, "Response: " + json);
-
-            final int code = json.optInt("code");
-            final String message = json.optString("message");
-
-            if (code == ErrorTool.ERROR_CODE_TOKEN_EXPIRED
-                    || code == ErrorTool.ERROR_CODE_TOKEN_EMPTY
-                    || code == ErrorTool.ERROR_CODE_TOKEN_MISMATCH) {
-                SolutionDataManager.ins().setToken("");
-                SolutionDemoEventManager.post(new AppTokenExpiredEvent());
-                throw new NetworkException(code, message);
-            } else if (code != 200) {
-                throw new NetworkException(code, message);
-            }
-
-            final long timestamp = json.optLong("timestamp");
-            Object responseObject = json.opt("response");
-
-            T data;
-            if (responseObject == null
-                    || resultClass == null
-                    || resultClass == Void.class) {
-                data = null;
-            } else {
-                data = GsonUtils.gson().fromJson(responseObject.toString(), resultClass);
+            @Override
+            public void onFailure(@NonNull IOException e) {
+                Log.d(TAG, "post fail url:" + url, e);
+                AppExecutors.mainThread().execute(() -> callBack.onError(NetworkException.CODE_ERROR, e.getMessage()));
             }
+        });
+    }
 
-            final ServerResponse<T> sr = ServerResponse.create(code, message, data, timestamp);
-            AppExecutors.mainThread().execute(() -> callBack.onSuccess(sr));
-        } catch (NetworkException e) {
-            Log.d(TAG, "post fail url:" + url, e);
-            AppExecutors.mainThread().execute(() -> callBack.onError(e.code, e.getMessage()));
-        } catch (IOException | JsonSyntaxException | JSONException e) {
-            Log.d(TAG, "post fail url:" + url, e);
-            AppExecutors.mainThread().execute(() -> callBack.onError(NetworkException.CODE_ERROR, e.getMessage()));
-        }
+    private static boolean isTokenError(int code) {
+        return code == ErrorTool.ERROR_CODE_TOKEN_EXPIRED
+                || code == ErrorTool.ERROR_CODE_TOKEN_EMPTY
+                || code == ErrorTool.ERROR_CODE_TOKEN_MISMATCH;
     }
 }
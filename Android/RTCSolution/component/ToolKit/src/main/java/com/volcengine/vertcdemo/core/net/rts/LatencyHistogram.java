@@ -0,0 +1,115 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import java.util.Arrays;
+
+/**
+ * Latency histogram in the way of HdrHistogram: exact below 32ms, above that every power of two
+ * is split into 16 buckets, so any value is off by at most 1/16. Fixed size, recording does not
+ * allocate.
+ *
+ * Values are clamped to [0, {@link #MAX_VALUE_MS}]. Not thread safe.
+ */
+public class LatencyHistogram {
+
+    static final int SUB_BUCKET_BITS = 4;
+    static final int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    // Below this every ms has its own bucket.
+    static final int LINEAR_LIMIT = SUB_BUCKETS * 2;
+    // 2^24 ms is about 4.6 hours.
+    static final int MAX_EXPONENT = 23;
+    public static final long MAX_VALUE_MS = (1L << (MAX_EXPONENT + 1)) - 1;
+    static final int BUCKET_COUNT = LINEAR_LIMIT + (MAX_EXPONENT - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    private final long[] mCounts = new long[BUCKET_COUNT];
+    private long mTotalCount;
+    private long mSum;
+    private long mMin = Long.MAX_VALUE;
+    private long mMax;
+
+    public void record(long valueMs) {
+        long value = Math.max(0, Math.min(MAX_VALUE_MS, valueMs));
+        mCounts[indexOf(value)]++;
+        mTotalCount++;
+        mSum += value;
+        mMin = Math.min(mMin, value);
+        mMax = Math.max(mMax, value);
+    }
+
+    public long getTotalCount() {
+        return mTotalCount;
+    }
+
+    public long getMin() {
+        return mTotalCount == 0 ? 0 : mMin;
+    }
+
+    public long getMax() {
+        return mMax;
+    }
+
+    public double getMean() {
+        return mTotalCount == 0 ? 0 : (double) mSum / mTotalCount;
+    }
+
+    /**
+     * @param percentile 0 to 100
+     * @return the highest value equivalent to the one at the percentile, never above the max
+     */
+    public long getValueAtPercentile(double percentile) {
+        if (mTotalCount == 0) {
+            return 0;
+        }
+        double p = Math.max(0, Math.min(100, percentile));
+        long target = Math.max(1, (long) Math.ceil(p / 100 * mTotalCount));
+        long seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += mCounts[i];
+            if (seen >= target) {
+                return Math.min(highestEquivalent(i), mMax);
+            }
+        }
+        return mMax;
+    }
+
+    public void add(LatencyHistogram other) {
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            mCounts[i] += other.mCounts[i];
+        }
+        mTotalCount += other.mTotalCount;
+        mSum += other.mSum;
+        mMin = Math.min(mMin, other.mMin);
+        mMax = Math.max(mMax, other.mMax);
+    }
+
+    public void reset() {
+        Arrays.fill(mCounts, 0);
+        mTotalCount = 0;
+        mSum = 0;
+        mMin = Long.MAX_VALUE;
+        mMax = 0;
+    }
+
+    static int indexOf(long value) {
+        if (value < LINEAR_LIMIT) {
+            return (int) value;
+        }
+        int exponent = 63 - Long.numberOfLeadingZeros(value);
+        int shift = exponent - SUB_BUCKET_BITS;
+        int subBucket = (int) (value >> shift) - SUB_BUCKETS;
+        return LINEAR_LIMIT + (exponent - SUB_BUCKET_BITS - 1) * SUB_BUCKETS + subBucket;
+    }
+
+    static long highestEquivalent(int index) {
+        if (index < LINEAR_LIMIT) {
+            return index;
+        }
+        int k = index - LINEAR_LIMIT;
+        int exponent = SUB_BUCKET_BITS + 1 + k / SUB_BUCKETS;
+        int shift = exponent - SUB_BUCKET_BITS;
+        long mantissa = SUB_BUCKETS + k % SUB_BUCKETS;
+        return ((mantissa + 1) << shift) - 1;
+    }
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import androidx.annotation.NonNull;
+
+import com.ss.bytertc.engine.RTCVideo;
+
+/**
+ * Sends through the RTC SDK, results come back through {@link RTCVideoEventHandlerWithRTS}.
+ */
+public class RTCVideoTransport implements RTSTransport {
+
+    @NonNull
+    private final RTCVideo mRTCVideo;
+
+    public RTCVideoTransport(@NonNull RTCVideo rtcVideo) {
+        mRTCVideo = rtcVideo;
+    }
+
+    @Override
+    public void login(@NonNull String token, @NonNull String userId) {
+        mRTCVideo.login(token, userId);
+    }
+
+    @Override
+    public void logout() {
+        mRTCVideo.logout();
+    }
+
+    @Override
+    public void setServerParams(@NonNull String signature, @NonNull String url) {
+        mRTCVideo.setServerParams(signature, url);
+    }
+
+    @Override
+    public long sendServerMessage(@NonNull String message) {
+        return mRTCVideo.sendServerMessage(message);
+    }
+
+    @NonNull
+    @Override
+    public String toString() {
+        return String.valueOf(mRTCVideo);
+    }
+}
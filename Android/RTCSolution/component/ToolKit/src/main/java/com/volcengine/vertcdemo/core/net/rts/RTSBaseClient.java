@@ -6,6 +6,7 @@ package com.volcengine.vertcdemo.core.net.rts;
 import static com.ss.bytertc.engine.type.UserMessageSendResult.USER_MESSAGE_SEND_RESULT_NOT_LOGIN;
 import static com.ss.bytertc.engine.type.UserMessageSendResult.USER_MESSAGE_SEND_RESULT_SUCCESS;
 
+import android.os.SystemClock;
 import android.text.TextUtils;
 import android.util.Log;
 
@@ -16,16 +17,23 @@ import com.google.gson.JsonObject;
 import com.ss.bytertc.engine.RTCVideo;
 import com.ss.bytertc.engine.type.LoginErrorCode;
 import com.volcengine.vertcdemo.common.AppExecutors;
+import com.volcengine.vertcdemo.common.Clock;
+import com.volcengine.vertcdemo.common.Scheduler;
 import com.volcengine.vertcdemo.core.SolutionDataManager;
 import com.volcengine.vertcdemo.core.eventbus.RTSLogoutEvent;
+import com.volcengine.vertcdemo.core.eventbus.SocketConnectEvent;
 import com.volcengine.vertcdemo.core.eventbus.SolutionDemoEventManager;
 import com.volcengine.vertcdemo.core.net.ErrorTool;
 import com.volcengine.vertcdemo.core.net.IBroadcastListener;
 import com.volcengine.vertcdemo.core.net.IRequestCallback;
 import com.volcengine.vertcdemo.core.net.ServerResponse;
+import com.volcengine.vertcdemo.core.net.http.AppNetworkStatusEvent;
+import com.volcengine.vertcdemo.core.net.http.AppNetworkStatusUtil;
 
 import org.json.JSONObject;
 
+import java.util.Arrays;
+import java.util.Random;
 import java.util.UUID;
 import java.util.concurrent.ConcurrentHashMap;
 
@@ -37,26 +45,178 @@ public abstract class RTSBaseClient {
     public static final int ERROR_CODE_USERNAME_SAME = 414;
     public static final int ERROR_CODE_ROOM_FULL = 507;
     public static final int ERROR_CODE_DEFAULT = -1;
+    public static final int ERROR_CODE_DUPLICATE_REQUEST = -2;
+    public static final int ERROR_CODE_REQUEST_TIMEOUT = -3;
+    /*** 请求等待业务服务器回复的默认最长时间 */
+    public static final long DEFAULT_REQUEST_TIMEOUT_MS = 15_000;
 
+    /*** 与业务服务器之间的链路，默认为 RTC SDK */
     @NonNull
-    private final RTCVideo mRTCVideo;
+    private final RTSTransport mTransport;
     /***是否初始化业务服务器完成*/
     private boolean mInitBizServerCompleted;
     private LoginCallBack mLoginCallback;
+    /***登录token，断线重连时复用*/
+    private String mLoginToken;
+    @NonNull
+    private final RTSReconnectSupervisor mSupervisor;
+    @NonNull
+    private final RTSNetworkFailover mNetworkFailover;
+    private final AppNetworkStatusUtil.NetworkStatusListener mNetworkStatusListener = this::onNetworkStatusChanged;
 
     @NonNull
     protected final RTSInfo mRTSInfo;
     /*** RTM请求集合，Key:发送消息id; value为请求requestId */
     private final ConcurrentHashMap<Long, String> mMessageIdRequestIdMap = new ConcurrentHashMap<>();
-    /*** RTM请求集合，Key:请求requestId; value为请求回调及数据类型class */
-    private final ConcurrentHashMap<String, IRTSCallback> mRequestIdCallbackMap = new ConcurrentHashMap<>();
+    /*** RTM请求集合，Key:请求requestId; value为原始请求，断线时用于重放 */
+    private final ConcurrentHashMap<String, RTSReconnectSupervisor.Call> mRequestIdCallMap = new ConcurrentHashMap<>();
+    /*** 请求超时任务，Key:请求requestId */
+    private final ConcurrentHashMap<String, Runnable> mRequestTimeoutMap = new ConcurrentHashMap<>();
+    @NonNull
+    private final Scheduler mScheduler;
+    private volatile long mRequestTimeoutMs = DEFAULT_REQUEST_TIMEOUT_MS;
     /*** RTM通知消息监听器*/
     protected final ConcurrentHashMap<String, IBroadcastListener> mEventListeners = new ConcurrentHashMap<>();
+    /*** 请求各阶段耗时统计 */
+    @NonNull
+    private final RTSLatencyTracer mLatencyTracer;
+    /*** 收发消息监听，用于录制和回放会话 */
+    @Nullable
+    private volatile MessageObserver mMessageObserver;
 
 
     public RTSBaseClient(@NonNull RTCVideo engine, @NonNull RTSInfo rtsInfo) {
-        mRTCVideo = engine;
+        this(new RTCVideoTransport(engine), rtsInfo);
+    }
+
+    /**
+     * @param transport 发送消息的链路，如测试中的本地业务服务器，结果需回调本类的 onLoginResult 等方法
+     */
+    public RTSBaseClient(@NonNull RTSTransport transport, @NonNull RTSInfo rtsInfo) {
+        this(transport, rtsInfo, AppExecutors.mainScheduler(), SystemClock::uptimeMillis, new Random());
+    }
+
+    /**
+     * @param scheduler 重连退避、握手超时、请求超时和网络切换探测的定时器
+     * @param clock     请求耗时统计的时钟
+     * @param random    重连退避的随机抖动
+     */
+    public RTSBaseClient(@NonNull RTSTransport transport, @NonNull RTSInfo rtsInfo,
+                         @NonNull Scheduler scheduler, @NonNull Clock clock, @NonNull Random random) {
+        mTransport = transport;
         mRTSInfo = rtsInfo;
+        mScheduler = scheduler;
+        mLatencyTracer = new RTSLatencyTracer(clock);
+        mSupervisor = new RTSReconnectSupervisor(this::restartLogin, scheduler, new RTSReconnectSupervisor.Replayer() {
+            @Override
+            public void replay(@NonNull RTSReconnectSupervisor.Call call) {
+                Log.d(TAG, "replay request after reconnect: " + call.eventName);
+                sendCall(call);
+            }
+
+            @Override
+            public void fail(@NonNull RTSReconnectSupervisor.Call call, int code, @NonNull String message) {
+                notifyRequestFail(code, message, call.callback);
+            }
+        }, random);
+        mSupervisor.addStateListener(this::onConnectionStateChanged);
+        mNetworkFailover = new RTSNetworkFailover(mSupervisor, this::sendHealthProbe, scheduler);
+    }
+
+    /**
+     * 网络切换后探测业务服务器是否可达，子类应发送一个轻量的幂等请求。
+     * 默认不探测，直接认为连接可用。
+     *
+     * @param callback 收到任何业务服务器回复即视为连接可用
+     */
+    protected void sendHealthProbe(@NonNull IRTSCallback callback) {
+        callback.onSuccess(null);
+    }
+
+    /**
+     * 登录和请求使用的用户 id，默认为当前登录用户
+     */
+    protected String getUserId() {
+        return SolutionDataManager.ins().getUserId();
+    }
+
+    /**
+     * 随每个请求发给业务服务器的登录 token，默认为当前登录用户的
+     */
+    protected String getLoginToken() {
+        return SolutionDataManager.ins().getToken();
+    }
+
+    protected String getDeviceId() {
+        return SolutionDataManager.ins().getDeviceId();
+    }
+
+    /**
+     * 注册非必要流量（轮询、音量回调等），网络不稳定时暂停，恢复连接后继续
+     */
+    public void addNonEssentialTraffic(@NonNull RTSNetworkFailover.Pausable pausable) {
+        mNetworkFailover.addPausable(pausable);
+    }
+
+    public void removeNonEssentialTraffic(@NonNull RTSNetworkFailover.Pausable pausable) {
+        mNetworkFailover.removePausable(pausable);
+    }
+
+    private void onNetworkStatusChanged(@NonNull AppNetworkStatusEvent event) {
+        Log.d(TAG, "onNetworkStatusChanged " + event);
+        if (event.status == AppNetworkStatusEvent.NETWORK_STATUS_DISCONNECTED) {
+            mNetworkFailover.onNetworkLost();
+        } else {
+            mNetworkFailover.onNetworkAvailable(event.switched);
+        }
+    }
+
+    /**
+     * 请求发出后等待业务服务器回复的最长时间，超时以 ERROR_CODE_REQUEST_TIMEOUT 结束请求，
+     * 之后到达的回复被忽略
+     */
+    public void setRequestTimeout(long timeoutMs) {
+        mRequestTimeoutMs = timeoutMs;
+    }
+
+    /**
+     * 声明幂等的请求，断线期间这些请求会排队并在重连成功后重发
+     *
+     * @param events 事件名称
+     */
+    protected final void setIdempotentEvents(String... events) {
+        mSupervisor.setIdempotentEvents(Arrays.asList(events));
+    }
+
+    /**
+     * 监听RTS连接状态变化，状态见 RTSReconnectSupervisor.State
+     */
+    public void addConnectionStateListener(@NonNull RTSReconnectSupervisor.StateListener listener) {
+        mSupervisor.addStateListener(listener);
+    }
+
+    public void removeConnectionStateListener(@NonNull RTSReconnectSupervisor.StateListener listener) {
+        mSupervisor.removeStateListener(listener);
+    }
+
+    @RTSReconnectSupervisor.State
+    public int getConnectionState() {
+        return mSupervisor.getState();
+    }
+
+    /**
+     * 请求从入队、交给 SDK、SDK 发送结果到收到业务服务器回复的耗时，按 event_name 统计
+     */
+    @NonNull
+    public RTSLatencyTracer getLatencyTracer() {
+        return mLatencyTracer;
+    }
+
+    /**
+     * 监听发给业务服务器和收到的原始消息，如 RTSSessionRecorder 录制会话、RTSSessionReplayer 回放会话
+     */
+    public void setMessageObserver(@Nullable MessageObserver observer) {
+        mMessageObserver = observer;
     }
 
     public boolean isLogin() {
@@ -71,16 +231,18 @@ public abstract class RTSBaseClient {
      */
     public void login(@NonNull String token, @NonNull LoginCallBack callback) {
         mLoginCallback = callback;
-        final String userId = SolutionDataManager.ins().getUserId();
+        mLoginToken = token;
+        AppNetworkStatusUtil.addNetworkStatusListener(mNetworkStatusListener);
+        final String userId = getUserId();
         if (TextUtils.isEmpty(token) || TextUtils.isEmpty(userId)) {
             notifyLoginResult(LoginCallBack.DEFAULT_FAIL_CODE,
                     "login fail because params is illegal :"
                             + "token:" + token
                             + ",uid:" + userId
-                            + ",mRTCEngine:" + mRTCVideo);
+                            + ",transport:" + mTransport);
             return;
         }
-        mRTCVideo.login(token, userId);
+        mTransport.login(token, userId);
     }
 
     /**
@@ -95,14 +257,16 @@ public abstract class RTSBaseClient {
         if (TextUtils.isEmpty(mRTSInfo.serverUrl) || TextUtils.isEmpty(mRTSInfo.serverSignature)) {
             notifyLoginResult(LoginCallBack.DEFAULT_FAIL_CODE,
                     "onLoginResult fail because params is illegal :"
-                            + "mRTCEngine:" + mRTCVideo
+                            + "transport:" + mTransport
                             + ",mRtmInfo:" + mRTSInfo);
+            mSupervisor.onHandshakeFailed(LoginCallBack.DEFAULT_FAIL_CODE);
             return;
         }
         if (code == LoginErrorCode.LOGIN_ERROR_CODE_SUCCESS) {
             setServerParams(mRTSInfo.serverSignature, mRTSInfo.serverUrl);
         } else {
             notifyLoginResult(code, "onLoginResult fail because");
+            mSupervisor.onHandshakeFailed(code);
         }
     }
 
@@ -113,7 +277,49 @@ public abstract class RTSBaseClient {
     public void logout() {
         Log.d(TAG, "logout");
         mInitBizServerCompleted = false;
-        mRTCVideo.logout();
+        AppNetworkStatusUtil.removeNetworkStatusListener(mNetworkStatusListener);
+        mSupervisor.stop();
+        mTransport.logout();
+    }
+
+    /**
+     * 断线重连时重新走 login + setServerParams 流程
+     */
+    private void restartLogin() {
+        final String userId = getUserId();
+        if (TextUtils.isEmpty(mLoginToken) || TextUtils.isEmpty(userId)) {
+            mSupervisor.onHandshakeFailed(LoginCallBack.DEFAULT_FAIL_CODE);
+            return;
+        }
+        Log.d(TAG, "restartLogin attempt:" + mSupervisor.getAttempt());
+        mTransport.logout();
+        mTransport.login(mLoginToken, userId);
+    }
+
+    private void onConnectionStateChanged(int oldState, int newState, int attempt) {
+        Log.d(TAG, "onConnectionStateChanged " + oldState + " -> " + newState + " attempt:" + attempt);
+        if (oldState == newState) {
+            return;
+        }
+        if (newState == RTSReconnectSupervisor.STATE_RECONNECTING) {
+            // 新请求排队或快速失败，不再发往已断开的连接
+            mInitBizServerCompleted = false;
+        }
+        SocketConnectEvent.ConnectStatus status;
+        if (newState == RTSReconnectSupervisor.STATE_CONNECTED) {
+            status = oldState == RTSReconnectSupervisor.STATE_RECONNECTING
+                    ? SocketConnectEvent.ConnectStatus.RECONNECTED
+                    : SocketConnectEvent.ConnectStatus.CONNECTED;
+        } else if (newState == RTSReconnectSupervisor.STATE_RECONNECTING) {
+            status = SocketConnectEvent.ConnectStatus.CONNECTING;
+        } else {
+            status = SocketConnectEvent.ConnectStatus.DISCONNECTED;
+        }
+        SolutionDemoEventManager.post(new SocketConnectEvent(status));
+        if (newState == RTSReconnectSupervisor.STATE_FAILED) {
+            // 重连失败，按 RTS 退出登录处理
+            SolutionDemoEventManager.post(new RTSLogoutEvent());
+        }
     }
 
     /**
@@ -129,12 +335,12 @@ public abstract class RTSBaseClient {
     public void setServerParams(String signature, String url) {
         if (TextUtils.isEmpty(signature) || TextUtils.isEmpty(url)) {
             notifyLoginResult(LoginCallBack.DEFAULT_FAIL_CODE, "setServerParams params is illegal :"
-                    + "mRTCEngine:" + mRTCVideo
+                    + "transport:" + mTransport
                     + "signature:" + signature
                     + ",url:" + url);
             return;
         }
-        mRTCVideo.setServerParams(signature, url);
+        mTransport.setServerParams(signature, url);
     }
 
     /**
@@ -145,10 +351,12 @@ public abstract class RTSBaseClient {
     public void onServerParamsSetResult(int error) {
         if (error != 200) {
             notifyLoginResult(error, "onServerParamsSetResult fail");
+            mSupervisor.onHandshakeFailed(error);
             return;
         }
-        notifyLoginResult(LoginCallBack.SUCCESS, "");
         mInitBizServerCompleted = true;
+        notifyLoginResult(LoginCallBack.SUCCESS, "");
+        mSupervisor.onConnected();
     }
 
     /**
@@ -159,11 +367,15 @@ public abstract class RTSBaseClient {
      */
     private <T extends RTSBizResponse> long sendServerMessage(String requestId, String message, IRTSCallback callBack) {
         if (TextUtils.isEmpty(message)) {
-            notifyRequestFail(ERROR_CODE_DEFAULT, "sendServerMessage fail mRTCEngine:" + mRTCVideo + ",message:" + message, callBack);
+            notifyRequestFail(ERROR_CODE_DEFAULT, "sendServerMessage fail transport:" + mTransport + ",message:" + message, callBack);
             return ERROR_CODE_DEFAULT;
         }
         Log.e(TAG, "sendServerMessage message:" + message);
-        long msgId = mRTCVideo.sendServerMessage(message);
+        final MessageObserver observer = mMessageObserver;
+        if (observer != null) {
+            observer.onOutbound(message);
+        }
+        long msgId = mTransport.sendServerMessage(message);
         if (msgId == ERROR_CODE_DEFAULT && callBack != null) {
             notifyRequestFail(ERROR_CODE_DEFAULT, "sendServerMessage fail msgId:" + msgId, callBack);
             return ERROR_CODE_DEFAULT;
@@ -180,13 +392,27 @@ public abstract class RTSBaseClient {
      * https://www.volcengine.com/docs/6348/70081#IRTCEngineEventHandler-onservermessagesendresult
      */
     public void onServerMessageSendResult(long messageId, int error) {
+        mLatencyTracer.onSendResult(messageId, error == USER_MESSAGE_SEND_RESULT_SUCCESS);
         String requestId = mMessageIdRequestIdMap.remove(messageId);
         if (error == USER_MESSAGE_SEND_RESULT_NOT_LOGIN) {
-            // RTS 退出登录
-            SolutionDemoEventManager.post(new RTSLogoutEvent());
+            // RTS 连接断开，幂等请求排队等待重连，其余请求直接失败
+            mInitBizServerCompleted = false;
+            mSupervisor.onConnectionLost();
+            final RTSReconnectSupervisor.Call call = requestId == null ? null : mRequestIdCallMap.remove(requestId);
+            if (call != null) {
+                cancelRequestTimeout(requestId);
+                mSupervisor.end(call);
+                if (!mSupervisor.enqueue(call)) {
+                    notifyRequestFail(ERROR_CODE_DEFAULT, "sendServerMessage fail error:" + error, call.callback);
+                }
+            }
         } else if (requestId != null && error != USER_MESSAGE_SEND_RESULT_SUCCESS) {
-            final IRTSCallback callback = mRequestIdCallbackMap.remove(requestId);
-            notifyRequestFail(ERROR_CODE_DEFAULT, "sendServerMessage fail error:" + error, callback);
+            final RTSReconnectSupervisor.Call call = mRequestIdCallMap.remove(requestId);
+            if (call != null) {
+                cancelRequestTimeout(requestId);
+                mSupervisor.end(call);
+                notifyRequestFail(ERROR_CODE_DEFAULT, "sendServerMessage fail error:" + error, call.callback);
+            }
         }
     }
 
@@ -204,7 +430,9 @@ public abstract class RTSBaseClient {
                                                              JsonObject content,
                                                              @Nullable Class<T> resultClass,
                                                              @Nullable IRequestCallback<T> callback) {
-        sendServerMessage(eventName, roomId, content, new RTSRequest<>(eventName, callback, resultClass));
+        RTSRequest<T> request = new RTSRequest<>(eventName, callback, resultClass);
+        request.enqueuedAtMs = mLatencyTracer.now();
+        sendServerMessage(eventName, roomId, content, request);
     }
 
     /**
@@ -220,29 +448,52 @@ public abstract class RTSBaseClient {
                                                              JsonObject content,
                                                              IRTSCallback callback) {
         Log.e(TAG, "sendServerMessage eventName:" + eventName + ",content:" + content);
+        sendCall(new RTSReconnectSupervisor.Call(eventName, roomId, content, callback));
+    }
+
+    private void sendCall(@NonNull RTSReconnectSupervisor.Call call) {
+        final String eventName = call.eventName;
+        final JsonObject content = call.content;
+        final IRTSCallback callback = call.callback;
         if (!mInitBizServerCompleted) {
+            if (mSupervisor.enqueue(call)) {
+                Log.d(TAG, "sendServerMessage queued until reconnected: " + eventName);
+                return;
+            }
             String msg = "sendServerMessage failed mInitBizServerCompleted: false";
             notifyRequestFail(ERROR_CODE_DEFAULT, msg, callback);
             Log.e(TAG, msg);
             return;
         }
-        if (content == null) {
-            content = new JsonObject();
+        if (!mSupervisor.begin(call)) {
+            String msg = "sendServerMessage duplicate request in flight: " + eventName;
+            notifyRequestFail(ERROR_CODE_DUPLICATE_REQUEST, msg, callback);
+            Log.e(TAG, msg);
+            return;
         }
-        content.addProperty("login_token", SolutionDataManager.ins().getToken());
+        content.addProperty("login_token", getLoginToken());
         String requestId = String.valueOf(UUID.randomUUID());
         JsonObject message = new JsonObject();
         message.addProperty("app_id", mRTSInfo.appId);
-        message.addProperty("room_id", roomId);
-        message.addProperty("user_id", SolutionDataManager.ins().getUserId());
+        message.addProperty("room_id", call.roomId);
+        message.addProperty("user_id", getUserId());
         message.addProperty("event_name", eventName);
         message.addProperty("content", content.toString());
         message.addProperty("request_id", requestId);
-        message.addProperty("device_id", SolutionDataManager.ins().getDeviceId());
+        message.addProperty("device_id", getDeviceId());
+        final long enqueuedAtMs = callback instanceof RTSRequest ? ((RTSRequest<?>) callback).enqueuedAtMs : -1;
+        // 先登记再发送，回复可能在 sendServerMessage 返回前到达
+        mRequestIdCallMap.put(requestId, call);
+        final Runnable timeoutTask = () -> onRequestTimeout(requestId);
+        mRequestTimeoutMap.put(requestId, timeoutTask);
+        mScheduler.schedule(timeoutTask, mRequestTimeoutMs);
+        mLatencyTracer.onSending(requestId, eventName, enqueuedAtMs);
         long msgId = sendServerMessage(requestId, message.toString(), callback);
-        if (msgId > 0) {
-            mRequestIdCallbackMap.put(requestId, callback);
-        } else {
+        mLatencyTracer.onSent(requestId, msgId);
+        if (msgId <= 0) {
+            mRequestIdCallMap.remove(requestId);
+            cancelRequestTimeout(requestId);
+            mSupervisor.end(call);
             if (callback != null) {
                 callback.onError(-1, "sendServerMessage failed: " + msgId);
             }
@@ -253,16 +504,26 @@ public abstract class RTSBaseClient {
      * 收到RTM业务请求回调消息及通知消息，并解析
      */
     public void onMessageReceived(String uid, String message) {
+        final MessageObserver observer = mMessageObserver;
+        if (observer != null && message != null) {
+            observer.onInbound(uid, message);
+        }
         try {
             JSONObject messageJson = new JSONObject(message);
             String messageType = messageJson.getString("message_type");
             if (TextUtils.equals(messageType, ServerResponse.MESSAGE_TYPE_RETURN)) {
                 String requestId = messageJson.getString("request_id");
-                final IRTSCallback callback = mRequestIdCallbackMap.remove(requestId);
-                if (callback == null) {
+                mLatencyTracer.onAnswer(requestId, messageJson.optInt("code") == 200);
+                final RTSReconnectSupervisor.Call call = mRequestIdCallMap.remove(requestId);
+                if (call != null) {
+                    cancelRequestTimeout(requestId);
+                    mSupervisor.end(call);
+                }
+                if (call == null || call.callback == null) {
                     Log.e(TAG, "onMessageReceived callback is null");
                     return;
                 }
+                final IRTSCallback callback = call.callback;
                 Log.e(TAG, String.format("onMessageReceived (%s): %s", requestId, message));
 
                 final int code = messageJson.optInt("code");
@@ -289,6 +550,29 @@ public abstract class RTSBaseClient {
         }
     }
 
+    /**
+     * 回复未在 mRequestTimeoutMs 内到达，结束请求，同一请求可以再次发送
+     */
+    private void onRequestTimeout(String requestId) {
+        mRequestTimeoutMap.remove(requestId);
+        final RTSReconnectSupervisor.Call call = mRequestIdCallMap.remove(requestId);
+        if (call == null) {
+            return;
+        }
+        mSupervisor.end(call);
+        mLatencyTracer.onTimeout(requestId);
+        String msg = "sendServerMessage timeout: " + call.eventName;
+        Log.e(TAG, msg);
+        notifyRequestFail(ERROR_CODE_REQUEST_TIMEOUT, msg, call.callback);
+    }
+
+    private void cancelRequestTimeout(String requestId) {
+        final Runnable timeoutTask = mRequestTimeoutMap.remove(requestId);
+        if (timeoutTask != null) {
+            mScheduler.cancel(timeoutTask);
+        }
+    }
+
     private static void notifyRequestFail(int code, String msg, @Nullable IRTSCallback callback) {
         if (callback == null) return;
         AppExecutors.mainThread().execute(() -> {
@@ -304,6 +588,21 @@ public abstract class RTSBaseClient {
         });
     }
 
+    /**
+     * 收发的原始消息，在 SDK 线程回调
+     */
+    public interface MessageObserver {
+        /**
+         * @param message 发给业务服务器的消息，交给 SDK 之前回调
+         */
+        void onOutbound(@NonNull String message);
+
+        /**
+         * @param message 收到的消息，解析之前回调
+         */
+        void onInbound(@Nullable String uid, @NonNull String message);
+    }
+
     /**
      * 登陆成功或者失败的回调
      */
@@ -0,0 +1,279 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.common.Clock;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+import java.util.TreeMap;
+
+/**
+ * Times every RTS request end to end. A request is stamped when the business layer enqueues
+ * it, when it is handed to the SDK, when the SDK reports the send result and when the answer of
+ * the business server arrives; the stages go into one {@link LatencyHistogram} each per
+ * event_name.
+ *
+ * Answers and send results may come in either order, and before the SDK returned the message
+ * id. Requests that timed out, see {@link #onTimeout(String)}, are counted as lost, so are
+ * requests never answered once they are dropped oldest first past {@link #MAX_TRACES}.
+ */
+public class RTSLatencyTracer {
+
+    /*** Enqueued to handed to the SDK, including the lane and the wait for a reconnect */
+    public static final int STAGE_QUEUE = 0;
+    /*** Handed to the SDK to the send result of the SDK */
+    public static final int STAGE_SEND = 1;
+    /*** Handed to the SDK to the answer of the business server */
+    public static final int STAGE_ANSWER = 2;
+    /*** Enqueued to the answer of the business server */
+    public static final int STAGE_TOTAL = 3;
+    static final int STAGE_COUNT = 4;
+    private static final String[] STAGE_NAMES = {"queue", "send", "answer", "total"};
+
+    static final int MAX_TRACES = 256;
+    static final int MAX_EVENTS = 64;
+    static final String OTHER_EVENT = "other";
+
+    private static final class Trace {
+        final String requestId;
+        final EventStats stats;
+        final long enqueuedAtMs;
+        final long sentAtMs;
+
+        Trace(String requestId, EventStats stats, long enqueuedAtMs, long sentAtMs) {
+            this.requestId = requestId;
+            this.stats = stats;
+            this.enqueuedAtMs = enqueuedAtMs;
+            this.sentAtMs = sentAtMs;
+        }
+    }
+
+    private static final class EventStats {
+        final LatencyHistogram[] stages = new LatencyHistogram[STAGE_COUNT];
+        long sendFailures;
+        long errorAnswers;
+        long lost;
+
+        EventStats() {
+            for (int i = 0; i < STAGE_COUNT; i++) {
+                stages[i] = new LatencyHistogram();
+            }
+        }
+    }
+
+    private final Clock mClock;
+    // Guarded by this. Sent, not answered yet.
+    private final LinkedHashMap<String, Trace> mByRequestId = new LinkedHashMap<String, Trace>() {
+        @Override
+        protected boolean removeEldestEntry(Map.Entry<String, Trace> eldest) {
+            if (size() <= MAX_TRACES) {
+                return false;
+            }
+            eldest.getValue().stats.lost++;
+            return true;
+        }
+    };
+    // Guarded by this. Handed to the SDK, message id not returned yet.
+    private final Map<String, Trace> mSending = new HashMap<>();
+    // Guarded by this. Sent, no send result yet.
+    private final LinkedHashMap<Long, Trace> mByMessageId = new LinkedHashMap<Long, Trace>() {
+        @Override
+        protected boolean removeEldestEntry(Map.Entry<Long, Trace> eldest) {
+            return size() > MAX_TRACES;
+        }
+    };
+    // Guarded by this. Send results that came before onSent returned, time of success or -1.
+    private final LinkedHashMap<Long, Long> mEarlyResults = new LinkedHashMap<Long, Long>() {
+        @Override
+        protected boolean removeEldestEntry(Map.Entry<Long, Long> eldest) {
+            return size() > MAX_TRACES;
+        }
+    };
+    // Guarded by this.
+    private final Map<String, EventStats> mEvents = new TreeMap<>();
+
+    public RTSLatencyTracer(@NonNull Clock clock) {
+        mClock = clock;
+    }
+
+    /**
+     * @return time on the tracer's clock, to stamp a request when it is enqueued
+     */
+    public long now() {
+        return mClock.now();
+    }
+
+    /**
+     * The request is about to be handed to the SDK. Call before sending, so an answer that comes
+     * before the SDK returned is matched, then {@link #onSent(String, long)}.
+     *
+     * @param enqueuedAtMs from {@link #now()} when it was enqueued, negative if not stamped
+     */
+    public synchronized void onSending(@NonNull String requestId, @NonNull String eventName, long enqueuedAtMs) {
+        long now = mClock.now();
+        EventStats stats = statsOf(eventName);
+        Trace trace = new Trace(requestId, stats, enqueuedAtMs >= 0 ? enqueuedAtMs : now, now);
+        stats.stages[STAGE_QUEUE].record(now - trace.enqueuedAtMs);
+        mByRequestId.put(requestId, trace);
+        mSending.put(requestId, trace);
+    }
+
+    /**
+     * The SDK returned from sending the request of {@link #onSending(String, String, long)}.
+     *
+     * @param messageId returned by the SDK, 0 or less if it did not take the message
+     */
+    public synchronized void onSent(@NonNull String requestId, long messageId) {
+        Trace trace = mSending.remove(requestId);
+        if (trace == null) {
+            return;
+        }
+        if (messageId <= 0) {
+            onSendResult(trace, false, mClock.now());
+            return;
+        }
+        Long early = mEarlyResults.remove(messageId);
+        if (early == null) {
+            mByMessageId.put(messageId, trace);
+        } else {
+            onSendResult(trace, early >= 0, early);
+        }
+    }
+
+    public synchronized void onSendResult(long messageId, boolean success) {
+        long now = mClock.now();
+        Trace trace = mByMessageId.remove(messageId);
+        if (trace == null) {
+            // The SDK may report on its thread before the sending thread got to onSent.
+            mEarlyResults.put(messageId, success ? now : -1);
+            return;
+        }
+        onSendResult(trace, success, now);
+    }
+
+    private void onSendResult(Trace trace, boolean success, long now) {
+        if (success) {
+            trace.stats.stages[STAGE_SEND].record(Math.max(0, now - trace.sentAtMs));
+        } else if (mByRequestId.remove(trace.requestId) != null) {
+            // Not sent, a retry is traced under its new request id.
+            trace.stats.sendFailures++;
+        }
+    }
+
+    /**
+     * @param success false if the business server answered with an error code
+     */
+    public synchronized void onAnswer(@NonNull String requestId, boolean success) {
+        Trace trace = mByRequestId.remove(requestId);
+        if (trace == null) {
+            return;
+        }
+        long now = mClock.now();
+        trace.stats.stages[STAGE_ANSWER].record(now - trace.sentAtMs);
+        trace.stats.stages[STAGE_TOTAL].record(now - trace.enqueuedAtMs);
+        if (!success) {
+            trace.stats.errorAnswers++;
+        }
+    }
+
+    /**
+     * The client gave up waiting for the answer, a late one is not timed.
+     */
+    public synchronized void onTimeout(@NonNull String requestId) {
+        mSending.remove(requestId);
+        Trace trace = mByRequestId.remove(requestId);
+        if (trace != null) {
+            trace.stats.lost++;
+        }
+    }
+
+    /**
+     * @return event names seen so far, sorted
+     */
+    @NonNull
+    public synchronized List<String> getEventNames() {
+        return new ArrayList<>(mEvents.keySet());
+    }
+
+    /**
+     * @param stage one of STAGE_*
+     * @return a copy of the histogram, null if the event was never sent
+     */
+    @Nullable
+    public synchronized LatencyHistogram getHistogram(@NonNull String eventName, int stage) {
+        EventStats stats = mEvents.get(eventName);
+        if (stats == null) {
+            return null;
+        }
+        LatencyHistogram copy = new LatencyHistogram();
+        copy.add(stats.stages[stage]);
+        return copy;
+    }
+
+    /*** Requests sent and not answered yet */
+    public synchronized int getPendingCount() {
+        return mByRequestId.size();
+    }
+
+    public synchronized void reset() {
+        mByRequestId.clear();
+        mSending.clear();
+        mByMessageId.clear();
+        mEarlyResults.clear();
+        mEvents.clear();
+    }
+
+    /**
+     * Per event_name and stage: count, p50, p90, p99 and max in ms, for the log or a debug panel.
+     */
+    @NonNull
+    public synchronized String dump() {
+        StringBuilder dump = new StringBuilder("RTS latency ms (n p50/p90/p99/max)");
+        if (mEvents.isEmpty()) {
+            dump.append("\nno requests");
+        }
+        for (Map.Entry<String, EventStats> entry : mEvents.entrySet()) {
+            EventStats stats = entry.getValue();
+            dump.append('\n').append(entry.getKey());
+            for (int stage = 0; stage < STAGE_COUNT; stage++) {
+                LatencyHistogram histogram = stats.stages[stage];
+                dump.append(String.format(Locale.US, "\n  %-6s %d %d/%d/%d/%d", STAGE_NAMES[stage],
+                        histogram.getTotalCount(),
+                        histogram.getValueAtPercentile(50),
+                        histogram.getValueAtPercentile(90),
+                        histogram.getValueAtPercentile(99),
+                        histogram.getMax()));
+            }
+            if (stats.sendFailures > 0 || stats.errorAnswers > 0 || stats.lost > 0) {
+                dump.append(String.format(Locale.US, "\n  send failed %d, error answers %d, lost %d",
+                        stats.sendFailures, stats.errorAnswers, stats.lost));
+            }
+        }
+        return dump.toString();
+    }
+
+    private EventStats statsOf(String eventName) {
+        String name = eventName == null ? OTHER_EVENT : eventName;
+        EventStats stats = mEvents.get(name);
+        if (stats == null) {
+            if (mEvents.size() >= MAX_EVENTS) {
+                name = OTHER_EVENT;
+                stats = mEvents.get(name);
+            }
+            if (stats == null) {
+                stats = new EventStats();
+                mEvents.put(name, stats);
+            }
+        }
+        return stats;
+    }
+}
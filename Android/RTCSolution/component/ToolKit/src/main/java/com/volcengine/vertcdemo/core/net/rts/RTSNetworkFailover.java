@@ -0,0 +1,188 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.common.Scheduler;
+
+import java.util.List;
+import java.util.concurrent.CopyOnWriteArrayList;
+
+/**
+ * Reacts to device network changes instead of waiting for SDK timeouts.
+ *
+ * Network lost: non essential traffic is paused and the RTS connection is marked lost, so
+ * idempotent requests queue up instead of going into a dead socket.
+ * Network back: the reconnect is started at once, skipping the remaining backoff.
+ * Network switched (e.g. Wi-Fi to cellular) while connected: a health probe is sent, if no
+ * reply comes within {@link #DEFAULT_PROBE_TIMEOUT_MS} the connection is treated as lost.
+ * Paused traffic resumes once the probe or the reconnect succeeded.
+ */
+public class RTSNetworkFailover {
+
+    public static final long DEFAULT_PROBE_TIMEOUT_MS = 3_000;
+
+    /**
+     * Sends a cheap request to the business server. Any server reply, even an error code,
+     * proves the connection is alive; only ERROR_CODE_DEFAULT (send failure) does not.
+     */
+    public interface Probe {
+        void send(@NonNull IRTSCallback callback);
+    }
+
+    /**
+     * Traffic that can stop while the network is unstable, e.g. polling or volume reports.
+     */
+    public interface Pausable {
+        void onPauseNonEssential();
+
+        void onResumeNonEssential();
+    }
+
+    private final RTSReconnectSupervisor mSupervisor;
+    private final Probe mProbe;
+    private final Scheduler mScheduler;
+    private final List<Pausable> mPausables = new CopyOnWriteArrayList<>();
+
+    private long mProbeTimeoutMs = DEFAULT_PROBE_TIMEOUT_MS;
+    private boolean mPaused;
+    // Bumped by every probe, replies of an older probe are ignored.
+    private int mProbeGeneration;
+    @Nullable
+    private Runnable mProbeTimeoutTask;
+
+    public RTSNetworkFailover(@NonNull RTSReconnectSupervisor supervisor, @NonNull Probe probe,
+                              @NonNull Scheduler scheduler) {
+        mSupervisor = supervisor;
+        mProbe = probe;
+        mScheduler = scheduler;
+        mSupervisor.addStateListener(this::onConnectionStateChanged);
+    }
+
+    public synchronized void setProbeTimeout(long probeTimeoutMs) {
+        mProbeTimeoutMs = probeTimeoutMs;
+    }
+
+    public void addPausable(@NonNull Pausable pausable) {
+        mPausables.add(pausable);
+        if (isPaused()) {
+            pausable.onPauseNonEssential();
+        }
+    }
+
+    public void removePausable(@NonNull Pausable pausable) {
+        mPausables.remove(pausable);
+    }
+
+    public synchronized boolean isPaused() {
+        return mPaused;
+    }
+
+    public void onNetworkLost() {
+        cancelProbe();
+        pause();
+        mSupervisor.setNetworkAvailable(false);
+        mSupervisor.onConnectionLost();
+    }
+
+    /**
+     * @param switched the default network changed, the old connection may be stale
+     */
+    public void onNetworkAvailable(boolean switched) {
+        mSupervisor.setNetworkAvailable(true);
+        int state = mSupervisor.getState();
+        if (state == RTSReconnectSupervisor.STATE_RECONNECTING) {
+            mSupervisor.retryNow();
+        } else if (state == RTSReconnectSupervisor.STATE_CONNECTED && switched) {
+            pause();
+            probe();
+        } else {
+            resume();
+        }
+    }
+
+    private void probe() {
+        final int generation;
+        final Runnable timeoutTask;
+        synchronized (this) {
+            generation = ++mProbeGeneration;
+            if (mProbeTimeoutTask != null) {
+                mScheduler.cancel(mProbeTimeoutTask);
+            }
+            timeoutTask = () -> onProbeResult(generation, false);
+            mProbeTimeoutTask = timeoutTask;
+            mScheduler.schedule(timeoutTask, mProbeTimeoutMs);
+        }
+        mProbe.send(new IRTSCallback() {
+            @Override
+            public void onSuccess(@Nullable String data) {
+                onProbeResult(generation, true);
+            }
+
+            @Override
+            public void onError(int errorCode, @Nullable String message) {
+                onProbeResult(generation, errorCode != RTSBaseClient.ERROR_CODE_DEFAULT);
+            }
+        });
+    }
+
+    private void onProbeResult(int generation, boolean alive) {
+        synchronized (this) {
+            if (generation != mProbeGeneration || mProbeTimeoutTask == null) {
+                return;
+            }
+            mScheduler.cancel(mProbeTimeoutTask);
+            mProbeTimeoutTask = null;
+        }
+        if (alive) {
+            resume();
+        } else {
+            mSupervisor.onConnectionLost();
+            mSupervisor.retryNow();
+        }
+    }
+
+    private synchronized void cancelProbe() {
+        mProbeGeneration++;
+        if (mProbeTimeoutTask != null) {
+            mScheduler.cancel(mProbeTimeoutTask);
+            mProbeTimeoutTask = null;
+        }
+    }
+
+    private void onConnectionStateChanged(int oldState, int newState, int attempt) {
+        if (newState == RTSReconnectSupervisor.STATE_CONNECTED) {
+            cancelProbe();
+            resume();
+        } else if (newState == RTSReconnectSupervisor.STATE_RECONNECTING && oldState != newState) {
+            pause();
+        }
+    }
+
+    private void pause() {
+        synchronized (this) {
+            if (mPaused) {
+                return;
+            }
+            mPaused = true;
+        }
+        for (Pausable pausable : mPausables) {
+            pausable.onPauseNonEssential();
+        }
+    }
+
+    private void resume() {
+        synchronized (this) {
+            if (!mPaused) {
+                return;
+            }
+            mPaused = false;
+        }
+        for (Pausable pausable : mPausables) {
+            pausable.onResumeNonEssential();
+        }
+    }
+}
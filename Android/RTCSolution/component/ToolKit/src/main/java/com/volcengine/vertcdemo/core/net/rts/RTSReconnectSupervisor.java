@@ -0,0 +1,416 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import androidx.annotation.IntDef;
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.google.gson.JsonElement;
+import com.google.gson.JsonObject;
+import com.volcengine.vertcdemo.common.Scheduler;
+
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.util.ArrayDeque;
+import java.util.Collection;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Random;
+import java.util.Set;
+import java.util.concurrent.CopyOnWriteArrayList;
+
+/**
+ * Keeps the RTS login alive.
+ *
+ * When the connection is lost the login + setServerParams handshake is retried with
+ * jittered exponential backoff. Idempotent requests issued meanwhile are queued and
+ * replayed once connected again, other requests fail fast and are never sent twice
+ * while the same one is still in flight.
+ *
+ * Does not touch the SDK or any Android API itself, see {@link Handshake},
+ * {@link Scheduler} and {@link Replayer}. Listeners and the replayer are never called while
+ * the supervisor holds its lock: calls are queued in order and run once it is released.
+ */
+public class RTSReconnectSupervisor {
+
+    /*** 未登录 */
+    public static final int STATE_IDLE = 0;
+    /*** 已登录且业务服务器参数设置完成 */
+    public static final int STATE_CONNECTED = 1;
+    /*** 连接断开，正在退避重连 */
+    public static final int STATE_RECONNECTING = 2;
+    /*** 重连次数用尽 */
+    public static final int STATE_FAILED = 3;
+
+    @IntDef({STATE_IDLE, STATE_CONNECTED, STATE_RECONNECTING, STATE_FAILED})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface State {
+    }
+
+    public static final long DEFAULT_BASE_DELAY_MS = 500;
+    public static final long DEFAULT_MAX_DELAY_MS = 30_000;
+    public static final int DEFAULT_MAX_ATTEMPTS = 10;
+    public static final long DEFAULT_HANDSHAKE_TIMEOUT_MS = 10_000;
+    public static final int MAX_REPLAY_QUEUE = 64;
+
+    /**
+     * Re-runs login + setServerParams, the result is reported through
+     * {@link #onConnected()} or {@link #onHandshakeFailed(int)}.
+     */
+    public interface Handshake {
+        void start();
+    }
+
+    public interface Replayer {
+        /**
+         * Send a queued request again.
+         */
+        void replay(@NonNull Call call);
+
+        /**
+         * Give up on a queued request.
+         */
+        void fail(@NonNull Call call, int code, @NonNull String message);
+    }
+
+    public interface StateListener {
+        /**
+         * @param attempt reconnect attempts made so far, 0 when connected
+         */
+        void onStateChanged(@State int oldState, @State int newState, int attempt);
+    }
+
+    /**
+     * A request as issued by the business layer, before the wire request id and login token are
+     * added.
+     */
+    public static final class Call {
+        public final String eventName;
+        public final String roomId;
+        public final JsonObject content;
+        @Nullable
+        public final IRTSCallback callback;
+        /**
+         * Identifies the same business request: the request_id the caller put into the content,
+         * so a deliberate repeat (lock, unlock, lock) is a new request. Without one, the content.
+         */
+        public final String key;
+
+        public Call(String eventName, String roomId, @Nullable JsonObject content, @Nullable IRTSCallback callback) {
+            this.eventName = eventName;
+            this.roomId = roomId;
+            this.content = content == null ? new JsonObject() : content;
+            this.callback = callback;
+            JsonElement requestId = this.content.get("request_id");
+            if (requestId != null && requestId.isJsonPrimitive() && !requestId.getAsString().isEmpty()) {
+                this.key = eventName + '|' + roomId + "|request_id:" + requestId.getAsString();
+            } else {
+                JsonObject keyContent = this.content.deepCopy();
+                keyContent.remove("login_token");
+                this.key = eventName + '|' + roomId + '|' + keyContent;
+            }
+        }
+    }
+
+    private final Handshake mHandshake;
+    private final Scheduler mScheduler;
+    private final Replayer mReplayer;
+    private final Random mRandom;
+    private final List<StateListener> mListeners = new CopyOnWriteArrayList<>();
+
+    private final Set<String> mIdempotentEvents = new HashSet<>();
+    private final ArrayDeque<Call> mReplayQueue = new ArrayDeque<>();
+    private final Set<String> mInFlightKeys = new HashSet<>();
+
+    private long mBaseDelayMs = DEFAULT_BASE_DELAY_MS;
+    private long mMaxDelayMs = DEFAULT_MAX_DELAY_MS;
+    private int mMaxAttempts = DEFAULT_MAX_ATTEMPTS;
+    private long mHandshakeTimeoutMs = DEFAULT_HANDSHAKE_TIMEOUT_MS;
+
+    @State
+    private int mState = STATE_IDLE;
+    private int mAttempt;
+    private boolean mHandshakeRunning;
+    private boolean mNetworkAvailable = true;
+
+    // State notifications, replays and failed calls, queued under the lock and run outside it.
+    private final ArrayDeque<Runnable> mDeliveries = new ArrayDeque<>();
+    private boolean mDelivering;
+
+    private final Runnable mRetryTask = this::startAttempt;
+    private final Runnable mTimeoutTask = () -> onHandshakeFailed(RTSBaseClient.ERROR_CODE_DEFAULT);
+
+    public RTSReconnectSupervisor(@NonNull Handshake handshake, @NonNull Scheduler scheduler,
+                                  @NonNull Replayer replayer, @NonNull Random random) {
+        mHandshake = handshake;
+        mScheduler = scheduler;
+        mReplayer = replayer;
+        mRandom = random;
+    }
+
+    public synchronized void setBackoff(long baseDelayMs, long maxDelayMs, int maxAttempts, long handshakeTimeoutMs) {
+        mBaseDelayMs = baseDelayMs;
+        mMaxDelayMs = maxDelayMs;
+        mMaxAttempts = maxAttempts;
+        mHandshakeTimeoutMs = handshakeTimeoutMs;
+    }
+
+    /**
+     * Requests that can safely be sent more than once: queries and absolute state updates.
+     */
+    public synchronized void setIdempotentEvents(@NonNull Collection<String> events) {
+        mIdempotentEvents.clear();
+        mIdempotentEvents.addAll(events);
+    }
+
+    public synchronized boolean isIdempotent(String eventName) {
+        return mIdempotentEvents.contains(eventName);
+    }
+
+    public void addStateListener(@NonNull StateListener listener) {
+        mListeners.add(listener);
+    }
+
+    public void removeStateListener(@NonNull StateListener listener) {
+        mListeners.remove(listener);
+    }
+
+    @State
+    public synchronized int getState() {
+        return mState;
+    }
+
+    public synchronized int getAttempt() {
+        return mAttempt;
+    }
+
+    /**
+     * Delay before the given attempt (1 based): half fixed, half random, capped.
+     */
+    public synchronized long backoffDelay(int attempt) {
+        long delay = mBaseDelayMs << Math.min(attempt - 1, 20);
+        if (delay <= 0 || delay > mMaxDelayMs) {
+            delay = mMaxDelayMs;
+        }
+        long half = delay / 2;
+        return half + (long) (mRandom.nextDouble() * (delay - half));
+    }
+
+    /**
+     * The handshake completed, either the first login or a reconnect.
+     */
+    public void onConnected() {
+        synchronized (this) {
+            mScheduler.cancel(mTimeoutTask);
+            mScheduler.cancel(mRetryTask);
+            mHandshakeRunning = false;
+            setState(STATE_CONNECTED, 0);
+            for (Call call : mReplayQueue) {
+                mDeliveries.addLast(() -> mReplayer.replay(call));
+            }
+            mReplayQueue.clear();
+        }
+        deliver();
+    }
+
+    /**
+     * The server can no longer be reached, start reconnecting unless already doing so.
+     */
+    public void onConnectionLost() {
+        synchronized (this) {
+            if (mState == STATE_RECONNECTING || mState == STATE_IDLE) {
+                return;
+            }
+            // Responses of requests sent before the loss may never come, do not block retries on them.
+            mInFlightKeys.clear();
+            setState(STATE_RECONNECTING, 0);
+            scheduleNextAttempt();
+        }
+        deliver();
+    }
+
+    public void onHandshakeFailed(int code) {
+        synchronized (this) {
+            if (mState != STATE_RECONNECTING || !mHandshakeRunning) {
+                return;
+            }
+            mHandshakeRunning = false;
+            mScheduler.cancel(mTimeoutTask);
+            scheduleNextAttempt();
+        }
+        deliver();
+    }
+
+    /**
+     * While the device has no network no attempt is made, so the attempt budget is not spent
+     * on handshakes that can not succeed.
+     */
+    public synchronized void setNetworkAvailable(boolean available) {
+        mNetworkAvailable = available;
+        if (!available) {
+            mScheduler.cancel(mRetryTask);
+        }
+    }
+
+    /**
+     * Skip the remaining backoff and try now with a fresh attempt budget, used when the
+     * network came back or changed.
+     */
+    public synchronized void retryNow() {
+        if (mState != STATE_RECONNECTING || mHandshakeRunning || !mNetworkAvailable) {
+            return;
+        }
+        mScheduler.cancel(mRetryTask);
+        mAttempt = 0;
+        mScheduler.schedule(mRetryTask, 0);
+    }
+
+    /**
+     * Logged out on purpose: stop retrying and fail everything queued.
+     */
+    public void stop() {
+        synchronized (this) {
+            mScheduler.cancel(mRetryTask);
+            mScheduler.cancel(mTimeoutTask);
+            mHandshakeRunning = false;
+            mInFlightKeys.clear();
+            setState(STATE_IDLE, 0);
+            failQueued("rts logout");
+        }
+        deliver();
+    }
+
+    /**
+     * Queue an idempotent request until the connection is back.
+     *
+     * @return false if the request has to be failed instead
+     */
+    public boolean enqueue(@NonNull Call call) {
+        synchronized (this) {
+            if (mState != STATE_RECONNECTING || !mIdempotentEvents.contains(call.eventName)) {
+                return false;
+            }
+            if (mReplayQueue.size() >= MAX_REPLAY_QUEUE) {
+                Call evicted = mReplayQueue.pollFirst();
+                mDeliveries.addLast(() -> mReplayer.fail(evicted, RTSBaseClient.ERROR_CODE_DEFAULT,
+                        "rts replay queue full"));
+            }
+            mReplayQueue.addLast(call);
+        }
+        deliver();
+        return true;
+    }
+
+    /**
+     * Mark a request as sent. Non idempotent requests are refused while the same one, see
+     * {@link Call#key}, is in flight.
+     *
+     * @return false if the request is a duplicate and must not be sent
+     */
+    public synchronized boolean begin(@NonNull Call call) {
+        if (mIdempotentEvents.contains(call.eventName)) {
+            return true;
+        }
+        return mInFlightKeys.add(call.key);
+    }
+
+    /**
+     * The request got its response or failed.
+     */
+    public synchronized void end(@NonNull Call call) {
+        if (!mIdempotentEvents.contains(call.eventName)) {
+            mInFlightKeys.remove(call.key);
+        }
+    }
+
+    public synchronized int getReplayQueueSize() {
+        return mReplayQueue.size();
+    }
+
+    private void scheduleNextAttempt() {
+        if (mAttempt >= mMaxAttempts) {
+            setState(STATE_FAILED, mAttempt);
+            failQueued("rts reconnect failed");
+            return;
+        }
+        if (!mNetworkAvailable) {
+            // retryNow() picks up again once the network is back
+            return;
+        }
+        mScheduler.schedule(mRetryTask, backoffDelay(mAttempt + 1));
+    }
+
+    private void startAttempt() {
+        synchronized (this) {
+            if (mState != STATE_RECONNECTING) {
+                return;
+            }
+            mAttempt++;
+            mHandshakeRunning = true;
+            mScheduler.schedule(mTimeoutTask, mHandshakeTimeoutMs);
+            notifyState(STATE_RECONNECTING, STATE_RECONNECTING, mAttempt);
+        }
+        deliver();
+        mHandshake.start();
+    }
+
+    private void setState(@State int state, int attempt) {
+        int old = mState;
+        mState = state;
+        mAttempt = attempt;
+        if (old != state) {
+            notifyState(old, state, attempt);
+        }
+    }
+
+    private void notifyState(@State int oldState, @State int newState, int attempt) {
+        mDeliveries.addLast(() -> {
+            for (StateListener listener : mListeners) {
+                listener.onStateChanged(oldState, newState, attempt);
+            }
+        });
+    }
+
+    private void failQueued(@NonNull String message) {
+        for (Call call : mReplayQueue) {
+            mDeliveries.addLast(() -> mReplayer.fail(call, RTSBaseClient.ERROR_CODE_DEFAULT, message));
+        }
+        mReplayQueue.clear();
+    }
+
+    /**
+     * Run the queued deliveries without holding the lock. One thread drains at a time so they
+     * keep their order, calls made from a listener are run after it returns.
+     */
+    private void deliver() {
+        synchronized (this) {
+            if (mDelivering) {
+                return;
+            }
+            mDelivering = true;
+        }
+        boolean drained = false;
+        try {
+            while (true) {
+                Runnable delivery;
+                synchronized (this) {
+                    delivery = mDeliveries.pollFirst();
+                    if (delivery == null) {
+                        mDelivering = false;
+                        drained = true;
+                        return;
+                    }
+                }
+                delivery.run();
+            }
+        } finally {
+            if (!drained) {
+                synchronized (this) {
+                    mDelivering = false;
+                }
+            }
+        }
+    }
+}
@@ -6,6 +6,7 @@ package com.volcengine.vertcdemo.core.net.rts;
 import androidx.annotation.Nullable;
 
 import com.volcengine.vertcdemo.common.GsonUtils;
+import com.volcengine.vertcdemo.common.MainThreadWatchdog;
 import com.volcengine.vertcdemo.core.net.IRequestCallback;
 
 /**
@@ -29,6 +30,11 @@ public final class RTSRequest<T extends RTSBizResponse> implements IRTSCallback
      */
     public Class<T> resultClass;
 
+    /**
+     * 请求入队时间，取自 RTSLatencyTracer#now，小于 0 表示未记录
+     */
+    public long enqueuedAtMs = -1;
+
     public RTSRequest(String eventName, @Nullable IRequestCallback<T> callback, Class<T> resultClass) {
         this.eventName = eventName;
         this.callback = callback;
@@ -39,17 +45,28 @@ public final class RTSRequest<T extends RTSBizResponse> implements IRTSCallback
         if (data == null || callback == null) {
             return;
         }
-        if (resultClass == null) {
-            callback.onSuccess(null);
-            return;
+        // 解析和回调卡住主线程时按请求名统计
+        final String previous = MainThreadWatchdog.enter(eventName);
+        try {
+            if (resultClass == null) {
+                callback.onSuccess(null);
+                return;
+            }
+            T result = GsonUtils.gson().fromJson(data, resultClass);
+            callback.onSuccess(result);
+        } finally {
+            MainThreadWatchdog.exit(previous);
         }
-        T result = GsonUtils.gson().fromJson(data, resultClass);
-        callback.onSuccess(result);
     }
 
     public void onError(int errorCode, @Nullable String message) {
         if (callback != null) {
-            callback.onError(errorCode, message);
+            final String previous = MainThreadWatchdog.enter(eventName);
+            try {
+                callback.onError(errorCode, message);
+            } finally {
+                MainThreadWatchdog.exit(previous);
+            }
         }
     }
 }
@@ -0,0 +1,99 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import androidx.annotation.NonNull;
+
+import java.util.ArrayDeque;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.concurrent.Executor;
+
+/**
+ * Runs tasks in the order they came per key, e.g. the requests of one room, while different keys
+ * run in parallel on the shared executor.
+ *
+ * A lane is a queue drained by one executor task at a time, it holds no thread while empty and
+ * is dropped once drained. A busy lane gives its thread back every {@link #MAX_BATCH} tasks so
+ * other lanes are not starved when the executor is small.
+ */
+public class RTSSerialLanes {
+
+    static final int MAX_BATCH = 32;
+
+    private final Executor mExecutor;
+    // Guards the lanes and their queues.
+    private final Map<String, Lane> mLanes = new HashMap<>();
+
+    public RTSSerialLanes(@NonNull Executor executor) {
+        mExecutor = executor;
+    }
+
+    /**
+     * Run the task after every task given before for the same key.
+     */
+    public void execute(@NonNull String key, @NonNull Runnable task) {
+        Lane lane;
+        boolean start;
+        synchronized (mLanes) {
+            lane = mLanes.get(key);
+            if (lane == null) {
+                lane = new Lane(key);
+                mLanes.put(key, lane);
+            }
+            lane.mTasks.add(task);
+            start = !lane.mScheduled;
+            lane.mScheduled = true;
+        }
+        if (start) {
+            mExecutor.execute(lane);
+        }
+    }
+
+    /**
+     * @return keys with tasks queued or running
+     */
+    public int getLaneCount() {
+        synchronized (mLanes) {
+            return mLanes.size();
+        }
+    }
+
+    private class Lane implements Runnable {
+        final String mKey;
+        final ArrayDeque<Runnable> mTasks = new ArrayDeque<>();
+        // Whether the lane is queued on or running in the executor.
+        boolean mScheduled;
+
+        Lane(String key) {
+            mKey = key;
+        }
+
+        @Override
+        public void run() {
+            for (int i = 0; i < MAX_BATCH; i++) {
+                Runnable task;
+                synchronized (mLanes) {
+                    task = mTasks.poll();
+                    if (task == null) {
+                        mScheduled = false;
+                        mLanes.remove(mKey);
+                        return;
+                    }
+                }
+                boolean done = false;
+                try {
+                    task.run();
+                    done = true;
+                } finally {
+                    if (!done) {
+                        // The executor sees the exception, the rest of the lane still runs.
+                        mExecutor.execute(this);
+                    }
+                }
+            }
+            mExecutor.execute(this);
+        }
+    }
+}
@@ -0,0 +1,424 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.google.gson.JsonElement;
+import com.google.gson.JsonParser;
+import com.google.gson.JsonPrimitive;
+import com.volcengine.vertcdemo.common.Clock;
+
+import java.io.BufferedOutputStream;
+import java.io.Closeable;
+import java.io.EOFException;
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+import java.util.concurrent.Executor;
+
+/**
+ * Writes the RTS messages of a session, sent and received, into a compact append-only log so the
+ * session can be replayed offline with {@link RTSSessionReplayer}.
+ *
+ * The log starts with {@link #MAGIC} and the wall clock time of the start. Every record is one
+ * kind byte, the ms since the previous record, for received messages the uid, and the message;
+ * numbers are varints and strings are UTF-8 with a varint length of at most
+ * {@link #MAX_STRING_BYTES}.
+ *
+ * Records are encoded on the thread of the message and written on the writer executor, the
+ * records that came in meanwhile in one write and one flush. A process killed mid-write loses
+ * the records not written yet, {@link #read(InputStream)} stops before a cut record. Records are
+ * dropped while more than {@link #MAX_PENDING_BYTES} wait for the writer.
+ *
+ * Credentials, e.g. the login_token of every request and the RTC tokens of the answers, are
+ * replaced with {@link #MASK} before a message is recorded, also inside the JSON strings of
+ * content, response and data. Replayed requests carry the live client's own.
+ *
+ * Write errors stop the recording, they are never passed to the client.
+ */
+public class RTSSessionRecorder implements RTSBaseClient.MessageObserver, Closeable {
+
+    static final byte[] MAGIC = {'R', 'T', 'S', 'L', 1};
+    static final int KIND_OUTBOUND = 0;
+    static final int KIND_INBOUND = 1;
+    /*** Sessions kept by {@link #open(File, Clock)}, the oldest are deleted */
+    static final int MAX_FILES = 5;
+    static final String FILE_SUFFIX = ".rtslog";
+    /*** Longest uid or message, far above what RTS sends; longer ones are not recorded */
+    static final int MAX_STRING_BYTES = 1 << 20;
+    static final int MAX_PENDING_BYTES = 4 << 20;
+    static final String MASK = "***";
+    /*** Keys whose values are never written to the log */
+    private static final Set<String> CREDENTIAL_KEYS = new HashSet<>(Arrays.asList(
+            "login_token", "rtc_token", "rtm_token", "token", "server_signature"));
+
+    public static final class Entry {
+        public final boolean inbound;
+        /*** Since the start of the session */
+        public final long atMs;
+        /*** Sender of a received message, null for sent ones */
+        @Nullable
+        public final String uid;
+        @NonNull
+        public final String message;
+
+        public Entry(boolean inbound, long atMs, @Nullable String uid, @NonNull String message) {
+            this.inbound = inbound;
+            this.atMs = atMs;
+            this.uid = uid;
+            this.message = message;
+        }
+    }
+
+    private final Clock mClock;
+    private final Executor mWriter;
+    // Only used on the writer, null once closed or failed.
+    @Nullable
+    private OutputStream mOut;
+    // Guarded by this.
+    private boolean mRecording = true;
+    private boolean mDrainScheduled;
+    private long mLastMs;
+    private long mCount;
+    private long mDropped;
+    // Guarded by this. Records waiting for the writer, swapped with mSpare on every write.
+    private byte[] mBuffer = new byte[4096];
+    private int mLength;
+    private int mPendingCount;
+    @Nullable
+    private byte[] mSpare = new byte[4096];
+
+    /**
+     * @param clock  time of the records, e.g. SystemClock::elapsedRealtime
+     * @param writer runs the writes one at a time, e.g. AppExecutors.diskIO()
+     */
+    public RTSSessionRecorder(@NonNull OutputStream out, @NonNull Clock clock, @NonNull Executor writer) {
+        mOut = out;
+        mClock = clock;
+        mWriter = writer;
+        mLastMs = clock.now();
+        System.arraycopy(MAGIC, 0, mBuffer, 0, MAGIC.length);
+        mLength = MAGIC.length;
+        writeVarLong(System.currentTimeMillis());
+        mDrainScheduled = true;
+        writer.execute(this::drain);
+    }
+
+    /**
+     * A new log in the directory, named by the start time. Only the newest {@link #MAX_FILES}
+     * logs are kept.
+     */
+    @NonNull
+    public static RTSSessionRecorder open(@NonNull File dir, @NonNull Clock clock, @NonNull Executor writer)
+            throws IOException {
+        if (!dir.isDirectory() && !dir.mkdirs()) {
+            throw new IOException("can't create " + dir);
+        }
+        File[] logs = dir.listFiles((parent, name) -> name.endsWith(FILE_SUFFIX));
+        if (logs != null && logs.length >= MAX_FILES) {
+            Arrays.sort(logs, (a, b) -> Long.compare(a.lastModified(), b.lastModified()));
+            for (int i = 0; i <= logs.length - MAX_FILES; i++) {
+                //noinspection ResultOfMethodCallIgnored
+                logs[i].delete();
+            }
+        }
+        String name = String.valueOf(System.currentTimeMillis());
+        File file = new File(dir, name + FILE_SUFFIX);
+        for (int i = 1; file.exists(); i++) {
+            file = new File(dir, name + "_" + i + FILE_SUFFIX);
+        }
+        return new RTSSessionRecorder(new BufferedOutputStream(new FileOutputStream(file)), clock, writer);
+    }
+
+    @Override
+    public void onOutbound(@NonNull String message) {
+        append(KIND_OUTBOUND, null, mask(message));
+    }
+
+    @Override
+    public void onInbound(@Nullable String uid, @NonNull String message) {
+        append(KIND_INBOUND, uid == null ? "" : uid, mask(message));
+    }
+
+    /*** Records written so far */
+    public synchronized long getCount() {
+        return mCount;
+    }
+
+    /*** Records not written, too long or while the writer was behind */
+    public synchronized long getDroppedCount() {
+        return mDropped;
+    }
+
+    public synchronized boolean isRecording() {
+        return mRecording;
+    }
+
+    /**
+     * Stop recording. The records so far are written and the stream closed on the writer.
+     */
+    @Override
+    public void close() {
+        synchronized (this) {
+            if (!mRecording) {
+                return;
+            }
+            mRecording = false;
+        }
+        mWriter.execute(() -> {
+            drain();
+            closeStream();
+        });
+    }
+
+    /**
+     * @return every complete record of the log, a truncated last record is left out
+     * @throws IOException if the stream is not a session log
+     */
+    @NonNull
+    public static List<Entry> read(@NonNull InputStream in) throws IOException {
+        byte[] magic = new byte[MAGIC.length];
+        for (int i = 0; i < magic.length; i++) {
+            int b = in.read();
+            if (b < 0) {
+                throw new IOException("not an RTS session log");
+            }
+            magic[i] = (byte) b;
+        }
+        if (!Arrays.equals(magic, MAGIC)) {
+            throw new IOException("not an RTS session log");
+        }
+        List<Entry> entries = new ArrayList<>();
+        try {
+            readVarLong(in);
+            long atMs = 0;
+            while (true) {
+                int kind = in.read();
+                if (kind < 0) {
+                    break;
+                }
+                atMs += readVarLong(in);
+                String uid = kind == KIND_INBOUND ? readString(in) : null;
+                String message = readString(in);
+                entries.add(new Entry(kind == KIND_INBOUND, atMs, uid, message));
+            }
+        } catch (EOFException e) {
+            // Killed mid-write, the last record is incomplete.
+        }
+        return entries;
+    }
+
+    /**
+     * @return the message with every credential replaced by {@link #MASK}, the message itself if
+     * it has none
+     */
+    @NonNull
+    static String mask(@NonNull String message) {
+        if (!message.contains("token") && !message.contains("signature")) {
+            return message;
+        }
+        JsonElement json = parse(message);
+        if (json == null || !maskIn(json)) {
+            return message;
+        }
+        return json.toString();
+    }
+
+    /**
+     * @return whether anything was masked
+     */
+    private static boolean maskIn(JsonElement json) {
+        boolean masked = false;
+        if (json.isJsonObject()) {
+            for (Map.Entry<String, JsonElement> entry : json.getAsJsonObject().entrySet()) {
+                JsonElement value = entry.getValue();
+                if (CREDENTIAL_KEYS.contains(entry.getKey()) && !value.isJsonNull()) {
+                    entry.setValue(new JsonPrimitive(MASK));
+                    masked = true;
+                } else if (value.isJsonPrimitive() && value.getAsJsonPrimitive().isString()) {
+                    // content, response and data are JSON in a string
+                    String text = value.getAsString();
+                    JsonElement nested = text.startsWith("{") || text.startsWith("[") ? parse(text) : null;
+                    if (nested != null && maskIn(nested)) {
+                        entry.setValue(new JsonPrimitive(nested.toString()));
+                        masked = true;
+                    }
+                } else if (maskIn(value)) {
+                    masked = true;
+                }
+            }
+        } else if (json.isJsonArray()) {
+            for (JsonElement element : json.getAsJsonArray()) {
+                masked |= maskIn(element);
+            }
+        }
+        return masked;
+    }
+
+    @Nullable
+    private static JsonElement parse(String text) {
+        try {
+            JsonElement json = new JsonParser().parse(text);
+            return json.isJsonObject() || json.isJsonArray() ? json : null;
+        } catch (RuntimeException e) {
+            return null;
+        }
+    }
+
+    private void append(int kind, @Nullable String uid, @NonNull String message) {
+        byte[] uidBytes = uid == null ? null : uid.getBytes(StandardCharsets.UTF_8);
+        byte[] messageBytes = message.getBytes(StandardCharsets.UTF_8);
+        synchronized (this) {
+            if (!mRecording) {
+                return;
+            }
+            if (messageBytes.length > MAX_STRING_BYTES || (uidBytes != null && uidBytes.length > MAX_STRING_BYTES)
+                    || mLength > MAX_PENDING_BYTES) {
+                mDropped++;
+                return;
+            }
+            long now = mClock.now();
+            ensure(1);
+            mBuffer[mLength++] = (byte) kind;
+            writeVarLong(Math.max(0, now - mLastMs));
+            mLastMs = Math.max(mLastMs, now);
+            if (uidBytes != null) {
+                writeString(uidBytes);
+            }
+            writeString(messageBytes);
+            mPendingCount++;
+            if (mDrainScheduled) {
+                return;
+            }
+            mDrainScheduled = true;
+        }
+        mWriter.execute(this::drain);
+    }
+
+    /**
+     * On the writer: writes what is pending until nothing is.
+     */
+    private void drain() {
+        while (true) {
+            byte[] chunk;
+            int length;
+            int count;
+            synchronized (this) {
+                if (mLength == 0 || mSpare == null) {
+                    mDrainScheduled = false;
+                    return;
+                }
+                chunk = mBuffer;
+                length = mLength;
+                count = mPendingCount;
+                mBuffer = mSpare;
+                mSpare = null;
+                mLength = 0;
+                mPendingCount = 0;
+            }
+            boolean written = write(chunk, length);
+            synchronized (this) {
+                mSpare = chunk;
+                if (written) {
+                    mCount += count;
+                } else {
+                    mDropped += count + mPendingCount;
+                    mRecording = false;
+                    mLength = 0;
+                    mPendingCount = 0;
+                }
+            }
+        }
+    }
+
+    private boolean write(byte[] chunk, int length) {
+        if (mOut == null) {
+            return false;
+        }
+        try {
+            mOut.write(chunk, 0, length);
+            mOut.flush();
+            return true;
+        } catch (IOException e) {
+            closeStream();
+            return false;
+        }
+    }
+
+    private void closeStream() {
+        if (mOut == null) {
+            return;
+        }
+        try {
+            mOut.close();
+        } catch (IOException ignored) {
+        }
+        mOut = null;
+    }
+
+    private void writeString(byte[] bytes) {
+        writeVarLong(bytes.length);
+        ensure(bytes.length);
+        System.arraycopy(bytes, 0, mBuffer, mLength, bytes.length);
+        mLength += bytes.length;
+    }
+
+    private void writeVarLong(long value) {
+        ensure(10);
+        while ((value & ~0x7FL) != 0) {
+            mBuffer[mLength++] = (byte) ((value & 0x7F) | 0x80);
+            value >>>= 7;
+        }
+        mBuffer[mLength++] = (byte) value;
+    }
+
+    private void ensure(int extra) {
+        if (mLength + extra > mBuffer.length) {
+            mBuffer = Arrays.copyOf(mBuffer, Math.max(mBuffer.length * 2, mLength + extra));
+        }
+    }
+
+    private static long readVarLong(InputStream in) throws IOException {
+        long value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int b = in.read();
+            if (b < 0) {
+                throw new EOFException();
+            }
+            value |= (long) (b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw new IOException("varint too long");
+    }
+
+    private static String readString(InputStream in) throws IOException {
+        long length = readVarLong(in);
+        if (length > MAX_STRING_BYTES) {
+            throw new IOException("not an RTS session log, string of " + length + " bytes");
+        }
+        byte[] bytes = new byte[(int) length];
+        int read = 0;
+        while (read < bytes.length) {
+            int n = in.read(bytes, read, bytes.length - read);
+            if (n < 0) {
+                throw new EOFException();
+            }
+            read += n;
+        }
+        return new String(bytes, StandardCharsets.UTF_8);
+    }
+}
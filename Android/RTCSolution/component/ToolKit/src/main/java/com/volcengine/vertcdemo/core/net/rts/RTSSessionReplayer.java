@@ -0,0 +1,240 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.google.gson.JsonElement;
+import com.google.gson.JsonObject;
+import com.google.gson.JsonParser;
+import com.volcengine.vertcdemo.common.Scheduler;
+import com.volcengine.vertcdemo.core.net.ServerResponse;
+
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Plays the received messages of a log written by {@link RTSSessionRecorder} into a client, e.g.
+ * {@link RTSBaseClient#onMessageReceived(String, String)}, at the recorded pace, faster, or back to
+ * back.
+ *
+ * Answers only reach the client if it sent the request again: set the replayer as the
+ * {@link RTSBaseClient.MessageObserver} of the client, every request it sends is paired with the
+ * next recorded request of the same event_name, and the recorded request_id in the answer is
+ * replaced with the new one.
+ *
+ * Call on the thread of the scheduler, {@link #onOutbound(String)} may come on any thread.
+ */
+public class RTSSessionReplayer implements RTSBaseClient.MessageObserver {
+
+    /*** Speed that delivers every message right away, without the scheduler */
+    public static final double MAX_SPEED = 0;
+
+    public interface Target {
+        void onMessageReceived(@Nullable String uid, @NonNull String message);
+    }
+
+    private static final class Inbound {
+        final long atMs;
+        final String uid;
+        final String message;
+        // Of an answer, null for notifications.
+        @Nullable
+        final String requestId;
+
+        Inbound(long atMs, String uid, String message, @Nullable String requestId) {
+            this.atMs = atMs;
+            this.uid = uid;
+            this.message = message;
+            this.requestId = requestId;
+        }
+    }
+
+    private final List<Inbound> mInbound = new ArrayList<>();
+    // Guarded by this. event_name -> recorded request ids not paired yet, in order.
+    private final Map<String, ArrayDeque<String>> mRecordedRequests = new HashMap<>();
+    // Guarded by this. Recorded request id -> request id of the client.
+    private final Map<String, String> mLiveRequestIds = new HashMap<>();
+    private final Target mTarget;
+    private final Scheduler mScheduler;
+    private final Runnable mDeliverNext = this::deliverNext;
+
+    private int mNext;
+    private double mSpeed;
+    private boolean mPlaying;
+    @Nullable
+    private Runnable mOnDone;
+
+    private int mDelivered;
+    private int mUnpairedAnswers;
+    private int mUnpairedRequests;
+
+    public RTSSessionReplayer(@NonNull List<RTSSessionRecorder.Entry> entries, @NonNull Target target,
+                              @NonNull Scheduler scheduler) {
+        mTarget = target;
+        mScheduler = scheduler;
+        for (RTSSessionRecorder.Entry entry : entries) {
+            JsonObject json = parse(entry.message);
+            if (!entry.inbound) {
+                String eventName = string(json, "event_name");
+                String requestId = string(json, "request_id");
+                if (eventName != null && requestId != null) {
+                    ArrayDeque<String> requests = mRecordedRequests.get(eventName);
+                    if (requests == null) {
+                        requests = new ArrayDeque<>();
+                        mRecordedRequests.put(eventName, requests);
+                    }
+                    requests.add(requestId);
+                }
+                continue;
+            }
+            String requestId = ServerResponse.MESSAGE_TYPE_RETURN.equals(string(json, "message_type"))
+                    ? string(json, "request_id") : null;
+            mInbound.add(new Inbound(entry.atMs, entry.uid, entry.message, requestId));
+        }
+    }
+
+    /**
+     * @param speed  1 for the recorded pace, 2 for twice as fast, {@link #MAX_SPEED} for back to back
+     * @param onDone after the last message, or right away if there is none
+     */
+    public void play(double speed, @Nullable Runnable onDone) {
+        stop();
+        mSpeed = speed;
+        mOnDone = onDone;
+        mPlaying = true;
+        if (speed <= MAX_SPEED) {
+            while (mPlaying && mNext < mInbound.size()) {
+                deliver(mInbound.get(mNext++));
+            }
+            finish();
+            return;
+        }
+        scheduleNext(mNext == 0 ? 0 : mInbound.get(mNext - 1).atMs);
+    }
+
+    /**
+     * Pause, {@link #play(double, Runnable)} goes on from the next message.
+     */
+    public void stop() {
+        mPlaying = false;
+        mScheduler.cancel(mDeliverNext);
+    }
+
+    public boolean isDone() {
+        return mNext >= mInbound.size();
+    }
+
+    /*** Received messages in the log */
+    public int getInboundCount() {
+        return mInbound.size();
+    }
+
+    public int getDeliveredCount() {
+        return mDelivered;
+    }
+
+    /*** Answers delivered for requests the client did not send again */
+    public int getUnpairedAnswerCount() {
+        return mUnpairedAnswers;
+    }
+
+    /*** Requests the client sent that are not in the log */
+    public synchronized int getUnpairedRequestCount() {
+        return mUnpairedRequests;
+    }
+
+    @Override
+    public void onOutbound(@NonNull String message) {
+        JsonObject json = parse(message);
+        String eventName = string(json, "event_name");
+        String requestId = string(json, "request_id");
+        synchronized (this) {
+            ArrayDeque<String> recorded = eventName == null ? null : mRecordedRequests.get(eventName);
+            if (requestId == null || recorded == null || recorded.isEmpty()) {
+                mUnpairedRequests++;
+                return;
+            }
+            mLiveRequestIds.put(recorded.poll(), requestId);
+        }
+    }
+
+    @Override
+    public void onInbound(@Nullable String uid, @NonNull String message) {
+    }
+
+    private void deliverNext() {
+        if (!mPlaying || isDone()) {
+            return;
+        }
+        Inbound inbound = mInbound.get(mNext++);
+        deliver(inbound);
+        if (isDone()) {
+            finish();
+        } else {
+            scheduleNext(inbound.atMs);
+        }
+    }
+
+    private void scheduleNext(long previousAtMs) {
+        if (isDone()) {
+            finish();
+            return;
+        }
+        long gapMs = Math.max(0, mInbound.get(mNext).atMs - previousAtMs);
+        mScheduler.schedule(mDeliverNext, Math.round(gapMs / mSpeed));
+    }
+
+    private void deliver(Inbound inbound) {
+        String message = inbound.message;
+        if (inbound.requestId != null) {
+            String live;
+            synchronized (this) {
+                live = mLiveRequestIds.remove(inbound.requestId);
+            }
+            if (live == null) {
+                mUnpairedAnswers++;
+            } else {
+                message = message.replace(inbound.requestId, live);
+            }
+        }
+        mDelivered++;
+        mTarget.onMessageReceived(inbound.uid, message);
+    }
+
+    private void finish() {
+        if (!mPlaying) {
+            return;
+        }
+        mPlaying = false;
+        Runnable onDone = mOnDone;
+        mOnDone = null;
+        if (onDone != null) {
+            onDone.run();
+        }
+    }
+
+    @Nullable
+    private static JsonObject parse(String message) {
+        try {
+            JsonElement element = new JsonParser().parse(message);
+            return element.isJsonObject() ? element.getAsJsonObject() : null;
+        } catch (RuntimeException e) {
+            return null;
+        }
+    }
+
+    @Nullable
+    private static String string(@Nullable JsonObject json, String key) {
+        if (json == null) {
+            return null;
+        }
+        JsonElement element = json.get(key);
+        return element != null && element.isJsonPrimitive() ? element.getAsString() : null;
+    }
+}
@@ -0,0 +1,29 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import androidx.annotation.NonNull;
+
+/**
+ * The link between {@link RTSBaseClient} and the business server, the RTC SDK in the app
+ * ({@link RTCVideoTransport}), a local stand-in server in tests.
+ *
+ * Results are reported the way the SDK reports them, to {@link RTSBaseClient#onLoginResult},
+ * {@link RTSBaseClient#onServerParamsSetResult}, {@link RTSBaseClient#onServerMessageSendResult}
+ * and {@link RTSBaseClient#onMessageReceived}.
+ */
+public interface RTSTransport {
+
+    void login(@NonNull String token, @NonNull String userId);
+
+    void logout();
+
+    void setServerParams(@NonNull String signature, @NonNull String url);
+
+    /**
+     * @return id of the message in {@link RTSBaseClient#onServerMessageSendResult}, or
+     * {@link RTSBaseClient#ERROR_CODE_DEFAULT} if it was not sent
+     */
+    long sendServerMessage(@NonNull String message);
+}
@@ -0,0 +1,358 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.utils;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.google.gson.JsonParseException;
+import com.volcengine.vertcdemo.common.GsonUtils;
+
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.InputStreamReader;
+import java.io.OutputStreamWriter;
+import java.io.Reader;
+import java.io.Writer;
+import java.nio.charset.StandardCharsets;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * Assets extracted to disk once per app version, for SDKs that only open file paths.
+ *
+ * Every extracted file is written next to its place and renamed over it when complete, and its
+ * size and SHA-256 go into a manifest. A file is checked against the manifest the first time it
+ * is asked for in a process, not at startup; a missing, cut or changed file is extracted again,
+ * and so is everything when the manifest is unreadable or from another app version.
+ *
+ * Blocking, call off the main thread. Safe to call from several threads.
+ */
+public class AssetCache {
+
+    /*** Layout of the manifest file, bumped when it changes */
+    public static final int MANIFEST_VERSION = 1;
+    static final String MANIFEST_NAME = ".asset_manifest.json";
+    private static final String PART_SUFFIX = ".part";
+    private static final int BUFFER_SIZE = 256 * 1024;
+
+    /**
+     * Where assets come from, the AssetManager in the app.
+     */
+    public interface Source {
+        /**
+         * @return names under a folder, empty for a file
+         */
+        @NonNull
+        String[] list(@NonNull String path) throws IOException;
+
+        @NonNull
+        InputStream open(@NonNull String path) throws IOException;
+    }
+
+    static class Manifest {
+        int version;
+        String appVersion;
+        Map<String, Entry> files;
+    }
+
+    static class Entry {
+        long size;
+        String sha256;
+
+        Entry(long size, String sha256) {
+            this.size = size;
+            this.sha256 = sha256;
+        }
+    }
+
+    private final Source mSource;
+    private final File mRoot;
+    private final String mAppVersion;
+    private final int mThreads;
+    private final ConcurrentHashMap<String, Object> mLocks = new ConcurrentHashMap<>();
+    private final Set<String> mVerified = Collections.newSetFromMap(new ConcurrentHashMap<>());
+    private final AtomicInteger mExtractedCount = new AtomicInteger();
+    private final AtomicInteger mRecoveredCount = new AtomicInteger();
+    @Nullable
+    private volatile Map<String, Entry> mEntries;
+
+    /**
+     * @param root       folder the assets are extracted into, keeping their paths
+     * @param appVersion anything that changes with the assets, e.g. version and install time
+     * @param threads    files extracted at the same time by {@link #getFolder(String)}
+     */
+    public AssetCache(@NonNull Source source, @NonNull File root, @NonNull String appVersion, int threads) {
+        mSource = source;
+        mRoot = root;
+        mAppVersion = appVersion;
+        mThreads = Math.max(1, threads);
+    }
+
+    @NonNull
+    public File getRoot() {
+        return mRoot;
+    }
+
+    /**
+     * @return the extracted, verified file, null if the asset can not be read
+     */
+    @Nullable
+    public File getFile(@NonNull String assetPath) {
+        File file = resolve(assetPath);
+        if (file != null) {
+            saveManifest();
+        }
+        return file;
+    }
+
+    /**
+     * Extract every file under an asset folder, several at a time.
+     *
+     * @return the extracted folder, null if any file can not be read
+     */
+    @Nullable
+    public File getFolder(@NonNull String assetDir) {
+        List<String> paths = new ArrayList<>();
+        try {
+            collect(assetDir, paths);
+        } catch (IOException e) {
+            return null;
+        }
+        boolean complete = true;
+        if (paths.size() == 1 || mThreads == 1) {
+            for (String path : paths) {
+                complete &= resolve(path) != null;
+            }
+        } else {
+            ExecutorService executor = Executors.newFixedThreadPool(Math.min(mThreads, paths.size()));
+            try {
+                List<Future<File>> futures = new ArrayList<>();
+                for (String path : paths) {
+                    futures.add(executor.submit(() -> resolve(path)));
+                }
+                for (Future<File> future : futures) {
+                    complete &= future.get() != null;
+                }
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+                complete = false;
+            } catch (ExecutionException e) {
+                complete = false;
+            } finally {
+                executor.shutdownNow();
+            }
+        }
+        saveManifest();
+        return complete ? new File(mRoot, assetDir) : null;
+    }
+
+    /*** Files written by this instance */
+    public int getExtractedCount() {
+        return mExtractedCount.get();
+    }
+
+    /*** Files found cut or changed on disk and written again */
+    public int getRecoveredCount() {
+        return mRecoveredCount.get();
+    }
+
+    @Nullable
+    private File resolve(@NonNull String assetPath) {
+        synchronized (lockOf(assetPath)) {
+            File file = new File(mRoot, assetPath);
+            if (mVerified.contains(assetPath) && file.isFile()) {
+                return file;
+            }
+            Map<String, Entry> entries = entries();
+            Entry entry = entries.get(assetPath);
+            if (entry != null) {
+                if (matches(file, entry)) {
+                    mVerified.add(assetPath);
+                    return file;
+                }
+                mRecoveredCount.incrementAndGet();
+            }
+            try {
+                entries.put(assetPath, extract(assetPath, file));
+                mExtractedCount.incrementAndGet();
+                mVerified.add(assetPath);
+                return file;
+            } catch (IOException e) {
+                entries.remove(assetPath);
+                return null;
+            }
+        }
+    }
+
+    @NonNull
+    private Entry extract(@NonNull String assetPath, @NonNull File file) throws IOException {
+        File dir = file.getParentFile();
+        if (dir != null && !dir.isDirectory() && !dir.mkdirs() && !dir.isDirectory()) {
+            throw new IOException("can not create " + dir);
+        }
+        File part = new File(file.getPath() + PART_SUFFIX);
+        MessageDigest digest = sha256();
+        long size = 0;
+        try (InputStream in = mSource.open(assetPath); FileOutputStream out = new FileOutputStream(part)) {
+            byte[] buffer = new byte[BUFFER_SIZE];
+            int length;
+            while ((length = in.read(buffer)) != -1) {
+                digest.update(buffer, 0, length);
+                out.write(buffer, 0, length);
+                size += length;
+            }
+            out.getFD().sync();
+        } catch (IOException e) {
+            //noinspection ResultOfMethodCallIgnored
+            part.delete();
+            throw e;
+        }
+        if (!part.renameTo(file)) {
+            //noinspection ResultOfMethodCallIgnored
+            part.delete();
+            throw new IOException("can not rename " + part);
+        }
+        return new Entry(size, toHex(digest.digest()));
+    }
+
+    private static boolean matches(@NonNull File file, @NonNull Entry entry) {
+        if (!file.isFile() || file.length() != entry.size || entry.sha256 == null) {
+            return false;
+        }
+        MessageDigest digest = sha256();
+        try (InputStream in = new FileInputStream(file)) {
+            byte[] buffer = new byte[BUFFER_SIZE];
+            int length;
+            while ((length = in.read(buffer)) != -1) {
+                digest.update(buffer, 0, length);
+            }
+        } catch (IOException e) {
+            return false;
+        }
+        return entry.sha256.equals(toHex(digest.digest()));
+    }
+
+    private void collect(@NonNull String path, @NonNull List<String> out) throws IOException {
+        String[] names = mSource.list(path);
+        if (names.length == 0) {
+            out.add(path);
+            return;
+        }
+        for (String name : names) {
+            collect(path.isEmpty() ? name : path + "/" + name, out);
+        }
+    }
+
+    @NonNull
+    private Map<String, Entry> entries() {
+        Map<String, Entry> entries = mEntries;
+        if (entries == null) {
+            synchronized (this) {
+                entries = mEntries;
+                if (entries == null) {
+                    entries = loadManifest();
+                    mEntries = entries;
+                }
+            }
+        }
+        return entries;
+    }
+
+    /**
+     * @return the files of a readable manifest of this app version, empty otherwise
+     */
+    @NonNull
+    private Map<String, Entry> loadManifest() {
+        Map<String, Entry> entries = new ConcurrentHashMap<>();
+        File file = new File(mRoot, MANIFEST_NAME);
+        if (!file.isFile()) {
+            return entries;
+        }
+        try (Reader reader = new InputStreamReader(new FileInputStream(file), StandardCharsets.UTF_8)) {
+            Manifest manifest = GsonUtils.gson().fromJson(reader, Manifest.class);
+            if (manifest == null || manifest.version != MANIFEST_VERSION
+                    || !mAppVersion.equals(manifest.appVersion) || manifest.files == null) {
+                return entries;
+            }
+            for (Map.Entry<String, Entry> entry : manifest.files.entrySet()) {
+                if (entry.getKey() != null && entry.getValue() != null) {
+                    entries.put(entry.getKey(), entry.getValue());
+                }
+            }
+        } catch (IOException | JsonParseException e) {
+            entries.clear();
+        }
+        return entries;
+    }
+
+    private synchronized void saveManifest() {
+        Map<String, Entry> entries = mEntries;
+        if (entries == null || (!mRoot.isDirectory() && !mRoot.mkdirs())) {
+            return;
+        }
+        Manifest manifest = new Manifest();
+        manifest.version = MANIFEST_VERSION;
+        manifest.appVersion = mAppVersion;
+        manifest.files = new HashMap<>(entries);
+        File file = new File(mRoot, MANIFEST_NAME);
+        File part = new File(file.getPath() + PART_SUFFIX);
+        try (FileOutputStream out = new FileOutputStream(part)) {
+            Writer writer = new OutputStreamWriter(out, StandardCharsets.UTF_8);
+            GsonUtils.gson().toJson(manifest, writer);
+            writer.flush();
+            out.getFD().sync();
+        } catch (IOException e) {
+            //noinspection ResultOfMethodCallIgnored
+            part.delete();
+            return;
+        }
+        if (!part.renameTo(file)) {
+            //noinspection ResultOfMethodCallIgnored
+            part.delete();
+        }
+    }
+
+    @NonNull
+    private Object lockOf(@NonNull String assetPath) {
+        Object lock = new Object();
+        Object existing = mLocks.putIfAbsent(assetPath, lock);
+        return existing != null ? existing : lock;
+    }
+
+    @NonNull
+    private static MessageDigest sha256() {
+        try {
+            return MessageDigest.getInstance("SHA-256");
+        } catch (NoSuchAlgorithmException e) {
+            throw new IllegalStateException(e);
+        }
+    }
+
+    @NonNull
+    private static String toHex(@NonNull byte[] bytes) {
+        char[] digits = "0123456789abcdef".toCharArray();
+        char[] chars = new char[bytes.length * 2];
+        for (int i = 0; i < bytes.length; i++) {
+            chars[i * 2] = digits[(bytes[i] >> 4) & 0xF];
+            chars[i * 2 + 1] = digits[bytes[i] & 0xF];
+        }
+        return new String(chars);
+    }
+}
@@ -4,6 +4,8 @@
 package com.volcengine.vertcdemo.utils;
 
 import android.content.Context;
+import android.content.pm.PackageInfo;
+import android.content.pm.PackageManager;
 import android.content.res.AssetManager;
 import android.util.Log;
 
@@ -13,10 +15,58 @@ import java.io.File;
 import java.io.FileOutputStream;
 import java.io.IOException;
 import java.io.InputStream;
-import java.io.OutputStream;
 
 public class FileUtils {
     private static final String TAG = "FileUtils";
+    private static final int COPY_BUFFER_SIZE = 256 * 1024;
+
+    private static volatile AssetCache sAssetCache;
+
+    /**
+     * Assets extracted under the external files dir once per app version, see {@link AssetCache}.
+     */
+    @NonNull
+    public static AssetCache getAssetCache(@NonNull Context context) {
+        if (sAssetCache == null) {
+            synchronized (FileUtils.class) {
+                if (sAssetCache == null) {
+                    Context appContext = context.getApplicationContext();
+                    AssetManager assets = appContext.getAssets();
+                    File dir = appContext.getExternalFilesDir("assets");
+                    if (dir == null) {
+                        dir = new File(appContext.getFilesDir(), "assets");
+                    }
+                    AssetCache.Source source = new AssetCache.Source() {
+                        @NonNull
+                        @Override
+                        public String[] list(@NonNull String path) throws IOException {
+                            String[] names = assets.list(path);
+                            return names == null ? new String[0] : names;
+                        }
+
+                        @NonNull
+                        @Override
+                        public InputStream open(@NonNull String path) throws IOException {
+                            return assets.open(path, AssetManager.ACCESS_STREAMING);
+                        }
+                    };
+                    sAssetCache = new AssetCache(source, new File(dir, "resource"), getInstallVersion(appContext),
+                            Math.min(4, Runtime.getRuntime().availableProcessors()));
+                }
+            }
+        }
+        return sAssetCache;
+    }
+
+    @NonNull
+    private static String getInstallVersion(@NonNull Context context) {
+        try {
+            PackageInfo info = context.getPackageManager().getPackageInfo(context.getPackageName(), 0);
+            return info.versionName + "/" + info.lastUpdateTime;
+        } catch (PackageManager.NameNotFoundException e) {
+            return "";
+        }
+    }
 
     public static boolean copyAssetFolder(Context context, String srcName, String dstName) {
         try {
@@ -40,18 +90,33 @@ public class FileUtils {
         }
     }
 
+    /**
+     * Copy an asset as is. The destination only appears once complete, a copy cut short by a
+     * killed process leaves nothing behind to be taken for the asset.
+     */
     public static boolean copyAssetFile(@NonNull Context context, @NonNull String srcName, @NonNull String dstName) {
         AssetManager assetManager = context.getAssets();
-        try (InputStream in = assetManager.open(srcName); OutputStream out = new FileOutputStream(dstName)) {
-            byte[] buffer = new byte[4096];
+        File part = new File(dstName + ".part");
+        try (InputStream in = assetManager.open(srcName, AssetManager.ACCESS_STREAMING);
+             FileOutputStream out = new FileOutputStream(part)) {
+            byte[] buffer = new byte[COPY_BUFFER_SIZE];
             int len;
             while ((len = in.read(buffer)) != -1) {
                 out.write(buffer, 0, len);
             }
-            return true;
+            out.getFD().sync();
         } catch (IOException e) {
             Log.d(TAG, "copyAssetFile failed srcName:" + srcName + ",msg:" + e.getLocalizedMessage());
+            //noinspection ResultOfMethodCallIgnored
+            part.delete();
+            return false;
+        }
+        if (!part.renameTo(new File(dstName))) {
+            Log.d(TAG, "copyAssetFile failed to rename " + part);
+            //noinspection ResultOfMethodCallIgnored
+            part.delete();
             return false;
         }
+        return true;
     }
 }
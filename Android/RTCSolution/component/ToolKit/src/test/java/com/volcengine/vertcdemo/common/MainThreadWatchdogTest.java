@@ -0,0 +1,192 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.common;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Stall detection on a thread standing in for the main looper, and attribution on a fake clock.
+ */
+public class MainThreadWatchdogTest {
+
+    private static final long THRESHOLD_MS = 100;
+    private static final long BLOCK_MS = 350;
+
+    @Test
+    public void syntheticBlockingTasksAreDetected() throws Exception {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        ExecutorService single = Executors.newSingleThreadExecutor();
+        List<Runnable> tasks = new ArrayList<>();
+        List<String> reports = Collections.synchronizedList(new ArrayList<>());
+        Thread watched = startLooper(single);
+        MainThreadWatchdog watchdog = new MainThreadWatchdog(() -> System.nanoTime() / 1_000_000, watched,
+                THRESHOLD_MS, reports::add);
+        watchdog.start();
+
+        for (int i = 0; i < 20; i++) {
+            tasks.add(() -> {
+            });
+        }
+        tasks.add(() -> {
+            String previous = watchdog.label("viJoinLiveRoom");
+            decodeSlowly();
+            watchdog.label(previous);
+        });
+        tasks.add(this::refreshListSlowly);
+        for (int i = 0; i < 20; i++) {
+            tasks.add(() -> {
+            });
+        }
+        for (Runnable task : tasks) {
+            single.execute(() -> {
+                watchdog.onDispatchStart("Handler (android.os.Handler) {1a2b} null: 0");
+                try {
+                    task.run();
+                } finally {
+                    watchdog.onDispatchEnd();
+                }
+            });
+        }
+        single.shutdown();
+        assertTrue(single.awaitTermination(10, TimeUnit.SECONDS));
+        watchdog.stop();
+
+        assertEquals(tasks.size(), watchdog.getDispatchCount());
+        assertEquals(2, watchdog.getStalls().size());
+        assertEquals(2, reports.size());
+
+        MainThreadWatchdog.Stall join = find(watchdog, "viJoinLiveRoom");
+        assertNotNull(join);
+        assertEquals(1, join.count);
+        assertTrue(join.maxMs >= BLOCK_MS);
+        assertTrue("stack sampled inside the stall", contains(join.stack, "decodeSlowly"));
+
+        MainThreadWatchdog.Stall refresh = null;
+        for (MainThreadWatchdog.Stall stall : watchdog.getStalls()) {
+            if (stall.kind.startsWith("MainThreadWatchdogTest.refreshListSlowly")) {
+                refresh = stall;
+            }
+        }
+        assertNotNull("unnamed stalls go by the first frame of the app", refresh);
+        assertTrue(contains(refresh.stack, "refreshListSlowly"));
+        System.out.println(watchdog.getReport());
+    }
+
+    @Test
+    public void stallsAreAddedUpByKind() {
+        long[] now = new long[1];
+        List<String> reports = new ArrayList<>();
+        MainThreadWatchdog watchdog = new MainThreadWatchdog(() -> now[0], Thread.currentThread(), 200, reports::add);
+
+        // Short messages, one of them longer than a frame.
+        for (int i = 0; i < 10; i++) {
+            watchdog.onDispatchStart("Handler (android.os.Handler) {1a2b} null: 0");
+            now[0] += i == 0 ? 40 : 2;
+            watchdog.onDispatchEnd();
+        }
+        assertEquals(10, watchdog.getDispatchCount());
+        assertEquals(1, watchdog.getJankCount());
+
+        // Not sampled before the threshold, then sampled at the request decoding.
+        for (int i = 0; i < 2; i++) {
+            watchdog.onDispatchStart("Handler (android.os.Handler) {1a2b} null: 0");
+            String previous = watchdog.label("viReplyInvite");
+            now[0] += 50;
+            assertEquals(150, watchdog.sampleOnce());
+            now[0] += 200 + i * 100;
+            assertEquals(100, watchdog.sampleOnce());
+            watchdog.label(previous);
+            now[0] += 10;
+            watchdog.onDispatchEnd();
+        }
+        MainThreadWatchdog.Stall reply = find(watchdog, "viReplyInvite");
+        assertNotNull(reply);
+        assertEquals(2, reply.count);
+        assertEquals(260 + 360, reply.totalMs);
+        assertEquals(360, reply.maxMs);
+        assertTrue(contains(reply.stack, "stallsAreAddedUpByKind"));
+
+        // Nothing named and no sample: the handler of the message.
+        watchdog.onLooperLog(">>>>> Dispatching to Handler (android.view.Choreographer$FrameHandler) {5c9d2b1} "
+                + "android.view.Choreographer$FrameDisplayEventReceiver@8f2e1: 0");
+        now[0] += 500;
+        watchdog.onLooperLog("<<<<< Finished to Handler (android.view.Choreographer$FrameHandler) {5c9d2b1} "
+                + "android.view.Choreographer$FrameDisplayEventReceiver@8f2e1");
+        assertNotNull(find(watchdog,
+                "Handler (android.view.Choreographer$FrameHandler) android.view.Choreographer$FrameDisplayEventReceiver"));
+
+        assertEquals(3, reports.size());
+        assertEquals("longest in total first", "viReplyInvite", watchdog.getStalls().get(0).kind);
+        assertEquals(3, watchdog.getReport().split("\n").length);
+    }
+
+    @Test
+    public void kindsAreCapped() {
+        long[] now = new long[1];
+        MainThreadWatchdog watchdog = new MainThreadWatchdog(() -> now[0], Thread.currentThread(), 200, line -> {
+        });
+        for (int i = 0; i < MainThreadWatchdog.MAX_KINDS + 10; i++) {
+            watchdog.onDispatchStart(null);
+            watchdog.label("viEvent" + i);
+            now[0] += 300;
+            watchdog.onDispatchEnd();
+        }
+        assertEquals(MainThreadWatchdog.MAX_KINDS + 1, watchdog.getStalls().size());
+        MainThreadWatchdog.Stall other = find(watchdog, MainThreadWatchdog.OTHER_KIND);
+        assertNotNull(other);
+        assertEquals(10, other.count);
+    }
+
+    private static Thread startLooper(ExecutorService looper) throws Exception {
+        Callable<Thread> current = Thread::currentThread;
+        return looper.submit(current).get();
+    }
+
+    private static void decodeSlowly() {
+        try {
+            Thread.sleep(BLOCK_MS);
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        }
+    }
+
+    private void refreshListSlowly() {
+        try {
+            Thread.sleep(BLOCK_MS);
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        }
+    }
+
+    private static MainThreadWatchdog.Stall find(MainThreadWatchdog watchdog, String kind) {
+        for (MainThreadWatchdog.Stall stall : watchdog.getStalls()) {
+            if (stall.kind.equals(kind)) {
+                return stall;
+            }
+        }
+        return null;
+    }
+
+    private static boolean contains(StackTraceElement[] stack, String method) {
+        for (StackTraceElement frame : stack) {
+            if (frame.getMethodName().contains(method)) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
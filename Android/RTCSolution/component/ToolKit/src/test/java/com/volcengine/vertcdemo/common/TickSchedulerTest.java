@@ -0,0 +1,248 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.common;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import android.app.Activity;
+import android.content.Context;
+import android.view.View;
+import android.widget.FrameLayout;
+
+import androidx.annotation.NonNull;
+
+import org.junit.Test;
+import org.junit.runner.RunWith;
+import org.robolectric.Robolectric;
+import org.robolectric.RobolectricTestRunner;
+
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * Tick scheduling, coalescing and pausing on a virtual clock.
+ */
+@RunWith(RobolectricTestRunner.class)
+public class TickSchedulerTest {
+
+    /**
+     * Virtual clock waking one task at a time, counting wakeups like a frame callback would.
+     */
+    private static class VirtualWaker implements Scheduler, Clock {
+        long now;
+        Runnable task;
+        long at;
+
+        @Override
+        public void schedule(@NonNull Runnable task, long delayMs) {
+            assertTrue("one wakeup armed at a time", this.task == null);
+            this.task = task;
+            this.at = now + delayMs;
+        }
+
+        @Override
+        public void cancel(@NonNull Runnable task) {
+            if (this.task == task) {
+                this.task = null;
+            }
+        }
+
+        @Override
+        public long now() {
+            return now;
+        }
+
+        void runUntil(long time) {
+            while (task != null && at <= time) {
+                Runnable run = task;
+                now = at;
+                task = null;
+                run.run();
+            }
+            now = time;
+        }
+    }
+
+    @Test
+    public void periodicAndOneShotTasksRunOnTime() {
+        VirtualWaker waker = new VirtualWaker();
+        TickScheduler scheduler = new TickScheduler(waker, waker);
+        List<Long> periodic = new ArrayList<>();
+        List<Long> once = new ArrayList<>();
+
+        TickScheduler.Task task = scheduler.schedulePeriodic(1_000, () -> periodic.add(waker.now));
+        TickScheduler.Task timeout = scheduler.scheduleOnce(2_500, () -> once.add(waker.now));
+        waker.runUntil(5_500);
+
+        assertEquals(5, periodic.size());
+        for (int i = 0; i < periodic.size(); i++) {
+            long due = (i + 1) * 1_000L;
+            assertTrue(periodic.get(i) >= due && periodic.get(i) <= due + 100);
+        }
+        assertEquals(1, once.size());
+        assertEquals(2_500, (long) once.get(0));
+        assertFalse(timeout.isActive());
+        assertTrue(task.isActive());
+
+        task.cancel();
+        waker.runUntil(20_000);
+        assertEquals(5, periodic.size());
+        assertEquals(0, scheduler.getTaskCount());
+        assertTrue("nothing armed once every task is gone", waker.task == null);
+    }
+
+    @Test
+    public void tasksCloseTogetherShareAWakeup() {
+        VirtualWaker waker = new VirtualWaker();
+        TickScheduler scheduler = new TickScheduler(waker, waker);
+        int[] runs = new int[3];
+
+        scheduler.schedulePeriodic(1_000, () -> runs[0]++);
+        waker.runUntil(40);
+        scheduler.schedulePeriodic(1_000, () -> runs[1]++);
+        waker.runUntil(70);
+        scheduler.schedulePeriodic(1_000, () -> runs[2]++);
+        waker.runUntil(10_100);
+
+        assertEquals(10, runs[0]);
+        assertEquals(10, runs[1]);
+        assertEquals(10, runs[2]);
+        assertEquals(30, scheduler.getRunCount());
+        assertEquals("three timers 70ms apart, one wakeup a tick", 10, scheduler.getWakeupCount());
+    }
+
+    @Test
+    public void pausedTasksCostNoWakeups() {
+        VirtualWaker waker = new VirtualWaker();
+        TickScheduler scheduler = new TickScheduler(waker, waker);
+        int[] runs = new int[1];
+        TickScheduler.Task task = scheduler.schedulePeriodic(600, () -> runs[0]++);
+        waker.runUntil(3_100);
+        assertEquals(5, runs[0]);
+
+        task.setPaused(true);
+        long wakeups = scheduler.getWakeupCount();
+        waker.runUntil(60_000);
+        assertEquals(wakeups, scheduler.getWakeupCount());
+        assertEquals(5, runs[0]);
+
+        task.setPaused(false);
+        waker.runUntil(60_000);
+        assertEquals("came due while paused, runs at once, missed ticks skipped", 6, runs[0]);
+        waker.runUntil(61_000);
+        assertEquals(7, runs[0]);
+    }
+
+    /**
+     * Keeps the attach listeners it holds.
+     */
+    private static class TrackingView extends View {
+        final List<OnAttachStateChangeListener> listeners = new ArrayList<>();
+
+        TrackingView(Context context) {
+            super(context);
+        }
+
+        @Override
+        public void addOnAttachStateChangeListener(OnAttachStateChangeListener listener) {
+            super.addOnAttachStateChangeListener(listener);
+            listeners.add(listener);
+        }
+
+        @Override
+        public void removeOnAttachStateChangeListener(OnAttachStateChangeListener listener) {
+            super.removeOnAttachStateChangeListener(listener);
+            listeners.remove(listener);
+        }
+    }
+
+    @Test
+    public void detachedViewPausesItsTask() {
+        VirtualWaker waker = new VirtualWaker();
+        TickScheduler scheduler = new TickScheduler(waker, waker);
+        Activity activity = Robolectric.buildActivity(Activity.class).setup().get();
+        FrameLayout root = new FrameLayout(activity);
+        activity.setContentView(root);
+        TrackingView view = new TrackingView(activity);
+        int[] runs = new int[1];
+
+        TickScheduler.Task task = scheduler.schedulePeriodic(1_000, () -> runs[0]++).pauseWhileDetached(view);
+        assertTrue("not attached yet", task.isPaused());
+        root.addView(view);
+        assertFalse(task.isPaused());
+        waker.runUntil(2_500);
+        assertEquals(2, runs[0]);
+
+        root.removeView(view);
+        assertTrue(task.isPaused());
+        long wakeups = scheduler.getWakeupCount();
+        waker.runUntil(30_000);
+        assertEquals(wakeups, scheduler.getWakeupCount());
+        assertEquals(2, runs[0]);
+
+        task.cancel();
+        assertTrue("the listener goes with the task", view.listeners.isEmpty());
+
+        TickScheduler.Task once = scheduler.scheduleOnce(1_000, () -> runs[0]++).pauseWhileDetached(view);
+        root.addView(view);
+        waker.runUntil(31_000);
+        assertEquals(3, runs[0]);
+        assertFalse(once.isActive());
+        assertTrue("and with a one-shot task once it ran", view.listeners.isEmpty());
+    }
+
+    @Test
+    public void tasksMayScheduleAndCancelFromTheirAction() {
+        VirtualWaker waker = new VirtualWaker();
+        TickScheduler scheduler = new TickScheduler(waker, waker);
+        List<String> ran = new ArrayList<>();
+        TickScheduler.Task[] other = new TickScheduler.Task[1];
+
+        scheduler.scheduleOnce(100, () -> {
+            ran.add("first");
+            other[0].cancel();
+            scheduler.scheduleOnce(0, () -> ran.add("scheduled by first"));
+        });
+        other[0] = scheduler.scheduleOnce(100, () -> ran.add("cancelled"));
+        waker.runUntil(1_000);
+
+        assertEquals(2, ran.size());
+        assertEquals("first", ran.get(0));
+        assertEquals("scheduled by first", ran.get(1));
+        assertEquals(0, scheduler.getTaskCount());
+    }
+
+    /**
+     * Periodic timers of the demo: seat volume 600ms, seat SEI 2s, room list 10s, and a 5s
+     * one-shot now and then. One scheduler against a timer each.
+     */
+    @Test
+    public void wakeupsPerSecond() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        VirtualWaker waker = new VirtualWaker();
+        TickScheduler scheduler = new TickScheduler(waker, waker);
+        scheduler.schedulePeriodic(600, () -> {
+        });
+        scheduler.schedulePeriodic(2_000, () -> {
+        });
+        scheduler.schedulePeriodic(10_000, () -> {
+        });
+        for (long at = 3_000; at < 60_000; at += 7_000) {
+            waker.runUntil(at);
+            scheduler.scheduleOnce(5_000, () -> {
+            }).setTolerance(100);
+        }
+        waker.runUntil(60_000);
+
+        long separate = scheduler.getRunCount();
+        assertTrue(scheduler.getWakeupCount() < separate);
+        float rate = scheduler.getWakeupsPerSecond();
+        assertTrue(String.valueOf(rate), rate > 1 && rate < 1000f / 600 + 1000f / 2_000 + 0.5f);
+        System.out.printf("demo timers over 60s: %d wakeups (%.2f/s) for %d runs%n",
+                scheduler.getWakeupCount(), rate, separate);
+    }
+}
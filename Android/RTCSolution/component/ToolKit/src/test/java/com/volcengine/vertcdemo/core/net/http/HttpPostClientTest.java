@@ -0,0 +1,289 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.http;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotSame;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import androidx.annotation.NonNull;
+
+import com.google.gson.Gson;
+import com.google.gson.JsonObject;
+import com.google.gson.JsonParser;
+import com.volcengine.vertcdemo.core.net.ServerResponse;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+import java.io.IOException;
+import java.io.StringReader;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import okhttp3.OkHttpClient;
+import okhttp3.mockwebserver.Dispatcher;
+import okhttp3.mockwebserver.MockResponse;
+import okhttp3.mockwebserver.MockWebServer;
+import okhttp3.mockwebserver.RecordedRequest;
+
+/**
+ * Runs the post client against a local mock server.
+ */
+public class HttpPostClientTest {
+
+    static class Room {
+        String room_id;
+        int audience_count;
+    }
+
+    static class RoomPage {
+        List<Room> rooms;
+    }
+
+    private final Gson mGson = new Gson();
+    private MockWebServer mServer;
+    private OkHttpClient mOkHttpClient;
+    private HttpPostClient mClient;
+
+    @Before
+    public void setUp() throws IOException {
+        mServer = new MockWebServer();
+        mServer.start();
+        mOkHttpClient = new OkHttpClient.Builder().build();
+        mClient = new HttpPostClient(mOkHttpClient, mGson);
+    }
+
+    @After
+    public void tearDown() throws IOException {
+        mServer.shutdown();
+        mOkHttpClient.dispatcher().executorService().shutdown();
+    }
+
+    @Test
+    public void identicalConcurrentPostsGoOutOnce() throws Exception {
+        CountDownLatch release = new CountDownLatch(1);
+        mServer.setDispatcher(new Dispatcher() {
+            @NonNull
+            @Override
+            public MockResponse dispatch(@NonNull RecordedRequest request) throws InterruptedException {
+                release.await(5, TimeUnit.SECONDS);
+                return new MockResponse().setBody(envelope(200, page(3)));
+            }
+        });
+        int callers = 10;
+        CountDownLatch done = new CountDownLatch(callers);
+        AtomicInteger rooms = new AtomicInteger();
+        for (int i = 0; i < callers; i++) {
+            mClient.post(url(), "{\"event_name\":\"viGetActiveLiveRoomList\"}", RoomPage.class, new Collector<RoomPage>(done) {
+                @Override
+                public void onResponse(@NonNull ServerResponse<RoomPage> response) {
+                    rooms.addAndGet(response.getData().rooms.size());
+                    super.onResponse(response);
+                }
+            });
+        }
+        release.countDown();
+
+        assertTrue(done.await(5, TimeUnit.SECONDS));
+        assertEquals(1, mServer.getRequestCount());
+        assertEquals(1, mClient.getSentCount());
+        assertEquals(callers - 1, mClient.getCoalescedCount());
+        assertEquals(callers * 3, rooms.get());
+    }
+
+    @Test
+    public void coalescedCallersGetOwnResultsAndOneObserverCall() throws Exception {
+        CountDownLatch release = new CountDownLatch(1);
+        mServer.setDispatcher(new Dispatcher() {
+            @NonNull
+            @Override
+            public MockResponse dispatch(@NonNull RecordedRequest request) throws InterruptedException {
+                release.await(5, TimeUnit.SECONDS);
+                return new MockResponse().setBody(envelope(401, page(1)));
+            }
+        });
+        AtomicInteger observed = new AtomicInteger();
+        mClient = new HttpPostClient(mOkHttpClient, mGson, response -> observed.incrementAndGet());
+        int callers = 4;
+        CountDownLatch done = new CountDownLatch(callers);
+        List<RoomPage> pages = new ArrayList<>();
+        for (int i = 0; i < callers; i++) {
+            mClient.post(url(), "{\"event_name\":\"viGetActiveLiveRoomList\"}", RoomPage.class, new Collector<RoomPage>(done) {
+                @Override
+                public void onResponse(@NonNull ServerResponse<RoomPage> response) {
+                    synchronized (pages) {
+                        pages.add(response.getData());
+                    }
+                    super.onResponse(response);
+                }
+            });
+        }
+        release.countDown();
+
+        assertTrue(done.await(5, TimeUnit.SECONDS));
+        assertEquals(1, mClient.getSentCount());
+        assertEquals("token expiry is handled once", 1, observed.get());
+        for (int i = 1; i < callers; i++) {
+            assertNotSame(pages.get(0), pages.get(i));
+            assertEquals(pages.get(0).rooms.get(0).room_id, pages.get(i).rooms.get(0).room_id);
+        }
+    }
+
+    @Test
+    public void differentBodiesAreNotCoalesced() throws Exception {
+        mServer.enqueue(new MockResponse().setBody(envelope(200, page(1))));
+        mServer.enqueue(new MockResponse().setBody(envelope(200, page(1))));
+        CountDownLatch done = new CountDownLatch(2);
+        mClient.post(url(), "{\"page\":1}", RoomPage.class, new Collector<>(done));
+        mClient.post(url(), "{\"page\":2}", RoomPage.class, new Collector<>(done));
+
+        assertTrue(done.await(5, TimeUnit.SECONDS));
+        assertEquals(2, mServer.getRequestCount());
+        assertEquals(0, mClient.getCoalescedCount());
+    }
+
+    @Test
+    public void sequentialPostsReuseTheConnection() throws Exception {
+        int posts = 5;
+        for (int i = 0; i < posts; i++) {
+            mServer.enqueue(new MockResponse().setBody(envelope(200, page(1))));
+        }
+        for (int i = 0; i < posts; i++) {
+            CountDownLatch done = new CountDownLatch(1);
+            mClient.post(url(), "{\"i\":" + i + "}", RoomPage.class, new Collector<>(done));
+            assertTrue(done.await(5, TimeUnit.SECONDS));
+        }
+        for (int i = 0; i < posts; i++) {
+            assertEquals("request " + i + " on the first connection", i, mServer.takeRequest().getSequenceNumber());
+        }
+    }
+
+    @Test
+    public void errorsReachEveryWaitingCaller() throws Exception {
+        mServer.enqueue(new MockResponse().setResponseCode(502));
+        mServer.enqueue(new MockResponse().setBody(envelope(450, "null")));
+        CountDownLatch failed = new CountDownLatch(1);
+        Collector<RoomPage> http = new Collector<>(failed);
+        mClient.post(url(), "{}", RoomPage.class, http);
+        assertTrue(failed.await(5, TimeUnit.SECONDS));
+        assertEquals(1, http.failures.size());
+
+        CountDownLatch answered = new CountDownLatch(1);
+        Collector<RoomPage> business = new Collector<>(answered);
+        mClient.post(url(), "{}", RoomPage.class, business);
+        assertTrue(answered.await(5, TimeUnit.SECONDS));
+        assertEquals(450, business.responses.get(0).getCode());
+        assertNull(business.responses.get(0).getData());
+    }
+
+    @Test
+    public void streamingParseMatchesTreeParse() throws IOException {
+        String json = envelope(200, page(50));
+        ServerResponse<RoomPage> streamed = HttpPostClient.parse(mGson, new StringReader(json), RoomPage.class);
+        RoomPage tree = treeParse(json);
+
+        assertEquals(200, streamed.getCode());
+        assertEquals("ok", streamed.getMsg());
+        assertEquals(1700000000000L, streamed.getTimestamp());
+        assertEquals(tree.rooms.size(), streamed.getData().rooms.size());
+        for (int i = 0; i < tree.rooms.size(); i++) {
+            assertEquals(tree.rooms.get(i).room_id, streamed.getData().rooms.get(i).room_id);
+            assertEquals(tree.rooms.get(i).audience_count, streamed.getData().rooms.get(i).audience_count);
+        }
+
+        ServerResponse<Void> empty = HttpPostClient.parse(mGson, new StringReader(envelope(200, "{}")), Void.class);
+        assertNull(empty.getData());
+    }
+
+    /**
+     * Compares the streaming parse against the old path: whole body as a string, parsed into
+     * a tree, "response" printed back to a string and parsed again.
+     */
+    @Test
+    public void benchmarkStreamingParseAgainstTreeParse() throws IOException {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        String json = envelope(200, page(200));
+        int rounds = 2_000;
+        for (int i = 0; i < 200; i++) {
+            HttpPostClient.parse(mGson, new StringReader(json), RoomPage.class);
+            treeParse(json);
+        }
+        long start = System.nanoTime();
+        int streamedRooms = 0;
+        for (int i = 0; i < rounds; i++) {
+            streamedRooms += HttpPostClient.parse(mGson, new StringReader(json), RoomPage.class).getData().rooms.size();
+        }
+        long streamedNs = System.nanoTime() - start;
+        start = System.nanoTime();
+        int treeRooms = 0;
+        for (int i = 0; i < rounds; i++) {
+            treeRooms += treeParse(json).rooms.size();
+        }
+        long treeNs = System.nanoTime() - start;
+        System.out.println("parse " + json.length() + " chars x" + rounds
+                + ": streaming " + streamedNs / rounds / 1000 + "us"
+                + ", tree " + treeNs / rounds / 1000 + "us");
+
+        assertEquals(treeRooms, streamedRooms);
+    }
+
+    private RoomPage treeParse(String json) {
+        JsonObject root = new JsonParser().parse(json).getAsJsonObject();
+        return mGson.fromJson(root.get("response").toString(), RoomPage.class);
+    }
+
+    private String url() {
+        return mServer.url("/login").toString();
+    }
+
+    private static String envelope(int code, String response) {
+        return "{\"code\":" + code + ",\"message\":\"ok\",\"timestamp\":1700000000000,\"response\":" + response + "}";
+    }
+
+    private static String page(int count) {
+        StringBuilder builder = new StringBuilder("{\"rooms\":[");
+        for (int i = 0; i < count; i++) {
+            if (i > 0) {
+                builder.append(',');
+            }
+            builder.append("{\"room_id\":\"room_").append(i)
+                    .append("\",\"audience_count\":").append(i * 7)
+                    .append(",\"extra\":{\"host\":\"user_").append(i).append("\"}}");
+        }
+        return builder.append("]}").toString();
+    }
+
+    private static class Collector<T> implements HttpPostClient.Listener<T> {
+        final List<ServerResponse<T>> responses = new ArrayList<>();
+        final List<IOException> failures = new ArrayList<>();
+        private final CountDownLatch mDone;
+
+        Collector(CountDownLatch done) {
+            mDone = done;
+        }
+
+        @Override
+        public void onResponse(@NonNull ServerResponse<T> response) {
+            synchronized (this) {
+                responses.add(response);
+            }
+            mDone.countDown();
+        }
+
+        @Override
+        public void onFailure(@NonNull IOException e) {
+            synchronized (this) {
+                failures.add(e);
+            }
+            mDone.countDown();
+        }
+    }
+}
@@ -0,0 +1,168 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import androidx.annotation.NonNull;
+
+import com.google.gson.JsonObject;
+import com.google.gson.JsonParser;
+import com.ss.bytertc.engine.type.LoginErrorCode;
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+import com.volcengine.vertcdemo.core.net.IRequestCallback;
+
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+import org.robolectric.RobolectricTestRunner;
+import org.robolectric.annotation.LooperMode;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * Request bookkeeping of the client: repeats, duplicates and answers that never come.
+ * Runs on the Robolectric main looper in LEGACY mode, callbacks posted to it run inline.
+ */
+@RunWith(RobolectricTestRunner.class)
+@LooperMode(LooperMode.Mode.LEGACY)
+public class RTSBaseClientTest {
+
+    private static final String CMD_LOCK = "viManageSeat";
+    private static final String ROOM = "room_1";
+
+    private static class Answer implements RTSBizResponse {
+    }
+
+    /**
+     * Logs in right away and keeps what was sent, answers only when told to.
+     */
+    private static class HeldTransport implements RTSTransport {
+        RTSBaseClient client;
+        final List<String> sent = new ArrayList<>();
+
+        @Override
+        public void login(@NonNull String token, @NonNull String userId) {
+            client.onLoginResult(userId, LoginErrorCode.LOGIN_ERROR_CODE_SUCCESS, 0);
+        }
+
+        @Override
+        public void logout() {
+        }
+
+        @Override
+        public void setServerParams(@NonNull String signature, @NonNull String url) {
+            client.onServerParamsSetResult(200);
+        }
+
+        @Override
+        public long sendServerMessage(@NonNull String message) {
+            sent.add(message);
+            return sent.size();
+        }
+
+        void answer(int index) {
+            JsonObject request = new JsonParser().parse(sent.get(index)).getAsJsonObject();
+            JsonObject answer = new JsonObject();
+            answer.addProperty("message_type", "return");
+            answer.addProperty("request_id", request.get("request_id").getAsString());
+            answer.addProperty("code", 200);
+            answer.addProperty("response", "{}");
+            client.onMessageReceived("server", answer.toString());
+        }
+    }
+
+    private final VirtualScheduler mScheduler = new VirtualScheduler();
+    private final HeldTransport mTransport = new HeldTransport();
+    private final List<String> mResults = new ArrayList<>();
+    private RTSBaseClient mClient;
+
+    @Before
+    public void setUp() {
+        mClient = new RTSBaseClient(mTransport, new RTSInfo("app", "rts_token", "server", "signature", "bid"),
+                mScheduler, mScheduler::now, new Random(1)) {
+            @Override
+            protected String getUserId() {
+                return "me";
+            }
+
+            @Override
+            protected String getLoginToken() {
+                return "login_token";
+            }
+
+            @Override
+            protected String getDeviceId() {
+                return "device";
+            }
+        };
+        mTransport.client = mClient;
+        mClient.login("rts_token", (code, message) -> assertEquals(message, RTSBaseClient.LoginCallBack.SUCCESS, code));
+        assertTrue(mClient.isLogin());
+    }
+
+    @Test
+    public void repeatsWithTheirOwnRequestIdAreSent() {
+        // Lock, unlock and lock again before the server answered the first lock.
+        send(CMD_LOCK, "lock_1", 1);
+        send(CMD_LOCK, "unlock_1", 2);
+        send(CMD_LOCK, "lock_2", 1);
+        assertEquals(3, mTransport.sent.size());
+
+        send(CMD_LOCK, "lock_1", 1);
+        assertEquals("the same request again is refused", 3, mTransport.sent.size());
+        assertEquals(Arrays.asList("lock_1 " + RTSBaseClient.ERROR_CODE_DUPLICATE_REQUEST), mResults);
+
+        mTransport.answer(0);
+        mTransport.answer(1);
+        mTransport.answer(2);
+        assertEquals(Arrays.asList("lock_1 " + RTSBaseClient.ERROR_CODE_DUPLICATE_REQUEST,
+                "lock_1 ok", "unlock_1 ok", "lock_2 ok"), mResults);
+    }
+
+    @Test
+    public void lostAnswerEndsTheCallOnTimeout() {
+        mClient.setRequestTimeout(5_000);
+        send(CMD_LOCK, "lock_1", 1);
+        mScheduler.runUntil(4_999);
+        assertTrue(mResults.isEmpty());
+        assertEquals(1, mClient.getLatencyTracer().getPendingCount());
+
+        mScheduler.runUntil(5_000);
+        assertEquals(Arrays.asList("lock_1 " + RTSBaseClient.ERROR_CODE_REQUEST_TIMEOUT), mResults);
+        assertEquals(0, mClient.getLatencyTracer().getPendingCount());
+
+        send(CMD_LOCK, "lock_1", 1);
+        assertEquals("sent again without waiting for a reconnect", 2, mTransport.sent.size());
+        mTransport.answer(0);
+        assertEquals("the late answer of the first send is ignored", 1, mResults.size());
+        mTransport.answer(1);
+        assertEquals("lock_1 ok", mResults.get(1));
+
+        mScheduler.runUntil(60_000);
+        assertEquals("answered calls do not time out", 2, mResults.size());
+    }
+
+    private void send(String eventName, String requestId, int seatId) {
+        JsonObject content = new JsonObject();
+        content.addProperty("room_id", ROOM);
+        content.addProperty("seat_id", seatId);
+        content.addProperty("request_id", requestId);
+        mClient.sendServerMessage(eventName, ROOM, content, Answer.class, new IRequestCallback<Answer>() {
+            @Override
+            public void onSuccess(Answer data) {
+                mResults.add(requestId + " ok");
+            }
+
+            @Override
+            public void onError(int errorCode, String message) {
+                mResults.add(requestId + " " + errorCode);
+            }
+        });
+    }
+}
@@ -0,0 +1,243 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * Request stages against a fake engine on a virtual clock, and histogram accuracy.
+ */
+public class RTSLatencyTracerTest {
+
+    private static final String CMD_JOIN = "viJoinLiveRoom";
+    private static final String CMD_REPLY = "viReplyInvite";
+    private static final String CMD_INVITE = "viInviteAnchor";
+
+    /**
+     * Plays the SDK and the business server: hands out message ids, reports the send result and
+     * delivers the answer after the given delays, the way RTSBaseClient reports them to the tracer.
+     */
+    private static class FakeEngine {
+        final VirtualScheduler scheduler;
+        final RTSLatencyTracer tracer;
+        long nextMessageId = 1;
+        int nextRequestId;
+
+        FakeEngine(VirtualScheduler scheduler) {
+            this.scheduler = scheduler;
+            this.tracer = new RTSLatencyTracer(scheduler::now);
+        }
+
+        /**
+         * @param sendResultMs negative to report the send result before onSent returns
+         * @param answerMs     negative for no answer
+         * @return the request id
+         */
+        String send(String eventName, long enqueuedAtMs, long sendResultMs, boolean sent, long answerMs, int code) {
+            String requestId = "request_" + nextRequestId++;
+            long messageId = nextMessageId++;
+            tracer.onSending(requestId, eventName, enqueuedAtMs);
+            if (sendResultMs < 0) {
+                tracer.onSendResult(messageId, sent);
+            } else {
+                scheduler.schedule(() -> tracer.onSendResult(messageId, sent), sendResultMs);
+            }
+            tracer.onSent(requestId, messageId);
+            if (sent && answerMs >= 0) {
+                scheduler.schedule(() -> tracer.onAnswer(requestId, code == 200), answerMs);
+            }
+            return requestId;
+        }
+    }
+
+    @Test
+    public void everyStageIsStamped() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        FakeEngine engine = new FakeEngine(scheduler);
+
+        long enqueuedAt = engine.tracer.now();
+        // Waits in its room's lane first.
+        scheduler.runUntil(30);
+        engine.send(CMD_JOIN, enqueuedAt, 8, true, 120, 200);
+        scheduler.runUntil(1_000);
+
+        assertEquals(30, percentile(engine.tracer, CMD_JOIN, RTSLatencyTracer.STAGE_QUEUE, 50));
+        assertEquals(8, percentile(engine.tracer, CMD_JOIN, RTSLatencyTracer.STAGE_SEND, 50));
+        assertEquals(120, percentile(engine.tracer, CMD_JOIN, RTSLatencyTracer.STAGE_ANSWER, 50));
+        assertEquals(150, percentile(engine.tracer, CMD_JOIN, RTSLatencyTracer.STAGE_TOTAL, 50));
+        assertEquals(0, engine.tracer.getPendingCount());
+        assertEquals(Arrays.asList(CMD_JOIN), engine.tracer.getEventNames());
+    }
+
+    @Test
+    public void sendResultAndAnswerInAnyOrder() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        FakeEngine engine = new FakeEngine(scheduler);
+
+        // The answer overtakes the send result.
+        engine.send(CMD_REPLY, -1, 200, true, 90, 200);
+        // The SDK reports before the sending thread got to onSent.
+        engine.send(CMD_INVITE, -1, -1, true, 60, 200);
+        scheduler.runUntil(1_000);
+
+        assertEquals(200, percentile(engine.tracer, CMD_REPLY, RTSLatencyTracer.STAGE_SEND, 50));
+        assertEquals(90, percentile(engine.tracer, CMD_REPLY, RTSLatencyTracer.STAGE_TOTAL, 50));
+        LatencyHistogram inviteSend = engine.tracer.getHistogram(CMD_INVITE, RTSLatencyTracer.STAGE_SEND);
+        assertNotNull(inviteSend);
+        assertEquals(1, inviteSend.getTotalCount());
+        assertEquals(60, percentile(engine.tracer, CMD_INVITE, RTSLatencyTracer.STAGE_ANSWER, 50));
+    }
+
+    @Test
+    public void answerBeforeTheSdkReturned() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        RTSLatencyTracer tracer = new RTSLatencyTracer(scheduler::now);
+
+        // The SDK thread gets the send result and the answer while sendServerMessage runs.
+        tracer.onSending("request_0", CMD_JOIN, -1);
+        scheduler.runUntil(40);
+        tracer.onSendResult(7, true);
+        tracer.onAnswer("request_0", true);
+        tracer.onSent("request_0", 7);
+
+        assertEquals(0, tracer.getPendingCount());
+        assertEquals(40, percentile(tracer, CMD_JOIN, RTSLatencyTracer.STAGE_ANSWER, 50));
+        assertEquals(40, percentile(tracer, CMD_JOIN, RTSLatencyTracer.STAGE_SEND, 50));
+        String dump = tracer.dump();
+        assertFalse(dump, dump.contains("lost"));
+    }
+
+    @Test
+    public void sdkRefusingTheMessageIsAFailedSend() {
+        RTSLatencyTracer tracer = new RTSLatencyTracer(new VirtualScheduler()::now);
+        tracer.onSending("request_0", CMD_JOIN, -1);
+        tracer.onSent("request_0", -1);
+
+        assertEquals(0, tracer.getPendingCount());
+        String dump = tracer.dump();
+        assertTrue(dump, dump.contains("send failed 1, error answers 0, lost 0"));
+    }
+
+    @Test
+    public void failedSendsAreCountedAndRetriesTraced() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        FakeEngine engine = new FakeEngine(scheduler);
+
+        long enqueuedAt = engine.tracer.now();
+        engine.send(CMD_JOIN, enqueuedAt, 10, false, 100, 200);
+        scheduler.runUntil(500);
+        assertEquals(0, engine.tracer.getPendingCount());
+
+        // Replayed after reconnecting, under a new request id.
+        engine.send(CMD_JOIN, enqueuedAt, 10, true, 100, 200);
+        engine.send(CMD_JOIN, engine.tracer.now(), 10, true, 100, 500);
+        scheduler.runUntil(2_000);
+
+        LatencyHistogram total = engine.tracer.getHistogram(CMD_JOIN, RTSLatencyTracer.STAGE_TOTAL);
+        assertNotNull(total);
+        assertEquals(2, total.getTotalCount());
+        assertEquals("reconnect wait counts end to end", 600, total.getMax());
+        String dump = engine.tracer.dump();
+        assertTrue(dump, dump.contains("send failed 1, error answers 1, lost 0"));
+    }
+
+    @Test
+    public void unansweredRequestsAreDroppedAsLost() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        FakeEngine engine = new FakeEngine(scheduler);
+        for (int i = 0; i < RTSLatencyTracer.MAX_TRACES + 10; i++) {
+            engine.send(CMD_INVITE, -1, 5, true, -1, 200);
+        }
+        scheduler.runUntil(60_000);
+
+        assertEquals(RTSLatencyTracer.MAX_TRACES, engine.tracer.getPendingCount());
+        assertTrue(engine.tracer.dump().contains("lost 10"));
+    }
+
+    /**
+     * Load generator: requests of three events with long tailed server time, percentiles of the
+     * tracer against the exact ones.
+     */
+    @Test
+    public void percentilesUnderLoad() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        VirtualScheduler scheduler = new VirtualScheduler();
+        FakeEngine engine = new FakeEngine(scheduler);
+        Random random = new Random(47);
+        String[] events = {CMD_JOIN, CMD_REPLY, CMD_INVITE};
+        double[] medianMs = {180, 60, 90};
+        List<List<Long>> exact = new ArrayList<>();
+        for (int i = 0; i < events.length; i++) {
+            exact.add(new ArrayList<>());
+        }
+
+        final int requests = 30_000;
+        for (int i = 0; i < requests; i++) {
+            int event = random.nextInt(events.length);
+            long answerMs = Math.round(medianMs[event] * Math.exp(random.nextGaussian() * 0.6));
+            long at = i * 3L;
+            scheduler.runUntil(at);
+            engine.send(events[event], at, 1 + random.nextInt(20), true, answerMs, 200);
+            exact.get(event).add(answerMs);
+        }
+        scheduler.runUntil(requests * 3L + 60_000);
+
+        StringBuilder report = new StringBuilder();
+        for (int event = 0; event < events.length; event++) {
+            List<Long> values = exact.get(event);
+            long[] sorted = new long[values.size()];
+            for (int i = 0; i < sorted.length; i++) {
+                sorted[i] = values.get(i);
+            }
+            Arrays.sort(sorted);
+            for (double p : new double[]{50, 90, 99, 99.9}) {
+                long expected = sorted[(int) Math.ceil(p / 100 * sorted.length) - 1];
+                long traced = percentile(engine.tracer, events[event], RTSLatencyTracer.STAGE_ANSWER, p);
+                assertTrue(events[event] + " p" + p + " " + traced + " vs " + expected,
+                        traced >= expected && traced <= expected + expected / LatencyHistogram.SUB_BUCKETS);
+                report.append(String.format("%s p%s %d (exact %d) ", events[event], p, traced, expected));
+            }
+        }
+        assertEquals(0, engine.tracer.getPendingCount());
+        System.out.println(report);
+        System.out.println(engine.tracer.dump());
+    }
+
+    @Test
+    public void histogramBucketsAreWithinASixteenth() {
+        for (long value = 0; value < 1 << 20; value++) {
+            long highest = LatencyHistogram.highestEquivalent(LatencyHistogram.indexOf(value));
+            assertTrue(String.valueOf(value), highest >= value && highest - value <= value / LatencyHistogram.SUB_BUCKETS);
+        }
+        assertEquals(LatencyHistogram.BUCKET_COUNT - 1, LatencyHistogram.indexOf(LatencyHistogram.MAX_VALUE_MS));
+
+        LatencyHistogram histogram = new LatencyHistogram();
+        histogram.record(-5);
+        histogram.record(Long.MAX_VALUE);
+        assertEquals(0, histogram.getMin());
+        assertEquals(LatencyHistogram.MAX_VALUE_MS, histogram.getMax());
+        assertEquals(LatencyHistogram.MAX_VALUE_MS, histogram.getValueAtPercentile(100));
+        histogram.reset();
+        assertEquals(0, histogram.getValueAtPercentile(99));
+    }
+
+    private static long percentile(RTSLatencyTracer tracer, String eventName, int stage, double percentile) {
+        LatencyHistogram histogram = tracer.getHistogram(eventName, stage);
+        assertNotNull(eventName, histogram);
+        return histogram.getValueAtPercentile(percentile);
+    }
+}
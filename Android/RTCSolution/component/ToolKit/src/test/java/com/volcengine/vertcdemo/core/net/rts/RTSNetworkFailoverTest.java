@@ -0,0 +1,220 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import androidx.annotation.NonNull;
+
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+
+import org.junit.Test;
+
+import java.util.Random;
+
+/**
+ * Injects synthetic network callbacks and measures time-to-recovered on a virtual clock.
+ */
+public class RTSNetworkFailoverTest {
+
+    private static final long RTT_MS = 80;
+    // How long the SDK takes to report a dead connection on its own.
+    private static final long SDK_DETECT_MS = 10_000;
+
+    /**
+     * Device network + business server seen through one RTS connection.
+     */
+    private static class Harness implements RTSReconnectSupervisor.Handshake, RTSNetworkFailover.Probe,
+            RTSNetworkFailover.Pausable {
+        final VirtualScheduler scheduler = new VirtualScheduler();
+        final RTSReconnectSupervisor supervisor;
+        final RTSNetworkFailover failover;
+        boolean networkUp = true;
+        // The connection was opened on a network that is gone, nothing sent on it arrives.
+        boolean stale;
+        int probeErrorCode;
+        int handshakes;
+        int probes;
+        int pauses;
+        int resumes;
+
+        Harness() {
+            supervisor = new RTSReconnectSupervisor(this, scheduler, new RTSReconnectSupervisor.Replayer() {
+                @Override
+                public void replay(@NonNull RTSReconnectSupervisor.Call call) {
+                }
+
+                @Override
+                public void fail(@NonNull RTSReconnectSupervisor.Call call, int code, @NonNull String message) {
+                }
+            }, new Random(7));
+            supervisor.setBackoff(RTSReconnectSupervisor.DEFAULT_BASE_DELAY_MS,
+                    RTSReconnectSupervisor.DEFAULT_MAX_DELAY_MS, 100,
+                    RTSReconnectSupervisor.DEFAULT_HANDSHAKE_TIMEOUT_MS);
+            failover = new RTSNetworkFailover(supervisor, this, scheduler);
+            failover.addPausable(this);
+            supervisor.onConnected();
+        }
+
+        @Override
+        public void start() {
+            handshakes++;
+            boolean ok = networkUp;
+            scheduler.schedule(() -> {
+                if (ok) {
+                    stale = false;
+                    supervisor.onConnected();
+                } else {
+                    supervisor.onHandshakeFailed(-1);
+                }
+            }, RTT_MS);
+        }
+
+        @Override
+        public void send(@NonNull IRTSCallback callback) {
+            probes++;
+            if (stale || !networkUp) {
+                return;
+            }
+            scheduler.schedule(() -> {
+                if (probeErrorCode == 0) {
+                    callback.onSuccess(null);
+                } else {
+                    callback.onError(probeErrorCode, "probe");
+                }
+            }, RTT_MS);
+        }
+
+        @Override
+        public void onPauseNonEssential() {
+            pauses++;
+        }
+
+        @Override
+        public void onResumeNonEssential() {
+            resumes++;
+        }
+
+        /**
+         * Run until connected and return when that happened.
+         */
+        long runUntilConnected(long limitMs) {
+            long deadline = scheduler.now() + limitMs;
+            while (supervisor.getState() != RTSReconnectSupervisor.STATE_CONNECTED
+                    && scheduler.now() < deadline) {
+                scheduler.runUntil(scheduler.now() + 1);
+            }
+            return scheduler.now();
+        }
+    }
+
+    @Test
+    public void lossPausesTrafficAndHoldsAttemptsUntilRegain() {
+        Harness h = new Harness();
+        h.networkUp = false;
+        h.stale = true;
+        h.failover.onNetworkLost();
+
+        assertTrue(h.failover.isPaused());
+        assertEquals(1, h.pauses);
+        assertEquals(RTSReconnectSupervisor.STATE_RECONNECTING, h.supervisor.getState());
+        h.scheduler.runUntil(60_000);
+        assertEquals("no handshake without network", 0, h.handshakes);
+
+        h.networkUp = true;
+        long regainAt = h.scheduler.now();
+        h.failover.onNetworkAvailable(false);
+        long recoveredAt = h.runUntilConnected(60_000);
+
+        assertEquals(RTSReconnectSupervisor.STATE_CONNECTED, h.supervisor.getState());
+        assertEquals(1, h.handshakes);
+        assertTrue(recoveredAt - regainAt <= 2 * RTT_MS);
+        assertFalse(h.failover.isPaused());
+        assertEquals(1, h.resumes);
+    }
+
+    @Test
+    public void switchWithStaleConnectionReconnectsAfterProbeTimeout() {
+        Harness h = new Harness();
+        h.stale = true;
+        long switchAt = h.scheduler.now();
+        h.failover.onNetworkAvailable(true);
+
+        assertTrue(h.failover.isPaused());
+        assertEquals(1, h.probes);
+        long recoveredAt = h.runUntilConnected(60_000);
+
+        assertEquals(RTSReconnectSupervisor.STATE_CONNECTED, h.supervisor.getState());
+        assertTrue(recoveredAt - switchAt <= RTSNetworkFailover.DEFAULT_PROBE_TIMEOUT_MS + 2 * RTT_MS);
+        assertFalse(h.failover.isPaused());
+    }
+
+    @Test
+    public void switchWithHealthyConnectionOnlyProbes() {
+        Harness h = new Harness();
+        h.failover.onNetworkAvailable(true);
+        h.scheduler.runUntil(30_000);
+
+        assertEquals(RTSReconnectSupervisor.STATE_CONNECTED, h.supervisor.getState());
+        assertEquals(0, h.handshakes);
+        assertEquals(1, h.pauses);
+        assertEquals(1, h.resumes);
+    }
+
+    @Test
+    public void serverErrorStillProvesTheConnection() {
+        Harness h = new Harness();
+        h.probeErrorCode = 500;
+        h.failover.onNetworkAvailable(true);
+        h.scheduler.runUntil(30_000);
+        assertEquals(0, h.handshakes);
+
+        h.probeErrorCode = RTSBaseClient.ERROR_CODE_DEFAULT;
+        h.failover.onNetworkAvailable(true);
+        h.scheduler.runUntil(60_000);
+        assertEquals("send failure means the connection is dead", 1, h.handshakes);
+        assertEquals(RTSReconnectSupervisor.STATE_CONNECTED, h.supervisor.getState());
+    }
+
+    @Test
+    public void measuresTimeToRecoveredAgainstSdkTimeout() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        Random random = new Random(2023);
+        int rounds = 50;
+        long withFailover = 0;
+        long baseline = 0;
+        for (int i = 0; i < rounds; i++) {
+            long outageMs = 500 + random.nextInt(8_000);
+
+            // With failover: the network callbacks drive the RTS layer.
+            Harness h = new Harness();
+            h.networkUp = false;
+            h.stale = true;
+            h.failover.onNetworkLost();
+            h.scheduler.runUntil(outageMs);
+            h.networkUp = true;
+            h.failover.onNetworkAvailable(true);
+            withFailover += h.runUntilConnected(10 * 60_000) - outageMs;
+
+            // Baseline: nothing reacts until the SDK reports the dead connection.
+            Harness b = new Harness();
+            b.networkUp = false;
+            b.stale = true;
+            b.scheduler.schedule(() -> b.networkUp = true, outageMs);
+            b.scheduler.schedule(b.supervisor::onConnectionLost, SDK_DETECT_MS);
+            b.scheduler.runUntil(SDK_DETECT_MS);
+            baseline += b.runUntilConnected(10 * 60_000) - outageMs;
+        }
+        long avgFailover = withFailover / rounds;
+        long avgBaseline = baseline / rounds;
+        System.out.println("avg time-to-recovered after network regain: failover " + avgFailover
+                + "ms, sdk timeout " + avgBaseline + "ms");
+
+        assertTrue(avgFailover <= 2 * RTT_MS);
+        assertTrue(avgFailover < avgBaseline);
+    }
+}
@@ -0,0 +1,252 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.google.gson.JsonObject;
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+
+import org.junit.Before;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * Drives the supervisor against a flaky stand-in server on a virtual clock.
+ */
+public class RTSReconnectSupervisorTest {
+
+    private static final String CMD_QUERY = "viGetAudienceList";
+    private static final String CMD_MEDIA = "viUpdateMediaStatus";
+    private static final String CMD_APPLY = "viApplyInteract";
+    private static final long HANDSHAKE_RTT_MS = 80;
+
+    /**
+     * Business server that is down between outages and drops some handshakes even when up.
+     */
+    private class FlakyServer implements RTSReconnectSupervisor.Handshake {
+        long downUntil;
+        double failRate;
+        double silentRate;
+        int handshakes;
+
+        @Override
+        public void start() {
+            handshakes++;
+            boolean up = mScheduler.now() >= downUntil;
+            double roll = mRandom.nextDouble();
+            if (up && roll < silentRate) {
+                return; // reply lost, the supervisor has to time out
+            }
+            boolean ok = up && roll >= silentRate + failRate;
+            mScheduler.schedule(() -> {
+                if (ok) {
+                    mSupervisor.onConnected();
+                } else {
+                    mSupervisor.onHandshakeFailed(-1);
+                }
+            }, HANDSHAKE_RTT_MS);
+        }
+    }
+
+    private final Random mRandom = new Random(42);
+    private final VirtualScheduler mScheduler = new VirtualScheduler();
+    private final FlakyServer mServer = new FlakyServer();
+    private final List<String> mReplayed = new ArrayList<>();
+    private final List<String> mFailed = new ArrayList<>();
+    private final List<int[]> mTransitions = new ArrayList<>();
+    private RTSReconnectSupervisor mSupervisor;
+
+    @Before
+    public void setUp() {
+        mSupervisor = new RTSReconnectSupervisor(mServer, mScheduler, new RTSReconnectSupervisor.Replayer() {
+            @Override
+            public void replay(@NonNull RTSReconnectSupervisor.Call call) {
+                assertUnlocked();
+                mReplayed.add(call.eventName);
+            }
+
+            @Override
+            public void fail(@NonNull RTSReconnectSupervisor.Call call, int code, @NonNull String message) {
+                assertUnlocked();
+                mFailed.add(call.eventName);
+            }
+        }, mRandom);
+        mSupervisor.setIdempotentEvents(Arrays.asList(CMD_QUERY, CMD_MEDIA));
+        mSupervisor.addStateListener((oldState, newState, attempt) -> {
+            assertUnlocked();
+            mTransitions.add(new int[]{oldState, newState, attempt});
+        });
+        mSupervisor.onConnected();
+        mTransitions.clear();
+    }
+
+    @Test
+    public void backoffIsJitteredAndCapped() {
+        for (int attempt = 1; attempt <= 15; attempt++) {
+            long expected = Math.min(RTSReconnectSupervisor.DEFAULT_BASE_DELAY_MS << (attempt - 1),
+                    RTSReconnectSupervisor.DEFAULT_MAX_DELAY_MS);
+            for (int i = 0; i < 50; i++) {
+                long delay = mSupervisor.backoffDelay(attempt);
+                assertTrue(delay >= expected / 2);
+                assertTrue(delay <= expected);
+            }
+        }
+    }
+
+    @Test
+    public void recoversAfterOutageAndReplaysIdempotentCalls() {
+        mServer.downUntil = 5_000;
+        mSupervisor.onConnectionLost();
+        assertEquals(RTSReconnectSupervisor.STATE_RECONNECTING, mSupervisor.getState());
+
+        assertTrue(mSupervisor.enqueue(call(CMD_QUERY, null)));
+        assertTrue(mSupervisor.enqueue(call(CMD_MEDIA, "1")));
+        assertFalse("non idempotent calls are not replayed", mSupervisor.enqueue(call(CMD_APPLY, null)));
+
+        mScheduler.runUntil(120_000);
+
+        assertEquals(RTSReconnectSupervisor.STATE_CONNECTED, mSupervisor.getState());
+        assertEquals(Arrays.asList(CMD_QUERY, CMD_MEDIA), mReplayed);
+        assertTrue(mFailed.isEmpty());
+        int[] first = mTransitions.get(0);
+        int[] last = mTransitions.get(mTransitions.size() - 1);
+        assertEquals(RTSReconnectSupervisor.STATE_CONNECTED, first[0]);
+        assertEquals(RTSReconnectSupervisor.STATE_RECONNECTING, first[1]);
+        assertEquals(RTSReconnectSupervisor.STATE_RECONNECTING, last[0]);
+        assertEquals(RTSReconnectSupervisor.STATE_CONNECTED, last[1]);
+    }
+
+    @Test
+    public void nonIdempotentDuplicatesAreRefusedWhileInFlight() {
+        RTSReconnectSupervisor.Call apply = call(CMD_APPLY, null);
+        RTSReconnectSupervisor.Call again = call(CMD_APPLY, null);
+        assertEquals("no request id, keyed on the content", apply.key, again.key);
+
+        assertTrue(mSupervisor.begin(apply));
+        assertFalse(mSupervisor.begin(again));
+        mSupervisor.end(apply);
+        assertTrue(mSupervisor.begin(again));
+
+        RTSReconnectSupervisor.Call query = call(CMD_QUERY, null);
+        assertTrue(mSupervisor.begin(query));
+        assertTrue(mSupervisor.begin(call(CMD_QUERY, null)));
+    }
+
+    @Test
+    public void requestIdTellsRepeatsFromDuplicates() {
+        RTSReconnectSupervisor.Call lock = requested(CMD_APPLY, "lock_1");
+        RTSReconnectSupervisor.Call lockAgain = requested(CMD_APPLY, "lock_2");
+        assertFalse("a deliberate repeat is a new request", lock.key.equals(lockAgain.key));
+        assertTrue(mSupervisor.begin(lock));
+        assertTrue(mSupervisor.begin(lockAgain));
+
+        RTSReconnectSupervisor.Call resent = requested(CMD_APPLY, "lock_1");
+        assertEquals(lock.key, resent.key);
+        assertFalse(mSupervisor.begin(resent));
+        mSupervisor.end(lock);
+        assertTrue(mSupervisor.begin(resent));
+    }
+
+    @Test
+    public void givesUpAfterMaxAttempts() {
+        mSupervisor.setBackoff(100, 1_000, 4, 2_000);
+        mServer.downUntil = Long.MAX_VALUE;
+        mSupervisor.onConnectionLost();
+        mSupervisor.enqueue(call(CMD_QUERY, null));
+
+        mScheduler.runUntil(60_000);
+
+        assertEquals(RTSReconnectSupervisor.STATE_FAILED, mSupervisor.getState());
+        assertEquals(4, mServer.handshakes);
+        assertEquals(Arrays.asList(CMD_QUERY), mFailed);
+        assertEquals(0, mSupervisor.getReplayQueueSize());
+    }
+
+    @Test
+    public void stopCancelsRetriesAndFailsQueue() {
+        mServer.downUntil = Long.MAX_VALUE;
+        mSupervisor.onConnectionLost();
+        mSupervisor.enqueue(call(CMD_MEDIA, "0"));
+        mSupervisor.stop();
+
+        mScheduler.runUntil(600_000);
+
+        assertEquals(RTSReconnectSupervisor.STATE_IDLE, mSupervisor.getState());
+        assertEquals(0, mServer.handshakes);
+        assertEquals(Arrays.asList(CMD_MEDIA), mFailed);
+        assertFalse("not logged in, nothing to supervise", mSupervisor.enqueue(call(CMD_QUERY, null)));
+    }
+
+    @Test
+    public void measuresRecoveryTimeUnderRandomOutages() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        mServer.failRate = 0.2;
+        mServer.silentRate = 0.1;
+        mSupervisor.setBackoff(RTSReconnectSupervisor.DEFAULT_BASE_DELAY_MS, RTSReconnectSupervisor.DEFAULT_MAX_DELAY_MS,
+                20, RTSReconnectSupervisor.DEFAULT_HANDSHAKE_TIMEOUT_MS);
+        int rounds = 100;
+        long totalRecoveryMs = 0;
+        long worstExtraMs = 0;
+        for (int i = 0; i < rounds; i++) {
+            long lostAt = mScheduler.now();
+            long outageMs = mRandom.nextInt(10_000);
+            mServer.downUntil = lostAt + outageMs;
+            mSupervisor.onConnectionLost();
+            mSupervisor.enqueue(call(CMD_QUERY, null));
+
+            long deadline = lostAt + 10 * 60_000;
+            while (mSupervisor.getState() == RTSReconnectSupervisor.STATE_RECONNECTING
+                    && mScheduler.now() < deadline) {
+                mScheduler.runUntil(mScheduler.now() + 10);
+            }
+            assertEquals("round " + i, RTSReconnectSupervisor.STATE_CONNECTED, mSupervisor.getState());
+            long recoveryMs = mScheduler.now() - lostAt;
+            totalRecoveryMs += recoveryMs;
+            worstExtraMs = Math.max(worstExtraMs, recoveryMs - outageMs);
+            mScheduler.runUntil(mScheduler.now() + 1_000);
+        }
+        System.out.println("rounds:" + rounds
+                + " avgRecoveryMs:" + totalRecoveryMs / rounds
+                + " worstAfterOutageMs:" + worstExtraMs
+                + " handshakes:" + mServer.handshakes);
+
+        assertEquals(rounds, mReplayed.size());
+        assertTrue(mFailed.isEmpty());
+    }
+
+    /**
+     * A listener or replayer that blocks would otherwise stall every thread touching the supervisor.
+     */
+    private void assertUnlocked() {
+        assertFalse("called under the supervisor lock", Thread.holdsLock(mSupervisor));
+    }
+
+    private static RTSReconnectSupervisor.Call requested(String eventName, String requestId) {
+        JsonObject content = new JsonObject();
+        content.addProperty("room_id", "room");
+        content.addProperty("seat_id", 1);
+        content.addProperty("request_id", requestId);
+        return new RTSReconnectSupervisor.Call(eventName, "room", content, null);
+    }
+
+    private static RTSReconnectSupervisor.Call call(String eventName, @Nullable String mic) {
+        JsonObject content = new JsonObject();
+        content.addProperty("room_id", "room");
+        if (mic != null) {
+            content.addProperty("mic", mic);
+        }
+        return new RTSReconnectSupervisor.Call(eventName, "room", content, null);
+    }
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * Per room ordering on a shared pool, and throughput against posting straight to the pool.
+ */
+public class RTSSerialLanesTest {
+
+    private static final int THREADS = 8;
+
+    @Test
+    public void requestsOfARoomKeepTheirOrder() throws InterruptedException {
+        final int rooms = 16;
+        final int requests = 2_000;
+        ExecutorService pool = Executors.newFixedThreadPool(THREADS);
+        RTSSerialLanes lanes = new RTSSerialLanes(pool);
+        List<List<Integer>> seen = new ArrayList<>();
+        AtomicInteger[] running = new AtomicInteger[rooms];
+        AtomicInteger overlaps = new AtomicInteger();
+        CountDownLatch done = new CountDownLatch(rooms * requests);
+        for (int room = 0; room < rooms; room++) {
+            seen.add(Collections.synchronizedList(new ArrayList<>()));
+            running[room] = new AtomicInteger();
+        }
+
+        for (int i = 0; i < requests; i++) {
+            for (int room = 0; room < rooms; room++) {
+                int r = room;
+                int seq = i;
+                lanes.execute("room_" + room, () -> {
+                    if (running[r].incrementAndGet() > 1) {
+                        overlaps.incrementAndGet();
+                    }
+                    seen.get(r).add(seq);
+                    running[r].decrementAndGet();
+                    done.countDown();
+                });
+            }
+        }
+        assertTrue(done.await(30, TimeUnit.SECONDS));
+        pool.shutdown();
+        assertTrue(pool.awaitTermination(5, TimeUnit.SECONDS));
+
+        assertEquals(0, overlaps.get());
+        for (int room = 0; room < rooms; room++) {
+            List<Integer> order = seen.get(room);
+            assertEquals(requests, order.size());
+            for (int i = 0; i < requests; i++) {
+                assertEquals("room_" + room, i, (int) order.get(i));
+            }
+        }
+        assertEquals("drained lanes are dropped", 0, lanes.getLaneCount());
+    }
+
+    @Test
+    public void aBlockedRoomDoesNotHoldOthers() throws InterruptedException {
+        ExecutorService pool = Executors.newFixedThreadPool(2);
+        RTSSerialLanes lanes = new RTSSerialLanes(pool);
+        CountDownLatch release = new CountDownLatch(1);
+        CountDownLatch otherRoom = new CountDownLatch(3);
+        AtomicInteger blockedRoomAfter = new AtomicInteger();
+
+        lanes.execute("a", () -> {
+            try {
+                release.await();
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+            }
+        });
+        lanes.execute("a", blockedRoomAfter::incrementAndGet);
+        for (int i = 0; i < 3; i++) {
+            lanes.execute("b", otherRoom::countDown);
+        }
+
+        assertTrue(otherRoom.await(5, TimeUnit.SECONDS));
+        assertEquals(0, blockedRoomAfter.get());
+        release.countDown();
+        pool.shutdown();
+        assertTrue(pool.awaitTermination(5, TimeUnit.SECONDS));
+        assertEquals(1, blockedRoomAfter.get());
+    }
+
+    @Test
+    public void aFailingRequestDoesNotStallItsRoom() {
+        List<Throwable> reported = new ArrayList<>();
+        // Runs inline and reports like a pool thread dying would.
+        RTSSerialLanes lanes = new RTSSerialLanes(task -> {
+            try {
+                task.run();
+            } catch (RuntimeException e) {
+                reported.add(e);
+            }
+        });
+        List<String> ran = new ArrayList<>();
+
+        lanes.execute("a", () -> ran.add("first"));
+        lanes.execute("a", () -> {
+            throw new IllegalStateException("sdk not ready");
+        });
+        lanes.execute("a", () -> ran.add("third"));
+
+        assertEquals(1, reported.size());
+        assertEquals(2, ran.size());
+        assertEquals(0, lanes.getLaneCount());
+    }
+
+    @Test
+    public void longLanesGiveTheirThreadBack() {
+        List<Runnable> queued = new ArrayList<>();
+        RTSSerialLanes lanes = new RTSSerialLanes(queued::add);
+        AtomicInteger ran = new AtomicInteger();
+        for (int i = 0; i < RTSSerialLanes.MAX_BATCH * 2 + 1; i++) {
+            lanes.execute("a", ran::incrementAndGet);
+        }
+        lanes.execute("b", ran::incrementAndGet);
+        assertEquals(2, queued.size());
+
+        queued.remove(0).run();
+        assertEquals(RTSSerialLanes.MAX_BATCH, ran.get());
+        assertEquals("the lane queued itself behind the other room", 2, queued.size());
+        while (!queued.isEmpty()) {
+            queued.remove(0).run();
+        }
+        assertEquals(RTSSerialLanes.MAX_BATCH * 2 + 2, ran.get());
+    }
+
+    /**
+     * Non-blocking requests like RTCVideo.sendServerMessage, lanes against posting straight to
+     * the shared pool, which reorders a room's requests.
+     */
+    @Test
+    public void throughputBenchmark() throws InterruptedException {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        final int rooms = 4;
+        final int requests = 50_000;
+        for (int round = 0; round < 3; round++) {
+            long poolNs = System.nanoTime();
+            int reordered = runPool(rooms, requests);
+            poolNs = System.nanoTime() - poolNs;
+            long lanesNs = System.nanoTime();
+            runLanes(rooms, requests);
+            lanesNs = System.nanoTime() - lanesNs;
+            if (round == 2) {
+                int total = rooms * requests;
+                System.out.printf("%d requests over %d rooms: pool %.0f/ms with %d reordered, lanes %.0f/ms in order%n",
+                        total, rooms, total / (poolNs / 1e6), reordered, total / (lanesNs / 1e6));
+            }
+        }
+    }
+
+    private static int runPool(int rooms, int requests) throws InterruptedException {
+        ExecutorService pool = Executors.newFixedThreadPool(THREADS);
+        int[] last = new int[rooms];
+        AtomicInteger reordered = new AtomicInteger();
+        CountDownLatch done = new CountDownLatch(rooms * requests);
+        for (int i = 1; i <= requests; i++) {
+            for (int room = 0; room < rooms; room++) {
+                int r = room;
+                int seq = i;
+                pool.execute(() -> {
+                    synchronized (last) {
+                        if (seq < last[r]) {
+                            reordered.incrementAndGet();
+                        }
+                        last[r] = Math.max(last[r], seq);
+                    }
+                    done.countDown();
+                });
+            }
+        }
+        assertTrue(done.await(60, TimeUnit.SECONDS));
+        pool.shutdown();
+        return reordered.get();
+    }
+
+    private static void runLanes(int rooms, int requests) throws InterruptedException {
+        ExecutorService pool = Executors.newFixedThreadPool(THREADS);
+        RTSSerialLanes lanes = new RTSSerialLanes(pool);
+        int[] last = new int[rooms];
+        AtomicInteger reordered = new AtomicInteger();
+        CountDownLatch done = new CountDownLatch(rooms * requests);
+        for (int i = 1; i <= requests; i++) {
+            for (int room = 0; room < rooms; room++) {
+                int r = room;
+                int seq = i;
+                lanes.execute("room_" + room, () -> {
+                    synchronized (last) {
+                        if (seq != last[r] + 1) {
+                            reordered.incrementAndGet();
+                        }
+                        last[r] = seq;
+                    }
+                    done.countDown();
+                });
+            }
+        }
+        assertTrue(done.await(60, TimeUnit.SECONDS));
+        pool.shutdown();
+        assertEquals(0, reordered.get());
+    }
+}
@@ -0,0 +1,477 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.core.net.rts;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertSame;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import androidx.annotation.NonNull;
+
+import com.google.gson.JsonObject;
+import com.google.gson.JsonParser;
+import com.google.gson.annotations.SerializedName;
+import com.ss.bytertc.engine.type.LoginErrorCode;
+import com.volcengine.vertcdemo.common.AbsBroadcast;
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+import com.volcengine.vertcdemo.core.net.IRequestCallback;
+
+import org.junit.Before;
+import org.junit.Rule;
+import org.junit.Test;
+import org.junit.rules.TemporaryFolder;
+import org.junit.runner.RunWith;
+import org.robolectric.RobolectricTestRunner;
+import org.robolectric.annotation.LooperMode;
+import org.robolectric.shadows.ShadowLog;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.File;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * A room session of the real client recorded against a fake server on a virtual clock, then
+ * replayed into a fresh client at the recorded pace, faster and back to back.
+ * Runs on the Robolectric main looper in LEGACY mode, answers posted to it are delivered inline.
+ */
+@RunWith(RobolectricTestRunner.class)
+@LooperMode(LooperMode.Mode.LEGACY)
+public class RTSSessionReplayTest {
+
+    private static final String SERVER = "server";
+    private static final String ROOM = "room_1";
+    private static final String LOGIN_TOKEN = "login_secret";
+    private static final String RTC_TOKEN = "rtc_secret";
+
+    @Rule
+    public TemporaryFolder mTemp = new TemporaryFolder();
+
+    /**
+     * A room screen on top of the real client: the answers of its requests and the room state
+     * kept from the notifications. Accepts an invite right away, as the UI would.
+     */
+    private static class RoomClient extends RTSBaseClient {
+        final List<String> audience = new ArrayList<>();
+        final List<String> seats = new ArrayList<>();
+        final List<String> answers = new ArrayList<>();
+
+        RoomClient(RTSTransport transport, VirtualScheduler scheduler) {
+            super(transport, new RTSInfo("app", "rts_token", "server", "signature", "bid"),
+                    scheduler, scheduler::now, new Random(1));
+            listen("viOnAudienceJoinRoom", audience::add);
+            listen("viOnAudienceLeaveRoom", audience::remove);
+            listen("viOnInviteInteract", userId -> {
+                JsonObject reply = new JsonObject();
+                reply.addProperty("reply", 1);
+                request("viReplyInvite", reply, "reply");
+            });
+            listen("viOnJoinInteract", seats::add);
+        }
+
+        private void listen(String event, AbsBroadcast.On<String> on) {
+            mEventListeners.put(event, new AbsBroadcast<>(event, UserNotice.class, notice -> on.on(notice.userId)));
+        }
+
+        @Override
+        protected String getUserId() {
+            return "me";
+        }
+
+        @Override
+        protected String getLoginToken() {
+            return LOGIN_TOKEN;
+        }
+
+        @Override
+        protected String getDeviceId() {
+            return "device";
+        }
+
+        void connect() {
+            login("rts_token", (code, message) -> assertEquals(message, LoginCallBack.SUCCESS, code));
+            assertTrue(isLogin());
+        }
+
+        void join() {
+            request("viJoinLiveRoom", new JsonObject(), "join");
+        }
+
+        void request(String eventName, JsonObject content, String label) {
+            sendServerMessage(eventName, ROOM, content, RoomAnswer.class, new IRequestCallback<RoomAnswer>() {
+                @Override
+                public void onSuccess(RoomAnswer data) {
+                    answers.add(label + " " + data.audienceCount);
+                }
+
+                @Override
+                public void onError(int errorCode, String message) {
+                    answers.add(label + " error " + errorCode);
+                }
+            });
+        }
+    }
+
+    private static class UserNotice {
+        @SerializedName("user_id")
+        String userId;
+    }
+
+    private static class RoomAnswer implements RTSBizResponse {
+        @SerializedName("audience_count")
+        int audienceCount;
+        @SerializedName("rtc_token")
+        String rtcToken;
+    }
+
+    /**
+     * Logs in right away and hands out message ids; a replayed session is answered from the log.
+     */
+    private static class ReplayTransport implements RTSTransport {
+        RoomClient client;
+        long mLastMessageId;
+
+        @Override
+        public void login(@NonNull String token, @NonNull String userId) {
+            client.onLoginResult(userId, LoginErrorCode.LOGIN_ERROR_CODE_SUCCESS, 0);
+        }
+
+        @Override
+        public void logout() {
+        }
+
+        @Override
+        public void setServerParams(@NonNull String signature, @NonNull String url) {
+            client.onServerParamsSetResult(200);
+        }
+
+        @Override
+        public long sendServerMessage(@NonNull String message) {
+            return ++mLastMessageId;
+        }
+    }
+
+    /**
+     * Answers requests after a delay, with an RTC token for the join, and pushes notifications at
+     * given times.
+     */
+    private static class FakeServer extends ReplayTransport {
+        final VirtualScheduler scheduler;
+
+        FakeServer(VirtualScheduler scheduler) {
+            this.scheduler = scheduler;
+        }
+
+        @Override
+        public long sendServerMessage(@NonNull String message) {
+            JsonObject request = new JsonParser().parse(message).getAsJsonObject();
+            String eventName = request.get("event_name").getAsString();
+            JsonObject answer = new JsonObject();
+            answer.addProperty("message_type", "return");
+            answer.addProperty("request_id", request.get("request_id").getAsString());
+            answer.addProperty("code", 200);
+            answer.addProperty("response", "viJoinLiveRoom".equals(eventName)
+                    ? "{\"audience_count\":3,\"rtc_token\":\"" + RTC_TOKEN + "\"}" : "{}");
+            scheduler.schedule(() -> client.onMessageReceived(SERVER, answer.toString()), 80);
+            return super.sendServerMessage(message);
+        }
+
+        void inform(long atMs, String event, String userId) {
+            JsonObject data = new JsonObject();
+            data.addProperty("user_id", userId);
+            JsonObject inform = new JsonObject();
+            inform.addProperty("message_type", "inform");
+            inform.addProperty("event", event);
+            inform.addProperty("data", data.toString());
+            scheduler.schedule(() -> client.onMessageReceived(SERVER, inform.toString()), atMs - scheduler.now());
+        }
+    }
+
+    private static final class Recording {
+        final RoomClient client;
+        final byte[] log;
+
+        Recording(RoomClient client, byte[] log) {
+            this.client = client;
+            this.log = log;
+        }
+
+        List<RTSSessionRecorder.Entry> entries() throws IOException {
+            return RTSSessionRecorder.read(new ByteArrayInputStream(log));
+        }
+    }
+
+    /**
+     * Join, audience coming and going, an invite accepted and the guest taking the seat.
+     */
+    private static Recording recordSession() throws IOException {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        ByteArrayOutputStream log = new ByteArrayOutputStream();
+        RTSSessionRecorder recorder = new RTSSessionRecorder(log, scheduler::now, Runnable::run);
+        FakeServer server = new FakeServer(scheduler);
+        RoomClient client = new RoomClient(server, scheduler);
+        server.client = client;
+        client.setMessageObserver(recorder);
+        client.connect();
+        client.join();
+        server.inform(500, "viOnAudienceJoinRoom", "audience_a");
+        server.inform(1_200, "viOnAudienceJoinRoom", "audience_b");
+        server.inform(3_000, "viOnInviteInteract", "me");
+        server.inform(3_400, "viOnJoinInteract", "me");
+        server.inform(7_000, "viOnAudienceLeaveRoom", "audience_a");
+        scheduler.runUntil(10_000);
+        recorder.close();
+        assertEquals(9, recorder.getCount());
+        assertEquals(Arrays.asList("join 3", "reply 0"), client.answers);
+        return new Recording(client, log.toByteArray());
+    }
+
+    /**
+     * A connected client with the replayer between it and the log.
+     */
+    private static RoomClient replayClient(VirtualScheduler scheduler) {
+        ReplayTransport transport = new ReplayTransport();
+        RoomClient client = new RoomClient(transport, scheduler);
+        transport.client = client;
+        client.connect();
+        return client;
+    }
+
+    @Before
+    public void setUp() {
+        ShadowLog.reset();
+    }
+
+    @Test
+    public void logRoundTripsAndSurvivesATruncatedTail() throws IOException {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        long[] now = {1_000};
+        RTSSessionRecorder recorder = new RTSSessionRecorder(out, () -> now[0], Runnable::run);
+        recorder.onOutbound("{\"event_name\":\"viJoinLiveRoom\"}");
+        now[0] += 250;
+        recorder.onInbound(SERVER, "{\"message_type\":\"inform\",\"data\":\"房间 👋\"}");
+        now[0] += 100_000;
+        recorder.onInbound(null, "{}");
+        byte[] log = out.toByteArray();
+
+        List<RTSSessionRecorder.Entry> entries = RTSSessionRecorder.read(new ByteArrayInputStream(log));
+        assertEquals(3, entries.size());
+        assertFalse(entries.get(0).inbound);
+        assertEquals(0, entries.get(0).atMs);
+        assertNull(entries.get(0).uid);
+        assertEquals(250, entries.get(1).atMs);
+        assertEquals(SERVER, entries.get(1).uid);
+        assertEquals("{\"message_type\":\"inform\",\"data\":\"房间 👋\"}", entries.get(1).message);
+        assertEquals(100_250, entries.get(2).atMs);
+        assertEquals("", entries.get(2).uid);
+
+        byte[] truncated = Arrays.copyOf(log, log.length - 1);
+        assertEquals(2, RTSSessionRecorder.read(new ByteArrayInputStream(truncated)).size());
+        try {
+            RTSSessionRecorder.read(new ByteArrayInputStream("{\"not\":\"a log\"}".getBytes()));
+            throw new AssertionError("read a json file as a log");
+        } catch (IOException expected) {
+        }
+    }
+
+    @Test
+    public void recordsAreWrittenOnTheWriter() throws IOException {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        List<Runnable> writer = new ArrayList<>();
+        RTSSessionRecorder recorder = new RTSSessionRecorder(out, () -> 0, writer::add);
+        recorder.onOutbound("{\"event_name\":\"viJoinLiveRoom\"}");
+        recorder.onInbound(SERVER, "{}");
+        assertEquals("nothing written on the sending thread", 0, out.size());
+        assertEquals("one write for the header and both records", 1, writer.size());
+
+        writer.remove(0).run();
+        assertEquals(2, recorder.getCount());
+        recorder.close();
+        recorder.onInbound(SERVER, "{\"late\":1}");
+        writer.remove(0).run();
+        assertTrue(writer.isEmpty());
+        assertEquals(2, RTSSessionRecorder.read(new ByteArrayInputStream(out.toByteArray())).size());
+    }
+
+    @Test
+    public void corruptLengthIsNotAllocated() {
+        ByteArrayOutputStream log = new ByteArrayOutputStream();
+        log.write(RTSSessionRecorder.MAGIC, 0, RTSSessionRecorder.MAGIC.length);
+        // Start time, an outbound record 0ms later, and a message "length" of 2^62.
+        byte[] record = {0, RTSSessionRecorder.KIND_OUTBOUND, 0,
+                (byte) 0x80, (byte) 0x80, (byte) 0x80, (byte) 0x80, (byte) 0x80,
+                (byte) 0x80, (byte) 0x80, (byte) 0x80, 0x40};
+        log.write(record, 0, record.length);
+        try {
+            RTSSessionRecorder.read(new ByteArrayInputStream(log.toByteArray()));
+            throw new AssertionError("read a record longer than MAX_STRING_BYTES");
+        } catch (IOException expected) {
+        }
+    }
+
+    @Test
+    public void credentialsAreNotRecorded() throws IOException {
+        Recording recording = recordSession();
+        String text = new String(recording.log, StandardCharsets.UTF_8);
+        assertFalse(text.contains(LOGIN_TOKEN));
+        assertFalse(text.contains(RTC_TOKEN));
+
+        List<RTSSessionRecorder.Entry> entries = recording.entries();
+        JsonObject join = new JsonParser().parse(entries.get(0).message).getAsJsonObject();
+        assertEquals("viJoinLiveRoom", join.get("event_name").getAsString());
+        JsonObject content = new JsonParser().parse(join.get("content").getAsString()).getAsJsonObject();
+        assertEquals(RTSSessionRecorder.MASK, content.get("login_token").getAsString());
+        JsonObject answer = new JsonParser().parse(entries.get(1).message).getAsJsonObject();
+        JsonObject response = new JsonParser().parse(answer.get("response").getAsString()).getAsJsonObject();
+        assertEquals(RTSSessionRecorder.MASK, response.get("rtc_token").getAsString());
+        assertEquals(3, response.get("audience_count").getAsInt());
+
+        String notice = "{\"message_type\":\"inform\",\"data\":\"{\\\"user_id\\\":\\\"token_holder\\\"}\"}";
+        assertSame("nothing to mask", notice, RTSSessionRecorder.mask(notice));
+        assertEquals("{\"room\":{\"token\":\"***\",\"seats\":[{\"rtc_token\":\"***\"}]}}",
+                RTSSessionRecorder.mask("{\"room\":{\"token\":\"t\",\"seats\":[{\"rtc_token\":\"r\"}]}}"));
+    }
+
+    @Test
+    public void replayAtRecordedPaceReproducesTheSession() throws IOException {
+        Recording recording = recordSession();
+
+        VirtualScheduler scheduler = new VirtualScheduler();
+        RoomClient client = replayClient(scheduler);
+        List<Long> deliveredAt = new ArrayList<>();
+        RTSSessionReplayer replayer = new RTSSessionReplayer(recording.entries(), (uid, message) -> {
+            deliveredAt.add(scheduler.now());
+            client.onMessageReceived(uid, message);
+        }, scheduler);
+        client.setMessageObserver(replayer);
+        boolean[] done = new boolean[1];
+        // The screen joins again, the rest comes from the log.
+        client.join();
+        replayer.play(1, () -> done[0] = true);
+        scheduler.runUntil(60_000);
+
+        assertTrue(done[0]);
+        assertEquals(recording.client.answers, client.answers);
+        assertEquals(recording.client.audience, client.audience);
+        assertEquals(recording.client.seats, client.seats);
+        assertEquals(Arrays.asList(80L, 500L, 1_200L, 3_000L, 3_080L, 3_400L, 7_000L), deliveredAt);
+        assertEquals(0, replayer.getUnpairedAnswerCount());
+        assertEquals(0, replayer.getUnpairedRequestCount());
+        assertEquals(0, client.getLatencyTracer().getPendingCount());
+    }
+
+    @Test
+    public void fasterAndBackToBack() throws IOException {
+        List<RTSSessionRecorder.Entry> entries = recordSession().entries();
+
+        VirtualScheduler scheduler = new VirtualScheduler();
+        RoomClient fast = replayClient(scheduler);
+        List<Long> deliveredAt = new ArrayList<>();
+        RTSSessionReplayer replayer = new RTSSessionReplayer(entries, (uid, message) -> {
+            deliveredAt.add(scheduler.now());
+            fast.onMessageReceived(uid, message);
+        }, scheduler);
+        fast.setMessageObserver(replayer);
+        fast.join();
+        replayer.play(4, null);
+        scheduler.runUntil(60_000);
+        assertEquals(Arrays.asList(20L, 125L, 300L, 750L, 770L, 850L, 1_750L), deliveredAt);
+
+        RoomClient backToBack = replayClient(new VirtualScheduler());
+        RTSSessionReplayer maxSpeed = new RTSSessionReplayer(entries, backToBack::onMessageReceived, new VirtualScheduler());
+        backToBack.setMessageObserver(maxSpeed);
+        backToBack.join();
+        boolean[] done = new boolean[1];
+        maxSpeed.play(RTSSessionReplayer.MAX_SPEED, () -> done[0] = true);
+        assertTrue("delivered without the scheduler", done[0]);
+        assertEquals(fast.answers, backToBack.answers);
+        assertEquals(Arrays.asList("audience_b"), backToBack.audience);
+        assertEquals(Arrays.asList("me"), backToBack.seats);
+    }
+
+    @Test
+    public void answersForRequestsNotSentAgainAreCounted() throws IOException {
+        List<RTSSessionRecorder.Entry> entries = recordSession().entries();
+        RoomClient client = replayClient(new VirtualScheduler());
+        RTSSessionReplayer replayer = new RTSSessionReplayer(entries, client::onMessageReceived, new VirtualScheduler());
+        client.setMessageObserver(replayer);
+        // No join this time, and one request the recorded session never sent.
+        client.request("viFinishLive", new JsonObject(), "finish");
+        replayer.play(RTSSessionReplayer.MAX_SPEED, null);
+
+        assertEquals(7, replayer.getDeliveredCount());
+        assertEquals(1, replayer.getUnpairedAnswerCount());
+        assertEquals(1, replayer.getUnpairedRequestCount());
+        assertEquals("the invite reply is still paired", Arrays.asList("reply 0"), client.answers);
+        assertEquals("the finish is never answered", 1, client.getLatencyTracer().getPendingCount());
+    }
+
+    @Test
+    public void openKeepsTheNewestLogs() throws IOException {
+        File dir = new File(mTemp.getRoot(), "rts_sessions");
+        for (int i = 0; i < RTSSessionRecorder.MAX_FILES + 3; i++) {
+            RTSSessionRecorder recorder = RTSSessionRecorder.open(dir, () -> 0, Runnable::run);
+            recorder.onOutbound("{\"n\":" + i + "}");
+            recorder.close();
+        }
+        File[] logs = dir.listFiles();
+        assertNotNull(logs);
+        assertEquals(RTSSessionRecorder.MAX_FILES, logs.length);
+    }
+
+    /**
+     * Decode, dispatch and state of a long synthetic session, back to back: a crowded room with
+     * audience churn and a request every tenth message.
+     */
+    @Test
+    public void replayBenchmark() throws IOException {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        VirtualScheduler scheduler = new VirtualScheduler();
+        ByteArrayOutputStream log = new ByteArrayOutputStream();
+        RTSSessionRecorder recorder = new RTSSessionRecorder(log, scheduler::now, Runnable::run);
+        FakeServer server = new FakeServer(scheduler);
+        RoomClient recordedClient = new RoomClient(server, scheduler);
+        server.client = recordedClient;
+        recordedClient.setMessageObserver(recorder);
+        recordedClient.connect();
+        final int informs = 50_000;
+        for (int i = 0; i < informs; i++) {
+            String event = i % 10 == 9 ? "viOnInviteInteract" : i % 3 == 2 ? "viOnAudienceLeaveRoom" : "viOnAudienceJoinRoom";
+            server.inform(i * 20L, event, "audience_" + i % 500);
+        }
+        scheduler.runUntil(informs * 20L + 1_000);
+        recorder.close();
+        byte[] bytes = log.toByteArray();
+        List<RTSSessionRecorder.Entry> entries = RTSSessionRecorder.read(new ByteArrayInputStream(bytes));
+
+        long bestNs = Long.MAX_VALUE;
+        RoomClient client = null;
+        RTSSessionReplayer replayer = null;
+        for (int round = 0; round < 5; round++) {
+            // Robolectric keeps every log line of the client
+            ShadowLog.reset();
+            client = replayClient(new VirtualScheduler());
+            replayer = new RTSSessionReplayer(entries, client::onMessageReceived, new VirtualScheduler());
+            client.setMessageObserver(replayer);
+            long start = System.nanoTime();
+            replayer.play(RTSSessionReplayer.MAX_SPEED, null);
+            bestNs = Math.min(bestNs, System.nanoTime() - start);
+        }
+        assertEquals(recordedClient.audience, client.audience);
+        assertEquals(recordedClient.answers.size(), client.answers.size());
+        assertEquals(0, replayer.getUnpairedAnswerCount());
+        System.out.printf("replayed %d messages (%d bytes logged, %d per record) in %dms, %d messages/s%n",
+                replayer.getDeliveredCount(), bytes.length, bytes.length / entries.size(), bestNs / 1_000_000,
+                replayer.getDeliveredCount() * 1_000_000_000L / bestNs);
+    }
+}
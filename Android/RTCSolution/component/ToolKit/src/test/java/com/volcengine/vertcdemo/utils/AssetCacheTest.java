@@ -0,0 +1,288 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.utils;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import androidx.annotation.NonNull;
+
+import org.junit.Before;
+import org.junit.Rule;
+import org.junit.Test;
+import org.junit.rules.TemporaryFolder;
+
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.FileNotFoundException;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.io.RandomAccessFile;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.util.Arrays;
+import java.util.Random;
+
+/**
+ * Extraction, reuse and recovery of the asset cache, with a folder standing in for the APK assets.
+ */
+public class AssetCacheTest {
+
+    /**
+     * Assets read from a folder, the way AssetManager lists and opens them.
+     */
+    private static class FolderSource implements AssetCache.Source {
+        final File mDir;
+        int opened;
+
+        FolderSource(File dir) {
+            mDir = dir;
+        }
+
+        @NonNull
+        @Override
+        public String[] list(@NonNull String path) {
+            String[] names = new File(mDir, path).list();
+            if (names == null) {
+                return new String[0];
+            }
+            Arrays.sort(names);
+            return names;
+        }
+
+        @NonNull
+        @Override
+        public synchronized InputStream open(@NonNull String path) throws IOException {
+            File file = new File(mDir, path);
+            if (!file.isFile()) {
+                throw new FileNotFoundException(path);
+            }
+            opened++;
+            return new FileInputStream(file);
+        }
+    }
+
+    @Rule
+    public TemporaryFolder mTemp = new TemporaryFolder();
+
+    private File mAssets;
+    private File mCacheDir;
+    private FolderSource mSource;
+
+    @Before
+    public void setUp() throws IOException {
+        mAssets = mTemp.newFolder("assets");
+        mCacheDir = new File(mTemp.getRoot(), "cache");
+        mSource = new FolderSource(mAssets);
+        write("voicechat_bgm.mp3", bytes(1, 300_000));
+        write("effect/model/face.model", bytes(2, 70_000));
+        write("effect/sticker/a.png", bytes(3, 5_000));
+        write("effect/sticker/b.png", bytes(4, 0));
+    }
+
+    @Test
+    public void extractsOnceAndReusesAcrossStarts() throws IOException {
+        AssetCache first = cache("1.0/100");
+        File bgm = first.getFile("voicechat_bgm.mp3");
+        assertNotNull(bgm);
+        assertArrayEquals(read(new File(mAssets, "voicechat_bgm.mp3")), read(bgm));
+        assertNotNull(first.getFolder("effect"));
+        assertEquals(4, first.getExtractedCount());
+        assertTrue(new File(mCacheDir, AssetCache.MANIFEST_NAME).isFile());
+
+        assertNotNull(first.getFile("voicechat_bgm.mp3"));
+        assertEquals("verified once per process", 4, mSource.opened);
+
+        AssetCache restarted = cache("1.0/100");
+        File effect = restarted.getFolder("effect");
+        assertNotNull(effect);
+        assertEquals(new File(mCacheDir, "effect"), effect);
+        assertNotNull(restarted.getFile("voicechat_bgm.mp3"));
+        assertEquals(0, restarted.getExtractedCount());
+        assertEquals(4, mSource.opened);
+    }
+
+    @Test
+    public void cutFileIsExtractedAgain() throws IOException {
+        File bgm = cache("1.0/100").getFile("voicechat_bgm.mp3");
+        assertNotNull(bgm);
+        try (RandomAccessFile file = new RandomAccessFile(bgm, "rw")) {
+            file.setLength(4096);
+        }
+
+        AssetCache restarted = cache("1.0/100");
+        assertNotNull(restarted.getFile("voicechat_bgm.mp3"));
+        assertEquals(1, restarted.getRecoveredCount());
+        assertArrayEquals(read(new File(mAssets, "voicechat_bgm.mp3")), read(bgm));
+    }
+
+    @Test
+    public void changedByteIsExtractedAgain() throws IOException {
+        File model = cache("1.0/100").getFile("effect/model/face.model");
+        assertNotNull(model);
+        long length = model.length();
+        try (RandomAccessFile file = new RandomAccessFile(model, "rw")) {
+            file.seek(length / 2);
+            int value = file.read();
+            file.seek(length / 2);
+            file.write(value ^ 0x01);
+        }
+        assertEquals(length, model.length());
+
+        AssetCache restarted = cache("1.0/100");
+        assertNotNull(restarted.getFolder("effect"));
+        assertEquals(1, restarted.getRecoveredCount());
+        assertEquals(1, restarted.getExtractedCount());
+        assertArrayEquals(read(new File(mAssets, "effect/model/face.model")), read(model));
+    }
+
+    @Test
+    public void copyCutByAKilledProcessIsNotUsed() throws IOException {
+        // What a process killed in the middle of an extraction leaves behind.
+        File part = new File(mCacheDir, "voicechat_bgm.mp3.part");
+        assertTrue(part.getParentFile().mkdirs());
+        try (OutputStream out = new FileOutputStream(part)) {
+            out.write(bytes(1, 1000));
+        }
+
+        AssetCache cache = cache("1.0/100");
+        File bgm = cache.getFile("voicechat_bgm.mp3");
+        assertNotNull(bgm);
+        assertArrayEquals(read(new File(mAssets, "voicechat_bgm.mp3")), read(bgm));
+        assertFalse(part.exists());
+    }
+
+    @Test
+    public void fileWithoutManifestEntryIsExtractedAgain() throws IOException {
+        // A file copied by older versions, which kept no manifest.
+        File old = new File(mCacheDir, "voicechat_bgm.mp3");
+        assertTrue(old.getParentFile().mkdirs());
+        try (OutputStream out = new FileOutputStream(old)) {
+            out.write(bytes(9, 300_000));
+        }
+        assertNotNull(cache("1.0/100").getFile("voicechat_bgm.mp3"));
+        assertArrayEquals(read(new File(mAssets, "voicechat_bgm.mp3")), read(old));
+    }
+
+    @Test
+    public void unreadableManifestExtractsEverythingAgain() throws IOException {
+        assertNotNull(cache("1.0/100").getFolder("effect"));
+        File manifest = new File(mCacheDir, AssetCache.MANIFEST_NAME);
+        for (String content : new String[]{"", "{\"version\":1,\"files\":", "[1,2]",
+                "{\"version\":1,\"appVersion\":\"1.0/100\",\"files\":{\"effect/sticker/a.png\":null}}"}) {
+            Files.write(manifest.toPath(), content.getBytes(StandardCharsets.UTF_8));
+            AssetCache restarted = cache("1.0/100");
+            assertNotNull(content, restarted.getFolder("effect"));
+            assertEquals(content, 3, restarted.getExtractedCount());
+        }
+        assertEquals(0, cache("1.0/100").getExtractedCount());
+    }
+
+    @Test
+    public void newAppVersionExtractsEverythingAgain() throws IOException {
+        File bgm = cache("1.0/100").getFile("voicechat_bgm.mp3");
+        assertNotNull(bgm);
+        write("voicechat_bgm.mp3", bytes(5, 300_000));
+
+        AssetCache sameVersion = cache("1.0/100");
+        assertNotNull(sameVersion.getFile("voicechat_bgm.mp3"));
+        assertEquals("assets only change with the app", 0, sameVersion.getExtractedCount());
+
+        AssetCache updated = cache("1.1/200");
+        assertNotNull(updated.getFile("voicechat_bgm.mp3"));
+        assertEquals(1, updated.getExtractedCount());
+        assertArrayEquals(bytes(5, 300_000), read(bgm));
+    }
+
+    @Test
+    public void missingAssetsAreNull() {
+        AssetCache cache = cache("1.0/100");
+        assertNull(cache.getFile("nothing.mp3"));
+        assertNull(cache.getFolder("nothing"));
+        assertFalse(new File(mCacheDir, "nothing.mp3").exists());
+    }
+
+    /**
+     * Extraction of an effect-sized folder by the cache, against the 4 KB loop copying file by
+     * file that FileUtils used.
+     */
+    @Test
+    public void extractionBenchmark() throws IOException {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        for (int i = 0; i < 48; i++) {
+            write("bench/res/" + i + ".bin", bytes(100 + i, 512 * 1024));
+        }
+        File legacyDir = new File(mTemp.getRoot(), "legacy");
+        legacyCopyFolder(new File(mAssets, "bench"), new File(legacyDir, "warmup"));
+
+        long legacyNs = System.nanoTime();
+        legacyCopyFolder(new File(mAssets, "bench"), new File(legacyDir, "bench"));
+        legacyNs = System.nanoTime() - legacyNs;
+
+        AssetCache cache = cache("1.0/100");
+        long coldNs = System.nanoTime();
+        assertNotNull(cache.getFolder("bench"));
+        coldNs = System.nanoTime() - coldNs;
+        assertEquals(48, cache.getExtractedCount());
+
+        AssetCache restarted = cache("1.0/100");
+        long warmNs = System.nanoTime();
+        assertNotNull(restarted.getFolder("bench"));
+        warmNs = System.nanoTime() - warmNs;
+        assertEquals(0, restarted.getExtractedCount());
+
+        System.out.printf("extract 24MB in 48 files: legacy copy %dms, cache cold %dms (hashed, synced), warm start verify %dms%n",
+                legacyNs / 1_000_000, coldNs / 1_000_000, warmNs / 1_000_000);
+        for (int i = 0; i < 48; i++) {
+            assertArrayEquals(bytes(100 + i, 512 * 1024), read(new File(mCacheDir, "bench/res/" + i + ".bin")));
+        }
+    }
+
+    private static void legacyCopyFolder(File from, File to) throws IOException {
+        String[] names = from.list();
+        if (names == null || names.length == 0) {
+            try (InputStream in = new FileInputStream(from); OutputStream out = new FileOutputStream(to)) {
+                byte[] buffer = new byte[4096];
+                int len;
+                while ((len = in.read(buffer)) != -1) {
+                    out.write(buffer, 0, len);
+                }
+            }
+            return;
+        }
+        //noinspection ResultOfMethodCallIgnored
+        to.mkdirs();
+        for (String name : names) {
+            legacyCopyFolder(new File(from, name), new File(to, name));
+        }
+    }
+
+    private AssetCache cache(String appVersion) {
+        return new AssetCache(mSource, mCacheDir, appVersion, 4);
+    }
+
+    private void write(String path, byte[] data) throws IOException {
+        File file = new File(mAssets, path);
+        //noinspection ResultOfMethodCallIgnored
+        file.getParentFile().mkdirs();
+        Files.write(file.toPath(), data);
+    }
+
+    private static byte[] read(File file) throws IOException {
+        return Files.readAllBytes(file.toPath());
+    }
+
+    private static byte[] bytes(long seed, int length) {
+        byte[] data = new byte[length];
+        new Random(seed).nextBytes(data);
+        return data;
+    }
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.common;
+
+import androidx.annotation.NonNull;
+
+import java.util.Iterator;
+import java.util.PriorityQueue;
+
+/**
+ * Single threaded scheduler with a virtual clock, a test fixture of ToolKit shared with the
+ * solutions' unit tests.
+ */
+public class VirtualScheduler implements Scheduler, Clock {
+    private static class Entry {
+        final long at;
+        final long seq;
+        final Runnable task;
+
+        Entry(long at, long seq, Runnable task) {
+            this.at = at;
+            this.seq = seq;
+            this.task = task;
+        }
+    }
+
+    private final PriorityQueue<Entry> mQueue = new PriorityQueue<>((a, b) ->
+            a.at != b.at ? Long.compare(a.at, b.at) : Long.compare(a.seq, b.seq));
+    private long mNow;
+    private long mSeq;
+
+    @Override
+    public void schedule(@NonNull Runnable task, long delayMs) {
+        mQueue.add(new Entry(mNow + delayMs, mSeq++, task));
+    }
+
+    @Override
+    public void cancel(@NonNull Runnable task) {
+        Iterator<Entry> it = mQueue.iterator();
+        while (it.hasNext()) {
+            if (it.next().task == task) {
+                it.remove();
+            }
+        }
+    }
+
+    /**
+     * Run every task due by the time, in order, then move the clock to it.
+     */
+    public void runUntil(long time) {
+        while (!mQueue.isEmpty() && mQueue.peek().at <= time) {
+            Entry entry = mQueue.poll();
+            mNow = entry.at;
+            entry.task.run();
+        }
+        mNow = Math.max(mNow, time);
+    }
+
+    @Override
+    public long now() {
+        return mNow;
+    }
+}
@@ -11,12 +11,15 @@ public class ChatMessageEvent implements RTSBizInform {
     public VideoChatUserInfo userInfo;
     @SerializedName("message")
     public String message;
+    @SerializedName("message_id")
+    public String messageId;
 
     @Override
     public String toString() {
         return "ChatMessageEvent{" +
                 "userInfo=" + userInfo +
                 ", message='" + message + '\'' +
+                ", messageId='" + messageId + '\'' +
                 '}';
     }
 }
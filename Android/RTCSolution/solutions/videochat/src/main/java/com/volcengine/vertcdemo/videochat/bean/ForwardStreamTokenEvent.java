@@ -0,0 +1,22 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.bean;
+
+import com.google.gson.annotations.SerializedName;
+
+public class ForwardStreamTokenEvent extends VideoChatResponse {
+    @SerializedName("rtc_token")
+    public String rtcToken;
+    /*** Seconds until the token expires, 0 if the server does not say */
+    @SerializedName("expire_in")
+    public long expireIn;
+
+    @Override
+    public String toString() {
+        return "ForwardStreamTokenEvent{" +
+                "rtcToken='" + rtcToken + '\'' +
+                ", expireIn=" + expireIn +
+                '}';
+    }
+}
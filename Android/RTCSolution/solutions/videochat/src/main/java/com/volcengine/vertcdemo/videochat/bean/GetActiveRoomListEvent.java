@@ -11,11 +11,29 @@ public class GetActiveRoomListEvent extends VideoChatResponse {
 
     @SerializedName("room_list")
     public List<VideoChatRoomInfo> roomList;
+    /**
+     * Cursor of the next page, empty when the server does not page the result.
+     */
+    @SerializedName("next_page_token")
+    public String nextPageToken;
+    @SerializedName("has_more")
+    public boolean hasMore;
+    /**
+     * Version tag of the first page, echoed back on refresh to detect unchanged lists.
+     */
+    @SerializedName("etag")
+    public String etag;
+    @SerializedName("not_modified")
+    public boolean notModified;
 
     @Override
     public String toString() {
         return "GetActiveRoomListEvent{" +
                 "roomList=" + roomList +
+                ", nextPageToken='" + nextPageToken + '\'' +
+                ", hasMore=" + hasMore +
+                ", etag='" + etag + '\'' +
+                ", notModified=" + notModified +
                 '}';
     }
 }
@@ -6,14 +6,41 @@ package com.volcengine.vertcdemo.videochat.bean;
 import android.os.Parcel;
 import android.os.Parcelable;
 
+import androidx.annotation.IntDef;
+
 import com.google.gson.annotations.SerializedName;
 
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
 import java.util.ArrayList;
 import java.util.HashMap;
 import java.util.List;
 import java.util.Map;
 
 public class JoinRoomEvent extends VideoChatResponse implements Parcelable {
+    /**
+     * viReconnect answered with a full snapshot, also what servers without resume support send.
+     */
+    public static final int SYNC_TYPE_FULL = 0;
+    /**
+     * viReconnect answered that nothing changed since the state_version sent by the client.
+     */
+    public static final int SYNC_TYPE_NONE = 1;
+    /**
+     * viReconnect answered with only the changed parts; absent fields and seats are unchanged.
+     */
+    public static final int SYNC_TYPE_DELTA = 2;
+
+    /**
+     * audience_count left out of a delta, see {@link ReconnectRoomEvent}.
+     */
+    public static final int AUDIENCE_COUNT_ABSENT = -1;
+
+    @IntDef({SYNC_TYPE_FULL, SYNC_TYPE_NONE, SYNC_TYPE_DELTA})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface SyncType {
+    }
+
     public boolean isFromCreate = true;
     @SerializedName("room_info")
     public VideoChatRoomInfo roomInfo;
@@ -31,6 +58,11 @@ public class JoinRoomEvent extends VideoChatResponse implements Parcelable {
     public List<AnchorInfo> anchorList;
     @SerializedName("interact_info_list")
     public List<InteractInfo> interactInfos;
+    @SerializedName("state_version")
+    public long stateVersion;
+    @SerializedName("sync_type")
+    @SyncType
+    public int syncType = SYNC_TYPE_FULL;
 
     @Override
     public String toString() {
@@ -44,6 +76,8 @@ public class JoinRoomEvent extends VideoChatResponse implements Parcelable {
                 ", audienceCount=" + audienceCount +
                 ", anchorList=" + anchorList +
                 ", interactInfos=" + interactInfos +
+                ", stateVersion=" + stateVersion +
+                ", syncType=" + syncType +
                 '}';
     }
 
@@ -67,6 +101,8 @@ public class JoinRoomEvent extends VideoChatResponse implements Parcelable {
         dest.writeInt(this.audienceCount);
         dest.writeList(this.anchorList);
         dest.writeList(this.interactInfos);
+        dest.writeLong(this.stateVersion);
+        dest.writeInt(this.syncType);
     }
 
     public void readFromParcel(Parcel source) {
@@ -87,6 +123,8 @@ public class JoinRoomEvent extends VideoChatResponse implements Parcelable {
         source.readList(this.anchorList, AnchorInfo.class.getClassLoader());
         this.interactInfos = new ArrayList<InteractInfo>();
         source.readList(this.interactInfos, InteractInfo.class.getClassLoader());
+        this.stateVersion = source.readLong();
+        this.syncType = source.readInt();
     }
 
     public JoinRoomEvent() {
@@ -110,6 +148,8 @@ public class JoinRoomEvent extends VideoChatResponse implements Parcelable {
         in.readList(this.anchorList, AnchorInfo.class.getClassLoader());
         this.interactInfos = new ArrayList<InteractInfo>();
         in.readList(this.interactInfos, InteractInfo.class.getClassLoader());
+        this.stateVersion = in.readLong();
+        this.syncType = in.readInt();
     }
 
     public static final Parcelable.Creator<JoinRoomEvent> CREATOR = new Parcelable.Creator<JoinRoomEvent>() {
@@ -0,0 +1,36 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.bean;
+
+import com.google.gson.annotations.SerializedName;
+import com.volcengine.vertcdemo.core.net.rts.RTSBizInform;
+
+import java.util.Arrays;
+
+/**
+ * Reactions of a room merged by the server, broadcast on a fixed cadence.
+ */
+public class ReactionTotalsEvent implements RTSBizInform {
+
+    @SerializedName("room_id")
+    public String roomId;
+    @SerializedName("seq")
+    public long seq;
+    // Every kind since the room started, indexed by VideoChatReactions kind.
+    @SerializedName("totals")
+    public long[] totals;
+    // Every kind since the previous broadcast, own reactions included.
+    @SerializedName("added")
+    public int[] added;
+
+    @Override
+    public String toString() {
+        return "ReactionTotalsEvent{" +
+                "roomId='" + roomId + '\'' +
+                ", seq=" + seq +
+                ", totals=" + Arrays.toString(totals) +
+                ", added=" + Arrays.toString(added) +
+                '}';
+    }
+}
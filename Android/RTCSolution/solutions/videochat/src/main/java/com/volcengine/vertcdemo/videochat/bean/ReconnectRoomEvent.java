@@ -0,0 +1,15 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.bean;
+
+/**
+ * Answer of a versioned viReconnect. A delta leaves out audience_count when it did not change,
+ * so it stays {@link #AUDIENCE_COUNT_ABSENT} unless the server sends it.
+ */
+public class ReconnectRoomEvent extends JoinRoomEvent {
+
+    public ReconnectRoomEvent() {
+        audienceCount = AUDIENCE_COUNT_ABSENT;
+    }
+}
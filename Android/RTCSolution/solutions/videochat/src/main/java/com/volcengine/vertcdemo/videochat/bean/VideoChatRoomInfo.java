@@ -57,6 +57,9 @@ public class VideoChatRoomInfo implements Parcelable {
     public int audienceCount;
     @SerializedName("ext")
     public String extraInfo;
+    /*** CDN playback address of the room's mixed stream, empty when the room is not pushed to CDN */
+    @SerializedName("stream_pull_url")
+    public String streamPullUrl;
 
     public boolean enableInteract() {
         return enableAudienceInteractApply == INTERACT_ON;
@@ -76,6 +79,7 @@ public class VideoChatRoomInfo implements Parcelable {
                 ", endTime=" + endTime +
                 ", audienceCount=" + audienceCount +
                 ", extraInfo='" + extraInfo + '\'' +
+                ", streamPullUrl='" + streamPullUrl + '\'' +
                 '}';
     }
 
@@ -97,6 +101,7 @@ public class VideoChatRoomInfo implements Parcelable {
         dest.writeLong(this.endTime);
         dest.writeInt(this.audienceCount);
         dest.writeString(this.extraInfo);
+        dest.writeString(this.streamPullUrl);
     }
 
     public void readFromParcel(Parcel source) {
@@ -111,6 +116,7 @@ public class VideoChatRoomInfo implements Parcelable {
         this.endTime = source.readLong();
         this.audienceCount = source.readInt();
         this.extraInfo = source.readString();
+        this.streamPullUrl = source.readString();
     }
 
     public VideoChatRoomInfo() {
@@ -128,6 +134,7 @@ public class VideoChatRoomInfo implements Parcelable {
         this.endTime = in.readLong();
         this.audienceCount = in.readInt();
         this.extraInfo = in.readString();
+        this.streamPullUrl = in.readString();
     }
 
     public static final Parcelable.Creator<VideoChatRoomInfo> CREATOR = new Parcelable.Creator<VideoChatRoomInfo>() {
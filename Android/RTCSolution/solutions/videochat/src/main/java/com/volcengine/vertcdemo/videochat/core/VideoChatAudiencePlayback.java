@@ -0,0 +1,250 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import android.view.View;
+
+import androidx.annotation.IntDef;
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.protocol.IVideoPlayer;
+
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+
+/**
+ * How a pure audience watches the room: the CDN pull stream through {@link IVideoPlayer}, or
+ * the RTC streams.
+ *
+ * In player mode the audience stays in the RTC room for signaling only, nothing subscribed.
+ * An invite or an apply subscribes the RTC streams ahead of time while the player keeps
+ * playing; once the audience is on mic the player is stopped at the first rendered RTC frame,
+ * so the picture never goes black. Declining drops the RTC streams again, going off mic
+ * returns to the player.
+ *
+ * Times are passed in, see {@link #getLastSwitchMs()} and {@link #getLastPrepareLeadMs()}.
+ * Call on the main thread.
+ */
+public class VideoChatAudiencePlayback {
+
+    /*** Watching the RTC streams */
+    public static final int MODE_RTC = 0;
+    /*** Watching the CDN pull stream, RTC streams not subscribed */
+    public static final int MODE_PLAYER = 1;
+    /*** Invited or applied, RTC streams subscribed behind the player */
+    public static final int MODE_PREPARING = 2;
+    /*** On mic, waiting for the first RTC frame to hide the player */
+    public static final int MODE_SWITCHING = 3;
+
+    public static final long SWITCH_TIMEOUT_MS = 2_000;
+
+    @IntDef({MODE_RTC, MODE_PLAYER, MODE_PREPARING, MODE_SWITCHING})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface Mode {
+    }
+
+    /**
+     * RTC side of the switch, see VideoChatRTCManager#setMediaSubscribed.
+     */
+    public interface Media {
+        void setSubscribed(boolean subscribed);
+    }
+
+    public interface Listener {
+        /**
+         * @param showPlayer whether the player view is the one on screen
+         */
+        void onModeChanged(@Mode int mode, boolean showPlayer);
+    }
+
+    @Nullable
+    private final IVideoPlayer mPlayer;
+    private final Media mMedia;
+    @Nullable
+    private Listener mListener;
+    @Mode
+    private int mMode = MODE_RTC;
+    @Nullable
+    private String mUrl;
+    private boolean mRtcFrameRendered;
+    private long mPrepareAtMs;
+    private long mCommitAtMs;
+    private long mLastSwitchMs = -1;
+    private long mLastPrepareLeadMs = -1;
+    private int mSwitchCount;
+    private int mCancelCount;
+
+    /**
+     * @param player null when no player is built in, the audience then always uses RTC
+     */
+    public VideoChatAudiencePlayback(@Nullable IVideoPlayer player, @NonNull Media media) {
+        mPlayer = player;
+        mMedia = media;
+    }
+
+    public void setListener(@Nullable Listener listener) {
+        mListener = listener;
+    }
+
+    /**
+     * Start watching the room as a pure audience.
+     *
+     * @return true if the player is used, false if the audience has to watch over RTC
+     */
+    public boolean start(@Nullable String url, @Nullable View container) {
+        if (mPlayer == null || url == null || url.isEmpty()) {
+            setMode(MODE_RTC);
+            mMedia.setSubscribed(true);
+            return false;
+        }
+        mUrl = url;
+        mMedia.setSubscribed(false);
+        mPlayer.setPlayerUrl(url, container);
+        mPlayer.updatePlayScaleModel(IVideoPlayer.MODE_ASPECT_FIT);
+        mPlayer.play();
+        setMode(MODE_PLAYER);
+        return true;
+    }
+
+    /**
+     * Invited by the host or applied for a seat: subscribe the RTC streams behind the player.
+     */
+    public void prepareInteract(long nowMs) {
+        if (mMode != MODE_PLAYER) {
+            return;
+        }
+        mPrepareAtMs = nowMs;
+        mRtcFrameRendered = false;
+        mMedia.setSubscribed(true);
+        setMode(MODE_PREPARING);
+    }
+
+    /**
+     * The audience is on mic, hide the player as soon as RTC renders.
+     */
+    public void commitInteract(long nowMs) {
+        if (mMode == MODE_PLAYER) {
+            // Nothing prepared, e.g. the invite arrived before start.
+            prepareInteract(nowMs);
+        }
+        if (mMode != MODE_PREPARING) {
+            return;
+        }
+        mCommitAtMs = nowMs;
+        setMode(MODE_SWITCHING);
+        if (mRtcFrameRendered) {
+            switchToRtc(nowMs);
+        }
+    }
+
+    /**
+     * Invite declined, timed out or apply rejected: back to the player alone.
+     */
+    public void cancelInteract() {
+        if (mMode != MODE_PREPARING) {
+            return;
+        }
+        mCancelCount++;
+        mRtcFrameRendered = false;
+        mMedia.setSubscribed(false);
+        setMode(MODE_PLAYER);
+    }
+
+    public void onRtcFirstFrame(long nowMs) {
+        if (mMode != MODE_PREPARING && mMode != MODE_SWITCHING) {
+            return;
+        }
+        if (!mRtcFrameRendered) {
+            mRtcFrameRendered = true;
+            mLastPrepareLeadMs = nowMs - mPrepareAtMs;
+        }
+        if (mMode == MODE_SWITCHING) {
+            switchToRtc(nowMs);
+        }
+    }
+
+    /**
+     * No RTC frame within {@link #SWITCH_TIMEOUT_MS} of going on mic, e.g. every camera is off:
+     * switch anyway rather than keep a stale player picture.
+     */
+    public void onSwitchTimeout(long nowMs) {
+        if (mMode == MODE_SWITCHING) {
+            switchToRtc(nowMs);
+        }
+    }
+
+    /**
+     * Off mic again: back to the player if the room has a pull stream.
+     */
+    public void finishInteract() {
+        if (mMode != MODE_RTC || mPlayer == null || mUrl == null) {
+            return;
+        }
+        mRtcFrameRendered = false;
+        mMedia.setSubscribed(false);
+        mPlayer.replacePlayWithUrl(mUrl);
+        mPlayer.play();
+        setMode(MODE_PLAYER);
+    }
+
+    public void release() {
+        if (mMode != MODE_RTC) {
+            mMedia.setSubscribed(true);
+        }
+        if (mPlayer != null) {
+            mPlayer.stop();
+            mPlayer.destroy();
+        }
+        mUrl = null;
+        mListener = null;
+        mMode = MODE_RTC;
+    }
+
+    @Mode
+    public int getMode() {
+        return mMode;
+    }
+
+    public boolean isPlayerShown() {
+        return mMode != MODE_RTC;
+    }
+
+    /*** From being put on mic to the player being replaced by RTC, -1 before the first switch */
+    public long getLastSwitchMs() {
+        return mLastSwitchMs;
+    }
+
+    /*** From subscribing ahead of time to the first RTC frame, -1 before the first one */
+    public long getLastPrepareLeadMs() {
+        return mLastPrepareLeadMs;
+    }
+
+    public int getSwitchCount() {
+        return mSwitchCount;
+    }
+
+    public int getCancelCount() {
+        return mCancelCount;
+    }
+
+    private void switchToRtc(long nowMs) {
+        mLastSwitchMs = Math.max(0, nowMs - mCommitAtMs);
+        mSwitchCount++;
+        if (mPlayer != null) {
+            mPlayer.stop();
+        }
+        setMode(MODE_RTC);
+    }
+
+    private void setMode(@Mode int mode) {
+        if (mMode == mode) {
+            return;
+        }
+        mMode = mode;
+        if (mListener != null) {
+            mListener.onModeChanged(mode, isPlayerShown());
+        }
+    }
+}
@@ -0,0 +1,474 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.IntDef;
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.common.IAction;
+
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.Objects;
+
+/**
+ * Background music played from a list of tracks.
+ *
+ * Two effect ids take turns: while a track plays on one of them, the next track is resolved and
+ * preloaded on the other, so when the current one finishes the next one starts from memory and
+ * the switch is gapless. A track that was not preloaded, e.g. after a skip to an arbitrary
+ * index, is resolved and opened at switch time.
+ *
+ * Times are passed in, see {@link #getLastSwitchMs()}. Call on the main thread.
+ */
+public class VideoChatBGMPlaylist {
+
+    public static final int STATE_STOPPED = 0;
+    public static final int STATE_PLAYING = 1;
+    public static final int STATE_PAUSED = 2;
+
+    @IntDef({STATE_STOPPED, STATE_PLAYING, STATE_PAUSED})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface State {
+    }
+
+    /**
+     * A track, either an asset of the APK or a file on disk.
+     */
+    public static final class Track {
+        @NonNull
+        public final String name;
+        /*** Asset path when {@link #isAsset}, absolute file path otherwise */
+        @NonNull
+        public final String location;
+        public final boolean isAsset;
+
+        private Track(@NonNull String name, @NonNull String location, boolean isAsset) {
+            this.name = name;
+            this.location = location;
+            this.isAsset = isAsset;
+        }
+
+        @NonNull
+        public static Track asset(@NonNull String assetPath) {
+            int slash = assetPath.lastIndexOf('/');
+            return new Track(assetPath.substring(slash + 1), assetPath, true);
+        }
+
+        @NonNull
+        public static Track file(@NonNull String path) {
+            int slash = path.lastIndexOf('/');
+            return new Track(path.substring(slash + 1), path, false);
+        }
+
+        @Override
+        public boolean equals(Object o) {
+            if (this == o) return true;
+            if (o == null || getClass() != o.getClass()) return false;
+            Track track = (Track) o;
+            return isAsset == track.isAsset && location.equals(track.location);
+        }
+
+        @Override
+        public int hashCode() {
+            return Objects.hash(location, isAsset);
+        }
+
+        @Override
+        public String toString() {
+            return (isAsset ? "asset:" : "file:") + location;
+        }
+    }
+
+    /**
+     * Effect player side, see VideoChatRTCManager. Every track is started to play once.
+     */
+    public interface Player {
+        void preload(int effectId, @NonNull String path);
+
+        void unload(int effectId);
+
+        void start(int effectId, @NonNull String path, int volume);
+
+        void stop(int effectId);
+
+        void pause(int effectId);
+
+        void resume(int effectId);
+
+        void setVolume(int effectId, int volume);
+    }
+
+    /**
+     * Turns a track into a path the player opens, may take disk IO.
+     */
+    public interface Resolver {
+        /**
+         * @param done called on the main thread, with null if the track can not be played
+         */
+        void resolve(@NonNull Track track, @NonNull IAction<String> done);
+    }
+
+    /**
+     * One of the two effect ids and what it holds.
+     */
+    private static final class Deck {
+        final int effectId;
+        int trackIndex = -1;
+        @Nullable
+        String path;
+        boolean preloaded;
+
+        Deck(int effectId) {
+            this.effectId = effectId;
+        }
+
+        void clear() {
+            trackIndex = -1;
+            path = null;
+            preloaded = false;
+        }
+    }
+
+    private final Player mPlayer;
+    private final Resolver mResolver;
+    private final Deck[] mDecks;
+    private List<Track> mTracks = Collections.emptyList();
+    private boolean mLoop = true;
+    private int mVolume = 100;
+    @State
+    private int mState = STATE_STOPPED;
+    private int mIndex;
+    private int mCurrentDeck;
+    /**
+     * Bumped by every switch, resolve results of an older one are dropped.
+     */
+    private int mGeneration;
+    private boolean mSwitching;
+    private int mFailuresInARow;
+    private long mSwitchAtMs;
+    private long mLastSwitchMs = -1;
+    private long mMaxSwitchMs = -1;
+    private int mSwitchCount;
+    private int mPreloadedSwitchCount;
+
+    /**
+     * @param firstEffectId the playlist uses this effect id and the one after it
+     */
+    public VideoChatBGMPlaylist(@NonNull Player player, @NonNull Resolver resolver, int firstEffectId) {
+        mPlayer = player;
+        mResolver = resolver;
+        mDecks = new Deck[]{new Deck(firstEffectId), new Deck(firstEffectId + 1)};
+    }
+
+    /**
+     * Replace the tracks, stopping what plays.
+     */
+    public void setTracks(@NonNull List<Track> tracks) {
+        stop();
+        mTracks = Collections.unmodifiableList(new ArrayList<>(tracks));
+        mIndex = 0;
+    }
+
+    @NonNull
+    public List<Track> getTracks() {
+        return mTracks;
+    }
+
+    /**
+     * @param loop whether the list starts over after the last track, true by default
+     */
+    public void setLoop(boolean loop) {
+        mLoop = loop;
+        if (mState != STATE_STOPPED) {
+            prepareNext();
+        }
+    }
+
+    /**
+     * @param volume 0 to 100
+     */
+    public void setVolume(int volume) {
+        mVolume = volume;
+        for (Deck deck : mDecks) {
+            mPlayer.setVolume(deck.effectId, volume);
+        }
+    }
+
+    @State
+    public int getState() {
+        return mState;
+    }
+
+    /**
+     * @return index of the current track, or of the one to play next when stopped
+     */
+    public int getIndex() {
+        return mIndex;
+    }
+
+    /**
+     * Start with the current track, or resume if paused.
+     */
+    public void play(long nowMs) {
+        if (mState == STATE_PAUSED) {
+            resume();
+        } else if (mState == STATE_STOPPED) {
+            playAt(mIndex, nowMs);
+        }
+    }
+
+    /**
+     * Switch to a track, preloaded or not.
+     */
+    public void playAt(int index, long nowMs) {
+        if (index < 0 || index >= mTracks.size()) {
+            return;
+        }
+        mFailuresInARow = 0;
+        switchTo(index, nowMs);
+    }
+
+    /**
+     * Skip to the next track, stopping at the end of the list unless looping.
+     */
+    public void next(long nowMs) {
+        int next = nextIndex(mIndex);
+        if (next < 0) {
+            stop();
+            return;
+        }
+        playAt(next, nowMs);
+    }
+
+    public void pause() {
+        if (mState != STATE_PLAYING) {
+            return;
+        }
+        mState = STATE_PAUSED;
+        if (current().path != null) {
+            mPlayer.pause(current().effectId);
+        }
+    }
+
+    public void resume() {
+        if (mState != STATE_PAUSED) {
+            return;
+        }
+        mState = STATE_PLAYING;
+        if (current().path != null) {
+            mPlayer.resume(current().effectId);
+        }
+    }
+
+    /**
+     * Stop and drop both effect ids, the current index is kept.
+     */
+    public void stop() {
+        mGeneration++;
+        mSwitching = false;
+        if (mState == STATE_STOPPED) {
+            return;
+        }
+        mState = STATE_STOPPED;
+        for (Deck deck : mDecks) {
+            mPlayer.stop(deck.effectId);
+            if (deck.preloaded) {
+                mPlayer.unload(deck.effectId);
+            }
+            deck.clear();
+        }
+    }
+
+    /**
+     * The player started to play an effect id.
+     */
+    public void onPlaying(int effectId, long nowMs) {
+        if (!mSwitching || mState == STATE_STOPPED || effectId != current().effectId) {
+            return;
+        }
+        mSwitching = false;
+        mFailuresInARow = 0;
+        mLastSwitchMs = nowMs - mSwitchAtMs;
+        mMaxSwitchMs = Math.max(mMaxSwitchMs, mLastSwitchMs);
+        mSwitchCount++;
+    }
+
+    /**
+     * The player reached the end of an effect id, go on with the next track.
+     */
+    public void onFinished(int effectId, long nowMs) {
+        if (mState == STATE_STOPPED || effectId != current().effectId) {
+            return;
+        }
+        int next = nextIndex(mIndex);
+        if (next < 0) {
+            stop();
+            return;
+        }
+        switchTo(next, nowMs);
+    }
+
+    /**
+     * The player could not open or decode an effect id, skip the track.
+     */
+    public void onFailed(int effectId, long nowMs) {
+        if (mState == STATE_STOPPED) {
+            return;
+        }
+        Deck deck = deckOf(effectId);
+        if (deck == null) {
+            return;
+        }
+        if (deck != current()) {
+            // The preloaded track is broken, it gets skipped when its turn comes.
+            deck.preloaded = false;
+            deck.path = null;
+            return;
+        }
+        skipBroken(nowMs);
+    }
+
+    /*** Time from asking for a track to the player playing it, -1 before the first switch */
+    public long getLastSwitchMs() {
+        return mLastSwitchMs;
+    }
+
+    public long getMaxSwitchMs() {
+        return mMaxSwitchMs;
+    }
+
+    public int getSwitchCount() {
+        return mSwitchCount;
+    }
+
+    /*** Switches that started a track preloaded ahead of time */
+    public int getPreloadedSwitchCount() {
+        return mPreloadedSwitchCount;
+    }
+
+    private void switchTo(int index, long nowMs) {
+        int generation = ++mGeneration;
+        Deck from = current();
+        Deck to = mDecks[1 - mCurrentDeck];
+        if (mState != STATE_STOPPED) {
+            mPlayer.stop(from.effectId);
+        }
+        mIndex = index;
+        mState = STATE_PLAYING;
+        mSwitching = true;
+        mSwitchAtMs = nowMs;
+        if (to.trackIndex == index && to.path != null) {
+            if (to.preloaded) {
+                mPreloadedSwitchCount++;
+            }
+            startOn(to, from);
+            return;
+        }
+        mResolver.resolve(mTracks.get(index), path -> {
+            if (generation != mGeneration) {
+                return;
+            }
+            if (path == null) {
+                skipBroken(nowMs);
+                return;
+            }
+            if (to.preloaded) {
+                mPlayer.unload(to.effectId);
+            }
+            to.trackIndex = index;
+            to.path = path;
+            to.preloaded = false;
+            startOn(to, from);
+        });
+    }
+
+    private void startOn(@NonNull Deck to, @NonNull Deck from) {
+        if (from.preloaded) {
+            mPlayer.unload(from.effectId);
+            from.preloaded = false;
+        }
+        // The path stays, a single track or a short list comes back to it without resolving.
+        mCurrentDeck = to == mDecks[0] ? 0 : 1;
+        mPlayer.start(to.effectId, Objects.requireNonNull(to.path), mVolume);
+        if (mState == STATE_PAUSED) {
+            // Paused while the track was being resolved.
+            mPlayer.pause(to.effectId);
+        }
+        prepareNext();
+    }
+
+    private void prepareNext() {
+        int next = nextIndex(mIndex);
+        Deck deck = mDecks[1 - mCurrentDeck];
+        if (next < 0) {
+            return;
+        }
+        if (deck.trackIndex == next && deck.path != null) {
+            if (!deck.preloaded) {
+                deck.preloaded = true;
+                mPlayer.preload(deck.effectId, deck.path);
+            }
+            return;
+        }
+        if (deck.preloaded) {
+            mPlayer.unload(deck.effectId);
+        }
+        deck.clear();
+        deck.trackIndex = next;
+        int generation = mGeneration;
+        mResolver.resolve(mTracks.get(next), path -> {
+            if (generation != mGeneration || deck.trackIndex != next || path == null) {
+                return;
+            }
+            deck.path = path;
+            deck.preloaded = true;
+            mPlayer.preload(deck.effectId, path);
+        });
+    }
+
+    private void skipBroken(long nowMs) {
+        mSwitching = false;
+        if (++mFailuresInARow >= mTracks.size()) {
+            // Nothing in the list plays, don't spin.
+            stop();
+            return;
+        }
+        int next = nextIndex(mIndex);
+        if (next < 0) {
+            stop();
+            return;
+        }
+        switchTo(next, nowMs);
+    }
+
+    private int nextIndex(int index) {
+        if (mTracks.isEmpty()) {
+            return -1;
+        }
+        if (index + 1 < mTracks.size()) {
+            return index + 1;
+        }
+        return mLoop ? 0 : -1;
+    }
+
+    @NonNull
+    private Deck current() {
+        return mDecks[mCurrentDeck];
+    }
+
+    @Nullable
+    private Deck deckOf(int effectId) {
+        for (Deck deck : mDecks) {
+            if (deck.effectId == effectId) {
+                return deck;
+            }
+        }
+        return null;
+    }
+}
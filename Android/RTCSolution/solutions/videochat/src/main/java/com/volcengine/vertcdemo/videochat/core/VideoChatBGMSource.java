@@ -0,0 +1,79 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import android.content.Context;
+import android.util.Log;
+
+import androidx.annotation.NonNull;
+
+import com.volcengine.vertcdemo.common.AppExecutors;
+import com.volcengine.vertcdemo.common.IAction;
+import com.volcengine.vertcdemo.utils.FileUtils;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Where the background music comes from: the default track, any asset under {@link #ASSET_DIR},
+ * and files on disk.
+ *
+ * The effect player only opens paths, so an asset is taken from the app's asset cache the first
+ * time it is about to play, extracted there once per app version. Nothing is copied at engine
+ * init.
+ */
+public class VideoChatBGMSource implements VideoChatBGMPlaylist.Resolver {
+
+    private static final String TAG = "VideoChatBGMSource";
+
+    public static final String DEFAULT_ASSET = "voicechat_bgm.mp3";
+    public static final String ASSET_DIR = "bgm";
+
+    private final Context mContext;
+
+    /**
+     * @param context application context
+     */
+    public VideoChatBGMSource(@NonNull Context context) {
+        mContext = context;
+    }
+
+    /**
+     * The default track first, then the assets under {@link #ASSET_DIR} by name.
+     */
+    @NonNull
+    public List<VideoChatBGMPlaylist.Track> listTracks() {
+        List<VideoChatBGMPlaylist.Track> tracks = new ArrayList<>();
+        tracks.add(VideoChatBGMPlaylist.Track.asset(DEFAULT_ASSET));
+        try {
+            String[] names = mContext.getAssets().list(ASSET_DIR);
+            if (names != null) {
+                Arrays.sort(names);
+                for (String name : names) {
+                    tracks.add(VideoChatBGMPlaylist.Track.asset(ASSET_DIR + "/" + name));
+                }
+            }
+        } catch (IOException e) {
+            Log.d(TAG, "list bgm assets failed: " + e.getLocalizedMessage());
+        }
+        return tracks;
+    }
+
+    @Override
+    public void resolve(@NonNull VideoChatBGMPlaylist.Track track, @NonNull IAction<String> done) {
+        AppExecutors.diskIO().execute(() -> {
+            String path;
+            if (track.isAsset) {
+                File file = FileUtils.getAssetCache(mContext).getFile(track.location);
+                path = file == null ? null : file.getAbsolutePath();
+            } else {
+                path = new File(track.location).isFile() ? track.location : null;
+            }
+            AppExecutors.mainThread().execute(() -> done.act(path));
+        });
+    }
+}
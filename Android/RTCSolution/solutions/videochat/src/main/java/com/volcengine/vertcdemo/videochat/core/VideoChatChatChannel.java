@@ -0,0 +1,420 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.IntDef;
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.google.gson.Gson;
+import com.google.gson.GsonBuilder;
+import com.google.gson.JsonParseException;
+import com.google.gson.annotations.SerializedName;
+import com.volcengine.vertcdemo.common.Scheduler;
+
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.util.LinkedHashMap;
+import java.util.Map;
+import java.util.Objects;
+
+/**
+ * Room chat sent two ways at once. The RTC room message reaches everyone in the room within one
+ * hop; the business server (viSendMessage) moderates and persists the message and fans it out
+ * again with viOnMessage. Every message carries an id, so whichever copy arrives second is
+ * dropped.
+ *
+ * Moderation does not rely on the sender: a room copy is provisional until the server copy
+ * confirms it, and is taken back when none comes within {@link #CONFIRM_WINDOW_MS}. The sender
+ * still broadcasts a retraction for a rejected message, which only takes it back sooner.
+ *
+ * A server that does not echo ids yet is matched by sender and text instead.
+ *
+ * Times are wall clock ms, the clock senders stamp their messages with. Call on the main thread.
+ */
+public class VideoChatChatChannel {
+
+    /*** Delivered by the RTC room message */
+    public static final int SOURCE_ROOM = 0;
+    /*** Delivered by the server fan-out, the room message was lost or late */
+    public static final int SOURCE_SERVER = 1;
+
+    @IntDef({SOURCE_ROOM, SOURCE_SERVER})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface Source {
+    }
+
+    public static final int SUBMIT_ACCEPTED = 0;
+    /*** The server refused the message, e.g. by moderation */
+    public static final int SUBMIT_REJECTED = 1;
+    /*** The server could not be reached, the message stays */
+    public static final int SUBMIT_FAILED = 2;
+
+    @IntDef({SUBMIT_ACCEPTED, SUBMIT_REJECTED, SUBMIT_FAILED})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface SubmitResult {
+    }
+
+    static final String TYPE_MESSAGE = "vi_chat";
+    static final String TYPE_RETRACT = "vi_chat_retract";
+    /*** Message ids remembered for dedupe */
+    static final int SEEN_CAPACITY = 512;
+    /*** How long a room copy waits for a server copy without id */
+    static final long MATCH_WINDOW_MS = 30_000;
+    /*** How long a room copy stays provisional before it is taken back unconfirmed */
+    static final long CONFIRM_WINDOW_MS = 15_000;
+    /*** Without HTML escaping, which would turn '=' and '<' into six bytes each */
+    private static final Gson GSON = new GsonBuilder().disableHtmlEscaping().create();
+
+    public static class Message {
+        @SerializedName("type")
+        String type;
+        @SerializedName("id")
+        public String id;
+        @SerializedName("user_id")
+        public String userId;
+        @SerializedName("user_name")
+        public String userName;
+        /*** Wire form of {@link #payload}, see VideoChatChatPayload */
+        @SerializedName("message")
+        public String text;
+        @SerializedName("sent_at")
+        public long sentAtMs;
+        /*** Only for the server submission, the room message is scoped by the room already */
+        public transient String roomId;
+        public transient VideoChatChatPayload payload;
+        /*** A room copy not confirmed by the server yet */
+        public transient boolean provisional;
+
+        @NonNull
+        @Override
+        public String toString() {
+            return "Message{" +
+                    "id='" + id + '\'' +
+                    ", userId='" + userId + '\'' +
+                    ", text='" + text + '\'' +
+                    '}';
+        }
+    }
+
+    public interface Transport {
+        /**
+         * Send a payload as RTC room message.
+         *
+         * @return false if it could not be sent, the server copy still arrives
+         */
+        boolean broadcast(@NonNull String payload);
+
+        /**
+         * Submit a message to the business server, callback on the main thread.
+         */
+        void submit(@NonNull Message message, @NonNull SubmitCallback callback);
+    }
+
+    public interface SubmitCallback {
+        void onResult(@SubmitResult int result);
+    }
+
+    public interface Listener {
+        void onMessage(@NonNull Message message, @Source int source);
+
+        /**
+         * The server confirmed a provisional message, see {@link Message#provisional}.
+         */
+        void onConfirmed(@NonNull String messageId);
+
+        void onRetracted(@NonNull String messageId);
+    }
+
+    /**
+     * A message seen by its id, with the time the room copy arrived.
+     */
+    private static class Seen {
+        final Message message;
+        final long roomArrivalMs;
+        boolean serverSeen;
+        boolean retracted;
+        /*** Takes the room copy back if the server does not confirm it */
+        @Nullable
+        Runnable expiry;
+
+        Seen(Message message, long roomArrivalMs) {
+            this.message = message;
+            this.roomArrivalMs = roomArrivalMs;
+        }
+    }
+
+    private final Transport mTransport;
+    private final Scheduler mScheduler;
+    @Nullable
+    private Listener mListener;
+    private final String mSession = Long.toString(System.currentTimeMillis(), 36);
+    private long mSequence;
+    private final LinkedHashMap<String, Seen> mSeen = new LinkedHashMap<String, Seen>(64, 0.75f, false) {
+        @Override
+        protected boolean removeEldestEntry(Map.Entry<String, Seen> eldest) {
+            return size() > SEEN_CAPACITY;
+        }
+    };
+
+    private int mRoomCount;
+    private int mServerCount;
+    private int mDuplicateCount;
+    private int mRejectedCount;
+    private int mUnconfirmedCount;
+    private long mRoomLatencySumMs;
+    private long mLeadSumMs;
+    private int mLeadCount;
+    private long mMaxLeadMs;
+
+    public VideoChatChatChannel(@NonNull Transport transport, @NonNull Scheduler scheduler) {
+        mTransport = transport;
+        mScheduler = scheduler;
+    }
+
+    public void setListener(@Nullable Listener listener) {
+        mListener = listener;
+    }
+
+    /**
+     * Send a message to the room and submit it to the server. The sender shows it right away.
+     */
+    @NonNull
+    public Message send(@NonNull String roomId, @NonNull String userId, @Nullable String userName,
+                        @NonNull VideoChatChatPayload payload, long nowMs) {
+        Message message = new Message();
+        message.type = TYPE_MESSAGE;
+        message.id = userId + "-" + mSession + "-" + (++mSequence);
+        message.userId = userId;
+        message.userName = userName;
+        message.text = payload.toWire();
+        message.payload = payload;
+        message.sentAtMs = nowMs;
+        message.roomId = roomId;
+        Seen seen = new Seen(message, nowMs);
+        seen.serverSeen = true;
+        mSeen.put(message.id, seen);
+
+        mTransport.broadcast(GSON.toJson(message));
+        mTransport.submit(message, result -> {
+            if (result == SUBMIT_REJECTED) {
+                mRejectedCount++;
+                Message retract = new Message();
+                retract.type = TYPE_RETRACT;
+                retract.id = message.id;
+                retract.userId = userId;
+                mTransport.broadcast(GSON.toJson(retract));
+                retract(message.id);
+            }
+        });
+        return message;
+    }
+
+    /**
+     * A room message from another user, see RTCRoomEventHandlerWithRTS#onRTCMessageReceived.
+     *
+     * @return false if it is not a chat message
+     */
+    public boolean onRoomMessage(@NonNull String fromUid, @Nullable String payload, long nowMs) {
+        Message message = parse(payload);
+        if (message == null || !Objects.equals(fromUid, message.userId)) {
+            return false;
+        }
+        if (TYPE_RETRACT.equals(message.type)) {
+            Seen seen = mSeen.get(message.id);
+            if (seen == null) {
+                // The retraction overtook the message, keep the id so the copies are dropped.
+                seen = new Seen(message, nowMs);
+                seen.serverSeen = true;
+                mSeen.put(message.id, seen);
+            }
+            if (!seen.retracted && Objects.equals(seen.message.userId, message.userId)) {
+                retract(message.id);
+            }
+            return true;
+        }
+        if (mSeen.containsKey(message.id)) {
+            mDuplicateCount++;
+            return true;
+        }
+        message.payload = VideoChatChatPayload.fromWire(message.text);
+        message.provisional = true;
+        Seen seen = new Seen(message, nowMs);
+        seen.expiry = () -> {
+            seen.expiry = null;
+            if (!seen.serverSeen && !seen.retracted) {
+                mUnconfirmedCount++;
+                retract(message.id);
+            }
+        };
+        mScheduler.schedule(seen.expiry, CONFIRM_WINDOW_MS);
+        mSeen.put(message.id, seen);
+        mRoomCount++;
+        mRoomLatencySumMs += Math.max(0, nowMs - message.sentAtMs);
+        if (mListener != null) {
+            mListener.onMessage(message, SOURCE_ROOM);
+        }
+        return true;
+    }
+
+    /**
+     * A message fanned out by the server with viOnMessage.
+     *
+     * @param messageId id sent with the message, null from servers that do not echo it
+     * @param text      message as sent, see VideoChatChatPayload
+     */
+    public void onServerMessage(@Nullable String messageId, @NonNull String userId, @Nullable String userName,
+                                @Nullable String text, long nowMs) {
+        Seen seen = messageId == null ? matchByText(userId, text, nowMs) : mSeen.get(messageId);
+        if (seen != null) {
+            if (!seen.serverSeen) {
+                seen.serverSeen = true;
+                long leadMs = Math.max(0, nowMs - seen.roomArrivalMs);
+                mLeadSumMs += leadMs;
+                mLeadCount++;
+                mMaxLeadMs = Math.max(mMaxLeadMs, leadMs);
+                confirm(seen);
+            }
+            mDuplicateCount++;
+            return;
+        }
+        Message message = new Message();
+        message.type = TYPE_MESSAGE;
+        message.id = messageId;
+        message.userId = userId;
+        message.userName = userName;
+        message.text = text;
+        message.payload = VideoChatChatPayload.fromWire(text);
+        if (messageId != null) {
+            Seen served = new Seen(message, -1);
+            served.serverSeen = true;
+            mSeen.put(messageId, served);
+        }
+        mServerCount++;
+        if (mListener != null) {
+            mListener.onMessage(message, SOURCE_SERVER);
+        }
+    }
+
+    /**
+     * Forget every message and the counters, e.g. when leaving the room.
+     */
+    public void reset() {
+        for (Seen seen : mSeen.values()) {
+            if (seen.expiry != null) {
+                mScheduler.cancel(seen.expiry);
+            }
+        }
+        mSeen.clear();
+        mRoomCount = 0;
+        mServerCount = 0;
+        mDuplicateCount = 0;
+        mRejectedCount = 0;
+        mUnconfirmedCount = 0;
+        mRoomLatencySumMs = 0;
+        mLeadSumMs = 0;
+        mLeadCount = 0;
+        mMaxLeadMs = 0;
+    }
+
+    /*** Messages delivered first by the room message */
+    public int getRoomCount() {
+        return mRoomCount;
+    }
+
+    /*** Messages only the server delivered */
+    public int getServerCount() {
+        return mServerCount;
+    }
+
+    public int getDuplicateCount() {
+        return mDuplicateCount;
+    }
+
+    /*** Own messages the server rejected */
+    public int getRejectedCount() {
+        return mRejectedCount;
+    }
+
+    /*** Room copies taken back because the server never confirmed them */
+    public int getUnconfirmedCount() {
+        return mUnconfirmedCount;
+    }
+
+    /*** Average time from sending to the room copy, by the sender's clock */
+    public long getAverageRoomLatencyMs() {
+        return mRoomCount == 0 ? 0 : mRoomLatencySumMs / mRoomCount;
+    }
+
+    /*** Average time the room copy came before the server copy, by the local clock only */
+    public long getAverageLeadMs() {
+        return mLeadCount == 0 ? 0 : mLeadSumMs / mLeadCount;
+    }
+
+    public long getMaxLeadMs() {
+        return mMaxLeadMs;
+    }
+
+    private void confirm(@NonNull Seen seen) {
+        if (seen.expiry != null) {
+            mScheduler.cancel(seen.expiry);
+            seen.expiry = null;
+        }
+        if (!seen.message.provisional || seen.retracted) {
+            return;
+        }
+        seen.message.provisional = false;
+        if (mListener != null) {
+            mListener.onConfirmed(seen.message.id);
+        }
+    }
+
+    private void retract(@NonNull String messageId) {
+        Seen seen = mSeen.get(messageId);
+        if (seen != null) {
+            seen.retracted = true;
+            if (seen.expiry != null) {
+                mScheduler.cancel(seen.expiry);
+                seen.expiry = null;
+            }
+        }
+        if (mListener != null) {
+            mListener.onRetracted(messageId);
+        }
+    }
+
+    /**
+     * The oldest room copy from the same sender with the same text that has no server copy yet.
+     */
+    @Nullable
+    private Seen matchByText(@NonNull String userId, @Nullable String text, long nowMs) {
+        for (Seen seen : mSeen.values()) {
+            if (seen.serverSeen || nowMs - seen.roomArrivalMs > MATCH_WINDOW_MS) {
+                continue;
+            }
+            if (userId.equals(seen.message.userId) && Objects.equals(text, seen.message.text)) {
+                return seen;
+            }
+        }
+        return null;
+    }
+
+    @Nullable
+    private static Message parse(@Nullable String payload) {
+        if (payload == null || !payload.startsWith("{")) {
+            return null;
+        }
+        Message message;
+        try {
+            message = GSON.fromJson(payload, Message.class);
+        } catch (JsonParseException e) {
+            return null;
+        }
+        if (message == null || message.id == null || message.userId == null
+                || !(TYPE_MESSAGE.equals(message.type) || TYPE_RETRACT.equals(message.type))) {
+            return null;
+        }
+        return message;
+    }
+}
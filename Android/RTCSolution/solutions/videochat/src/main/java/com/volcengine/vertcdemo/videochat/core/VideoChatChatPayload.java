@@ -0,0 +1,292 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import java.io.ByteArrayOutputStream;
+import java.io.UnsupportedEncodingException;
+import java.net.URLDecoder;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.Objects;
+
+/**
+ * Text of a chat message as it travels in viSendMessage, viOnMessage and the room message.
+ *
+ * Plain text goes as it is, UTF-8 inside the JSON. Earlier versions URL-encoded it, which made
+ * CJK text nine bytes a character; {@link #fromWire(String)} still reads that. URL encoding only
+ * produces {@code A-Z a-z 0-9 . * _ - + %}, so text made of those characters alone that contains
+ * a '+' or '%', and text starting with {@link #ESCAPE}, is sent with a leading {@link #ESCAPE}.
+ *
+ * Messages with mentions, emoji or reactions go as {@link #RICH_PREFIX} and base64 of:
+ * <pre>
+ *  0  u8      format version, {@link #FORMAT_VERSION}
+ *  1  u8      header length H, bytes after this field before the first segment (0 in version 1)
+ *     ...     H bytes added by later versions, skipped
+ *  segments:
+ *     u8      kind, {@link #KIND_TEXT} {@link #KIND_MENTION} {@link #KIND_EMOJI} {@link #KIND_REACTION}
+ *     varint  length L, 7 bits a byte, low bits first
+ *     L       kind specific:
+ *             text, emoji: UTF-8
+ *             mention:     u8 K, K bytes user id, L - 1 - K bytes display name, UTF-8
+ *             reaction:    u8 K, K bytes message id reacted to, L - 1 - K bytes reaction, UTF-8
+ * </pre>
+ * Later versions may add header bytes and segment kinds, which older readers skip.
+ *
+ * The iOS client reads and writes the same forms, VideoChatChatPayload.m next to its
+ * VideoChatRTSManager; a change here needs the same change there.
+ */
+public class VideoChatChatPayload {
+
+    public static final int FORMAT_VERSION = 1;
+    public static final int KIND_TEXT = 1;
+    public static final int KIND_MENTION = 2;
+    public static final int KIND_EMOJI = 3;
+    public static final int KIND_REACTION = 4;
+
+    static final char ESCAPE = '~';
+    static final String RICH_PREFIX = "~!";
+    /*** Longest user or message id a segment can carry */
+    private static final int MAX_ID_BYTES = 0xFF;
+
+    public static class Segment {
+        public final int kind;
+        /*** Text, display name, emoji or reaction */
+        @NonNull
+        public final String value;
+        /*** User id of a mention, message id of a reaction */
+        @Nullable
+        public final String target;
+
+        Segment(int kind, @NonNull String value, @Nullable String target) {
+            this.kind = kind;
+            this.value = value;
+            this.target = target;
+        }
+
+        @Override
+        public boolean equals(Object o) {
+            if (this == o) return true;
+            if (!(o instanceof Segment)) return false;
+            Segment segment = (Segment) o;
+            return kind == segment.kind && value.equals(segment.value) && Objects.equals(target, segment.target);
+        }
+
+        @Override
+        public int hashCode() {
+            return Objects.hash(kind, value, target);
+        }
+
+        @NonNull
+        @Override
+        public String toString() {
+            return kind + ":" + (target == null ? "" : target + "/") + value;
+        }
+    }
+
+    public static class Builder {
+        private final List<Segment> mSegments = new ArrayList<>();
+
+        public Builder text(@NonNull String text) {
+            mSegments.add(new Segment(KIND_TEXT, text, null));
+            return this;
+        }
+
+        public Builder mention(@NonNull String userId, @NonNull String userName) {
+            mSegments.add(new Segment(KIND_MENTION, userName, truncate(userId)));
+            return this;
+        }
+
+        public Builder emoji(@NonNull String emoji) {
+            mSegments.add(new Segment(KIND_EMOJI, emoji, null));
+            return this;
+        }
+
+        public Builder reaction(@NonNull String messageId, @NonNull String reaction) {
+            mSegments.add(new Segment(KIND_REACTION, reaction, truncate(messageId)));
+            return this;
+        }
+
+        @NonNull
+        public VideoChatChatPayload build() {
+            return new VideoChatChatPayload(new ArrayList<>(mSegments));
+        }
+    }
+
+    private final List<Segment> mSegments;
+
+    private VideoChatChatPayload(@NonNull List<Segment> segments) {
+        mSegments = Collections.unmodifiableList(segments);
+    }
+
+    @NonNull
+    public static VideoChatChatPayload text(@NonNull String text) {
+        return new Builder().text(text).build();
+    }
+
+    @NonNull
+    public List<Segment> getSegments() {
+        return mSegments;
+    }
+
+    /**
+     * @return true if the message is one piece of text, sent without the binary form
+     */
+    public boolean isPlain() {
+        return mSegments.isEmpty() || (mSegments.size() == 1 && mSegments.get(0).kind == KIND_TEXT);
+    }
+
+    /**
+     * @return the text to show in the chat list
+     */
+    @NonNull
+    public String toDisplayText() {
+        if (isPlain()) {
+            return mSegments.isEmpty() ? "" : mSegments.get(0).value;
+        }
+        StringBuilder out = new StringBuilder();
+        for (Segment segment : mSegments) {
+            if (segment.kind == KIND_MENTION) {
+                out.append('@');
+            }
+            out.append(segment.value);
+        }
+        return out.toString();
+    }
+
+    /**
+     * @return the message field of viSendMessage and the room message
+     */
+    @NonNull
+    public String toWire() {
+        if (!isPlain()) {
+            return RICH_PREFIX + VideoChatSeatSei.toBase64(encode());
+        }
+        String text = toDisplayText();
+        boolean escape = (!text.isEmpty() && text.charAt(0) == ESCAPE)
+                || (isUrlEncodedAlphabet(text) && (text.indexOf('%') >= 0 || text.indexOf('+') >= 0));
+        return escape ? ESCAPE + text : text;
+    }
+
+    /**
+     * Reads every form sent so far: plain, escaped, rich and the URL-encoded text of earlier
+     * versions. Never fails, text that does not parse is shown as it came.
+     */
+    @NonNull
+    public static VideoChatChatPayload fromWire(@Nullable String wire) {
+        if (wire == null || wire.isEmpty()) {
+            return text("");
+        }
+        if (wire.startsWith(RICH_PREFIX)) {
+            byte[] data = VideoChatSeatSei.fromBase64(wire.substring(RICH_PREFIX.length()));
+            VideoChatChatPayload payload = data == null ? null : decode(data);
+            return payload != null ? payload : text(wire);
+        }
+        if (wire.charAt(0) == ESCAPE) {
+            return text(wire.substring(1));
+        }
+        if (isUrlEncodedAlphabet(wire) && (wire.indexOf('%') >= 0 || wire.indexOf('+') >= 0)) {
+            try {
+                return text(URLDecoder.decode(wire, "UTF-8"));
+            } catch (UnsupportedEncodingException | IllegalArgumentException e) {
+                return text(wire);
+            }
+        }
+        return text(wire);
+    }
+
+    @NonNull
+    byte[] encode() {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        out.write(FORMAT_VERSION);
+        out.write(0);
+        for (Segment segment : mSegments) {
+            byte[] value = segment.value.getBytes(StandardCharsets.UTF_8);
+            byte[] target = segment.target == null ? null : segment.target.getBytes(StandardCharsets.UTF_8);
+            int length = value.length + (target == null ? 0 : 1 + target.length);
+            out.write(segment.kind);
+            for (int rest = length; ; rest >>>= 7) {
+                if (rest < 0x80) {
+                    out.write(rest);
+                    break;
+                }
+                out.write(rest & 0x7F | 0x80);
+            }
+            if (target != null) {
+                out.write(target.length);
+                out.write(target, 0, target.length);
+            }
+            out.write(value, 0, value.length);
+        }
+        return out.toByteArray();
+    }
+
+    /**
+     * @return null if the data is cut or not a chat payload
+     */
+    @Nullable
+    static VideoChatChatPayload decode(@NonNull byte[] data) {
+        if (data.length < 2 || data[0] == 0) {
+            return null;
+        }
+        int pos = 2 + (data[1] & 0xFF);
+        List<Segment> segments = new ArrayList<>();
+        while (pos < data.length) {
+            int kind = data[pos++] & 0xFF;
+            int length = 0;
+            for (int shift = 0; ; shift += 7) {
+                if (pos >= data.length || shift > 21) {
+                    return null;
+                }
+                int b = data[pos++] & 0xFF;
+                length |= (b & 0x7F) << shift;
+                if ((b & 0x80) == 0) {
+                    break;
+                }
+            }
+            int end = pos + length;
+            if (end > data.length) {
+                return null;
+            }
+            if (kind == KIND_TEXT || kind == KIND_EMOJI) {
+                segments.add(new Segment(kind, new String(data, pos, length, StandardCharsets.UTF_8), null));
+            } else if (kind == KIND_MENTION || kind == KIND_REACTION) {
+                int idLength = length == 0 ? -1 : data[pos] & 0xFF;
+                if (idLength < 0 || 1 + idLength > length) {
+                    return null;
+                }
+                String target = new String(data, pos + 1, idLength, StandardCharsets.UTF_8);
+                String value = new String(data, pos + 1 + idLength, length - 1 - idLength, StandardCharsets.UTF_8);
+                segments.add(new Segment(kind, value, target));
+            }
+            pos = end;
+        }
+        return pos == data.length ? new VideoChatChatPayload(segments) : null;
+    }
+
+    private static boolean isUrlEncodedAlphabet(@NonNull String text) {
+        for (int i = 0; i < text.length(); i++) {
+            char c = text.charAt(i);
+            boolean allowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+                    || c == '.' || c == '*' || c == '_' || c == '-' || c == '+' || c == '%';
+            if (!allowed) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    @NonNull
+    private static String truncate(@NonNull String id) {
+        String out = id;
+        while (out.getBytes(StandardCharsets.UTF_8).length > MAX_ID_BYTES) {
+            out = out.substring(0, out.length() - 1);
+        }
+        return out;
+    }
+}
@@ -82,6 +82,7 @@ public class VideoChatDataManager {
     private int mUserVolume = 100;
     private boolean isFirstSetBGMSwitch = true;
     private boolean isSelfApply = false;
+    private boolean isMixedStreamEnabled = false;
 
     public void clearData() {
         selfUserInfo = null;
@@ -93,6 +94,7 @@ public class VideoChatDataManager {
         mUserVolume = 100;
         isFirstSetBGMSwitch = true;
         isSelfApply = false;
+        isMixedStreamEnabled = false;
         selfInviteStatus = INTERACT_STATUS_NORMAL;
     }
 
@@ -143,4 +145,15 @@ public class VideoChatDataManager {
     public boolean getSelfApply() {
         return isSelfApply;
     }
+
+    /**
+     * Host option: let audiences watch one server side mixed stream instead of every seat.
+     */
+    public void setMixedStreamEnabled(boolean isMixedStreamEnabled) {
+        this.isMixedStreamEnabled = isMixedStreamEnabled;
+    }
+
+    public boolean isMixedStreamEnabled() {
+        return isMixedStreamEnabled;
+    }
 }
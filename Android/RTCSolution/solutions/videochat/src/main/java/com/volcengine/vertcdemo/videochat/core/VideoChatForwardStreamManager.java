@@ -0,0 +1,607 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.IntDef;
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.common.Clock;
+import com.volcengine.vertcdemo.common.Scheduler;
+
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Random;
+import java.util.concurrent.CopyOnWriteArrayList;
+
+/**
+ * Keeps the local stream relayed into the rooms of the other PK anchors.
+ *
+ * Every target room has its own state. A failed relay is retried with jittered backoff, an
+ * invalid token is fetched again first, and tokens with a known expiry are refreshed before
+ * they run out. A relay that reports a disconnect and does not come back within
+ * {@link #DEFAULT_STALL_TIMEOUT_MS} is restarted.
+ *
+ * SDK calls go through {@link Relay}; the SDK forward stream callbacks are fed in through
+ * {@link #onStateChanged(String, int, int)} and {@link #onEvent(String, int)}. Relay calls, token
+ * fetches and listeners are queued under the lock and run after it is released.
+ */
+public class VideoChatForwardStreamManager {
+
+    /*** Not relaying, or removed */
+    public static final int TARGET_IDLE = 0;
+    /*** Relay requested, waiting for the SDK to report success */
+    public static final int TARGET_STARTING = 1;
+    /*** Relaying */
+    public static final int TARGET_RELAYING = 2;
+    /*** Relay connection interrupted, the SDK is reconnecting by itself */
+    public static final int TARGET_STALLED = 3;
+    /*** Relay failed, waiting for the next attempt */
+    public static final int TARGET_RETRYING = 4;
+    /*** Attempts used up */
+    public static final int TARGET_FAILED = 5;
+
+    @IntDef({TARGET_IDLE, TARGET_STARTING, TARGET_RELAYING, TARGET_STALLED, TARGET_RETRYING, TARGET_FAILED})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface TargetState {
+    }
+
+    // ForwardStreamState values reported by the SDK.
+    public static final int SDK_STATE_IDLE = 0;
+    public static final int SDK_STATE_SUCCESS = 1;
+    public static final int SDK_STATE_FAILURE = 2;
+
+    // ForwardStreamError values reported by the SDK.
+    public static final int SDK_ERROR_OK = 0;
+    public static final int SDK_ERROR_INVALID_ARGUMENT = 1201;
+    public static final int SDK_ERROR_INVALID_TOKEN = 1202;
+    public static final int SDK_ERROR_RESPONSE = 1203;
+    public static final int SDK_ERROR_REMOTE_KICKED = 1204;
+    public static final int SDK_ERROR_NOT_SUPPORT = 1205;
+
+    // ForwardStreamEvent values reported by the SDK.
+    public static final int SDK_EVENT_DISCONNECTED = 0;
+    public static final int SDK_EVENT_CONNECTED = 1;
+    public static final int SDK_EVENT_INTERRUPT = 2;
+    public static final int SDK_EVENT_RECOVER = 3;
+
+    public static final long DEFAULT_BASE_DELAY_MS = 1_000;
+    public static final long DEFAULT_MAX_DELAY_MS = 16_000;
+    public static final int DEFAULT_MAX_ATTEMPTS = 6;
+    public static final long DEFAULT_STALL_TIMEOUT_MS = 5_000;
+    public static final long DEFAULT_TOKEN_REFRESH_LEAD_MS = 60_000;
+
+    /**
+     * The SDK relay. start/update take every room that should be relayed to; rooms left out
+     * of an update stop relaying.
+     */
+    public interface Relay {
+        void start(@NonNull List<Target> targets);
+
+        void update(@NonNull List<Target> targets);
+
+        void stop();
+    }
+
+    public interface TokenProvider {
+        /**
+         * Fetch a token to publish into the room, answer through the callback on any thread.
+         */
+        void fetch(@NonNull String roomId, @NonNull TokenCallback callback);
+    }
+
+    public interface TokenCallback {
+        /**
+         * @param expiresAtMs expiry on the manager clock, 0 if unknown
+         */
+        void onToken(@NonNull String token, long expiresAtMs);
+
+        void onError(int code, @Nullable String message);
+    }
+
+    public interface Listener {
+        void onTargetStateChanged(@NonNull String roomId, @TargetState int oldState, @TargetState int newState);
+    }
+
+    /**
+     * Relay health of one target room.
+     */
+    public static final class Metrics {
+        /*** Relay requests sent to the SDK, first start and retries */
+        public int attempts;
+        public int failures;
+        public int stalls;
+        public int tokenRefreshes;
+        /*** Request to success of the latest start, -1 before the first success */
+        public long lastStartLatencyMs = -1;
+        public long maxStartLatencyMs = -1;
+        /*** Time spent relaying, up to the last state change */
+        public long relayingMs;
+        public int lastError;
+    }
+
+    public static final class Target {
+        public final String roomId;
+        public String token;
+        long expiresAtMs;
+        @TargetState
+        int state = TARGET_IDLE;
+        int attempt;
+        long requestedAtMs;
+        long relayingSinceMs;
+        boolean fetchingToken;
+        final Metrics metrics = new Metrics();
+        Runnable pendingTask;
+
+        Target(String roomId, String token, long expiresAtMs) {
+            this.roomId = roomId;
+            this.token = token;
+            this.expiresAtMs = expiresAtMs;
+        }
+    }
+
+    private final Relay mRelay;
+    private final TokenProvider mTokenProvider;
+    private final Scheduler mScheduler;
+    private final Clock mClock;
+    private final Random mRandom;
+    private final List<Listener> mListeners = new CopyOnWriteArrayList<>();
+    private final LinkedHashMap<String, Target> mTargets = new LinkedHashMap<>();
+    private boolean mRelayStarted;
+
+    // Relay calls, token fetches and state notifications, queued under the lock and run outside it.
+    private final ArrayDeque<Runnable> mDeliveries = new ArrayDeque<>();
+    private boolean mDelivering;
+
+    private long mBaseDelayMs = DEFAULT_BASE_DELAY_MS;
+    private long mMaxDelayMs = DEFAULT_MAX_DELAY_MS;
+    private int mMaxAttempts = DEFAULT_MAX_ATTEMPTS;
+    private long mStallTimeoutMs = DEFAULT_STALL_TIMEOUT_MS;
+    private long mTokenRefreshLeadMs = DEFAULT_TOKEN_REFRESH_LEAD_MS;
+
+    public VideoChatForwardStreamManager(@NonNull Relay relay, @NonNull TokenProvider tokenProvider,
+                                         @NonNull Scheduler scheduler,
+                                         @NonNull Clock clock, @NonNull Random random) {
+        mRelay = relay;
+        mTokenProvider = tokenProvider;
+        mScheduler = scheduler;
+        mClock = clock;
+        mRandom = random;
+    }
+
+    public synchronized void setRetryPolicy(long baseDelayMs, long maxDelayMs, int maxAttempts,
+                                            long stallTimeoutMs, long tokenRefreshLeadMs) {
+        mBaseDelayMs = baseDelayMs;
+        mMaxDelayMs = maxDelayMs;
+        mMaxAttempts = maxAttempts;
+        mStallTimeoutMs = stallTimeoutMs;
+        mTokenRefreshLeadMs = tokenRefreshLeadMs;
+    }
+
+    public void addListener(@NonNull Listener listener) {
+        mListeners.add(listener);
+    }
+
+    public void removeListener(@NonNull Listener listener) {
+        mListeners.remove(listener);
+    }
+
+    /**
+     * Start relaying into a room, or replace the token of a room already relayed to.
+     * A new room without a token is fetched one from the token provider first.
+     *
+     * @param expiresAtMs token expiry on the manager clock, 0 if unknown
+     */
+    public void addTarget(@NonNull String roomId, @Nullable String token, long expiresAtMs) {
+        locked(() -> {
+            Target target = mTargets.get(roomId);
+            if (target != null) {
+                if (token != null && !token.isEmpty()) {
+                    target.token = token;
+                    target.expiresAtMs = expiresAtMs;
+                }
+                if (target.state == TARGET_FAILED) {
+                    target.attempt = 0;
+                    begin(target);
+                } else {
+                    pushTargets();
+                    scheduleTokenRefresh(target);
+                }
+                return;
+            }
+            target = new Target(roomId, token, expiresAtMs);
+            mTargets.put(roomId, target);
+            begin(target);
+        });
+    }
+
+    public void removeTarget(@NonNull String roomId) {
+        locked(() -> {
+            Target target = mTargets.remove(roomId);
+            if (target == null) {
+                return;
+            }
+            cancelPending(target);
+            setState(target, TARGET_IDLE);
+            pushTargets();
+        });
+    }
+
+    /**
+     * PK ended, stop relaying to every room.
+     */
+    public void removeAll() {
+        locked(() -> {
+            for (Target target : new ArrayList<>(mTargets.values())) {
+                cancelPending(target);
+                setState(target, TARGET_IDLE);
+            }
+            mTargets.clear();
+            if (mRelayStarted) {
+                mRelayStarted = false;
+                mDeliveries.addLast(mRelay::stop);
+            }
+        });
+    }
+
+    @TargetState
+    public synchronized int getState(@NonNull String roomId) {
+        Target target = mTargets.get(roomId);
+        return target == null ? TARGET_IDLE : target.state;
+    }
+
+    /**
+     * @return a copy of the metrics of the room, null if it is not a target
+     */
+    @Nullable
+    public synchronized Metrics getMetrics(@NonNull String roomId) {
+        Target target = mTargets.get(roomId);
+        if (target == null) {
+            return null;
+        }
+        Metrics copy = new Metrics();
+        Metrics metrics = target.metrics;
+        copy.attempts = metrics.attempts;
+        copy.failures = metrics.failures;
+        copy.stalls = metrics.stalls;
+        copy.tokenRefreshes = metrics.tokenRefreshes;
+        copy.lastStartLatencyMs = metrics.lastStartLatencyMs;
+        copy.maxStartLatencyMs = metrics.maxStartLatencyMs;
+        copy.relayingMs = metrics.relayingMs
+                + (target.state == TARGET_RELAYING ? mClock.now() - target.relayingSinceMs : 0);
+        copy.lastError = metrics.lastError;
+        return copy;
+    }
+
+    public synchronized List<String> getTargetRoomIds() {
+        return new ArrayList<>(mTargets.keySet());
+    }
+
+    /**
+     * SDK onForwardStreamStateChanged, one call per room.
+     */
+    public void onStateChanged(@NonNull String roomId, int sdkState, int sdkError) {
+        locked(() -> {
+            Target target = mTargets.get(roomId);
+            if (target == null) {
+                return;
+            }
+            if (sdkState == SDK_STATE_SUCCESS) {
+                cancelPending(target);
+                long latency = mClock.now() - target.requestedAtMs;
+                target.metrics.lastStartLatencyMs = latency;
+                target.metrics.maxStartLatencyMs = Math.max(target.metrics.maxStartLatencyMs, latency);
+                target.attempt = 0;
+                setState(target, TARGET_RELAYING);
+                scheduleTokenRefresh(target);
+            } else if (sdkState == SDK_STATE_FAILURE) {
+                target.metrics.failures++;
+                target.metrics.lastError = sdkError;
+                onFailed(target, sdkError);
+            } else if (target.state == TARGET_RELAYING || target.state == TARGET_STALLED) {
+                // Stopped although still a target, e.g. the SDK gave up reconnecting.
+                target.metrics.failures++;
+                onFailed(target, sdkError);
+            }
+        });
+    }
+
+    /**
+     * SDK onForwardStreamEvent, one call per room. A stall is set by a disconnect or an
+     * interrupt and cleared by a connect or a recover.
+     */
+    public void onEvent(@NonNull String roomId, int sdkEvent) {
+        locked(() -> {
+            Target target = mTargets.get(roomId);
+            if (target == null) {
+                return;
+            }
+            if (sdkEvent == SDK_EVENT_DISCONNECTED || sdkEvent == SDK_EVENT_INTERRUPT) {
+                if (target.state != TARGET_RELAYING) {
+                    return;
+                }
+                target.metrics.stalls++;
+                setState(target, TARGET_STALLED);
+                schedule(target, () -> onStallTimeout(target), mStallTimeoutMs);
+            } else if ((sdkEvent == SDK_EVENT_CONNECTED || sdkEvent == SDK_EVENT_RECOVER)
+                    && target.state == TARGET_STALLED) {
+                cancelPending(target);
+                setState(target, TARGET_RELAYING);
+                scheduleTokenRefresh(target);
+            }
+        });
+    }
+
+    /**
+     * Delay before the given retry (1 based): half fixed, half random, capped.
+     */
+    public synchronized long backoffDelay(int attempt) {
+        long delay = mBaseDelayMs << Math.min(attempt - 1, 20);
+        if (delay <= 0 || delay > mMaxDelayMs) {
+            delay = mMaxDelayMs;
+        }
+        long half = delay / 2;
+        return half + (long) (mRandom.nextDouble() * (delay - half));
+    }
+
+    private void onStallTimeout(Target target) {
+        locked(() -> {
+            if (mTargets.get(target.roomId) != target || target.state != TARGET_STALLED) {
+                return;
+            }
+            target.metrics.failures++;
+            onFailed(target, SDK_ERROR_OK);
+        });
+    }
+
+    private void onFailed(Target target, int sdkError) {
+        cancelPending(target);
+        if (sdkError == SDK_ERROR_INVALID_ARGUMENT || sdkError == SDK_ERROR_NOT_SUPPORT
+                || target.attempt >= mMaxAttempts) {
+            setState(target, TARGET_FAILED);
+            return;
+        }
+        setState(target, TARGET_RETRYING);
+        target.attempt++;
+        if (sdkError == SDK_ERROR_INVALID_TOKEN) {
+            refreshToken(target, true);
+            return;
+        }
+        schedule(target, () -> onRetry(target), backoffDelay(target.attempt));
+    }
+
+    private void onRetry(Target target) {
+        locked(() -> {
+            if (mTargets.get(target.roomId) != target || target.state != TARGET_RETRYING) {
+                return;
+            }
+            target.pendingTask = null;
+            request(target);
+        });
+    }
+
+    private void begin(Target target) {
+        if (target.token == null || target.token.isEmpty()) {
+            setState(target, TARGET_STARTING);
+            refreshToken(target, true);
+            return;
+        }
+        request(target);
+    }
+
+    private void request(Target target) {
+        boolean retry = target.metrics.attempts > 0;
+        target.requestedAtMs = mClock.now();
+        target.metrics.attempts++;
+        setState(target, TARGET_STARTING);
+        if (!retry || !mRelayStarted) {
+            pushTargets();
+            return;
+        }
+        if (mTargets.size() > 1) {
+            // Take the room out and put it back in so the SDK starts it over.
+            List<Target> others = relayedTargets();
+            others.remove(target);
+            relay(others, false);
+        } else {
+            mDeliveries.addLast(mRelay::stop);
+            mRelayStarted = false;
+        }
+        pushTargets();
+    }
+
+    private void pushTargets() {
+        List<Target> targets = relayedTargets();
+        if (targets.isEmpty()) {
+            if (mRelayStarted) {
+                mRelayStarted = false;
+                mDeliveries.addLast(mRelay::stop);
+            }
+        } else if (mRelayStarted) {
+            relay(targets, false);
+        } else {
+            mRelayStarted = true;
+            relay(targets, true);
+        }
+    }
+
+    /**
+     * Queue a start or update with copies of the targets, their tokens may change before it runs.
+     */
+    private void relay(List<Target> targets, boolean start) {
+        List<Target> copies = new ArrayList<>(targets.size());
+        for (Target target : targets) {
+            copies.add(new Target(target.roomId, target.token, target.expiresAtMs));
+        }
+        mDeliveries.addLast(() -> {
+            if (start) {
+                mRelay.start(copies);
+            } else {
+                mRelay.update(copies);
+            }
+        });
+    }
+
+    /**
+     * @return targets that have a token, rooms still waiting for their first one are left out
+     */
+    private List<Target> relayedTargets() {
+        List<Target> targets = new ArrayList<>(mTargets.size());
+        for (Target target : mTargets.values()) {
+            if (target.token != null && !target.token.isEmpty()) {
+                targets.add(target);
+            }
+        }
+        return targets;
+    }
+
+    private void scheduleTokenRefresh(Target target) {
+        if (target.expiresAtMs <= 0 || target.state != TARGET_RELAYING) {
+            return;
+        }
+        long delay = Math.max(0, target.expiresAtMs - mTokenRefreshLeadMs - mClock.now());
+        schedule(target, () -> locked(() -> {
+            if (mTargets.get(target.roomId) == target) {
+                target.pendingTask = null;
+                refreshToken(target, false);
+            }
+        }), delay);
+    }
+
+    /**
+     * @param restart the relay failed on the token and has to be requested again
+     */
+    private void refreshToken(Target target, boolean restart) {
+        if (target.fetchingToken) {
+            return;
+        }
+        target.fetchingToken = true;
+        target.metrics.tokenRefreshes++;
+        TokenCallback callback = new TokenCallback() {
+            @Override
+            public void onToken(@NonNull String token, long expiresAtMs) {
+                locked(() -> {
+                    target.fetchingToken = false;
+                    if (mTargets.get(target.roomId) != target) {
+                        return;
+                    }
+                    target.token = token;
+                    target.expiresAtMs = expiresAtMs;
+                    if (restart || target.state == TARGET_RETRYING) {
+                        request(target);
+                    } else {
+                        pushTargets();
+                        scheduleTokenRefresh(target);
+                    }
+                });
+            }
+
+            @Override
+            public void onError(int code, @Nullable String message) {
+                locked(() -> {
+                    target.fetchingToken = false;
+                    if (mTargets.get(target.roomId) != target) {
+                        return;
+                    }
+                    if (target.attempt >= mMaxAttempts) {
+                        setState(target, TARGET_FAILED);
+                        return;
+                    }
+                    target.attempt++;
+                    // Try the fetch again later, the current token may still work until then.
+                    schedule(target, () -> locked(() -> {
+                        if (mTargets.get(target.roomId) == target) {
+                            target.pendingTask = null;
+                            refreshToken(target, restart);
+                        }
+                    }), backoffDelay(target.attempt));
+                });
+            }
+        };
+        String roomId = target.roomId;
+        mDeliveries.addLast(() -> mTokenProvider.fetch(roomId, callback));
+    }
+
+    private void schedule(Target target, Runnable task, long delayMs) {
+        cancelPending(target);
+        target.pendingTask = task;
+        mScheduler.schedule(task, delayMs);
+    }
+
+    private void cancelPending(Target target) {
+        if (target.pendingTask != null) {
+            mScheduler.cancel(target.pendingTask);
+            target.pendingTask = null;
+        }
+    }
+
+    private void setState(Target target, @TargetState int state) {
+        int old = target.state;
+        if (old == state) {
+            return;
+        }
+        long now = mClock.now();
+        if (old == TARGET_RELAYING) {
+            target.metrics.relayingMs += now - target.relayingSinceMs;
+        }
+        if (state == TARGET_RELAYING) {
+            target.relayingSinceMs = now;
+        }
+        target.state = state;
+        String roomId = target.roomId;
+        mDeliveries.addLast(() -> {
+            for (Listener listener : mListeners) {
+                listener.onTargetStateChanged(roomId, old, state);
+            }
+        });
+    }
+
+    /**
+     * Run the body under the lock, then what it queued without it.
+     */
+    private void locked(Runnable body) {
+        synchronized (this) {
+            body.run();
+        }
+        deliver();
+    }
+
+    /**
+     * Run the queued deliveries without holding the lock. One thread drains at a time so they
+     * keep their order, calls made from a listener are run after it returns.
+     */
+    private void deliver() {
+        synchronized (this) {
+            if (mDelivering) {
+                return;
+            }
+            mDelivering = true;
+        }
+        boolean drained = false;
+        try {
+            while (true) {
+                Runnable delivery;
+                synchronized (this) {
+                    delivery = mDeliveries.pollFirst();
+                    if (delivery == null) {
+                        mDelivering = false;
+                        drained = true;
+                        return;
+                    }
+                }
+                delivery.run();
+            }
+        } finally {
+            if (!drained) {
+                synchronized (this) {
+                    mDelivering = false;
+                }
+            }
+        }
+    }
+}
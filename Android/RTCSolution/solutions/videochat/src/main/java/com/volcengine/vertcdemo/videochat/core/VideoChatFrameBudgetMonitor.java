@@ -0,0 +1,253 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.IntDef;
+import androidx.annotation.Nullable;
+
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+
+/**
+ * Watches whether the capture pipeline keeps up, and steps the video effects down when it can't.
+ *
+ * Each sample is either one frame with its processing time, see {@link #onFrame}, or one stats
+ * report comparing the frames that made it through the pipeline against the frames captured,
+ * see {@link #onReport}. A slow camera, e.g. in dim light, lowers both rates and is not a miss.
+ *
+ * The last samples are kept in a window. When a quarter of them miss the level goes one step
+ * down; once samples have stayed within budget for a while it goes one step up again. Every
+ * step down doubles the time needed to come back, so a device that can't carry the effects
+ * stops flapping between levels. {@link #setMaxLevel} bounds how far it steps down.
+ *
+ * Times are passed in. Call on the main thread.
+ */
+public class VideoChatFrameBudgetMonitor {
+
+    /*** Effects as the user set them */
+    public static final int LEVEL_FULL = 0;
+    /*** Effects on, fewer frames to process */
+    public static final int LEVEL_REDUCED = 1;
+    /*** Effects off */
+    public static final int LEVEL_OFF = 2;
+
+    @IntDef({LEVEL_FULL, LEVEL_REDUCED, LEVEL_OFF})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface Level {
+    }
+
+    public interface Listener {
+        void onLevelChanged(@Level int oldLevel, @Level int newLevel);
+    }
+
+    /*** Window for {@link #onFrame} */
+    public static final int WINDOW_FRAMES = 60;
+    /*** Window for {@link #onReport}, with 2 second reports one short report is a spike */
+    public static final int WINDOW_REPORTS = 8;
+    /*** Samples over budget in the window, in percent, that step down */
+    static final int DOWNGRADE_PERCENT = 25;
+    /*** Samples over budget in the window, in percent, still counted as healthy */
+    static final int HEALTHY_PERCENT = 5;
+    /*** A frame this much over its budget, or a report this much short of its rate, in percent, misses */
+    static final int SLACK_PERCENT = 10;
+    /*** No step right after another one, the pipeline needs time to settle */
+    static final long SETTLE_MS = 3_000;
+    static final long UPGRADE_AFTER_MS = 15_000;
+    static final long MAX_UPGRADE_AFTER_MS = 240_000;
+
+    private final boolean[] mWindow;
+    private int mWindowSize;
+    private int mWindowNext;
+    private int mWindowOver;
+    private int mFrameRate;
+    private long mBudgetUs;
+    @Level
+    private int mLevel = LEVEL_FULL;
+    @Level
+    private int mMaxLevel = LEVEL_OFF;
+    private long mLastChangeMs = -1;
+    private long mHealthySinceMs = -1;
+    private long mUpgradeAfterMs = UPGRADE_AFTER_MS;
+    @Nullable
+    private Listener mListener;
+
+    private long mFrameCount;
+    private long mOverBudgetCount;
+    private int mDowngradeCount;
+    private int mUpgradeCount;
+    private long mWorstFrameUs;
+
+    /**
+     * @param frameRate frames per second the pipeline has to keep up with
+     */
+    public VideoChatFrameBudgetMonitor(int frameRate) {
+        this(frameRate, WINDOW_FRAMES);
+    }
+
+    /**
+     * @param windowSize samples kept, {@link #WINDOW_FRAMES} or {@link #WINDOW_REPORTS}
+     */
+    public VideoChatFrameBudgetMonitor(int frameRate, int windowSize) {
+        mWindow = new boolean[Math.max(1, windowSize)];
+        setFrameRate(frameRate);
+    }
+
+    public void setListener(@Nullable Listener listener) {
+        mListener = listener;
+    }
+
+    /**
+     * The frame rate changed, e.g. by a step to {@link #LEVEL_REDUCED}. The window starts over.
+     */
+    public void setFrameRate(int frameRate) {
+        mFrameRate = Math.max(1, frameRate);
+        mBudgetUs = 1_000_000L / mFrameRate;
+        clearWindow();
+    }
+
+    /**
+     * Lowest level to step down to, e.g. {@link #LEVEL_REDUCED} when the samples are only a proxy
+     * for the processing time and turning the effects off would be out of proportion.
+     */
+    public void setMaxLevel(@Level int maxLevel) {
+        mMaxLevel = maxLevel;
+    }
+
+    public long getBudgetUs() {
+        return mBudgetUs;
+    }
+
+    @Level
+    public int getLevel() {
+        return mLevel;
+    }
+
+    /**
+     * One frame went through the pipeline.
+     */
+    public void onFrame(long frameUs, long nowMs) {
+        record(frameUs);
+        evaluate(nowMs);
+    }
+
+    /**
+     * One stats report: frames per second captured and frames per second that made it through the
+     * pipeline. The report misses when fewer frames got through than were captured, up to the
+     * frame rate set.
+     * @param intervalMs time the report covers
+     */
+    public void onReport(int capturedFps, int processedFps, long intervalMs, long nowMs) {
+        int expectedFps = Math.min(capturedFps, mFrameRate);
+        if (expectedFps <= 0) {
+            return;
+        }
+        boolean over = processedFps * 100L < expectedFps * (100L - SLACK_PERCENT);
+        mFrameCount += capturedFps * intervalMs / 1000;
+        if (over) {
+            mOverBudgetCount += (expectedFps - processedFps) * intervalMs / 1000;
+        }
+        push(over);
+        evaluate(nowMs);
+    }
+
+    /**
+     * Back to {@link #LEVEL_FULL} without telling the listener, e.g. for a new engine.
+     */
+    public void reset() {
+        mLevel = LEVEL_FULL;
+        mLastChangeMs = -1;
+        mHealthySinceMs = -1;
+        mUpgradeAfterMs = UPGRADE_AFTER_MS;
+        clearWindow();
+    }
+
+    public long getFrameCount() {
+        return mFrameCount;
+    }
+
+    public long getOverBudgetCount() {
+        return mOverBudgetCount;
+    }
+
+    public int getDowngradeCount() {
+        return mDowngradeCount;
+    }
+
+    public int getUpgradeCount() {
+        return mUpgradeCount;
+    }
+
+    public long getWorstFrameUs() {
+        return mWorstFrameUs;
+    }
+
+    private void record(long frameUs) {
+        boolean over = frameUs * 100 > mBudgetUs * (100 + SLACK_PERCENT);
+        mFrameCount++;
+        mWorstFrameUs = Math.max(mWorstFrameUs, frameUs);
+        if (over) {
+            mOverBudgetCount++;
+        }
+        push(over);
+    }
+
+    private void push(boolean over) {
+        if (mWindowSize == mWindow.length) {
+            if (mWindow[mWindowNext]) {
+                mWindowOver--;
+            }
+        } else {
+            mWindowSize++;
+        }
+        mWindow[mWindowNext] = over;
+        if (over) {
+            mWindowOver++;
+        }
+        mWindowNext = (mWindowNext + 1) % mWindow.length;
+    }
+
+    private void evaluate(long nowMs) {
+        if (mWindowSize < mWindow.length) {
+            return;
+        }
+        if (mLastChangeMs >= 0 && nowMs - mLastChangeMs < SETTLE_MS) {
+            return;
+        }
+        int overPercent = mWindowOver * 100 / mWindow.length;
+        if (overPercent >= DOWNGRADE_PERCENT) {
+            mHealthySinceMs = -1;
+            if (mLevel < mMaxLevel) {
+                mDowngradeCount++;
+                mUpgradeAfterMs = Math.min(mUpgradeAfterMs * 2, MAX_UPGRADE_AFTER_MS);
+                changeLevel(mLevel + 1, nowMs);
+            }
+        } else if (overPercent <= HEALTHY_PERCENT) {
+            if (mHealthySinceMs < 0) {
+                mHealthySinceMs = nowMs;
+            } else if (mLevel > LEVEL_FULL && nowMs - mHealthySinceMs >= mUpgradeAfterMs) {
+                mUpgradeCount++;
+                changeLevel(mLevel - 1, nowMs);
+            }
+        } else {
+            mHealthySinceMs = -1;
+        }
+    }
+
+    private void changeLevel(@Level int level, long nowMs) {
+        int oldLevel = mLevel;
+        mLevel = level;
+        mLastChangeMs = nowMs;
+        mHealthySinceMs = -1;
+        clearWindow();
+        if (mListener != null) {
+            mListener.onLevelChanged(oldLevel, level);
+        }
+    }
+
+    private void clearWindow() {
+        mWindowSize = 0;
+        mWindowNext = 0;
+        mWindowOver = 0;
+    }
+}
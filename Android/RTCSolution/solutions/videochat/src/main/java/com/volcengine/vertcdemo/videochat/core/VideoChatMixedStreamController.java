@@ -0,0 +1,253 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.IntDef;
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.common.Scheduler;
+
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+
+/**
+ * Keeps the server side mixed stream of the host's room in step with the seats.
+ *
+ * Every seat change hands the latest layout to {@link #onLayoutChanged}; a layout equal to the
+ * last one the server accepted is not sent again, and while a request is in flight only the
+ * newest layout is kept and sent when it returns. A rejected update is sent again with the
+ * next change, or after a backoff that doubles with every rejection in a row.
+ *
+ * Call on the main thread.
+ */
+public class VideoChatMixedStreamController {
+
+    /*** Mixing is off */
+    public static final int STATE_OFF = 0;
+    /*** First layout sent, waiting for the server */
+    public static final int STATE_STARTING = 1;
+    /*** Server is mixing with the last accepted layout */
+    public static final int STATE_MIXING = 2;
+    /*** Last request was rejected */
+    public static final int STATE_FAILED = 3;
+    /*** Stop sent, waiting for the server */
+    public static final int STATE_STOPPING = 4;
+
+    public static final long RETRY_BASE_DELAY_MS = 1_000;
+    public static final long RETRY_MAX_DELAY_MS = 30_000;
+
+    @IntDef({STATE_OFF, STATE_STARTING, STATE_MIXING, STATE_FAILED, STATE_STOPPING})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface State {
+    }
+
+    public interface Callback {
+        void onResult(boolean success);
+    }
+
+    /**
+     * Business server calls, see VideoChatRTSClient#updateMixedStream and #stopMixedStream.
+     */
+    public interface Requester {
+        void update(@NonNull String layoutJson, @NonNull Callback callback);
+
+        void stop(@NonNull Callback callback);
+    }
+
+    private final Requester mRequester;
+    private final Scheduler mScheduler;
+    private final Runnable mRetryTask = this::retry;
+    @State
+    private int mState = STATE_OFF;
+    private boolean mEnabled;
+    private boolean mInFlight;
+    @Nullable
+    private String mPendingJson;
+    @Nullable
+    private String mAcceptedJson;
+    private boolean mPendingStop;
+    private int mRequestCount;
+    private int mSkippedCount;
+    private int mFailureCount;
+    // Rejections in a row, sets the retry backoff.
+    private int mRetryAttempt;
+
+    public VideoChatMixedStreamController(@NonNull Requester requester,
+                                          @NonNull Scheduler scheduler) {
+        mRequester = requester;
+        mScheduler = scheduler;
+    }
+
+    /**
+     * Turns mixing on or off. Turning it on sends {@code layout} right away.
+     */
+    public void setEnabled(boolean enabled, @Nullable VideoChatMixedStreamLayout layout) {
+        if (mEnabled == enabled) {
+            if (enabled && layout != null) {
+                onLayoutChanged(layout);
+            }
+            return;
+        }
+        mEnabled = enabled;
+        if (enabled) {
+            mPendingStop = false;
+            mAcceptedJson = null;
+            mState = STATE_STARTING;
+            if (layout != null) {
+                submit(layout.toJson());
+            }
+        } else {
+            cancelRetry();
+            mPendingJson = null;
+            mPendingStop = true;
+            mState = STATE_STOPPING;
+            drain();
+        }
+    }
+
+    public boolean isEnabled() {
+        return mEnabled;
+    }
+
+    public void onLayoutChanged(@NonNull VideoChatMixedStreamLayout layout) {
+        if (!mEnabled) {
+            return;
+        }
+        submit(layout.toJson());
+    }
+
+    /**
+     * Delay before the retry that follows the given number of rejections in a row.
+     */
+    public static long retryDelay(int attempt) {
+        long delay = RETRY_BASE_DELAY_MS << Math.min(attempt - 1, 20);
+        return delay <= 0 || delay > RETRY_MAX_DELAY_MS ? RETRY_MAX_DELAY_MS : delay;
+    }
+
+    /**
+     * Stops mixing when leaving the room. Results of requests still in flight are ignored.
+     */
+    public void release() {
+        cancelRetry();
+        if (mEnabled) {
+            mEnabled = false;
+            mRequester.stop(success -> {
+            });
+        }
+        mPendingJson = null;
+        mPendingStop = false;
+        mAcceptedJson = null;
+        mState = STATE_OFF;
+    }
+
+    @State
+    public int getState() {
+        return mState;
+    }
+
+    @Nullable
+    public String getAcceptedLayoutJson() {
+        return mAcceptedJson;
+    }
+
+    public int getRequestCount() {
+        return mRequestCount;
+    }
+
+    /*** Layout changes dropped because they matched the accepted layout or were superseded */
+    public int getSkippedCount() {
+        return mSkippedCount;
+    }
+
+    public int getFailureCount() {
+        return mFailureCount;
+    }
+
+    private void submit(@NonNull String json) {
+        if (mPendingJson != null) {
+            mSkippedCount++;
+        }
+        if (json.equals(mAcceptedJson) && mState == STATE_MIXING && !mInFlight) {
+            mPendingJson = null;
+            mSkippedCount++;
+            return;
+        }
+        mPendingJson = json;
+        drain();
+    }
+
+    private void drain() {
+        if (mInFlight) {
+            return;
+        }
+        if (mPendingStop) {
+            mPendingStop = false;
+            mInFlight = true;
+            mRequestCount++;
+            mRequester.stop(success -> {
+                mInFlight = false;
+                if (!success) {
+                    mFailureCount++;
+                }
+                if (!mEnabled) {
+                    mAcceptedJson = null;
+                    mState = STATE_OFF;
+                }
+                drain();
+            });
+            return;
+        }
+        final String json = mPendingJson;
+        if (!mEnabled || json == null) {
+            return;
+        }
+        if (json.equals(mAcceptedJson)) {
+            mPendingJson = null;
+            mSkippedCount++;
+            mState = STATE_MIXING;
+            return;
+        }
+        mPendingJson = null;
+        mInFlight = true;
+        mRequestCount++;
+        mScheduler.cancel(mRetryTask);
+        mRequester.update(json, success -> {
+            mInFlight = false;
+            if (!mEnabled) {
+                drain();
+                return;
+            }
+            if (success) {
+                mRetryAttempt = 0;
+                mAcceptedJson = json;
+                mState = STATE_MIXING;
+            } else {
+                mFailureCount++;
+                mState = STATE_FAILED;
+                if (mPendingJson == null) {
+                    mPendingJson = json;
+                }
+                mRetryAttempt++;
+                mScheduler.schedule(mRetryTask, retryDelay(mRetryAttempt));
+                return;
+            }
+            drain();
+        });
+    }
+
+    /**
+     * Sends the newest layout again after a rejected update.
+     */
+    private void retry() {
+        if (mEnabled && mState == STATE_FAILED && mPendingJson != null) {
+            drain();
+        }
+    }
+
+    private void cancelRetry() {
+        mScheduler.cancel(mRetryTask);
+        mRetryAttempt = 0;
+    }
+}
@@ -0,0 +1,185 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.google.gson.annotations.SerializedName;
+import com.volcengine.vertcdemo.common.GsonUtils;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Map;
+import java.util.Objects;
+
+/**
+ * Layout of the server side mixed stream of a room, derived from the seat model.
+ *
+ * The canvas mirrors VideoChatSeatsGroupLayout: a grid of {@link #COLUMNS} x {@link #ROWS}
+ * square tiles, the host in slot 0 and seat N in slot N. Empty and locked seats get no region,
+ * the server paints the background there. A guest with the camera off keeps its region with
+ * video off so the grid does not move when cameras toggle.
+ *
+ * The mixed stream is published into the room as {@link #mixUserId(String)}.
+ */
+public class VideoChatMixedStreamLayout {
+
+    public static final int LAYOUT_VERSION = 1;
+    public static final int COLUMNS = 3;
+    public static final int ROWS = 2;
+    public static final int SLOT_COUNT = COLUMNS * ROWS;
+    public static final int DEFAULT_TILE_SIZE = 240;
+    public static final String DEFAULT_BACKGROUND = "#0E0825";
+    public static final String RENDER_MODE_HIDDEN = "hidden";
+
+    /*** Prefix of the virtual user the server publishes the mixed stream as */
+    public static final String MIX_USER_PREFIX = "mix_";
+
+    public static class Region {
+        @SerializedName("user_id")
+        public String userId;
+        @SerializedName("room_id")
+        public String roomId;
+        @SerializedName("slot")
+        public int slot;
+        @SerializedName("x")
+        public int x;
+        @SerializedName("y")
+        public int y;
+        @SerializedName("width")
+        public int width;
+        @SerializedName("height")
+        public int height;
+        @SerializedName("z_order")
+        public int zOrder;
+        @SerializedName("render_mode")
+        public String renderMode = RENDER_MODE_HIDDEN;
+        @SerializedName("video")
+        public boolean video;
+        @SerializedName("audio")
+        public boolean audio;
+
+        @Override
+        public boolean equals(Object o) {
+            if (this == o) return true;
+            if (!(o instanceof Region)) return false;
+            Region region = (Region) o;
+            return slot == region.slot && x == region.x && y == region.y
+                    && width == region.width && height == region.height
+                    && zOrder == region.zOrder && video == region.video && audio == region.audio
+                    && Objects.equals(userId, region.userId)
+                    && Objects.equals(roomId, region.roomId)
+                    && Objects.equals(renderMode, region.renderMode);
+        }
+
+        @Override
+        public int hashCode() {
+            return Objects.hash(userId, roomId, slot, x, y, width, height, zOrder, renderMode, video, audio);
+        }
+
+        @Override
+        public String toString() {
+            return "Region{" +
+                    "userId='" + userId + '\'' +
+                    ", slot=" + slot +
+                    ", video=" + video +
+                    ", audio=" + audio +
+                    '}';
+        }
+    }
+
+    @SerializedName("version")
+    public int version = LAYOUT_VERSION;
+    @SerializedName("room_id")
+    public String roomId;
+    @SerializedName("canvas_width")
+    public int canvasWidth;
+    @SerializedName("canvas_height")
+    public int canvasHeight;
+    @SerializedName("background")
+    public String background = DEFAULT_BACKGROUND;
+    @SerializedName("regions")
+    public List<Region> regions = new ArrayList<>();
+
+    @NonNull
+    public static String mixUserId(@NonNull String roomId) {
+        return MIX_USER_PREFIX + roomId;
+    }
+
+    public static boolean isMixUser(@Nullable String userId) {
+        return userId != null && userId.startsWith(MIX_USER_PREFIX);
+    }
+
+    /**
+     * @param seats seat id to seat, ids outside 1 until {@link #SLOT_COUNT} are not shown in the grid
+     */
+    @NonNull
+    public static VideoChatMixedStreamLayout build(@NonNull String roomId,
+                                                   @Nullable VideoChatUserInfo host,
+                                                   @Nullable Map<Integer, VideoChatSeatInfo> seats,
+                                                   int tileSize) {
+        VideoChatMixedStreamLayout layout = new VideoChatMixedStreamLayout();
+        layout.roomId = roomId;
+        layout.canvasWidth = COLUMNS * tileSize;
+        layout.canvasHeight = ROWS * tileSize;
+        if (host != null) {
+            layout.regions.add(region(roomId, host, 0, tileSize));
+        }
+        for (int slot = 1; slot < SLOT_COUNT; slot++) {
+            VideoChatSeatInfo seat = seats == null ? null : seats.get(slot);
+            if (seat == null || seat.isLocked() || seat.userInfo == null) {
+                continue;
+            }
+            layout.regions.add(region(roomId, seat.userInfo, slot, tileSize));
+        }
+        return layout;
+    }
+
+    private static Region region(String roomId, VideoChatUserInfo user, int slot, int tileSize) {
+        Region region = new Region();
+        region.userId = user.userId;
+        region.roomId = roomId;
+        region.slot = slot;
+        region.x = slot % COLUMNS * tileSize;
+        region.y = slot / COLUMNS * tileSize;
+        region.width = tileSize;
+        region.height = tileSize;
+        region.video = user.isCameraOn();
+        region.audio = user.isMicOn();
+        return region;
+    }
+
+    @NonNull
+    public String toJson() {
+        return GsonUtils.gson().toJson(this);
+    }
+
+    @Override
+    public boolean equals(Object o) {
+        if (this == o) return true;
+        if (!(o instanceof VideoChatMixedStreamLayout)) return false;
+        VideoChatMixedStreamLayout layout = (VideoChatMixedStreamLayout) o;
+        return version == layout.version
+                && canvasWidth == layout.canvasWidth && canvasHeight == layout.canvasHeight
+                && Objects.equals(roomId, layout.roomId)
+                && Objects.equals(background, layout.background)
+                && Objects.equals(regions, layout.regions);
+    }
+
+    @Override
+    public int hashCode() {
+        return Objects.hash(version, roomId, canvasWidth, canvasHeight, background, regions);
+    }
+
+    @Override
+    public String toString() {
+        return "VideoChatMixedStreamLayout{" +
+                "roomId='" + roomId + '\'' +
+                ", regions=" + regions +
+                '}';
+    }
+}
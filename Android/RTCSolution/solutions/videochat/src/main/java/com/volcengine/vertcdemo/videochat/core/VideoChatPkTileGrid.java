@@ -0,0 +1,61 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.NonNull;
+
+/**
+ * Tiles of the PK video area for any number of anchors.
+ *
+ * 1 anchor fills the area, 2 split it in halves, 3 give the first anchor the left half and stack
+ * the others on the right, 4 and more fill a grid of ceil(sqrt(n)) columns whose last row is
+ * stretched when it is not full. Tiles cover the area without gaps or overlap, edges are rounded
+ * so neighbours share them exactly.
+ */
+public final class VideoChatPkTileGrid {
+
+    /*** Ints per tile in the output array: left, top, right, bottom */
+    public static final int TILE_STRIDE = 4;
+
+    private VideoChatPkTileGrid() {
+    }
+
+    /**
+     * @param out receives {@link #TILE_STRIDE} ints per tile, at least count * TILE_STRIDE long
+     */
+    public static void layout(int count, int width, int height, @NonNull int[] out) {
+        if (count <= 0) {
+            return;
+        }
+        if (out.length < count * TILE_STRIDE) {
+            throw new IllegalArgumentException("out holds " + out.length / TILE_STRIDE + " tiles, needs " + count);
+        }
+        if (count == 3) {
+            int half = width / 2;
+            set(out, 0, 0, 0, half, height);
+            set(out, 1, half, 0, width, height / 2);
+            set(out, 2, half, height / 2, width, height);
+            return;
+        }
+        int columns = (int) Math.ceil(Math.sqrt(count));
+        int rows = (count + columns - 1) / columns;
+        int lastRowStart = (rows - 1) * columns;
+        for (int i = 0; i < count; i++) {
+            int row = i / columns;
+            int column = i % columns;
+            int rowColumns = i < lastRowStart ? columns : count - lastRowStart;
+            set(out, i,
+                    width * column / rowColumns, height * row / rows,
+                    width * (column + 1) / rowColumns, height * (row + 1) / rows);
+        }
+    }
+
+    private static void set(int[] out, int tile, int left, int top, int right, int bottom) {
+        int offset = tile * TILE_STRIDE;
+        out[offset] = left;
+        out[offset + 1] = top;
+        out[offset + 2] = right;
+        out[offset + 3] = bottom;
+    }
+}
@@ -0,0 +1,195 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.IntDef;
+import androidx.annotation.NonNull;
+
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+
+/**
+ * Which anchor rooms each anchor relays its stream into during a PK of 2 or more anchors.
+ *
+ * Up to {@link #MESH_MAX_ANCHORS} anchors relay into each other's rooms (full mesh), every room
+ * shows every anchor; 4 anchors take 12 relays. Beyond that the mesh costs N * (N - 1) relays, so
+ * one room becomes the hub: the other anchors relay only into the hub room and the hub anchor
+ * relays into every room. The hub room shows every anchor, the other rooms show their own anchor
+ * and the hub.
+ *
+ * A relay only forwards the relaying anchor's own stream, so the hub can not pass the other
+ * anchors on and a PK is capped at {@link #MAX_ANCHORS}, the largest mesh, where every room still
+ * shows everyone. The hub topology is the cost model for larger PKs, not used by the app.
+ *
+ * The hub is the smallest room id so every client picks the same one without asking the server.
+ */
+public class VideoChatPkTopology {
+
+    /*** Every anchor relays into every other anchor room */
+    public static final int TOPOLOGY_MESH = 0;
+    /*** Anchors relay into the hub room, the hub relays into every anchor room */
+    public static final int TOPOLOGY_HUB = 1;
+
+    @IntDef({TOPOLOGY_MESH, TOPOLOGY_HUB})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface Topology {
+    }
+
+    /*** Largest PK still relayed as a full mesh */
+    public static final int MESH_MAX_ANCHORS = 4;
+    /*** Largest PK offered, every room has to show every anchor */
+    public static final int MAX_ANCHORS = MESH_MAX_ANCHORS;
+
+    /**
+     * Relay and bandwidth cost of a topology for one video stream bitrate.
+     * Relays run on the RTC server, so an anchor uploads one stream in either topology.
+     */
+    public static final class Bandwidth {
+        @Topology
+        public int topology;
+        public int anchors;
+        /*** Forward stream relays between rooms */
+        public int relays;
+        public int anchorUplinkKbps;
+        /*** Anchor video an anchor subscribes to in the room that sees the most anchors */
+        public int maxAnchorDownlinkKbps;
+        /*** Anchor video an audience subscribes to in the room that sees the most anchors */
+        public int maxAudienceDownlinkKbps;
+        public int serverRelayKbps;
+
+        @Override
+        public String toString() {
+            return "Bandwidth{" +
+                    "topology=" + topology +
+                    ", anchors=" + anchors +
+                    ", relays=" + relays +
+                    ", anchorUplinkKbps=" + anchorUplinkKbps +
+                    ", maxAnchorDownlinkKbps=" + maxAnchorDownlinkKbps +
+                    ", maxAudienceDownlinkKbps=" + maxAudienceDownlinkKbps +
+                    ", serverRelayKbps=" + serverRelayKbps +
+                    '}';
+        }
+    }
+
+    @Topology
+    private final int mTopology;
+    private final List<String> mRoomIds;
+
+    private VideoChatPkTopology(@Topology int topology, List<String> roomIds) {
+        mTopology = topology;
+        mRoomIds = roomIds;
+    }
+
+    /**
+     * @param anchorCount anchors in the PK, the local one included
+     */
+    @Topology
+    public static int select(int anchorCount) {
+        return anchorCount <= MESH_MAX_ANCHORS ? TOPOLOGY_MESH : TOPOLOGY_HUB;
+    }
+
+    /**
+     * @param anchorRoomIds room of every anchor in the PK, in any order, duplicates ignored
+     */
+    @NonNull
+    public static VideoChatPkTopology plan(@NonNull List<String> anchorRoomIds) {
+        ArrayList<String> roomIds = new ArrayList<>(anchorRoomIds.size());
+        for (String roomId : anchorRoomIds) {
+            if (roomId != null && !roomId.isEmpty() && !roomIds.contains(roomId)) {
+                roomIds.add(roomId);
+            }
+        }
+        Collections.sort(roomIds);
+        return new VideoChatPkTopology(select(roomIds.size()), Collections.unmodifiableList(roomIds));
+    }
+
+    @Topology
+    public int getTopology() {
+        return mTopology;
+    }
+
+    /**
+     * @return anchor rooms, the hub first
+     */
+    @NonNull
+    public List<String> getRoomIds() {
+        return mRoomIds;
+    }
+
+    @NonNull
+    public String getHubRoomId() {
+        return mRoomIds.isEmpty() ? "" : mRoomIds.get(0);
+    }
+
+    public boolean contains(String roomId) {
+        return mRoomIds.contains(roomId);
+    }
+
+    /**
+     * @return rooms the anchor of this room relays its stream into
+     */
+    @NonNull
+    public List<String> relayTargetsOf(@NonNull String roomId) {
+        if (!mRoomIds.contains(roomId)) {
+            return Collections.emptyList();
+        }
+        ArrayList<String> targets = new ArrayList<>(mRoomIds.size() - 1);
+        if (mTopology == TOPOLOGY_HUB && !roomId.equals(getHubRoomId())) {
+            targets.add(getHubRoomId());
+            return targets;
+        }
+        for (String other : mRoomIds) {
+            if (!other.equals(roomId)) {
+                targets.add(other);
+            }
+        }
+        return targets;
+    }
+
+    /**
+     * @return anchor rooms whose anchor can be seen in this room, this room first
+     */
+    @NonNull
+    public List<String> visibleIn(@NonNull String roomId) {
+        if (!mRoomIds.contains(roomId)) {
+            return Collections.emptyList();
+        }
+        ArrayList<String> visible = new ArrayList<>(mRoomIds.size());
+        visible.add(roomId);
+        for (String other : mRoomIds) {
+            if (!other.equals(roomId) && relayTargetsOf(other).contains(roomId)) {
+                visible.add(other);
+            }
+        }
+        return visible;
+    }
+
+    public int getRelayCount() {
+        int relays = 0;
+        for (String roomId : mRoomIds) {
+            relays += relayTargetsOf(roomId).size();
+        }
+        return relays;
+    }
+
+    @NonNull
+    public Bandwidth bandwidth(int streamKbps) {
+        Bandwidth bandwidth = new Bandwidth();
+        bandwidth.topology = mTopology;
+        bandwidth.anchors = mRoomIds.size();
+        bandwidth.relays = getRelayCount();
+        bandwidth.anchorUplinkKbps = mRoomIds.isEmpty() ? 0 : streamKbps;
+        int maxVisible = 0;
+        for (String roomId : mRoomIds) {
+            maxVisible = Math.max(maxVisible, visibleIn(roomId).size());
+        }
+        bandwidth.maxAnchorDownlinkKbps = Math.max(0, maxVisible - 1) * streamKbps;
+        bandwidth.maxAudienceDownlinkKbps = maxVisible * streamKbps;
+        bandwidth.serverRelayKbps = bandwidth.relays * streamKbps;
+        return bandwidth;
+    }
+}
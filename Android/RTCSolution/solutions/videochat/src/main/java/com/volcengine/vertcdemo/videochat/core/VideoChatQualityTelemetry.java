@@ -0,0 +1,358 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import java.util.Arrays;
+import java.util.Locale;
+
+/**
+ * Keeps the stream statistics of the RTC room instead of only a good/bad badge per user:
+ * bitrates, frame rate, loss, RTT, jitter, stalls and how often the network quality was bad.
+ *
+ * Every stream has a fixed-size window of the last {@link #WINDOW_SAMPLES} samples per metric
+ * for percentiles, plus session totals for means and stall rates. Streams, windows and the
+ * {@link Sample} the caller fills are allocated up front, so recording does not allocate; only
+ * building a summary does. Past {@link #MAX_STREAMS} the stream updated least recently is
+ * dropped.
+ *
+ * A compact summary goes to the reporter every {@link #SUMMARY_INTERVAL_MS} of samples, and is
+ * built on leave with {@link #summary()}.
+ */
+public class VideoChatQualityTelemetry {
+
+    /*** Video bitrate sent or received, in kbps */
+    public static final int METRIC_VIDEO_KBPS = 0;
+    /*** Frame rate sent or rendered */
+    public static final int METRIC_FPS = 1;
+    /*** Audio bitrate sent or received, in kbps */
+    public static final int METRIC_AUDIO_KBPS = 2;
+    /*** Packet loss in per mille, the worse of audio and video */
+    public static final int METRIC_LOSS = 3;
+    /*** Round trip time, in ms */
+    public static final int METRIC_RTT = 4;
+    /*** Audio jitter buffer delay, in ms */
+    public static final int METRIC_JITTER = 5;
+    static final int METRIC_COUNT = 6;
+    private static final String[] METRIC_NAMES = {"kbps", "fps", "akbps", "loss‰", "rtt", "jitter"};
+    // For rates the low tail is the bad one, it is reported instead of p90.
+    private static final boolean[] LOW_TAIL = {true, true, true, false, false, false};
+
+    /*** A metric the stream did not report */
+    public static final int UNSET = -1;
+
+    /*** A minute of the SDK's 2 second stats */
+    static final int WINDOW_SAMPLES = 30;
+    static final int MAX_STREAMS = 16;
+    public static final long SUMMARY_INTERVAL_MS = 60_000;
+
+    public interface Reporter {
+        void report(@NonNull String summary);
+    }
+
+    /**
+     * One stats callback of one stream. Fill it with {@link #reset(String, boolean, int)} and
+     * the setters and pass it to {@link #onStats(Sample, long)}; reuse it for the next one.
+     */
+    public static final class Sample {
+        String uid;
+        boolean local;
+        int intervalMs;
+        final int[] values = new int[METRIC_COUNT];
+        int videoStallCount;
+        int videoStallMs;
+        int audioStallCount;
+        int audioStallMs;
+
+        /**
+         * @param intervalMs the period the stats cover
+         */
+        public Sample reset(@NonNull String uid, boolean local, int intervalMs) {
+            this.uid = uid;
+            this.local = local;
+            this.intervalMs = Math.max(0, intervalMs);
+            Arrays.fill(values, UNSET);
+            videoStallCount = 0;
+            videoStallMs = 0;
+            audioStallCount = 0;
+            audioStallMs = 0;
+            return this;
+        }
+
+        /**
+         * @param metric one of METRIC_*
+         */
+        public Sample set(int metric, int value) {
+            values[metric] = value;
+            return this;
+        }
+
+        /**
+         * @param lossRate 0 to 1, kept if worse than the one already set
+         */
+        public Sample loss(float lossRate) {
+            int perMille = Math.round(Math.max(0, Math.min(1, lossRate)) * 1000);
+            values[METRIC_LOSS] = Math.max(values[METRIC_LOSS], perMille);
+            return this;
+        }
+
+        /**
+         * Stalls within the interval.
+         */
+        public Sample stalls(int videoCount, int videoMs, int audioCount, int audioMs) {
+            videoStallCount = Math.max(0, videoCount);
+            videoStallMs = Math.max(0, videoMs);
+            audioStallCount = Math.max(0, audioCount);
+            audioStallMs = Math.max(0, audioMs);
+            return this;
+        }
+    }
+
+    private static final class Stream {
+        String uid;
+        boolean local;
+        boolean used;
+        long lastUpdateMs;
+        final int[][] window = new int[METRIC_COUNT][WINDOW_SAMPLES];
+        final int[] windowSize = new int[METRIC_COUNT];
+        final int[] windowNext = new int[METRIC_COUNT];
+        final long[] sum = new long[METRIC_COUNT];
+        final long[] count = new long[METRIC_COUNT];
+        long observedMs;
+        long videoStallCount;
+        long videoStallMs;
+        long audioStallCount;
+        long audioStallMs;
+        long qualityReports;
+        long badQualityReports;
+
+        void reset(String uid, boolean local) {
+            this.uid = uid;
+            this.local = local;
+            used = true;
+            lastUpdateMs = 0;
+            Arrays.fill(windowSize, 0);
+            Arrays.fill(windowNext, 0);
+            Arrays.fill(sum, 0);
+            Arrays.fill(count, 0);
+            observedMs = 0;
+            videoStallCount = 0;
+            videoStallMs = 0;
+            audioStallCount = 0;
+            audioStallMs = 0;
+            qualityReports = 0;
+            badQualityReports = 0;
+        }
+    }
+
+    private final Stream[] mStreams = new Stream[MAX_STREAMS];
+    private final int[] mScratch = new int[WINDOW_SAMPLES];
+    @Nullable
+    private Reporter mReporter;
+    private long mFirstSampleMs = -1;
+    private long mLastSampleMs;
+    private long mLastSummaryMs;
+    private int mDroppedStreams;
+
+    public VideoChatQualityTelemetry() {
+        for (int i = 0; i < MAX_STREAMS; i++) {
+            mStreams[i] = new Stream();
+        }
+    }
+
+    /**
+     * @param reporter gets the periodic summary, on the thread of the stats callbacks
+     */
+    public synchronized void setReporter(@Nullable Reporter reporter) {
+        mReporter = reporter;
+    }
+
+    public synchronized void onStats(@NonNull Sample sample, long nowMs) {
+        Stream stream = streamOf(sample.uid, sample.local);
+        stream.lastUpdateMs = nowMs;
+        for (int metric = 0; metric < METRIC_COUNT; metric++) {
+            int value = sample.values[metric];
+            if (value < 0) {
+                continue;
+            }
+            stream.window[metric][stream.windowNext[metric]] = value;
+            stream.windowNext[metric] = (stream.windowNext[metric] + 1) % WINDOW_SAMPLES;
+            stream.windowSize[metric] = Math.min(WINDOW_SAMPLES, stream.windowSize[metric] + 1);
+            stream.sum[metric] += value;
+            stream.count[metric]++;
+        }
+        stream.observedMs += sample.intervalMs;
+        stream.videoStallCount += sample.videoStallCount;
+        stream.videoStallMs += sample.videoStallMs;
+        stream.audioStallCount += sample.audioStallCount;
+        stream.audioStallMs += sample.audioStallMs;
+        onSampleTime(nowMs);
+    }
+
+    /**
+     * A network quality report of the user.
+     *
+     * @param good excellent or good, unknown qualities are not passed
+     */
+    public synchronized void onQuality(@NonNull String uid, boolean local, boolean good, long nowMs) {
+        Stream stream = streamOf(uid, local);
+        stream.lastUpdateMs = nowMs;
+        stream.qualityReports++;
+        if (!good) {
+            stream.badQualityReports++;
+        }
+        onSampleTime(nowMs);
+    }
+
+    /**
+     * @param metric     one of METRIC_*
+     * @param percentile 0 to 100, over the last {@link #WINDOW_SAMPLES} samples
+     * @return {@link #UNSET} if the stream never reported the metric
+     */
+    public synchronized int getPercentile(@NonNull String uid, boolean local, int metric, double percentile) {
+        Stream stream = find(uid, local);
+        return stream == null ? UNSET : percentile(stream, metric, percentile);
+    }
+
+    /**
+     * @return mean over the session, {@link #UNSET} if the stream never reported the metric
+     */
+    public synchronized int getMean(@NonNull String uid, boolean local, int metric) {
+        Stream stream = find(uid, local);
+        return stream == null ? UNSET : mean(stream, metric);
+    }
+
+    /**
+     * @return time the video stalled in percent of the time observed, 0 if nothing was observed
+     */
+    public synchronized float getVideoStallPercent(@NonNull String uid, boolean local) {
+        Stream stream = find(uid, local);
+        return stream == null || stream.observedMs == 0 ? 0 : stream.videoStallMs * 100f / stream.observedMs;
+    }
+
+    public synchronized int getStreamCount() {
+        int count = 0;
+        for (Stream stream : mStreams) {
+            if (stream.used) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    public synchronized int getDroppedStreamCount() {
+        return mDroppedStreams;
+    }
+
+    /**
+     * One line per stream: per metric p50/p90 of the last window (p10 for rates) and the session
+     * mean in brackets, stalls as count and percent of the time, share of bad quality reports.
+     */
+    @NonNull
+    public synchronized String summary() {
+        StringBuilder summary = new StringBuilder(String.format(Locale.US, "RTC quality %ds, %d streams",
+                mFirstSampleMs < 0 ? 0 : (mLastSampleMs - mFirstSampleMs) / 1000, getStreamCount()));
+        if (mDroppedStreams > 0) {
+            summary.append(", ").append(mDroppedStreams).append(" dropped");
+        }
+        for (Stream stream : mStreams) {
+            if (!stream.used) {
+                continue;
+            }
+            summary.append('\n').append(stream.local ? "local " : "").append(stream.uid)
+                    .append(' ').append(stream.observedMs / 1000).append('s');
+            for (int metric = 0; metric < METRIC_COUNT; metric++) {
+                if (stream.count[metric] == 0) {
+                    continue;
+                }
+                summary.append(String.format(Locale.US, " %s %d/%d(%d)", METRIC_NAMES[metric],
+                        percentile(stream, metric, 50),
+                        percentile(stream, metric, LOW_TAIL[metric] ? 10 : 90),
+                        mean(stream, metric)));
+            }
+            if (!stream.local && stream.observedMs > 0) {
+                summary.append(String.format(Locale.US, " stall v%d/%.1f%% a%d/%.1f%%",
+                        stream.videoStallCount, stream.videoStallMs * 100f / stream.observedMs,
+                        stream.audioStallCount, stream.audioStallMs * 100f / stream.observedMs));
+            }
+            if (stream.qualityReports > 0) {
+                summary.append(String.format(Locale.US, " bad %d%%",
+                        stream.badQualityReports * 100 / stream.qualityReports));
+            }
+        }
+        return summary.toString();
+    }
+
+    /**
+     * Forget every stream, e.g. after leaving the room.
+     */
+    public synchronized void reset() {
+        for (Stream stream : mStreams) {
+            stream.used = false;
+            stream.uid = null;
+        }
+        mFirstSampleMs = -1;
+        mLastSampleMs = 0;
+        mDroppedStreams = 0;
+    }
+
+    private void onSampleTime(long nowMs) {
+        if (mFirstSampleMs < 0) {
+            mFirstSampleMs = nowMs;
+            mLastSummaryMs = nowMs;
+        }
+        mLastSampleMs = nowMs;
+        if (mReporter != null && nowMs - mLastSummaryMs >= SUMMARY_INTERVAL_MS) {
+            mLastSummaryMs = nowMs;
+            mReporter.report(summary());
+        }
+    }
+
+    private int percentile(Stream stream, int metric, double percentile) {
+        int size = stream.windowSize[metric];
+        if (size == 0) {
+            return UNSET;
+        }
+        System.arraycopy(stream.window[metric], 0, mScratch, 0, size);
+        Arrays.sort(mScratch, 0, size);
+        int rank = (int) Math.ceil(Math.max(0, Math.min(100, percentile)) / 100 * size);
+        return mScratch[Math.max(0, rank - 1)];
+    }
+
+    private static int mean(Stream stream, int metric) {
+        return stream.count[metric] == 0 ? UNSET : (int) (stream.sum[metric] / stream.count[metric]);
+    }
+
+    @Nullable
+    private Stream find(String uid, boolean local) {
+        for (Stream stream : mStreams) {
+            if (stream.used && stream.local == local && stream.uid.equals(uid)) {
+                return stream;
+            }
+        }
+        return null;
+    }
+
+    private Stream streamOf(String uid, boolean local) {
+        Stream stream = find(uid, local);
+        if (stream != null) {
+            return stream;
+        }
+        Stream oldest = null;
+        for (Stream candidate : mStreams) {
+            if (!candidate.used) {
+                candidate.reset(uid, local);
+                return candidate;
+            }
+            if (oldest == null || candidate.lastUpdateMs < oldest.lastUpdateMs) {
+                oldest = candidate;
+            }
+        }
+        mDroppedStreams++;
+        oldest.reset(uid, local);
+        return oldest;
+    }
+}
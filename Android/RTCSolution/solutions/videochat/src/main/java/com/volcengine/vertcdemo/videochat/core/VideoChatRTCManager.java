@@ -3,16 +3,19 @@
 
 package com.volcengine.vertcdemo.videochat.core;
 
+import static com.ss.bytertc.engine.VideoCanvas.RENDER_MODE_FIT;
 import static com.ss.bytertc.engine.VideoCanvas.RENDER_MODE_HIDDEN;
 import static com.ss.bytertc.engine.data.AudioMixingType.AUDIO_MIXING_TYPE_PLAYOUT_AND_PUBLISH;
-import static com.volcengine.vertcdemo.utils.FileUtils.copyAssetFile;
 
+import android.app.Activity;
 import android.content.Context;
+import android.os.SystemClock;
 import android.text.TextUtils;
 import android.util.Log;
 import android.view.TextureView;
 
 import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
 
 import com.ss.bytertc.engine.RTCRoom;
 import com.ss.bytertc.engine.RTCRoomConfig;
@@ -21,6 +24,7 @@ import com.ss.bytertc.engine.UserInfo;
 import com.ss.bytertc.engine.VideoCanvas;
 import com.ss.bytertc.engine.VideoEncoderConfig;
 import com.ss.bytertc.engine.audio.IAudioEffectPlayer;
+import com.ss.bytertc.engine.audio.IAudioEffectPlayerEventHandler;
 import com.ss.bytertc.engine.data.AudioEffectPlayerConfig;
 import com.ss.bytertc.engine.data.AudioMixingConfig;
 import com.ss.bytertc.engine.data.AudioPropertiesConfig;
@@ -32,11 +36,24 @@ import com.ss.bytertc.engine.data.LocalAudioPropertiesInfo;
 import com.ss.bytertc.engine.data.MirrorType;
 import com.ss.bytertc.engine.data.RemoteAudioPropertiesInfo;
 import com.ss.bytertc.engine.data.RemoteStreamKey;
+import com.ss.bytertc.engine.data.SEICountPerFrame;
 import com.ss.bytertc.engine.data.StreamIndex;
+import com.ss.bytertc.engine.data.VideoFrameInfo;
 import com.ss.bytertc.engine.type.ChannelProfile;
+import com.ss.bytertc.engine.type.LocalAudioStats;
+import com.ss.bytertc.engine.type.LocalStreamStats;
+import com.ss.bytertc.engine.type.LocalVideoStats;
 import com.ss.bytertc.engine.type.MediaStreamType;
+import com.ss.bytertc.engine.type.NetworkQuality;
 import com.ss.bytertc.engine.type.NetworkQualityStats;
+import com.ss.bytertc.engine.type.PlayerError;
+import com.ss.bytertc.engine.type.PlayerState;
+import com.ss.bytertc.engine.type.RemoteAudioStats;
+import com.ss.bytertc.engine.type.RemoteStreamStats;
+import com.ss.bytertc.engine.type.RemoteVideoStats;
+import com.ss.bytertc.engine.type.StreamRemoveReason;
 import com.volcengine.vertcdemo.common.AppExecutors;
+import com.volcengine.vertcdemo.common.IAction;
 import com.volcengine.vertcdemo.core.eventbus.SDKReconnectToRoomEvent;
 import com.volcengine.vertcdemo.utils.AppUtil;
 import com.volcengine.vertcdemo.common.MLog;
@@ -44,21 +61,40 @@ import com.volcengine.vertcdemo.core.SolutionDataManager;
 import com.volcengine.vertcdemo.core.eventbus.SolutionDemoEventManager;
 import com.volcengine.vertcdemo.core.net.rts.RTCRoomEventHandlerWithRTS;
 import com.volcengine.vertcdemo.core.net.rts.RTCVideoEventHandlerWithRTS;
+import com.volcengine.vertcdemo.core.net.IRequestCallback;
+import com.volcengine.vertcdemo.core.net.rts.RTSNetworkFailover;
+import com.volcengine.vertcdemo.core.net.rts.RTSSessionRecorder;
 import com.volcengine.vertcdemo.core.net.rts.RTSInfo;
 import com.volcengine.vertcdemo.protocol.IEffect;
 import com.volcengine.vertcdemo.protocol.ProtocolUtil;
+import com.volcengine.vertcdemo.videochat.BuildConfig;
+import com.volcengine.vertcdemo.videochat.bean.ForwardStreamTokenEvent;
 import com.volcengine.vertcdemo.videochat.bean.UserJoinedEvent;
 import com.volcengine.vertcdemo.videochat.bean.UserLeaveEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatResponse;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+import com.volcengine.vertcdemo.videochat.event.ChatConfirmedEvent;
+import com.volcengine.vertcdemo.videochat.event.ChatReceivedEvent;
+import com.volcengine.vertcdemo.videochat.event.ForwardStreamStateEvent;
+import com.volcengine.vertcdemo.videochat.event.MixedStreamEvent;
+import com.volcengine.vertcdemo.videochat.event.ReactionEvent;
+import com.volcengine.vertcdemo.videochat.event.RemoteFirstFrameEvent;
 import com.volcengine.vertcdemo.videochat.event.SDKAudioPropertiesEvent;
 import com.volcengine.vertcdemo.videochat.event.SDKNetStatusEvent;
+import com.volcengine.vertcdemo.videochat.event.SeatSeiEvent;
 
 import java.io.File;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
 import java.util.ArrayList;
 import java.util.HashMap;
+import java.util.HashSet;
 import java.util.List;
 import java.util.Locale;
 import java.util.Map;
+import java.util.Random;
+import java.util.Set;
 
 /**
  * RTC object management class
@@ -147,6 +183,45 @@ public class VideoChatRTCManager {
             }
             SolutionDemoEventManager.post(new SDKAudioPropertiesEvent(audioPropertiesList));
         }
+
+        /**
+         * SEI carried by a subscribed stream, the host puts its seat state there.
+         * @param remoteStreamKey Stream the SEI came with, see RemoteStreamKey for details.
+         * @param message SEI content.
+         */
+        @Override
+        public void onSEIMessageReceived(RemoteStreamKey remoteStreamKey, ByteBuffer message) {
+            super.onSEIMessageReceived(remoteStreamKey, message);
+            if (message == null) {
+                return;
+            }
+            byte[] data = new byte[message.remaining()];
+            message.duplicate().get(data);
+            VideoChatSeatSei sei = VideoChatSeatSei.fromText(new String(data, StandardCharsets.US_ASCII));
+            if (sei != null) {
+                SolutionDemoEventManager.post(new SeatSeiEvent(remoteStreamKey.getUserId(), sei));
+            }
+        }
+
+        /**
+         * The first local video frame was captured, ends the room entry trace of a host.
+         */
+        @Override
+        public void onFirstLocalVideoFrameCaptured(StreamIndex streamIndex, VideoFrameInfo frameInfo) {
+            super.onFirstLocalVideoFrameCaptured(streamIndex, frameInfo);
+            VideoChatRoomSessions.ins().traceFirstFrame(SystemClock.elapsedRealtime());
+        }
+
+        /**
+         * The first remote video frame was rendered, ends the room entry trace of an audience.
+         */
+        @Override
+        public void onFirstRemoteVideoFrameRendered(RemoteStreamKey remoteStreamKey, VideoFrameInfo frameInfo) {
+            super.onFirstRemoteVideoFrameRendered(remoteStreamKey, frameInfo);
+            long now = SystemClock.elapsedRealtime();
+            VideoChatRoomSessions.ins().traceFirstFrame(now);
+            SolutionDemoEventManager.post(new RemoteFirstFrameEvent(remoteStreamKey.getUserId(), now));
+        }
     };
 
     /**
@@ -197,6 +272,7 @@ public class VideoChatRTCManager {
         @Override
         public void onUserLeave(String uid, int reason) {
             Log.d(TAG, String.format("onUserLeave: %s, %d", uid, reason));
+            onPublisherRemoved(uid);
             SolutionDemoEventManager.post(new UserLeaveEvent(uid, reason));
         }
 
@@ -208,9 +284,35 @@ public class VideoChatRTCManager {
         @Override
         public void onUserPublishStream(String uid, MediaStreamType type) {
             super.onUserPublishStream(uid, type);
-            if (type != MediaStreamType.RTC_MEDIA_STREAM_TYPE_AUDIO && !TextUtils.isEmpty(mRoomId)) {
+            if (type != MediaStreamType.RTC_MEDIA_STREAM_TYPE_AUDIO && !TextUtils.isEmpty(mRoomId)
+                    && !VideoChatMixedStreamLayout.isMixUser(uid)) {
                 setRemoteVideoView(uid, mRoomId, getUserRenderView(uid));
             }
+            onPublisherAdded(uid);
+        }
+
+        /**
+         * The remote user stopped publishing camera/microphone streams in the room.
+         * @param uid The user ID of the remote stream publishing user.
+         * @param type The type of the removed media stream, see MediaStreamType.
+         * @param reason The reason the stream was removed, see StreamRemoveReason.
+         */
+        @Override
+        public void onUserUnpublishStream(String uid, MediaStreamType type, StreamRemoveReason reason) {
+            super.onUserUnpublishStream(uid, type, reason);
+            onPublisherRemoved(uid);
+        }
+
+        /**
+         * Room or user message from another client, the chat fast path.
+         * @param fromUid User ID of the sender.
+         * @param message Message content.
+         */
+        @Override
+        protected void onRTCMessageReceived(String fromUid, String message) {
+            super.onRTCMessageReceived(fromUid, message);
+            long now = System.currentTimeMillis();
+            AppExecutors.mainThread().execute(() -> mChatChannel.onRoomMessage(fromUid, message, now));
         }
 
         /**
@@ -223,25 +325,95 @@ public class VideoChatRTCManager {
         @Override
         public void onNetworkQuality(NetworkQualityStats localQuality, NetworkQualityStats[] remoteQualities) {
             super.onNetworkQuality(localQuality, remoteQualities);
+            long now = SystemClock.elapsedRealtime();
             SolutionDemoEventManager.post(new SDKNetStatusEvent(localQuality.uid, localQuality.txQuality));
+            onQuality(localQuality.uid, true, localQuality.txQuality, now);
             if (remoteQualities != null) {
                 for (NetworkQualityStats stats : remoteQualities) {
                     SolutionDemoEventManager.post(new SDKNetStatusEvent(stats.uid, stats.rxQuality));
+                    onQuality(stats.uid, false, stats.rxQuality, now);
                 }
             }
         }
 
+        /**
+         * Statistics of the published streams every 2 seconds, captured against encoded frames feed the frame budget monitor.
+         * @param stats Local stream statistics, see LocalStreamStats for details.
+         */
+        @Override
+        public void onLocalStreamStats(LocalStreamStats stats) {
+            super.onLocalStreamStats(stats);
+            long now = SystemClock.elapsedRealtime();
+            LocalVideoStats videoStats = stats.videoStats;
+            LocalAudioStats audioStats = stats.audioStats;
+            VideoChatQualityTelemetry.Sample sample = mQualitySample.reset(SolutionDataManager.ins().getUserId(),
+                    true, LOCAL_STATS_INTERVAL_S * 1000);
+            if (videoStats != null) {
+                sample.set(VideoChatQualityTelemetry.METRIC_VIDEO_KBPS, Math.round(videoStats.sentKBitrate))
+                        .set(VideoChatQualityTelemetry.METRIC_FPS, Math.round(videoStats.sentFrameRate))
+                        .set(VideoChatQualityTelemetry.METRIC_RTT, videoStats.rtt)
+                        .loss(videoStats.videoLossRate);
+            }
+            if (audioStats != null) {
+                sample.set(VideoChatQualityTelemetry.METRIC_AUDIO_KBPS, Math.round(audioStats.sendKBitrate))
+                        .loss(audioStats.audioLossRate);
+            }
+            mQualityTelemetry.onStats(sample, now);
+
+            int inputFrameRate = videoStats == null ? 0 : Math.round(videoStats.inputFrameRate);
+            if (inputFrameRate <= 0) {
+                return;
+            }
+            // Frames the effects could not process in time never reach the encoder.
+            int encodedFrameRate = Math.round(videoStats.encoderOutputFrameRate);
+            AppExecutors.mainThread().execute(() -> {
+                if (mEffectState == EFFECT_READY && mIsCameraOn) {
+                    mFrameBudgetMonitor.onReport(inputFrameRate, encodedFrameRate,
+                            LOCAL_STATS_INTERVAL_S * 1000L, now);
+                }
+            });
+        }
+
+        /**
+         * Statistics of every subscribed stream every 2 seconds, kept by the quality telemetry.
+         * @param stats Remote stream statistics, see RemoteStreamStats for details.
+         */
+        @Override
+        public void onRemoteStreamStats(RemoteStreamStats stats) {
+            super.onRemoteStreamStats(stats);
+            RemoteVideoStats videoStats = stats.videoStats;
+            RemoteAudioStats audioStats = stats.audioStats;
+            int intervalMs = videoStats != null ? videoStats.statsInterval
+                    : audioStats != null ? audioStats.statsInterval : LOCAL_STATS_INTERVAL_S * 1000;
+            VideoChatQualityTelemetry.Sample sample = mQualitySample.reset(stats.uid, false, intervalMs);
+            if (videoStats != null) {
+                sample.set(VideoChatQualityTelemetry.METRIC_VIDEO_KBPS, Math.round(videoStats.receivedKBitrate))
+                        .set(VideoChatQualityTelemetry.METRIC_FPS, Math.round(videoStats.rendererOutputFrameRate))
+                        .set(VideoChatQualityTelemetry.METRIC_RTT, videoStats.rtt)
+                        .loss(videoStats.videoLossRate);
+            }
+            if (audioStats != null) {
+                sample.set(VideoChatQualityTelemetry.METRIC_AUDIO_KBPS, Math.round(audioStats.receivedKBitrate))
+                        .set(VideoChatQualityTelemetry.METRIC_JITTER, audioStats.jitterBufferDelay)
+                        .loss(audioStats.audioLossRate);
+            }
+            sample.stalls(videoStats == null ? 0 : videoStats.stallCount,
+                    videoStats == null ? 0 : videoStats.stallDuration,
+                    audioStats == null ? 0 : audioStats.stallCount,
+                    audioStats == null ? 0 : audioStats.stallDuration);
+            mQualityTelemetry.onStats(sample, SystemClock.elapsedRealtime());
+        }
+
         /**
          * Callback returning the state and errors during relaying the media stream to each of the rooms
          * @param stateInfos Array of the state and errors of each designated room. see ForwardStreamStateInfo for more information.
          */
         @Override
         public void onForwardStreamStateChanged(ForwardStreamStateInfo[] stateInfos) {
-            String result = "";
             for (ForwardStreamStateInfo info : stateInfos) {
-                result = result.concat("|" + info.roomId + "," + info.error + "," + info.state + "|");
+                Log.d(TAG, String.format("onForwardStreamStateChanged: %s, %s, %s", info.roomId, info.state, info.error));
+                mForwardStreamManager.onStateChanged(info.roomId, info.state.value(), info.error.value());
             }
-            Log.d(TAG, String.format("onForwardStreamStateChanged: %s", result));
         }
 
         /**
@@ -250,22 +422,347 @@ public class VideoChatRTCManager {
          */
         @Override
         public void onForwardStreamEvent(ForwardStreamEventInfo[] eventInfos) {
-            String result = "";
             for (ForwardStreamEventInfo info : eventInfos) {
-                result = result.concat("|" + info.roomId + "," + info.event + "|");
+                Log.d(TAG, String.format("onForwardStreamEvent: %s, %s", info.roomId, info.event));
+                mForwardStreamManager.onEvent(info.roomId, info.event.value());
             }
-            Log.d(TAG, String.format("onForwardStreamStateChanged: %s", result));
         }
     };
 
     private static final int AUDIO_EFFECT_ID = 0;
+    private static final int LOCAL_STATS_INTERVAL_S = 2;
+    /*** Frame rate cap from {@link VideoChatFrameBudgetMonitor#LEVEL_REDUCED} on */
+    private static final int REDUCED_FRAME_RATE = 10;
+
+    private static final int EFFECT_IDLE = 0;
+    private static final int EFFECT_LOADING = 1;
+    private static final int EFFECT_READY = 2;
+    private static final int AUDIO_VOLUME_INDICATION_INTERVAL = 2000;
+
+    /**
+     * Volume reports only drive the speaking animation, stop them while the network recovers.
+     */
+    private final RTSNetworkFailover.Pausable mVolumeReportPausable = new RTSNetworkFailover.Pausable() {
+        @Override
+        public void onPauseNonEssential() {
+            enableAudioVolumeIndication(0);
+        }
+
+        @Override
+        public void onResumeNonEssential() {
+            enableAudioVolumeIndication(AUDIO_VOLUME_INDICATION_INTERVAL);
+        }
+    };
+
+    private final VideoChatBGMPlaylist.Player mBGMPlayer = new VideoChatBGMPlaylist.Player() {
+        @Override
+        public void preload(int effectId, @NonNull String path) {
+            if (mRTCVideo != null) {
+                mRTCVideo.getAudioEffectPlayer().preload(effectId, path);
+            }
+        }
+
+        @Override
+        public void unload(int effectId) {
+            if (mRTCVideo != null) {
+                mRTCVideo.getAudioEffectPlayer().unload(effectId);
+            }
+        }
+
+        @Override
+        public void start(int effectId, @NonNull String path, int volume) {
+            if (mRTCVideo != null) {
+                IAudioEffectPlayer effectPlayer = mRTCVideo.getAudioEffectPlayer();
+                AudioEffectPlayerConfig config = new AudioEffectPlayerConfig();
+                config.type = AUDIO_MIXING_TYPE_PLAYOUT_AND_PUBLISH;
+                config.playCount = 1;
+                effectPlayer.start(effectId, path, config);
+                effectPlayer.setVolume(effectId, volume);
+            }
+        }
+
+        @Override
+        public void stop(int effectId) {
+            if (mRTCVideo != null) {
+                mRTCVideo.getAudioEffectPlayer().stop(effectId);
+            }
+        }
+
+        @Override
+        public void pause(int effectId) {
+            if (mRTCVideo != null) {
+                mRTCVideo.getAudioEffectPlayer().pause(effectId);
+            }
+        }
+
+        @Override
+        public void resume(int effectId) {
+            if (mRTCVideo != null) {
+                mRTCVideo.getAudioEffectPlayer().resume(effectId);
+            }
+        }
+
+        @Override
+        public void setVolume(int effectId, int volume) {
+            if (mRTCVideo != null) {
+                mRTCVideo.getAudioEffectPlayer().setVolume(effectId, volume);
+            }
+        }
+    };
+
+    /**
+     * Background music, on {@link #AUDIO_EFFECT_ID} and the effect id after it.
+     */
+    private final VideoChatBGMSource mBGMSource = new VideoChatBGMSource(AppUtil.getApplicationContext());
+    private final VideoChatBGMPlaylist mBGMPlaylist = new VideoChatBGMPlaylist(mBGMPlayer, mBGMSource, AUDIO_EFFECT_ID);
+
+    private final IAudioEffectPlayerEventHandler mBGMEventHandler = new IAudioEffectPlayerEventHandler() {
+        @Override
+        public void onAudioEffectPlayerStateChanged(int effectId, PlayerState state, PlayerError error) {
+            Log.d(TAG, String.format("onAudioEffectPlayerStateChanged: %d, %s, %s", effectId, state, error));
+            AppExecutors.mainThread().execute(() -> {
+                long now = SystemClock.elapsedRealtime();
+                if (state == PlayerState.PLAYING) {
+                    mBGMPlaylist.onPlaying(effectId, now);
+                    Log.d(TAG, String.format(Locale.ENGLISH, "bgm track %d switched in %dms, preloaded %d/%d",
+                            mBGMPlaylist.getIndex(), mBGMPlaylist.getLastSwitchMs(),
+                            mBGMPlaylist.getPreloadedSwitchCount(), mBGMPlaylist.getSwitchCount()));
+                } else if (state == PlayerState.FINISHED) {
+                    mBGMPlaylist.onFinished(effectId, now);
+                } else if (state == PlayerState.FAILED) {
+                    mBGMPlaylist.onFailed(effectId, now);
+                }
+            });
+        }
+    };
+
+    /**
+     * Chat sent as RTC room message for the room and to the business server for moderation
+     * and persistence, see VideoChatChatChannel.
+     */
+    private final VideoChatChatChannel mChatChannel = new VideoChatChatChannel(new VideoChatChatChannel.Transport() {
+        @Override
+        public boolean broadcast(@NonNull String payload) {
+            if (mRTCRoom == null) {
+                return false;
+            }
+            long msgId = mRTCRoom.sendRoomMessage(payload);
+            if (msgId < 0) {
+                Log.d(TAG, String.format(Locale.ENGLISH, "sendRoomMessage failed: %d", msgId));
+                return false;
+            }
+            return true;
+        }
+
+        @Override
+        public void submit(@NonNull VideoChatChatChannel.Message message,
+                           @NonNull VideoChatChatChannel.SubmitCallback callback) {
+            if (mRTSClient == null) {
+                callback.onResult(VideoChatChatChannel.SUBMIT_FAILED);
+                return;
+            }
+            mRTSClient.sendMessage(message.roomId, message.text, message.id, new IRequestCallback<VideoChatResponse>() {
+                @Override
+                public void onSuccess(VideoChatResponse data) {
+                    callback.onResult(VideoChatChatChannel.SUBMIT_ACCEPTED);
+                }
+
+                @Override
+                public void onError(int errorCode, String msg) {
+                    Log.d(TAG, String.format(Locale.ENGLISH, "sendMessage %s failed: %d, %s", message.id, errorCode, msg));
+                    // Negative codes are transport failures, positive ones come from the server.
+                    callback.onResult(errorCode > 0 ? VideoChatChatChannel.SUBMIT_REJECTED
+                            : VideoChatChatChannel.SUBMIT_FAILED);
+                }
+            });
+        }
+    }, AppExecutors.mainScheduler());
+
+    {
+        mChatChannel.setListener(new VideoChatChatChannel.Listener() {
+            @Override
+            public void onMessage(@NonNull VideoChatChatChannel.Message message, int source) {
+                SolutionDemoEventManager.post(new ChatReceivedEvent(message.id, message));
+            }
+
+            @Override
+            public void onConfirmed(@NonNull String messageId) {
+                SolutionDemoEventManager.post(new ChatConfirmedEvent(messageId));
+            }
+
+            @Override
+            public void onRetracted(@NonNull String messageId) {
+                SolutionDemoEventManager.post(new ChatReceivedEvent(messageId, null));
+            }
+        });
+    }
 
     private VideoChatRTSClient mRTSClient;
 
     private RTCVideo mRTCVideo;
     private RTCRoom mRTCRoom;
+    // RoomId of the currently joined RTC room.
+    private String mRoomId = "";
+
+    /**
+     * Reactions tapped in the current room, counted and sent once a flush interval, see VideoChatReactions.
+     */
+    private final VideoChatReactions mReactions = new VideoChatReactions(
+            (counts, callback) -> {
+                if (mRTSClient == null || TextUtils.isEmpty(mRoomId)) {
+                    callback.onResult(false);
+                    return;
+                }
+                mRTSClient.sendReactions(mRoomId, counts, new IRequestCallback<VideoChatResponse>() {
+                    @Override
+                    public void onSuccess(VideoChatResponse data) {
+                        callback.onResult(true);
+                    }
+
+                    @Override
+                    public void onError(int errorCode, String msg) {
+                        Log.d(TAG, String.format(Locale.ENGLISH, "sendReactions failed: %d, %s", errorCode, msg));
+                        callback.onResult(false);
+                    }
+                });
+            },
+            AppExecutors.mainScheduler());
+
+    {
+        mReactions.setListener(new VideoChatReactions.Listener() {
+            @Override
+            public void onReactions(int kind, int count, boolean own) {
+                SolutionDemoEventManager.post(new ReactionEvent(kind, count, own, null));
+            }
+
+            @Override
+            public void onTotals(@NonNull long[] totals) {
+                SolutionDemoEventManager.post(new ReactionEvent(VideoChatReactions.KIND_LIKE, 0, false, totals));
+            }
+        });
+    }
+
+    private final RTSNetworkFailover.Pausable mReactionsPausable = new RTSNetworkFailover.Pausable() {
+        @Override
+        public void onPauseNonEssential() {
+            AppExecutors.mainThread().execute(mReactions::pause);
+        }
+
+        @Override
+        public void onResumeNonEssential() {
+            AppExecutors.mainThread().execute(mReactions::resume);
+        }
+    };
+
+    private final VideoChatForwardStreamManager.Relay mForwardStreamRelay = new VideoChatForwardStreamManager.Relay() {
+        @Override
+        public void start(@NonNull List<VideoChatForwardStreamManager.Target> targets) {
+            if (mRTCRoom != null) {
+                int result = mRTCRoom.startForwardStreamToRooms(toForwardStreamInfos(targets));
+                Log.d(TAG, String.format("startForwardStreamToRooms result: %d", result));
+            }
+        }
+
+        @Override
+        public void update(@NonNull List<VideoChatForwardStreamManager.Target> targets) {
+            if (mRTCRoom != null) {
+                int result = mRTCRoom.updateForwardStreamToRooms(toForwardStreamInfos(targets));
+                Log.d(TAG, String.format("updateForwardStreamToRooms result: %d", result));
+            }
+        }
+
+        @Override
+        public void stop() {
+            if (mRTCRoom != null) {
+                Log.d(TAG, "stopForwardStreamToRooms");
+                mRTCRoom.stopForwardStreamToRooms();
+            }
+        }
+    };
+
+    private final VideoChatForwardStreamManager.TokenProvider mForwardStreamTokenProvider = (roomId, callback) -> {
+        if (mRTSClient == null) {
+            callback.onError(-1, "rts client not ready");
+            return;
+        }
+        mRTSClient.requestForwardStreamToken(mRoomId, roomId, new IRequestCallback<ForwardStreamTokenEvent>() {
+            @Override
+            public void onSuccess(ForwardStreamTokenEvent data) {
+                if (data == null || TextUtils.isEmpty(data.rtcToken)) {
+                    callback.onError(-1, "empty token");
+                    return;
+                }
+                long expiresAtMs = data.expireIn > 0 ? SystemClock.elapsedRealtime() + data.expireIn * 1000 : 0;
+                callback.onToken(data.rtcToken, expiresAtMs);
+            }
+
+            @Override
+            public void onError(int errorCode, String message) {
+                callback.onError(errorCode, message);
+            }
+        });
+    };
+
+    private final VideoChatForwardStreamManager mForwardStreamManager = new VideoChatForwardStreamManager(
+            mForwardStreamRelay, mForwardStreamTokenProvider,
+            AppExecutors.mainScheduler(),
+            SystemClock::elapsedRealtime, new Random());
+
+    {
+        mForwardStreamManager.addListener((roomId, oldState, newState) -> {
+            VideoChatForwardStreamManager.Metrics metrics = mForwardStreamManager.getMetrics(roomId);
+            if (metrics != null) {
+                Log.d(TAG, String.format(Locale.ENGLISH,
+                        "forward stream %s: %d -> %d, attempts:%d, failures:%d, stalls:%d, tokenRefreshes:%d, startLatency:%dms, maxStartLatency:%dms, relaying:%dms, lastError:%d",
+                        roomId, oldState, newState, metrics.attempts, metrics.failures, metrics.stalls,
+                        metrics.tokenRefreshes, metrics.lastStartLatencyMs, metrics.maxStartLatencyMs,
+                        metrics.relayingMs, metrics.lastError));
+            }
+            SolutionDemoEventManager.post(new ForwardStreamStateEvent(roomId, newState));
+        });
+    }
 
     private final Map<String, TextureView> mUidViewMap = new HashMap<>();
+    /**
+     * Users publishing in the current room, the server side mixed stream included.
+     */
+    private final Set<String> mPublishers = new HashSet<>();
+    /**
+     * Whether the mixed stream is subscribed instead of the single streams, see {@link #useMixedStream(boolean)}.
+     */
+    private boolean mUseMixedStream = false;
+    /**
+     * Whether remote streams are subscribed at all, off while an audience watches the CDN pull stream.
+     */
+    private boolean mMediaSubscribed = true;
+
+    /**
+     * Video effects are loaded on the first camera capture, audiences that never publish skip them.
+     */
+    private int mEffectState = EFFECT_IDLE;
+    private final List<IAction<IEffect>> mEffectActions = new ArrayList<>();
+    private final VideoChatFrameBudgetMonitor mFrameBudgetMonitor = new VideoChatFrameBudgetMonitor(15,
+            VideoChatFrameBudgetMonitor.WINDOW_REPORTS);
+    private final VideoChatQualityTelemetry mQualityTelemetry = new VideoChatQualityTelemetry();
+    @Nullable
+    private RTSSessionRecorder mSessionRecorder;
+    // Filled and passed on by the stats callbacks, all on the callback thread of the SDK.
+    private final VideoChatQualityTelemetry.Sample mQualitySample = new VideoChatQualityTelemetry.Sample();
+
+    {
+        mQualityTelemetry.setReporter(summary -> Log.d(TAG, summary));
+        // Stats reports only hint at the processing cost, lowering the frame rate is as far as they
+        // go: turning the effects off would also lose the user's beauty settings.
+        mFrameBudgetMonitor.setMaxLevel(VideoChatFrameBudgetMonitor.LEVEL_REDUCED);
+        mFrameBudgetMonitor.setListener((oldLevel, newLevel) -> {
+            Log.d(TAG, String.format(Locale.ENGLISH,
+                    "effect level %d -> %d, frames:%d, overBudget:%d, worst:%dus, downgrades:%d, upgrades:%d",
+                    oldLevel, newLevel, mFrameBudgetMonitor.getFrameCount(), mFrameBudgetMonitor.getOverBudgetCount(),
+                    mFrameBudgetMonitor.getWorstFrameUs(), mFrameBudgetMonitor.getDowngradeCount(),
+                    mFrameBudgetMonitor.getUpgradeCount()));
+            updateVideoConfig();
+        });
+    }
 
     private boolean mIsCameraOn = true;
     private boolean mIsMicOn = true;
@@ -275,8 +772,6 @@ public class VideoChatRTCManager {
     private int mFrameHeight = 1280;
     private int mBitrate = 1600;
     public boolean isTest = false;
-    // RoomId of the currently joined RTC room.
-    private String mRoomId = "";
 
     public static VideoChatRTCManager ins() {
         if (sInstance == null) {
@@ -293,7 +788,7 @@ public class VideoChatRTCManager {
         mRTCVideo = RTCVideo.createRTCVideo(AppUtil.getApplicationContext(), info.appId, mRTCVideoEventHandler, null, null);
         mRTCVideo.setBusinessId(info.bid);
         mRTCVideo.stopVideoCapture();
-        enableAudioVolumeIndication(2000);
+        enableAudioVolumeIndication(AUDIO_VOLUME_INDICATION_INTERVAL);
 
         VideoEncoderConfig config = new VideoEncoderConfig();
         config.width = 720;
@@ -301,15 +796,45 @@ public class VideoChatRTCManager {
         config.frameRate = 15;
         config.maxBitrate = 1600;
         mRTCVideo.setVideoEncoderConfig(config);
+        mFrameBudgetMonitor.setFrameRate(config.frameRate);
         switchCamera(mIsFront);
 
-        initVideoEffect();
-        initBGMRes();
+        mRTCVideo.getAudioEffectPlayer().setEventHandler(mBGMEventHandler);
+        mBGMPlaylist.setTracks(mBGMSource.listTracks());
         mRTSClient = new VideoChatRTSClient(mRTCVideo, info);
+        if (BuildConfig.DEBUG) {
+            startSessionRecording(mRTSClient);
+        }
+        mRTSClient.addNonEssentialTraffic(mVolumeReportPausable);
+        mRTSClient.addNonEssentialTraffic(mReactionsPausable);
         mRTCVideoEventHandler.setBaseClient(mRTSClient);
         mRTCRoomEventHandler.setBaseClient(mRTSClient);
     }
 
+    /**
+     * Record the RTS messages of debug builds under cache/rts_sessions, for replaying a session
+     * offline with RTSSessionReplayer.
+     */
+    private void startSessionRecording(@NonNull VideoChatRTSClient client) {
+        stopSessionRecording();
+        try {
+            mSessionRecorder = RTSSessionRecorder.open(
+                    new File(AppUtil.getApplicationContext().getCacheDir(), "rts_sessions"),
+                    SystemClock::elapsedRealtime, AppExecutors.diskIO());
+            client.setMessageObserver(mSessionRecorder);
+        } catch (IOException e) {
+            Log.e(TAG, "startSessionRecording failed: " + e);
+        }
+    }
+
+    private void stopSessionRecording() {
+        if (mSessionRecorder != null) {
+            Log.d(TAG, "session recorded, messages:" + mSessionRecorder.getCount());
+            mSessionRecorder.close();
+            mSessionRecorder = null;
+        }
+    }
+
     /**
      * Get the RTS Client object.
      * @return Video chat scenario RTS client object, enabling users to send and receive messages in the RTC room.
@@ -318,6 +843,22 @@ public class VideoChatRTCManager {
         return mRTSClient;
     }
 
+    /**
+     * Get the chat channel of the current room.
+     * @return Chat channel, sending to the room and the server at once.
+     */
+    public VideoChatChatChannel getChatChannel() {
+        return mChatChannel;
+    }
+
+    /**
+     * Get the reactions of the current room.
+     * @return Reactions, counting local taps and taking the totals broadcast by the server.
+     */
+    public VideoChatReactions getReactions() {
+        return mReactions;
+    }
+
     /**
      * Enable audio volume indication.
      * @param interval Callback period.
@@ -383,6 +924,7 @@ public class VideoChatRTCManager {
     public void turnOnCamera(boolean isCameraOn) {
         if (mRTCVideo != null) {
             if (isCameraOn) {
+                withVideoEffect(null);
                 mRTCVideo.startVideoCapture();
             } else {
                 mRTCVideo.stopVideoCapture();
@@ -440,11 +982,14 @@ public class VideoChatRTCManager {
     }
 
     private void updateVideoConfig() {
+        int frameRate = mFrameBudgetMonitor.getLevel() == VideoChatFrameBudgetMonitor.LEVEL_FULL
+                ? mFrameRate : Math.min(mFrameRate, REDUCED_FRAME_RATE);
+        mFrameBudgetMonitor.setFrameRate(frameRate);
         if (mRTCVideo != null) {
             VideoEncoderConfig config = new VideoEncoderConfig();
             config.width = mFrameWidth;
             config.height = mFrameHeight;
-            config.frameRate = mFrameRate;
+            config.frameRate = frameRate;
             config.maxBitrate = mBitrate;
             mRTCVideo.setVideoEncoderConfig(config);
         }
@@ -481,6 +1026,7 @@ public class VideoChatRTCManager {
     public void startVideoCapture(boolean isStart) {
         if (mRTCVideo != null) {
             if (isStart) {
+                withVideoEffect(null);
                 mRTCVideo.startVideoCapture();
             } else {
                 mRTCVideo.stopVideoCapture();
@@ -538,22 +1084,116 @@ public class VideoChatRTCManager {
         }
     }
 
-    private void initBGMRes() {
-        AppExecutors.diskIO().execute(() -> {
-            File bgmPath = new File(getExternalResourcePath(), "bgm/voicechat_bgm.mp3");
-            if (!bgmPath.exists()) {
-                File dir = new File(getExternalResourcePath() + "bgm");
-                if (!dir.exists()) {
-                    //noinspection ResultOfMethodCallIgnored
-                    dir.mkdirs();
-                }
-                copyAssetFile(AppUtil.getApplicationContext(), "voicechat_bgm.mp3", bgmPath.getAbsolutePath());
+    /**
+     * @return uid of the server side mixed stream published in the current room, or null
+     */
+    public String getMixedStreamUserId() {
+        for (String uid : mPublishers) {
+            if (VideoChatMixedStreamLayout.isMixUser(uid)) {
+                return uid;
             }
-        });
+        }
+        return null;
     }
 
-    private String getExternalResourcePath() {
-        return AppUtil.getApplicationContext().getExternalFilesDir("assets").getAbsolutePath() + "/resource/";
+    /**
+     * Watch the server side mixed stream instead of every seat, or switch back.
+     *
+     * In mixed mode only the mix is subscribed, a single downlink whatever the number of
+     * guests; otherwise the mix is left unsubscribed. Switching back happens by itself when
+     * the mix stops being published.
+     *
+     * @return whether the mixed stream is in use after the call
+     */
+    public boolean useMixedStream(boolean use) {
+        String mixUid = getMixedStreamUserId();
+        boolean useMix = use && mixUid != null;
+        if (useMix == mUseMixedStream) {
+            return useMix;
+        }
+        Log.d(TAG, String.format("useMixedStream: %b, %s", useMix, mixUid));
+        mUseMixedStream = useMix;
+        if (useMix) {
+            setMixedStreamView(mixUid, getUserRenderView(mixUid));
+        }
+        for (String uid : mPublishers) {
+            updateSubscription(uid);
+        }
+        return useMix;
+    }
+
+    /**
+     * Subscribe the remote streams or drop them all, the room stays joined for signaling.
+     * Set before {@link #joinRoom} to join without subscribing.
+     */
+    public void setMediaSubscribed(boolean subscribed) {
+        if (mMediaSubscribed == subscribed) {
+            return;
+        }
+        Log.d(TAG, String.format("setMediaSubscribed: %b", subscribed));
+        mMediaSubscribed = subscribed;
+        for (String uid : mPublishers) {
+            updateSubscription(uid);
+        }
+    }
+
+    public boolean isUsingMixedStream() {
+        return mUseMixedStream;
+    }
+
+    /**
+     * Put the seat state SEI on the next frames of the local main stream.
+     * @param payload See VideoChatSeatSei#toText.
+     * @param repeatCount Number of further frames to repeat it on, so a lost frame does not lose it.
+     */
+    public void sendSeatSei(@NonNull byte[] payload, int repeatCount) {
+        if (mRTCVideo != null) {
+            mRTCVideo.sendSEIMessage(StreamIndex.STREAM_INDEX_MAIN, payload, repeatCount,
+                    SEICountPerFrame.SEI_COUNT_PER_FRAME_SINGLE);
+        }
+    }
+
+    private void setMixedStreamView(String mixUid, TextureView textureView) {
+        if (mRTCVideo != null) {
+            VideoCanvas canvas = new VideoCanvas(textureView, RENDER_MODE_FIT);
+            RemoteStreamKey remoteStreamKey = new RemoteStreamKey(mRoomId, mixUid, StreamIndex.STREAM_INDEX_MAIN);
+            mRTCVideo.setRemoteVideoCanvas(remoteStreamKey, canvas);
+        }
+    }
+
+    private void onPublisherAdded(String uid) {
+        if (TextUtils.isEmpty(uid) || !mPublishers.add(uid)) {
+            return;
+        }
+        updateSubscription(uid);
+        if (VideoChatMixedStreamLayout.isMixUser(uid)) {
+            SolutionDemoEventManager.post(new MixedStreamEvent(uid, true));
+        }
+    }
+
+    private void onPublisherRemoved(String uid) {
+        if (TextUtils.isEmpty(uid) || !mPublishers.remove(uid)) {
+            return;
+        }
+        if (VideoChatMixedStreamLayout.isMixUser(uid)) {
+            useMixedStream(false);
+            SolutionDemoEventManager.post(new MixedStreamEvent(uid, false));
+        }
+    }
+
+    /**
+     * The room subscribes automatically, streams not wanted in the current mode are dropped here.
+     */
+    private void updateSubscription(String uid) {
+        if (mRTCRoom == null) {
+            return;
+        }
+        boolean wanted = mMediaSubscribed && VideoChatMixedStreamLayout.isMixUser(uid) == mUseMixedStream;
+        if (wanted) {
+            mRTCRoom.subscribeStream(uid, MediaStreamType.RTC_MEDIA_STREAM_TYPE_BOTH);
+        } else {
+            mRTCRoom.unsubscribeStream(uid, MediaStreamType.RTC_MEDIA_STREAM_TYPE_BOTH);
+        }
     }
 
     public void destroyEngine() {
@@ -566,6 +1206,14 @@ public class VideoChatRTCManager {
         if (mRTCVideo == null) {
             return;
         }
+        mBGMPlaylist.stop();
+        mEffectState = EFFECT_IDLE;
+        mEffectActions.clear();
+        mFrameBudgetMonitor.reset();
+        if (mRTSClient != null) {
+            mRTSClient.setMessageObserver(null);
+        }
+        stopSessionRecording();
         RTCVideo.destroyRTCVideo();
         mRTCVideo = null;
     }
@@ -591,7 +1239,7 @@ public class VideoChatRTCManager {
         mRTCRoom.setRTCRoomEventHandler(mRTCRoomEventHandler);
         UserInfo userInfo = new UserInfo(userId, null);
         RTCRoomConfig roomConfig = new RTCRoomConfig(ChannelProfile.CHANNEL_PROFILE_COMMUNICATION,
-                true, true, true);
+                true, mMediaSubscribed, mMediaSubscribed);
         mRTCRoom.joinRoom(token, userInfo, roomConfig);
     }
 
@@ -600,6 +1248,25 @@ public class VideoChatRTCManager {
      */
     public void leaveRoom() {
         Log.d(TAG, "leaveRoom");
+        mPublishers.clear();
+        mUseMixedStream = false;
+        Log.d(TAG, String.format(Locale.ENGLISH,
+                "chat: room:%d, server only:%d, duplicates:%d, rejected:%d, unconfirmed:%d, room latency avg:%dms, room lead avg:%dms max:%dms",
+                mChatChannel.getRoomCount(), mChatChannel.getServerCount(), mChatChannel.getDuplicateCount(),
+                mChatChannel.getRejectedCount(), mChatChannel.getUnconfirmedCount(),
+                mChatChannel.getAverageRoomLatencyMs(),
+                mChatChannel.getAverageLeadMs(), mChatChannel.getMaxLeadMs()));
+        mChatChannel.reset();
+        Log.d(TAG, String.format(Locale.ENGLISH,
+                "reactions: taps:%d, messages:%d, failed:%d, broadcasts:%d",
+                mReactions.getTapCount(), mReactions.getMessageCount(), mReactions.getFailedCount(),
+                mReactions.getBroadcastCount()));
+        mReactions.reset();
+        if (mRTSClient != null) {
+            Log.d(TAG, mRTSClient.getLatencyTracer().dump());
+        }
+        Log.d(TAG, mQualityTelemetry.summary());
+        mQualityTelemetry.reset();
         if (mRTCRoom != null) {
             mRTCRoom.leaveRoom();
             mRTCRoom.destroy();
@@ -607,19 +1274,31 @@ public class VideoChatRTCManager {
         }
     }
 
+    /**
+     * @return per stream quality of the current room, see {@link VideoChatQualityTelemetry#summary()}
+     */
+    public String getQualitySummary() {
+        return mQualityTelemetry.summary();
+    }
+
+    /**
+     * Network quality of a user, unknown qualities are left out.
+     */
+    private void onQuality(String uid, boolean local, int quality, long now) {
+        if (quality == NetworkQuality.NETWORK_QUALITY_UNKNOWN || TextUtils.isEmpty(uid)) {
+            return;
+        }
+        mQualityTelemetry.onQuality(uid, local, quality == NetworkQuality.NETWORK_QUALITY_EXCELLENT
+                || quality == NetworkQuality.NETWORK_QUALITY_GOOD, now);
+    }
+
     public void startAudioMixing(boolean isStart) {
         Log.d(TAG, String.format("startAudioMixing: %b", isStart));
         if (mRTCVideo != null) {
-            IAudioEffectPlayer effectPlayer = mRTCVideo.getAudioEffectPlayer();
             if (isStart) {
-                String bgmPath = getExternalResourcePath() + "bgm/voicechat_bgm.mp3";
-                effectPlayer.preload(AUDIO_EFFECT_ID, bgmPath);
-                AudioEffectPlayerConfig config = new AudioEffectPlayerConfig();
-                config.type = AUDIO_MIXING_TYPE_PLAYOUT_AND_PUBLISH;
-                config.playCount = -1;
-                effectPlayer.start(AUDIO_EFFECT_ID, bgmPath, config);
+                mBGMPlaylist.play(SystemClock.elapsedRealtime());
             } else {
-                effectPlayer.stop(AUDIO_EFFECT_ID);
+                mBGMPlaylist.stop();
             }
         }
     }
@@ -627,32 +1306,28 @@ public class VideoChatRTCManager {
     public void resumeAudioMixing() {
         Log.d(TAG, "resumeAudioMixing");
         if (mRTCVideo != null) {
-            IAudioEffectPlayer effectPlayer = mRTCVideo.getAudioEffectPlayer();
-            effectPlayer.resume(AUDIO_EFFECT_ID);
+            mBGMPlaylist.resume();
         }
     }
 
     public void pauseAudioMixing() {
         Log.d(TAG, "pauseAudioMixing");
         if (mRTCVideo != null) {
-            IAudioEffectPlayer effectPlayer = mRTCVideo.getAudioEffectPlayer();
-            effectPlayer.pause(AUDIO_EFFECT_ID);
+            mBGMPlaylist.pause();
         }
     }
 
     public void stopAudioMixing() {
         Log.d(TAG, "stopAudioMixing");
         if (mRTCVideo != null) {
-            IAudioEffectPlayer effectPlayer = mRTCVideo.getAudioEffectPlayer();
-            effectPlayer.stop(AUDIO_EFFECT_ID);
+            mBGMPlaylist.stop();
         }
     }
 
     public void adjustBGMVolume(int progress) {
         Log.d(TAG, String.format("adjustBGMVolume: %d", progress));
         if (mRTCVideo != null) {
-            IAudioEffectPlayer effectPlayer = mRTCVideo.getAudioEffectPlayer();
-            effectPlayer.setVolume(AUDIO_EFFECT_ID, progress);
+            mBGMPlaylist.setVolume(progress);
         }
     }
 
@@ -663,20 +1338,43 @@ public class VideoChatRTCManager {
         }
     }
 
-    public void forwardStreamToRoom(ForwardStreamInfo targetRoomInfo) {
-        if (mRTCRoom != null) {
-            ArrayList<ForwardStreamInfo> list = new ArrayList<>(1);
-            list.add(targetRoomInfo);
-            int result = mRTCRoom.startForwardStreamToRooms(list);
-            Log.d(TAG, String.format("forwardStreamToRoom result: %d", result));
-        }
+    /**
+     * Relay the local stream into a PK peer room, kept alive by the forward stream manager.
+     * @param peerRoomId Target room id.
+     * @param rtcToken Token to publish into the target room, fetched from the server when empty.
+     */
+    public void forwardStreamToRoom(String peerRoomId, String rtcToken) {
+        Log.d(TAG, "forwardStreamToRoom peerRoomId:" + peerRoomId);
+        mForwardStreamManager.addTarget(peerRoomId, rtcToken, 0);
+    }
+
+    /**
+     * Stop relaying into one PK peer room.
+     * @param peerRoomId Target room id.
+     */
+    public void stopForwardStreamToRoom(String peerRoomId) {
+        Log.d(TAG, "stopForwardStreamToRoom peerRoomId:" + peerRoomId);
+        mForwardStreamManager.removeTarget(peerRoomId);
     }
 
+    /**
+     * Stop relaying into every PK peer room.
+     */
     public void stopForwardStreamToRoom() {
-        if (mRTCRoom != null) {
-            Log.d(TAG, "stopForwardStreamToRoom");
-            mRTCRoom.stopForwardStreamToRooms();
+        Log.d(TAG, "stopForwardStreamToRoom");
+        mForwardStreamManager.removeAll();
+    }
+
+    public VideoChatForwardStreamManager getForwardStreamManager() {
+        return mForwardStreamManager;
+    }
+
+    private static List<ForwardStreamInfo> toForwardStreamInfos(List<VideoChatForwardStreamManager.Target> targets) {
+        ArrayList<ForwardStreamInfo> list = new ArrayList<>(targets.size());
+        for (VideoChatForwardStreamManager.Target target : targets) {
+            list.add(new ForwardStreamInfo(target.roomId, target.token));
         }
+        return list;
     }
 
     public void muteRemoteAudio(String uid, boolean mute) {
@@ -697,30 +1395,61 @@ public class VideoChatRTCManager {
     }
 
     /**
-     * Initialize video effect.
+     * Run an action on the video effect, loading it first off the main thread if not done yet.
+     * @param action null to only start loading.
      */
-    private void initVideoEffect() {
+    private void withVideoEffect(IAction<IEffect> action) {
         IEffect effect = ProtocolUtil.getIEffect();
-        if (effect != null) {
-            effect.initWithRTCVideo(mRTCVideo);
+        if (effect == null || mRTCVideo == null) {
+            return;
         }
+        if (mEffectState == EFFECT_READY) {
+            if (action != null) {
+                action.act(effect);
+            }
+            return;
+        }
+        if (action != null) {
+            mEffectActions.add(action);
+        }
+        if (mEffectState == EFFECT_LOADING) {
+            return;
+        }
+        mEffectState = EFFECT_LOADING;
+        RTCVideo rtcVideo = mRTCVideo;
+        long startAt = SystemClock.elapsedRealtime();
+        AppExecutors.diskIO().execute(() -> {
+            effect.initWithRTCVideo(rtcVideo);
+            AppExecutors.mainThread().execute(() -> {
+                if (rtcVideo != mRTCVideo || mEffectState != EFFECT_LOADING) {
+                    return;
+                }
+                Log.d(TAG, String.format(Locale.ENGLISH, "video effect loaded in %dms",
+                        SystemClock.elapsedRealtime() - startAt));
+                mEffectState = EFFECT_READY;
+                List<IAction<IEffect>> actions = new ArrayList<>(mEffectActions);
+                mEffectActions.clear();
+                for (IAction<IEffect> pending : actions) {
+                    pending.act(effect);
+                }
+            });
+        });
     }
 
     public void resumeVideoEffect() {
-        IEffect effect = ProtocolUtil.getIEffect();
-        if (effect != null) {
-            effect.resume();
-        }
+        withVideoEffect(IEffect::resume);
     }
 
     /**
-     * Open effect dialog.
+     * Open effect dialog, once the effect is loaded.
      * @param context context object.
      */
     public void openEffectDialog(Context context) {
-        IEffect effect = ProtocolUtil.getIEffect();
-        if (effect != null) {
+        withVideoEffect(effect -> {
+            if (context instanceof Activity && ((Activity) context).isFinishing()) {
+                return;
+            }
             effect.showEffectDialog(context, null);
-        }
+        });
     }
 }
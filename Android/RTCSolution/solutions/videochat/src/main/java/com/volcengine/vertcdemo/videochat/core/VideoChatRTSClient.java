@@ -5,19 +5,29 @@ package com.volcengine.vertcdemo.videochat.core;
 
 import static com.volcengine.vertcdemo.videochat.core.VideoChatDataManager.REPLY_TYPE_ACCEPT;
 
+import android.os.SystemClock;
 import android.text.TextUtils;
 
+import androidx.annotation.NonNull;
+
+import com.google.gson.JsonArray;
 import com.google.gson.JsonObject;
 import com.ss.bytertc.engine.RTCVideo;
 import com.volcengine.vertcdemo.common.AbsBroadcast;
 import com.volcengine.vertcdemo.common.AppExecutors;
-import com.volcengine.vertcdemo.core.SolutionDataManager;
+import com.volcengine.vertcdemo.common.Clock;
+import com.volcengine.vertcdemo.common.Scheduler;
 import com.volcengine.vertcdemo.core.eventbus.SolutionDemoEventManager;
 import com.volcengine.vertcdemo.core.net.IRequestCallback;
 import com.volcengine.vertcdemo.core.net.RequestCallbackAdapter;
+import com.volcengine.vertcdemo.core.net.rts.IRTSCallback;
+import com.volcengine.vertcdemo.core.net.rts.RTCVideoTransport;
 import com.volcengine.vertcdemo.core.net.rts.RTSBaseClient;
 import com.volcengine.vertcdemo.core.net.rts.RTSBizInform;
 import com.volcengine.vertcdemo.core.net.rts.RTSInfo;
+import com.volcengine.vertcdemo.core.net.rts.RTSRequest;
+import com.volcengine.vertcdemo.core.net.rts.RTSSerialLanes;
+import com.volcengine.vertcdemo.core.net.rts.RTSTransport;
 import com.volcengine.vertcdemo.videochat.bean.AnchorPkFinishEvent;
 import com.volcengine.vertcdemo.videochat.bean.AudienceApplyEvent;
 import com.volcengine.vertcdemo.videochat.bean.AudienceChangedEvent;
@@ -26,6 +36,7 @@ import com.volcengine.vertcdemo.videochat.bean.ClearUserEvent;
 import com.volcengine.vertcdemo.videochat.bean.CloseChatRoomEvent;
 import com.volcengine.vertcdemo.videochat.bean.CreateRoomEvent;
 import com.volcengine.vertcdemo.videochat.bean.FinishLiveEvent;
+import com.volcengine.vertcdemo.videochat.bean.ForwardStreamTokenEvent;
 import com.volcengine.vertcdemo.videochat.bean.GetActiveRoomListEvent;
 import com.volcengine.vertcdemo.videochat.bean.GetAnchorsEvent;
 import com.volcengine.vertcdemo.videochat.bean.GetAudienceEvent;
@@ -38,7 +49,9 @@ import com.volcengine.vertcdemo.videochat.bean.JoinRoomEvent;
 import com.volcengine.vertcdemo.videochat.bean.ManageOtherAnchorEvent;
 import com.volcengine.vertcdemo.videochat.bean.MediaChangedEvent;
 import com.volcengine.vertcdemo.videochat.bean.MediaOperateEvent;
+import com.volcengine.vertcdemo.videochat.bean.ReactionTotalsEvent;
 import com.volcengine.vertcdemo.videochat.bean.ReceivedInteractEvent;
+import com.volcengine.vertcdemo.videochat.bean.ReconnectRoomEvent;
 import com.volcengine.vertcdemo.videochat.bean.ReplyAnchorsEvent;
 import com.volcengine.vertcdemo.videochat.bean.ReplyMicOnEvent;
 import com.volcengine.vertcdemo.videochat.bean.SeatChangedEvent;
@@ -46,7 +59,9 @@ import com.volcengine.vertcdemo.videochat.bean.VideoChatResponse;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
 import com.volcengine.vertcdemo.videochat.event.UserStatusChangedEvent;
 
+import java.util.Random;
 import java.util.UUID;
+import java.util.concurrent.Executor;
 
 public class VideoChatRTSClient extends RTSBaseClient {
 
@@ -66,6 +81,7 @@ public class VideoChatRTSClient extends RTSBaseClient {
     private static final String CMD_LEAVE_LIVE_ROOM = "viLeaveLiveRoom";
     private static final String CMD_GET_ACTIVE_LIVE_ROOM_LIST = "viGetActiveLiveRoomList";
     private static final String CMD_SEND_MESSAGE = "viSendMessage";
+    private static final String CMD_SEND_REACTIONS = "viSendReactions";
     private static final String CMD_RECONNECT = "viReconnect";
     private static final String CMD_CLEAR_USER = "viClearUser";
     private static final String CMD_UPDATE_MEDIA_STATUS = "viUpdateMediaStatus";
@@ -75,6 +91,9 @@ public class VideoChatRTSClient extends RTSBaseClient {
     private static final String CMD_REPLY_ANCHOR = "viReplyAnchor";
     private static final String CMD_FINISH_ANCHOR_INTERACT = "viFinishAnchorInteract";
     private static final String CMD_MANAGE_OTHER_ANCHOR = "viManageOtherAnchor";
+    private static final String CMD_GET_FORWARD_STREAM_TOKEN = "viGetForwardStreamToken";
+    private static final String CMD_UPDATE_MIXED_STREAM = "viUpdateMixedStream";
+    private static final String CMD_STOP_MIXED_STREAM = "viStopMixedStream";
 
     private static final String ON_AUDIENCE_JOIN_ROOM = "viOnAudienceJoinRoom";
     private static final String ON_AUDIENCE_LEAVE_ROOM = "viOnAudienceLeaveRoom";
@@ -95,9 +114,40 @@ public class VideoChatRTSClient extends RTSBaseClient {
     private static final String ON_ANCHOR_INTERACT_FINISH = "viOnAnchorInteractFinish";
     private static final String ON_MANAGE_OTHER_ANCHOR = "viOnManageOtherAnchor";
     private static final String ON_CLOSE_CHAT_ROOM = "viOnCloseChatRoom";
+    private static final String ON_REACTION_TOTALS = "viOnReactionTotals";
+
+    /**
+     * Requests of one room reach the SDK in the order they were made, e.g. a seat locked then
+     * unlocked, rooms do not wait for each other.
+     */
+    private final RTSSerialLanes mRequestLanes;
+    /*** Runs the health probe off the caller's thread */
+    private final Executor mNetwork;
 
     public VideoChatRTSClient(RTCVideo rtcVideo, RTSInfo rtmInfo) {
-        super(rtcVideo, rtmInfo);
+        this(new RTCVideoTransport(rtcVideo), rtmInfo);
+    }
+
+    /**
+     * @param transport e.g. a local stand-in of the business server
+     */
+    public VideoChatRTSClient(RTSTransport transport, RTSInfo rtmInfo) {
+        this(transport, rtmInfo, AppExecutors.mainScheduler(), SystemClock::uptimeMillis, new Random(),
+                AppExecutors.networkIO());
+    }
+
+    /**
+     * @param network runs the request lanes, e.g. a direct executor in tests
+     * @see RTSBaseClient#RTSBaseClient(RTSTransport, RTSInfo, Scheduler, Clock, Random)
+     */
+    public VideoChatRTSClient(RTSTransport transport, RTSInfo rtmInfo, Scheduler scheduler,
+                              Clock clock, Random random, Executor network) {
+        super(transport, rtmInfo, scheduler, clock, random);
+        mNetwork = network;
+        mRequestLanes = new RTSSerialLanes(network);
+        setIdempotentEvents(CMD_GET_AUDIENCE_LIST, CMD_GET_APPLY_AUDIENCE_LIST,
+                CMD_GET_ACTIVE_LIVE_ROOM_LIST, CMD_GET_ANCHORS, CMD_UPDATE_MEDIA_STATUS, CMD_RECONNECT,
+                CMD_GET_FORWARD_STREAM_TOKEN, CMD_UPDATE_MIXED_STREAM, CMD_STOP_MIXED_STREAM);
         initEventListener();
     }
 
@@ -105,83 +155,92 @@ public class VideoChatRTSClient extends RTSBaseClient {
         JsonObject params = new JsonObject();
         params.addProperty("app_id", mRTSInfo.appId);
         params.addProperty("room_id", "");
-        params.addProperty("user_id", SolutionDataManager.ins().getUserId());
+        params.addProperty("user_id", getUserId());
         params.addProperty("event_name", cmd);
         params.addProperty("request_id", UUID.randomUUID().toString());
-        params.addProperty("device_id", SolutionDataManager.ins().getDeviceId());
+        params.addProperty("device_id", getDeviceId());
         return params;
     }
 
     private void initEventListener() {
         putEventListener(new AbsBroadcast<>(ON_AUDIENCE_JOIN_ROOM, AudienceChangedEvent.class, (data) -> {
             data.isJoin = true;
-            SolutionDemoEventManager.post(data);
+            post(data);
         }));
 
         putEventListener(new AbsBroadcast<>(ON_AUDIENCE_LEAVE_ROOM, AudienceChangedEvent.class, (data) -> {
             data.isJoin = false;
-            SolutionDemoEventManager.post(data);
+            post(data);
         }));
 
         putEventListener(new AbsBroadcast<>(ON_FINISH_LIVE, FinishLiveEvent.class,
-                SolutionDemoEventManager::post));
+                this::post));
 
         putEventListener(new AbsBroadcast<>(ON_JOIN_INTERACT, InteractChangedEvent.class, (data) -> {
             data.isStart = true;
-            SolutionDemoEventManager.post(data);
+            post(data);
         }));
 
         putEventListener(new AbsBroadcast<>(ON_FINISH_INTERACT, InteractChangedEvent.class, (data) -> {
             data.isStart = false;
-            SolutionDemoEventManager.post(data);
+            post(data);
 
             UserStatusChangedEvent event = new UserStatusChangedEvent(data.userInfo, VideoChatUserInfo.USER_STATUS_NORMAL);
-            SolutionDemoEventManager.post(event);
+            post(event);
         }));
 
         putEventListener(new AbsBroadcast<>(ON_SEAT_STATUS_CHANGE, SeatChangedEvent.class,
-                SolutionDemoEventManager::post));
+                this::post));
 
         putEventListener(new AbsBroadcast<>(ON_MEDIA_STATUS_CHANGE, MediaChangedEvent.class,
-                SolutionDemoEventManager::post));
+                this::post));
 
-        putEventListener(new AbsBroadcast<>(ON_MESSAGE, ChatMessageEvent.class, SolutionDemoEventManager::post));
+        putEventListener(new AbsBroadcast<>(ON_MESSAGE, ChatMessageEvent.class, this::post));
 
         putEventListener(new AbsBroadcast<>(ON_INVITE_INTERACT, ReceivedInteractEvent.class, (data) -> {
             UserStatusChangedEvent event = new UserStatusChangedEvent(data.userInfo, VideoChatUserInfo.USER_STATUS_INVITING);
-            SolutionDemoEventManager.post(event);
-            SolutionDemoEventManager.post(data);
+            post(event);
+            post(data);
         }));
 
         putEventListener(new AbsBroadcast<>(ON_APPLY_INTERACT, AudienceApplyEvent.class, (data) -> {
             data.hasNewApply = true;
-            SolutionDemoEventManager.post(data);
+            post(data);
             UserStatusChangedEvent event = new UserStatusChangedEvent(data.userInfo, VideoChatUserInfo.USER_STATUS_APPLYING);
-            SolutionDemoEventManager.post(event);
+            post(event);
         }));
 
         putEventListener(new AbsBroadcast<>(ON_INVITE_RESULT, InteractResultEvent.class, (data) -> {
-            SolutionDemoEventManager.post(data);
+            post(data);
             int statue = data.reply == REPLY_TYPE_ACCEPT ? VideoChatUserInfo.USER_STATUS_INTERACT : VideoChatUserInfo.USER_STATUS_NORMAL;
             UserStatusChangedEvent event = new UserStatusChangedEvent(data.userInfo, statue);
-            SolutionDemoEventManager.post(event);
+            post(event);
         }));
 
-        putEventListener(new AbsBroadcast<>(ON_MEDIA_OPERATE, MediaOperateEvent.class, SolutionDemoEventManager::post));
+        putEventListener(new AbsBroadcast<>(ON_MEDIA_OPERATE, MediaOperateEvent.class, this::post));
+
+        putEventListener(new AbsBroadcast<>(ON_CLEAR_USER, ClearUserEvent.class, this::post));
 
-        putEventListener(new AbsBroadcast<>(ON_CLEAR_USER, ClearUserEvent.class, SolutionDemoEventManager::post));
+        putEventListener(new AbsBroadcast<>(ON_ANCHOR_INVITE, InviteAnchorEvent.class, this::post));
 
-        putEventListener(new AbsBroadcast<>(ON_ANCHOR_INVITE, InviteAnchorEvent.class, SolutionDemoEventManager::post));
+        putEventListener(new AbsBroadcast<>(ON_ANCHOR_REPLY, InviteAnchorReplyEvent.class, this::post));
 
-        putEventListener(new AbsBroadcast<>(ON_ANCHOR_REPLY, InviteAnchorReplyEvent.class, SolutionDemoEventManager::post));
+        putEventListener(new AbsBroadcast<>(ON_NEW_ANCHOR_JOIN, VideoChatUserInfo.class, this::post));
 
-        putEventListener(new AbsBroadcast<>(ON_NEW_ANCHOR_JOIN, VideoChatUserInfo.class, SolutionDemoEventManager::post));
+        putEventListener(new AbsBroadcast<>(ON_ANCHOR_INTERACT_FINISH, AnchorPkFinishEvent.class, this::post));
 
-        putEventListener(new AbsBroadcast<>(ON_ANCHOR_INTERACT_FINISH, AnchorPkFinishEvent.class, SolutionDemoEventManager::post));
+        putEventListener(new AbsBroadcast<>(ON_MANAGE_OTHER_ANCHOR, ManageOtherAnchorEvent.class, this::post));
 
-        putEventListener(new AbsBroadcast<>(ON_MANAGE_OTHER_ANCHOR, ManageOtherAnchorEvent.class, SolutionDemoEventManager::post));
+        putEventListener(new AbsBroadcast<>(ON_CLOSE_CHAT_ROOM, CloseChatRoomEvent.class, this::post));
 
-        putEventListener(new AbsBroadcast<>(ON_CLOSE_CHAT_ROOM, CloseChatRoomEvent.class, SolutionDemoEventManager::post));
+        putEventListener(new AbsBroadcast<>(ON_REACTION_TOTALS, ReactionTotalsEvent.class, this::post));
+    }
+
+    /**
+     * Hands a notice of the business server to the pages, through the event bus by default.
+     */
+    protected void post(Object event) {
+        SolutionDemoEventManager.post(event);
     }
 
     private void putEventListener(AbsBroadcast<? extends RTSBizInform> absBroadcast) {
@@ -208,6 +267,18 @@ public class VideoChatRTSClient extends RTSBaseClient {
         mEventListeners.remove(ON_ANCHOR_INTERACT_FINISH);
         mEventListeners.remove(ON_MANAGE_OTHER_ANCHOR);
         mEventListeners.remove(ON_CLOSE_CHAT_ROOM);
+        mEventListeners.remove(ON_REACTION_TOTALS);
+    }
+
+    /**
+     * One room of the active list is the cheapest idempotent request the server offers.
+     */
+    @Override
+    protected void sendHealthProbe(@NonNull IRTSCallback callback) {
+        JsonObject params = getCommonParams(CMD_GET_ACTIVE_LIVE_ROOM_LIST);
+        params.addProperty("page_size", 1);
+        mNetwork.execute(() ->
+                sendServerMessage(CMD_GET_ACTIVE_LIVE_ROOM_LIST, "", params, callback));
     }
 
     private <T extends VideoChatResponse> void sendServerMessageOnNetwork(
@@ -216,8 +287,11 @@ public class VideoChatRTSClient extends RTSBaseClient {
         if (TextUtils.isEmpty(cmd)) {
             return;
         }
-        AppExecutors.networkIO().execute(() -> {
-            sendServerMessage(cmd, roomId, content, resultClass, callback);
+        // 入队即计时，排队等待计入请求耗时
+        final RTSRequest<T> request = new RTSRequest<>(cmd, callback, resultClass);
+        request.enqueuedAtMs = getLatencyTracer().now();
+        mRequestLanes.execute(roomId == null ? "" : roomId, () -> {
+            sendServerMessage(cmd, roomId, content, request);
         });
     }
 
@@ -313,14 +387,59 @@ public class VideoChatRTSClient extends RTSBaseClient {
     }
 
     public void getActiveRoomList(IRequestCallback<GetActiveRoomListEvent> callback) {
+        getActiveRoomList(null, 0, null, callback);
+    }
+
+    /**
+     * Request one page of active rooms.
+     *
+     * @param pageToken cursor returned by the previous page, null for the first page
+     * @param pageSize  max rooms per page, 0 lets the server return every room
+     * @param etag      etag of the list already shown, lets the server reply not_modified
+     */
+    public void getActiveRoomList(String pageToken, int pageSize, String etag,
+                                  IRequestCallback<GetActiveRoomListEvent> callback) {
         JsonObject params = getCommonParams(CMD_GET_ACTIVE_LIVE_ROOM_LIST);
+        if (!TextUtils.isEmpty(pageToken)) {
+            params.addProperty("page_token", pageToken);
+        }
+        if (pageSize > 0) {
+            params.addProperty("page_size", pageSize);
+        }
+        if (!TextUtils.isEmpty(etag)) {
+            params.addProperty("etag", etag);
+        }
         sendServerMessageOnNetwork("", params, GetActiveRoomListEvent.class, callback);
     }
 
-    public void sendMessage(String roomId, String message, IRequestCallback<VideoChatResponse> callback) {
+    /**
+     * Submit a chat message for moderation, persistence and the viOnMessage fan-out.
+     *
+     * @param messageId id the room already got the message with, echoed in viOnMessage for dedupe
+     */
+    public void sendMessage(String roomId, String message, String messageId, IRequestCallback<VideoChatResponse> callback) {
         JsonObject params = getCommonParams(CMD_SEND_MESSAGE);
         params.addProperty("room_id", roomId);
         params.addProperty("message", message);
+        if (!TextUtils.isEmpty(messageId)) {
+            params.addProperty("message_id", messageId);
+        }
+        sendServerMessageOnNetwork(roomId, params, VideoChatResponse.class, callback);
+    }
+
+    /**
+     * Report reactions tapped since the last report, merged by the server into viOnReactionTotals.
+     *
+     * @param counts taps of every kind, indexed by VideoChatReactions kind
+     */
+    public void sendReactions(String roomId, int[] counts, IRequestCallback<VideoChatResponse> callback) {
+        JsonObject params = getCommonParams(CMD_SEND_REACTIONS);
+        params.addProperty("room_id", roomId);
+        JsonArray array = new JsonArray();
+        for (int count : counts) {
+            array.add(count);
+        }
+        params.add("counts", array);
         sendServerMessageOnNetwork(roomId, params, VideoChatResponse.class, callback);
     }
 
@@ -329,8 +448,37 @@ public class VideoChatRTSClient extends RTSBaseClient {
     }
 
     public void reconnectToServer(String roomId, IRequestCallback<JoinRoomEvent> callback) {
+        reconnectToServer(roomId, 0, callback);
+    }
+
+    /**
+     * Resumable reconnect.
+     *
+     * @param stateVersion version of the room state last applied, 0 asks for a full snapshot
+     */
+    public void reconnectToServer(String roomId, long stateVersion, IRequestCallback<JoinRoomEvent> callback) {
         JsonObject params = getCommonParams(CMD_RECONNECT);
-        sendServerMessageOnNetwork(roomId, params, JoinRoomEvent.class, callback);
+        if (stateVersion <= 0) {
+            sendServerMessageOnNetwork(roomId, params, JoinRoomEvent.class, callback);
+            return;
+        }
+        params.addProperty("state_version", stateVersion);
+        // 增量应答可能不带 audience_count，需与 0 区分
+        sendServerMessageOnNetwork(roomId, params, ReconnectRoomEvent.class, new IRequestCallback<ReconnectRoomEvent>() {
+            @Override
+            public void onSuccess(ReconnectRoomEvent data) {
+                if (callback != null) {
+                    callback.onSuccess(data);
+                }
+            }
+
+            @Override
+            public void onError(int errorCode, String message) {
+                if (callback != null) {
+                    callback.onError(errorCode, message);
+                }
+            }
+        });
     }
 
     public void requestClearUser(Runnable next) {
@@ -400,6 +548,47 @@ public class VideoChatRTSClient extends RTSBaseClient {
         sendServerMessageOnNetwork(roomId, params, ReplyAnchorsEvent.class, callback);
     }
 
+    /**
+     * 获取转推到对端主播房间的新 token，用于 token 过期前刷新或失效后重试
+     *
+     * @param roomId     本端房间
+     * @param peerRoomId 转推目标房间
+     * @param callback
+     */
+    public void requestForwardStreamToken(String roomId, String peerRoomId,
+                                          IRequestCallback<ForwardStreamTokenEvent> callback) {
+        JsonObject params = getCommonParams(CMD_GET_FORWARD_STREAM_TOKEN);
+        params.addProperty("room_id", roomId);
+        params.addProperty("peer_room_id", peerRoomId);
+        sendServerMessageOnNetwork(roomId, params, ForwardStreamTokenEvent.class, callback);
+    }
+
+    /**
+     * 开启或更新服务端合流，每次携带完整布局，服务端以 mix_房间ID 的用户身份把合流发布到房间内
+     *
+     * @param roomId     本端房间
+     * @param layoutJson 合流布局，见 VideoChatMixedStreamLayout
+     * @param callback
+     */
+    public void updateMixedStream(String roomId, String userId, String layoutJson,
+                                  IRequestCallback<VideoChatResponse> callback) {
+        JsonObject params = getCommonParams(CMD_UPDATE_MIXED_STREAM);
+        params.addProperty("room_id", roomId);
+        params.addProperty("user_id", userId);
+        params.addProperty("layout", layoutJson);
+        sendServerMessageOnNetwork(roomId, params, VideoChatResponse.class, callback);
+    }
+
+    /**
+     * 停止服务端合流
+     */
+    public void stopMixedStream(String roomId, String userId, IRequestCallback<VideoChatResponse> callback) {
+        JsonObject params = getCommonParams(CMD_STOP_MIXED_STREAM);
+        params.addProperty("room_id", roomId);
+        params.addProperty("user_id", userId);
+        sendServerMessageOnNetwork(roomId, params, VideoChatResponse.class, callback);
+    }
+
     public void finishAnchorInteract(String roomId, IRequestCallback<VideoChatResponse> callback) {
         JsonObject params = getCommonParams(CMD_FINISH_ANCHOR_INTERACT);
         params.addProperty("room_id", roomId);
@@ -0,0 +1,110 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import java.util.Random;
+
+/**
+ * Floating reactions on screen, a fixed number at most.
+ *
+ * Particles live in parallel arrays sized once, spawning and retiring never allocates. A burst
+ * larger than the free room is cut, the totals still show every reaction; reactions of a
+ * broadcast are spread over the broadcast interval so they rise one after another.
+ *
+ * Times are passed in. Call on the main thread.
+ */
+public class VideoChatReactionParticles {
+
+    public static final long LIFETIME_MS = 2_000;
+
+    private final int mCapacity;
+    private final int[] mKind;
+    private final long[] mStartMs;
+    private final float[] mLane;
+    private final Random mRandom;
+    private int mCount;
+
+    private long mSpawnedCount;
+    private long mDroppedCount;
+
+    public VideoChatReactionParticles(int capacity, Random random) {
+        mCapacity = capacity;
+        mKind = new int[capacity];
+        mStartMs = new long[capacity];
+        mLane = new float[capacity];
+        mRandom = random;
+    }
+
+    /**
+     * @param spreadMs start the particles evenly over this time, 0 for all at once
+     * @return particles spawned, fewer than {@code count} when the pool is full
+     */
+    public int spawn(int kind, int count, long nowMs, long spreadMs) {
+        int spawned = Math.min(count, mCapacity - mCount);
+        for (int i = 0; i < spawned; i++) {
+            mKind[mCount] = kind;
+            mStartMs[mCount] = nowMs + (spawned > 1 ? spreadMs * i / spawned : 0);
+            mLane[mCount] = mRandom.nextFloat();
+            mCount++;
+        }
+        mSpawnedCount += spawned;
+        mDroppedCount += count - spawned;
+        return spawned;
+    }
+
+    /**
+     * Retire the particles whose time is over.
+     *
+     * @return particles still alive, the view keeps animating while this is above 0
+     */
+    public int step(long nowMs) {
+        for (int i = mCount - 1; i >= 0; i--) {
+            if (nowMs - mStartMs[i] >= LIFETIME_MS) {
+                int last = --mCount;
+                mKind[i] = mKind[last];
+                mStartMs[i] = mStartMs[last];
+                mLane[i] = mLane[last];
+            }
+        }
+        return mCount;
+    }
+
+    public int getCount() {
+        return mCount;
+    }
+
+    public int getCapacity() {
+        return mCapacity;
+    }
+
+    public int kindAt(int index) {
+        return mKind[index];
+    }
+
+    /**
+     * @return 0 at the start to 1 at the end of the lifetime, below 0 if not started yet
+     */
+    public float progressAt(int index, long nowMs) {
+        return (float) (nowMs - mStartMs[index]) / LIFETIME_MS;
+    }
+
+    /**
+     * @return random horizontal lane of the particle, 0 to 1
+     */
+    public float laneAt(int index) {
+        return mLane[index];
+    }
+
+    public long getSpawnedCount() {
+        return mSpawnedCount;
+    }
+
+    public long getDroppedCount() {
+        return mDroppedCount;
+    }
+
+    public void clear() {
+        mCount = 0;
+    }
+}
@@ -0,0 +1,245 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.IntDef;
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.common.Scheduler;
+
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.util.Arrays;
+
+/**
+ * Reactions of a room, counted instead of sent one by one.
+ *
+ * Taps only bump a counter; every {@link #FLUSH_INTERVAL_MS} the counters go to the server in one
+ * viSendReactions, one request in flight at a time. The server merges every client and
+ * broadcasts the room totals with what was added since its last broadcast (viOnReactionTotals)
+ * on a fixed cadence, so a room costs one inform per cadence however fast people tap.
+ *
+ * Own taps are shown right away, their share of the next broadcast is not shown again.
+ *
+ * Call on the main thread.
+ */
+public class VideoChatReactions {
+
+    public static final int KIND_LIKE = 0;
+    public static final int KIND_HEART = 1;
+    public static final int KIND_LAUGH = 2;
+    public static final int KIND_CLAP = 3;
+    public static final int KIND_COUNT = 4;
+
+    @IntDef({KIND_LIKE, KIND_HEART, KIND_LAUGH, KIND_CLAP})
+    @Retention(RetentionPolicy.SOURCE)
+    public @interface Kind {
+    }
+
+    public static final long FLUSH_INTERVAL_MS = 1_000;
+    /*** Taps of one kind a client reports per flush at most, more are not believable and dropped */
+    static final int MAX_COUNT_PER_FLUSH = 100;
+
+    public interface Sender {
+        /**
+         * Send the counts of every kind since the last flush, callback on the main thread.
+         */
+        void send(@NonNull int[] counts, @NonNull SendCallback callback);
+    }
+
+    public interface SendCallback {
+        void onResult(boolean success);
+    }
+
+    public interface Listener {
+        /**
+         * Reactions to show, own taps at once and the rest of the room with every broadcast.
+         */
+        void onReactions(@Kind int kind, int count, boolean own);
+
+        void onTotals(@NonNull long[] totals);
+    }
+
+    private final Sender mSender;
+    private final Scheduler mScheduler;
+    @Nullable
+    private Listener mListener;
+
+    private final int[] mPending = new int[KIND_COUNT];
+    private final int[] mInFlight = new int[KIND_COUNT];
+    // Own taps sent, or being sent, that no broadcast has included yet.
+    private final int[] mUnmatched = new int[KIND_COUNT];
+    private final long[] mTotals = new long[KIND_COUNT];
+    private boolean mSending;
+    private boolean mFlushScheduled;
+    private boolean mPaused;
+    private long mLastSeq = -1;
+    // Bumped by reset(), answers to sends of an earlier room are dropped.
+    private int mGeneration;
+
+    private long mTapCount;
+    private long mMessageCount;
+    private long mFailedCount;
+    private long mBroadcastCount;
+
+    private final Runnable mFlushTask = () -> {
+        mFlushScheduled = false;
+        flush();
+    };
+
+    public VideoChatReactions(@NonNull Sender sender, @NonNull Scheduler scheduler) {
+        mSender = sender;
+        mScheduler = scheduler;
+    }
+
+    public void setListener(@Nullable Listener listener) {
+        mListener = listener;
+    }
+
+    /**
+     * The local user tapped a reaction.
+     */
+    public void tap(@Kind int kind) {
+        if (kind < 0 || kind >= KIND_COUNT) {
+            return;
+        }
+        mTapCount++;
+        mPending[kind]++;
+        if (mListener != null) {
+            mListener.onReactions(kind, 1, true);
+        }
+        scheduleFlush();
+    }
+
+    /**
+     * Room totals broadcast by the server.
+     *
+     * @param seq    bumped by every broadcast of the room, older and repeated ones are dropped
+     * @param totals reactions of every kind since the room started
+     * @param added  reactions of every kind since the previous broadcast
+     */
+    public void onTotals(long seq, @Nullable long[] totals, @Nullable int[] added) {
+        if (seq <= mLastSeq || totals == null) {
+            return;
+        }
+        mLastSeq = seq;
+        mBroadcastCount++;
+        for (int kind = 0; kind < KIND_COUNT && kind < totals.length; kind++) {
+            mTotals[kind] = Math.max(mTotals[kind], totals[kind]);
+        }
+        for (int kind = 0; added != null && kind < KIND_COUNT && kind < added.length; kind++) {
+            int own = Math.min(Math.max(0, added[kind]), mUnmatched[kind]);
+            mUnmatched[kind] -= own;
+            int others = added[kind] - own;
+            if (others > 0 && mListener != null) {
+                mListener.onReactions(kind, others, false);
+            }
+        }
+        if (mListener != null) {
+            mListener.onTotals(mTotals.clone());
+        }
+    }
+
+    /**
+     * Keep counting but stop sending, e.g. while the network recovers.
+     */
+    public void pause() {
+        mPaused = true;
+    }
+
+    public void resume() {
+        mPaused = false;
+        scheduleFlush();
+    }
+
+    /**
+     * Drop everything of the current room.
+     */
+    public void reset() {
+        mScheduler.cancel(mFlushTask);
+        mFlushScheduled = false;
+        mSending = false;
+        mGeneration++;
+        Arrays.fill(mPending, 0);
+        Arrays.fill(mInFlight, 0);
+        Arrays.fill(mUnmatched, 0);
+        Arrays.fill(mTotals, 0);
+        mLastSeq = -1;
+    }
+
+    @NonNull
+    public long[] getTotals() {
+        return mTotals.clone();
+    }
+
+    /*** Taps of the local user */
+    public long getTapCount() {
+        return mTapCount;
+    }
+
+    /*** viSendReactions sent for those taps */
+    public long getMessageCount() {
+        return mMessageCount;
+    }
+
+    public long getFailedCount() {
+        return mFailedCount;
+    }
+
+    /*** Room broadcasts taken */
+    public long getBroadcastCount() {
+        return mBroadcastCount;
+    }
+
+    private void scheduleFlush() {
+        if (!mFlushScheduled && !mPaused) {
+            mFlushScheduled = true;
+            mScheduler.schedule(mFlushTask, FLUSH_INTERVAL_MS);
+        }
+    }
+
+    private void flush() {
+        if (mPaused || mSending) {
+            // The answer of the request in flight schedules the next flush.
+            return;
+        }
+        boolean any = false;
+        for (int kind = 0; kind < KIND_COUNT; kind++) {
+            mInFlight[kind] = Math.min(mPending[kind], MAX_COUNT_PER_FLUSH);
+            mPending[kind] = 0;
+            // The broadcast with them may come before the answer.
+            mUnmatched[kind] += mInFlight[kind];
+            any |= mInFlight[kind] > 0;
+        }
+        if (!any) {
+            return;
+        }
+        mSending = true;
+        mMessageCount++;
+        int generation = mGeneration;
+        mSender.send(mInFlight.clone(), success -> {
+            if (generation != mGeneration) {
+                return;
+            }
+            mSending = false;
+            for (int kind = 0; kind < KIND_COUNT; kind++) {
+                if (!success) {
+                    mUnmatched[kind] = Math.max(0, mUnmatched[kind] - mInFlight[kind]);
+                    mPending[kind] += mInFlight[kind];
+                }
+                mInFlight[kind] = 0;
+            }
+            if (!success) {
+                mFailedCount++;
+            }
+            for (int count : mPending) {
+                if (count > 0) {
+                    scheduleFlush();
+                    break;
+                }
+            }
+        });
+    }
+}
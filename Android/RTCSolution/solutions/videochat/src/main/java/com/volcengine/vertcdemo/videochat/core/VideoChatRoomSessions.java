@@ -0,0 +1,177 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import android.util.Log;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.core.net.rts.LatencyHistogram;
+
+import java.util.Iterator;
+import java.util.LinkedHashMap;
+import java.util.Locale;
+import java.util.Map;
+import java.util.TreeMap;
+
+/**
+ * Hands room data from one screen to the next by reference.
+ *
+ * The opening screen puts the object and passes only the returned id through the Intent or
+ * fragment arguments; the receiving screen takes it back. Ids are only valid in this process,
+ * after process death {@link #take(String, Class)} returns null and the receiver falls back to
+ * its saved instance state.
+ *
+ * Also traces room entry: time from opening the room screen, e.g. right after the room was
+ * created, to the first local or remote video frame of the SDK. Entries are added up per handoff,
+ * so the registry path can be compared with the parcel fallback and the join-only path.
+ */
+public class VideoChatRoomSessions {
+
+    private static final String TAG = "VideoChatRoomSessions";
+
+    /*** Entries nobody took (e.g. the screen never started) are dropped beyond this */
+    public static final int MAX_PENDING = 8;
+
+    /*** Data taken from this registry */
+    public static final String HANDOFF_REGISTRY = "registry";
+    /*** Data restored from saved instance state */
+    public static final String HANDOFF_PARCEL = "parcel";
+    /*** Only the room id was handed off, the data came with the join response */
+    public static final String HANDOFF_JOIN = "join";
+    /*** The first frame came before the room screen reported its handoff */
+    public static final String HANDOFF_UNKNOWN = "unknown";
+
+    private static VideoChatRoomSessions sInstance;
+
+    public static synchronized VideoChatRoomSessions ins() {
+        if (sInstance == null) {
+            sInstance = new VideoChatRoomSessions();
+        }
+        return sInstance;
+    }
+
+    private final LinkedHashMap<String, Object> mPending = new LinkedHashMap<>();
+    private long mNextId;
+
+    // Room entry trace, open time is 0 when nothing is traced.
+    private long mTraceOpenAtMs;
+    private long mTraceShownAtMs;
+    private String mTraceHandoff;
+    // Per handoff: open->shown and open->first frame.
+    private final Map<String, LatencyHistogram[]> mEntries = new TreeMap<>();
+
+    /**
+     * @return id to pass to the receiving screen
+     */
+    @NonNull
+    public synchronized String put(@NonNull Object data) {
+        String id = "room_session_" + (++mNextId);
+        mPending.put(id, data);
+        Iterator<Map.Entry<String, Object>> iterator = mPending.entrySet().iterator();
+        while (mPending.size() > MAX_PENDING && iterator.hasNext()) {
+            iterator.next();
+            iterator.remove();
+        }
+        return id;
+    }
+
+    /**
+     * Remove and return the data put under the id.
+     *
+     * @return null if the id is unknown, e.g. the process was restarted, or the type differs
+     */
+    @Nullable
+    public synchronized <T> T take(@Nullable String id, @NonNull Class<T> type) {
+        if (id == null) {
+            return null;
+        }
+        Object data = mPending.remove(id);
+        return type.isInstance(data) ? type.cast(data) : null;
+    }
+
+    public synchronized int getPendingCount() {
+        return mPending.size();
+    }
+
+    /**
+     * The user asked to enter a room.
+     */
+    public synchronized void traceOpen(long nowMs) {
+        mTraceOpenAtMs = nowMs;
+        mTraceShownAtMs = 0;
+        mTraceHandoff = null;
+    }
+
+    /**
+     * The room screen got its data and built the views.
+     *
+     * @param handoff {@link #HANDOFF_REGISTRY}, {@link #HANDOFF_PARCEL} or {@link #HANDOFF_JOIN}
+     */
+    public synchronized void traceShown(long nowMs, @NonNull String handoff) {
+        if (mTraceOpenAtMs == 0 || mTraceShownAtMs != 0) {
+            return;
+        }
+        mTraceShownAtMs = nowMs;
+        mTraceHandoff = handoff;
+    }
+
+    /**
+     * First local or remote video frame, ends the trace.
+     */
+    public synchronized void traceFirstFrame(long nowMs) {
+        if (mTraceOpenAtMs == 0) {
+            return;
+        }
+        String handoff = mTraceHandoff == null ? HANDOFF_UNKNOWN : mTraceHandoff;
+        LatencyHistogram[] entry = mEntries.get(handoff);
+        if (entry == null) {
+            entry = new LatencyHistogram[]{new LatencyHistogram(), new LatencyHistogram()};
+            mEntries.put(handoff, entry);
+        }
+        if (mTraceShownAtMs != 0) {
+            entry[0].record(mTraceShownAtMs - mTraceOpenAtMs);
+        }
+        entry[1].record(nowMs - mTraceOpenAtMs);
+        Log.i(TAG, "room entry handoff:" + handoff
+                + ", open->shown:" + (mTraceShownAtMs == 0 ? -1 : mTraceShownAtMs - mTraceOpenAtMs) + "ms"
+                + ", open->first frame:" + (nowMs - mTraceOpenAtMs) + "ms");
+        mTraceOpenAtMs = 0;
+    }
+
+    /**
+     * @param handoff {@link #HANDOFF_REGISTRY}, {@link #HANDOFF_PARCEL} or {@link #HANDOFF_JOIN}
+     * @return a copy of the open->first frame times of the handoff, null if none was traced
+     */
+    @Nullable
+    public synchronized LatencyHistogram getFirstFrameHistogram(@NonNull String handoff) {
+        LatencyHistogram[] entry = mEntries.get(handoff);
+        if (entry == null) {
+            return null;
+        }
+        LatencyHistogram copy = new LatencyHistogram();
+        copy.add(entry[1]);
+        return copy;
+    }
+
+    /**
+     * Per handoff: count, p50 and max of open->shown and open->first frame, for a debug panel.
+     */
+    @NonNull
+    public synchronized String dumpEntries() {
+        StringBuilder dump = new StringBuilder("room entry ms (n p50/max)");
+        if (mEntries.isEmpty()) {
+            dump.append("\nno entries");
+        }
+        for (Map.Entry<String, LatencyHistogram[]> entry : mEntries.entrySet()) {
+            LatencyHistogram shown = entry.getValue()[0];
+            LatencyHistogram firstFrame = entry.getValue()[1];
+            dump.append(String.format(Locale.US, "\n%s shown %d %d/%d, first frame %d %d/%d", entry.getKey(),
+                    shown.getTotalCount(), shown.getValueAtPercentile(50), shown.getMax(),
+                    firstFrame.getTotalCount(), firstFrame.getValueAtPercentile(50), firstFrame.getMax()));
+        }
+        return dump.toString();
+    }
+}
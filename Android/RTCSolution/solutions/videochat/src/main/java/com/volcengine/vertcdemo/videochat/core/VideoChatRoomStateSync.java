@@ -0,0 +1,317 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.videochat.bean.AnchorInfo;
+import com.volcengine.vertcdemo.videochat.bean.InteractInfo;
+import com.volcengine.vertcdemo.videochat.bean.JoinRoomEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Objects;
+
+/**
+ * Last room state applied to the UI, used to make viReconnect resumable.
+ *
+ * The client sends {@link #getStateVersion()} with viReconnect and the server answers with
+ * no change, a delta or a full snapshot (see JoinRoomEvent#syncType). {@link #apply} merges
+ * the answer into the held state and reports which parts actually changed, so the room
+ * screen only rebinds those.
+ *
+ * Room, host and self info are held by reference, the same objects VideoChatDataManager
+ * exposes, so status changes made by the room screen are seen here without extra calls.
+ * Seat notices must be fed through the onXxx methods so the held seats never lag the UI.
+ */
+public class VideoChatRoomStateSync {
+
+    /**
+     * What a reconnect response changed compared to the state already shown.
+     */
+    public static class Plan {
+        /**
+         * Merged full state, equivalent to a full snapshot response.
+         */
+        @NonNull
+        public final JoinRoomEvent snapshot;
+        public boolean noChange;
+        public boolean roomStatusChanged;
+        public boolean hostChanged;
+        public boolean selfChanged;
+        public boolean anchorsChanged;
+        public boolean audienceCountChanged;
+        /**
+         * Seats whose occupant, lock or media state changed. A null value means the seat is now empty.
+         */
+        public final Map<Integer, VideoChatSeatInfo> changedSeats = new HashMap<>();
+
+        Plan(@NonNull JoinRoomEvent snapshot) {
+            this.snapshot = snapshot;
+        }
+
+        /**
+         * @return true if the current screen can not be patched and has to be rebuilt
+         */
+        public boolean needsRebuild() {
+            return roomStatusChanged || selfChanged || anchorsChanged;
+        }
+    }
+
+    private long mStateVersion;
+    @Nullable
+    private VideoChatRoomInfo mRoomInfo;
+    @Nullable
+    private VideoChatUserInfo mHostInfo;
+    @Nullable
+    private VideoChatUserInfo mSelfInfo;
+    private final Map<Integer, VideoChatSeatInfo> mSeats = new HashMap<>();
+    private List<AnchorInfo> mAnchors = Collections.emptyList();
+    private int mAudienceCount;
+    @Nullable
+    private String mRtcToken;
+    @Nullable
+    private List<InteractInfo> mInteractInfos;
+
+    public long getStateVersion() {
+        return mStateVersion;
+    }
+
+    @Nullable
+    public VideoChatRoomInfo getRoomInfo() {
+        return mRoomInfo;
+    }
+
+    @Nullable
+    public VideoChatUserInfo getHostInfo() {
+        return mHostInfo;
+    }
+
+    /**
+     * @return read only view of the held seats, keyed by seat id
+     */
+    @NonNull
+    public Map<Integer, VideoChatSeatInfo> getSeats() {
+        return Collections.unmodifiableMap(mSeats);
+    }
+
+    /**
+     * Seed the state from a join, create or rebuild.
+     */
+    public void reset(@NonNull JoinRoomEvent data) {
+        mStateVersion = data.stateVersion;
+        mRoomInfo = data.roomInfo;
+        mHostInfo = data.hostInfo;
+        mSelfInfo = data.userInfo;
+        mSeats.clear();
+        putSeats(mSeats, data.seatMap);
+        mAnchors = data.anchorList == null ? Collections.emptyList() : new ArrayList<>(data.anchorList);
+        mAudienceCount = Math.max(0, data.audienceCount);
+        mRtcToken = data.rtcToken;
+        mInteractInfos = data.interactInfos;
+    }
+
+    public void clear() {
+        mStateVersion = 0;
+        mRoomInfo = null;
+        mHostInfo = null;
+        mSelfInfo = null;
+        mSeats.clear();
+        mAnchors = Collections.emptyList();
+        mAudienceCount = 0;
+        mRtcToken = null;
+        mInteractInfos = null;
+    }
+
+    /**
+     * Merge a viReconnect response into the held state.
+     */
+    @NonNull
+    public Plan apply(@NonNull JoinRoomEvent data) {
+        if (data.syncType == JoinRoomEvent.SYNC_TYPE_NONE) {
+            // Carries no state, a different version is only a bump: the held seats and anchors stay.
+            mStateVersion = data.stateVersion;
+            Plan plan = new Plan(snapshot());
+            plan.noChange = true;
+            return plan;
+        }
+        boolean isDelta = data.syncType == JoinRoomEvent.SYNC_TYPE_DELTA;
+
+        VideoChatRoomInfo roomInfo = data.roomInfo != null ? data.roomInfo : mRoomInfo;
+        VideoChatUserInfo hostInfo = data.hostInfo != null ? data.hostInfo : mHostInfo;
+        VideoChatUserInfo selfInfo = data.userInfo != null ? data.userInfo : mSelfInfo;
+        Map<Integer, VideoChatSeatInfo> seats = new HashMap<>();
+        if (isDelta) {
+            seats.putAll(mSeats);
+        }
+        putSeats(seats, data.seatMap);
+        List<AnchorInfo> anchors = data.anchorList != null || !isDelta
+                ? (data.anchorList == null ? Collections.emptyList() : data.anchorList)
+                : mAnchors;
+        // Absent from a delta means unchanged.
+        int audienceCount = data.audienceCount == JoinRoomEvent.AUDIENCE_COUNT_ABSENT
+                ? mAudienceCount : data.audienceCount;
+        String rtcToken = isDelta && data.rtcToken == null ? mRtcToken : data.rtcToken;
+        List<InteractInfo> interactInfos = isDelta && data.interactInfos == null
+                ? mInteractInfos : data.interactInfos;
+
+        JoinRoomEvent merged = new JoinRoomEvent();
+        merged.isFromCreate = false;
+        merged.stateVersion = data.stateVersion;
+        merged.roomInfo = roomInfo;
+        merged.hostInfo = hostInfo;
+        merged.userInfo = selfInfo;
+        merged.rtcToken = rtcToken;
+        merged.seatMap = seats;
+        merged.anchorList = anchors;
+        merged.interactInfos = interactInfos;
+        merged.audienceCount = audienceCount;
+
+        Plan plan = new Plan(merged);
+        plan.roomStatusChanged = roomInfo == null || mRoomInfo == null || roomInfo.status != mRoomInfo.status;
+        plan.hostChanged = !sameUser(hostInfo, mHostInfo);
+        plan.selfChanged = !sameUser(selfInfo, mSelfInfo);
+        plan.anchorsChanged = !sameAnchors(anchors, mAnchors);
+        plan.audienceCountChanged = audienceCount != mAudienceCount;
+        for (Map.Entry<Integer, VideoChatSeatInfo> entry : seats.entrySet()) {
+            if (!sameSeat(entry.getValue(), mSeats.get(entry.getKey()))) {
+                plan.changedSeats.put(entry.getKey(), entry.getValue());
+            }
+        }
+        for (Integer seatId : mSeats.keySet()) {
+            if (!seats.containsKey(seatId) && mSeats.get(seatId) != null) {
+                plan.changedSeats.put(seatId, null);
+            }
+        }
+        plan.noChange = !plan.roomStatusChanged && !plan.hostChanged && !plan.selfChanged
+                && !plan.anchorsChanged && !plan.audienceCountChanged && plan.changedSeats.isEmpty();
+        reset(merged);
+        return plan;
+    }
+
+    public void onSeatUserChanged(int seatId, @Nullable VideoChatUserInfo userInfo) {
+        VideoChatSeatInfo seat = mSeats.get(seatId);
+        VideoChatSeatInfo updated = new VideoChatSeatInfo();
+        updated.seatIndex = seatId;
+        updated.status = seat == null ? VideoChatDataManager.SEAT_STATUS_UNLOCKED : seat.status;
+        updated.userInfo = copyOf(userInfo);
+        mSeats.put(seatId, updated);
+    }
+
+    public void onSeatStatusChanged(int seatId, @VideoChatDataManager.SeatStatus int status) {
+        VideoChatSeatInfo seat = mSeats.get(seatId);
+        VideoChatSeatInfo updated = seat == null ? new VideoChatSeatInfo() : seat.deepCopy();
+        updated.seatIndex = seatId;
+        updated.status = status;
+        mSeats.put(seatId, updated);
+    }
+
+    public void onSeatsCleared() {
+        mSeats.clear();
+    }
+
+    public void onMediaChanged(@Nullable String userId, int mic, int camera) {
+        if (userId == null) {
+            return;
+        }
+        for (VideoChatSeatInfo seat : mSeats.values()) {
+            if (seat != null && seat.userInfo != null && userId.equals(seat.userInfo.userId)) {
+                seat.userInfo.mic = mic;
+                seat.userInfo.camera = camera;
+            }
+        }
+    }
+
+    public void onAudienceCountChanged(int audienceCount) {
+        mAudienceCount = audienceCount;
+    }
+
+    @NonNull
+    private JoinRoomEvent snapshot() {
+        JoinRoomEvent event = new JoinRoomEvent();
+        event.isFromCreate = false;
+        event.stateVersion = mStateVersion;
+        event.roomInfo = mRoomInfo;
+        event.hostInfo = mHostInfo;
+        event.userInfo = mSelfInfo;
+        event.seatMap = new HashMap<>(mSeats);
+        event.anchorList = mAnchors;
+        event.audienceCount = mAudienceCount;
+        event.rtcToken = mRtcToken;
+        event.interactInfos = mInteractInfos;
+        return event;
+    }
+
+    private static void putSeats(Map<Integer, VideoChatSeatInfo> target,
+                                 @Nullable Map<Integer, VideoChatSeatInfo> seats) {
+        if (seats == null) {
+            return;
+        }
+        for (Map.Entry<Integer, VideoChatSeatInfo> entry : seats.entrySet()) {
+            VideoChatSeatInfo seat = entry.getValue() == null ? null : entry.getValue().deepCopy();
+            if (seat != null) {
+                seat.seatIndex = entry.getKey();
+            }
+            target.put(entry.getKey(), seat);
+        }
+    }
+
+    @Nullable
+    private static VideoChatUserInfo copyOf(@Nullable VideoChatUserInfo info) {
+        return info == null ? null : info.deepCopy();
+    }
+
+    private static boolean sameUser(@Nullable VideoChatUserInfo a, @Nullable VideoChatUserInfo b) {
+        if (a == b) {
+            return true;
+        }
+        if (a == null || b == null) {
+            return false;
+        }
+        return Objects.equals(a.userId, b.userId)
+                && Objects.equals(a.userName, b.userName)
+                && a.userRole == b.userRole
+                && a.userStatus == b.userStatus
+                && a.mic == b.mic
+                && a.camera == b.camera;
+    }
+
+    private static boolean sameSeat(@Nullable VideoChatSeatInfo a, @Nullable VideoChatSeatInfo b) {
+        boolean aEmpty = a == null || (a.userInfo == null && !a.isLocked());
+        boolean bEmpty = b == null || (b.userInfo == null && !b.isLocked());
+        if (aEmpty || bEmpty) {
+            return aEmpty == bEmpty;
+        }
+        return a.status == b.status && sameUser(a.userInfo, b.userInfo);
+    }
+
+    private static boolean sameAnchors(@NonNull List<AnchorInfo> a, @NonNull List<AnchorInfo> b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (int i = 0; i < a.size(); i++) {
+            AnchorInfo x = a.get(i);
+            AnchorInfo y = b.get(i);
+            if (x == y) {
+                continue;
+            }
+            if (x == null || y == null
+                    || !Objects.equals(x.userId, y.userId)
+                    || !Objects.equals(x.roomId, y.roomId)
+                    || x.mic != y.mic
+                    || x.camera != y.camera
+                    || x.audioStatusThisRoom != y.audioStatusThisRoom) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
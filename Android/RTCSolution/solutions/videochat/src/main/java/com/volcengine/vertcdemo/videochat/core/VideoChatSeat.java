@@ -0,0 +1,187 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static com.volcengine.vertcdemo.videochat.core.VideoChatDataManager.SEAT_STATUS_LOCKED;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import java.util.Objects;
+
+/**
+ * One seat as shown in the grid, immutable. Where the seat is comes from its index in
+ * {@link VideoChatSeatTable}.
+ *
+ * Seats of the same occupant that only differ in lock, mic or camera state belong to one
+ * family and are interned there, so toggling them hands out the same instances again instead of
+ * allocating, and a view tells whether anything changed by identity alone.
+ *
+ * Call on the main thread.
+ */
+public final class VideoChatSeat {
+
+    private static final int VARIANT_LOCKED = 1 << 2;
+    private static final int VARIANT_MIC = 1 << 1;
+    private static final int VARIANT_CAMERA = 1;
+    private static final int VARIANT_COUNT = 8;
+
+    /*** The unlocked empty seat, shared by every table */
+    public static final VideoChatSeat EMPTY = new VideoChatSeat(
+            new VideoChatSeat[VARIANT_COUNT], 0, null, null, null,
+            VideoChatUserInfo.USER_ROLE_AUDIENCE, VideoChatUserInfo.USER_STATUS_NORMAL);
+
+    static {
+        EMPTY.mFamily[0] = EMPTY;
+        EMPTY.variant(VARIANT_LOCKED);
+    }
+
+    @Nullable
+    public final String roomId;
+    @Nullable
+    public final String userId;
+    @Nullable
+    public final String userName;
+    @VideoChatUserInfo.UserRole
+    public final int userRole;
+    @VideoChatUserInfo.UserStatus
+    public final int userStatus;
+    private final int mVariant;
+    private final VideoChatSeat[] mFamily;
+
+    private VideoChatSeat(VideoChatSeat[] family, int variant, @Nullable String roomId,
+                          @Nullable String userId, @Nullable String userName,
+                          int userRole, int userStatus) {
+        mFamily = family;
+        mVariant = variant;
+        this.roomId = roomId;
+        this.userId = userId;
+        this.userName = userName;
+        this.userRole = userRole;
+        this.userStatus = userStatus;
+    }
+
+    /**
+     * First seat of a new family. Prefer {@link VideoChatSeatTable}, which reuses the families
+     * of recent occupants.
+     */
+    @NonNull
+    static VideoChatSeat occupy(@NonNull VideoChatUserInfo user, @VideoChatDataManager.SeatStatus int status) {
+        VideoChatSeat seat = new VideoChatSeat(new VideoChatSeat[VARIANT_COUNT], 0, user.roomId,
+                user.userId, user.userName, user.userRole, user.userStatus);
+        seat.mFamily[0] = seat;
+        return seat.with(status, user.isMicOn(), user.isCameraOn());
+    }
+
+    public boolean isEmpty() {
+        return mFamily == EMPTY.mFamily;
+    }
+
+    @VideoChatDataManager.SeatStatus
+    public int getStatus() {
+        return isLocked() ? SEAT_STATUS_LOCKED : SEAT_STATUS_UNLOCKED;
+    }
+
+    public boolean isLocked() {
+        return (mVariant & VARIANT_LOCKED) != 0;
+    }
+
+    public boolean isMicOn() {
+        return (mVariant & VARIANT_MIC) != 0;
+    }
+
+    public boolean isCameraOn() {
+        return (mVariant & VARIANT_CAMERA) != 0;
+    }
+
+    public boolean isHost() {
+        return !isEmpty() && userRole == VideoChatUserInfo.USER_ROLE_HOST;
+    }
+
+    /**
+     * @return whether both seats hold the same occupant, or are both empty
+     */
+    public boolean sameOccupant(@Nullable VideoChatSeat other) {
+        return other != null && other.mFamily == mFamily;
+    }
+
+    /**
+     * @return whether this seat is of the family that {@code user} would get
+     */
+    public boolean isOccupiedBy(@Nullable VideoChatUserInfo user) {
+        return user != null && !isEmpty()
+                && Objects.equals(userId, user.userId)
+                && Objects.equals(userName, user.userName)
+                && Objects.equals(roomId, user.roomId)
+                && userRole == user.userRole
+                && userStatus == user.userStatus;
+    }
+
+    @NonNull
+    public VideoChatSeat withStatus(@VideoChatDataManager.SeatStatus int status) {
+        return with(status, isMicOn(), isCameraOn());
+    }
+
+    /**
+     * Empty seats have no media, asking for it returns the seat itself.
+     */
+    @NonNull
+    public VideoChatSeat withMedia(boolean mic, boolean camera) {
+        return isEmpty() ? this : with(getStatus(), mic, camera);
+    }
+
+    @NonNull
+    VideoChatSeat with(@VideoChatDataManager.SeatStatus int status, boolean mic, boolean camera) {
+        int variant = (status == SEAT_STATUS_LOCKED ? VARIANT_LOCKED : 0);
+        if (!isEmpty()) {
+            variant |= (mic ? VARIANT_MIC : 0) | (camera ? VARIANT_CAMERA : 0);
+        }
+        return variant(variant);
+    }
+
+    private VideoChatSeat variant(int variant) {
+        VideoChatSeat seat = mFamily[variant];
+        if (seat == null) {
+            seat = new VideoChatSeat(mFamily, variant, roomId, userId, userName, userRole, userStatus);
+            mFamily[variant] = seat;
+        }
+        return seat;
+    }
+
+    /**
+     * A mutable copy for code working on the bean, such as the seat option dialog.
+     */
+    @NonNull
+    public VideoChatSeatInfo toSeatInfo(int seatIndex) {
+        VideoChatSeatInfo info = new VideoChatSeatInfo();
+        info.seatIndex = seatIndex;
+        info.status = getStatus();
+        if (!isEmpty()) {
+            VideoChatUserInfo user = new VideoChatUserInfo();
+            user.roomId = roomId;
+            user.userId = userId;
+            user.userName = userName;
+            user.userRole = userRole;
+            user.userStatus = userStatus;
+            user.mic = isMicOn() ? VideoChatUserInfo.MIC_STATUS_ON : VideoChatUserInfo.MIC_STATUS_OFF;
+            user.camera = isCameraOn() ? VideoChatUserInfo.CAMERA_STATUS_ON : VideoChatUserInfo.CAMERA_STATUS_OFF;
+            info.userInfo = user;
+        }
+        return info;
+    }
+
+    @Override
+    public String toString() {
+        return "VideoChatSeat{" +
+                "userId='" + userId + '\'' +
+                ", locked=" + isLocked() +
+                ", mic=" + isMicOn() +
+                ", camera=" + isCameraOn() +
+                '}';
+    }
+}
@@ -0,0 +1,430 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.Map;
+import java.util.Objects;
+import java.util.Random;
+
+/**
+ * Seat state the host embeds as SEI in its published stream, so viewers see seat lock, mic and
+ * camera changes together with the frames they belong to instead of whenever the RTS notice lands.
+ *
+ * Binary schema, big endian:
+ * <pre>
+ *  0  u8[2]  magic 'V' 'C'
+ *  2  u8     schema version, {@link #SCHEMA_VERSION}
+ *  3  u8     header length H, bytes from offset 4 to the first slot record (7 in version 1)
+ *  4  u16    session, random per host screen
+ *  6  u32    sequence, bumped on every state change within a session
+ * 10  u8     slot count N
+ *     ...    H - 7 bytes added by later versions, skipped
+ *  N slot records:
+ *     u8     record length L, bytes after this field
+ *     u8     slot, 0 is the host, N is seat N
+ *     u8     flags, {@link #FLAG_LOCKED} | {@link #FLAG_OCCUPIED} | {@link #FLAG_MIC} | {@link #FLAG_CAMERA}
+ *     u8     user id length K
+ *     K      user id, UTF-8
+ *     ...    L - 3 - K bytes added by later versions, skipped
+ * </pre>
+ * Later versions may only append header fields, record fields or flag bits, which older readers
+ * skip; anything else needs a new magic. The payload travels as base64 text
+ * ({@link #toText()}) because the CDN player hands SEI over as a string.
+ */
+public class VideoChatSeatSei {
+
+    public static final int SCHEMA_VERSION = 1;
+    public static final int FLAG_LOCKED = 1;
+    public static final int FLAG_OCCUPIED = 1 << 1;
+    public static final int FLAG_MIC = 1 << 2;
+    public static final int FLAG_CAMERA = 1 << 3;
+    /*** Longest user id that fits a slot record, longer ids are sent as an unknown occupant */
+    public static final int MAX_USER_ID_BYTES = 0xFF - 3;
+
+    private static final byte MAGIC_0 = 'V';
+    private static final byte MAGIC_1 = 'C';
+    private static final int HEADER_LENGTH_V1 = 7;
+    private static final int RECORD_LENGTH_V1 = 3;
+    private static final char[] BASE64 =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/".toCharArray();
+
+    public static class Slot {
+        public final int slot;
+        public final boolean locked;
+        /*** Null for an empty seat, empty for an occupant whose id did not fit */
+        @Nullable
+        public final String userId;
+        public final boolean mic;
+        public final boolean camera;
+
+        public Slot(int slot, boolean locked, @Nullable String userId, boolean mic, boolean camera) {
+            this.slot = slot;
+            this.locked = locked;
+            this.userId = userId;
+            this.mic = mic;
+            this.camera = camera;
+        }
+
+        public boolean isEmpty() {
+            return userId == null;
+        }
+
+        @Override
+        public boolean equals(Object o) {
+            if (this == o) return true;
+            if (!(o instanceof Slot)) return false;
+            Slot other = (Slot) o;
+            return slot == other.slot && locked == other.locked
+                    && mic == other.mic && camera == other.camera
+                    && Objects.equals(userId, other.userId);
+        }
+
+        @Override
+        public int hashCode() {
+            return Objects.hash(slot, locked, userId, mic, camera);
+        }
+
+        @Override
+        public String toString() {
+            return "Slot{" +
+                    "slot=" + slot +
+                    ", locked=" + locked +
+                    ", userId='" + userId + '\'' +
+                    ", mic=" + mic +
+                    ", camera=" + camera +
+                    '}';
+        }
+    }
+
+    public final int session;
+    public final long sequence;
+    @NonNull
+    public final List<Slot> slots;
+
+    public VideoChatSeatSei(int session, long sequence, @NonNull List<Slot> slots) {
+        this.session = session & 0xFFFF;
+        this.sequence = sequence & 0xFFFFFFFFL;
+        this.slots = Collections.unmodifiableList(new ArrayList<>(slots));
+    }
+
+    /**
+     * @param seats seat id to seat, every grid slot gets a record so viewers also learn lock state
+     */
+    @NonNull
+    public static VideoChatSeatSei build(int session, long sequence,
+                                         @Nullable VideoChatUserInfo host,
+                                         @Nullable Map<Integer, VideoChatSeatInfo> seats) {
+        List<Slot> slots = new ArrayList<>(VideoChatMixedStreamLayout.SLOT_COUNT);
+        slots.add(slot(0, false, host));
+        for (int id = 1; id < VideoChatMixedStreamLayout.SLOT_COUNT; id++) {
+            VideoChatSeatInfo seat = seats == null ? null : seats.get(id);
+            slots.add(seat == null
+                    ? new Slot(id, false, null, false, false)
+                    : slot(id, seat.isLocked(), seat.userInfo));
+        }
+        return new VideoChatSeatSei(session, sequence, slots);
+    }
+
+    private static Slot slot(int id, boolean locked, @Nullable VideoChatUserInfo user) {
+        if (user == null) {
+            return new Slot(id, locked, null, false, false);
+        }
+        String userId = user.userId == null ? "" : user.userId;
+        return new Slot(id, locked, userId, user.isMicOn(), user.isCameraOn());
+    }
+
+    @Nullable
+    public Slot getSlot(int slot) {
+        for (Slot item : slots) {
+            if (item.slot == slot) {
+                return item;
+            }
+        }
+        return null;
+    }
+
+    @NonNull
+    public byte[] encode() {
+        int size = 4 + HEADER_LENGTH_V1;
+        byte[][] ids = new byte[slots.size()][];
+        for (int i = 0; i < slots.size(); i++) {
+            String userId = slots.get(i).userId;
+            ids[i] = userId == null ? new byte[0] : userId.getBytes(StandardCharsets.UTF_8);
+            if (ids[i].length > MAX_USER_ID_BYTES) {
+                ids[i] = new byte[0];
+            }
+            size += 1 + RECORD_LENGTH_V1 + ids[i].length;
+        }
+        byte[] out = new byte[size];
+        int pos = 0;
+        out[pos++] = MAGIC_0;
+        out[pos++] = MAGIC_1;
+        out[pos++] = SCHEMA_VERSION;
+        out[pos++] = HEADER_LENGTH_V1;
+        out[pos++] = (byte) (session >> 8);
+        out[pos++] = (byte) session;
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out[pos++] = (byte) (sequence >> shift);
+        }
+        out[pos++] = (byte) slots.size();
+        for (int i = 0; i < slots.size(); i++) {
+            Slot slot = slots.get(i);
+            out[pos++] = (byte) (RECORD_LENGTH_V1 + ids[i].length);
+            out[pos++] = (byte) slot.slot;
+            out[pos++] = (byte) ((slot.locked ? FLAG_LOCKED : 0)
+                    | (slot.isEmpty() ? 0 : FLAG_OCCUPIED)
+                    | (slot.mic ? FLAG_MIC : 0)
+                    | (slot.camera ? FLAG_CAMERA : 0));
+            out[pos++] = (byte) ids[i].length;
+            System.arraycopy(ids[i], 0, out, pos, ids[i].length);
+            pos += ids[i].length;
+        }
+        return out;
+    }
+
+    /**
+     * @return null if {@code data} is not a seat SEI or is cut short
+     */
+    @Nullable
+    public static VideoChatSeatSei decode(@Nullable byte[] data) {
+        if (data == null || data.length < 4 + HEADER_LENGTH_V1
+                || data[0] != MAGIC_0 || data[1] != MAGIC_1 || (data[2] & 0xFF) < 1) {
+            return null;
+        }
+        int headerLength = data[3] & 0xFF;
+        if (headerLength < HEADER_LENGTH_V1 || 4 + headerLength > data.length) {
+            return null;
+        }
+        int session = (data[4] & 0xFF) << 8 | (data[5] & 0xFF);
+        long sequence = 0;
+        for (int i = 6; i < 10; i++) {
+            sequence = sequence << 8 | (data[i] & 0xFF);
+        }
+        int count = data[10] & 0xFF;
+        int pos = 4 + headerLength;
+        List<Slot> slots = new ArrayList<>(count);
+        for (int i = 0; i < count; i++) {
+            if (pos >= data.length) {
+                return null;
+            }
+            int recordLength = data[pos++] & 0xFF;
+            int end = pos + recordLength;
+            if (recordLength < RECORD_LENGTH_V1 || end > data.length) {
+                return null;
+            }
+            int slot = data[pos] & 0xFF;
+            int flags = data[pos + 1] & 0xFF;
+            int idLength = data[pos + 2] & 0xFF;
+            if (RECORD_LENGTH_V1 + idLength > recordLength) {
+                return null;
+            }
+            String userId = (flags & FLAG_OCCUPIED) == 0
+                    ? null : new String(data, pos + 3, idLength, StandardCharsets.UTF_8);
+            slots.add(new Slot(slot, (flags & FLAG_LOCKED) != 0, userId,
+                    (flags & FLAG_MIC) != 0, (flags & FLAG_CAMERA) != 0));
+            pos = end;
+        }
+        return new VideoChatSeatSei(session, sequence, slots);
+    }
+
+    /**
+     * @return the SEI payload as sent, base64 of {@link #encode()}
+     */
+    @NonNull
+    public String toText() {
+        return toBase64(encode());
+    }
+
+    /**
+     * @return null if {@code text} is not a seat SEI, e.g. SEI some other party put in the stream
+     */
+    @Nullable
+    public static VideoChatSeatSei fromText(@Nullable String text) {
+        byte[] data = fromBase64(text);
+        return data == null ? null : decode(data);
+    }
+
+    /**
+     * Base64 with padding, also used by {@link VideoChatChatPayload}; android.util.Base64 is not
+     * there in unit tests and java.util.Base64 needs API 26.
+     */
+    @NonNull
+    static String toBase64(@NonNull byte[] data) {
+        StringBuilder out = new StringBuilder((data.length + 2) / 3 * 4);
+        for (int i = 0; i < data.length; i += 3) {
+            int n = (data[i] & 0xFF) << 16;
+            if (i + 1 < data.length) n |= (data[i + 1] & 0xFF) << 8;
+            if (i + 2 < data.length) n |= data[i + 2] & 0xFF;
+            out.append(BASE64[n >> 18 & 0x3F]).append(BASE64[n >> 12 & 0x3F]);
+            out.append(i + 1 < data.length ? BASE64[n >> 6 & 0x3F] : '=');
+            out.append(i + 2 < data.length ? BASE64[n & 0x3F] : '=');
+        }
+        return out.toString();
+    }
+
+    /**
+     * @return null if {@code text} is not base64
+     */
+    @Nullable
+    static byte[] fromBase64(@Nullable String text) {
+        if (text == null) {
+            return null;
+        }
+        text = text.trim();
+        if (text.isEmpty() || text.length() % 4 != 0) {
+            return null;
+        }
+        int padding = text.endsWith("==") ? 2 : text.endsWith("=") ? 1 : 0;
+        byte[] data = new byte[text.length() / 4 * 3 - padding];
+        int pos = 0;
+        for (int i = 0; i < text.length(); i += 4) {
+            int n = 0;
+            for (int j = 0; j < 4; j++) {
+                char c = text.charAt(i + j);
+                int value = c == '=' && i + 4 == text.length() && j >= 4 - padding ? 0 : base64Value(c);
+                if (value < 0) {
+                    return null;
+                }
+                n = n << 6 | value;
+            }
+            for (int shift = 16; shift >= 0 && pos < data.length; shift -= 8) {
+                data[pos++] = (byte) (n >> shift);
+            }
+        }
+        return data;
+    }
+
+    private static int base64Value(char c) {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    }
+
+    /**
+     * Host side: builds the payload to send as SEI, a new sequence only when the state changed.
+     */
+    public static class Writer {
+        private final int mSession;
+        private long mSequence;
+        @Nullable
+        private VideoChatSeatSei mCurrent;
+        @Nullable
+        private byte[] mPayload;
+
+        public Writer() {
+            this(new Random().nextInt(0x10000));
+        }
+
+        public Writer(int session) {
+            mSession = session;
+        }
+
+        /**
+         * @return the payload to send, null if the state is the one already sent
+         */
+        @Nullable
+        public byte[] update(@Nullable VideoChatUserInfo host,
+                             @Nullable Map<Integer, VideoChatSeatInfo> seats) {
+            VideoChatSeatSei next = build(mSession, mSequence + 1, host, seats);
+            if (mCurrent != null && mCurrent.slots.equals(next.slots)) {
+                return null;
+            }
+            mSequence = next.sequence;
+            mCurrent = next;
+            mPayload = next.toText().getBytes(StandardCharsets.US_ASCII);
+            return mPayload;
+        }
+
+        /**
+         * @return the last payload, sent again now and then for viewers who just arrived
+         */
+        @Nullable
+        public byte[] getPayload() {
+            return mPayload;
+        }
+
+        @Nullable
+        public VideoChatSeatSei getCurrent() {
+            return mCurrent;
+        }
+    }
+
+    /**
+     * Viewer side: turns the SEI stream into the slots that changed. SEI repeats over several
+     * frames and arrives from RTC and the player alike, so repeats and older sequences are
+     * dropped. The first SEI of a session is only a baseline: the join response is the truth
+     * until the host reports a change.
+     */
+    public static class Reader {
+        @Nullable
+        private VideoChatSeatSei mLast;
+        private int mDroppedCount;
+
+        @NonNull
+        public List<Slot> onReceived(@NonNull VideoChatSeatSei sei) {
+            VideoChatSeatSei last = mLast;
+            boolean sameSession = last != null && last.session == sei.session;
+            if (sameSession && (int) (sei.sequence - last.sequence) <= 0) {
+                mDroppedCount++;
+                return Collections.emptyList();
+            }
+            mLast = sei;
+            if (!sameSession) {
+                return Collections.emptyList();
+            }
+            List<Slot> changed = new ArrayList<>();
+            for (Slot slot : sei.slots) {
+                Slot before = last.getSlot(slot.slot);
+                if (before == null || !before.equals(slot)) {
+                    changed.add(slot);
+                }
+            }
+            return changed;
+        }
+
+        public void reset() {
+            mLast = null;
+        }
+
+        /*** Repeated or out of order SEI ignored so far */
+        public int getDroppedCount() {
+            return mDroppedCount;
+        }
+    }
+
+    @Override
+    public boolean equals(Object o) {
+        if (this == o) return true;
+        if (!(o instanceof VideoChatSeatSei)) return false;
+        VideoChatSeatSei other = (VideoChatSeatSei) o;
+        return session == other.session && sequence == other.sequence && slots.equals(other.slots);
+    }
+
+    @Override
+    public int hashCode() {
+        return Objects.hash(session, sequence, slots);
+    }
+
+    @Override
+    public String toString() {
+        return "VideoChatSeatSei{" +
+                "session=" + session +
+                ", sequence=" + sequence +
+                ", slots=" + slots +
+                '}';
+    }
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static com.volcengine.vertcdemo.videochat.core.VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+/**
+ * Seats of the grid addressed by seat id, 0 being the host, holding immutable
+ * {@link VideoChatSeat}s.
+ *
+ * Every change swaps the seat at one index and bumps {@link #getVersion()}; nothing is copied,
+ * so a view that remembers the version and the seats it bound redraws only what changed. The
+ * families of recent occupants are kept, so guests hopping on and off the seats reuse their
+ * seats too and a long session settles into replacing references only.
+ *
+ * Call on the main thread.
+ */
+public class VideoChatSeatTable {
+
+    public static final int SEAT_COUNT = VideoChatMixedStreamLayout.SLOT_COUNT;
+    private static final int RECENT_FAMILIES = 32;
+
+    private final VideoChatSeat[] mSeats = new VideoChatSeat[SEAT_COUNT];
+    private final VideoChatSeat[] mRecent = new VideoChatSeat[RECENT_FAMILIES];
+    private int mRecentNext;
+    private long mVersion;
+
+    public VideoChatSeatTable() {
+        for (int i = 0; i < SEAT_COUNT; i++) {
+            mSeats[i] = VideoChatSeat.EMPTY;
+        }
+    }
+
+    /**
+     * @param seatId 0 until {@link #SEAT_COUNT}
+     */
+    @NonNull
+    public VideoChatSeat get(int seatId) {
+        return mSeats[seatId];
+    }
+
+    /*** Bumped by every change */
+    public long getVersion() {
+        return mVersion;
+    }
+
+    /**
+     * @return seat id of the user, -1 if not on a seat
+     */
+    public int indexOf(@Nullable String userId) {
+        if (userId == null) {
+            return -1;
+        }
+        for (int i = 0; i < SEAT_COUNT; i++) {
+            if (userId.equals(mSeats[i].userId)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * A seat as sent by the server in a join or reconnect response, null for an empty seat.
+     * @return whether the seat changed
+     */
+    public boolean setSeat(int seatId, @Nullable VideoChatSeatInfo info) {
+        if (!isValid(seatId)) {
+            return false;
+        }
+        int status = info == null ? SEAT_STATUS_UNLOCKED : info.status;
+        return put(seatId, seatOf(info == null ? null : info.userInfo, status));
+    }
+
+    /**
+     * Someone sat down on the seat or left it, the lock status stays.
+     * @return whether the seat changed
+     */
+    public boolean setUser(int seatId, @Nullable VideoChatUserInfo user) {
+        if (!isValid(seatId)) {
+            return false;
+        }
+        return put(seatId, seatOf(user, mSeats[seatId].getStatus()));
+    }
+
+    /**
+     * @return whether the seat changed
+     */
+    public boolean setStatus(int seatId, @VideoChatDataManager.SeatStatus int status) {
+        if (!isValid(seatId)) {
+            return false;
+        }
+        return put(seatId, mSeats[seatId].withStatus(status));
+    }
+
+    /**
+     * @return seat id of the user if the seat changed, -1 otherwise
+     */
+    public int setMedia(@Nullable String userId, boolean mic, boolean camera) {
+        int seatId = indexOf(userId);
+        if (seatId < 0 || !put(seatId, mSeats[seatId].withMedia(mic, camera))) {
+            return -1;
+        }
+        return seatId;
+    }
+
+    private boolean put(int seatId, @NonNull VideoChatSeat seat) {
+        if (mSeats[seatId] == seat) {
+            return false;
+        }
+        mSeats[seatId] = seat;
+        mVersion++;
+        return true;
+    }
+
+    @NonNull
+    private VideoChatSeat seatOf(@Nullable VideoChatUserInfo user, @VideoChatDataManager.SeatStatus int status) {
+        if (user == null) {
+            return VideoChatSeat.EMPTY.withStatus(status);
+        }
+        for (VideoChatSeat seat : mRecent) {
+            if (seat != null && seat.isOccupiedBy(user)) {
+                return seat.with(status, user.isMicOn(), user.isCameraOn());
+            }
+        }
+        VideoChatSeat seat = VideoChatSeat.occupy(user, status);
+        mRecent[mRecentNext] = seat;
+        mRecentNext = (mRecentNext + 1) % RECENT_FAMILIES;
+        return seat;
+    }
+
+    private static boolean isValid(int seatId) {
+        return seatId >= 0 && seatId < SEAT_COUNT;
+    }
+}
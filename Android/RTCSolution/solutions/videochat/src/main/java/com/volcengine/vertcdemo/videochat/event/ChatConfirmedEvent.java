@@ -0,0 +1,15 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.event;
+
+/**
+ * 聊天消息确认事件，业务服务器审核通过了此前只经房间消息收到的临时消息
+ */
+public class ChatConfirmedEvent {
+    public String messageId; // 消息id
+
+    public ChatConfirmedEvent(String messageId) {
+        this.messageId = messageId;
+    }
+}
@@ -0,0 +1,22 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.event;
+
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.videochat.core.VideoChatChatChannel;
+
+/**
+ * 聊天消息事件，来自房间消息或业务服务器，已去重
+ */
+public class ChatReceivedEvent {
+    public String messageId; // 消息id
+    @Nullable
+    public VideoChatChatChannel.Message message; // 消息内容，为空表示该消息被撤回
+
+    public ChatReceivedEvent(String messageId, @Nullable VideoChatChatChannel.Message message) {
+        this.messageId = messageId;
+        this.message = message;
+    }
+}
@@ -0,0 +1,20 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.event;
+
+import com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager;
+
+/**
+ * PK 转推到某个对端房间的状态变化事件
+ */
+public class ForwardStreamStateEvent {
+    public String roomId; // 转推目标房间id
+    @VideoChatForwardStreamManager.TargetState
+    public int state; // 转推状态
+
+    public ForwardStreamStateEvent(String roomId, int state) {
+        this.roomId = roomId;
+        this.state = state;
+    }
+}
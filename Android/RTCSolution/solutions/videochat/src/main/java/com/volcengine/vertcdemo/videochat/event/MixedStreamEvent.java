@@ -0,0 +1,17 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.event;
+
+/**
+ * 服务端合流在当前房间内开始或停止发布的事件
+ */
+public class MixedStreamEvent {
+    public String userId; // 合流用户id，见 VideoChatMixedStreamLayout#mixUserId
+    public boolean published; // 合流是否正在发布
+
+    public MixedStreamEvent(String userId, boolean published) {
+        this.userId = userId;
+        this.published = published;
+    }
+}
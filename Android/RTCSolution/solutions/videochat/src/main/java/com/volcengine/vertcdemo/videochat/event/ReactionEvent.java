@@ -0,0 +1,24 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.event;
+
+import androidx.annotation.Nullable;
+
+/**
+ * 互动表情事件，自己的点击立即通知，房间内其他人的随服务器汇总周期性通知
+ */
+public class ReactionEvent {
+    public int kind; // 表情类型，见 VideoChatReactions
+    public int count; // 本次新增数量，只有总数更新时为0
+    public boolean own; // 是否为自己的点击
+    @Nullable
+    public long[] totals; // 房间内各类型总数，为空表示未更新
+
+    public ReactionEvent(int kind, int count, boolean own, @Nullable long[] totals) {
+        this.kind = kind;
+        this.count = count;
+        this.own = own;
+        this.totals = totals;
+    }
+}
@@ -0,0 +1,17 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.event;
+
+/**
+ * 远端视频首帧渲染事件
+ */
+public class RemoteFirstFrameEvent {
+    public String userId; // 远端用户id
+    public long renderedAtMs; // 渲染时刻，SystemClock.elapsedRealtime
+
+    public RemoteFirstFrameEvent(String userId, long renderedAtMs) {
+        this.userId = userId;
+        this.renderedAtMs = renderedAtMs;
+    }
+}
@@ -0,0 +1,19 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.event;
+
+import com.volcengine.vertcdemo.videochat.core.VideoChatSeatSei;
+
+/**
+ * 主播流中携带的麦位 SEI 事件
+ */
+public class SeatSeiEvent {
+    public String userId; // 发送 SEI 的流所属用户id
+    public VideoChatSeatSei sei; // 解析后的麦位状态
+
+    public SeatSeiEvent(String userId, VideoChatSeatSei sei) {
+        this.userId = userId;
+        this.sei = sei;
+    }
+}
@@ -12,6 +12,7 @@ import android.util.Log;
 import android.view.View;
 
 import androidx.annotation.Keep;
+import androidx.annotation.NonNull;
 import androidx.annotation.Nullable;
 import androidx.recyclerview.widget.LinearLayoutManager;
 import androidx.recyclerview.widget.RecyclerView;
@@ -21,16 +22,17 @@ import com.vertcdemo.joinrtsparams.common.JoinRTSManager;
 import com.volcengine.vertcdemo.common.IAction;
 import com.volcengine.vertcdemo.common.SolutionBaseActivity;
 import com.volcengine.vertcdemo.common.SolutionToast;
+import com.volcengine.vertcdemo.common.TickScheduler;
 import com.volcengine.vertcdemo.core.SolutionDataManager;
 import com.volcengine.vertcdemo.core.eventbus.AppTokenExpiredEvent;
 import com.volcengine.vertcdemo.core.net.IRequestCallback;
 import com.volcengine.vertcdemo.core.net.ServerResponse;
 import com.volcengine.vertcdemo.core.net.rts.RTSBaseClient;
+import com.volcengine.vertcdemo.core.net.rts.RTSNetworkFailover;
 import com.volcengine.vertcdemo.core.net.rts.RTSInfo;
 import com.volcengine.vertcdemo.utils.AppUtil;
 import com.volcengine.vertcdemo.utils.DebounceClickListener;
 import com.volcengine.vertcdemo.videochat.R;
-import com.volcengine.vertcdemo.videochat.bean.GetActiveRoomListEvent;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
 import com.volcengine.vertcdemo.videochat.core.Constants;
 import com.volcengine.vertcdemo.videochat.core.VideoChatRTCManager;
@@ -42,6 +44,7 @@ import org.greenrobot.eventbus.Subscribe;
 import org.greenrobot.eventbus.ThreadMode;
 
 import java.util.List;
+import java.util.concurrent.TimeUnit;
 
 /**
  * Video chat room list activity.
@@ -49,6 +52,10 @@ import java.util.List;
 public class VideoChatListActivity extends SolutionBaseActivity {
 
     private static final String TAG = "VideoChatListActivity";
+    // Start loading the next page when this many rows are left below the last visible one.
+    private static final int PREFETCH_DISTANCE = 5;
+    // Periodic refresh of the first page while the list is in foreground, 0 disables it.
+    private static final long BACKGROUND_REFRESH_INTERVAL_MS = TimeUnit.SECONDS.toMillis(10);
 
     private ActivityVideoChatListBinding mViewBinding;
 
@@ -59,21 +66,71 @@ public class VideoChatListActivity extends SolutionBaseActivity {
 
     private final VideoChatRoomListAdapter mVoiceChatRoomListAdapter = new VideoChatRoomListAdapter(mOnClickRoomInfo);
 
-    private final IRequestCallback<GetActiveRoomListEvent> mRequestRoomList =
-            new IRequestCallback<GetActiveRoomListEvent>() {
-                @Override
-                public void onSuccess(GetActiveRoomListEvent data) {
-                    if (isFinishing()){
-                        return;
-                    }
-                    setRoomList(data.roomList);
-                }
+    private final VideoChatRoomListPager mRoomListPager = new VideoChatRoomListPager(
+            (pageToken, pageSize, etag, callback) -> VideoChatRTCManager.ins().getRTSClient()
+                    .getActiveRoomList(pageToken, pageSize, etag, callback),
+            VideoChatRoomListPager.DEFAULT_PAGE_SIZE);
 
-                @Override
-                public void onError(int errorCode, String message) {
-                    SolutionToast.show(message);
-                }
-            };
+    private final VideoChatRoomListPager.Listener mRoomListListener = new VideoChatRoomListPager.Listener() {
+        @Override
+        public void onRoomListChanged(@NonNull List<VideoChatRoomInfo> roomList) {
+            if (isFinishing()) {
+                return;
+            }
+            setRoomList(roomList);
+        }
+
+        @Override
+        public void onError(int errorCode, String message) {
+            SolutionToast.show(message);
+        }
+    };
+
+    private boolean mRTSLogin = false;
+    // Paused while the network is switching or lost, see RTSNetworkFailover.
+    private boolean mRefreshPaused = false;
+
+    private final Runnable mBackgroundRefreshTask = () -> {
+        if (mRTSLogin && !mRefreshPaused) {
+            mRoomListPager.refresh(false);
+        }
+    };
+    // Runs while the list is in front.
+    @Nullable
+    private TickScheduler.Task mBackgroundRefresh;
+
+    private final RTSNetworkFailover.Pausable mRefreshPausable = new RTSNetworkFailover.Pausable() {
+        @Override
+        public void onPauseNonEssential() {
+            mRefreshPaused = true;
+        }
+
+        @Override
+        public void onResumeNonEssential() {
+            mRefreshPaused = false;
+            // The connection is back, do not wait for the next background tick.
+            if (mRTSLogin) {
+                mRoomListPager.refresh(false);
+            }
+        }
+    };
+
+    private final RecyclerView.OnScrollListener mPrefetchListener = new RecyclerView.OnScrollListener() {
+        @Override
+        public void onScrolled(@NonNull RecyclerView recyclerView, int dx, int dy) {
+            if (dy <= 0 || !mRoomListPager.hasMore() || mRoomListPager.isLoading()) {
+                return;
+            }
+            LinearLayoutManager manager = (LinearLayoutManager) recyclerView.getLayoutManager();
+            if (manager == null) {
+                return;
+            }
+            int lastVisible = manager.findLastVisibleItemPosition();
+            if (lastVisible >= manager.getItemCount() - 1 - PREFETCH_DISTANCE) {
+                mRoomListPager.loadMore();
+            }
+        }
+    };
 
     @Override
     protected void onCreate(@Nullable Bundle savedInstanceState) {
@@ -92,10 +149,30 @@ public class VideoChatListActivity extends SolutionBaseActivity {
         LinearLayoutManager manager = new LinearLayoutManager(this, RecyclerView.VERTICAL, false);
         mViewBinding.videoChatListRv.setLayoutManager(manager);
         mViewBinding.videoChatListRv.setAdapter(mVoiceChatRoomListAdapter);
+        mViewBinding.videoChatListRv.addOnScrollListener(mPrefetchListener);
+        mRoomListPager.setListener(mRoomListListener);
 
         initRTC();
     }
 
+    @Override
+    protected void onResume() {
+        super.onResume();
+        if (BACKGROUND_REFRESH_INTERVAL_MS > 0) {
+            mBackgroundRefresh = TickScheduler.main().schedulePeriodic(BACKGROUND_REFRESH_INTERVAL_MS,
+                    mBackgroundRefreshTask);
+        }
+    }
+
+    @Override
+    protected void onPause() {
+        super.onPause();
+        if (mBackgroundRefresh != null) {
+            mBackgroundRefresh.cancel();
+            mBackgroundRefresh = null;
+        }
+    }
+
     /**
      * Get rts information.
      */
@@ -120,8 +197,10 @@ public class VideoChatListActivity extends SolutionBaseActivity {
             finish();
             return;
         }
+        rtsClient.addNonEssentialTraffic(mRefreshPausable);
         rtsClient.login(mRTSInfo.rtsToken, (resultCode, message) -> {
             if (resultCode == RTSBaseClient.LoginCallBack.SUCCESS) {
+                mRTSLogin = true;
                 requestRoomList();
             } else {
                 SolutionToast.show("Login Rtm Fail Error:" + resultCode + ",Message:" + message);
@@ -137,6 +216,8 @@ public class VideoChatListActivity extends SolutionBaseActivity {
     @Override
     protected void onDestroy() {
         super.onDestroy();
+        mRoomListPager.setListener(null);
+        VideoChatRTCManager.ins().getRTSClient().removeNonEssentialTraffic(mRefreshPausable);
         VideoChatRTCManager.ins().getRTSClient().removeAllEventListener();
         VideoChatRTCManager.ins().getRTSClient().logout();
         VideoChatRTCManager.ins().destroyEngine();
@@ -161,7 +242,7 @@ public class VideoChatListActivity extends SolutionBaseActivity {
      */
     private void requestRoomList() {
         VideoChatRTCManager.ins().getRTSClient().requestClearUser(null);
-        VideoChatRTCManager.ins().getRTSClient().getActiveRoomList(mRequestRoomList);
+        mRoomListPager.refresh(true);
     }
 
     /**
@@ -12,6 +12,8 @@ import android.widget.TextView;
 
 import androidx.annotation.NonNull;
 import androidx.annotation.Nullable;
+import androidx.recyclerview.widget.DiffUtil;
+import androidx.recyclerview.widget.ListAdapter;
 import androidx.recyclerview.widget.RecyclerView;
 
 import com.volcengine.vertcdemo.utils.Utils;
@@ -19,20 +21,40 @@ import com.volcengine.vertcdemo.common.IAction;
 import com.volcengine.vertcdemo.videochat.R;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
 
-import java.util.ArrayList;
 import java.util.List;
+import java.util.Objects;
 
 /**
  * Video chat room list adapter.
+ *
+ * Rows are keyed by room id and diffed off the main thread, so a refresh only rebinds
+ * the rooms whose visible content changed.
  */
-public class VideoChatRoomListAdapter extends RecyclerView.Adapter<RecyclerView.ViewHolder> {
+public class VideoChatRoomListAdapter extends ListAdapter<VideoChatRoomInfo, RecyclerView.ViewHolder> {
 
-    private final List<VideoChatRoomInfo> mRoomList = new ArrayList<>();
+    /**
+     * Rooms are the same row when the id matches, and need a rebind only when a bound field changed.
+     */
+    public static final DiffUtil.ItemCallback<VideoChatRoomInfo> DIFF_CALLBACK = new DiffUtil.ItemCallback<VideoChatRoomInfo>() {
+        @Override
+        public boolean areItemsTheSame(@NonNull VideoChatRoomInfo oldItem, @NonNull VideoChatRoomInfo newItem) {
+            return Objects.equals(oldItem.roomId, newItem.roomId);
+        }
+
+        @Override
+        public boolean areContentsTheSame(@NonNull VideoChatRoomInfo oldItem, @NonNull VideoChatRoomInfo newItem) {
+            return Objects.equals(oldItem.roomName, newItem.roomName)
+                    && Objects.equals(oldItem.hostUserName, newItem.hostUserName)
+                    && oldItem.audienceCount == newItem.audienceCount;
+        }
+    };
 
     private final IAction<VideoChatRoomInfo> mOnClickRoomInfo;
 
     public VideoChatRoomListAdapter(IAction<VideoChatRoomInfo> onClickRoomInfo) {
+        super(DIFF_CALLBACK);
         mOnClickRoomInfo = onClickRoomInfo;
+        setHasStableIds(true);
     }
 
     @NonNull
@@ -45,25 +67,36 @@ public class VideoChatRoomListAdapter extends RecyclerView.Adapter<RecyclerView.
     @Override
     public void onBindViewHolder(@NonNull RecyclerView.ViewHolder holder, int position) {
         if (holder instanceof VoiceChatRoomListViewHolder) {
-            ((VoiceChatRoomListViewHolder) holder).bind(mRoomList.get(position));
+            ((VoiceChatRoomListViewHolder) holder).bind(getItem(position));
         }
     }
 
     @Override
-    public int getItemCount() {
-        return mRoomList.size();
+    public long getItemId(int position) {
+        return stableId(getItem(position).roomId);
     }
 
     /**
-     * Set video chat room list.
+     * Set video chat room list, the list must not be mutated afterwards.
      * @param roomList Video chat room information list, see VideoChatRoomInfo for details.
      */
     public void setRoomList(List<VideoChatRoomInfo> roomList) {
-        mRoomList.clear();
-        if (roomList != null) {
-            mRoomList.addAll(roomList);
+        submitList(roomList);
+    }
+
+    /**
+     * 64-bit FNV-1a of the room id, room ids are not numeric on every deployment.
+     */
+    static long stableId(@Nullable String roomId) {
+        if (roomId == null) {
+            return RecyclerView.NO_ID;
+        }
+        long hash = 0xcbf29ce484222325L;
+        for (int i = 0; i < roomId.length(); i++) {
+            hash ^= roomId.charAt(i);
+            hash *= 0x100000001b3L;
         }
-        notifyDataSetChanged();
+        return hash;
     }
 
     private static class VoiceChatRoomListViewHolder extends RecyclerView.ViewHolder {
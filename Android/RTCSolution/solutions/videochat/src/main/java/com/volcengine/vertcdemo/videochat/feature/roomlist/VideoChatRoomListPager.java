@@ -0,0 +1,223 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.feature.roomlist;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.core.net.IRequestCallback;
+import com.volcengine.vertcdemo.videochat.bean.GetActiveRoomListEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Paged room directory.
+ *
+ * Keeps the loaded pages keyed by room id so a room never shows twice, refreshes
+ * only the first page and drops responses that were overtaken by a newer refresh.
+ * Every change is published as a new immutable list so the adapter can diff it.
+ */
+public class VideoChatRoomListPager {
+
+    public static final int DEFAULT_PAGE_SIZE = 20;
+
+    /**
+     * Source of room list pages, normally VideoChatRTSClient#getActiveRoomList.
+     */
+    public interface PageSource {
+        void load(@Nullable String pageToken, int pageSize, @Nullable String etag,
+                  IRequestCallback<GetActiveRoomListEvent> callback);
+    }
+
+    public interface Listener {
+        void onRoomListChanged(@NonNull List<VideoChatRoomInfo> roomList);
+
+        void onError(int errorCode, String message);
+    }
+
+    private final PageSource mSource;
+    private final int mPageSize;
+    @Nullable
+    private Listener mListener;
+
+    // Rooms of the first page, in server order.
+    private final LinkedHashMap<String, VideoChatRoomInfo> mFirstPage = new LinkedHashMap<>();
+    // Rooms appended by loadMore, in server order.
+    private final LinkedHashMap<String, VideoChatRoomInfo> mMorePages = new LinkedHashMap<>();
+    private List<VideoChatRoomInfo> mSnapshot = Collections.emptyList();
+
+    private String mEtag;
+    private String mNextPageToken;
+    private boolean mHasMore;
+    private boolean mRefreshing;
+    private boolean mLoadingMore;
+    // Bumped on every refresh, responses of an older generation are ignored.
+    private int mGeneration;
+
+    private int mNotModifiedCount;
+
+    public VideoChatRoomListPager(@NonNull PageSource source, int pageSize) {
+        mSource = source;
+        mPageSize = pageSize;
+    }
+
+    public void setListener(@Nullable Listener listener) {
+        mListener = listener;
+    }
+
+    /**
+     * Reload the first page.
+     *
+     * @param force user initiated: ignore the cached etag, drop the pages loaded by loadMore and
+     *              report errors. Background refreshes fail silently and retry on the next tick.
+     */
+    public void refresh(boolean force) {
+        if (mRefreshing && !force) {
+            return;
+        }
+        mRefreshing = true;
+        mLoadingMore = false;
+        final int generation = ++mGeneration;
+        mSource.load(null, mPageSize, force ? null : mEtag, new IRequestCallback<GetActiveRoomListEvent>() {
+            @Override
+            public void onSuccess(GetActiveRoomListEvent data) {
+                if (generation != mGeneration) {
+                    return;
+                }
+                mRefreshing = false;
+                onFirstPage(data, force);
+            }
+
+            @Override
+            public void onError(int errorCode, String message) {
+                if (generation != mGeneration) {
+                    return;
+                }
+                mRefreshing = false;
+                if (force) {
+                    notifyError(errorCode, message);
+                }
+            }
+        });
+    }
+
+    /**
+     * Load the page after the last loaded one, no-op while a request is running or at the end.
+     */
+    public void loadMore() {
+        if (mRefreshing || mLoadingMore || !mHasMore) {
+            return;
+        }
+        mLoadingMore = true;
+        final int generation = mGeneration;
+        mSource.load(mNextPageToken, mPageSize, null, new IRequestCallback<GetActiveRoomListEvent>() {
+            @Override
+            public void onSuccess(GetActiveRoomListEvent data) {
+                if (generation != mGeneration) {
+                    return;
+                }
+                mLoadingMore = false;
+                onNextPage(data);
+            }
+
+            @Override
+            public void onError(int errorCode, String message) {
+                if (generation != mGeneration) {
+                    return;
+                }
+                mLoadingMore = false;
+                notifyError(errorCode, message);
+            }
+        });
+    }
+
+    public boolean hasMore() {
+        return mHasMore;
+    }
+
+    public boolean isLoading() {
+        return mRefreshing || mLoadingMore;
+    }
+
+    /**
+     * @return how many refreshes were short-circuited because the list was unchanged
+     */
+    public int getNotModifiedCount() {
+        return mNotModifiedCount;
+    }
+
+    @NonNull
+    public List<VideoChatRoomInfo> getRoomList() {
+        return mSnapshot;
+    }
+
+    private void onFirstPage(@Nullable GetActiveRoomListEvent data, boolean force) {
+        if (data == null) {
+            return;
+        }
+        boolean sameEtag = data.etag != null && !data.etag.isEmpty() && data.etag.equals(mEtag);
+        if (!force && (data.notModified || sameEtag)) {
+            mNotModifiedCount++;
+            return;
+        }
+        mEtag = data.etag;
+        mFirstPage.clear();
+        putAll(mFirstPage, data.roomList);
+        // A forced or full (unpaged) response replaces everything that was appended before.
+        if (force || !data.hasMore) {
+            mMorePages.clear();
+        }
+        if (mMorePages.isEmpty()) {
+            mNextPageToken = data.nextPageToken;
+            mHasMore = data.hasMore;
+        }
+        publish();
+    }
+
+    private void onNextPage(@Nullable GetActiveRoomListEvent data) {
+        if (data == null) {
+            return;
+        }
+        putAll(mMorePages, data.roomList);
+        mNextPageToken = data.nextPageToken;
+        mHasMore = data.hasMore;
+        publish();
+    }
+
+    private static void putAll(Map<String, VideoChatRoomInfo> target, @Nullable List<VideoChatRoomInfo> rooms) {
+        if (rooms == null) {
+            return;
+        }
+        for (VideoChatRoomInfo room : rooms) {
+            if (room != null && room.roomId != null) {
+                target.put(room.roomId, room);
+            }
+        }
+    }
+
+    private void publish() {
+        List<VideoChatRoomInfo> list = new ArrayList<>(mFirstPage.size() + mMorePages.size());
+        list.addAll(mFirstPage.values());
+        for (Map.Entry<String, VideoChatRoomInfo> entry : mMorePages.entrySet()) {
+            if (!mFirstPage.containsKey(entry.getKey())) {
+                list.add(entry.getValue());
+            }
+        }
+        mSnapshot = Collections.unmodifiableList(list);
+        if (mListener != null) {
+            mListener.onRoomListChanged(mSnapshot);
+        }
+    }
+
+    private void notifyError(int errorCode, String message) {
+        if (mListener != null) {
+            mListener.onError(errorCode, message);
+        }
+    }
+}
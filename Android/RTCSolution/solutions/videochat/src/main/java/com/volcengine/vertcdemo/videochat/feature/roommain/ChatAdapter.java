@@ -14,11 +14,17 @@ import androidx.recyclerview.widget.RecyclerView;
 import com.volcengine.vertcdemo.videochat.R;
 
 import java.util.ArrayList;
+import java.util.HashSet;
 import java.util.List;
+import java.util.Set;
 
 public class ChatAdapter extends RecyclerView.Adapter<RecyclerView.ViewHolder> {
 
     private final List<String> mMsgList = new ArrayList<>();
+    // Message id of every row, null for rows that can not be taken back.
+    private final List<String> mIdList = new ArrayList<>();
+    // Ids of rows shown before the server confirmed them, drawn dimmed.
+    private final Set<String> mProvisionalIds = new HashSet<>();
 
     @NonNull
     @Override
@@ -31,7 +37,9 @@ public class ChatAdapter extends RecyclerView.Adapter<RecyclerView.ViewHolder> {
     @Override
     public void onBindViewHolder(@NonNull RecyclerView.ViewHolder holder, int position) {
         if (holder instanceof ChatViewHolder) {
-            ((ChatViewHolder) holder).bind(mMsgList.get(position));
+            String messageId = mIdList.get(position);
+            ((ChatViewHolder) holder).bind(mMsgList.get(position),
+                    messageId != null && mProvisionalIds.contains(messageId));
         }
     }
 
@@ -41,13 +49,58 @@ public class ChatAdapter extends RecyclerView.Adapter<RecyclerView.ViewHolder> {
     }
 
     public void addChatMsg(String info) {
+        addChatMsg(null, info);
+    }
+
+    public void addChatMsg(String messageId, String info) {
+        addChatMsg(messageId, info, false);
+    }
+
+    /**
+     * @param provisional shown before the server confirmed it, see {@link #confirmChatMsg(String)}
+     */
+    public void addChatMsg(String messageId, String info, boolean provisional) {
         if (info == null) {
             return;
         }
+        if (provisional && messageId != null) {
+            mProvisionalIds.add(messageId);
+        }
         mMsgList.add(info);
+        mIdList.add(messageId);
         notifyItemInserted(mMsgList.size() - 1);
     }
 
+    /**
+     * Show a provisional message as confirmed by the server.
+     */
+    public void confirmChatMsg(String messageId) {
+        if (messageId == null || !mProvisionalIds.remove(messageId)) {
+            return;
+        }
+        int index = mIdList.lastIndexOf(messageId);
+        if (index >= 0) {
+            notifyItemChanged(index);
+        }
+    }
+
+    /**
+     * Remove a message taken back by its sender or never confirmed by the server.
+     */
+    public void removeChatMsg(String messageId) {
+        if (messageId == null) {
+            return;
+        }
+        int index = mIdList.lastIndexOf(messageId);
+        if (index < 0) {
+            return;
+        }
+        mProvisionalIds.remove(messageId);
+        mMsgList.remove(index);
+        mIdList.remove(index);
+        notifyItemRemoved(index);
+    }
+
     private static class ChatViewHolder extends RecyclerView.ViewHolder {
 
         private final TextView mChatTv;
@@ -57,8 +110,9 @@ public class ChatAdapter extends RecyclerView.Adapter<RecyclerView.ViewHolder> {
             mChatTv = (TextView) itemView;
         }
 
-        public void bind(String msg) {
+        public void bind(String msg, boolean provisional) {
             mChatTv.setText(msg);
+            mChatTv.setAlpha(provisional ? 0.6f : 1f);
         }
     }
 }
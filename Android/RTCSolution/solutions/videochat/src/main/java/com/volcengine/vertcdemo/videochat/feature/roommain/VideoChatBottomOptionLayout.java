@@ -52,6 +52,11 @@ public class VideoChatBottomOptionLayout extends LinearLayout {
                 mIBottomOptions.onInputClick();
             }
         });
+        mViewBinding.videoChatMainOptionLikeBtn.setOnClickListener((v) -> {
+            if (mIBottomOptions != null) {
+                mIBottomOptions.onLikeClick();
+            }
+        });
         mViewBinding.videoChatMainOptionPkBtn.setOnClickListener((v) -> {
             if (mIBottomOptions != null) {
                 mIBottomOptions.onPkClick();
@@ -146,6 +151,8 @@ public class VideoChatBottomOptionLayout extends LinearLayout {
 
         void onInputClick();
 
+        void onLikeClick();
+
         void onPkClick();
 
         void onInteractClick();
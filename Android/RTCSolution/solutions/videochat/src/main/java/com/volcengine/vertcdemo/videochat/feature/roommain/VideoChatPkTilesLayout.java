@@ -0,0 +1,79 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.feature.roommain;
+
+import android.content.Context;
+import android.util.AttributeSet;
+import android.view.View;
+import android.view.ViewGroup;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.videochat.core.VideoChatPkTileGrid;
+
+/**
+ * PK video area, lays its visible children out as {@link VideoChatPkTileGrid} tiles in child order.
+ */
+public class VideoChatPkTilesLayout extends ViewGroup {
+
+    private int[] mTiles = new int[0];
+
+    public VideoChatPkTilesLayout(@NonNull Context context) {
+        super(context);
+    }
+
+    public VideoChatPkTilesLayout(@NonNull Context context, @Nullable AttributeSet attrs) {
+        super(context, attrs);
+    }
+
+    public VideoChatPkTilesLayout(@NonNull Context context, @Nullable AttributeSet attrs, int defStyleAttr) {
+        super(context, attrs, defStyleAttr);
+    }
+
+    @Override
+    protected void onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
+        int width = MeasureSpec.getSize(widthMeasureSpec);
+        int height = MeasureSpec.getSize(heightMeasureSpec);
+        setMeasuredDimension(width, height);
+        int count = layoutTiles(width, height);
+        for (int i = 0, tile = 0; i < getChildCount() && tile < count; i++) {
+            View child = getChildAt(i);
+            if (child.getVisibility() == GONE) {
+                continue;
+            }
+            int offset = tile++ * VideoChatPkTileGrid.TILE_STRIDE;
+            child.measure(
+                    MeasureSpec.makeMeasureSpec(mTiles[offset + 2] - mTiles[offset], MeasureSpec.EXACTLY),
+                    MeasureSpec.makeMeasureSpec(mTiles[offset + 3] - mTiles[offset + 1], MeasureSpec.EXACTLY));
+        }
+    }
+
+    @Override
+    protected void onLayout(boolean changed, int l, int t, int r, int b) {
+        int count = layoutTiles(r - l, b - t);
+        for (int i = 0, tile = 0; i < getChildCount() && tile < count; i++) {
+            View child = getChildAt(i);
+            if (child.getVisibility() == GONE) {
+                continue;
+            }
+            int offset = tile++ * VideoChatPkTileGrid.TILE_STRIDE;
+            child.layout(mTiles[offset], mTiles[offset + 1], mTiles[offset + 2], mTiles[offset + 3]);
+        }
+    }
+
+    private int layoutTiles(int width, int height) {
+        int count = 0;
+        for (int i = 0; i < getChildCount(); i++) {
+            if (getChildAt(i).getVisibility() != GONE) {
+                count++;
+            }
+        }
+        if (mTiles.length < count * VideoChatPkTileGrid.TILE_STRIDE) {
+            mTiles = new int[count * VideoChatPkTileGrid.TILE_STRIDE];
+        }
+        VideoChatPkTileGrid.layout(count, width, height, mTiles);
+        return count;
+    }
+}
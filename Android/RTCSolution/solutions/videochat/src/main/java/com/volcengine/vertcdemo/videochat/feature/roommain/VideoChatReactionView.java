@@ -0,0 +1,93 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.feature.roommain;
+
+import android.content.Context;
+import android.graphics.Canvas;
+import android.graphics.Paint;
+import android.os.SystemClock;
+import android.util.AttributeSet;
+import android.util.TypedValue;
+import android.view.View;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.videochat.core.VideoChatReactionParticles;
+import com.volcengine.vertcdemo.videochat.core.VideoChatReactions;
+
+import java.util.Random;
+
+/**
+ * 互动表情飘屏控件，同屏表情数量有上限，超出的不再显示
+ */
+public class VideoChatReactionView extends View {
+
+    private static final int MAX_PARTICLES = 48;
+    private static final String[] EMOJI = {"👍", "❤️", "😂", "👏"};
+
+    private final VideoChatReactionParticles mParticles = new VideoChatReactionParticles(MAX_PARTICLES, new Random());
+    private final Paint mPaint = new Paint(Paint.ANTI_ALIAS_FLAG);
+    private final float mEmojiSize;
+
+    public VideoChatReactionView(@NonNull Context context) {
+        this(context, null);
+    }
+
+    public VideoChatReactionView(@NonNull Context context, @Nullable AttributeSet attrs) {
+        this(context, attrs, 0);
+    }
+
+    public VideoChatReactionView(@NonNull Context context, @Nullable AttributeSet attrs, int defStyleAttr) {
+        super(context, attrs, defStyleAttr);
+        mEmojiSize = TypedValue.applyDimension(TypedValue.COMPLEX_UNIT_DIP, 28, getResources().getDisplayMetrics());
+        mPaint.setTextSize(mEmojiSize);
+        mPaint.setTextAlign(Paint.Align.CENTER);
+    }
+
+    /**
+     * Show reactions rising from the bottom.
+     *
+     * @param spreadMs start them one after another over this time, 0 for all at once
+     */
+    public void burst(@VideoChatReactions.Kind int kind, int count, long spreadMs) {
+        if (kind < 0 || kind >= EMOJI.length) {
+            return;
+        }
+        if (mParticles.spawn(kind, count, SystemClock.uptimeMillis(), spreadMs) > 0) {
+            postInvalidateOnAnimation();
+        }
+    }
+
+    @Override
+    protected void onDraw(Canvas canvas) {
+        super.onDraw(canvas);
+        long now = SystemClock.uptimeMillis();
+        if (mParticles.step(now) == 0) {
+            return;
+        }
+        float travel = getHeight() - mEmojiSize;
+        float span = getWidth() - mEmojiSize;
+        for (int i = 0; i < mParticles.getCount(); i++) {
+            float progress = mParticles.progressAt(i, now);
+            if (progress < 0) {
+                continue;
+            }
+            float lane = mParticles.laneAt(i);
+            float x = mEmojiSize / 2 + span * lane
+                    + (float) Math.sin((progress * 3 + lane) * Math.PI) * mEmojiSize / 4;
+            float y = getHeight() - travel * progress;
+            // Fade out over the last third.
+            mPaint.setAlpha((int) (255 * Math.min(1f, (1f - progress) * 3)));
+            canvas.drawText(EMOJI[mParticles.kindAt(i)], x, y, mPaint);
+        }
+        postInvalidateOnAnimation();
+    }
+
+    @Override
+    protected void onDetachedFromWindow() {
+        super.onDetachedFromWindow();
+        mParticles.clear();
+    }
+}
@@ -9,14 +9,14 @@ import static com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo.ROOM_STA
 import static com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo.USER_STATUS_INTERACT;
 import static com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo.USER_STATUS_NORMAL;
 import static com.volcengine.vertcdemo.videochat.core.VideoChatDataManager.INTERACT_STATUS_NORMAL;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatDataManager.SEAT_STATUS_LOCKED;
 import static com.volcengine.vertcdemo.videochat.core.VideoChatDataManager.SEAT_STATUS_UNLOCKED;
 import static com.volcengine.vertcdemo.videochat.feature.roommain.AudienceManagerDialog.SEAT_ID_BY_SERVER;
 
 import android.app.Activity;
 import android.content.Intent;
 import android.os.Bundle;
-import android.os.Handler;
-import android.os.Looper;
+import android.os.SystemClock;
 import android.text.TextUtils;
 import android.util.ArrayMap;
 import android.util.Log;
@@ -25,17 +25,21 @@ import android.view.View;
 import android.view.ViewGroup;
 import android.widget.FrameLayout;
 
+import androidx.annotation.NonNull;
 import androidx.annotation.Nullable;
 import androidx.fragment.app.Fragment;
 import androidx.fragment.app.FragmentManager;
+import androidx.fragment.app.FragmentTransaction;
 import androidx.recyclerview.widget.LinearLayoutManager;
 import androidx.recyclerview.widget.RecyclerView;
 
-import com.volcengine.vertcdemo.common.GsonUtils;
+import com.volcengine.vertcdemo.common.AppExecutors;
 import com.volcengine.vertcdemo.common.InputTextDialogFragment;
+import com.volcengine.vertcdemo.common.MainThreadWatchdog;
 import com.volcengine.vertcdemo.common.SolutionBaseActivity;
 import com.volcengine.vertcdemo.common.SolutionCommonDialog;
 import com.volcengine.vertcdemo.common.SolutionToast;
+import com.volcengine.vertcdemo.common.TickScheduler;
 import com.volcengine.vertcdemo.core.SolutionDataManager;
 import com.volcengine.vertcdemo.core.annotation.CameraStatus;
 import com.volcengine.vertcdemo.core.annotation.MicStatus;
@@ -44,8 +48,11 @@ import com.volcengine.vertcdemo.core.eventbus.SDKReconnectToRoomEvent;
 import com.volcengine.vertcdemo.core.eventbus.SolutionDemoEventManager;
 import com.volcengine.vertcdemo.core.net.ErrorTool;
 import com.volcengine.vertcdemo.core.net.IRequestCallback;
+import com.volcengine.vertcdemo.protocol.IVideoPlayer;
+import com.volcengine.vertcdemo.protocol.ProtocolUtil;
 import com.volcengine.vertcdemo.utils.IMEUtils;
 import com.volcengine.vertcdemo.utils.Utils;
+import com.volcengine.vertcdemo.videochat.BuildConfig;
 import com.volcengine.vertcdemo.videochat.R;
 import com.volcengine.vertcdemo.videochat.bean.AnchorInfo;
 import com.volcengine.vertcdemo.videochat.bean.AnchorPkFinishEvent;
@@ -63,27 +70,45 @@ import com.volcengine.vertcdemo.videochat.bean.InviteAnchorEvent;
 import com.volcengine.vertcdemo.videochat.bean.InviteAnchorReplyEvent;
 import com.volcengine.vertcdemo.videochat.bean.JoinRoomEvent;
 import com.volcengine.vertcdemo.videochat.bean.MediaChangedEvent;
+import com.volcengine.vertcdemo.videochat.bean.ReactionTotalsEvent;
 import com.volcengine.vertcdemo.videochat.bean.ReceivedInteractEvent;
 import com.volcengine.vertcdemo.videochat.bean.ReplyAnchorsEvent;
+import com.volcengine.vertcdemo.videochat.bean.SeatChangedEvent;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatResponse;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
 import com.volcengine.vertcdemo.videochat.core.Constants;
+import com.volcengine.vertcdemo.videochat.core.VideoChatAudiencePlayback;
+import com.volcengine.vertcdemo.videochat.core.VideoChatChatChannel;
+import com.volcengine.vertcdemo.videochat.core.VideoChatChatPayload;
 import com.volcengine.vertcdemo.videochat.core.VideoChatDataManager;
+import com.volcengine.vertcdemo.videochat.core.VideoChatMixedStreamController;
+import com.volcengine.vertcdemo.videochat.core.VideoChatMixedStreamLayout;
+import com.volcengine.vertcdemo.videochat.core.VideoChatPkTopology;
 import com.volcengine.vertcdemo.videochat.core.VideoChatRTCManager;
 import com.volcengine.vertcdemo.videochat.core.VideoChatRTSClient;
+import com.volcengine.vertcdemo.videochat.core.VideoChatReactions;
+import com.volcengine.vertcdemo.videochat.core.VideoChatRoomSessions;
+import com.volcengine.vertcdemo.videochat.core.VideoChatRoomStateSync;
+import com.volcengine.vertcdemo.videochat.core.VideoChatSeatSei;
 import com.volcengine.vertcdemo.videochat.databinding.ActivityVideoChatMainBinding;
 import com.volcengine.vertcdemo.videochat.event.AudioStatsEvent;
+import com.volcengine.vertcdemo.videochat.event.ChatConfirmedEvent;
+import com.volcengine.vertcdemo.videochat.event.ChatReceivedEvent;
+import com.volcengine.vertcdemo.videochat.event.MixedStreamEvent;
+import com.volcengine.vertcdemo.videochat.event.ReactionEvent;
+import com.volcengine.vertcdemo.videochat.event.RemoteFirstFrameEvent;
+import com.volcengine.vertcdemo.videochat.event.SeatSeiEvent;
 import com.volcengine.vertcdemo.videochat.feature.roommain.fragment.VideoAnchorPkFragment;
 import com.volcengine.vertcdemo.videochat.feature.roommain.fragment.VideoChatRoomFragment;
 
 import org.greenrobot.eventbus.Subscribe;
 import org.greenrobot.eventbus.ThreadMode;
 
-import java.io.UnsupportedEncodingException;
-import java.net.URLDecoder;
-import java.net.URLEncoder;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
 import java.util.Map;
 import java.util.concurrent.TimeUnit;
 
@@ -98,9 +123,11 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
     private static final String REFER_KEY = "refer";
     private static final String REFER_FROM_CREATE = "create";
     private static final String REFER_FROM_LIST = "list";
-    private static final String REFER_EXTRA_ROOM = "extra_room";
-    private static final String REFER_EXTRA_USER = "extra_user";
-    private static final String REFER_EXTRA_CREATE_JSON = "extra_create_json";
+    private static final String REFER_EXTRA_ROOM_ID = "extra_room_id";
+    private static final String REFER_EXTRA_CREATE_SESSION = "extra_create_session";
+    private static final String KEY_SAVED_CREATE_DATA = "saved_create_data";
+    private static final int SEAT_SEI_REPEAT_COUNT = 15;
+    private static final long SEAT_SEI_REFRESH_MS = 2_000;
 
     private ActivityVideoChatMainBinding mViewBinding;
 
@@ -112,7 +139,46 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
     private boolean isLeaveByKickOut = false;
     private VideoChatRoomFragment mVideoChatFragment;
     private VideoAnchorPkFragment mVideoPkFragment;
-    private final Handler mHandler = new Handler(Looper.getMainLooper());
+    // Room state last applied to this screen, lets viReconnect answer with a delta.
+    private final VideoChatRoomStateSync mStateSync = new VideoChatRoomStateSync();
+    // Room created by this user, kept so it can be restored after process death.
+    private JoinRoomEvent mCreateData;
+    private String mEntryHandoff = VideoChatRoomSessions.HANDOFF_REGISTRY;
+    // CDN playback of a pure audience, null for hosts and when the room has no pull stream.
+    private VideoChatAudiencePlayback mPlayback;
+    private final Runnable mPlaybackSwitchTimeoutTask = () -> {
+        if (mPlayback != null) {
+            mPlayback.onSwitchTimeout(SystemClock.elapsedRealtime());
+        }
+    };
+    // Server side mixed stream of the host's room, fed with the seat layout after every change.
+    private final VideoChatMixedStreamController mMixedStreamController = new VideoChatMixedStreamController(
+            new VideoChatMixedStreamController.Requester() {
+                @Override
+                public void update(@NonNull String layoutJson, @NonNull VideoChatMixedStreamController.Callback callback) {
+                    VideoChatRTCManager.ins().getRTSClient().updateMixedStream(getRoomInfo().roomId,
+                            SolutionDataManager.ins().getUserId(), layoutJson, mixedStreamCallback(callback));
+                }
+
+                @Override
+                public void stop(@NonNull VideoChatMixedStreamController.Callback callback) {
+                    VideoChatRTCManager.ins().getRTSClient().stopMixedStream(getRoomInfo().roomId,
+                            SolutionDataManager.ins().getUserId(), mixedStreamCallback(callback));
+                }
+            },
+            AppExecutors.mainScheduler());
+
+    // Seat state in the host's stream as SEI: the host writes it, viewers read it.
+    private final VideoChatSeatSei.Writer mSeatSeiWriter = new VideoChatSeatSei.Writer();
+    private final VideoChatSeatSei.Reader mSeatSeiReader = new VideoChatSeatSei.Reader();
+    private final Runnable mSeatSeiRefreshTask = () -> {
+        byte[] payload = mSeatSeiWriter.getPayload();
+        if (payload != null) {
+            VideoChatRTCManager.ins().sendSeatSei(payload, 0);
+        }
+    };
+    @Nullable
+    private TickScheduler.Task mSeatSeiRefresh;
 
     private final IRequestCallback<JoinRoomEvent> mJoinCallback = new IRequestCallback<JoinRoomEvent>() {
         @Override
@@ -166,8 +232,9 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
     private final IRequestCallback<JoinRoomEvent> mReconnectCallback = new IRequestCallback<JoinRoomEvent>() {
         @Override
         public void onSuccess(JoinRoomEvent data) {
+            if (isFinishing()) return;
             data.isFromCreate = false;
-            initViewWithData(data);
+            onReconnected(data);
         }
 
         @Override
@@ -183,6 +250,11 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
             openInput();
         }
 
+        @Override
+        public void onLikeClick() {
+            VideoChatRTCManager.ins().getReactions().tap(VideoChatReactions.KIND_LIKE);
+        }
+
         @Override
         public void onPkClick() {
             if (getRoomInfo().status == ROOM_STATUS_CHATTING) {
@@ -217,7 +289,16 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
                                 }
                             });
                 });
-                dialog.setNegativeListener(v -> dialog.dismiss());
+                if (mVideoPkFragment != null
+                        && mVideoPkFragment.getAnchorCount() < VideoChatPkTopology.MAX_ANCHORS) {
+                    // Room for one more anchor, offer to invite one instead of only cancelling.
+                    dialog.setNegativeListener(R.string.video_chat_pk_invite_more, v -> {
+                        dialog.dismiss();
+                        new RemoteAnchorsDialog(VideoChatRoomMainActivity.this).show();
+                    });
+                } else {
+                    dialog.setNegativeListener(v -> dialog.dismiss());
+                }
                 dialog.show();
                 return;
             }
@@ -279,7 +360,8 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
 
         @Override
         public void onSettingsClick() {
-            new VideoChatSettingDialog(VideoChatRoomMainActivity.this, getRoomInfo().roomId, obj -> onBGMClick()).show();
+            new VideoChatSettingDialog(VideoChatRoomMainActivity.this, getRoomInfo().roomId, obj -> onBGMClick(),
+                    enabled -> mMixedStreamController.setEnabled(enabled, buildMixedStreamLayout())).show();
         }
     };
 
@@ -297,9 +379,15 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         mViewBinding.videoChatMainChatRv.setLayoutManager(new LinearLayoutManager(VideoChatRoomMainActivity.this, RecyclerView.VERTICAL, false));
         mViewBinding.videoChatMainChatRv.setAdapter(mChatAdapter);
         mViewBinding.videoChatMainChatRv.setOnClickListener((v) -> closeInput());
+        if (BuildConfig.DEBUG) {
+            mViewBinding.videoChatMainTitle.setOnLongClickListener(v -> {
+                showDebugStats();
+                return true;
+            });
+        }
 
         closeInput();
-        if (!checkArgs()) {
+        if (!checkArgs(savedInstanceState)) {
             onArgsError(getString(R.string.joining_room_failed));
         }
 
@@ -308,27 +396,35 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
 
     /**
      * Check video chat room arguments.
+     * @param savedInstanceState Used when the process was restarted and the room data is gone.
      * @return
      */
-    private boolean checkArgs() {
+    private boolean checkArgs(@Nullable Bundle savedInstanceState) {
         Intent intent = getIntent();
         if (intent == null) {
             return false;
         }
         String refer = intent.getStringExtra(REFER_KEY);
-        String roomJson = intent.getStringExtra(REFER_EXTRA_ROOM);
-        String selfJson = intent.getStringExtra(REFER_EXTRA_USER);
-        VideoChatRoomInfo roomInfo = GsonUtils.gson().fromJson(roomJson, VideoChatRoomInfo.class);
-        VideoChatUserInfo selfInfo = GsonUtils.gson().fromJson(selfJson, VideoChatUserInfo.class);
         if (TextUtils.equals(refer, REFER_FROM_LIST)) {
-            VideoChatRTCManager.ins().getRTSClient().requestJoinRoom(selfInfo.userName, roomInfo.roomId, mJoinCallback);
+            String roomId = intent.getStringExtra(REFER_EXTRA_ROOM_ID);
+            if (TextUtils.isEmpty(roomId)) {
+                return false;
+            }
+            mEntryHandoff = VideoChatRoomSessions.HANDOFF_JOIN;
+            VideoChatRTCManager.ins().getRTSClient().requestJoinRoom(SolutionDataManager.ins().getUserName(), roomId, mJoinCallback);
             return true;
         } else if (TextUtils.equals(refer, REFER_FROM_CREATE)) {
-            String createJson = intent.getStringExtra(REFER_EXTRA_CREATE_JSON);
-            if (TextUtils.isEmpty(createJson)) {
+            JoinRoomEvent createResponse = VideoChatRoomSessions.ins().take(
+                    intent.getStringExtra(REFER_EXTRA_CREATE_SESSION), JoinRoomEvent.class);
+            mEntryHandoff = VideoChatRoomSessions.HANDOFF_REGISTRY;
+            if (createResponse == null && savedInstanceState != null) {
+                createResponse = savedInstanceState.getParcelable(KEY_SAVED_CREATE_DATA);
+                mEntryHandoff = VideoChatRoomSessions.HANDOFF_PARCEL;
+            }
+            if (createResponse == null) {
                 return false;
             }
-            JoinRoomEvent createResponse = GsonUtils.gson().fromJson(createJson, JoinRoomEvent.class);
+            mCreateData = createResponse;
             initViewWithData(createResponse);
             return true;
         } else {
@@ -336,17 +432,31 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         }
     }
 
+    @Override
+    protected void onSaveInstanceState(@NonNull Bundle outState) {
+        super.onSaveInstanceState(outState);
+        if (mCreateData != null) {
+            outState.putParcelable(KEY_SAVED_CREATE_DATA, mCreateData);
+        }
+    }
+
     /**
      * Initialize view.
      * @param data Join room event, see JoinRoomEvent for details.
      */
 
     private void initViewWithData(JoinRoomEvent data) {
+        VideoChatRoomSessions.ins().traceShown(SystemClock.elapsedRealtime(), mEntryHandoff);
+        mStateSync.reset(data);
+        mSeatSeiReader.reset();
         mViewBinding.videoChatMainAudienceNum.setText(String.valueOf(data.audienceCount + 1));
         VideoChatDataManager.ins().roomInfo = data.roomInfo;
         VideoChatDataManager.ins().hostUserInfo = data.hostInfo;
         VideoChatDataManager.ins().selfUserInfo = data.userInfo;
 
+        if (mPlayback == null && !data.userInfo.isHost() && data.userInfo.userStatus != USER_STATUS_INTERACT) {
+            startAudiencePlayback(data.roomInfo.streamPullUrl);
+        }
         if (data.isFromCreate) {
             VideoChatRTCManager.ins().joinRoom(data.roomInfo.roomId, data.rtcToken, data.userInfo.userId, data.userInfo.isHost());
         }
@@ -370,23 +480,23 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
             startChatRoom(data);
         } else if (roomStatus == VideoChatRoomInfo.ROOM_STATUS_PK_ING) {
             // Already in pk, user only is an audience.
-            if (data.anchorList == null || data.anchorList.size() != 2) {
+            if (data.anchorList == null || data.anchorList.size() < 2) {
                 Log.i(TAG, "anchors or hostInfo is null!!");
                 finish();
                 return;
             }
-            AnchorInfo peerAnchor = null;
+            List<AnchorInfo> peerAnchors = new ArrayList<>();
             AnchorInfo localAnchor = null;
             for (AnchorInfo info : data.anchorList) {
                 if (info == null) continue;
                 if (TextUtils.equals(info.userId, getHostUserInfo().userId)) {
                     localAnchor = info;
                 } else {
-                    peerAnchor = info;
+                    peerAnchors.add(info);
                 }
             }
-            if (peerAnchor != null && localAnchor != null) {
-                startPk(peerAnchor, localAnchor, null);
+            if (!peerAnchors.isEmpty() && localAnchor != null) {
+                startPk(localAnchor, peerAnchors, null);
             }
         } else if (roomStatus == VideoChatRoomInfo.ROOM_STATUS_LIVING) {
             if (getSelfUserInfo() != null && getSelfUserInfo().isHost()) {
@@ -396,6 +506,120 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
             }
             setLocalLive();
         }
+        syncMixedStream();
+    }
+
+    /**
+     * Watch the CDN pull stream instead of the RTC streams, the RTC room stays joined for signaling.
+     * @param url CDN pull stream of the room, RTC is used when empty or no player is built in.
+     */
+    private void startAudiencePlayback(@Nullable String url) {
+        IVideoPlayer player = TextUtils.isEmpty(url) ? null : ProtocolUtil.getPlayerInstance();
+        if (player == null) {
+            return;
+        }
+        player.startWithConfiguration(this);
+        if (player.isSupportSEI()) {
+            // The pull stream carries the host's SEI as well, see VideoChatSeatSei.
+            final String hostUid = getHostUserInfo().userId;
+            player.setSEICallback(text -> {
+                VideoChatSeatSei sei = VideoChatSeatSei.fromText(text);
+                if (sei != null) {
+                    SolutionDemoEventManager.post(new SeatSeiEvent(hostUid, sei));
+                }
+            });
+        }
+        mPlayback = new VideoChatAudiencePlayback(player,
+                subscribed -> VideoChatRTCManager.ins().setMediaSubscribed(subscribed));
+        mPlayback.setListener((mode, showPlayer) -> {
+            if (mode == VideoChatAudiencePlayback.MODE_RTC) {
+                AppExecutors.mainHandler().removeCallbacks(mPlaybackSwitchTimeoutTask);
+                Log.i(TAG, "playback switched to rtc in " + mPlayback.getLastSwitchMs()
+                        + "ms, prepared " + mPlayback.getLastPrepareLeadMs() + "ms ahead");
+            }
+            updatePlaybackView(showPlayer);
+            syncMixedStream();
+        });
+        mPlayback.start(url, mViewBinding.pullStreamFl);
+        updatePlaybackView(mPlayback.isPlayerShown());
+    }
+
+    /**
+     * Show the player over the RTC views, or the RTC views alone.
+     * @param showPlayer Whether the CDN pull stream is on screen.
+     */
+    private void updatePlaybackView(boolean showPlayer) {
+        mViewBinding.pullStreamFl.setVisibility(showPlayer ? View.VISIBLE : View.GONE);
+        mViewBinding.bizFl.setVisibility(showPlayer ? View.INVISIBLE : View.VISIBLE);
+    }
+
+    /**
+     * The audience is going on mic, hand over from the player once RTC renders.
+     */
+    private void commitAudiencePlayback() {
+        if (mPlayback == null) {
+            return;
+        }
+        mPlayback.commitInteract(SystemClock.elapsedRealtime());
+        if (mPlayback.getMode() == VideoChatAudiencePlayback.MODE_SWITCHING) {
+            AppExecutors.mainHandler().removeCallbacks(mPlaybackSwitchTimeoutTask);
+            AppExecutors.mainHandler().postDelayed(mPlaybackSwitchTimeoutTask, VideoChatAudiencePlayback.SWITCH_TIMEOUT_MS);
+        }
+    }
+
+    /**
+     * Apply a viReconnect response, patching only what changed while disconnected.
+     * @param data Reconnect response, see JoinRoomEvent#syncType for details.
+     */
+    private void onReconnected(JoinRoomEvent data) {
+        VideoChatRoomStateSync.Plan plan = mStateSync.apply(data);
+        mSeatSeiReader.reset();
+        Log.i(TAG, "onReconnected syncType:" + data.syncType + ",version:" + data.stateVersion
+                + ",noChange:" + plan.noChange + ",rebuild:" + plan.needsRebuild()
+                + ",changedSeats:" + plan.changedSeats.keySet());
+        if (plan.noChange) {
+            return;
+        }
+        JoinRoomEvent snapshot = plan.snapshot;
+        VideoChatDataManager.ins().roomInfo = snapshot.roomInfo;
+        VideoChatDataManager.ins().hostUserInfo = snapshot.hostInfo;
+        VideoChatDataManager.ins().selfUserInfo = snapshot.userInfo;
+        if (plan.needsRebuild()) {
+            rebuildWithData(snapshot);
+            return;
+        }
+        syncMixedStream();
+        if (plan.audienceCountChanged) {
+            mViewBinding.videoChatMainAudienceNum.setText(String.valueOf(snapshot.audienceCount + 1));
+        }
+        if (mVideoChatFragment != null && mVideoChatFragment.isVisible()) {
+            if (plan.hostChanged) {
+                mVideoChatFragment.bindHostInfo(snapshot.hostInfo);
+            }
+            mVideoChatFragment.bindSeats(plan.changedSeats);
+        } else if (plan.hostChanged && getRoomInfo().status == ROOM_STATUS_LIVING) {
+            updateHostCameraView(getHostUserInfo().camera);
+        }
+    }
+
+    /**
+     * Drop the current chat or pk screen and build it again from a full room state.
+     * @param data Full room state, see JoinRoomEvent for details.
+     */
+    private void rebuildWithData(JoinRoomEvent data) {
+        FragmentTransaction transaction = getSupportFragmentManager().beginTransaction();
+        if (mVideoChatFragment != null) {
+            transaction.remove(mVideoChatFragment);
+        }
+        if (mVideoPkFragment != null) {
+            transaction.remove(mVideoPkFragment);
+        }
+        transaction.commitAllowingStateLoss();
+        mVideoChatFragment = null;
+        mVideoPkFragment = null;
+        mViewBinding.bizFl.removeAllViews();
+        mViewBinding.localLiveFl.removeAllViews();
+        initViewWithData(data);
     }
 
     /**
@@ -409,7 +633,7 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         mVideoChatFragment = new VideoChatRoomFragment();
         mVideoChatFragment.setICloseChatRoom(mCloseChatRoom);
         Bundle args = new Bundle();
-        args.putParcelable(VideoChatRoomFragment.KEY_JOIN_DATA, data);
+        args.putString(VideoChatRoomFragment.KEY_JOIN_SESSION, VideoChatRoomSessions.ins().put(data));
         mVideoChatFragment.setArguments(args);
         FragmentManager fragmentManager = getSupportFragmentManager();
         fragmentManager.beginTransaction()
@@ -448,11 +672,21 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         super.onDestroy();
         closeInput();
         SolutionDemoEventManager.unregister(this);
+        mMixedStreamController.release();
+        AppExecutors.mainHandler().removeCallbacks(mPlaybackSwitchTimeoutTask);
+        cancelTask(mSeatSeiRefresh);
+        AppExecutors.mainHandler().removeCallbacks(mCloseInviteInteractDialogTask);
+        AppExecutors.mainHandler().removeCallbacks(mCloseInviteAnchorDialogTask);
+        if (mPlayback != null) {
+            mPlayback.release();
+            mPlayback = null;
+        }
         VideoChatRTCManager.ins().startVideoCapture(false);
         VideoChatRTCManager.ins().startAudioCapture(false);
         VideoChatRTCManager.ins().leaveRoom();
         VideoChatRTCManager.ins().stopAudioMixing();
         VideoChatDataManager.ins().clearData();
+        mStateSync.clear();
     }
 
     @Override
@@ -484,6 +718,27 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         dialog.show();
     }
 
+    /**
+     * Debug panel: RTS request latency by event, room entry, RTC stream quality and main thread stalls.
+     */
+    private void showDebugStats() {
+        VideoChatRTSClient rtsClient = VideoChatRTCManager.ins().getRTSClient();
+        StringBuilder stats = new StringBuilder();
+        if (rtsClient != null) {
+            stats.append(rtsClient.getLatencyTracer().dump()).append("\n\n");
+        }
+        stats.append(VideoChatRoomSessions.ins().dumpEntries()).append("\n\n");
+        stats.append(VideoChatRTCManager.ins().getQualitySummary());
+        MainThreadWatchdog watchdog = MainThreadWatchdog.installed();
+        if (watchdog != null) {
+            stats.append("\n\n").append(watchdog.getReport());
+        }
+        SolutionCommonDialog dialog = new SolutionCommonDialog(this);
+        dialog.setMessage(stats.toString());
+        dialog.setPositiveListener((v) -> dialog.dismiss());
+        dialog.show();
+    }
+
     /**
      * Attempt leave chat room.
      */
@@ -555,16 +810,10 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
             return;
         }
         closeInput();
-        onReceivedMessage(String.format("%s : %s", SolutionDataManager.ins().getUserName(), message));
-        try {
-            message = URLEncoder.encode(message, "UTF-8");
-        } catch (UnsupportedEncodingException e) {
-            e.printStackTrace();
-        }
-        VideoChatRTSClient rtsClient = VideoChatRTCManager.ins().getRTSClient();
-        if (rtsClient != null) {
-            rtsClient.sendMessage(getRoomInfo().roomId, message, null);
-        }
+        VideoChatChatChannel.Message chat = VideoChatRTCManager.ins().getChatChannel().send(getRoomInfo().roomId,
+                SolutionDataManager.ins().getUserId(), SolutionDataManager.ins().getUserName(),
+                VideoChatChatPayload.text(message), System.currentTimeMillis());
+        onReceivedMessage(chat.id, String.format("%s : %s", SolutionDataManager.ins().getUserName(), message));
         fragment.dismiss();
     }
 
@@ -580,7 +829,26 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
      * @param message Chat message.
      */
     private void onReceivedMessage(String message) {
-        mChatAdapter.addChatMsg(message);
+        onReceivedMessage(null, message);
+    }
+
+    /**
+     * The callback of receive chat message.
+     * @param messageId Chat message id, null if it can not be taken back.
+     * @param message Chat message.
+     */
+    private void onReceivedMessage(String messageId, String message) {
+        onReceivedMessage(messageId, message, false);
+    }
+
+    /**
+     * The callback of receive chat message.
+     * @param messageId Chat message id, null if it can not be taken back.
+     * @param message Chat message.
+     * @param provisional Not confirmed by the server yet.
+     */
+    private void onReceivedMessage(String messageId, String message, boolean provisional) {
+        mChatAdapter.addChatMsg(messageId, message, provisional);
         mViewBinding.videoChatMainChatRv.post(() -> mViewBinding.videoChatMainChatRv.smoothScrollToPosition(mChatAdapter.getItemCount()));
     }
 
@@ -609,6 +877,7 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
                 : getString(R.string.video_chat_left_room);
         onReceivedMessage(event.userInfo.userName + suffix);
         mViewBinding.videoChatMainAudienceNum.setText(String.valueOf(event.audienceCount + 1));
+        mStateSync.onAudienceCountChanged(event.audienceCount);
     }
 
     /**
@@ -670,6 +939,11 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         getRoomInfo().status = ROOM_STATUS_LIVING;
         getSelfUserInfo().userStatus = USER_STATUS_NORMAL;
         VideoChatDataManager.ins().selfInviteStatus = INTERACT_STATUS_NORMAL;
+        mStateSync.onSeatsCleared();
+        syncMixedStream();
+        if (mPlayback != null) {
+            mPlayback.finishInteract();
+        }
         mViewBinding.videoChatMainBottomOption.updateUIByRoleAndStatus(ROOM_STATUS_LIVING, getSelfUserInfo().userRole, USER_STATUS_NORMAL);
         FragmentManager fragmentManager = getSupportFragmentManager();
         Fragment videoChatFragment = fragmentManager.findFragmentByTag(TAG_FRAGMENT_CHAT_ROOM);
@@ -693,13 +967,56 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         if (TextUtils.equals(event.userInfo.userId, getSelfUserInfo().userId)) {
             return;
         }
-        String message;
-        try {
-            message = URLDecoder.decode(event.message, "UTF-8");
-        } catch (UnsupportedEncodingException e) {
-            message = event.message;
+        // Most messages came as room message already, the channel drops those.
+        VideoChatRTCManager.ins().getChatChannel().onServerMessage(event.messageId, event.userInfo.userId,
+                event.userInfo.userName, event.message, System.currentTimeMillis());
+    }
+
+    /**
+     * The callback of chat message event, deduplicated from the room message and the server.
+     * @param event Chat received event, see ChatReceivedEvent for details.
+     */
+    @Subscribe(threadMode = ThreadMode.MAIN)
+    public void onChatReceived(ChatReceivedEvent event) {
+        if (event.message == null) {
+            mChatAdapter.removeChatMsg(event.messageId);
+            return;
+        }
+        onReceivedMessage(event.messageId, String.format("%s : %s", event.message.userName,
+                event.message.payload.toDisplayText()), event.message.provisional);
+    }
+
+    /**
+     * The callback of chat confirmed event, the server passed a message shown from the room copy.
+     * @param event Chat confirmed event, see ChatConfirmedEvent for details.
+     */
+    @Subscribe(threadMode = ThreadMode.MAIN)
+    public void onChatConfirmed(ChatConfirmedEvent event) {
+        mChatAdapter.confirmChatMsg(event.messageId);
+    }
+
+    /**
+     * The callback of reaction totals event, merged by the server from every client of the room.
+     * @param event Reaction totals event, see ReactionTotalsEvent for details.
+     */
+    @Subscribe(threadMode = ThreadMode.MAIN)
+    public void onReactionTotalsBroadcast(ReactionTotalsEvent event) {
+        if (!TextUtils.equals(event.roomId, getRoomInfo().roomId)) {
+            return;
+        }
+        VideoChatRTCManager.ins().getReactions().onTotals(event.seq, event.totals, event.added);
+    }
+
+    /**
+     * The callback of reaction event, own taps at once and the rest of the room with every broadcast.
+     * @param event Reaction event, see ReactionEvent for details.
+     */
+    @Subscribe(threadMode = ThreadMode.MAIN)
+    public void onReaction(ReactionEvent event) {
+        if (event.count > 0) {
+            mViewBinding.videoChatMainReactionView.burst(event.kind, event.count,
+                    event.own ? 0 : VideoChatReactions.FLUSH_INTERVAL_MS);
         }
-        onReceivedMessage(String.format("%s : %s", event.userInfo.userName, message));
     }
 
     /**
@@ -709,7 +1026,9 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
     @Subscribe(threadMode = ThreadMode.MAIN)
     public void onInteractChangedBroadcast(InteractChangedEvent event) {
         Log.i(TAG, "onInteractChangedBroadcast:" + event + ",mAgreeHostInvite:" + mAgreeHostInvite);
+        mStateSync.onSeatUserChanged(event.seatId, event.isStart ? event.userInfo : null);
         if (mAgreeHostInvite) {
+            syncMixedStream();
             return;
         }
         VideoChatSeatInfo info = new VideoChatSeatInfo();
@@ -722,6 +1041,11 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         boolean isSelf = TextUtils.equals(SolutionDataManager.ins().getUserId(), event.userInfo.userId);
         if (isSelf) {
             getSelfUserInfo().userStatus = event.isStart ? USER_STATUS_INTERACT : USER_STATUS_NORMAL;
+            if (event.isStart) {
+                commitAudiencePlayback();
+            } else if (mPlayback != null) {
+                mPlayback.finishInteract();
+            }
         }
         mViewBinding.videoChatMainBottomOption.updateUIByRoleAndStatus(ROOM_STATUS_CHATTING, getSelfUserInfo().userRole, getSelfUserInfo().userStatus);
         if (event.isStart && getRoomInfo().status != ROOM_STATUS_CHATTING) {
@@ -739,6 +1063,7 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
                 mVideoChatFragment.onInteractChangedBroadcast(event);
             });
         }
+        syncMixedStream();
     }
 
     /**
@@ -749,6 +1074,9 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         if (mInviteInteractDialog != null) {
             mInviteInteractDialog.dismiss();
         }
+        if (mPlayback != null) {
+            mPlayback.cancelInteract();
+        }
     };
 
     /**
@@ -759,6 +1087,10 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
     public void onReceivedInteractBroadcast(ReceivedInteractEvent event) {
         int oldRoomStatus = getRoomInfo().status;
         Log.i(TAG, "onReceivedInteractBroadcast:" + event + ",oldRoomStatus:" + oldRoomStatus);
+        if (mPlayback != null) {
+            // Subscribe RTC behind the player while the audience decides.
+            mPlayback.prepareInteract(SystemClock.elapsedRealtime());
+        }
         mInviteInteractDialog = new SolutionCommonDialog(this);
         mInviteInteractDialog.setMessage(getString(R.string.host_invited_you_on_mic));
         mInviteInteractDialog.setPositiveBtnText(R.string.accept);
@@ -781,6 +1113,9 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
                             mViewBinding.videoChatMainBottomOption.updateUIByRoleAndStatus(ROOM_STATUS_CHATTING, getSelfUserInfo().userRole, USER_STATUS_INTERACT);
                             VideoChatUserInfo selfUserInfo = getSelfUserInfo();
                             selfUserInfo.userStatus = USER_STATUS_INTERACT;
+                            mStateSync.onSeatUserChanged(event.seatId, selfUserInfo);
+                            syncMixedStream();
+                            commitAudiencePlayback();
                             if (oldRoomStatus == ROOM_STATUS_CHATTING) {
                                 return;
                             }
@@ -808,14 +1143,20 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
                         public void onError(int errorCode, String message) {
                             mAgreeHostInvite = false;
                             VideoChatDataManager.ins().selfInviteStatus = INTERACT_STATUS_NORMAL;
+                            if (mPlayback != null) {
+                                mPlayback.cancelInteract();
+                            }
                             Log.i(TAG, "replyInvite onError errorCode:" + errorCode + ",message:" + message);
                             SolutionToast.show(ErrorTool.getErrorMessageByErrorCode(errorCode, message));
                         }
                     });
             mInviteInteractDialog.dismiss();
-            mHandler.removeCallbacks(mCloseInviteInteractDialogTask);
+            AppExecutors.mainHandler().removeCallbacks(mCloseInviteInteractDialogTask);
         });
         mInviteInteractDialog.setNegativeListener((v) -> {
+            if (mPlayback != null) {
+                mPlayback.cancelInteract();
+            }
             VideoChatRTCManager.ins().getRTSClient().replyInvite(
                     getRoomInfo().roomId,
                     VideoChatDataManager.REPLY_TYPE_REJECT,
@@ -830,10 +1171,11 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
                         }
                     });
             mInviteInteractDialog.dismiss();
-            mHandler.removeCallbacks(mCloseInviteInteractDialogTask);
+            AppExecutors.mainHandler().removeCallbacks(mCloseInviteInteractDialogTask);
         });
         mInviteInteractDialog.show();
-        mHandler.postDelayed(mCloseInviteInteractDialogTask, TimeUnit.SECONDS.toMillis(5));
+        AppExecutors.mainHandler().removeCallbacks(mCloseInviteInteractDialogTask);
+        AppExecutors.mainHandler().postDelayed(mCloseInviteInteractDialogTask, TimeUnit.SECONDS.toMillis(5));
     }
 
     /**
@@ -868,7 +1210,7 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
     public void onReconnectToRoom(SDKReconnectToRoomEvent event) {
         final String roomId = getRoomInfo().roomId;
         VideoChatRTCManager.ins().getRTSClient()
-                .reconnectToServer(roomId, mReconnectCallback);
+                .reconnectToServer(roomId, mStateSync.getStateVersion(), mReconnectCallback);
     }
 
     /**
@@ -900,23 +1242,188 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
     @Subscribe(threadMode = ThreadMode.MAIN)
     public void onMediaChangedBroadcast(MediaChangedEvent event) {
         Log.i(TAG, "MediaChangedBroadcast event:" + event);
+        mStateSync.onMediaChanged(event.userInfo.userId, event.userInfo.mic, event.userInfo.camera);
         String hostUid = getHostUserInfo() == null ? null : getHostUserInfo().userId;
         if (TextUtils.equals(hostUid, event.userInfo.userId)) {
             getHostUserInfo().mic = event.userInfo.mic;
             getHostUserInfo().camera = event.userInfo.camera;
             if (getRoomInfo().status == ROOM_STATUS_LIVING) {
-                if (event.userInfo.camera == VideoChatUserInfo.CAMERA_STATUS_OFF) {
-                    mViewBinding.localLiveFl.setVisibility(View.GONE);
-                    mViewBinding.localAnchorNameFl.setVisibility(View.VISIBLE);
-                } else if (event.userInfo.camera == VideoChatUserInfo.CAMERA_STATUS_ON) {
-                    mViewBinding.localLiveFl.setVisibility(View.VISIBLE);
-                    mViewBinding.localAnchorNameFl.setVisibility(View.GONE);
-                }
+                updateHostCameraView(event.userInfo.camera);
             }
         }
         if (mVideoChatFragment != null && mVideoChatFragment.isVisible()) {
             mVideoChatFragment.onMediaChangedBroadcast(event);
         }
+        syncMixedStream();
+    }
+
+    /**
+     * Switch the single host view between video and the name placeholder.
+     * @param camera Host camera status.
+     */
+    private void updateHostCameraView(@VideoChatUserInfo.CameraStatus int camera) {
+        if (camera == VideoChatUserInfo.CAMERA_STATUS_OFF) {
+            mViewBinding.localLiveFl.setVisibility(View.GONE);
+            mViewBinding.localAnchorNameFl.setVisibility(View.VISIBLE);
+        } else if (camera == VideoChatUserInfo.CAMERA_STATUS_ON) {
+            mViewBinding.localLiveFl.setVisibility(View.VISIBLE);
+            mViewBinding.localAnchorNameFl.setVisibility(View.GONE);
+        }
+    }
+
+    /**
+     * The callback of seat lock status change, tracked for resumable reconnect.
+     * @param event Seat changed event, see SeatChangedEvent for details.
+     */
+    @Subscribe(threadMode = ThreadMode.MAIN)
+    public void onSeatChangedBroadcast(SeatChangedEvent event) {
+        mStateSync.onSeatStatusChanged(event.seatId, event.type);
+        syncMixedStream();
+    }
+
+    /**
+     * The callback of the first remote video frame, ends the hand over from the CDN player.
+     * @param event Remote first frame event, see RemoteFirstFrameEvent for details.
+     */
+    @Subscribe(threadMode = ThreadMode.MAIN)
+    public void onRemoteFirstFrameEvent(RemoteFirstFrameEvent event) {
+        if (mPlayback != null) {
+            mPlayback.onRtcFirstFrame(event.renderedAtMs);
+        }
+    }
+
+    /**
+     * The callback of the server side mixed stream starting or stopping in the room.
+     * @param event Mixed stream event, see MixedStreamEvent for details.
+     */
+    @Subscribe(threadMode = ThreadMode.MAIN)
+    public void onMixedStreamEvent(MixedStreamEvent event) {
+        Log.i(TAG, "onMixedStreamEvent uid:" + event.userId + ",published:" + event.published);
+        syncMixedStream();
+    }
+
+    /**
+     * Keep the server side mixed stream and the seat SEI in step with the seats. The host sends
+     * the layout, audiences off mic in a chat room watch the mix while it is published.
+     */
+    private void syncMixedStream() {
+        VideoChatUserInfo selfUserInfo = getSelfUserInfo();
+        VideoChatRoomInfo roomInfo = getRoomInfo();
+        if (selfUserInfo == null || roomInfo == null) {
+            return;
+        }
+        if (selfUserInfo.isHost()) {
+            syncSeatSei();
+            if (mMixedStreamController.isEnabled()) {
+                mMixedStreamController.onLayoutChanged(buildMixedStreamLayout());
+            }
+            return;
+        }
+        boolean watchMix = roomInfo.status == ROOM_STATUS_CHATTING
+                && selfUserInfo.userStatus != USER_STATUS_INTERACT
+                && (mPlayback == null || !mPlayback.isPlayerShown())
+                && VideoChatRTCManager.ins().useMixedStream(true);
+        if (!watchMix) {
+            VideoChatRTCManager.ins().useMixedStream(false);
+            mViewBinding.mixedStreamFl.removeAllViews();
+            mViewBinding.mixedStreamFl.setVisibility(View.GONE);
+            return;
+        }
+        TextureView renderView = VideoChatRTCManager.ins().getUserRenderView(
+                VideoChatRTCManager.ins().getMixedStreamUserId());
+        if (renderView.getParent() != mViewBinding.mixedStreamFl) {
+            Utils.removeFromParent(renderView);
+            mViewBinding.mixedStreamFl.removeAllViews();
+            mViewBinding.mixedStreamFl.addView(renderView, new FrameLayout.LayoutParams(
+                    ViewGroup.LayoutParams.MATCH_PARENT, ViewGroup.LayoutParams.MATCH_PARENT));
+        }
+        mViewBinding.mixedStreamFl.setVisibility(View.VISIBLE);
+    }
+
+    private static void cancelTask(@Nullable TickScheduler.Task task) {
+        if (task != null) {
+            task.cancel();
+        }
+    }
+
+    /**
+     * Put the seat state on the host's stream when it changed, repeated over a few frames.
+     */
+    private void syncSeatSei() {
+        byte[] payload = mSeatSeiWriter.update(mStateSync.getHostInfo(), mStateSync.getSeats());
+        if (payload == null) {
+            return;
+        }
+        VideoChatRTCManager.ins().sendSeatSei(payload, SEAT_SEI_REPEAT_COUNT);
+        // Restarted so the refresh comes a full interval after the repeated frames.
+        cancelTask(mSeatSeiRefresh);
+        mSeatSeiRefresh = TickScheduler.main().schedulePeriodic(SEAT_SEI_REFRESH_MS, mSeatSeiRefreshTask);
+    }
+
+    /**
+     * The callback of seat state SEI in the host's stream, from RTC or the CDN player. Applies
+     * lock, mic and camera changes when they show up in the video, ahead of the RTS notices,
+     * which then change nothing. New occupants still wait for the notice carrying the user info.
+     * @param event Seat SEI event, see SeatSeiEvent for details.
+     */
+    @Subscribe(threadMode = ThreadMode.MAIN)
+    public void onSeatSeiEvent(SeatSeiEvent event) {
+        VideoChatUserInfo selfUserInfo = getSelfUserInfo();
+        VideoChatUserInfo hostUserInfo = getHostUserInfo();
+        if (selfUserInfo == null || selfUserInfo.isHost() || hostUserInfo == null
+                || !TextUtils.equals(event.userId, hostUserInfo.userId)) {
+            return;
+        }
+        for (VideoChatSeatSei.Slot slot : mSeatSeiReader.onReceived(event.sei)) {
+            applySeatSei(slot, selfUserInfo.userId);
+        }
+    }
+
+    private void applySeatSei(VideoChatSeatSei.Slot slot, String selfUid) {
+        VideoChatSeatInfo seat = mStateSync.getSeats().get(slot.slot);
+        if (slot.slot != 0 && (seat == null ? slot.locked : seat.isLocked() != slot.locked)) {
+            SeatChangedEvent seatEvent = new SeatChangedEvent();
+            seatEvent.seatId = slot.slot;
+            seatEvent.type = slot.locked ? SEAT_STATUS_LOCKED : SEAT_STATUS_UNLOCKED;
+            onSeatChangedBroadcast(seatEvent);
+            if (mVideoChatFragment != null && mVideoChatFragment.isVisible()) {
+                mVideoChatFragment.onSeatChangedBroadcast(seatEvent);
+            }
+        }
+        VideoChatUserInfo user = slot.slot == 0 ? getHostUserInfo() : seat == null ? null : seat.userInfo;
+        if (user == null || TextUtils.isEmpty(slot.userId) || !TextUtils.equals(user.userId, slot.userId)
+                || TextUtils.equals(user.userId, selfUid)
+                || (user.isMicOn() == slot.mic && user.isCameraOn() == slot.camera)) {
+            return;
+        }
+        MediaChangedEvent mediaEvent = new MediaChangedEvent();
+        mediaEvent.mic = slot.mic ? VideoChatUserInfo.MIC_STATUS_ON : VideoChatUserInfo.MIC_STATUS_OFF;
+        mediaEvent.camera = slot.camera ? VideoChatUserInfo.CAMERA_STATUS_ON : VideoChatUserInfo.CAMERA_STATUS_OFF;
+        mediaEvent.userInfo = user.deepCopy();
+        mediaEvent.userInfo.mic = mediaEvent.mic;
+        mediaEvent.userInfo.camera = mediaEvent.camera;
+        onMediaChangedBroadcast(mediaEvent);
+    }
+
+    @NonNull
+    private VideoChatMixedStreamLayout buildMixedStreamLayout() {
+        return VideoChatMixedStreamLayout.build(getRoomInfo().roomId, mStateSync.getHostInfo(),
+                mStateSync.getSeats(), VideoChatMixedStreamLayout.DEFAULT_TILE_SIZE);
+    }
+
+    private IRequestCallback<VideoChatResponse> mixedStreamCallback(VideoChatMixedStreamController.Callback callback) {
+        return new IRequestCallback<VideoChatResponse>() {
+            @Override
+            public void onSuccess(VideoChatResponse data) {
+                callback.onResult(true);
+            }
+
+            @Override
+            public void onError(int errorCode, String message) {
+                Log.i(TAG, "mixed stream request onError errorCode:" + errorCode + ",message:" + message);
+                callback.onResult(false);
+            }
+        };
     }
 
     @Subscribe(threadMode = ThreadMode.MAIN)
@@ -962,22 +1469,31 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
                         public void onSuccess(ReplyAnchorsEvent data) {
                             Log.i(TAG, "onInviteAnchor replyAnchor onSuccess:" + data);
                             if (data == null || data.interactInfoList == null
-                                    || data.interactInfoList.size() == 0
-                                    || data.interactInfoList.get(0) == null) {
+                                    || data.interactInfoList.size() == 0) {
+                                return;
+                            }
+                            // Every anchor already in the PK, with a token to relay into each room.
+                            List<AnchorInfo> peerAnchors = new ArrayList<>();
+                            List<String> rtcTokens = new ArrayList<>();
+                            for (InteractInfo info : data.interactInfoList) {
+                                if (info == null) continue;
+                                AnchorInfo peerAnchor = new AnchorInfo();
+                                peerAnchor.roomId = info.roomId;
+                                peerAnchor.userId = info.userId;
+                                peerAnchor.userName = info.userName;
+                                peerAnchor.mic = info.mic;
+                                peerAnchor.camera = info.camera;
+                                peerAnchor.audioStatusThisRoom = 1;
+                                peerAnchors.add(peerAnchor);
+                                rtcTokens.add(info.token);
+                            }
+                            if (peerAnchors.isEmpty()) {
                                 return;
                             }
-                            InteractInfo info = data.interactInfoList.get(0);
-                            AnchorInfo peerAnchor = new AnchorInfo();
-                            peerAnchor.roomId = info.roomId;
-                            peerAnchor.userId = info.userId;
-                            peerAnchor.userName = info.userName;
-                            peerAnchor.mic = info.mic;
-                            peerAnchor.camera = info.camera;
-                            peerAnchor.audioStatusThisRoom = 1;
                             AnchorInfo localAnchor = new AnchorInfo();
                             localAnchor.mic = VideoChatRTCManager.ins().isMicOn() ? MicStatus.ON : MicStatus.OFF;
                             localAnchor.camera = VideoChatRTCManager.ins().isCameraOn() ? CameraStatus.ON : CameraStatus.OFF;
-                            startPk(peerAnchor, localAnchor, info.token);
+                            startPk(localAnchor, peerAnchors, rtcTokens);
                         }
 
                         @Override
@@ -986,7 +1502,7 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
                         }
                     });
             mOnInviteAnchorDialog.cancel();
-            mHandler.removeCallbacks(mCloseInviteAnchorDialogTask);
+            AppExecutors.mainHandler().removeCallbacks(mCloseInviteAnchorDialogTask);
         });
         mOnInviteAnchorDialog.setNegativeListener(v -> {
             VideoChatRTCManager.ins().getRTSClient().replyAnchor(
@@ -995,10 +1511,11 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
                     event.fromRoomId, event.fromUserId,
                     2, null);
             mOnInviteAnchorDialog.cancel();
-            mHandler.removeCallbacks(mCloseInviteAnchorDialogTask);
+            AppExecutors.mainHandler().removeCallbacks(mCloseInviteAnchorDialogTask);
         });
         mOnInviteAnchorDialog.show();
-        mHandler.postDelayed(mCloseInviteAnchorDialogTask, TimeUnit.SECONDS.toMillis(5));
+        AppExecutors.mainHandler().removeCallbacks(mCloseInviteAnchorDialogTask);
+        AppExecutors.mainHandler().postDelayed(mCloseInviteAnchorDialogTask, TimeUnit.SECONDS.toMillis(5));
     }
 
     /**
@@ -1018,10 +1535,7 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
             peerAnchor.userName = event.toUserName;
             peerAnchor.mic = event.interactInfo.mic;
             peerAnchor.camera = event.interactInfo.camera;
-            AnchorInfo localAnchor = new AnchorInfo();
-            localAnchor.mic = VideoChatRTCManager.ins().isMicOn() ? MicStatus.ON : MicStatus.OFF;
-            localAnchor.camera = VideoChatRTCManager.ins().isCameraOn() ? CameraStatus.ON : CameraStatus.OFF;
-            startPk(peerAnchor, localAnchor, event.interactInfo.token);
+            addPkAnchor(peerAnchor, event.interactInfo.token);
         }
     }
 
@@ -1082,7 +1596,8 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
      */
     @Subscribe(threadMode = ThreadMode.MAIN)
     public void onOnNewAnchorJoin(VideoChatUserInfo event) {
-        if (getSelfUserInfo() != null && getSelfUserInfo().isHost()) {
+        // Anchors start their own PK from the invite reply, later anchors join the running one.
+        if (getSelfUserInfo() != null && getSelfUserInfo().isHost() && mVideoPkFragment == null) {
             return;
         }
         Log.i(TAG, "onOnNewAnchorJoin event:" + event);
@@ -1092,31 +1607,67 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         peerAnchor.userName = event.userName;
         peerAnchor.mic = event.mic;
         peerAnchor.camera = event.camera;
+        addPkAnchor(peerAnchor, null);
+    }
+
+    /**
+     * Add an anchor to the running pk, or start a pk with it.
+     * @param peerAnchor Peer anchor information, see AnchorInfo for details.
+     * @param rtcToken Token to relay into the peer anchor room, null to fetch it when needed.
+     */
+    private void addPkAnchor(AnchorInfo peerAnchor, @Nullable String rtcToken) {
+        if (mVideoPkFragment != null) {
+            mVideoPkFragment.addAnchor(peerAnchor, rtcToken);
+            return;
+        }
         AnchorInfo localAnchor = new AnchorInfo();
-        localAnchor.mic = getHostUserInfo().mic;
-        localAnchor.camera = getHostUserInfo().camera;
-        startPk(peerAnchor, localAnchor, null);
+        if (getSelfUserInfo() != null && getSelfUserInfo().isHost()) {
+            localAnchor.mic = VideoChatRTCManager.ins().isMicOn() ? MicStatus.ON : MicStatus.OFF;
+            localAnchor.camera = VideoChatRTCManager.ins().isCameraOn() ? CameraStatus.ON : CameraStatus.OFF;
+        } else {
+            localAnchor.mic = getHostUserInfo().mic;
+            localAnchor.camera = getHostUserInfo().camera;
+        }
+        startPk(localAnchor, Collections.singletonList(peerAnchor), Collections.singletonList(rtcToken));
     }
 
     /**
      * Start pk.
-     * @param peerAnchor Peer anchor information, see AnchorInfo for details.
      * @param localAnchor Local anchor information, see AnchorInfo for details.
-     * @param rtcToken rtc token.
+     * @param peerAnchors Other anchors in the pk, see AnchorInfo for details.
+     * @param rtcTokens Token to relay into each peer anchor room, null to fetch them when needed.
      */
-    private void startPk(AnchorInfo peerAnchor, AnchorInfo localAnchor, String rtcToken) {
+    private void startPk(AnchorInfo localAnchor, List<AnchorInfo> peerAnchors, @Nullable List<String> rtcTokens) {
         getRoomInfo().status = ROOM_STATUS_PK_ING;
         mIsFinishAnchorLinkBySelf = false;
         mViewBinding.videoChatMainBottomOption.updateUIByRoleAndStatus(ROOM_STATUS_PK_ING, getSelfUserInfo().userRole, getSelfUserInfo().userStatus);
         mVideoPkFragment = new VideoAnchorPkFragment();
+        int count = peerAnchors.size();
+        String[] roomIds = new String[count];
+        String[] userIds = new String[count];
+        String[] userNames = new String[count];
+        String[] tokens = new String[count];
+        boolean[] muted = new boolean[count];
+        boolean[] micOn = new boolean[count];
+        boolean[] cameraOn = new boolean[count];
+        for (int i = 0; i < count; i++) {
+            AnchorInfo peerAnchor = peerAnchors.get(i);
+            roomIds[i] = peerAnchor.roomId;
+            userIds[i] = peerAnchor.userId;
+            userNames[i] = peerAnchor.userName;
+            tokens[i] = rtcTokens != null && i < rtcTokens.size() ? rtcTokens.get(i) : null;
+            muted[i] = peerAnchor.audioStatusThisRoom == 0;
+            micOn[i] = peerAnchor.mic == 1;
+            cameraOn[i] = peerAnchor.camera == 1;
+        }
         Bundle args = new Bundle();
-        args.putString(VideoAnchorPkFragment.KEY_PEER_ROOM_ID, peerAnchor.roomId);
-        args.putString(VideoAnchorPkFragment.KEY_PEER_USER_ID, peerAnchor.userId);
-        args.putString(VideoAnchorPkFragment.KEY_PEER_USER_NAME, peerAnchor.userName);
-        args.putString(VideoAnchorPkFragment.KEY_RTC_TOKEN, rtcToken);
-        args.putBoolean(VideoAnchorPkFragment.KEY_PEER_ANCHOR_MUTED, peerAnchor.audioStatusThisRoom == 0);
-        args.putBoolean(VideoAnchorPkFragment.KEY_PEER_ANCHOR_MIC_ON, peerAnchor.mic == 1);
-        args.putBoolean(VideoAnchorPkFragment.KEY_PEER_ANCHOR_CAMERA_ON, peerAnchor.camera == 1);
+        args.putStringArray(VideoAnchorPkFragment.KEY_PEER_ROOM_IDS, roomIds);
+        args.putStringArray(VideoAnchorPkFragment.KEY_PEER_USER_IDS, userIds);
+        args.putStringArray(VideoAnchorPkFragment.KEY_PEER_USER_NAMES, userNames);
+        args.putStringArray(VideoAnchorPkFragment.KEY_PEER_RTC_TOKENS, tokens);
+        args.putBooleanArray(VideoAnchorPkFragment.KEY_PEER_ANCHORS_MUTED, muted);
+        args.putBooleanArray(VideoAnchorPkFragment.KEY_PEER_ANCHORS_MIC_ON, micOn);
+        args.putBooleanArray(VideoAnchorPkFragment.KEY_PEER_ANCHORS_CAMERA_ON, cameraOn);
         args.putBoolean(VideoAnchorPkFragment.KEY_LOCAL_ANCHOR_MIC_ON, localAnchor.mic == 1);
         args.putBoolean(VideoAnchorPkFragment.KEY_LOCAL_ANCHOR_CAMERA_ON, localAnchor.camera == 1);
         mVideoPkFragment.setArguments(args);
@@ -1131,11 +1682,8 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
     public static void openFromList(Activity activity, VideoChatRoomInfo roomInfo) {
         Intent intent = new Intent(activity, VideoChatRoomMainActivity.class);
         intent.putExtra(REFER_KEY, REFER_FROM_LIST);
-        intent.putExtra(REFER_EXTRA_ROOM, GsonUtils.gson().toJson(roomInfo));
-        VideoChatUserInfo userInfo = new VideoChatUserInfo();
-        userInfo.userId = SolutionDataManager.ins().getUserId();
-        userInfo.userName = SolutionDataManager.ins().getUserName();
-        intent.putExtra(REFER_EXTRA_USER, GsonUtils.gson().toJson(userInfo));
+        intent.putExtra(REFER_EXTRA_ROOM_ID, roomInfo.roomId);
+        VideoChatRoomSessions.ins().traceOpen(SystemClock.elapsedRealtime());
         activity.startActivity(intent);
     }
 
@@ -1148,7 +1696,8 @@ public class VideoChatRoomMainActivity extends SolutionBaseActivity {
         response.roomInfo = roomInfo;
         response.rtcToken = rtcToken;
         response.audienceCount = 0;
-        intent.putExtra(REFER_EXTRA_CREATE_JSON, GsonUtils.gson().toJson(response));
+        intent.putExtra(REFER_EXTRA_CREATE_SESSION, VideoChatRoomSessions.ins().put(response));
+        VideoChatRoomSessions.ins().traceOpen(SystemClock.elapsedRealtime());
         activity.startActivity(intent);
     }
 
@@ -3,9 +3,6 @@
 
 package com.volcengine.vertcdemo.videochat.feature.roommain;
 
-import static com.volcengine.vertcdemo.videochat.core.VideoChatDataManager.SEAT_STATUS_LOCKED;
-import static com.volcengine.vertcdemo.videochat.core.VideoChatDataManager.SEAT_STATUS_UNLOCKED;
-
 import android.content.Context;
 import android.graphics.drawable.Drawable;
 import android.text.TextUtils;
@@ -29,9 +26,9 @@ import com.volcengine.vertcdemo.utils.AppUtil;
 import com.volcengine.vertcdemo.utils.Utils;
 import com.volcengine.vertcdemo.videochat.R;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
-import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
 import com.volcengine.vertcdemo.videochat.core.VideoChatDataManager;
 import com.volcengine.vertcdemo.videochat.core.VideoChatRTCManager;
+import com.volcengine.vertcdemo.videochat.core.VideoChatSeat;
 import com.volcengine.vertcdemo.videochat.databinding.LayoutVideoChatSeatBinding;
 import com.volcengine.vertcdemo.videochat.event.SDKNetStatusEvent;
 
@@ -39,11 +36,14 @@ import org.greenrobot.eventbus.Subscribe;
 import org.greenrobot.eventbus.ThreadMode;
 
 /**
- * 单个座位控件
+ * 单个座位控件，绑定不可变的 VideoChatSeat，同一对象重复绑定不做任何事
  */
 public class VideoChatSeatLayout extends ConstraintLayout {
 
-    private final VideoChatSeatInfo mSeatInfo = new VideoChatSeatInfo();
+    private int mIndex = -1;
+    // Last bound seat, compared by identity.
+    @Nullable
+    private VideoChatSeat mSeat;
 
     private LayoutVideoChatSeatBinding mViewBinding;
 
@@ -65,22 +65,33 @@ public class VideoChatSeatLayout extends ConstraintLayout {
     private void initView() {
         View view = View.inflate(getContext(), R.layout.layout_video_chat_seat, this);
         mViewBinding = LayoutVideoChatSeatBinding.bind(view);
-        bind(null);
+        bind(VideoChatSeat.EMPTY);
     }
 
     public void setIndex(int index) {
-        mSeatInfo.seatIndex = index;
+        mIndex = index;
     }
 
     public int getIndex() {
-        return mSeatInfo.seatIndex;
+        return mIndex;
     }
 
-    public void bind(@Nullable VideoChatSeatInfo info) {
-        mSeatInfo.status = info == null ? SEAT_STATUS_UNLOCKED : info.status;
-        mSeatInfo.userInfo = info == null ? null : info.userInfo == null ? null : info.userInfo.deepCopy();
-        updateLockedStatus(mSeatInfo.isLocked());
-        if (mSeatInfo.userInfo == null || mSeatInfo.isLocked()) {
+    public void bind(@NonNull VideoChatSeat seat) {
+        VideoChatSeat last = mSeat;
+        if (seat == last) {
+            return;
+        }
+        mSeat = seat;
+        if (last != null && last.sameOccupant(seat) && last.isLocked() == seat.isLocked()) {
+            // Same occupant, only mic or camera changed.
+            updateMicIcon(seat.isMicOn());
+            if (last.isCameraOn() != seat.isCameraOn()) {
+                onUserCameraStateUpdated(seat.userId, seat.isCameraOn());
+            }
+            return;
+        }
+        updateLockedStatus(seat.isLocked());
+        if (seat.isEmpty() || seat.isLocked()) {
             mViewBinding.videoChatSeatNetworkTv.setVisibility(GONE);
             mViewBinding.videoChatSeatVideoContainer.removeAllViews();
             mViewBinding.videoChatSeatCameraOffTv.setVisibility(GONE);
@@ -92,32 +103,29 @@ public class VideoChatSeatLayout extends ConstraintLayout {
         } else {
             mViewBinding.videoChatSeatEmpty.setVisibility(GONE);
             mViewBinding.videoChatSeatNetworkTv.setVisibility(VISIBLE);
-            mViewBinding.videoChatSeatCameraOffTv.setText(mSeatInfo.userInfo.userName.substring(0, 1));
+            mViewBinding.videoChatSeatCameraOffTv.setText(seat.userName.substring(0, 1));
             mViewBinding.videoChatMainRoomBottomCover.setVisibility(VISIBLE);
             mViewBinding.videoChatMainRoomNameIv.setVisibility(VISIBLE);
-            mViewBinding.videoChatMainRoomNameIv.setText(mSeatInfo.userInfo.userName);
-            if (mSeatInfo.userInfo.isHost()) {
-                mViewBinding.videoChatMainRoomHostIv.setVisibility(VISIBLE);
-            }
-            if (mSeatInfo.userInfo.isMicOn()) {
-                mViewBinding.videoChatMainRoomMicOffIv.setVisibility(GONE);
-            } else {
-                mViewBinding.videoChatMainRoomMicOffIv.setVisibility(VISIBLE);
-            }
-            onUserCameraStateUpdated(mSeatInfo.userInfo.userId, mSeatInfo.userInfo.userName, mSeatInfo.userInfo.isCameraOn());
+            mViewBinding.videoChatMainRoomNameIv.setText(seat.userName);
+            mViewBinding.videoChatMainRoomHostIv.setVisibility(seat.isHost() ? VISIBLE : GONE);
+            updateMicIcon(seat.isMicOn());
+            onUserCameraStateUpdated(seat.userId, seat.isCameraOn());
         }
     }
 
-    public void updateLockedStatus(boolean isLocked) {
+    private void updateLockedStatus(boolean isLocked) {
         if (isLocked) {
             mViewBinding.videoChatSeatEmptyIv.setImageResource(R.drawable.video_chat_room_main_seat_locked);
         } else {
             mViewBinding.videoChatSeatEmptyIv.setImageResource(R.drawable.video_chat_room_main_seat_empty);
         }
-        mSeatInfo.status = isLocked ? SEAT_STATUS_LOCKED : SEAT_STATUS_UNLOCKED;
     }
 
-    private void onUserCameraStateUpdated(String userID, String userName, boolean cameraOn) {
+    private void updateMicIcon(boolean micOn) {
+        mViewBinding.videoChatMainRoomMicOffIv.setVisibility(micOn ? GONE : VISIBLE);
+    }
+
+    private void onUserCameraStateUpdated(String userID, boolean cameraOn) {
         if (cameraOn) {
             FrameLayout.LayoutParams params = new FrameLayout.LayoutParams(ViewGroup.LayoutParams.MATCH_PARENT, ViewGroup.LayoutParams.MATCH_PARENT);
             TextureView renderView = VideoChatRTCManager.ins().getUserRenderView(userID);
@@ -140,34 +148,19 @@ public class VideoChatSeatLayout extends ConstraintLayout {
         }
     }
 
-    public void updateMicStatus(String userId, boolean micOn, boolean cameraOn) {
-        if (mSeatInfo.userInfo != null && TextUtils.equals(mSeatInfo.userInfo.userId, userId)) {
-            mSeatInfo.userInfo.mic = micOn ? VideoChatUserInfo.MIC_STATUS_ON : VideoChatUserInfo.MIC_STATUS_OFF;
-            if (mSeatInfo.userInfo.isMicOn()) {
-                mViewBinding.videoChatMainRoomMicOffIv.setVisibility(GONE);
-            } else {
-                mViewBinding.videoChatMainRoomMicOffIv.setVisibility(VISIBLE);
-            }
-            if (mSeatInfo.userInfo.isCameraOn() != cameraOn) {
-                mSeatInfo.userInfo.camera = cameraOn ? VideoChatUserInfo.CAMERA_STATUS_ON : VideoChatUserInfo.CAMERA_STATUS_OFF;
-                onUserCameraStateUpdated(mSeatInfo.userInfo.userId, mSeatInfo.userInfo.userName, cameraOn);
-            }
-        }
-    }
-
     private void updateVolumeStatus(int volume, boolean forceUpdate) {
     }
 
     public void updateVolumeStatus(String userId, int volume) {
-        if (mSeatInfo.userInfo != null && TextUtils.equals(mSeatInfo.userInfo.userId, userId)) {
+        if (mSeat != null && !mSeat.isEmpty() && TextUtils.equals(mSeat.userId, userId)) {
             updateVolumeStatus(volume, false);
         }
     }
 
     public void setSeatClick(IAction<VideoChatSeatInfo> action) {
         setOnClickListener((v) -> {
-            if (action != null && mSeatInfo != null) {
-                action.act(mSeatInfo);
+            if (action != null && mSeat != null) {
+                action.act(mSeat.toSeatInfo(mIndex));
             }
         });
     }
@@ -188,7 +181,7 @@ public class VideoChatSeatLayout extends ConstraintLayout {
     @Subscribe(threadMode = ThreadMode.MAIN)
     public void updateNetQuality(SDKNetStatusEvent event) {
         int visibility = mViewBinding.videoChatSeatNetworkTv.getVisibility();
-        if (visibility == View.VISIBLE && TextUtils.equals(event.uid, mSeatInfo.userInfo.userId)) {
+        if (visibility == View.VISIBLE && mSeat != null && TextUtils.equals(event.uid, mSeat.userId)) {
             updateNetStatus(mViewBinding.videoChatSeatNetworkTv, event.networkQuality);
         }
     }
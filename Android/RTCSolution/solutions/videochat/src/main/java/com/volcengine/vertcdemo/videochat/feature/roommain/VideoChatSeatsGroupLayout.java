@@ -3,8 +3,6 @@
 
 package com.volcengine.vertcdemo.videochat.feature.roommain;
 
-import static com.volcengine.vertcdemo.videochat.core.VideoChatDataManager.SEAT_STATUS_LOCKED;
-
 import android.content.Context;
 import android.util.AttributeSet;
 import android.view.View;
@@ -18,18 +16,20 @@ import com.volcengine.vertcdemo.videochat.R;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
 import com.volcengine.vertcdemo.videochat.core.VideoChatDataManager;
+import com.volcengine.vertcdemo.videochat.core.VideoChatSeatTable;
 import com.volcengine.vertcdemo.videochat.databinding.LayoutVideoChatSeatGroupBinding;
 
-import java.util.ArrayList;
-import java.util.List;
 import java.util.Map;
 
 /**
- * 多个座位集合控件
+ * 多个座位集合控件，座位状态存放在 VideoChatSeatTable 中，按座位号直接寻址
  */
 public class VideoChatSeatsGroupLayout extends ConstraintLayout {
 
-    private final List<VideoChatSeatLayout> mSeatInfoList = new ArrayList<>();
+    private final VideoChatSeatLayout[] mSeatLayouts = new VideoChatSeatLayout[VideoChatSeatTable.SEAT_COUNT];
+    private final VideoChatSeatTable mSeatTable = new VideoChatSeatTable();
+    // Table version the seat views were last bound to.
+    private long mBoundVersion = -1;
 
     public VideoChatSeatsGroupLayout(@NonNull Context context) {
         super(context);
@@ -50,25 +50,22 @@ public class VideoChatSeatsGroupLayout extends ConstraintLayout {
         View view = View.inflate(getContext(), R.layout.layout_video_chat_seat_group, this);
         LayoutVideoChatSeatGroupBinding viewBinding = LayoutVideoChatSeatGroupBinding.bind(view);
 
-        mSeatInfoList.add(viewBinding.videoGroupSeat1);
-        mSeatInfoList.add(viewBinding.videoGroupSeat2);
-        mSeatInfoList.add(viewBinding.videoGroupSeat3);
-        mSeatInfoList.add(viewBinding.videoGroupSeat4);
-        mSeatInfoList.add(viewBinding.videoGroupSeat5);
-        mSeatInfoList.add(viewBinding.videoGroupSeat6);
-
-        for (int i = 0; i < mSeatInfoList.size(); i++) {
-            VideoChatSeatLayout layout = mSeatInfoList.get(i);
-            layout.setIndex(i);
-            layout.bind(null);
+        mSeatLayouts[0] = viewBinding.videoGroupSeat1;
+        mSeatLayouts[1] = viewBinding.videoGroupSeat2;
+        mSeatLayouts[2] = viewBinding.videoGroupSeat3;
+        mSeatLayouts[3] = viewBinding.videoGroupSeat4;
+        mSeatLayouts[4] = viewBinding.videoGroupSeat5;
+        mSeatLayouts[5] = viewBinding.videoGroupSeat6;
+
+        for (int i = 0; i < mSeatLayouts.length; i++) {
+            mSeatLayouts[i].setIndex(i);
         }
+        bindChangedSeats();
     }
 
     public void bindHostInfo(VideoChatUserInfo userInfo) {
-        VideoChatSeatInfo info = new VideoChatSeatInfo();
-        info.userInfo = userInfo;
-        info.status = VideoChatDataManager.SEAT_STATUS_UNLOCKED;
-        mSeatInfoList.get(0).bind(info);
+        mSeatTable.setUser(0, userInfo);
+        bindChangedSeats();
     }
 
     public void bindSeatInfo(Map<Integer, VideoChatSeatInfo> map) {
@@ -76,43 +73,59 @@ public class VideoChatSeatsGroupLayout extends ConstraintLayout {
             return;
         }
         for (Map.Entry<Integer, VideoChatSeatInfo> seatInfoEntry : map.entrySet()) {
-            bindSeatInfo(seatInfoEntry.getKey(), seatInfoEntry.getValue());
+            mSeatTable.setSeat(seatInfoEntry.getKey(), seatInfoEntry.getValue());
         }
+        bindChangedSeats();
     }
 
     public void bindSeatInfo(int seatId, VideoChatSeatInfo seatInfo) {
-        for (VideoChatSeatLayout layout : mSeatInfoList) {
-            if (layout.getIndex() == seatId) {
-                layout.bind(seatInfo);
-                break;
-            }
-        }
+        mSeatTable.setSeat(seatId, seatInfo);
+        bindChangedSeats();
+    }
+
+    /**
+     * Someone sat down on the seat or left it.
+     * @param userInfo null when the seat is left
+     */
+    public void bindSeatUser(int seatId, @Nullable VideoChatUserInfo userInfo) {
+        mSeatTable.setUser(seatId, userInfo);
+        bindChangedSeats();
     }
 
     public void updateUserMediaStatus(String userId, boolean micOn, boolean cameraOn) {
-        for (VideoChatSeatLayout layout : mSeatInfoList) {
-            layout.updateMicStatus(userId, micOn, cameraOn);
-        }
+        mSeatTable.setMedia(userId, micOn, cameraOn);
+        bindChangedSeats();
     }
 
     public void onUserSpeaker(String userId, int volume) {
-        for (VideoChatSeatLayout layout : mSeatInfoList) {
-            layout.updateVolumeStatus(userId, volume);
+        int seatId = mSeatTable.indexOf(userId);
+        if (seatId >= 0) {
+            mSeatLayouts[seatId].updateVolumeStatus(userId, volume);
         }
     }
 
     public void setSeatClick(IAction<VideoChatSeatInfo> action) {
-        for (VideoChatSeatLayout layout : mSeatInfoList) {
+        for (VideoChatSeatLayout layout : mSeatLayouts) {
             layout.setSeatClick(action);
         }
     }
 
     public void updateSeatStatus(int seatId, @VideoChatDataManager.SeatStatus int seatStatus) {
-        for (VideoChatSeatLayout layout : mSeatInfoList) {
-            if (layout.getIndex() == seatId) {
-                layout.updateLockedStatus(seatStatus == SEAT_STATUS_LOCKED);
-                break;
-            }
+        mSeatTable.setStatus(seatId, seatStatus);
+        bindChangedSeats();
+    }
+
+    /**
+     * Rebind after the table changed; views whose seat is the same object skip the bind.
+     */
+    private void bindChangedSeats() {
+        long version = mSeatTable.getVersion();
+        if (version == mBoundVersion) {
+            return;
+        }
+        mBoundVersion = version;
+        for (int i = 0; i < mSeatLayouts.length; i++) {
+            mSeatLayouts[i].bind(mSeatTable.get(i));
         }
     }
-}
\ No newline at end of file
+}
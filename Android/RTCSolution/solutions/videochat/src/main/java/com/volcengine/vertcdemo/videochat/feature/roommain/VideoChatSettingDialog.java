@@ -35,11 +35,14 @@ public class VideoChatSettingDialog extends BaseDialog {
 
     private final String mRoomId;
     private final IAction<Object> mBgmBtnAction;
+    private final IAction<Boolean> mMixedStreamAction;
 
-    public VideoChatSettingDialog(@NonNull Context context, String roomId, IAction<Object> bgmBtnAction) {
+    public VideoChatSettingDialog(@NonNull Context context, String roomId, IAction<Object> bgmBtnAction,
+                                  IAction<Boolean> mixedStreamAction) {
         super(context);
         this.mRoomId = roomId;
         this.mBgmBtnAction = bgmBtnAction;
+        this.mMixedStreamAction = mixedStreamAction;
     }
 
     @Override
@@ -62,7 +65,11 @@ public class VideoChatSettingDialog extends BaseDialog {
             boolean isHost = TextUtils.equals(selfUid, hostUid);
             mViewBinding.bgmIv.setVisibility(isHost ? View.VISIBLE : View.GONE);
             mViewBinding.bgmTv.setVisibility(isHost ? View.VISIBLE : View.GONE);
+            mViewBinding.mixedStreamTv.setVisibility(isHost ? View.VISIBLE : View.GONE);
+            mViewBinding.mixedStreamSwitch.setVisibility(isHost ? View.VISIBLE : View.GONE);
         }
+        mViewBinding.mixedStreamSwitch.setChecked(VideoChatDataManager.ins().isMixedStreamEnabled());
+        mViewBinding.mixedStreamSwitch.setOnCheckedChangeListener((v, checked) -> onMixedStreamSwitchChanged(checked));
         mViewBinding.micIv.setOnClickListener(v -> onClickMic());
         mViewBinding.cameraIv.setOnClickListener(v -> onClickCamera());
         mViewBinding.switchCameraIv.setOnClickListener(v -> onClickSwitchCamera());
@@ -94,6 +101,13 @@ public class VideoChatSettingDialog extends BaseDialog {
         cancel();
     }
 
+    private void onMixedStreamSwitchChanged(boolean isChecked) {
+        VideoChatDataManager.ins().setMixedStreamEnabled(isChecked);
+        if (mMixedStreamAction != null) {
+            mMixedStreamAction.act(isChecked);
+        }
+    }
+
     private void onClickSwitchCamera() {
         VideoChatRTCManager.ins().switchCamera();
         cancel();
@@ -20,7 +20,6 @@ import androidx.annotation.Nullable;
 import androidx.core.content.ContextCompat;
 import androidx.fragment.app.Fragment;
 
-import com.ss.bytertc.engine.data.ForwardStreamInfo;
 import com.ss.bytertc.engine.type.NetworkQuality;
 import com.volcengine.vertcdemo.common.SolutionToast;
 import com.volcengine.vertcdemo.core.eventbus.SolutionDemoEventManager;
@@ -28,51 +27,74 @@ import com.volcengine.vertcdemo.core.net.IRequestCallback;
 import com.volcengine.vertcdemo.utils.AppUtil;
 import com.volcengine.vertcdemo.utils.Utils;
 import com.volcengine.vertcdemo.videochat.R;
+import com.volcengine.vertcdemo.videochat.bean.AnchorInfo;
 import com.volcengine.vertcdemo.videochat.bean.ManageOtherAnchorEvent;
 import com.volcengine.vertcdemo.videochat.bean.MediaChangedEvent;
 import com.volcengine.vertcdemo.videochat.bean.UserJoinedEvent;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatResponse;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
 import com.volcengine.vertcdemo.videochat.core.VideoChatDataManager;
+import com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager;
+import com.volcengine.vertcdemo.videochat.core.VideoChatPkTopology;
 import com.volcengine.vertcdemo.videochat.core.VideoChatRTCManager;
+import com.volcengine.vertcdemo.videochat.event.ForwardStreamStateEvent;
 import com.volcengine.vertcdemo.videochat.event.SDKNetStatusEvent;
+import com.volcengine.vertcdemo.videochat.feature.roommain.VideoChatPkTilesLayout;
 
 import org.greenrobot.eventbus.Subscribe;
 import org.greenrobot.eventbus.ThreadMode;
 
+import java.util.ArrayList;
+import java.util.LinkedHashMap;
+import java.util.List;
+
+/**
+ * PK of this room's anchor with up to {@link VideoChatPkTopology#MAX_ANCHORS} - 1 peer anchors.
+ * Relays follow {@link VideoChatPkTopology}, every anchor seen in this room gets a tile.
+ */
 public class VideoAnchorPkFragment extends Fragment {
     private static final String TAG = "VideoAnchorPkFragment";
 
-    public static final String KEY_RTC_TOKEN = "rtc_token";
-    public static final String KEY_PEER_ROOM_ID = "peer_room_id";
-    public static final String KEY_PEER_USER_ID = "peer_user_id";
-    public static final String KEY_PEER_USER_NAME = "peer_user_name";
-    public static final String KEY_PEER_ANCHOR_MUTED = "peer_anchor_muted";
-    public static final String KEY_PEER_ANCHOR_MIC_ON = "peer_anchor_mic_on";
-    public static final String KEY_PEER_ANCHOR_CAMERA_ON = "peer_anchor_camera_on";
+    /*** Parallel arrays, one entry per peer anchor */
+    public static final String KEY_PEER_ROOM_IDS = "peer_room_ids";
+    public static final String KEY_PEER_USER_IDS = "peer_user_ids";
+    public static final String KEY_PEER_USER_NAMES = "peer_user_names";
+    public static final String KEY_PEER_RTC_TOKENS = "peer_rtc_tokens";
+    public static final String KEY_PEER_ANCHORS_MUTED = "peer_anchors_muted";
+    public static final String KEY_PEER_ANCHORS_MIC_ON = "peer_anchors_mic_on";
+    public static final String KEY_PEER_ANCHORS_CAMERA_ON = "peer_anchors_camera_on";
     public static final String KEY_LOCAL_ANCHOR_MIC_ON = "local_anchor_mic_on";
     public static final String KEY_LOCAL_ANCHOR_CAMERA_ON = "local_anchor_camera_on";
 
-    private FrameLayout mLocalVideoContainer;
-    private FrameLayout mRemoteVideoContainer;
-    private TextView mLocalStatusTv;
-    private TextView mRemoteStatusTv;
-    private TextView mLocalNameTv;
-    private TextView mRemoteNameTv;
-    private ImageView mMuteRemoteIv;
-
-    private String mPeerRoomId;
-    private String mPeerUid;
-    private String mPeerUname;
+    /**
+     * An anchor of the PK and its tile, the tile views are null while it is not shown.
+     */
+    private static class PkAnchor {
+        String roomId;
+        String userId;
+        String userName;
+        // Relay token into this room, handed to the forward stream manager once.
+        String rtcToken;
+        boolean local;
+        boolean muted;
+        boolean micOn;
+        boolean cameraOn;
+        boolean muting;
+        boolean selfMuting;
+
+        View tile;
+        FrameLayout videoContainer;
+        TextView statusTv;
+        TextView nameTv;
+        ImageView muteIv;
+    }
 
-    private boolean mPeerAnchorMuted;
-    private boolean mPeerAnchorCameraOn;
-    private boolean mPeerAnchorMicOn;
-    private boolean mLocalAnchorCameraOn;
-    private boolean mLocalAnchorMicOn;
+    private VideoChatPkTilesLayout mTilesLayout;
 
-    private boolean mMutingPeerAnchor;
-    private boolean mSelfMutePeerAnchor;
+    // Keyed by room id, the local anchor first.
+    private final LinkedHashMap<String, PkAnchor> mAnchors = new LinkedHashMap<>();
+    private VideoChatPkTopology mTopology = VideoChatPkTopology.plan(new ArrayList<>());
+    private final List<String> mRelayedRoomIds = new ArrayList<>();
 
     public VideoAnchorPkFragment() {
         super();
@@ -83,39 +105,126 @@ public class VideoAnchorPkFragment extends Fragment {
         super.onCreate(savedInstanceState);
         SolutionDemoEventManager.register(this);
         Bundle args = getArguments();
-        String rtcToken = null;
+        PkAnchor local = new PkAnchor();
+        local.local = true;
+        local.roomId = getLocalRoomId();
+        local.userId = getHostUserInfo() == null ? null : getHostUserInfo().userId;
+        local.userName = getLocalUserName();
         if (args != null) {
-            mPeerRoomId = args.getString(KEY_PEER_ROOM_ID);
-            mPeerUid = args.getString(KEY_PEER_USER_ID);
-            mPeerUname = args.getString(KEY_PEER_USER_NAME);
-            rtcToken = args.getString(KEY_RTC_TOKEN);
-            mPeerAnchorMuted = args.getBoolean(KEY_PEER_ANCHOR_MUTED);
-            mPeerAnchorCameraOn = args.getBoolean(KEY_PEER_ANCHOR_CAMERA_ON);
-            mPeerAnchorMicOn = args.getBoolean(KEY_PEER_ANCHOR_MIC_ON);
-            mLocalAnchorCameraOn = args.getBoolean(KEY_LOCAL_ANCHOR_CAMERA_ON);
-            mLocalAnchorMicOn = args.getBoolean(KEY_LOCAL_ANCHOR_MIC_ON);
+            local.micOn = args.getBoolean(KEY_LOCAL_ANCHOR_MIC_ON);
+            local.cameraOn = args.getBoolean(KEY_LOCAL_ANCHOR_CAMERA_ON);
+        }
+        // Anchors added before the fragment was created go after the local one.
+        LinkedHashMap<String, PkAnchor> added = new LinkedHashMap<>(mAnchors);
+        mAnchors.clear();
+        mAnchors.put(local.roomId, local);
+        mAnchors.putAll(added);
+        if (args != null) {
+            String[] roomIds = args.getStringArray(KEY_PEER_ROOM_IDS);
+            String[] userIds = args.getStringArray(KEY_PEER_USER_IDS);
+            String[] userNames = args.getStringArray(KEY_PEER_USER_NAMES);
+            String[] rtcTokens = args.getStringArray(KEY_PEER_RTC_TOKENS);
+            boolean[] muted = args.getBooleanArray(KEY_PEER_ANCHORS_MUTED);
+            boolean[] micOn = args.getBooleanArray(KEY_PEER_ANCHORS_MIC_ON);
+            boolean[] cameraOn = args.getBooleanArray(KEY_PEER_ANCHORS_CAMERA_ON);
+            int count = roomIds == null ? 0 : roomIds.length;
+            for (int i = 0; i < count; i++) {
+                putPeer(roomIds[i], item(userIds, i), item(userNames, i), item(rtcTokens, i),
+                        item(muted, i), item(micOn, i), item(cameraOn, i));
+            }
         }
-        startForwardStream(rtcToken, mPeerRoomId);
+        updateTopology();
     }
 
-    private void startForwardStream(String rtcToken, String peerRoomId) {
-        if (!getSelfUserInfo().isHost()) {
+    /**
+     * Another anchor joined the PK, or an anchor already in it came with a new relay token.
+     * @param rtcToken Token to relay into the anchor's room, null to fetch it when needed.
+     */
+    public void addAnchor(@NonNull AnchorInfo anchor, @Nullable String rtcToken) {
+        Log.i(TAG, "addAnchor anchor:" + anchor);
+        putPeer(anchor.roomId, anchor.userId, anchor.userName, rtcToken,
+                anchor.audioStatusThisRoom == 0, anchor.mic == 1, anchor.camera == 1);
+        updateTopology();
+    }
+
+    /**
+     * @return anchors in the PK, the local one included
+     */
+    public int getAnchorCount() {
+        return mAnchors.size();
+    }
+
+    private void putPeer(String roomId, String userId, String userName, String rtcToken,
+                         boolean muted, boolean micOn, boolean cameraOn) {
+        if (TextUtils.isEmpty(roomId) || TextUtils.equals(roomId, getLocalRoomId())) {
+            return;
+        }
+        PkAnchor anchor = mAnchors.get(roomId);
+        if (anchor != null) {
+            if (!TextUtils.isEmpty(rtcToken)) {
+                anchor.rtcToken = rtcToken;
+            }
             return;
         }
-        if (!VideoChatRTCManager.ins().isTest && TextUtils.isEmpty(rtcToken)) {
+        int anchors = mAnchors.size() + (mAnchors.containsKey(getLocalRoomId()) ? 0 : 1);
+        if (anchors >= VideoChatPkTopology.MAX_ANCHORS) {
+            Log.i(TAG, "putPeer too many anchors, drop roomId:" + roomId);
             return;
         }
-        if (TextUtils.isEmpty(peerRoomId)) {
+        anchor = new PkAnchor();
+        anchor.roomId = roomId;
+        anchor.userId = userId;
+        anchor.userName = userName;
+        anchor.rtcToken = rtcToken;
+        anchor.muted = muted;
+        anchor.micOn = micOn;
+        anchor.cameraOn = cameraOn;
+        mAnchors.put(roomId, anchor);
+    }
+
+    private void updateTopology() {
+        mTopology = VideoChatPkTopology.plan(new ArrayList<>(mAnchors.keySet()));
+        Log.i(TAG, "updateTopology rooms:" + mTopology.getRoomIds()
+                + ",hub:" + mTopology.getHubRoomId()
+                + ",bandwidth:" + mTopology.bandwidth(VideoChatRTCManager.ins().getBitrate()));
+        updateForwardStream();
+        updateTiles();
+    }
+
+    private void updateForwardStream() {
+        if (getSelfUserInfo() == null || !getSelfUserInfo().isHost()) {
             return;
         }
-        Log.i(TAG, "startForwardStream mPeerRoomId:" + peerRoomId + ",rtcToken:" + rtcToken);
-        VideoChatRTCManager.ins().forwardStreamToRoom(new ForwardStreamInfo(peerRoomId, rtcToken));
+        List<String> targets = mTopology.relayTargetsOf(getLocalRoomId());
+        for (String roomId : new ArrayList<>(mRelayedRoomIds)) {
+            if (!targets.contains(roomId)) {
+                mRelayedRoomIds.remove(roomId);
+                VideoChatRTCManager.ins().stopForwardStreamToRoom(roomId);
+            }
+        }
+        for (String roomId : targets) {
+            PkAnchor anchor = mAnchors.get(roomId);
+            String rtcToken = anchor == null ? null : anchor.rtcToken;
+            boolean relayed = mRelayedRoomIds.contains(roomId);
+            if (relayed && TextUtils.isEmpty(rtcToken)) {
+                continue;
+            }
+            if (!relayed) {
+                mRelayedRoomIds.add(roomId);
+            }
+            if (anchor != null) {
+                anchor.rtcToken = null;
+            }
+            Log.i(TAG, "startForwardStream roomId:" + roomId + ",rtcToken:" + rtcToken);
+            VideoChatRTCManager.ins().forwardStreamToRoom(roomId, rtcToken);
+        }
     }
 
     private void stopForwardStream() {
-        if (!getSelfUserInfo().isHost()) {
+        if (getSelfUserInfo() == null || !getSelfUserInfo().isHost()) {
             return;
         }
+        mRelayedRoomIds.clear();
         VideoChatRTCManager.ins().stopForwardStreamToRoom();
     }
 
@@ -123,84 +232,138 @@ public class VideoAnchorPkFragment extends Fragment {
     @Override
     public View onCreateView(@NonNull LayoutInflater inflater, @Nullable ViewGroup container, @Nullable Bundle savedInstanceState) {
         View view = inflater.inflate(R.layout.fragment_video_pk, container, false);
-        TextView mLocalUserNamePrefixTv = view.findViewById(R.id.local_name_tv);
-        TextView mRemoteUserNamePrefixTv = view.findViewById(R.id.remote_name_tv);
-        mLocalVideoContainer = view.findViewById(R.id.local_video_container);
-        mRemoteVideoContainer = view.findViewById(R.id.remote_video_container);
-        mLocalStatusTv = view.findViewById(R.id.local_network_status_tv);
-        mRemoteStatusTv = view.findViewById(R.id.remote_network_status_tv);
-        mLocalNameTv = view.findViewById(R.id.local_user_name_tv);
-        mRemoteNameTv = view.findViewById(R.id.remote_user_name_tv);
-        mMuteRemoteIv = view.findViewById(R.id.mute_remote_user_iv);
-        if (getSelfUserInfo().isHost()) {
-            addLocalVideo();
-        } else {
-            addSelfAnchorVideo();
-        }
-        addRemoteAnchorVideo();
-        String localName = getLocalUserName();
-        mLocalNameTv.setText(localName);
-        mLocalUserNamePrefixTv.setText(TextUtils.isEmpty(localName) ? "" : localName.substring(0, 1));
-        mRemoteNameTv.setText(mPeerUname);
-        mRemoteUserNamePrefixTv.setText(TextUtils.isEmpty(mPeerUname) ? "" : mPeerUname.substring(0, 1));
-
-        Drawable localMicDrawable = mLocalAnchorMicOn ? null : ContextCompat.getDrawable(AppUtil.getApplicationContext(), R.drawable.mic_off_1x);
-        if (localMicDrawable != null) {
-            localMicDrawable.setBounds(0, 0, (int) Utils.dp2Px(12), (int) Utils.dp2Px(12));
-        }
-        mLocalNameTv.setCompoundDrawables(null, null, localMicDrawable, null);
-
-        mLocalVideoContainer.setVisibility(mLocalAnchorCameraOn ? View.VISIBLE : View.INVISIBLE);
-
-        Drawable peerMicDrawable = mPeerAnchorMicOn ? null : ContextCompat.getDrawable(AppUtil.getApplicationContext(), R.drawable.mic_off_1x);
-        if (peerMicDrawable != null) {
-            peerMicDrawable.setBounds(0, 0, (int) Utils.dp2Px(12), (int) Utils.dp2Px(12));
-        }
-        mRemoteNameTv.setCompoundDrawables(null, null, peerMicDrawable, null);
-
-        mRemoteVideoContainer.setVisibility(mPeerAnchorCameraOn ? View.VISIBLE : View.INVISIBLE);
-
-        VideoChatRTCManager.ins().muteRemoteAudio(mPeerUid, mPeerAnchorMuted);
-
-        mMuteRemoteIv.setImageResource(mPeerAnchorMuted
-                ? R.drawable.video_chat_main_pk_mute_remote
-                : R.drawable.video_chat_main_pk_unmute_remote);
+        mTilesLayout = view.findViewById(R.id.pk_tiles_layout);
+        updateTiles();
+        return view;
+    }
+
+    @Override
+    public void onDestroyView() {
+        super.onDestroyView();
+        for (PkAnchor anchor : mAnchors.values()) {
+            unbindTile(anchor);
+        }
+        mTilesLayout = null;
+    }
+
+    /**
+     * Show a tile for every anchor seen in this room, the local anchor first.
+     */
+    private void updateTiles() {
+        if (mTilesLayout == null) {
+            return;
+        }
+        List<String> visible = mTopology.visibleIn(getLocalRoomId());
+        for (PkAnchor anchor : mAnchors.values()) {
+            if (anchor.tile != null && !visible.contains(anchor.roomId)) {
+                mTilesLayout.removeView(anchor.tile);
+                unbindTile(anchor);
+            }
+        }
+        for (int i = 0; i < visible.size(); i++) {
+            PkAnchor anchor = mAnchors.get(visible.get(i));
+            if (anchor == null) {
+                continue;
+            }
+            if (anchor.tile == null) {
+                bindTile(anchor);
+            }
+            if (mTilesLayout.indexOfChild(anchor.tile) != i) {
+                Utils.removeFromParent(anchor.tile);
+                mTilesLayout.addView(anchor.tile, Math.min(i, mTilesLayout.getChildCount()));
+            }
+        }
+    }
+
+    private void bindTile(PkAnchor anchor) {
+        View tile = LayoutInflater.from(mTilesLayout.getContext())
+                .inflate(R.layout.item_video_chat_pk_tile, mTilesLayout, false);
+        anchor.tile = tile;
+        anchor.videoContainer = tile.findViewById(R.id.pk_tile_video_container);
+        anchor.statusTv = tile.findViewById(R.id.pk_tile_network_status_tv);
+        anchor.nameTv = tile.findViewById(R.id.pk_tile_user_name_tv);
+        anchor.muteIv = tile.findViewById(R.id.pk_tile_mute_iv);
+        TextView namePrefixTv = tile.findViewById(R.id.pk_tile_name_prefix_tv);
+
+        addAnchorVideo(anchor);
+        anchor.nameTv.setText(anchor.userName);
+        namePrefixTv.setText(TextUtils.isEmpty(anchor.userName) ? "" : anchor.userName.substring(0, 1));
+        updateMedia(anchor, anchor.micOn, anchor.cameraOn);
+        if (anchor.local) {
+            return;
+        }
+        VideoChatRTCManager.ins().muteRemoteAudio(anchor.userId, anchor.muted);
+        anchor.muteIv.setVisibility(View.VISIBLE);
+        updateMuteIcon(anchor);
         //观众没有mute权限
         if (getSelfUserInfo() != null && getSelfUserInfo().isHost()) {
-            mMuteRemoteIv.setOnClickListener(v -> {
-                if (mMutingPeerAnchor) {
-                    return;
-                }
-                mMutingPeerAnchor = true;
-                mSelfMutePeerAnchor = true;
-                int targetType = mPeerAnchorMuted ? VideoChatDataManager.TYPE_UN_MUTE : VideoChatDataManager.TYPE_MUTE;
-                VideoChatRTCManager.ins().getRTSClient().manageOtherAnchor(
-                        VideoChatDataManager.ins().selfUserInfo.userId,
-                        VideoChatDataManager.ins().selfUserInfo.roomId,
-                        mPeerUid, targetType, new IRequestCallback<VideoChatResponse>() {
-                            @Override
-                            public void onSuccess(VideoChatResponse data) {
-                                mMutingPeerAnchor = false;
-                                VideoChatRTCManager.ins().muteRemoteAudio(mPeerUid, !mPeerAnchorMuted);
-                                mPeerAnchorMuted = !mPeerAnchorMuted;
-                                mMuteRemoteIv.setImageResource(mPeerAnchorMuted
-                                        ? R.drawable.video_chat_main_pk_mute_remote
-                                        : R.drawable.video_chat_main_pk_unmute_remote);
-                            }
-
-                            @Override
-                            public void onError(int errorCode, String message) {
-                                mMutingPeerAnchor = false;
-                                String msg = mPeerAnchorMuted
-                                        ? getString(R.string.failed_unmute_remote_co_host)
-                                        : getString(R.string.failed_mute_remote_co_host);
-                                SolutionToast.show(msg + errorCode + "," + message);
-                            }
-                        });
-
-            });
+            anchor.muteIv.setOnClickListener(v -> manageAnchor(anchor));
         }
-        return view;
+    }
+
+    private void unbindTile(PkAnchor anchor) {
+        anchor.tile = null;
+        anchor.videoContainer = null;
+        anchor.statusTv = null;
+        anchor.nameTv = null;
+        anchor.muteIv = null;
+    }
+
+    private void manageAnchor(PkAnchor anchor) {
+        if (anchor.muting) {
+            return;
+        }
+        anchor.muting = true;
+        anchor.selfMuting = true;
+        int targetType = anchor.muted ? VideoChatDataManager.TYPE_UN_MUTE : VideoChatDataManager.TYPE_MUTE;
+        VideoChatRTCManager.ins().getRTSClient().manageOtherAnchor(
+                VideoChatDataManager.ins().selfUserInfo.userId,
+                VideoChatDataManager.ins().selfUserInfo.roomId,
+                anchor.userId, targetType, new IRequestCallback<VideoChatResponse>() {
+                    @Override
+                    public void onSuccess(VideoChatResponse data) {
+                        anchor.muting = false;
+                        VideoChatRTCManager.ins().muteRemoteAudio(anchor.userId, !anchor.muted);
+                        anchor.muted = !anchor.muted;
+                        updateMuteIcon(anchor);
+                    }
+
+                    @Override
+                    public void onError(int errorCode, String message) {
+                        anchor.muting = false;
+                        anchor.selfMuting = false;
+                        if (!isAdded()) {
+                            return;
+                        }
+                        String msg = anchor.muted
+                                ? getString(R.string.failed_unmute_remote_co_host)
+                                : getString(R.string.failed_mute_remote_co_host);
+                        SolutionToast.show(msg + errorCode + "," + message);
+                    }
+                });
+    }
+
+    private void updateMuteIcon(PkAnchor anchor) {
+        if (anchor.muteIv == null) {
+            return;
+        }
+        anchor.muteIv.setImageResource(anchor.muted
+                ? R.drawable.video_chat_main_pk_mute_remote
+                : R.drawable.video_chat_main_pk_unmute_remote);
+    }
+
+    private void updateMedia(PkAnchor anchor, boolean micOn, boolean cameraOn) {
+        anchor.micOn = micOn;
+        anchor.cameraOn = cameraOn;
+        if (anchor.tile == null) {
+            return;
+        }
+        Drawable micDrawable = micOn ? null : ContextCompat.getDrawable(AppUtil.getApplicationContext(), R.drawable.mic_off_1x);
+        if (micDrawable != null) {
+            micDrawable.setBounds(0, 0, (int) Utils.dp2Px(12), (int) Utils.dp2Px(12));
+        }
+        anchor.nameTv.setCompoundDrawables(null, null, micDrawable, null);
+        anchor.videoContainer.setVisibility(cameraOn ? View.VISIBLE : View.INVISIBLE);
     }
 
     private String getLocalUserName() {
@@ -213,42 +376,23 @@ public class VideoAnchorPkFragment extends Fragment {
         return "";
     }
 
-    private void addLocalVideo() {
-        if (getSelfUserInfo() == null || TextUtils.isEmpty(getSelfUserInfo().userId)) {
-            return;
-        }
-        TextureView localVideoView = VideoChatRTCManager.ins().getUserRenderView(getSelfUserInfo().userId);
-        Utils.removeFromParent(localVideoView);
-        mLocalVideoContainer.removeAllViews();
-        mLocalVideoContainer.addView(localVideoView, new FrameLayout.LayoutParams(
-                ViewGroup.LayoutParams.MATCH_PARENT, ViewGroup.LayoutParams.MATCH_PARENT));
+    private String getLocalRoomId() {
+        return getHostUserInfo() == null ? "" : getHostUserInfo().roomId;
     }
 
-    private void addSelfAnchorVideo() {
-        if (getHostUserInfo() == null || TextUtils.isEmpty(getHostUserInfo().userId)) {
+    private void addAnchorVideo(PkAnchor anchor) {
+        if (anchor.videoContainer == null || TextUtils.isEmpty(anchor.userId)) {
             return;
         }
-        String userId = getHostUserInfo().userId;
-        TextureView remoteVideoView = VideoChatRTCManager.ins().getUserRenderView(userId);
-        Utils.removeFromParent(remoteVideoView);
-        mLocalVideoContainer.removeAllViews();
-        mLocalVideoContainer.addView(remoteVideoView, new FrameLayout.LayoutParams(
+        TextureView videoView = VideoChatRTCManager.ins().getUserRenderView(anchor.userId);
+        Utils.removeFromParent(videoView);
+        anchor.videoContainer.removeAllViews();
+        anchor.videoContainer.addView(videoView, new FrameLayout.LayoutParams(
                 ViewGroup.LayoutParams.MATCH_PARENT, ViewGroup.LayoutParams.MATCH_PARENT));
-
-        VideoChatRTCManager.ins().setRemoteVideoView(userId, getHostUserInfo().roomId, remoteVideoView);
-    }
-
-    private void addRemoteAnchorVideo() {
-        if (TextUtils.isEmpty(mPeerUid)) {
-            return;
+        boolean selfVideo = anchor.local && getSelfUserInfo() != null && getSelfUserInfo().isHost();
+        if (!selfVideo) {
+            VideoChatRTCManager.ins().setRemoteVideoView(anchor.userId, getLocalRoomId(), videoView);
         }
-        TextureView remoteVideoView = VideoChatRTCManager.ins().getUserRenderView(mPeerUid);
-        Utils.removeFromParent(remoteVideoView);
-        mRemoteVideoContainer.removeAllViews();
-        mRemoteVideoContainer.addView(remoteVideoView, new FrameLayout.LayoutParams(
-                ViewGroup.LayoutParams.MATCH_PARENT, ViewGroup.LayoutParams.MATCH_PARENT));
-
-        VideoChatRTCManager.ins().setRemoteVideoView(mPeerUid, getHostUserInfo().roomId, remoteVideoView);
     }
 
     @Override
@@ -261,26 +405,27 @@ public class VideoAnchorPkFragment extends Fragment {
     @Subscribe(threadMode = ThreadMode.MAIN)
     public void onManageOtherAnchor(ManageOtherAnchorEvent event) {
         Log.i(TAG, "onManageOtherAnchor event:" + event);
-        if (TextUtils.equals(event.otherAnchorUid, mPeerUid) && !mSelfMutePeerAnchor) {
-            mPeerAnchorMuted = event.type == VideoChatDataManager.TYPE_MUTE;
-            mMuteRemoteIv.setImageResource(mPeerAnchorMuted
-                    ? R.drawable.video_chat_main_pk_mute_remote
-                    : R.drawable.video_chat_main_pk_unmute_remote);
-            if (getSelfUserInfo() != null && !getSelfUserInfo().isHost()
-                    && TextUtils.equals(event.otherAnchorUid, mPeerUid)) {
-                VideoChatRTCManager.ins().muteRemoteAudio(mPeerUid, mPeerAnchorMuted);
-            }
+        PkAnchor anchor = findAnchorByUserId(event.otherAnchorUid);
+        if (anchor == null || anchor.local) {
+            return;
+        }
+        if (anchor.selfMuting) {
+            anchor.selfMuting = false;
+            return;
         }
-        if (mSelfMutePeerAnchor) {
-            mSelfMutePeerAnchor = false;
+        anchor.muted = event.type == VideoChatDataManager.TYPE_MUTE;
+        updateMuteIcon(anchor);
+        if (getSelfUserInfo() != null && !getSelfUserInfo().isHost()) {
+            VideoChatRTCManager.ins().muteRemoteAudio(anchor.userId, anchor.muted);
         }
     }
 
     @Subscribe(threadMode = ThreadMode.MAIN)
     public void onUserJoined(UserJoinedEvent event) {
         Log.i(TAG, "onUserJoined event:" + event);
-        if (TextUtils.equals(event.userInfo.getUid(), mPeerUid)) {
-            addRemoteAnchorVideo();
+        PkAnchor anchor = findAnchorByUserId(event.userInfo.getUid());
+        if (anchor != null && !anchor.local) {
+            addAnchorVideo(anchor);
         }
     }
 
@@ -290,36 +435,56 @@ public class VideoAnchorPkFragment extends Fragment {
         if (event == null || event.userInfo == null || TextUtils.isEmpty(event.userInfo.userId)) {
             return;
         }
-        Drawable drawable = event.userInfo.mic == 1 ? null : ContextCompat.getDrawable(AppUtil.getApplicationContext(), R.drawable.mic_off_1x);
-        if (drawable != null) {
-            drawable.setBounds(0, 0, (int) Utils.dp2Px(12), (int) Utils.dp2Px(12));
+        PkAnchor anchor = findAnchorByUserId(event.userInfo.userId);
+        if (anchor != null) {
+            updateMedia(anchor, event.userInfo.mic == 1, event.userInfo.camera == 1);
         }
-        if (TextUtils.equals(event.userInfo.userId, mPeerUid)) {
-            mRemoteNameTv.setCompoundDrawables(null, null, drawable, null);
-            mRemoteVideoContainer.setVisibility(event.userInfo.camera == 1 ? View.VISIBLE : View.INVISIBLE);
-            return;
-        }
-        if (getHostUserInfo() != null && TextUtils.equals(getHostUserInfo().userId, event.userInfo.userId)) {
-            mLocalNameTv.setCompoundDrawables(null, null, drawable, null);
-            mLocalVideoContainer.setVisibility(event.userInfo.camera == 1 ? View.VISIBLE : View.INVISIBLE);
+    }
+
+    @Subscribe(threadMode = ThreadMode.MAIN)
+    public void onForwardStreamState(ForwardStreamStateEvent event) {
+        if (event.state == VideoChatForwardStreamManager.TARGET_FAILED
+                && mRelayedRoomIds.contains(event.roomId)) {
+            SolutionToast.show(R.string.video_chat_pk_relay_failed);
         }
     }
 
     @Subscribe(threadMode = ThreadMode.MAIN)
     public void onNetStatus(SDKNetStatusEvent stats) {
-        if (TextUtils.equals(stats.uid, mPeerUid)) {
-            updateNetStatus(mRemoteStatusTv, stats.networkQuality);
-            return;
-        }
-        //自己端主播
-        if (getHostUserInfo() != null
-                && TextUtils.equals(stats.uid, getHostUserInfo().userId)) {
-            updateNetStatus(mLocalStatusTv, stats.networkQuality);
+        PkAnchor anchor = findAnchorByUserId(stats.uid);
+        if (anchor != null) {
+            updateNetStatus(anchor.statusTv, stats.networkQuality);
         }
     }
 
+    /**
+     * @return names of the peer anchors, comma separated
+     */
     public String getPeerUname() {
-        return TextUtils.isEmpty(mPeerUname) ? "" : mPeerUname;
+        StringBuilder names = new StringBuilder();
+        for (PkAnchor anchor : mAnchors.values()) {
+            if (anchor.local || TextUtils.isEmpty(anchor.userName)) {
+                continue;
+            }
+            if (names.length() > 0) {
+                names.append(", ");
+            }
+            names.append(anchor.userName);
+        }
+        return names.toString();
+    }
+
+    @Nullable
+    private PkAnchor findAnchorByUserId(String userId) {
+        if (TextUtils.isEmpty(userId)) {
+            return null;
+        }
+        for (PkAnchor anchor : mAnchors.values()) {
+            if (TextUtils.equals(anchor.userId, userId)) {
+                return anchor;
+            }
+        }
+        return null;
     }
 
     private VideoChatUserInfo getHostUserInfo() {
@@ -343,4 +508,12 @@ public class VideoAnchorPkFragment extends Fragment {
         }
         textView.setCompoundDrawables(netStatusDrawable, null, null, null);
     }
+
+    private static String item(String[] array, int index) {
+        return array != null && index < array.length ? array[index] : null;
+    }
+
+    private static boolean item(boolean[] array, int index) {
+        return array != null && index < array.length && array[index];
+    }
 }
@@ -37,6 +37,7 @@ import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
 import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
 import com.volcengine.vertcdemo.videochat.core.VideoChatDataManager;
 import com.volcengine.vertcdemo.videochat.core.VideoChatRTCManager;
+import com.volcengine.vertcdemo.videochat.core.VideoChatRoomSessions;
 import com.volcengine.vertcdemo.videochat.event.SDKAudioPropertiesEvent;
 import com.volcengine.vertcdemo.videochat.feature.roommain.AudienceManagerDialog;
 import com.volcengine.vertcdemo.videochat.feature.roommain.SeatOptionDialog;
@@ -47,10 +48,13 @@ import org.greenrobot.eventbus.Subscribe;
 import org.greenrobot.eventbus.ThreadMode;
 
 import java.util.List;
+import java.util.Map;
 
 public class VideoChatRoomFragment extends Fragment {
     private static final String TAG = "VideoChatRoomFragment";
     public static final String KEY_JOIN_DATA = "JOIN_ROOM_DATA";
+    /*** Id of the JoinRoomEvent in VideoChatRoomSessions */
+    public static final String KEY_JOIN_SESSION = "JOIN_ROOM_SESSION";
 
     private VideoChatSeatsGroupLayout mSeatsGroupLayout;
     private AudienceManagerDialog.ICloseChatRoom mICloseChatRoom;
@@ -102,10 +106,23 @@ public class VideoChatRoomFragment extends Fragment {
     @Override
     public void onCreate(@Nullable Bundle savedInstanceState) {
         super.onCreate(savedInstanceState);
-        mJoinRoomResponse = getArguments() == null ? null : getArguments().getParcelable(KEY_JOIN_DATA);
+        String sessionId = getArguments() == null ? null : getArguments().getString(KEY_JOIN_SESSION);
+        mJoinRoomResponse = VideoChatRoomSessions.ins().take(sessionId, JoinRoomEvent.class);
+        if (mJoinRoomResponse == null && savedInstanceState != null) {
+            // The process was restarted, the registry is empty.
+            mJoinRoomResponse = savedInstanceState.getParcelable(KEY_JOIN_DATA);
+        }
         SolutionDemoEventManager.register(this);
     }
 
+    @Override
+    public void onSaveInstanceState(@NonNull Bundle outState) {
+        super.onSaveInstanceState(outState);
+        if (mJoinRoomResponse != null) {
+            outState.putParcelable(KEY_JOIN_DATA, mJoinRoomResponse);
+        }
+    }
+
     @Nullable
     @Override
     public View onCreateView(@NonNull LayoutInflater inflater, @Nullable ViewGroup container, @Nullable Bundle savedInstanceState) {
@@ -129,14 +146,26 @@ public class VideoChatRoomFragment extends Fragment {
         mSeatsGroupLayout.bindSeatInfo(data.seatMap);
     }
 
+    /**
+     * Rebind only the given seats, a null value clears the seat.
+     */
+    public void bindSeats(Map<Integer, VideoChatSeatInfo> seats) {
+        if (mSeatsGroupLayout != null) {
+            mSeatsGroupLayout.bindSeatInfo(seats);
+        }
+    }
+
+    public void bindHostInfo(VideoChatUserInfo hostInfo) {
+        if (mSeatsGroupLayout != null) {
+            mSeatsGroupLayout.bindHostInfo(hostInfo);
+        }
+    }
+
     @Subscribe(threadMode = ThreadMode.MAIN)
     public void onInteractChangedBroadcast(InteractChangedEvent event) {
         Log.i(TAG, "VideoChatRoomFragment onInteractChangedBroadcast event:" + event);
         if (mSeatsGroupLayout != null) {
-            VideoChatSeatInfo info = new VideoChatSeatInfo();
-            info.userInfo = event.userInfo;
-            info.status = VideoChatDataManager.SEAT_STATUS_UNLOCKED;
-            mSeatsGroupLayout.bindSeatInfo(event.seatId, event.isStart ? info : null);
+            mSeatsGroupLayout.bindSeatUser(event.seatId, event.isStart ? event.userInfo : null);
         }
 
         boolean isSelf = TextUtils.equals(SolutionDataManager.ins().getUserId(), event.userInfo.userId);
@@ -0,0 +1,76 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import android.content.Context;
+import android.view.View;
+
+import com.volcengine.vertcdemo.common.IAction;
+import com.volcengine.vertcdemo.protocol.IVideoPlayer;
+
+/**
+ * Player that plays nothing: records what it was asked to do, so the CDN path can be tested
+ * without a CDN or the player kit.
+ */
+class StandInVideoPlayer implements IVideoPlayer {
+    String url;
+    int scalingMode = MODE_NONE;
+    boolean configured;
+    boolean playing;
+    boolean destroyed;
+    int playCount;
+    int stopCount;
+    int replaceCount;
+
+    @Override
+    public void startWithConfiguration(Context context) {
+        configured = true;
+    }
+
+    @Override
+    public void setSEICallback(IAction<String> SEICallback) {
+    }
+
+    @Override
+    public void setPlayerUrl(String url, View container) {
+        this.url = url;
+    }
+
+    @Override
+    public void updatePlayScaleModel(int scalingMode) {
+        this.scalingMode = scalingMode;
+    }
+
+    @Override
+    public void play() {
+        if (url == null || destroyed) {
+            throw new IllegalStateException("play without url");
+        }
+        playing = true;
+        playCount++;
+    }
+
+    @Override
+    public void replacePlayWithUrl(String url) {
+        this.url = url;
+        replaceCount++;
+    }
+
+    @Override
+    public void stop() {
+        playing = false;
+        stopCount++;
+    }
+
+    @Override
+    public boolean isSupportSEI() {
+        return false;
+    }
+
+    @Override
+    public void destroy() {
+        playing = false;
+        destroyed = true;
+    }
+}
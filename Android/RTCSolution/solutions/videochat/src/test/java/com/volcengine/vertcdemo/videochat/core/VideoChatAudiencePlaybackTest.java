@@ -0,0 +1,216 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static com.volcengine.vertcdemo.videochat.core.VideoChatAudiencePlayback.MODE_PLAYER;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatAudiencePlayback.MODE_PREPARING;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatAudiencePlayback.MODE_RTC;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatAudiencePlayback.MODE_SWITCHING;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+import com.volcengine.vertcdemo.protocol.IVideoPlayer;
+
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Hand over of a pure audience from the CDN player to RTC, with a stand-in player and an RTC
+ * room that renders its first frame {@link #RTC_FIRST_FRAME_MS} after subscribing.
+ */
+public class VideoChatAudiencePlaybackTest {
+
+    private static final String URL = "rtmp://cdn.example.com/live/room";
+    private static final long RTC_FIRST_FRAME_MS = 300;
+
+    /**
+     * RTC room joined for signaling; subscribing renders a frame after a delay.
+     */
+    private static class StandInRtc implements VideoChatAudiencePlayback.Media {
+        final VirtualScheduler scheduler;
+        VideoChatAudiencePlayback playback;
+        boolean subscribed = true;
+        boolean rendering;
+        int subscribeCount;
+        final Runnable firstFrame = new Runnable() {
+            @Override
+            public void run() {
+                rendering = true;
+                playback.onRtcFirstFrame(scheduler.now());
+            }
+        };
+
+        StandInRtc(VirtualScheduler scheduler) {
+            this.scheduler = scheduler;
+        }
+
+        @Override
+        public void setSubscribed(boolean subscribed) {
+            this.subscribed = subscribed;
+            scheduler.cancel(firstFrame);
+            rendering = false;
+            if (subscribed) {
+                subscribeCount++;
+                scheduler.schedule(firstFrame, RTC_FIRST_FRAME_MS);
+            }
+        }
+    }
+
+    private final VirtualScheduler mScheduler = new VirtualScheduler();
+    private final StandInVideoPlayer mPlayer = new StandInVideoPlayer();
+    private final StandInRtc mRtc = new StandInRtc(mScheduler);
+    private final VideoChatAudiencePlayback mPlayback = new VideoChatAudiencePlayback(mPlayer, mRtc);
+    // Something is on screen at every mode change: the player or an RTC frame.
+    private int mBlankModeChanges;
+
+    @Before
+    public void setUp() {
+        mRtc.playback = mPlayback;
+        mPlayback.setListener((mode, showPlayer) -> {
+            if (showPlayer ? !mPlayer.playing : !mRtc.rendering) {
+                mBlankModeChanges++;
+            }
+        });
+    }
+
+    @Test
+    public void pureAudienceWatchesThePlayerOnly() {
+        assertTrue(mPlayback.start(URL, null));
+        assertEquals(MODE_PLAYER, mPlayback.getMode());
+        assertEquals(URL, mPlayer.url);
+        assertEquals(IVideoPlayer.MODE_ASPECT_FIT, mPlayer.scalingMode);
+        assertTrue(mPlayer.playing);
+        assertFalse("no RTC media while on the player", mRtc.subscribed);
+        mScheduler.runUntil(10_000);
+        assertEquals(MODE_PLAYER, mPlayback.getMode());
+    }
+
+    @Test
+    public void preparedInviteSwitchesAtOnce() {
+        mPlayback.start(URL, null);
+        mPlayback.prepareInteract(mScheduler.now());
+        assertEquals(MODE_PREPARING, mPlayback.getMode());
+        assertTrue(mRtc.subscribed);
+
+        mScheduler.runUntil(2_000); // the audience reads the invite
+        assertTrue("player keeps playing behind", mPlayer.playing);
+        assertEquals(MODE_PREPARING, mPlayback.getMode());
+
+        mPlayback.commitInteract(mScheduler.now());
+        assertEquals(MODE_RTC, mPlayback.getMode());
+        assertFalse(mPlayer.playing);
+        assertEquals(0, mPlayback.getLastSwitchMs());
+        assertEquals(RTC_FIRST_FRAME_MS, mPlayback.getLastPrepareLeadMs());
+        assertEquals(0, mBlankModeChanges);
+    }
+
+    @Test
+    public void quickAcceptWaitsForTheFirstFrame() {
+        mPlayback.start(URL, null);
+        mPlayback.prepareInteract(mScheduler.now());
+        mScheduler.runUntil(100);
+        mPlayback.commitInteract(mScheduler.now());
+        assertEquals(MODE_SWITCHING, mPlayback.getMode());
+        assertTrue(mPlayer.playing);
+
+        mScheduler.runUntil(RTC_FIRST_FRAME_MS);
+        assertEquals(MODE_RTC, mPlayback.getMode());
+        assertEquals(RTC_FIRST_FRAME_MS - 100, mPlayback.getLastSwitchMs());
+        assertEquals(1, mPlayback.getSwitchCount());
+        assertEquals(0, mBlankModeChanges);
+    }
+
+    @Test
+    public void acceptedApplyWithoutInviteStillHandsOver() {
+        mPlayback.start(URL, null);
+        mScheduler.runUntil(5_000);
+        mPlayback.commitInteract(mScheduler.now());
+        assertEquals(MODE_SWITCHING, mPlayback.getMode());
+        mScheduler.runUntil(5_000 + RTC_FIRST_FRAME_MS);
+        assertEquals(MODE_RTC, mPlayback.getMode());
+        assertEquals(RTC_FIRST_FRAME_MS, mPlayback.getLastSwitchMs());
+        assertEquals(0, mBlankModeChanges);
+    }
+
+    @Test
+    public void declinedInviteDropsRtcMedia() {
+        mPlayback.start(URL, null);
+        mPlayback.prepareInteract(mScheduler.now());
+        mScheduler.runUntil(50);
+        mPlayback.cancelInteract();
+        assertEquals(MODE_PLAYER, mPlayback.getMode());
+        assertFalse(mRtc.subscribed);
+        assertTrue(mPlayer.playing);
+        assertEquals(1, mPlayback.getCancelCount());
+
+        mScheduler.runUntil(10_000);
+        assertEquals("late frame does not switch", MODE_PLAYER, mPlayback.getMode());
+        assertEquals(-1, mPlayback.getLastPrepareLeadMs());
+    }
+
+    @Test
+    public void noRtcFrameSwitchesOnTimeout() {
+        mPlayback.start(URL, null);
+        mPlayback.prepareInteract(mScheduler.now());
+        mScheduler.cancel(mRtc.firstFrame); // every camera off
+        mPlayback.commitInteract(mScheduler.now());
+        mScheduler.schedule(() -> mPlayback.onSwitchTimeout(mScheduler.now()),
+                VideoChatAudiencePlayback.SWITCH_TIMEOUT_MS);
+        mScheduler.runUntil(VideoChatAudiencePlayback.SWITCH_TIMEOUT_MS);
+        assertEquals(MODE_RTC, mPlayback.getMode());
+        assertEquals(VideoChatAudiencePlayback.SWITCH_TIMEOUT_MS, mPlayback.getLastSwitchMs());
+        assertFalse(mPlayer.playing);
+    }
+
+    @Test
+    public void offMicReturnsToThePlayer() {
+        mPlayback.start(URL, null);
+        mPlayback.prepareInteract(mScheduler.now());
+        mPlayback.commitInteract(mScheduler.now());
+        mScheduler.runUntil(RTC_FIRST_FRAME_MS);
+        assertEquals(MODE_RTC, mPlayback.getMode());
+
+        mPlayback.finishInteract();
+        assertEquals(MODE_PLAYER, mPlayback.getMode());
+        assertTrue(mPlayer.playing);
+        assertEquals(1, mPlayer.replaceCount);
+        assertFalse(mRtc.subscribed);
+
+        // A second round trip is measured again.
+        mScheduler.runUntil(1_000);
+        mPlayback.prepareInteract(mScheduler.now());
+        mScheduler.runUntil(1_000 + RTC_FIRST_FRAME_MS);
+        mPlayback.commitInteract(mScheduler.now());
+        assertEquals(2, mPlayback.getSwitchCount());
+        assertEquals(0, mBlankModeChanges);
+    }
+
+    @Test
+    public void withoutUrlOrPlayerTheAudienceUsesRtc() {
+        assertFalse(mPlayback.start("", null));
+        assertEquals(MODE_RTC, mPlayback.getMode());
+        assertTrue(mRtc.subscribed);
+        mPlayback.finishInteract();
+        assertEquals(MODE_RTC, mPlayback.getMode());
+
+        StandInRtc rtc = new StandInRtc(mScheduler);
+        VideoChatAudiencePlayback noPlayer = new VideoChatAudiencePlayback(null, rtc);
+        rtc.playback = noPlayer;
+        assertFalse(noPlayer.start(URL, null));
+        assertTrue(rtc.subscribed);
+        noPlayer.prepareInteract(0);
+        assertEquals(MODE_RTC, noPlayer.getMode());
+    }
+
+    @Test
+    public void releaseRestoresSubscription() {
+        mPlayback.start(URL, null);
+        mPlayback.release();
+        assertTrue(mRtc.subscribed);
+        assertTrue(mPlayer.destroyed);
+        assertEquals(MODE_RTC, mPlayback.getMode());
+    }
+}
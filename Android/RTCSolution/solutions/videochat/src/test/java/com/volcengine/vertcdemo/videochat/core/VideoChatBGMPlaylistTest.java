@@ -0,0 +1,282 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import androidx.annotation.NonNull;
+
+import com.volcengine.vertcdemo.common.IAction;
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+
+import org.junit.Before;
+import org.junit.Test;
+
+import java.io.File;
+import java.net.URL;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Playlist order, preloading and switch latency, with the tracks of the bgm fixture directory.
+ */
+public class VideoChatBGMPlaylistTest {
+
+    /*** Resolving a track, e.g. extracting an asset on first use */
+    private static final long RESOLVE_MS = 120;
+    /*** Opening and decoding a file that was not preloaded */
+    private static final long OPEN_MS = 40;
+    /*** Starting a preloaded effect */
+    private static final long START_MS = 2;
+    private static final long TRACK_MS = 30_000;
+
+    /**
+     * Effect player on the virtual clock, playing every track for {@link #TRACK_MS}.
+     */
+    private class FakePlayer implements VideoChatBGMPlaylist.Player {
+        final List<String> calls = new ArrayList<>();
+        final Map<Integer, String> preloaded = new HashMap<>();
+        final Map<Integer, Runnable> pending = new HashMap<>();
+        final List<Long> switchMs = new ArrayList<>();
+
+        @Override
+        public void preload(int effectId, @NonNull String path) {
+            calls.add("preload " + effectId + " " + new File(path).getName());
+            preloaded.put(effectId, path);
+        }
+
+        @Override
+        public void unload(int effectId) {
+            preloaded.remove(effectId);
+        }
+
+        @Override
+        public void start(int effectId, @NonNull String path, int volume) {
+            calls.add("start " + effectId + " " + new File(path).getName());
+            cancel(effectId);
+            Runnable finish = () -> {
+                pending.remove(effectId);
+                mPlaylist.onFinished(effectId, mScheduler.now());
+            };
+            Runnable playing = () -> {
+                mPlaylist.onPlaying(effectId, mScheduler.now());
+                switchMs.add(mPlaylist.getLastSwitchMs());
+                pending.put(effectId, finish);
+                mScheduler.schedule(finish, TRACK_MS);
+            };
+            pending.put(effectId, playing);
+            mScheduler.schedule(playing, path.equals(preloaded.get(effectId)) ? START_MS : OPEN_MS);
+        }
+
+        @Override
+        public void stop(int effectId) {
+            cancel(effectId);
+        }
+
+        @Override
+        public void pause(int effectId) {
+            calls.add("pause " + effectId);
+        }
+
+        @Override
+        public void resume(int effectId) {
+            calls.add("resume " + effectId);
+        }
+
+        @Override
+        public void setVolume(int effectId, int volume) {
+        }
+
+        private void cancel(int effectId) {
+            Runnable task = pending.remove(effectId);
+            if (task != null) {
+                mScheduler.cancel(task);
+            }
+        }
+    }
+
+    /**
+     * Files resolve to themselves after {@link #RESOLVE_MS}, missing ones to null.
+     */
+    private class FixtureResolver implements VideoChatBGMPlaylist.Resolver {
+        int count;
+
+        @Override
+        public void resolve(@NonNull VideoChatBGMPlaylist.Track track, @NonNull IAction<String> done) {
+            count++;
+            File file = new File(track.location);
+            mScheduler.schedule(() -> done.act(file.isFile() ? file.getAbsolutePath() : null), RESOLVE_MS);
+        }
+    }
+
+    private VirtualScheduler mScheduler;
+    private FakePlayer mPlayer;
+    private FixtureResolver mResolver;
+    private VideoChatBGMPlaylist mPlaylist;
+    private List<VideoChatBGMPlaylist.Track> mFixtures;
+
+    @Before
+    public void setUp() {
+        mScheduler = new VirtualScheduler();
+        mPlayer = new FakePlayer();
+        mResolver = new FixtureResolver();
+        mPlaylist = new VideoChatBGMPlaylist(mPlayer, mResolver, 0);
+        mFixtures = fixtureTracks();
+    }
+
+    @Test
+    public void fixtureTracksPlayInOrderAndLoop() {
+        assertEquals(3, mFixtures.size());
+        mPlaylist.setTracks(mFixtures);
+        mPlaylist.play(mScheduler.now());
+        mScheduler.runUntil(RESOLVE_MS * 2);
+        assertEquals(Arrays.asList("start 0 01_intro.wav", "preload 1 02_loop.wav"), mPlayer.calls);
+
+        mPlayer.calls.clear();
+        mScheduler.runUntil(mScheduler.now() + TRACK_MS * 3 + RESOLVE_MS);
+        assertEquals(Arrays.asList(
+                "start 1 02_loop.wav", "preload 0 03_outro.wav",
+                "start 0 03_outro.wav", "preload 1 01_intro.wav",
+                "start 1 01_intro.wav", "preload 0 02_loop.wav"), mPlayer.calls);
+        assertEquals(0, mPlaylist.getIndex());
+        assertEquals(4, mPlaylist.getSwitchCount());
+        assertEquals(3, mPlaylist.getPreloadedSwitchCount());
+    }
+
+    @Test
+    public void endOfListStopsWithoutLoop() {
+        mPlaylist.setTracks(mFixtures);
+        mPlaylist.setLoop(false);
+        mPlaylist.play(mScheduler.now());
+        mScheduler.runUntil(TRACK_MS * 4);
+        assertEquals(VideoChatBGMPlaylist.STATE_STOPPED, mPlaylist.getState());
+        assertEquals(3, mPlaylist.getSwitchCount());
+    }
+
+    @Test
+    public void singleTrackRepeatsGaplessly() {
+        mPlaylist.setTracks(mFixtures.subList(0, 1));
+        mPlaylist.play(mScheduler.now());
+        mScheduler.runUntil(TRACK_MS * 5);
+        assertEquals(5, mPlaylist.getSwitchCount());
+        assertEquals(Arrays.asList(RESOLVE_MS + OPEN_MS, START_MS, START_MS, START_MS, START_MS), mPlayer.switchMs);
+        assertEquals("both effect ids keep the path", 2, mResolver.count);
+    }
+
+    @Test
+    public void missingTracksAreSkipped() {
+        List<VideoChatBGMPlaylist.Track> tracks = new ArrayList<>(mFixtures);
+        tracks.add(1, VideoChatBGMPlaylist.Track.file(new File(fixtureDir(), "gone.wav").getPath()));
+        mPlaylist.setTracks(tracks);
+        mPlaylist.playAt(1, mScheduler.now());
+        mScheduler.runUntil(RESOLVE_MS * 3);
+        assertEquals(2, mPlaylist.getIndex());
+        assertTrue(mPlayer.calls.contains("start 0 02_loop.wav")
+                || mPlayer.calls.contains("start 1 02_loop.wav"));
+
+        VideoChatBGMPlaylist.Track gone = VideoChatBGMPlaylist.Track.file("/nonexistent/bgm.mp3");
+        mPlaylist.setTracks(Arrays.asList(gone, gone));
+        mPlaylist.play(mScheduler.now());
+        mScheduler.runUntil(mScheduler.now() + RESOLVE_MS * 10);
+        assertEquals("nothing playable, no spinning", VideoChatBGMPlaylist.STATE_STOPPED, mPlaylist.getState());
+    }
+
+    @Test
+    public void pauseWhileResolvingStaysPaused() {
+        mPlaylist.setTracks(mFixtures);
+        mPlaylist.play(mScheduler.now());
+        mPlaylist.pause();
+        mScheduler.runUntil(RESOLVE_MS);
+        assertEquals(Arrays.asList("start 0 01_intro.wav", "pause 0"), mPlayer.calls.subList(0, 2));
+        assertEquals(VideoChatBGMPlaylist.STATE_PAUSED, mPlaylist.getState());
+
+        mPlaylist.play(mScheduler.now());
+        assertEquals("resume 0", mPlayer.calls.get(mPlayer.calls.size() - 1));
+    }
+
+    @Test
+    public void stopDropsLateResolves() {
+        mPlaylist.setTracks(mFixtures);
+        mPlaylist.play(mScheduler.now());
+        mPlaylist.stop();
+        mScheduler.runUntil(TRACK_MS);
+        assertTrue(mPlayer.calls.isEmpty());
+        assertEquals(0, mPlaylist.getSwitchCount());
+    }
+
+    /**
+     * Switch latency of tracks preloaded ahead, against opening every track at switch time as
+     * the single effect id did.
+     */
+    @Test
+    public void preloadedSwitchBenchmark() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        final int switches = 300;
+        List<VideoChatBGMPlaylist.Track> tracks = new ArrayList<>();
+        for (int i = 0; i < 10; i++) {
+            tracks.addAll(mFixtures);
+        }
+
+        // Playing through the list, every next track preloaded while the current one plays.
+        mPlaylist.setTracks(tracks);
+        mPlaylist.play(mScheduler.now());
+        mScheduler.runUntil(RESOLVE_MS + OPEN_MS + (TRACK_MS + START_MS) * (switches - 1));
+        List<Long> preloaded = mPlayer.switchMs.subList(1, mPlayer.switchMs.size());
+        assertEquals(switches - 1, preloaded.size());
+        assertEquals(switches - 1, mPlaylist.getPreloadedSwitchCount());
+
+        // Skipping around, the track asked for is never the preloaded one.
+        mPlaylist.stop();
+        mPlayer = new FakePlayer();
+        mPlaylist = new VideoChatBGMPlaylist(mPlayer, new FixtureResolver(), 0);
+        mPlaylist.setTracks(tracks);
+        for (int i = 1; i < switches; i++) {
+            mPlaylist.playAt((i * 7) % tracks.size(), mScheduler.now());
+            mScheduler.runUntil(mScheduler.now() + RESOLVE_MS + OPEN_MS);
+        }
+        List<Long> cold = mPlayer.switchMs;
+        assertEquals(switches - 1, cold.size());
+        assertEquals(0, mPlaylist.getPreloadedSwitchCount());
+
+        System.out.printf("bgm switch over %d tracks: preloaded avg %.1fms max %dms, cold avg %.1fms max %dms%n",
+                switches - 1, average(preloaded), Collections.max(preloaded),
+                average(cold), Collections.max(cold));
+        assertEquals(START_MS, (long) Collections.max(preloaded));
+        assertEquals(RESOLVE_MS + OPEN_MS, (long) Collections.min(cold));
+    }
+
+    private static double average(@NonNull List<Long> values) {
+        long sum = 0;
+        for (long value : values) {
+            sum += value;
+        }
+        return (double) sum / values.size();
+    }
+
+    @NonNull
+    private static File fixtureDir() {
+        URL url = VideoChatBGMPlaylistTest.class.getClassLoader().getResource("bgm");
+        assertNotNull("bgm fixture directory", url);
+        return new File(url.getPath());
+    }
+
+    @NonNull
+    private static List<VideoChatBGMPlaylist.Track> fixtureTracks() {
+        String[] names = fixtureDir().list();
+        assertNotNull(names);
+        Arrays.sort(names);
+        List<VideoChatBGMPlaylist.Track> tracks = new ArrayList<>();
+        for (String name : names) {
+            tracks.add(VideoChatBGMPlaylist.Track.file(new File(fixtureDir(), name).getAbsolutePath()));
+        }
+        return tracks;
+    }
+}
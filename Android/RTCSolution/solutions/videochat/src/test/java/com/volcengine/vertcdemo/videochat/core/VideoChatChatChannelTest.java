@@ -0,0 +1,351 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import androidx.annotation.NonNull;
+
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+
+import org.junit.Before;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+
+/**
+ * Delivery, dedupe and end-to-end latency of the chat channel, with a local stand-in for the RTC
+ * room and the business server.
+ */
+public class VideoChatChatChannelTest {
+
+    /*** RTC room message, one hop through the media server */
+    private static final long ROOM_MS = 30;
+    /*** Client to business server, through the RTS relay */
+    private static final long UPLINK_MS = 40;
+    /*** Moderation and persistence */
+    private static final long SERVER_MS = 20;
+    /*** Business server to every client, through the RTS relay */
+    private static final long FANOUT_MS = 40;
+    /*** Up to this much extra delay on every hop */
+    private static final int JITTER_MS = 50;
+
+    /**
+     * RTC room and business server on the virtual clock. The server rejects messages containing
+     * "spam" and does not fan a message out to its sender, which the room screen drops anyway.
+     */
+    private class StandIn {
+        final Map<String, VideoChatChatChannel> members = new LinkedHashMap<>();
+        final Map<String, Map<String, String>> shown = new HashMap<>();
+        final List<String> persisted = new ArrayList<>();
+        final Map<String, Long> sentAt = new HashMap<>();
+        final List<Long> latencies = new ArrayList<>();
+        final Random random = new Random(41);
+        boolean roomUp = true;
+        double roomLoss;
+        boolean echoIds = true;
+
+        VideoChatChatChannel join(String userId) {
+            VideoChatChatChannel channel = new VideoChatChatChannel(new VideoChatChatChannel.Transport() {
+                @Override
+                public boolean broadcast(@NonNull String payload) {
+                    if (!roomUp) {
+                        return false;
+                    }
+                    for (Map.Entry<String, VideoChatChatChannel> member : members.entrySet()) {
+                        if (member.getKey().equals(userId) || random.nextDouble() < roomLoss) {
+                            continue;
+                        }
+                        VideoChatChatChannel to = member.getValue();
+                        mScheduler.schedule(() -> to.onRoomMessage(userId, payload, mScheduler.now()), hop(ROOM_MS));
+                    }
+                    return true;
+                }
+
+                @Override
+                public void submit(@NonNull VideoChatChatChannel.Message message,
+                                   @NonNull VideoChatChatChannel.SubmitCallback callback) {
+                    mScheduler.schedule(() -> serve(message, callback), hop(UPLINK_MS) + SERVER_MS);
+                }
+            }, mScheduler);
+            Map<String, String> screen = new LinkedHashMap<>();
+            channel.setListener(new VideoChatChatChannel.Listener() {
+                @Override
+                public void onMessage(@NonNull VideoChatChatChannel.Message message, int source) {
+                    String text = message.payload.toDisplayText();
+                    String key = message.id != null ? message.id : text;
+                    assertFalse(userId + " shows " + key + " twice", screen.containsKey(key));
+                    screen.put(key, text);
+                    latencies.add(mScheduler.now() - sentAt.get(text));
+                }
+
+                @Override
+                public void onConfirmed(@NonNull String messageId) {
+                    assertTrue(userId + " confirms " + messageId, screen.containsKey(messageId));
+                }
+
+                @Override
+                public void onRetracted(@NonNull String messageId) {
+                    screen.remove(messageId);
+                }
+            });
+            members.put(userId, channel);
+            shown.put(userId, screen);
+            return channel;
+        }
+
+        void send(String userId, String text) {
+            sentAt.put(text, mScheduler.now());
+            VideoChatChatChannel.Message message = members.get(userId).send("room", userId, userId,
+                    VideoChatChatPayload.text(text), mScheduler.now());
+            shown.get(userId).put(message.id, text);
+        }
+
+        private void serve(VideoChatChatChannel.Message message, VideoChatChatChannel.SubmitCallback callback) {
+            if (message.text.contains("spam")) {
+                mScheduler.schedule(() -> callback.onResult(VideoChatChatChannel.SUBMIT_REJECTED), hop(FANOUT_MS));
+                return;
+            }
+            persisted.add(message.text);
+            mScheduler.schedule(() -> callback.onResult(VideoChatChatChannel.SUBMIT_ACCEPTED), hop(FANOUT_MS));
+            String id = echoIds ? message.id : null;
+            for (Map.Entry<String, VideoChatChatChannel> member : members.entrySet()) {
+                if (member.getKey().equals(message.userId)) {
+                    continue;
+                }
+                VideoChatChatChannel to = member.getValue();
+                mScheduler.schedule(() -> to.onServerMessage(id, message.userId, message.userName, message.text,
+                        mScheduler.now()), hop(FANOUT_MS));
+            }
+        }
+
+        private long hop(long ms) {
+            return ms + random.nextInt(JITTER_MS);
+        }
+    }
+
+    private VirtualScheduler mScheduler;
+    private StandIn mStandIn;
+
+    @Before
+    public void setUp() {
+        mScheduler = new VirtualScheduler();
+        mStandIn = new StandIn();
+    }
+
+    @Test
+    public void roomCopyComesFirstAndServerCopyIsDropped() {
+        mStandIn.join("alice");
+        VideoChatChatChannel bob = mStandIn.join("bob");
+        mStandIn.join("carol");
+        for (int i = 0; i < 20; i++) {
+            mStandIn.send("alice", "hello " + i);
+            mScheduler.runUntil(mScheduler.now() + 100);
+        }
+        mScheduler.runUntil(mScheduler.now() + 1_000);
+
+        assertEquals(20, mStandIn.shown.get("bob").size());
+        assertEquals(20, mStandIn.shown.get("carol").size());
+        assertEquals(20, mStandIn.persisted.size());
+        assertEquals(20, bob.getRoomCount());
+        assertEquals(0, bob.getServerCount());
+        assertEquals(20, bob.getDuplicateCount());
+        assertTrue(bob.getAverageLeadMs() > 0);
+        assertTrue(bob.getAverageRoomLatencyMs() < ROOM_MS + JITTER_MS);
+    }
+
+    @Test
+    public void lostRoomMessagesAreDeliveredByServer() {
+        mStandIn.roomLoss = 0.3;
+        VideoChatChatChannel alice = mStandIn.join("alice");
+        VideoChatChatChannel bob = mStandIn.join("bob");
+        for (int i = 0; i < 50; i++) {
+            mStandIn.send(i % 2 == 0 ? "alice" : "bob", "message " + i);
+            mScheduler.runUntil(mScheduler.now() + 50);
+        }
+        mScheduler.runUntil(mScheduler.now() + 1_000);
+
+        assertEquals(50, mStandIn.shown.get("alice").size());
+        assertEquals(50, mStandIn.shown.get("bob").size());
+        assertTrue(bob.getServerCount() > 0);
+        assertEquals(25, bob.getRoomCount() + bob.getServerCount());
+        assertEquals(25, alice.getRoomCount() + alice.getServerCount());
+    }
+
+    @Test
+    public void withoutRoomTheServerDeliversEverything() {
+        mStandIn.roomUp = false;
+        mStandIn.join("alice");
+        VideoChatChatChannel bob = mStandIn.join("bob");
+        mStandIn.send("alice", "hello");
+        mScheduler.runUntil(1_000);
+
+        assertEquals(Collections.singletonList("hello"), new ArrayList<>(mStandIn.shown.get("bob").values()));
+        assertEquals(1, bob.getServerCount());
+        assertEquals(0, bob.getDuplicateCount());
+    }
+
+    @Test
+    public void rejectedMessageIsTakenBack() {
+        VideoChatChatChannel alice = mStandIn.join("alice");
+        mStandIn.join("bob");
+        mStandIn.send("alice", "cheap spam here");
+        mScheduler.runUntil(ROOM_MS + JITTER_MS);
+        assertEquals("the room sees it before moderation", 1, mStandIn.shown.get("bob").size());
+
+        mScheduler.runUntil(1_000);
+        assertTrue(mStandIn.shown.get("bob").isEmpty());
+        assertTrue(mStandIn.shown.get("alice").isEmpty());
+        assertTrue(mStandIn.persisted.isEmpty());
+        assertEquals(1, alice.getRejectedCount());
+    }
+
+    @Test
+    public void roomCopyTheServerNeverConfirmsIsTakenBack() {
+        List<String> events = new ArrayList<>();
+        VideoChatChatChannel channel = listening(events);
+        // A client that skips the retraction for its rejected message, and an accepted one.
+        String rejected = "{\"type\":\"vi_chat\",\"id\":\"mallory-1\",\"user_id\":\"mallory\",\"message\":\"spam\",\"sent_at\":0}";
+        String accepted = "{\"type\":\"vi_chat\",\"id\":\"alice-1\",\"user_id\":\"alice\",\"message\":\"hi\",\"sent_at\":0}";
+        assertTrue(channel.onRoomMessage("mallory", rejected, 0));
+        assertTrue(channel.onRoomMessage("alice", accepted, 0));
+        mScheduler.runUntil(100);
+        channel.onServerMessage("alice-1", "alice", "alice", "hi", 100);
+        mScheduler.runUntil(VideoChatChatChannel.CONFIRM_WINDOW_MS);
+
+        assertEquals(Arrays.asList("message mallory-1", "message alice-1", "confirmed alice-1", "retracted mallory-1"),
+                events);
+        assertEquals(1, channel.getUnconfirmedCount());
+    }
+
+    @Test
+    public void retractionOvertakingTheMessageDropsIt() {
+        List<String> events = new ArrayList<>();
+        VideoChatChatChannel channel = listening(events);
+        String message = "{\"type\":\"vi_chat\",\"id\":\"alice-1\",\"user_id\":\"alice\",\"message\":\"hi\",\"sent_at\":0}";
+        String retract = "{\"type\":\"vi_chat_retract\",\"id\":\"alice-1\",\"user_id\":\"alice\"}";
+        assertTrue(channel.onRoomMessage("alice", retract, 10));
+        assertTrue(channel.onRoomMessage("alice", message, 20));
+        channel.onServerMessage("alice-1", "alice", "alice", "hi", 30);
+        assertEquals(Collections.singletonList("retracted alice-1"), events);
+    }
+
+    @Test
+    public void serverWithoutIdsIsMatchedByText() {
+        mStandIn.echoIds = false;
+        mStandIn.join("alice");
+        VideoChatChatChannel bob = mStandIn.join("bob");
+        mStandIn.send("alice", "same");
+        mScheduler.runUntil(mScheduler.now() + 1_000);
+        assertEquals(1, mStandIn.shown.get("bob").size());
+        assertEquals(1, bob.getDuplicateCount());
+
+        // The same text again is a new message, matched to its own room copy.
+        mStandIn.send("alice", "same");
+        mScheduler.runUntil(mScheduler.now() + 1_000);
+        assertEquals(2, mStandIn.shown.get("bob").size());
+        assertEquals(2, bob.getRoomCount());
+        assertEquals(2, bob.getDuplicateCount());
+        assertEquals(0, bob.getServerCount());
+    }
+
+    @Test
+    public void foreignAndSpoofedRoomMessagesAreIgnored() {
+        List<String> events = new ArrayList<>();
+        VideoChatChatChannel channel = listening(events);
+        String message = "{\"type\":\"vi_chat\",\"id\":\"alice-1\",\"user_id\":\"alice\",\"message\":\"hi\",\"sent_at\":0}";
+        assertFalse(channel.onRoomMessage("mallory", message, 0));
+        assertFalse(channel.onRoomMessage("alice", "{\"type\":\"other\"}", 0));
+        assertFalse(channel.onRoomMessage("alice", "not json", 0));
+        assertFalse(channel.onRoomMessage("alice", "{broken", 0));
+        assertFalse(channel.onRoomMessage("alice", null, 0));
+        assertTrue(events.isEmpty());
+    }
+
+    /**
+     * Time from sending to showing on every other screen, room message with server fallback
+     * against the server fan-out alone.
+     */
+    @Test
+    public void endToEndLatencyBenchmark() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        List<Long> hybrid = runRoom(true);
+        mScheduler = new VirtualScheduler();
+        mStandIn = new StandIn();
+        List<Long> serverOnly = runRoom(false);
+
+        System.out.printf("chat end to end over %d deliveries: room+server p50 %dms p95 %dms, server only p50 %dms p95 %dms%n",
+                hybrid.size(), percentile(hybrid, 50), percentile(hybrid, 95),
+                percentile(serverOnly, 50), percentile(serverOnly, 95));
+        assertEquals(serverOnly.size(), hybrid.size());
+        assertTrue(percentile(hybrid, 50) < ROOM_MS + JITTER_MS);
+        assertTrue(percentile(serverOnly, 50) >= UPLINK_MS + SERVER_MS + FANOUT_MS);
+        assertTrue(percentile(hybrid, 95) < percentile(serverOnly, 50));
+    }
+
+    private List<Long> runRoom(boolean roomUp) {
+        mStandIn.roomUp = roomUp;
+        mStandIn.roomLoss = 0.02;
+        for (int i = 0; i < 6; i++) {
+            mStandIn.join("user" + i);
+        }
+        Random random = new Random(42);
+        for (int i = 0; i < 500; i++) {
+            mStandIn.send("user" + random.nextInt(6), "message " + i);
+            mScheduler.runUntil(mScheduler.now() + 20 + random.nextInt(200));
+        }
+        mScheduler.runUntil(mScheduler.now() + 1_000);
+        for (Map<String, String> screen : mStandIn.shown.values()) {
+            assertEquals(500, screen.size());
+        }
+        return mStandIn.latencies;
+    }
+
+    private VideoChatChatChannel listening(List<String> events) {
+        VideoChatChatChannel channel = new VideoChatChatChannel(new VideoChatChatChannel.Transport() {
+            @Override
+            public boolean broadcast(@NonNull String payload) {
+                return false;
+            }
+
+            @Override
+            public void submit(@NonNull VideoChatChatChannel.Message message,
+                               @NonNull VideoChatChatChannel.SubmitCallback callback) {
+            }
+        }, mScheduler);
+        channel.setListener(new VideoChatChatChannel.Listener() {
+            @Override
+            public void onMessage(@NonNull VideoChatChatChannel.Message message, int source) {
+                events.add("message " + message.id);
+            }
+
+            @Override
+            public void onConfirmed(@NonNull String messageId) {
+                events.add("confirmed " + messageId);
+            }
+
+            @Override
+            public void onRetracted(@NonNull String messageId) {
+                events.add("retracted " + messageId);
+            }
+        });
+        return channel;
+    }
+
+    private static long percentile(List<Long> values, int percent) {
+        List<Long> sorted = new ArrayList<>(values);
+        Collections.sort(sorted);
+        return sorted.get(Math.min(sorted.size() - 1, sorted.size() * percent / 100));
+    }
+}
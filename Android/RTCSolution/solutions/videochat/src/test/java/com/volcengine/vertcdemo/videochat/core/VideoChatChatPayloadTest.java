@@ -0,0 +1,211 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import com.google.gson.JsonObject;
+
+import org.junit.Test;
+
+import java.io.UnsupportedEncodingException;
+import java.net.URLEncoder;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Chat payload forms, compatibility with URL-encoded messages, and size against URL encoding.
+ */
+public class VideoChatChatPayloadTest {
+
+    private static final List<String> CORPUS = Arrays.asList(
+            "Hello everyone, welcome to the room!",
+            "lol 😂😂😂",
+            "大家好，欢迎来到直播间！今天我们聊聊音乐。",
+            "这首歌太好听了 👍",
+            "こんにちは、よろしくお願いします。",
+            "안녕하세요! 반갑습니다.",
+            "Привет всем, как дела?",
+            "مرحبا بالجميع في الغرفة",
+            "नमस्ते, आप कैसे हैं?",
+            "สวัสดีครับ ยินดีที่ได้รู้จัก",
+            "Olá! Tudo bem? Ça va très bien, merci.",
+            "🎉🎂🎁 生日快乐 happy birthday 🥳",
+            "ok",
+            "666");
+
+    @Test
+    public void plainTextGoesAsItIs() {
+        for (String text : CORPUS) {
+            assertEquals(text, VideoChatChatPayload.text(text).toWire());
+        }
+    }
+
+    @Test
+    public void corpusRoundTripsInEveryForm() throws UnsupportedEncodingException {
+        for (String text : CORPUS) {
+            assertEquals(text, VideoChatChatPayload.fromWire(VideoChatChatPayload.text(text).toWire()).toDisplayText());
+            assertEquals("sent by earlier versions", text,
+                    VideoChatChatPayload.fromWire(URLEncoder.encode(text, "UTF-8")).toDisplayText());
+        }
+    }
+
+    @Test
+    public void textLookingUrlEncodedIsEscaped() throws UnsupportedEncodingException {
+        for (String text : new String[]{"50%", "1+1", "%E4%BD%A0", "a+b%2", "~", "~hi", "~~", "~!AAAA"}) {
+            String wire = VideoChatChatPayload.text(text).toWire();
+            assertEquals(text, VideoChatChatPayload.ESCAPE + text, wire);
+            assertEquals(text, VideoChatChatPayload.fromWire(wire).toDisplayText());
+            assertEquals(text, VideoChatChatPayload.fromWire(URLEncoder.encode(text, "UTF-8")).toDisplayText());
+        }
+        assertEquals("a_b-c.d*e", VideoChatChatPayload.text("a_b-c.d*e").toWire());
+    }
+
+    @Test
+    public void brokenEscapesAreShownAsTheyCame() {
+        assertEquals("100%", VideoChatChatPayload.fromWire("100%").toDisplayText());
+        assertEquals("%zz", VideoChatChatPayload.fromWire("%zz").toDisplayText());
+        assertEquals("", VideoChatChatPayload.fromWire(null).toDisplayText());
+        assertEquals("", VideoChatChatPayload.fromWire("").toDisplayText());
+    }
+
+    @Test
+    public void richMessageRoundTrips() {
+        VideoChatChatPayload payload = new VideoChatChatPayload.Builder()
+                .text("谢谢 ")
+                .mention("user_1024", "小明")
+                .text(" ")
+                .emoji("🎉")
+                .reaction("alice-kx1-7", "❤️")
+                .build();
+        assertFalse(payload.isPlain());
+        String wire = payload.toWire();
+        assertTrue(wire, wire.startsWith(VideoChatChatPayload.RICH_PREFIX));
+
+        VideoChatChatPayload read = VideoChatChatPayload.fromWire(wire);
+        assertEquals(payload.getSegments(), read.getSegments());
+        assertEquals("谢谢 @小明 🎉❤️", read.toDisplayText());
+        assertEquals("user_1024", read.getSegments().get(1).target);
+        assertEquals("alice-kx1-7", read.getSegments().get(4).target);
+    }
+
+    @Test
+    public void laterHeaderBytesAndSegmentKindsAreSkipped() {
+        byte[] text = new VideoChatChatPayload.Builder().text("hi").emoji("👋").build().encode();
+        // Version 2 with one more header byte and a segment of an unknown kind 9 in front.
+        byte[] later = new byte[text.length + 1 + 4];
+        later[0] = 2;
+        later[1] = 1;
+        later[2] = 0x7F;
+        later[3] = 9;
+        later[4] = 2;
+        later[5] = 'x';
+        later[6] = 'y';
+        System.arraycopy(text, 2, later, 7, text.length - 2);
+
+        VideoChatChatPayload read = VideoChatChatPayload.fromWire(
+                VideoChatChatPayload.RICH_PREFIX + VideoChatSeatSei.toBase64(later));
+        assertEquals("hi👋", read.toDisplayText());
+        assertEquals(2, read.getSegments().size());
+    }
+
+    @Test
+    public void longSegmentsUseMoreLengthBytes() {
+        StringBuilder text = new StringBuilder();
+        for (int i = 0; i < 2000; i++) {
+            text.append('字');
+        }
+        VideoChatChatPayload payload = new VideoChatChatPayload.Builder().text(text.toString()).emoji("🙂").build();
+        assertEquals(text + "🙂", VideoChatChatPayload.fromWire(payload.toWire()).toDisplayText());
+    }
+
+    @Test
+    public void damagedRichPayloadIsShownAsItCame() {
+        String wire = new VideoChatChatPayload.Builder().text("hello").emoji("🙂").build().toWire();
+        byte[] data = VideoChatSeatSei.fromBase64(wire.substring(VideoChatChatPayload.RICH_PREFIX.length()));
+        byte[] cut = Arrays.copyOf(data, data.length - 2);
+        String cutWire = VideoChatChatPayload.RICH_PREFIX + VideoChatSeatSei.toBase64(cut);
+        assertEquals(cutWire, VideoChatChatPayload.fromWire(cutWire).toDisplayText());
+        assertEquals("~!not base64", VideoChatChatPayload.fromWire("~!not base64").toDisplayText());
+        assertEquals("~!AAAA", VideoChatChatPayload.fromWire("~!AAAA").toDisplayText());
+    }
+
+    /**
+     * Bytes of the RTS envelope RTSBaseClient sends and encode plus decode time, URL-encoded text
+     * against the payload, over the corpus.
+     */
+    @Test
+    public void sizeAndCpuComparison() throws UnsupportedEncodingException {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        long legacyBytes = 0;
+        long payloadBytes = 0;
+        for (String text : CORPUS) {
+            int legacy = envelopeBytes(URLEncoder.encode(text, "UTF-8"));
+            int payload = envelopeBytes(VideoChatChatPayload.text(text).toWire());
+            assertTrue(text, payload <= legacy);
+            legacyBytes += legacy - envelopeBytes("");
+            payloadBytes += payload - envelopeBytes("");
+        }
+        int cjkLegacy = envelopeBytes(URLEncoder.encode(CORPUS.get(2), "UTF-8")) - envelopeBytes("");
+        int cjkPayload = envelopeBytes(VideoChatChatPayload.text(CORPUS.get(2)).toWire()) - envelopeBytes("");
+        assertTrue(cjkLegacy + " vs " + cjkPayload, cjkPayload * 2 < cjkLegacy);
+
+        final int rounds = 2_000;
+        for (int warmup = 0; warmup < 2; warmup++) {
+            legacyRounds(rounds);
+            payloadRounds(rounds);
+        }
+        long legacyNs = System.nanoTime();
+        legacyRounds(rounds);
+        legacyNs = System.nanoTime() - legacyNs;
+        long payloadNs = System.nanoTime();
+        payloadRounds(rounds);
+        payloadNs = System.nanoTime() - payloadNs;
+
+        System.out.printf("chat corpus of %d messages: url-encoded %d bytes, payload %d bytes (%.0f%%), cjk line %d -> %d bytes; "
+                        + "encode+decode url %dus, payload %dus per corpus%n",
+                CORPUS.size(), legacyBytes, payloadBytes, payloadBytes * 100.0 / legacyBytes, cjkLegacy, cjkPayload,
+                legacyNs / rounds / 1000, payloadNs / rounds / 1000);
+    }
+
+    private static void legacyRounds(int rounds) throws UnsupportedEncodingException {
+        for (int i = 0; i < rounds; i++) {
+            for (String text : CORPUS) {
+                String wire = URLEncoder.encode(text, "UTF-8");
+                if (!java.net.URLDecoder.decode(wire, "UTF-8").equals(text)) {
+                    throw new AssertionError(text);
+                }
+            }
+        }
+    }
+
+    private static void payloadRounds(int rounds) {
+        for (int i = 0; i < rounds; i++) {
+            for (String text : CORPUS) {
+                String wire = VideoChatChatPayload.text(text).toWire();
+                if (!VideoChatChatPayload.fromWire(wire).toDisplayText().equals(text)) {
+                    throw new AssertionError(text);
+                }
+            }
+        }
+    }
+
+    /**
+     * The message as RTSBaseClient wraps it: the params stringified into the content field.
+     */
+    private static int envelopeBytes(String message) {
+        JsonObject content = new JsonObject();
+        content.addProperty("room_id", "room_1024");
+        content.addProperty("message", message);
+        content.addProperty("message_id", "user_1024-kx1abc-1");
+        JsonObject envelope = new JsonObject();
+        envelope.addProperty("event_name", "viSendMessage");
+        envelope.addProperty("content", content.toString());
+        return envelope.toString().getBytes(StandardCharsets.UTF_8).length;
+    }
+}
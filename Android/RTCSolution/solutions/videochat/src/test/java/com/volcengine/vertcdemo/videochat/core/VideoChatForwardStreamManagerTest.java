@@ -0,0 +1,322 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_ERROR_INVALID_ARGUMENT;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_ERROR_INVALID_TOKEN;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_ERROR_OK;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_ERROR_RESPONSE;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_EVENT_CONNECTED;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_EVENT_DISCONNECTED;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_EVENT_INTERRUPT;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_EVENT_RECOVER;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_STATE_FAILURE;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_STATE_IDLE;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.SDK_STATE_SUCCESS;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.TARGET_FAILED;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.TARGET_IDLE;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.TARGET_RELAYING;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.TARGET_RETRYING;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.TARGET_STALLED;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatForwardStreamManager.TARGET_STARTING;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+import androidx.annotation.NonNull;
+
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+
+import org.junit.Before;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * Drives the relay state machine with synthetic SDK forward stream callbacks on a virtual clock.
+ */
+public class VideoChatForwardStreamManagerTest {
+
+    private static final long TOKEN_RTT_MS = 100;
+
+    /**
+     * Records what the manager asked the SDK to relay.
+     */
+    private class FakeRelay implements VideoChatForwardStreamManager.Relay {
+        final List<String> calls = new ArrayList<>();
+        List<String> relayed = new ArrayList<>();
+        List<String> tokens = new ArrayList<>();
+
+        @Override
+        public void start(@NonNull List<VideoChatForwardStreamManager.Target> targets) {
+            record("start", targets);
+        }
+
+        @Override
+        public void update(@NonNull List<VideoChatForwardStreamManager.Target> targets) {
+            record("update", targets);
+        }
+
+        @Override
+        public void stop() {
+            assertUnlocked();
+            calls.add("stop");
+            relayed = new ArrayList<>();
+            tokens = new ArrayList<>();
+        }
+
+        private void record(String call, List<VideoChatForwardStreamManager.Target> targets) {
+            assertUnlocked();
+            relayed = new ArrayList<>();
+            tokens = new ArrayList<>();
+            for (VideoChatForwardStreamManager.Target target : targets) {
+                relayed.add(target.roomId);
+                tokens.add(target.token);
+            }
+            calls.add(call + relayed);
+        }
+    }
+
+    private final VirtualScheduler mScheduler = new VirtualScheduler();
+    private final FakeRelay mRelay = new FakeRelay();
+    private final List<String> mTransitions = new ArrayList<>();
+    private final List<String> mFetches = new ArrayList<>();
+    private boolean mTokenServerUp = true;
+    private long mTokenLifetimeMs;
+    private int mTokenSerial;
+    private VideoChatForwardStreamManager mManager;
+
+    @Before
+    public void setUp() {
+        mManager = new VideoChatForwardStreamManager(mRelay, (roomId, callback) -> {
+            assertUnlocked();
+            mFetches.add(roomId);
+            boolean up = mTokenServerUp;
+            mScheduler.schedule(() -> {
+                if (up) {
+                    callback.onToken("token_" + (++mTokenSerial),
+                            mTokenLifetimeMs > 0 ? mScheduler.now() + mTokenLifetimeMs : 0);
+                } else {
+                    callback.onError(500, "down");
+                }
+            }, TOKEN_RTT_MS);
+        }, mScheduler, mScheduler::now, new Random(11));
+        mManager.addListener((roomId, oldState, newState) -> {
+            assertUnlocked();
+            mTransitions.add(roomId + ":" + oldState + "->" + newState);
+        });
+    }
+
+    /**
+     * A relay, token provider or listener that blocks would otherwise stall the SDK callbacks.
+     */
+    private void assertUnlocked() {
+        assertFalse("called under the manager lock", Thread.holdsLock(mManager));
+    }
+
+    @Test
+    public void startReportsLatency() {
+        mManager.addTarget("A", "token_a", 0);
+        assertEquals(Arrays.asList("start[A]"), mRelay.calls);
+        assertEquals(TARGET_STARTING, mManager.getState("A"));
+
+        mScheduler.runUntil(300);
+        mManager.onStateChanged("A", SDK_STATE_SUCCESS, SDK_ERROR_OK);
+
+        assertEquals(TARGET_RELAYING, mManager.getState("A"));
+        VideoChatForwardStreamManager.Metrics metrics = mManager.getMetrics("A");
+        assertEquals(300, metrics.lastStartLatencyMs);
+        assertEquals(1, metrics.attempts);
+        mScheduler.runUntil(10_300);
+        assertEquals(10_000, mManager.getMetrics("A").relayingMs);
+    }
+
+    @Test
+    public void failureIsRetriedWithBackoff() {
+        mManager.addTarget("A", "token_a", 0);
+        mManager.onStateChanged("A", SDK_STATE_SUCCESS, SDK_ERROR_OK);
+        mRelay.calls.clear();
+
+        mManager.onStateChanged("A", SDK_STATE_FAILURE, SDK_ERROR_RESPONSE);
+        assertEquals(TARGET_RETRYING, mManager.getState("A"));
+        mScheduler.runUntil(VideoChatForwardStreamManager.DEFAULT_BASE_DELAY_MS / 2 - 1);
+        assertTrue("not before the backoff", mRelay.calls.isEmpty());
+
+        mScheduler.runUntil(VideoChatForwardStreamManager.DEFAULT_BASE_DELAY_MS);
+        assertEquals(TARGET_STARTING, mManager.getState("A"));
+        assertEquals("single target is restarted", Arrays.asList("stop", "start[A]"), mRelay.calls);
+
+        mManager.onStateChanged("A", SDK_STATE_SUCCESS, SDK_ERROR_OK);
+        VideoChatForwardStreamManager.Metrics metrics = mManager.getMetrics("A");
+        assertEquals(TARGET_RELAYING, mManager.getState("A"));
+        assertEquals(2, metrics.attempts);
+        assertEquals(1, metrics.failures);
+        assertEquals(SDK_ERROR_RESPONSE, metrics.lastError);
+    }
+
+    @Test
+    public void invalidTokenIsFetchedBeforeRetry() {
+        mManager.addTarget("A", "expired", 0);
+        mManager.onStateChanged("A", SDK_STATE_FAILURE, SDK_ERROR_INVALID_TOKEN);
+
+        assertEquals(Arrays.asList("A"), mFetches);
+        mScheduler.runUntil(TOKEN_RTT_MS);
+        assertEquals(TARGET_STARTING, mManager.getState("A"));
+        assertEquals(Arrays.asList("A"), mRelay.relayed);
+        assertEquals(Arrays.asList("token_1"), mRelay.tokens);
+    }
+
+    @Test
+    public void targetWithoutTokenIsFetchedBeforeStart() {
+        mManager.addTarget("A", "token_a", 0);
+        mManager.addTarget("B", null, 0);
+
+        assertEquals(Arrays.asList("B"), mFetches);
+        assertEquals(TARGET_STARTING, mManager.getState("B"));
+        assertEquals(Arrays.asList("start[A]"), mRelay.calls);
+        mScheduler.runUntil(TOKEN_RTT_MS);
+        assertEquals(Arrays.asList("start[A]", "update[A, B]"), mRelay.calls);
+        assertEquals(Arrays.asList("token_a", "token_1"), mRelay.tokens);
+        assertEquals(1, mManager.getMetrics("B").attempts);
+    }
+
+    @Test
+    public void tokenIsRefreshedBeforeExpiry() {
+        mTokenLifetimeMs = 300_000;
+        mManager.addTarget("A", "token_a", 120_000);
+        mManager.onStateChanged("A", SDK_STATE_SUCCESS, SDK_ERROR_OK);
+
+        mScheduler.runUntil(120_000 - VideoChatForwardStreamManager.DEFAULT_TOKEN_REFRESH_LEAD_MS - 1);
+        assertTrue(mFetches.isEmpty());
+        mScheduler.runUntil(120_000 - VideoChatForwardStreamManager.DEFAULT_TOKEN_REFRESH_LEAD_MS + TOKEN_RTT_MS);
+        assertEquals(Arrays.asList("A"), mFetches);
+        assertEquals("update", mRelay.calls.get(mRelay.calls.size() - 1).substring(0, 6));
+        assertEquals(Arrays.asList("token_1"), mRelay.tokens);
+        assertEquals("relay keeps running", TARGET_RELAYING, mManager.getState("A"));
+
+        // The new token expires at 60_100 + 300_000, refreshed a lead time before that.
+        mScheduler.runUntil(360_100 - VideoChatForwardStreamManager.DEFAULT_TOKEN_REFRESH_LEAD_MS + TOKEN_RTT_MS);
+        assertEquals(Arrays.asList("A", "A"), mFetches);
+        assertEquals(Arrays.asList("token_2"), mRelay.tokens);
+        assertEquals(2, mManager.getMetrics("A").tokenRefreshes);
+    }
+
+    @Test
+    public void stallRecoversOrRestarts() {
+        mManager.addTarget("A", "token_a", 0);
+        mManager.onStateChanged("A", SDK_STATE_SUCCESS, SDK_ERROR_OK);
+        mRelay.calls.clear();
+
+        mManager.onEvent("A", SDK_EVENT_DISCONNECTED);
+        assertEquals(TARGET_STALLED, mManager.getState("A"));
+        mScheduler.runUntil(1_000);
+        mManager.onEvent("A", SDK_EVENT_CONNECTED);
+        assertEquals(TARGET_RELAYING, mManager.getState("A"));
+        mScheduler.runUntil(60_000);
+        assertTrue("SDK reconnected by itself", mRelay.calls.isEmpty());
+
+        mManager.onEvent("A", SDK_EVENT_DISCONNECTED);
+        mScheduler.runUntil(60_000 + VideoChatForwardStreamManager.DEFAULT_STALL_TIMEOUT_MS);
+        assertEquals(TARGET_RETRYING, mManager.getState("A"));
+        mScheduler.runUntil(60_000 + VideoChatForwardStreamManager.DEFAULT_STALL_TIMEOUT_MS
+                + VideoChatForwardStreamManager.DEFAULT_BASE_DELAY_MS);
+        assertEquals(TARGET_STARTING, mManager.getState("A"));
+        assertEquals(2, mManager.getMetrics("A").stalls);
+    }
+
+    @Test
+    public void interruptEndsOnRecover() {
+        mManager.addTarget("A", "token_a", 0);
+        mManager.onStateChanged("A", SDK_STATE_SUCCESS, SDK_ERROR_OK);
+        mRelay.calls.clear();
+        mTransitions.clear();
+
+        mManager.onEvent("A", SDK_EVENT_INTERRUPT);
+        assertEquals(TARGET_STALLED, mManager.getState("A"));
+        mScheduler.runUntil(VideoChatForwardStreamManager.DEFAULT_STALL_TIMEOUT_MS - 1);
+        mManager.onEvent("A", SDK_EVENT_RECOVER);
+        assertEquals(TARGET_RELAYING, mManager.getState("A"));
+
+        mScheduler.runUntil(60_000);
+        assertEquals("the stall timeout was cancelled", TARGET_RELAYING, mManager.getState("A"));
+        assertTrue(mRelay.calls.isEmpty());
+        assertEquals(Arrays.asList("A:" + TARGET_RELAYING + "->" + TARGET_STALLED,
+                "A:" + TARGET_STALLED + "->" + TARGET_RELAYING), mTransitions);
+        VideoChatForwardStreamManager.Metrics metrics = mManager.getMetrics("A");
+        assertEquals(1, metrics.stalls);
+        assertEquals(0, metrics.failures);
+
+        mManager.onEvent("A", SDK_EVENT_RECOVER);
+        assertEquals("a recover without a stall changes nothing", 2, mTransitions.size());
+    }
+
+    @Test
+    public void targetsFailIndependently() {
+        mManager.addTarget("A", "token_a", 0);
+        mManager.addTarget("B", "token_b", 0);
+        mManager.addTarget("C", "token_c", 0);
+        assertEquals(Arrays.asList("start[A]", "update[A, B]", "update[A, B, C]"), mRelay.calls);
+        for (String room : Arrays.asList("A", "B", "C")) {
+            mManager.onStateChanged(room, SDK_STATE_SUCCESS, SDK_ERROR_OK);
+        }
+        mRelay.calls.clear();
+        mTransitions.clear();
+
+        mManager.onStateChanged("B", SDK_STATE_FAILURE, SDK_ERROR_RESPONSE);
+        mScheduler.runUntil(VideoChatForwardStreamManager.DEFAULT_BASE_DELAY_MS);
+
+        assertEquals("B is taken out and put back, A and C keep relaying",
+                Arrays.asList("update[A, C]", "update[A, B, C]"), mRelay.calls);
+        assertEquals(Arrays.asList("B:2->4", "B:4->1"), mTransitions);
+        assertEquals(TARGET_RELAYING, mManager.getState("A"));
+        assertEquals(TARGET_RELAYING, mManager.getState("C"));
+    }
+
+    @Test
+    public void givesUpAfterMaxAttemptsAndCanBeRestarted() {
+        mManager.setRetryPolicy(100, 1_000, 3, 5_000, 60_000);
+        mManager.addTarget("A", "token_a", 0);
+        for (int i = 0; i < 4; i++) {
+            mManager.onStateChanged("A", SDK_STATE_FAILURE, SDK_ERROR_RESPONSE);
+            mScheduler.runUntil(mScheduler.now() + 1_000);
+        }
+        assertEquals(TARGET_FAILED, mManager.getState("A"));
+        assertEquals(4, mManager.getMetrics("A").attempts);
+
+        mManager.addTarget("A", "token_new", 0);
+        assertEquals(TARGET_STARTING, mManager.getState("A"));
+        assertEquals(Arrays.asList("token_new"), mRelay.tokens);
+
+        mManager.onStateChanged("A", SDK_STATE_FAILURE, SDK_ERROR_INVALID_ARGUMENT);
+        assertEquals("not retryable", TARGET_FAILED, mManager.getState("A"));
+    }
+
+    @Test
+    public void removedTargetsIgnoreLateCallbacks() {
+        mManager.addTarget("A", "token_a", 0);
+        mManager.addTarget("B", "token_b", 0);
+        mManager.onStateChanged("A", SDK_STATE_FAILURE, SDK_ERROR_RESPONSE);
+        mManager.removeTarget("A");
+        mScheduler.runUntil(60_000);
+        mManager.onStateChanged("A", SDK_STATE_SUCCESS, SDK_ERROR_OK);
+
+        assertEquals(TARGET_IDLE, mManager.getState("A"));
+        assertNull(mManager.getMetrics("A"));
+        assertEquals(Arrays.asList("B"), mRelay.relayed);
+
+        mManager.onStateChanged("B", SDK_STATE_SUCCESS, SDK_ERROR_OK);
+        mManager.onStateChanged("B", SDK_STATE_IDLE, SDK_ERROR_OK);
+        assertEquals("stopped by the SDK while still a target", TARGET_RETRYING, mManager.getState("B"));
+
+        mManager.removeAll();
+        assertEquals("stop", mRelay.calls.get(mRelay.calls.size() - 1));
+        assertTrue(mManager.getTargetRoomIds().isEmpty());
+        mScheduler.runUntil(120_000);
+        assertEquals("stop", mRelay.calls.get(mRelay.calls.size() - 1));
+    }
+}
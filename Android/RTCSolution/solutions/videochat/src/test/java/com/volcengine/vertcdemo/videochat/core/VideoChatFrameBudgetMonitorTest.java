@@ -0,0 +1,194 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static com.volcengine.vertcdemo.videochat.core.VideoChatFrameBudgetMonitor.LEVEL_FULL;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatFrameBudgetMonitor.LEVEL_OFF;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatFrameBudgetMonitor.LEVEL_REDUCED;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import org.junit.Before;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * Steps of the frame budget monitor driven by simulated frame timings and stats reports.
+ */
+public class VideoChatFrameBudgetMonitorTest {
+
+    private static final int FRAME_RATE = 15;
+    private static final int REDUCED_FRAME_RATE = 10;
+    private static final long REPORT_MS = 2_000;
+
+    /**
+     * A device where every effect level costs a fixed time per frame, with some jitter.
+     */
+    private static class SimulatedPipeline {
+        final long[] costUs;
+        final Random random = new Random(40);
+
+        SimulatedPipeline(long fullUs, long reducedUs, long offUs) {
+            costUs = new long[]{fullUs, reducedUs, offUs};
+        }
+
+        long frameUs(int level) {
+            long cost = costUs[level];
+            return cost + (long) (random.nextGaussian() * cost / 20);
+        }
+    }
+
+    private VideoChatFrameBudgetMonitor mMonitor;
+    private final List<String> mSteps = new ArrayList<>();
+    private long mNowMs;
+
+    @Before
+    public void setUp() {
+        mMonitor = new VideoChatFrameBudgetMonitor(FRAME_RATE);
+        mMonitor.setListener((oldLevel, newLevel) -> {
+            mSteps.add(oldLevel + "->" + newLevel + "@" + mNowMs / 1000);
+            // What VideoChatRTCManager does: cap the frame rate below LEVEL_FULL.
+            mMonitor.setFrameRate(newLevel == LEVEL_FULL ? FRAME_RATE : REDUCED_FRAME_RATE);
+        });
+    }
+
+    @Test
+    public void pipelineWithinBudgetStaysFull() {
+        run(new SimulatedPipeline(40_000, 30_000, 5_000), 120_000);
+        assertEquals(LEVEL_FULL, mMonitor.getLevel());
+        assertTrue(mSteps.isEmpty());
+        assertEquals(0, mMonitor.getOverBudgetCount());
+        assertEquals(0, mMonitor.getDowngradeCount());
+        assertTrue(mMonitor.getFrameCount() > 100 * FRAME_RATE);
+    }
+
+    @Test
+    public void slowEffectsStepDownToReduced() {
+        // 80ms a frame misses 15 fps, but fits 10 fps.
+        run(new SimulatedPipeline(80_000, 80_000, 5_000), 30_000);
+        assertEquals(LEVEL_REDUCED, mMonitor.getLevel());
+        assertEquals(1, mMonitor.getDowngradeCount());
+        assertEquals("first full window", "0->1@4", mSteps.get(0));
+        assertEquals(1, mSteps.size());
+    }
+
+    @Test
+    public void effectsTooSlowForAnyRateAreTurnedOff() {
+        run(new SimulatedPipeline(150_000, 150_000, 5_000), 20_000);
+        assertEquals(LEVEL_OFF, mMonitor.getLevel());
+        assertEquals(2, mMonitor.getDowngradeCount());
+        assertTrue(mMonitor.getWorstFrameUs() > 150_000);
+    }
+
+    @Test
+    public void shortSpikeDoesNotStepDown() {
+        SimulatedPipeline pipeline = new SimulatedPipeline(40_000, 30_000, 5_000);
+        run(pipeline, 10_000);
+        // A tenth of a window, e.g. the camera switching.
+        for (int i = 0; i < VideoChatFrameBudgetMonitor.WINDOW_FRAMES / 10; i++) {
+            frame(200_000);
+        }
+        run(pipeline, 10_000);
+        assertEquals(LEVEL_FULL, mMonitor.getLevel());
+        assertEquals(VideoChatFrameBudgetMonitor.WINDOW_FRAMES / 10, mMonitor.getOverBudgetCount());
+    }
+
+    @Test
+    public void recoveredPipelineStepsBackUpWithBackoff() {
+        SimulatedPipeline busy = new SimulatedPipeline(80_000, 80_000, 5_000);
+        SimulatedPipeline idle = new SimulatedPipeline(40_000, 30_000, 5_000);
+        run(busy, 10_000);
+        assertEquals(LEVEL_REDUCED, mMonitor.getLevel());
+
+        // Healthy again, e.g. another app stopped using the GPU.
+        run(idle, 60_000);
+        assertEquals(LEVEL_FULL, mMonitor.getLevel());
+        assertEquals(1, mMonitor.getUpgradeCount());
+
+        // Still too slow at full rate: down again, and it takes twice as long to come back.
+        run(busy, 10_000);
+        assertEquals(LEVEL_REDUCED, mMonitor.getLevel());
+        run(idle, 120_000);
+        assertEquals(LEVEL_FULL, mMonitor.getLevel());
+        assertEquals(4, mSteps.size());
+
+        long firstStayedDown = stepSecond(1) - stepSecond(0);
+        long secondStayedDown = stepSecond(3) - stepSecond(2);
+        assertTrue(firstStayedDown + "s", firstStayedDown >= VideoChatFrameBudgetMonitor.UPGRADE_AFTER_MS * 2 / 1000);
+        assertTrue(secondStayedDown + "s", secondStayedDown >= VideoChatFrameBudgetMonitor.UPGRADE_AFTER_MS * 4 / 1000);
+    }
+
+    @Test
+    public void dimLightIsNotAMiss() {
+        VideoChatFrameBudgetMonitor monitor = reportMonitor();
+        // The camera delivers 10 fps in the dark, every frame gets through.
+        for (int report = 0; report < 30; report++) {
+            mNowMs += REPORT_MS;
+            monitor.onReport(10, 10, REPORT_MS, mNowMs);
+        }
+        assertEquals(LEVEL_FULL, monitor.getLevel());
+        assertEquals(0, monitor.getOverBudgetCount());
+    }
+
+    @Test
+    public void singleShortReportIsASpike() {
+        VideoChatFrameBudgetMonitor monitor = reportMonitor();
+        for (int report = 0; report < 30; report++) {
+            mNowMs += REPORT_MS;
+            boolean spike = report % VideoChatFrameBudgetMonitor.WINDOW_REPORTS == 3;
+            monitor.onReport(FRAME_RATE, spike ? 4 : FRAME_RATE, REPORT_MS, mNowMs);
+        }
+        assertEquals(LEVEL_FULL, monitor.getLevel());
+        assertTrue(monitor.getOverBudgetCount() > 0);
+    }
+
+    @Test
+    public void reportsStepDownToTheMaxLevelOnly() {
+        VideoChatFrameBudgetMonitor monitor = reportMonitor();
+        for (int report = 0; report < 60; report++) {
+            mNowMs += REPORT_MS;
+            monitor.onReport(FRAME_RATE, 3, REPORT_MS, mNowMs);
+        }
+        assertEquals(LEVEL_REDUCED, monitor.getLevel());
+        assertEquals(1, monitor.getDowngradeCount());
+        assertEquals(1, mSteps.size());
+    }
+
+    /**
+     * Fed with stats reports and capped as VideoChatRTCManager does.
+     */
+    private VideoChatFrameBudgetMonitor reportMonitor() {
+        VideoChatFrameBudgetMonitor monitor = new VideoChatFrameBudgetMonitor(FRAME_RATE,
+                VideoChatFrameBudgetMonitor.WINDOW_REPORTS);
+        monitor.setMaxLevel(LEVEL_REDUCED);
+        monitor.setListener((oldLevel, newLevel) -> {
+            mSteps.add(oldLevel + "->" + newLevel + "@" + mNowMs / 1000);
+            monitor.setFrameRate(newLevel == LEVEL_FULL ? FRAME_RATE : REDUCED_FRAME_RATE);
+        });
+        return monitor;
+    }
+
+    private void run(SimulatedPipeline pipeline, long durationMs) {
+        long endMs = mNowMs + durationMs;
+        while (mNowMs < endMs) {
+            frame(pipeline.frameUs(mMonitor.getLevel()));
+        }
+    }
+
+    /**
+     * A frame takes its budget, or longer when the pipeline is slower than that.
+     */
+    private void frame(long frameUs) {
+        mNowMs += Math.max(frameUs, mMonitor.getBudgetUs()) / 1000;
+        mMonitor.onFrame(frameUs, mNowMs);
+    }
+
+    private long stepSecond(int index) {
+        String step = mSteps.get(index);
+        return Long.parseLong(step.substring(step.indexOf('@') + 1));
+    }
+}
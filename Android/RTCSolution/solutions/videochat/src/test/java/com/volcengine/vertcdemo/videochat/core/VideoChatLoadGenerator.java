@@ -0,0 +1,383 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.common.AbsBroadcast;
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+import com.volcengine.vertcdemo.core.net.IRequestCallback;
+import com.volcengine.vertcdemo.core.net.rts.LatencyHistogram;
+import com.volcengine.vertcdemo.videochat.bean.AudienceApplyEvent;
+import com.volcengine.vertcdemo.videochat.bean.InviteAnchorEvent;
+import com.volcengine.vertcdemo.videochat.bean.MediaOperateEvent;
+import com.volcengine.vertcdemo.videochat.bean.ReceivedInteractEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import org.robolectric.shadows.ShadowLog;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+import java.util.Random;
+import java.util.TreeMap;
+
+/**
+ * Drives thousands of {@link VideoChatLocalUser}, each a real VideoChatRTSClient, against one
+ * {@link VideoChatLocalServer}: hosts open rooms, the audience joins over a ramp, chats, applies,
+ * takes and leaves seats, drops off and resumes, hosts invite, lock seats and pair up for PK.
+ * After the run every online client's seats are compared with the server's.
+ */
+class VideoChatLoadGenerator {
+
+    static class Config {
+        int rooms = 100;
+        int audiencePerRoom = 40;
+        long rampMs = 10_000;
+        long durationMs = 60_000;
+        /*** Mean time between two actions of a client */
+        long thinkMs = 4_000;
+        /*** How long a client that dropped off stays offline */
+        long offlineMs = 3_000;
+        long minDelayMs = 20;
+        long maxDelayMs = 80;
+        long seed = 7;
+    }
+
+    static class Report {
+        int clients;
+        long requests;
+        long answered;
+        long dropped;
+        long pending;
+        long failures;
+        long notices;
+        long wallMs;
+        long virtualMs;
+        /*** Online clients in a room whose seats differ from the server's */
+        int mismatches;
+        int compared;
+        /*** Virtual ms from send to answer, by event_name */
+        final Map<String, LatencyHistogram> roundTrips = new TreeMap<>();
+        /*** Failed answers by code */
+        final Map<Integer, Integer> errors = new TreeMap<>();
+        Map<String, LatencyHistogram> handleMicros;
+
+        double requestsPerSecond() {
+            return wallMs == 0 ? 0 : requests * 1000.0 / wallMs;
+        }
+
+        String summary() {
+            StringBuilder builder = new StringBuilder(String.format(Locale.US,
+                    "signaling load: %d clients, %d requests in %dms wall (%.0f req/s) for %ds virtual, "
+                            + "%d notices, %d failed %s, %d dropped at logout, %d/%d states differ%n",
+                    clients, requests, wallMs, requestsPerSecond(), virtualMs / 1000, notices, failures,
+                    errors, dropped, mismatches, compared));
+            for (Map.Entry<String, LatencyHistogram> entry : roundTrips.entrySet()) {
+                LatencyHistogram rtt = entry.getValue();
+                LatencyHistogram handle = handleMicros.get(entry.getKey());
+                builder.append(String.format(Locale.US,
+                        "  %-24s %7d  rtt p50 %3dms p99 %3dms  server p50 %4dus p99 %5dus%n",
+                        entry.getKey(), rtt.getTotalCount(), rtt.getValueAtPercentile(50),
+                        rtt.getValueAtPercentile(99), handle == null ? 0 : handle.getValueAtPercentile(50),
+                        handle == null ? 0 : handle.getValueAtPercentile(99)));
+            }
+            return builder.toString();
+        }
+    }
+
+    private final Config mConfig;
+    private final VirtualScheduler mScheduler = new VirtualScheduler();
+    private final Random mRandom;
+    private final VideoChatLocalServer mServer;
+    private final List<VideoChatLocalUser> mHosts = new ArrayList<>();
+    /*** The audience of each room, by room index */
+    private final List<List<VideoChatLocalUser>> mAudience = new ArrayList<>();
+    private boolean mStopped;
+
+    VideoChatLoadGenerator(Config config) {
+        mConfig = config;
+        mRandom = new Random(config.seed);
+        mServer = new VideoChatLocalServer(mScheduler, mScheduler::now, config.minDelayMs, config.maxDelayMs,
+                new Random(config.seed + 1));
+    }
+
+    VideoChatLocalServer getServer() {
+        return mServer;
+    }
+
+    Report run() {
+        long startNs = System.nanoTime();
+        for (int r = 0; r < mConfig.rooms; r++) {
+            VideoChatLocalUser host = client("host_" + r);
+            host.behavior = this::onHostNotice;
+            mHosts.add(host);
+            List<VideoChatLocalUser> audience = new ArrayList<>();
+            for (int a = 0; a < mConfig.audiencePerRoom; a++) {
+                VideoChatLocalUser client = client("audience_" + r + "_" + a);
+                client.behavior = this::onAudienceNotice;
+                audience.add(client);
+            }
+            mAudience.add(audience);
+            int room = r;
+            mScheduler.schedule(() -> host.connect(() -> host.createRoom("room " + room,
+                    callback(created -> host.startLive(callback(started -> {
+                        host.reconnect(null);
+                        thinkLater(host, () -> hostAct(room, host));
+                    }))))), (long) (mRandom.nextDouble() * mConfig.rampMs / 4));
+            for (VideoChatLocalUser client : audience) {
+                mScheduler.schedule(() -> client.connect(() -> audienceJoin(room, client)),
+                        mConfig.rampMs / 4 + (long) (mRandom.nextDouble() * mConfig.rampMs));
+            }
+        }
+        runUntil(mConfig.durationMs);
+        mStopped = true;
+        runUntil(mConfig.durationMs + 10 * (mConfig.maxDelayMs + mConfig.offlineMs));
+
+        Report report = new Report();
+        report.wallMs = (System.nanoTime() - startNs) / 1_000_000;
+        report.virtualMs = mScheduler.now();
+        report.handleMicros = mServer.getHandleMicros();
+        report.failures = mServer.getFailureCount();
+        report.notices = mServer.getNoticeCount();
+        for (int r = 0; r < mHosts.size(); r++) {
+            collect(report, mHosts.get(r));
+            for (VideoChatLocalUser client : mAudience.get(r)) {
+                collect(report, client);
+            }
+        }
+        return report;
+    }
+
+    private VideoChatLocalUser client(String userId) {
+        return new VideoChatLocalUser(userId, mServer, mScheduler);
+    }
+
+    /**
+     * A virtual second at a time, dropping the log lines Robolectric keeps for every request in
+     * between.
+     */
+    private void runUntil(long timeMs) {
+        while (mScheduler.now() < timeMs) {
+            ShadowLog.reset();
+            mScheduler.runUntil(Math.min(timeMs, mScheduler.now() + 1_000));
+        }
+    }
+
+    private void collect(Report report, VideoChatLocalUser client) {
+        report.clients++;
+        report.requests += client.getSentCount();
+        report.answered += client.getAnsweredCount();
+        report.dropped += client.getDroppedCount();
+        report.pending += client.getPendingCount();
+        client.addRoundTrips(report.roundTrips);
+        for (Integer code : client.getErrorCodes()) {
+            Integer count = report.errors.get(code);
+            report.errors.put(code, count == null ? 1 : count + 1);
+        }
+        VideoChatLocalServer.Room room = client.roomId == null ? null : mServer.getRoom(client.roomId);
+        if (client.connected && room != null) {
+            report.compared++;
+            if (!describeSeats(client).equals(VideoChatLocalServer.describeSeats(room))) {
+                report.mismatches++;
+            }
+        }
+    }
+
+    /**
+     * The seats of the client in the form of {@link VideoChatLocalServer#describeSeats}.
+     */
+    static List<String> describeSeats(VideoChatLocalUser client) {
+        List<String> seats = new ArrayList<>();
+        for (int i = 1; i <= VideoChatLocalServer.SEAT_COUNT; i++) {
+            VideoChatSeatInfo seat = client.state.getSeats().get(i);
+            int status = seat == null ? VideoChatDataManager.SEAT_STATUS_UNLOCKED : seat.status;
+            String guestId = seat == null || seat.userInfo == null ? null : seat.userInfo.userId;
+            seats.add(i + ":" + status + ":" + guestId);
+        }
+        return seats;
+    }
+
+    private void audienceJoin(int room, VideoChatLocalUser client) {
+        String roomId = mHosts.get(room).roomId;
+        if (roomId == null) {
+            // The host is not live yet.
+            thinkLater(client, () -> audienceJoin(room, client));
+            return;
+        }
+        Runnable next = () -> thinkLater(client, () -> audienceAct(room, client));
+        client.joinRoom(roomId, callback(joined -> next.run(), next));
+    }
+
+    private void audienceAct(int room, VideoChatLocalUser client) {
+        if (client.roomId == null) {
+            thinkLater(client, () -> audienceJoin(room, client));
+            return;
+        }
+        int dice = mRandom.nextInt(100);
+        int seatId = seatOf(client);
+        if (dice < 45) {
+            client.sendMessage("hello from " + client.userId, null);
+        } else if (dice < 60) {
+            if (seatId > 0) {
+                client.finishInteract(seatId, null);
+            } else {
+                client.applyInteract(1 + mRandom.nextInt(VideoChatLocalServer.SEAT_COUNT), null);
+            }
+        } else if (dice < 70) {
+            if (seatId > 0) {
+                client.updateMediaStatus(mRandom.nextInt(2), mRandom.nextInt(2), null);
+            } else {
+                client.reconnect(null);
+            }
+        } else if (dice < 76) {
+            Runnable next = () -> thinkLater(client, () -> audienceAct(room, client));
+            client.leaveRoom(callback(left -> next.run(), next));
+            return;
+        } else if (dice < 80) {
+            // Drop off the network, come back and resume with the held state version.
+            client.disconnect();
+            Runnable next = () -> thinkLater(client, () -> audienceAct(room, client));
+            mScheduler.schedule(() -> client.connect(() -> client.reconnect(callback(plan -> next.run(), next))),
+                    mConfig.offlineMs);
+            return;
+        }
+        thinkLater(client, () -> audienceAct(room, client));
+    }
+
+    private void hostAct(int room, VideoChatLocalUser host) {
+        if (host.roomId == null) {
+            return;
+        }
+        int dice = mRandom.nextInt(100);
+        VideoChatLocalServer.Room state = mServer.getRoom(host.roomId);
+        boolean inPk = state != null && state.status == VideoChatRoomInfo.ROOM_STATUS_PK_ING;
+        if (dice < 30) {
+            List<VideoChatLocalUser> audience = mAudience.get(room);
+            VideoChatLocalUser guest = audience.get(mRandom.nextInt(audience.size()));
+            host.inviteInteract(guest.userId, 0, null);
+        } else if (dice < 45) {
+            int seatId = 1 + mRandom.nextInt(VideoChatLocalServer.SEAT_COUNT);
+            VideoChatSeatInfo seat = host.state.getSeats().get(seatId);
+            boolean locked = seat != null && seat.status == VideoChatDataManager.SEAT_STATUS_LOCKED;
+            host.manageSeat(seatId, locked ? VideoChatDataManager.SEAT_OPTION_UNLOCK
+                    : VideoChatDataManager.SEAT_OPTION_LOCK, null);
+        } else if (dice < 55) {
+            for (int seatId = 1; seatId <= VideoChatLocalServer.SEAT_COUNT; seatId++) {
+                VideoChatSeatInfo seat = host.state.getSeats().get(seatId);
+                if (seat != null && seat.userInfo != null) {
+                    host.manageSeat(seatId, mRandom.nextBoolean() ? VideoChatDataManager.SEAT_OPTION_MIC_OFF
+                            : VideoChatDataManager.SEAT_OPTION_END_INTERACT, null);
+                    break;
+                }
+            }
+        } else if (dice < 60) {
+            host.manageInteractApply(mRandom.nextBoolean() ? VideoChatRoomInfo.INTERACT_ON
+                    : VideoChatRoomInfo.INTERACT_OFF, null);
+        } else if (dice < 75) {
+            host.sendMessage("welcome", null);
+        } else if (dice < 85) {
+            host.reconnect(null);
+        } else if (inPk) {
+            host.finishAnchorInteract(null);
+        } else if (room % 2 == 0 && room + 1 < mHosts.size()) {
+            // Hosts pair up, the even one invites and the odd one accepts. PK needs empty seats,
+            // both lock theirs first.
+            VideoChatLocalUser peer = mHosts.get(room + 1);
+            if (peer.roomId != null) {
+                lockAll(host);
+                lockAll(peer);
+                mScheduler.schedule(() -> {
+                    if (!mStopped && peer.roomId != null) {
+                        host.inviteAnchor(peer.roomId, peer.userId, null);
+                    }
+                }, mConfig.maxDelayMs * 4);
+            }
+        }
+        thinkLater(host, () -> hostAct(room, host));
+    }
+
+    private void onHostNotice(VideoChatLocalUser host, Object notice) {
+        if (mStopped) {
+            return;
+        }
+        if (notice instanceof AudienceApplyEvent) {
+            VideoChatUserInfo audience = ((AudienceApplyEvent) notice).userInfo;
+            host.agreeApply(audience.userId, null);
+        } else if (notice instanceof InviteAnchorEvent) {
+            InviteAnchorEvent invite = (InviteAnchorEvent) notice;
+            host.replyAnchor(invite.fromRoomId, invite.fromUserId, VideoChatDataManager.REPLY_TYPE_ACCEPT, null);
+        }
+    }
+
+    private void onAudienceNotice(VideoChatLocalUser client, Object notice) {
+        if (mStopped) {
+            return;
+        }
+        if (notice instanceof ReceivedInteractEvent) {
+            int reply = mRandom.nextInt(4) == 0 ? VideoChatDataManager.REPLY_TYPE_REJECT
+                    : VideoChatDataManager.REPLY_TYPE_ACCEPT;
+            client.replyInvite(reply, ((ReceivedInteractEvent) notice).seatId, null);
+        } else if (notice instanceof MediaOperateEvent) {
+            client.updateMediaStatus(((MediaOperateEvent) notice).mic, VideoChatUserInfo.CAMERA_STATUS_ON, null);
+        }
+    }
+
+    private static void lockAll(VideoChatLocalUser host) {
+        for (int seatId = 1; seatId <= VideoChatLocalServer.SEAT_COUNT; seatId++) {
+            host.manageSeat(seatId, VideoChatDataManager.SEAT_OPTION_LOCK, null);
+        }
+    }
+
+    private static int seatOf(VideoChatLocalUser client) {
+        for (Map.Entry<Integer, VideoChatSeatInfo> entry : client.state.getSeats().entrySet()) {
+            VideoChatSeatInfo seat = entry.getValue();
+            if (seat != null && seat.userInfo != null && client.userId.equals(seat.userInfo.userId)) {
+                return entry.getKey();
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Next action of the client after an exponential think time, none once the run stopped.
+     */
+    private void thinkLater(VideoChatLocalUser client, Runnable action) {
+        if (mStopped) {
+            return;
+        }
+        long delayMs = 1 + (long) (-Math.log(1 - mRandom.nextDouble()) * mConfig.thinkMs);
+        mScheduler.schedule(() -> {
+            if (!mStopped && client.connected) {
+                action.run();
+            }
+        }, delayMs);
+    }
+
+    private static <T> IRequestCallback<T> callback(AbsBroadcast.On<T> onSuccess) {
+        return callback(onSuccess, null);
+    }
+
+    /**
+     * @param onError the script going on after a failed answer, the code is in the report
+     */
+    private static <T> IRequestCallback<T> callback(AbsBroadcast.On<T> onSuccess, @Nullable Runnable onError) {
+        return new IRequestCallback<T>() {
+            @Override
+            public void onSuccess(T data) {
+                onSuccess.on(data);
+            }
+
+            @Override
+            public void onError(int errorCode, String message) {
+                if (onError != null) {
+                    onError.run();
+                }
+            }
+        };
+    }
+}
@@ -0,0 +1,988 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static com.ss.bytertc.engine.type.UserMessageSendResult.USER_MESSAGE_SEND_RESULT_NOT_LOGIN;
+import static com.ss.bytertc.engine.type.UserMessageSendResult.USER_MESSAGE_SEND_RESULT_SUCCESS;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+
+import com.google.gson.JsonArray;
+import com.google.gson.JsonElement;
+import com.google.gson.JsonObject;
+import com.google.gson.JsonParser;
+import com.ss.bytertc.engine.type.LoginErrorCode;
+import com.volcengine.vertcdemo.common.Clock;
+import com.volcengine.vertcdemo.common.Scheduler;
+import com.volcengine.vertcdemo.core.net.ServerResponse;
+import com.volcengine.vertcdemo.core.net.rts.LatencyHistogram;
+import com.volcengine.vertcdemo.core.net.rts.RTSBaseClient;
+import com.volcengine.vertcdemo.core.net.rts.RTSTransport;
+import com.volcengine.vertcdemo.videochat.bean.FinishLiveEvent;
+import com.volcengine.vertcdemo.videochat.bean.InteractChangedEvent;
+import com.volcengine.vertcdemo.videochat.bean.JoinRoomEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.LinkedHashMap;
+import java.util.LinkedHashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+import java.util.Set;
+
+/**
+ * Single threaded stand-in of the video chat business server: the vi* requests and notices on
+ * the RTS wire format, with rooms, seats, audience apply and host invite, and anchor PK.
+ *
+ * Every client connects through a {@link Link}, the {@link RTSTransport} of a VideoChatRTSClient.
+ * Messages take a random delay each way on the scheduler and stay in order per link, as they do
+ * on one RTS connection.
+ */
+class VideoChatLocalServer {
+
+    static final String UID_SERVER = "server";
+    static final int SEAT_COUNT = 6;
+
+    static final int CODE_OK = 200;
+    static final int CODE_BAD_REQUEST = 400;
+    static final int CODE_USER_NOT_FOUND = 404;
+    static final int CODE_PERMISSION_DENIED = 416;
+    static final int CODE_USER_LEFT = 419;
+    static final int CODE_ROOM_CLOSED = 422;
+    static final int CODE_SEATS_FULL = 506;
+    static final int CODE_INTERACT_ENDED = 611;
+    static final int CODE_HOST_BUSY = 622;
+    static final int CODE_GUEST_IN_ROOM = 643;
+    static final int CODE_HOST_IN_ROOM = 644;
+    static final int CODE_WAITING_REPLY = 645;
+
+    /**
+     * What the SDK reports to RTSBaseClient, {@link #to(RTSBaseClient)} for a real client.
+     */
+    interface Receiver {
+        void onLoginResult(String uid, int code, int elapsed);
+
+        void onServerParamsSetResult(int error);
+
+        void onServerMessageSendResult(long messageId, int error);
+
+        void onMessageReceived(String uid, String message);
+    }
+
+    static Receiver to(RTSBaseClient client) {
+        return new Receiver() {
+            @Override
+            public void onLoginResult(String uid, int code, int elapsed) {
+                client.onLoginResult(uid, code, elapsed);
+            }
+
+            @Override
+            public void onServerParamsSetResult(int error) {
+                client.onServerParamsSetResult(error);
+            }
+
+            @Override
+            public void onServerMessageSendResult(long messageId, int error) {
+                client.onServerMessageSendResult(messageId, error);
+            }
+
+            @Override
+            public void onMessageReceived(String uid, String message) {
+                client.onMessageReceived(uid, message);
+            }
+        };
+    }
+
+    /**
+     * One RTS connection of a user.
+     */
+    class Link implements RTSTransport {
+        private Receiver mReceiver;
+        @Nullable
+        private String mUserId;
+        private boolean mLoggedIn;
+        private long mNextMessageId;
+        private long mLastUpAt;
+        private long mLastDownAt;
+
+        /**
+         * Set once the client on the link exists, before it logs in.
+         */
+        void attach(@NonNull Receiver receiver) {
+            mReceiver = receiver;
+        }
+
+        @Override
+        public void login(@NonNull String token, @NonNull String userId) {
+            mUserId = userId;
+            mLoggedIn = true;
+            down(() -> mReceiver.onLoginResult(userId, LoginErrorCode.LOGIN_ERROR_CODE_SUCCESS, 0), false);
+        }
+
+        @Override
+        public void logout() {
+            mLoggedIn = false;
+            if (mUserId != null && mLinks.get(mUserId) == this) {
+                mLinks.remove(mUserId);
+            }
+        }
+
+        @Override
+        public void setServerParams(@NonNull String signature, @NonNull String url) {
+            if (mUserId != null) {
+                mLinks.put(mUserId, this);
+            }
+            down(() -> mReceiver.onServerParamsSetResult(CODE_OK), false);
+        }
+
+        @Override
+        public long sendServerMessage(@NonNull String message) {
+            final long messageId = ++mNextMessageId;
+            if (!mLoggedIn) {
+                down(() -> mReceiver.onServerMessageSendResult(messageId, USER_MESSAGE_SEND_RESULT_NOT_LOGIN), true);
+                return messageId;
+            }
+            final String userId = mUserId;
+            long at = Math.max(mClock.now() + delay(), mLastUpAt);
+            mLastUpAt = at;
+            mScheduler.schedule(() -> {
+                onRequest(this, userId, message);
+                down(() -> mReceiver.onServerMessageSendResult(messageId, USER_MESSAGE_SEND_RESULT_SUCCESS), false);
+            }, at - mClock.now());
+            return messageId;
+        }
+
+        boolean isLoggedIn() {
+            return mLoggedIn;
+        }
+
+        void send(String message) {
+            down(() -> mReceiver.onMessageReceived(UID_SERVER, message), false);
+        }
+
+        /**
+         * @param loggedOut also delivered after logout, as the SDK does for a send refused
+         */
+        private void down(Runnable delivery, boolean loggedOut) {
+            long at = Math.max(mClock.now() + delay(), mLastDownAt);
+            mLastDownAt = at;
+            mScheduler.schedule(() -> {
+                if (mLoggedIn || loggedOut) {
+                    delivery.run();
+                }
+            }, at - mClock.now());
+        }
+    }
+
+    static final class User {
+        final String userId;
+        String userName = "";
+        @Nullable
+        String roomId;
+        int role = VideoChatUserInfo.USER_ROLE_AUDIENCE;
+        int status = VideoChatUserInfo.USER_STATUS_NORMAL;
+        int mic = VideoChatUserInfo.MIC_STATUS_ON;
+        int camera = VideoChatUserInfo.CAMERA_STATUS_ON;
+
+        User(String userId) {
+            this.userId = userId;
+        }
+    }
+
+    static final class Seat {
+        int status = VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+        @Nullable
+        String guestId;
+    }
+
+    static final class Room {
+        final String roomId;
+        final String hostId;
+        String roomName = "";
+        int status = VideoChatRoomInfo.ROOM_STATUS_CREATED;
+        int applySwitch = VideoChatRoomInfo.INTERACT_ON;
+        final long startTime = System.currentTimeMillis();
+        long stateVersion = 1;
+        /*** Host first, then the audience in join order */
+        final Set<String> members = new LinkedHashSet<>();
+        final Seat[] seats = new Seat[SEAT_COUNT + 1];
+        /*** Audience user id -> seat id asked for */
+        final Map<String, Integer> applies = new LinkedHashMap<>();
+        final Map<String, Integer> invites = new LinkedHashMap<>();
+        /*** Room of the other host in PK, or of the host waiting for our reply */
+        @Nullable
+        String pkRoomId;
+        @Nullable
+        String anchorInviteFrom;
+
+        Room(String roomId, String hostId) {
+            this.roomId = roomId;
+            this.hostId = hostId;
+            for (int i = 1; i <= SEAT_COUNT; i++) {
+                seats[i] = new Seat();
+            }
+        }
+
+        int audienceCount() {
+            return members.size() - 1;
+        }
+
+        int seatOf(String userId) {
+            for (int i = 1; i <= SEAT_COUNT; i++) {
+                if (userId.equals(seats[i].guestId)) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        boolean hasGuests() {
+            for (int i = 1; i <= SEAT_COUNT; i++) {
+                if (seats[i].guestId != null) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    private static final class Failure extends RuntimeException {
+        final int code;
+
+        Failure(int code, String message) {
+            super(message, null, false, false);
+            this.code = code;
+        }
+    }
+
+    private final Scheduler mScheduler;
+    private final Clock mClock;
+    private final long mMinDelayMs;
+    private final long mMaxDelayMs;
+    private final Random mRandom;
+
+    private final Map<String, Link> mLinks = new HashMap<>();
+    private final Map<String, User> mUsers = new HashMap<>();
+    private final Map<String, Room> mRooms = new LinkedHashMap<>();
+    private final Map<String, LatencyHistogram> mHandleMicros = new HashMap<>();
+    private int mNextRoomId;
+    private long mRequests;
+    private long mFailures;
+    private long mNotices;
+
+    /**
+     * @param minDelayMs one way delay of every message, picked between min and max
+     */
+    VideoChatLocalServer(Scheduler scheduler, Clock clock,
+                         long minDelayMs, long maxDelayMs, Random random) {
+        mScheduler = scheduler;
+        mClock = clock;
+        mMinDelayMs = minDelayMs;
+        mMaxDelayMs = maxDelayMs;
+        mRandom = random;
+    }
+
+    Link connect() {
+        return new Link();
+    }
+
+    @Nullable
+    Room getRoom(String roomId) {
+        return mRooms.get(roomId);
+    }
+
+    @Nullable
+    User getUser(String userId) {
+        return mUsers.get(userId);
+    }
+
+    int getRoomCount() {
+        return mRooms.size();
+    }
+
+    long getRequestCount() {
+        return mRequests;
+    }
+
+    long getFailureCount() {
+        return mFailures;
+    }
+
+    long getNoticeCount() {
+        return mNotices;
+    }
+
+    /**
+     * Wall clock time the server spent on each event_name, in µs.
+     */
+    Map<String, LatencyHistogram> getHandleMicros() {
+        return mHandleMicros;
+    }
+
+    private long delay() {
+        return mMinDelayMs + (mMaxDelayMs > mMinDelayMs ? (long) (mRandom.nextDouble() * (mMaxDelayMs - mMinDelayMs)) : 0);
+    }
+
+    private void onRequest(Link link, String userId, String message) {
+        long startNs = System.nanoTime();
+        mRequests++;
+        JsonObject request;
+        String eventName = "";
+        String requestId = "";
+        try {
+            request = new JsonParser().parse(message).getAsJsonObject();
+            eventName = string(request, "event_name");
+            requestId = string(request, "request_id");
+        } catch (RuntimeException e) {
+            mFailures++;
+            return;
+        }
+        User user = mUsers.get(userId);
+        if (user == null) {
+            user = new User(userId);
+            mUsers.put(userId, user);
+        }
+        JsonObject answer = new JsonObject();
+        answer.addProperty("message_type", ServerResponse.MESSAGE_TYPE_RETURN);
+        answer.addProperty("request_id", requestId);
+        answer.addProperty("timestamp", mClock.now());
+        try {
+            JsonElement content = new JsonParser().parse(string(request, "content"));
+            JsonObject response = handle(eventName, user,
+                    content.isJsonObject() ? content.getAsJsonObject() : new JsonObject());
+            answer.addProperty("code", CODE_OK);
+            answer.addProperty("message", "ok");
+            answer.add("response", response);
+        } catch (Failure failure) {
+            mFailures++;
+            answer.addProperty("code", failure.code);
+            answer.addProperty("message", failure.getMessage());
+        } catch (RuntimeException e) {
+            mFailures++;
+            answer.addProperty("code", CODE_BAD_REQUEST);
+            answer.addProperty("message", String.valueOf(e));
+        }
+        link.send(answer.toString());
+        LatencyHistogram histogram = mHandleMicros.get(eventName);
+        if (histogram == null) {
+            histogram = new LatencyHistogram();
+            mHandleMicros.put(eventName, histogram);
+        }
+        histogram.record((System.nanoTime() - startNs) / 1000);
+    }
+
+    private JsonObject handle(String eventName, User user, JsonObject content) {
+        switch (eventName) {
+            case "viCreateRoom":
+                return createRoom(user, content);
+            case "viStartLive":
+                hostedRoom(user).status = VideoChatRoomInfo.ROOM_STATUS_LIVING;
+                bump(hostedRoom(user));
+                return new JsonObject();
+            case "viJoinLiveRoom":
+                return joinRoom(user, content);
+            case "viLeaveLiveRoom":
+                leaveRoom(user);
+                return new JsonObject();
+            case "viFinishLive":
+                finishRoom(hostedRoom(user));
+                return new JsonObject();
+            case "viGetAudienceList":
+                return audienceList(roomOf(user).members, roomOf(user).hostId);
+            case "viGetApplyAudienceList":
+                return audienceList(hostedRoom(user).applies.keySet(), null);
+            case "viManageInteractApply":
+                hostedRoom(user).applySwitch = integer(content, "type");
+                return new JsonObject();
+            case "viInviteInteract":
+                return inviteInteract(user, content);
+            case "viReplyInvite":
+                return replyInvite(user, content);
+            case "viApplyInteract":
+                return applyInteract(user, content);
+            case "viAgreeApply":
+                return agreeApply(user, content);
+            case "viFinishInteract":
+                freeSeat(roomOf(user), user, InteractChangedEvent.FINISH_INTERACT_TYPE_SELF);
+                return new JsonObject();
+            case "viManageSeat":
+                manageSeat(user, content);
+                return new JsonObject();
+            case "viUpdateMediaStatus":
+                updateMedia(user, content);
+                return new JsonObject();
+            case "viSendMessage":
+                return sendMessage(user, content);
+            case "viReconnect":
+                return reconnect(user, content);
+            case "viGetActiveLiveRoomList":
+                return activeRooms(content);
+            case "viGetAnchorList":
+                return anchors(user);
+            case "viInviteAnchor":
+                return inviteAnchor(user, content);
+            case "viReplyAnchor":
+                return replyAnchor(user, content);
+            case "viFinishAnchorInteract":
+                finishPk(hostedRoom(user), user.userId);
+                return new JsonObject();
+            default:
+                throw new Failure(CODE_BAD_REQUEST, "unknown event " + eventName);
+        }
+    }
+
+    private JsonObject createRoom(User host, JsonObject content) {
+        leaveRoom(host);
+        Room room = new Room("local_room_" + (++mNextRoomId), host.userId);
+        room.roomName = string(content, "room_name");
+        host.userName = string(content, "user_name");
+        host.roomId = room.roomId;
+        host.role = VideoChatUserInfo.USER_ROLE_HOST;
+        host.status = VideoChatUserInfo.USER_STATUS_NORMAL;
+        room.members.add(host.userId);
+        mRooms.put(room.roomId, room);
+        JsonObject response = new JsonObject();
+        response.add("room_info", roomJson(room));
+        response.add("user_info", userJson(host));
+        response.addProperty("rtc_token", "token_" + room.roomId + "_" + host.userId);
+        return response;
+    }
+
+    private JsonObject joinRoom(User user, JsonObject content) {
+        Room room = mRooms.get(string(content, "room_id"));
+        if (room == null || room.status == VideoChatRoomInfo.ROOM_STATUS_FINISHED) {
+            throw new Failure(CODE_ROOM_CLOSED, "room closed");
+        }
+        if (!room.roomId.equals(user.roomId)) {
+            leaveRoom(user);
+            user.userName = string(content, "user_name");
+            user.roomId = room.roomId;
+            user.role = VideoChatUserInfo.USER_ROLE_AUDIENCE;
+            user.status = VideoChatUserInfo.USER_STATUS_NORMAL;
+            room.members.add(user.userId);
+            bump(room);
+            JsonObject data = new JsonObject();
+            data.add("user_info", userJson(user));
+            data.addProperty("audience_count", room.audienceCount());
+            notifyRoom(room, "viOnAudienceJoinRoom", data, user.userId);
+        }
+        return snapshot(room, user);
+    }
+
+    private void leaveRoom(User user) {
+        Room room = user.roomId == null ? null : mRooms.get(user.roomId);
+        if (room == null) {
+            user.roomId = null;
+            return;
+        }
+        if (room.hostId.equals(user.userId)) {
+            finishRoom(room);
+            return;
+        }
+        if (room.seatOf(user.userId) > 0) {
+            freeSeat(room, user, InteractChangedEvent.FINISH_INTERACT_TYPE_SELF);
+        }
+        room.applies.remove(user.userId);
+        room.invites.remove(user.userId);
+        room.members.remove(user.userId);
+        user.roomId = null;
+        user.status = VideoChatUserInfo.USER_STATUS_NORMAL;
+        bump(room);
+        JsonObject data = new JsonObject();
+        data.add("user_info", userJson(user));
+        data.addProperty("audience_count", room.audienceCount());
+        notifyRoom(room, "viOnAudienceLeaveRoom", data, null);
+    }
+
+    private void finishRoom(Room room) {
+        if (room.pkRoomId != null) {
+            finishPk(room, room.hostId);
+        }
+        room.status = VideoChatRoomInfo.ROOM_STATUS_FINISHED;
+        JsonObject data = new JsonObject();
+        data.addProperty("room_id", room.roomId);
+        data.addProperty("type", FinishLiveEvent.FINISH_TYPE_NORMAL);
+        notifyRoom(room, "viOnFinishLive", data, room.hostId);
+        for (String memberId : room.members) {
+            User member = mUsers.get(memberId);
+            member.roomId = null;
+            member.status = VideoChatUserInfo.USER_STATUS_NORMAL;
+            member.role = VideoChatUserInfo.USER_ROLE_AUDIENCE;
+        }
+        mRooms.remove(room.roomId);
+    }
+
+    private JsonObject reconnect(User user, JsonObject content) {
+        Room room = roomOf(user);
+        if (content.has("state_version") && integer(content, "state_version") == room.stateVersion) {
+            JsonObject response = new JsonObject();
+            response.addProperty("sync_type", JoinRoomEvent.SYNC_TYPE_NONE);
+            response.addProperty("state_version", room.stateVersion);
+            return response;
+        }
+        return snapshot(room, user);
+    }
+
+    private JsonObject audienceList(Iterable<String> userIds, @Nullable String exceptId) {
+        JsonArray list = new JsonArray();
+        for (String userId : userIds) {
+            if (!userId.equals(exceptId)) {
+                list.add(userJson(mUsers.get(userId)));
+            }
+        }
+        JsonObject response = new JsonObject();
+        response.add("audience_list", list);
+        return response;
+    }
+
+    private JsonObject activeRooms(JsonObject content) {
+        int pageSize = content.has("page_size") ? integer(content, "page_size") : Integer.MAX_VALUE;
+        JsonArray list = new JsonArray();
+        boolean hasMore = false;
+        for (Room room : mRooms.values()) {
+            if (room.status == VideoChatRoomInfo.ROOM_STATUS_CREATED) {
+                continue;
+            }
+            if (list.size() == pageSize) {
+                hasMore = true;
+                break;
+            }
+            list.add(roomJson(room));
+        }
+        JsonObject response = new JsonObject();
+        response.add("room_list", list);
+        response.addProperty("has_more", hasMore);
+        return response;
+    }
+
+    private JsonObject sendMessage(User user, JsonObject content) {
+        Room room = roomOf(user);
+        JsonObject data = new JsonObject();
+        data.add("user_info", userJson(user));
+        data.addProperty("message", string(content, "message"));
+        if (content.has("message_id")) {
+            data.addProperty("message_id", string(content, "message_id"));
+        }
+        notifyRoom(room, "viOnMessage", data, null);
+        return new JsonObject();
+    }
+
+    private JsonObject inviteInteract(User host, JsonObject content) {
+        Room room = hostedRoom(host);
+        User audience = memberOf(room, string(content, "audience_user_id"));
+        if (room.pkRoomId != null) {
+            throw new Failure(CODE_HOST_IN_ROOM, "in PK");
+        }
+        if (room.seatOf(audience.userId) > 0) {
+            throw new Failure(CODE_BAD_REQUEST, "already on a seat");
+        }
+        if (room.invites.containsKey(audience.userId)) {
+            throw new Failure(CODE_WAITING_REPLY, "invite pending");
+        }
+        int seatId = freeSeat(room, integer(content, "seat_id"));
+        room.invites.put(audience.userId, seatId);
+        audience.status = VideoChatUserInfo.USER_STATUS_INVITING;
+        JsonObject data = new JsonObject();
+        data.add("host_info", userJson(host));
+        data.addProperty("seat_id", seatId);
+        notifyUser(audience.userId, "viOnInviteInteract", data);
+        return new JsonObject();
+    }
+
+    private JsonObject replyInvite(User audience, JsonObject content) {
+        Room room = roomOf(audience);
+        Integer invitedSeat = room.invites.remove(audience.userId);
+        if (invitedSeat == null) {
+            throw new Failure(CODE_INTERACT_ENDED, "no invite");
+        }
+        int reply = integer(content, "reply");
+        if (reply == VideoChatDataManager.REPLY_TYPE_ACCEPT) {
+            takeSeat(room, audience, content.has("seat_id") ? integer(content, "seat_id") : invitedSeat);
+        } else {
+            audience.status = VideoChatUserInfo.USER_STATUS_NORMAL;
+        }
+        JsonObject data = new JsonObject();
+        data.addProperty("reply", reply);
+        data.add("user_info", userJson(audience));
+        notifyUser(room.hostId, "viOnInviteResult", data);
+        JsonObject response = new JsonObject();
+        response.add("user_info", userJson(audience));
+        return response;
+    }
+
+    private JsonObject applyInteract(User audience, JsonObject content) {
+        Room room = roomOf(audience);
+        if (room.hostId.equals(audience.userId) || room.seatOf(audience.userId) > 0) {
+            throw new Failure(CODE_BAD_REQUEST, "already on a seat");
+        }
+        if (room.pkRoomId != null) {
+            throw new Failure(CODE_HOST_IN_ROOM, "in PK");
+        }
+        int seatId = freeSeat(room, integer(content, "seat_id"));
+        JsonObject response = new JsonObject();
+        if (room.applySwitch == VideoChatRoomInfo.INTERACT_ON) {
+            room.applies.put(audience.userId, seatId);
+            audience.status = VideoChatUserInfo.USER_STATUS_APPLYING;
+            JsonObject data = new JsonObject();
+            data.add("user_info", userJson(audience));
+            data.addProperty("seat_id", seatId);
+            notifyUser(room.hostId, "viOnApplyInteract", data);
+            response.addProperty("is_need_apply", true);
+        } else {
+            takeSeat(room, audience, seatId);
+            response.addProperty("is_need_apply", false);
+        }
+        return response;
+    }
+
+    private JsonObject agreeApply(User host, JsonObject content) {
+        Room room = hostedRoom(host);
+        User audience = memberOf(room, string(content, "audience_user_id"));
+        Integer seatId = room.applies.remove(audience.userId);
+        if (seatId == null) {
+            throw new Failure(CODE_INTERACT_ENDED, "no apply");
+        }
+        takeSeat(room, audience, seatId);
+        return new JsonObject();
+    }
+
+    private void manageSeat(User host, JsonObject content) {
+        Room room = hostedRoom(host);
+        int seatId = integer(content, "seat_id");
+        if (seatId < 1 || seatId > SEAT_COUNT) {
+            throw new Failure(CODE_BAD_REQUEST, "no seat " + seatId);
+        }
+        Seat seat = room.seats[seatId];
+        User guest = seat.guestId == null ? null : mUsers.get(seat.guestId);
+        switch (integer(content, "type")) {
+            case VideoChatDataManager.SEAT_OPTION_LOCK:
+            case VideoChatDataManager.SEAT_OPTION_UNLOCK:
+                boolean lock = integer(content, "type") == VideoChatDataManager.SEAT_OPTION_LOCK;
+                if (lock && guest != null) {
+                    freeSeat(room, guest, InteractChangedEvent.FINISH_INTERACT_TYPE_HOST);
+                }
+                seat.status = lock ? VideoChatDataManager.SEAT_STATUS_LOCKED : VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+                bump(room);
+                JsonObject data = new JsonObject();
+                data.addProperty("seat_id", seatId);
+                data.addProperty("type", seat.status);
+                notifyRoom(room, "viOnSeatStatusChange", data, null);
+                break;
+            case VideoChatDataManager.SEAT_OPTION_MIC_OFF:
+            case VideoChatDataManager.SEAT_OPTION_MIC_ON:
+                if (guest == null) {
+                    throw new Failure(CODE_USER_NOT_FOUND, "seat " + seatId + " is empty");
+                }
+                // The guest applies it with viUpdateMediaStatus.
+                JsonObject operate = new JsonObject();
+                operate.addProperty("mic", integer(content, "type") == VideoChatDataManager.SEAT_OPTION_MIC_ON
+                        ? VideoChatUserInfo.MIC_STATUS_ON : VideoChatUserInfo.MIC_STATUS_OFF);
+                notifyUser(guest.userId, "viOnMediaOperate", operate);
+                break;
+            case VideoChatDataManager.SEAT_OPTION_END_INTERACT:
+                if (guest == null) {
+                    throw new Failure(CODE_USER_NOT_FOUND, "seat " + seatId + " is empty");
+                }
+                freeSeat(room, guest, InteractChangedEvent.FINISH_INTERACT_TYPE_HOST);
+                break;
+            default:
+                throw new Failure(CODE_BAD_REQUEST, "seat option " + integer(content, "type"));
+        }
+    }
+
+    private void updateMedia(User user, JsonObject content) {
+        Room room = roomOf(user);
+        user.mic = integer(content, "mic");
+        user.camera = integer(content, "camera");
+        bump(room);
+        JsonObject data = new JsonObject();
+        data.add("user_info", userJson(user));
+        data.addProperty("mic", user.mic);
+        data.addProperty("camera", user.camera);
+        notifyRoom(room, "viOnMediaStatusChange", data, null);
+    }
+
+    /**
+     * @return the seat asked for, or the first free one if it is taken or 0
+     */
+    private int freeSeat(Room room, int seatId) {
+        if (seatId >= 1 && seatId <= SEAT_COUNT && room.seats[seatId].guestId == null
+                && room.seats[seatId].status == VideoChatDataManager.SEAT_STATUS_UNLOCKED) {
+            return seatId;
+        }
+        for (int i = 1; i <= SEAT_COUNT; i++) {
+            if (room.seats[i].guestId == null && room.seats[i].status == VideoChatDataManager.SEAT_STATUS_UNLOCKED) {
+                return i;
+            }
+        }
+        throw new Failure(CODE_SEATS_FULL, "seats full");
+    }
+
+    private void takeSeat(Room room, User user, int seatId) {
+        seatId = freeSeat(room, seatId);
+        room.applies.remove(user.userId);
+        room.invites.remove(user.userId);
+        room.seats[seatId].guestId = user.userId;
+        user.status = VideoChatUserInfo.USER_STATUS_INTERACT;
+        bump(room);
+        JsonObject data = new JsonObject();
+        data.add("user_info", userJson(user));
+        data.addProperty("seat_id", seatId);
+        notifyRoom(room, "viOnJoinInteract", data, null);
+    }
+
+    private void freeSeat(Room room, User user, int type) {
+        int seatId = room.seatOf(user.userId);
+        if (seatId < 0) {
+            throw new Failure(CODE_USER_LEFT, "not on a seat");
+        }
+        room.seats[seatId].guestId = null;
+        user.status = VideoChatUserInfo.USER_STATUS_NORMAL;
+        bump(room);
+        JsonObject data = new JsonObject();
+        data.add("user_info", userJson(user));
+        data.addProperty("seat_id", seatId);
+        data.addProperty("type", type);
+        notifyRoom(room, "viOnFinishInteract", data, null);
+    }
+
+    private JsonObject anchors(User user) {
+        JsonArray list = new JsonArray();
+        for (Room room : mRooms.values()) {
+            if (room.status == VideoChatRoomInfo.ROOM_STATUS_LIVING && !room.hostId.equals(user.userId)) {
+                list.add(userJson(mUsers.get(room.hostId)));
+            }
+        }
+        JsonObject response = new JsonObject();
+        response.add("anchor_list", list);
+        return response;
+    }
+
+    private JsonObject inviteAnchor(User inviter, JsonObject content) {
+        Room room = hostedRoom(inviter);
+        Room peer = mRooms.get(string(content, "invitee_room_id"));
+        if (peer == null || peer == room || peer.status == VideoChatRoomInfo.ROOM_STATUS_FINISHED) {
+            throw new Failure(CODE_ROOM_CLOSED, "room closed");
+        }
+        if (room.pkRoomId != null || peer.pkRoomId != null) {
+            throw new Failure(CODE_HOST_BUSY, "host busy");
+        }
+        if (room.hasGuests() || peer.hasGuests()) {
+            throw new Failure(CODE_GUEST_IN_ROOM, "guest in room");
+        }
+        if (peer.anchorInviteFrom != null) {
+            throw new Failure(CODE_WAITING_REPLY, "invite pending");
+        }
+        peer.anchorInviteFrom = room.roomId;
+        JsonObject data = new JsonObject();
+        data.addProperty("from_room_id", room.roomId);
+        data.addProperty("from_user_id", inviter.userId);
+        data.addProperty("from_user_name", inviter.userName);
+        notifyUser(peer.hostId, "viOnAnchorInvite", data);
+        return new JsonObject();
+    }
+
+    private JsonObject replyAnchor(User invitee, JsonObject content) {
+        Room room = hostedRoom(invitee);
+        String inviterRoomId = string(content, "inviter_room_id");
+        Room inviterRoom = mRooms.get(inviterRoomId);
+        if (!inviterRoomId.equals(room.anchorInviteFrom) || inviterRoom == null) {
+            room.anchorInviteFrom = null;
+            throw new Failure(CODE_INTERACT_ENDED, "no invite");
+        }
+        room.anchorInviteFrom = null;
+        User inviter = mUsers.get(inviterRoom.hostId);
+        int reply = integer(content, "reply");
+        JsonArray interactInfos = new JsonArray();
+        JsonObject data = new JsonObject();
+        data.addProperty("to_room_id", room.roomId);
+        data.addProperty("to_user_id", invitee.userId);
+        data.addProperty("to_user_name", invitee.userName);
+        data.addProperty("reply", reply);
+        if (reply == VideoChatDataManager.REPLY_TYPE_ACCEPT) {
+            if (inviterRoom.pkRoomId != null || room.hasGuests() || inviterRoom.hasGuests()) {
+                throw new Failure(CODE_HOST_BUSY, "host busy");
+            }
+            room.pkRoomId = inviterRoom.roomId;
+            inviterRoom.pkRoomId = room.roomId;
+            room.status = VideoChatRoomInfo.ROOM_STATUS_PK_ING;
+            inviterRoom.status = VideoChatRoomInfo.ROOM_STATUS_PK_ING;
+            bump(room);
+            bump(inviterRoom);
+            data.add("interact_info", interactJson(invitee, inviterRoom));
+            interactInfos.add(interactJson(inviter, room));
+            notifyRoom(room, "viOnNewAnchorJoin", userJson(inviter), invitee.userId);
+            notifyRoom(inviterRoom, "viOnNewAnchorJoin", userJson(invitee), inviter.userId);
+        }
+        notifyUser(inviter.userId, "viOnAnchorReply", data);
+        JsonObject response = new JsonObject();
+        response.add("interact_info_list", interactInfos);
+        return response;
+    }
+
+    private void finishPk(Room room, String byUserId) {
+        Room peer = room.pkRoomId == null ? null : mRooms.get(room.pkRoomId);
+        if (peer == null) {
+            throw new Failure(CODE_INTERACT_ENDED, "not in PK");
+        }
+        for (Room each : new Room[]{room, peer}) {
+            each.pkRoomId = null;
+            each.status = VideoChatRoomInfo.ROOM_STATUS_LIVING;
+            bump(each);
+            notifyRoom(each, "viOnAnchorInteractFinish", new JsonObject(), byUserId);
+        }
+    }
+
+    private JsonObject snapshot(Room room, User user) {
+        JsonObject response = new JsonObject();
+        response.add("room_info", roomJson(room));
+        response.add("user_info", userJson(user));
+        response.add("host_info", userJson(mUsers.get(room.hostId)));
+        response.addProperty("rtc_token", "token_" + room.roomId + "_" + user.userId);
+        JsonObject seats = new JsonObject();
+        for (int i = 1; i <= SEAT_COUNT; i++) {
+            JsonObject seat = new JsonObject();
+            seat.addProperty("status", room.seats[i].status);
+            String guestId = room.seats[i].guestId;
+            if (guestId != null) {
+                seat.add("guest_info", userJson(mUsers.get(guestId)));
+            }
+            seats.add(String.valueOf(i), seat);
+        }
+        response.add("seat_list", seats);
+        response.addProperty("audience_count", room.audienceCount());
+        JsonArray anchors = new JsonArray();
+        Room peer = room.pkRoomId == null ? null : mRooms.get(room.pkRoomId);
+        if (peer != null) {
+            anchors.add(userJson(mUsers.get(room.hostId)));
+            anchors.add(userJson(mUsers.get(peer.hostId)));
+        }
+        response.add("anchor_list", anchors);
+        response.addProperty("state_version", room.stateVersion);
+        response.addProperty("sync_type", JoinRoomEvent.SYNC_TYPE_FULL);
+        return response;
+    }
+
+    private JsonObject roomJson(Room room) {
+        User host = mUsers.get(room.hostId);
+        JsonObject json = new JsonObject();
+        json.addProperty("app_id", "local");
+        json.addProperty("room_id", room.roomId);
+        json.addProperty("room_name", room.roomName);
+        json.addProperty("host_user_id", room.hostId);
+        json.addProperty("host_user_name", host == null ? "" : host.userName);
+        json.addProperty("status", room.status);
+        json.addProperty("enable_audience_interact_apply", room.applySwitch);
+        json.addProperty("start_time", room.startTime);
+        json.addProperty("audience_count", room.audienceCount());
+        return json;
+    }
+
+    private static JsonObject userJson(User user) {
+        JsonObject json = new JsonObject();
+        json.addProperty("room_id", user.roomId == null ? "" : user.roomId);
+        json.addProperty("user_id", user.userId);
+        json.addProperty("user_name", user.userName);
+        json.addProperty("user_role", user.role);
+        json.addProperty("status", user.status);
+        json.addProperty("mic", user.mic);
+        json.addProperty("camera", user.camera);
+        return json;
+    }
+
+    /**
+     * @param room the room the user forwards the stream to, the token is for it
+     */
+    private static JsonObject interactJson(User user, Room room) {
+        JsonObject json = userJson(user);
+        json.addProperty("token", "token_" + room.roomId + "_" + user.userId);
+        return json;
+    }
+
+    private void notifyRoom(Room room, String event, JsonObject data, @Nullable String exceptId) {
+        String message = inform(event, data);
+        for (String memberId : room.members) {
+            if (!memberId.equals(exceptId)) {
+                send(memberId, message);
+            }
+        }
+    }
+
+    private void notifyUser(String userId, String event, JsonObject data) {
+        send(userId, inform(event, data));
+    }
+
+    private void send(String userId, String message) {
+        Link link = mLinks.get(userId);
+        if (link != null && link.isLoggedIn()) {
+            mNotices++;
+            link.send(message);
+        }
+    }
+
+    private String inform(String event, JsonObject data) {
+        JsonObject inform = new JsonObject();
+        inform.addProperty("message_type", ServerResponse.MESSAGE_TYPE_INFORM);
+        inform.addProperty("event", event);
+        inform.add("data", data);
+        inform.addProperty("timestamp", mClock.now());
+        return inform.toString();
+    }
+
+    private static void bump(Room room) {
+        room.stateVersion++;
+    }
+
+    private Room roomOf(User user) {
+        Room room = user.roomId == null ? null : mRooms.get(user.roomId);
+        if (room == null) {
+            throw new Failure(CODE_USER_LEFT, "not in a room");
+        }
+        return room;
+    }
+
+    private Room hostedRoom(User user) {
+        Room room = roomOf(user);
+        if (!room.hostId.equals(user.userId)) {
+            throw new Failure(CODE_PERMISSION_DENIED, "not the host");
+        }
+        return room;
+    }
+
+    private User memberOf(Room room, String userId) {
+        User user = mUsers.get(userId);
+        if (user == null || !room.members.contains(userId)) {
+            throw new Failure(CODE_USER_NOT_FOUND, "no user " + userId);
+        }
+        return user;
+    }
+
+    private static String string(JsonObject json, String key) {
+        JsonElement element = json.get(key);
+        return element == null || !element.isJsonPrimitive() ? "" : element.getAsString();
+    }
+
+    private static int integer(JsonObject json, String key) {
+        JsonElement element = json.get(key);
+        if (element == null || !element.isJsonPrimitive()) {
+            throw new Failure(CODE_BAD_REQUEST, "missing " + key);
+        }
+        return element.getAsInt();
+    }
+
+    /**
+     * All users of the room and their seats as the server holds them, for comparing with a client.
+     */
+    static List<String> describeSeats(Room room) {
+        List<String> seats = new ArrayList<>();
+        for (int i = 1; i <= SEAT_COUNT; i++) {
+            seats.add(i + ":" + room.seats[i].status + ":" + room.seats[i].guestId);
+        }
+        return seats;
+    }
+}
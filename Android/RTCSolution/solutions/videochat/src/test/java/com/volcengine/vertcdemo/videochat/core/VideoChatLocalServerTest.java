@@ -0,0 +1,311 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+import com.volcengine.vertcdemo.core.net.IRequestCallback;
+import com.volcengine.vertcdemo.core.net.rts.RTSBaseClient;
+import com.volcengine.vertcdemo.utils.AppUtil;
+import com.volcengine.vertcdemo.videochat.bean.AnchorPkFinishEvent;
+import com.volcengine.vertcdemo.videochat.bean.AudienceApplyEvent;
+import com.volcengine.vertcdemo.videochat.bean.FinishLiveEvent;
+import com.volcengine.vertcdemo.videochat.bean.InteractChangedEvent;
+import com.volcengine.vertcdemo.videochat.bean.InteractResultEvent;
+import com.volcengine.vertcdemo.videochat.bean.InviteAnchorEvent;
+import com.volcengine.vertcdemo.videochat.bean.InviteAnchorReplyEvent;
+import com.volcengine.vertcdemo.videochat.bean.ReceivedInteractEvent;
+import com.volcengine.vertcdemo.videochat.bean.ReplyMicOnEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatResponse;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+import org.robolectric.RobolectricTestRunner;
+import org.robolectric.RuntimeEnvironment;
+import org.robolectric.annotation.LooperMode;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * Real VideoChatRTSClients against the local stand-in of the business server, and the signaling
+ * load run. The main looper runs posted callbacks right away, so answers arrive on the virtual
+ * scheduler's thread.
+ */
+@RunWith(RobolectricTestRunner.class)
+@LooperMode(LooperMode.Mode.LEGACY)
+public class VideoChatLocalServerTest {
+
+    private VirtualScheduler mScheduler;
+    private VideoChatLocalServer mServer;
+
+    private static class Result<T> implements IRequestCallback<T> {
+        T data;
+        int code;
+
+        @Override
+        public void onSuccess(T data) {
+            this.data = data;
+            code = VideoChatLocalServer.CODE_OK;
+        }
+
+        @Override
+        public void onError(int errorCode, String message) {
+            code = errorCode;
+        }
+    }
+
+    @Before
+    public void setUp() {
+        // Error messages of the answers come from the resources
+        AppUtil.initApp(RuntimeEnvironment.getApplication());
+        mScheduler = new VirtualScheduler();
+        mServer = new VideoChatLocalServer(mScheduler, mScheduler::now, 10, 30, new Random(5));
+    }
+
+    private void settle() {
+        mScheduler.runUntil(mScheduler.now() + 1_000);
+    }
+
+    private VideoChatLocalUser connect(String userId) {
+        VideoChatLocalUser user = new VideoChatLocalUser(userId, mServer, mScheduler);
+        user.connect(null);
+        settle();
+        assertTrue(user.connected);
+        return user;
+    }
+
+    private VideoChatLocalUser openRoom(String userId) {
+        VideoChatLocalUser host = connect(userId);
+        host.createRoom("room of " + userId, null);
+        settle();
+        host.startLive(null);
+        host.reconnect(null);
+        settle();
+        assertNotNull(host.roomId);
+        return host;
+    }
+
+    private VideoChatLocalUser join(String userId, VideoChatLocalUser host) {
+        VideoChatLocalUser audience = connect(userId);
+        audience.joinRoom(host.roomId, null);
+        settle();
+        assertEquals(host.roomId, audience.roomId);
+        return audience;
+    }
+
+    private void assertSameSeats(VideoChatLocalUser... users) {
+        for (VideoChatLocalUser user : users) {
+            assertEquals(user.userId, VideoChatLocalServer.describeSeats(mServer.getRoom(user.roomId)),
+                    VideoChatLoadGenerator.describeSeats(user));
+        }
+    }
+
+    @Test
+    public void applyInviteAndLockKeepEveryClientInSync() {
+        VideoChatLocalUser host = openRoom("host");
+        VideoChatLocalUser alice = join("alice", host);
+        VideoChatLocalUser bob = join("bob", host);
+        assertEquals(2, mServer.getRoom(host.roomId).audienceCount());
+        host.behavior = (user, notice) -> {
+            if (notice instanceof AudienceApplyEvent) {
+                user.agreeApply(((AudienceApplyEvent) notice).userInfo.userId, null);
+            }
+        };
+        bob.behavior = (user, notice) -> {
+            if (notice instanceof ReceivedInteractEvent) {
+                user.replyInvite(VideoChatDataManager.REPLY_TYPE_ACCEPT, ((ReceivedInteractEvent) notice).seatId, null);
+            }
+        };
+
+        Result<ReplyMicOnEvent> apply = new Result<>();
+        alice.applyInteract(2, apply);
+        settle();
+        assertTrue(apply.data.needApply);
+        assertEquals(1, host.getNoticeCount(AudienceApplyEvent.class));
+        assertEquals(2, mServer.getRoom(host.roomId).seatOf("alice"));
+
+        host.inviteInteract("bob", 2, null);
+        settle();
+        assertEquals("the taken seat moves the invite to the first free one",
+                1, mServer.getRoom(host.roomId).seatOf("bob"));
+        assertEquals(1, host.getNoticeCount(InteractResultEvent.class));
+        assertSameSeats(host, alice, bob);
+
+        host.manageSeat(2, VideoChatDataManager.SEAT_OPTION_LOCK, null);
+        settle();
+        assertEquals(-1, mServer.getRoom(host.roomId).seatOf("alice"));
+        assertSameSeats(host, alice, bob);
+
+        host.manageInteractApply(VideoChatRoomInfo.INTERACT_OFF, null);
+        settle();
+        alice.applyInteract(2, apply);
+        settle();
+        assertFalse("the locked seat is skipped and no apply is needed", apply.data.needApply);
+        assertEquals(3, mServer.getRoom(host.roomId).seatOf("alice"));
+
+        bob.leaveRoom(null);
+        settle();
+        assertNull(bob.roomId);
+        assertSameSeats(host, alice);
+        assertEquals("alice", alice.state.getSeats().get(3).userInfo.userId);
+    }
+
+    @Test
+    public void anchorPkBetweenTwoRooms() {
+        VideoChatLocalUser hostA = openRoom("host_a");
+        VideoChatLocalUser hostB = openRoom("host_b");
+        VideoChatLocalUser audience = join("audience", hostB);
+        audience.applyInteract(1, null);
+        settle();
+        hostB.agreeApply("audience", null);
+        settle();
+
+        Result<VideoChatResponse> invite = new Result<>();
+        hostA.inviteAnchor(hostB.roomId, hostB.userId, invite);
+        settle();
+        assertEquals(VideoChatLocalServer.CODE_GUEST_IN_ROOM, invite.code);
+
+        audience.finishInteract(1, null);
+        settle();
+        hostB.behavior = (user, notice) -> {
+            if (notice instanceof InviteAnchorEvent) {
+                InviteAnchorEvent received = (InviteAnchorEvent) notice;
+                user.replyAnchor(received.fromRoomId, received.fromUserId, VideoChatDataManager.REPLY_TYPE_ACCEPT, null);
+            }
+        };
+        hostA.inviteAnchor(hostB.roomId, hostB.userId, invite);
+        settle();
+        assertEquals(VideoChatLocalServer.CODE_OK, invite.code);
+        assertEquals(1, hostA.getNoticeCount(InviteAnchorReplyEvent.class));
+        assertEquals(1, audience.getNoticeCount(VideoChatUserInfo.class));
+        assertEquals(VideoChatRoomInfo.ROOM_STATUS_PK_ING, mServer.getRoom(hostA.roomId).status);
+        assertEquals(VideoChatRoomInfo.ROOM_STATUS_PK_ING, mServer.getRoom(hostB.roomId).status);
+
+        Result<ReplyMicOnEvent> apply = new Result<>();
+        audience.applyInteract(1, apply);
+        settle();
+        assertEquals(VideoChatLocalServer.CODE_HOST_IN_ROOM, apply.code);
+
+        hostB.finishAnchorInteract(null);
+        settle();
+        assertEquals(1, hostA.getNoticeCount(AnchorPkFinishEvent.class));
+        assertEquals(1, audience.getNoticeCount(AnchorPkFinishEvent.class));
+        assertEquals(VideoChatRoomInfo.ROOM_STATUS_LIVING, mServer.getRoom(hostA.roomId).status);
+        assertEquals(VideoChatRoomInfo.ROOM_STATUS_LIVING, mServer.getRoom(hostB.roomId).status);
+    }
+
+    @Test
+    public void resumeAfterDropOffCatchesUpOnMissedNotices() {
+        VideoChatLocalUser host = openRoom("host");
+        VideoChatLocalUser alice = join("alice", host);
+        VideoChatLocalUser bob = join("bob", host);
+        long version = alice.state.getStateVersion();
+
+        alice.disconnect();
+        Result<VideoChatResponse> offline = new Result<>();
+        alice.sendMessage("lost", offline);
+        bob.applyInteract(4, null);
+        settle();
+        host.agreeApply("bob", null);
+        host.manageSeat(6, VideoChatDataManager.SEAT_OPTION_LOCK, null);
+        settle();
+        assertEquals("refused by the client while logged out", RTSBaseClient.ERROR_CODE_DEFAULT, offline.code);
+        assertEquals(0, alice.getNoticeCount(InteractChangedEvent.class));
+
+        Result<VideoChatRoomStateSync.Plan> resumed = new Result<>();
+        alice.connect(() -> alice.reconnect(resumed));
+        settle();
+        assertFalse(resumed.data.noChange);
+        assertTrue(resumed.data.changedSeats.containsKey(4));
+        assertTrue(resumed.data.changedSeats.containsKey(6));
+        assertTrue(alice.state.getStateVersion() > version);
+        assertSameSeats(alice, bob, host);
+
+        alice.reconnect(resumed);
+        settle();
+        assertTrue("nothing changed since the snapshot", resumed.data.noChange);
+    }
+
+    @Test
+    public void errorsCarryTheBusinessCodes() {
+        VideoChatLocalUser host = openRoom("host");
+        VideoChatLocalUser alice = join("alice", host);
+        List<Integer> expected = new ArrayList<>();
+
+        alice.manageSeat(1, VideoChatDataManager.SEAT_OPTION_LOCK, null);
+        expected.add(VideoChatLocalServer.CODE_PERMISSION_DENIED);
+        alice.finishInteract(1, null);
+        expected.add(VideoChatLocalServer.CODE_USER_LEFT);
+        alice.replyInvite(VideoChatDataManager.REPLY_TYPE_ACCEPT, 1, null);
+        expected.add(VideoChatLocalServer.CODE_INTERACT_ENDED);
+        host.manageSeat(7, VideoChatDataManager.SEAT_OPTION_LOCK, null);
+        settle();
+        expected.add(VideoChatLocalServer.CODE_BAD_REQUEST);
+
+        String roomId = host.roomId;
+        host.finishLive(null);
+        settle();
+        assertEquals(1, alice.getNoticeCount(FinishLiveEvent.class));
+        assertNull(alice.roomId);
+        alice.joinRoom(roomId, null);
+        settle();
+        expected.add(VideoChatLocalServer.CODE_ROOM_CLOSED);
+
+        List<Integer> codes = new ArrayList<>(alice.getErrorCodes());
+        codes.addAll(3, host.getErrorCodes());
+        assertEquals(expected, codes);
+        assertEquals(0, mServer.getRoomCount());
+    }
+
+    /**
+     * Throughput and latency of the signaling layer: 4000 clients in 100 rooms for a virtual
+     * minute, every answered request is timed and every client ends on the server's seats.
+     */
+    @Test
+    public void signalingLoad() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        VideoChatLoadGenerator.Config config = new VideoChatLoadGenerator.Config();
+        config.rooms = 100;
+        config.audiencePerRoom = 39;
+        VideoChatLoadGenerator generator = new VideoChatLoadGenerator(config);
+        VideoChatLoadGenerator.Report report = generator.run();
+
+        assertEquals(4000, report.clients);
+        assertEquals(0, report.pending);
+        assertEquals(report.requests, report.answered + report.dropped);
+        assertEquals(report.requests, generator.getServer().getRequestCount() + countRefused(report));
+        assertTrue(report.compared > 3000);
+        assertEquals(0, report.mismatches);
+        assertTrue(report.roundTrips.get("viSendMessage").getTotalCount() > 10_000);
+        assertTrue(report.roundTrips.get("viAgreeApply").getTotalCount() > 0);
+        assertTrue(report.roundTrips.get("viReplyAnchor").getTotalCount() > 0);
+        assertTrue("one delay each way", report.roundTrips.get("viSendMessage").getMax() <= 2 * config.maxDelayMs);
+
+        System.out.print(report.summary());
+    }
+
+    /**
+     * Requests the client failed without reaching the server: sent while logged out, or
+     * identical to one in flight.
+     */
+    private static long countRefused(VideoChatLoadGenerator.Report report) {
+        long refused = 0;
+        for (int code : new int[]{RTSBaseClient.ERROR_CODE_DEFAULT, RTSBaseClient.ERROR_CODE_DUPLICATE_REQUEST}) {
+            Integer count = report.errors.get(code);
+            refused += count == null ? 0 : count;
+        }
+        return refused;
+    }
+}
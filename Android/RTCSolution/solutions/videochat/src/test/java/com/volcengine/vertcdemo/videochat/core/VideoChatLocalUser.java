@@ -0,0 +1,345 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import androidx.annotation.Nullable;
+
+import com.volcengine.vertcdemo.common.AbsBroadcast;
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+import com.volcengine.vertcdemo.core.net.IRequestCallback;
+import com.volcengine.vertcdemo.core.net.rts.LatencyHistogram;
+import com.volcengine.vertcdemo.core.net.rts.RTSBaseClient;
+import com.volcengine.vertcdemo.core.net.rts.RTSInfo;
+import com.volcengine.vertcdemo.core.net.rts.RTSLatencyTracer;
+import com.volcengine.vertcdemo.videochat.bean.AudienceChangedEvent;
+import com.volcengine.vertcdemo.videochat.bean.CreateRoomEvent;
+import com.volcengine.vertcdemo.videochat.bean.FinishLiveEvent;
+import com.volcengine.vertcdemo.videochat.bean.InteractChangedEvent;
+import com.volcengine.vertcdemo.videochat.bean.InteractReplyEvent;
+import com.volcengine.vertcdemo.videochat.bean.JoinRoomEvent;
+import com.volcengine.vertcdemo.videochat.bean.MediaChangedEvent;
+import com.volcengine.vertcdemo.videochat.bean.ReplyAnchorsEvent;
+import com.volcengine.vertcdemo.videochat.bean.ReplyMicOnEvent;
+import com.volcengine.vertcdemo.videochat.bean.SeatChangedEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatResponse;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+import java.util.Set;
+import java.util.UUID;
+
+/**
+ * One app on a link of {@link VideoChatLocalServer}: a real {@link VideoChatRTSClient} on the
+ * virtual scheduler, and the seats a room screen keeps in a {@link VideoChatRoomStateSync}, fed
+ * from the client's notices and answers the way the screen feeds it.
+ *
+ * Requests are framed, sent and answered by the client, this only counts them for the report.
+ * Needs the Robolectric main looper in legacy mode, the client answers on the main thread.
+ */
+class VideoChatLocalUser {
+
+    /**
+     * Reacts to notices, e.g. accepts an invite, after the room state was updated.
+     */
+    interface Behavior {
+        /**
+         * @param notice the bean the client posted, e.g. an AudienceApplyEvent
+         */
+        void onNotice(VideoChatLocalUser user, Object notice);
+    }
+
+    final String userId;
+    final VideoChatRTSClient client;
+    final VideoChatRoomStateSync state = new VideoChatRoomStateSync();
+    @Nullable
+    String roomId;
+    boolean connected;
+    @Nullable
+    Behavior behavior;
+
+    private final Map<Class<?>, Integer> mNoticeCounts = new HashMap<>();
+    private final List<Integer> mErrorCodes = new ArrayList<>();
+    /*** Callbacks of the requests not answered yet */
+    private final Set<Tracked<?>> mOutstanding = Collections.newSetFromMap(new IdentityHashMap<>());
+    private long mSent;
+    private long mAnswered;
+    private long mDropped;
+
+    VideoChatLocalUser(String userId, VideoChatLocalServer server, VirtualScheduler scheduler) {
+        this.userId = userId;
+        VideoChatLocalServer.Link link = server.connect();
+        RTSInfo rtsInfo = new RTSInfo("local", "rts_token", "local", "signature", "videochat");
+        client = new VideoChatRTSClient(link, rtsInfo, scheduler, scheduler::now,
+                new Random(userId.hashCode()), Runnable::run) {
+            @Override
+            protected String getUserId() {
+                return VideoChatLocalUser.this.userId;
+            }
+
+            @Override
+            protected String getLoginToken() {
+                return "token_" + VideoChatLocalUser.this.userId;
+            }
+
+            @Override
+            protected String getDeviceId() {
+                return "device_" + VideoChatLocalUser.this.userId;
+            }
+
+            @Override
+            protected void post(Object event) {
+                onNotice(event);
+            }
+        };
+        link.attach(VideoChatLocalServer.to(client));
+    }
+
+    private void onNotice(Object notice) {
+        if (notice instanceof AudienceChangedEvent) {
+            state.onAudienceCountChanged(((AudienceChangedEvent) notice).audienceCount);
+        } else if (notice instanceof InteractChangedEvent) {
+            InteractChangedEvent event = (InteractChangedEvent) notice;
+            state.onSeatUserChanged(event.seatId, event.isStart ? event.userInfo : null);
+        } else if (notice instanceof SeatChangedEvent) {
+            SeatChangedEvent event = (SeatChangedEvent) notice;
+            state.onSeatStatusChanged(event.seatId, event.type);
+        } else if (notice instanceof MediaChangedEvent) {
+            MediaChangedEvent event = (MediaChangedEvent) notice;
+            state.onMediaChanged(event.userInfo == null ? null : event.userInfo.userId, event.mic, event.camera);
+        } else if (notice instanceof FinishLiveEvent) {
+            roomId = null;
+            state.clear();
+        }
+        Integer count = mNoticeCounts.get(notice.getClass());
+        mNoticeCounts.put(notice.getClass(), count == null ? 1 : count + 1);
+        Behavior behavior = this.behavior;
+        if (behavior != null) {
+            behavior.onNotice(this, notice);
+        }
+    }
+
+    /**
+     * RTSBaseClient#login, the handshake with the local server.
+     */
+    void connect(@Nullable Runnable onConnected) {
+        client.login("rts_token_" + userId, (resultCode, message) -> {
+            connected = resultCode == RTSBaseClient.LoginCallBack.SUCCESS;
+            if (connected && onConnected != null) {
+                onConnected.run();
+            }
+        });
+    }
+
+    /**
+     * Logout, requests in flight are dropped as their answers no longer arrive.
+     */
+    void disconnect() {
+        connected = false;
+        mDropped += mOutstanding.size();
+        mOutstanding.clear();
+        client.logout();
+    }
+
+    int getNoticeCount(Class<?> type) {
+        Integer count = mNoticeCounts.get(type);
+        return count == null ? 0 : count;
+    }
+
+    /*** Codes of the failed answers and refused sends, in order */
+    List<Integer> getErrorCodes() {
+        return mErrorCodes;
+    }
+
+    long getSentCount() {
+        return mSent;
+    }
+
+    long getAnsweredCount() {
+        return mAnswered;
+    }
+
+    long getDroppedCount() {
+        return mDropped;
+    }
+
+    int getPendingCount() {
+        return mOutstanding.size();
+    }
+
+    /**
+     * Adds the client's send-to-answer times, by event_name, to the run's.
+     */
+    void addRoundTrips(Map<String, LatencyHistogram> roundTrips) {
+        RTSLatencyTracer tracer = client.getLatencyTracer();
+        for (String eventName : tracer.getEventNames()) {
+            LatencyHistogram histogram = roundTrips.get(eventName);
+            if (histogram == null) {
+                histogram = new LatencyHistogram();
+                roundTrips.put(eventName, histogram);
+            }
+            histogram.add(tracer.getHistogram(eventName, RTSLatencyTracer.STAGE_ANSWER));
+        }
+    }
+
+    void createRoom(String roomName, @Nullable IRequestCallback<CreateRoomEvent> callback) {
+        client.requestCreateRoom(userId, roomName, "", track(callback, data -> roomId = data.roomInfo.roomId));
+    }
+
+    void startLive(@Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.requestStartLive(roomId, track(callback, null));
+    }
+
+    void joinRoom(String roomId, @Nullable IRequestCallback<JoinRoomEvent> callback) {
+        client.requestJoinRoom(userId, roomId, track(callback, data -> {
+            this.roomId = data.roomInfo.roomId;
+            state.reset(data);
+        }));
+    }
+
+    void leaveRoom(@Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.requestLeaveRoom(roomId, track(callback, data -> {
+            roomId = null;
+            state.clear();
+        }));
+    }
+
+    void finishLive(@Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.requestFinishLive(roomId, track(callback, data -> {
+            roomId = null;
+            state.clear();
+        }));
+    }
+
+    /**
+     * Resumable reconnect with the version of the held state, merged with
+     * {@link VideoChatRoomStateSync#apply}.
+     */
+    void reconnect(@Nullable IRequestCallback<VideoChatRoomStateSync.Plan> callback) {
+        client.reconnectToServer(roomId, state.getStateVersion(), track(new IRequestCallback<JoinRoomEvent>() {
+            @Override
+            public void onSuccess(JoinRoomEvent data) {
+                VideoChatRoomStateSync.Plan plan = state.apply(data);
+                if (callback != null) {
+                    callback.onSuccess(plan);
+                }
+            }
+
+            @Override
+            public void onError(int errorCode, String message) {
+                if (errorCode == VideoChatLocalServer.CODE_USER_LEFT
+                        || errorCode == VideoChatLocalServer.CODE_ROOM_CLOSED) {
+                    // Left or closed while offline, the room screen exits.
+                    roomId = null;
+                    state.clear();
+                }
+                if (callback != null) {
+                    callback.onError(errorCode, message);
+                }
+            }
+        }, null));
+    }
+
+    void inviteInteract(String audienceUserId, int seatId, @Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.inviteInteract(roomId, audienceUserId, seatId, track(callback, null));
+    }
+
+    void replyInvite(int reply, int seatId, @Nullable IRequestCallback<InteractReplyEvent> callback) {
+        client.replyInvite(roomId, reply, seatId, track(callback, null));
+    }
+
+    void applyInteract(int seatId, @Nullable IRequestCallback<ReplyMicOnEvent> callback) {
+        client.applyInteract(roomId, seatId, track(callback, null));
+    }
+
+    void agreeApply(String audienceUserId, @Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.agreeApply(roomId, audienceUserId, roomId, track(callback, null));
+    }
+
+    void manageInteractApply(int type, @Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.manageInteractApply(roomId, type, track(callback, null));
+    }
+
+    void finishInteract(int seatId, @Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.finishInteract(roomId, seatId, track(callback, null));
+    }
+
+    void manageSeat(int seatId, @VideoChatDataManager.SeatOption int type,
+                    @Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.managerSeat(roomId, seatId, type, track(callback, null));
+    }
+
+    void updateMediaStatus(int mic, int camera, @Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.updateMediaStatus(roomId, userId, mic, camera, track(callback, null));
+    }
+
+    void sendMessage(String message, @Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.sendMessage(roomId, message, UUID.randomUUID().toString(), track(callback, null));
+    }
+
+    void inviteAnchor(String peerRoomId, String peerUid, @Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.inviteAnchor(roomId, userId, peerRoomId, peerUid, 1, track(callback, null));
+    }
+
+    void replyAnchor(String peerRoomId, String peerUid, int reply, @Nullable IRequestCallback<ReplyAnchorsEvent> callback) {
+        client.replyAnchor(roomId, userId, peerRoomId, peerUid, reply, track(callback, null));
+    }
+
+    void finishAnchorInteract(@Nullable IRequestCallback<VideoChatResponse> callback) {
+        client.finishAnchorInteract(roomId, track(callback, null));
+    }
+
+    /**
+     * Counts the request, the state update of the answer runs first, then the callback of the caller.
+     */
+    private <T> IRequestCallback<T> track(@Nullable IRequestCallback<T> callback, @Nullable AbsBroadcast.On<T> onState) {
+        Tracked<T> tracked = new Tracked<>(callback, onState);
+        mSent++;
+        mOutstanding.add(tracked);
+        return tracked;
+    }
+
+    private final class Tracked<T> implements IRequestCallback<T> {
+        @Nullable
+        final IRequestCallback<T> callback;
+        @Nullable
+        final AbsBroadcast.On<T> onState;
+
+        Tracked(@Nullable IRequestCallback<T> callback, @Nullable AbsBroadcast.On<T> onState) {
+            this.callback = callback;
+            this.onState = onState;
+        }
+
+        @Override
+        public void onSuccess(T data) {
+            if (!mOutstanding.remove(this)) {
+                // Dropped at logout
+                return;
+            }
+            mAnswered++;
+            if (onState != null) {
+                onState.on(data);
+            }
+            if (callback != null) {
+                callback.onSuccess(data);
+            }
+        }
+
+        @Override
+        public void onError(int errorCode, String message) {
+            if (!mOutstanding.remove(this)) {
+                return;
+            }
+            mAnswered++;
+            mErrorCodes.add(errorCode);
+            if (callback != null) {
+                callback.onError(errorCode, message);
+            }
+        }
+    }
+}
@@ -0,0 +1,281 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+import com.google.gson.JsonArray;
+import com.google.gson.JsonObject;
+import com.google.gson.JsonParser;
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+import com.volcengine.vertcdemo.videochat.bean.JoinRoomEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+
+/**
+ * Checks the mixed stream layout JSON against the seat state it is built from, and how seat
+ * changes reach the server through the controller.
+ */
+public class VideoChatMixedStreamLayoutTest {
+
+    private static final String ROOM_ID = "room";
+    private static final int TILE = VideoChatMixedStreamLayout.DEFAULT_TILE_SIZE;
+
+    /**
+     * Records requests and answers them when told to.
+     */
+    private static class FakeRequester implements VideoChatMixedStreamController.Requester {
+        final List<String> updates = new ArrayList<>();
+        int stops;
+        VideoChatMixedStreamController.Callback pending;
+
+        @Override
+        public void update(String layoutJson, VideoChatMixedStreamController.Callback callback) {
+            assertNull("one request at a time", pending);
+            updates.add(layoutJson);
+            pending = callback;
+        }
+
+        @Override
+        public void stop(VideoChatMixedStreamController.Callback callback) {
+            assertNull("one request at a time", pending);
+            stops++;
+            pending = callback;
+        }
+
+        void answer(boolean success) {
+            VideoChatMixedStreamController.Callback callback = pending;
+            pending = null;
+            callback.onResult(success);
+        }
+    }
+
+    @Test
+    public void layoutJsonFollowsTheSeats() {
+        VideoChatUserInfo host = user("host", true, true);
+        Map<Integer, VideoChatSeatInfo> seats = new HashMap<>();
+        seats.put(1, seat(1, user("guest_1", true, true), false));
+        seats.put(2, seat(2, null, true)); // locked and empty
+        seats.put(3, seat(3, user("guest_3", false, true), true)); // locked after the guest sat down
+        seats.put(4, seat(4, null, false));
+        seats.put(5, seat(5, user("guest_5", true, false), false));
+        seats.put(6, seat(6, user("overflow", true, true), false)); // no slot for it
+
+        JsonObject json = parse(VideoChatMixedStreamLayout.build(ROOM_ID, host, seats, TILE).toJson());
+        assertEquals(VideoChatMixedStreamLayout.LAYOUT_VERSION, json.get("version").getAsInt());
+        assertEquals(ROOM_ID, json.get("room_id").getAsString());
+        assertEquals(3 * TILE, json.get("canvas_width").getAsInt());
+        assertEquals(2 * TILE, json.get("canvas_height").getAsInt());
+
+        JsonArray regions = json.getAsJsonArray("regions");
+        assertEquals(3, regions.size());
+        assertRegion(regions.get(0).getAsJsonObject(), "host", 0, 0, 0, true, true);
+        assertRegion(regions.get(1).getAsJsonObject(), "guest_1", 1, TILE, 0, true, true);
+        assertRegion(regions.get(2).getAsJsonObject(), "guest_5", 5, 2 * TILE, TILE, true, false);
+    }
+
+    @Test
+    public void regionsMatchTheSeatsForAnySeatState() {
+        Random random = new Random(34);
+        for (int round = 0; round < 500; round++) {
+            VideoChatUserInfo host = random.nextInt(8) == 0 ? null : user("host", random.nextBoolean(), random.nextBoolean());
+            Map<Integer, VideoChatSeatInfo> seats = new HashMap<>();
+            for (int seatId = 1; seatId < VideoChatMixedStreamLayout.SLOT_COUNT; seatId++) {
+                int kind = random.nextInt(4);
+                if (kind == 0) {
+                    continue;
+                }
+                VideoChatUserInfo guest = kind == 1 ? null
+                        : user("guest_" + seatId, random.nextBoolean(), random.nextBoolean());
+                seats.put(seatId, seat(seatId, guest, random.nextInt(4) == 0));
+            }
+
+            VideoChatMixedStreamLayout layout = VideoChatMixedStreamLayout.build(ROOM_ID, host, seats, TILE);
+            JsonArray regions = parse(layout.toJson()).getAsJsonArray("regions");
+            Map<Integer, JsonObject> bySlot = new HashMap<>();
+            for (int i = 0; i < regions.size(); i++) {
+                JsonObject region = regions.get(i).getAsJsonObject();
+                assertNull("slot used twice", bySlot.put(region.get("slot").getAsInt(), region));
+            }
+            for (int slot = 0; slot < VideoChatMixedStreamLayout.SLOT_COUNT; slot++) {
+                VideoChatUserInfo expected;
+                if (slot == 0) {
+                    expected = host;
+                } else {
+                    VideoChatSeatInfo seat = seats.get(slot);
+                    expected = seat == null || seat.isLocked() ? null : seat.userInfo;
+                }
+                JsonObject region = bySlot.get(slot);
+                if (expected == null) {
+                    assertNull("round " + round + " slot " + slot, region);
+                    continue;
+                }
+                assertNotNull("round " + round + " slot " + slot, region);
+                assertRegion(region, expected.userId, slot, slot % 3 * TILE, slot / 3 * TILE,
+                        expected.isMicOn(), expected.isCameraOn());
+            }
+        }
+    }
+
+    @Test
+    public void layoutFromTheStateSyncTracksSeatNotices() {
+        VideoChatRoomStateSync sync = new VideoChatRoomStateSync();
+        JoinRoomEvent join = new JoinRoomEvent();
+        join.roomInfo = new VideoChatRoomInfo();
+        join.roomInfo.roomId = ROOM_ID;
+        join.hostInfo = user("host", true, true);
+        join.userInfo = join.hostInfo;
+        join.seatMap = new HashMap<>();
+        sync.reset(join);
+
+        sync.onSeatUserChanged(2, user("guest_2", true, true));
+        sync.onSeatStatusChanged(4, VideoChatDataManager.SEAT_STATUS_LOCKED);
+        sync.onMediaChanged("guest_2", VideoChatUserInfo.MIC_STATUS_OFF, VideoChatUserInfo.CAMERA_STATUS_ON);
+        VideoChatMixedStreamLayout layout = VideoChatMixedStreamLayout.build(ROOM_ID, sync.getHostInfo(), sync.getSeats(), TILE);
+        assertEquals(2, layout.regions.size());
+        assertEquals("guest_2", layout.regions.get(1).userId);
+        assertFalse(layout.regions.get(1).audio);
+
+        sync.onSeatUserChanged(2, null);
+        layout = VideoChatMixedStreamLayout.build(ROOM_ID, sync.getHostInfo(), sync.getSeats(), TILE);
+        assertEquals(1, layout.regions.size());
+    }
+
+    @Test
+    public void controllerCoalescesAndSkipsUnchangedLayouts() {
+        FakeRequester requester = new FakeRequester();
+        VirtualScheduler scheduler = new VirtualScheduler();
+        VideoChatMixedStreamController controller = new VideoChatMixedStreamController(requester, scheduler);
+        Map<Integer, VideoChatSeatInfo> seats = new HashMap<>();
+        VideoChatUserInfo host = user("host", true, true);
+
+        controller.onLayoutChanged(layout(host, seats));
+        assertTrue("nothing is sent while off", requester.updates.isEmpty());
+
+        controller.setEnabled(true, layout(host, seats));
+        assertEquals(VideoChatMixedStreamController.STATE_STARTING, controller.getState());
+        assertEquals(1, requester.updates.size());
+
+        // Three seat changes while the first request is in flight, only the last is sent.
+        for (int seatId = 1; seatId <= 3; seatId++) {
+            seats.put(seatId, seat(seatId, user("guest_" + seatId, true, true), false));
+            controller.onLayoutChanged(layout(host, seats));
+        }
+        requester.answer(true);
+        assertEquals(2, requester.updates.size());
+        assertEquals(layout(host, seats).toJson(), requester.updates.get(1));
+        requester.answer(true);
+        assertEquals(VideoChatMixedStreamController.STATE_MIXING, controller.getState());
+        assertEquals(layout(host, seats).toJson(), controller.getAcceptedLayoutJson());
+
+        controller.onLayoutChanged(layout(host, seats));
+        assertEquals("unchanged layout is not sent", 2, requester.updates.size());
+
+        controller.setEnabled(false, null);
+        assertEquals(1, requester.stops);
+        requester.answer(true);
+        assertEquals(VideoChatMixedStreamController.STATE_OFF, controller.getState());
+        controller.onLayoutChanged(layout(host, seats));
+        assertEquals(2, requester.updates.size());
+    }
+
+    @Test
+    public void rejectedLayoutIsSentAgain() {
+        FakeRequester requester = new FakeRequester();
+        VirtualScheduler scheduler = new VirtualScheduler();
+        VideoChatMixedStreamController controller = new VideoChatMixedStreamController(requester, scheduler);
+        Map<Integer, VideoChatSeatInfo> seats = new HashMap<>();
+        VideoChatUserInfo host = user("host", true, true);
+
+        controller.setEnabled(true, layout(host, seats));
+        requester.answer(false);
+        assertEquals(VideoChatMixedStreamController.STATE_FAILED, controller.getState());
+        assertEquals(1, controller.getFailureCount());
+
+        scheduler.runUntil(VideoChatMixedStreamController.retryDelay(1) - 1);
+        assertEquals(1, requester.updates.size());
+        scheduler.runUntil(VideoChatMixedStreamController.retryDelay(1));
+        assertEquals("retried after the backoff", 2, requester.updates.size());
+        assertEquals(requester.updates.get(0), requester.updates.get(1));
+        requester.answer(false);
+        assertEquals(2 * VideoChatMixedStreamController.retryDelay(1), VideoChatMixedStreamController.retryDelay(2));
+
+        // The next seat change carries the newest layout and replaces the scheduled retry.
+        seats.put(1, seat(1, user("guest_1", true, true), false));
+        controller.onLayoutChanged(layout(host, seats));
+        assertEquals(3, requester.updates.size());
+        assertEquals(layout(host, seats).toJson(), requester.updates.get(2));
+        requester.answer(true);
+        assertEquals(VideoChatMixedStreamController.STATE_MIXING, controller.getState());
+        scheduler.runUntil(60_000);
+        assertEquals(3, requester.updates.size());
+    }
+
+    @Test
+    public void retryBackoffIsCapped() {
+        assertEquals(VideoChatMixedStreamController.RETRY_BASE_DELAY_MS, VideoChatMixedStreamController.retryDelay(1));
+        assertEquals(VideoChatMixedStreamController.RETRY_MAX_DELAY_MS, VideoChatMixedStreamController.retryDelay(6));
+        assertEquals(VideoChatMixedStreamController.RETRY_MAX_DELAY_MS, VideoChatMixedStreamController.retryDelay(100));
+    }
+
+    @Test
+    public void mixUserIsRecognised() {
+        assertEquals("mix_room", VideoChatMixedStreamLayout.mixUserId(ROOM_ID));
+        assertTrue(VideoChatMixedStreamLayout.isMixUser("mix_room"));
+        assertFalse(VideoChatMixedStreamLayout.isMixUser("host"));
+        assertFalse(VideoChatMixedStreamLayout.isMixUser(null));
+    }
+
+    private static VideoChatMixedStreamLayout layout(VideoChatUserInfo host, Map<Integer, VideoChatSeatInfo> seats) {
+        return VideoChatMixedStreamLayout.build(ROOM_ID, host, seats, TILE);
+    }
+
+    private static void assertRegion(JsonObject region, String userId, int slot, int x, int y,
+                                     boolean audio, boolean video) {
+        assertEquals(userId, region.get("user_id").getAsString());
+        assertEquals(ROOM_ID, region.get("room_id").getAsString());
+        assertEquals(slot, region.get("slot").getAsInt());
+        assertEquals(x, region.get("x").getAsInt());
+        assertEquals(y, region.get("y").getAsInt());
+        assertEquals(TILE, region.get("width").getAsInt());
+        assertEquals(TILE, region.get("height").getAsInt());
+        assertEquals(VideoChatMixedStreamLayout.RENDER_MODE_HIDDEN, region.get("render_mode").getAsString());
+        assertEquals(userId + " audio", audio, region.get("audio").getAsBoolean());
+        assertEquals(userId + " video", video, region.get("video").getAsBoolean());
+    }
+
+    private static JsonObject parse(String json) {
+        return new JsonParser().parse(json).getAsJsonObject();
+    }
+
+    private static VideoChatUserInfo user(String userId, boolean micOn, boolean cameraOn) {
+        VideoChatUserInfo info = new VideoChatUserInfo();
+        info.userId = userId;
+        info.roomId = ROOM_ID;
+        info.mic = micOn ? VideoChatUserInfo.MIC_STATUS_ON : VideoChatUserInfo.MIC_STATUS_OFF;
+        info.camera = cameraOn ? VideoChatUserInfo.CAMERA_STATUS_ON : VideoChatUserInfo.CAMERA_STATUS_OFF;
+        return info;
+    }
+
+    private static VideoChatSeatInfo seat(int seatId, VideoChatUserInfo userInfo, boolean locked) {
+        VideoChatSeatInfo seat = new VideoChatSeatInfo();
+        seat.seatIndex = seatId;
+        seat.userInfo = userInfo;
+        seat.status = locked ? VideoChatDataManager.SEAT_STATUS_LOCKED : VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+        return seat;
+    }
+}
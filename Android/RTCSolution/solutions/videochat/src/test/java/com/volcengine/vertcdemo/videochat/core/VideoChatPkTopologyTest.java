@@ -0,0 +1,186 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static com.volcengine.vertcdemo.videochat.core.VideoChatPkTopology.TOPOLOGY_HUB;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatPkTopology.TOPOLOGY_MESH;
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Set;
+
+/**
+ * Simulates the relays of PKs of 2 or more anchors: which anchors every room ends up showing,
+ * what it costs, and the tiles they are shown in.
+ */
+public class VideoChatPkTopologyTest {
+
+    private static final int STREAM_KBPS = 1_200;
+
+    @Test
+    public void meshUpToFourAnchors() {
+        assertEquals(TOPOLOGY_MESH, VideoChatPkTopology.select(2));
+        assertEquals(TOPOLOGY_MESH, VideoChatPkTopology.select(3));
+        assertEquals(TOPOLOGY_MESH, VideoChatPkTopology.select(4));
+        assertEquals(TOPOLOGY_HUB, VideoChatPkTopology.select(5));
+        assertEquals("the largest PK offered is still a mesh",
+                TOPOLOGY_MESH, VideoChatPkTopology.select(VideoChatPkTopology.MAX_ANCHORS));
+        assertEquals(TOPOLOGY_HUB, VideoChatPkTopology.select(VideoChatPkTopology.MAX_ANCHORS + 1));
+
+        VideoChatPkTopology topology = VideoChatPkTopology.plan(Arrays.asList("c", "a", "b"));
+        assertEquals(TOPOLOGY_MESH, topology.getTopology());
+        assertEquals(Arrays.asList("a", "c"), topology.relayTargetsOf("b"));
+        assertEquals(Arrays.asList("c", "a", "b"), topology.visibleIn("c"));
+        assertEquals(6, topology.getRelayCount());
+    }
+
+    @Test
+    public void fourAnchorsSeeEachOtherInEveryRoom() {
+        assertEquals(4, VideoChatPkTopology.MAX_ANCHORS);
+        VideoChatPkTopology topology = VideoChatPkTopology.plan(rooms(VideoChatPkTopology.MAX_ANCHORS));
+        assertEquals(TOPOLOGY_MESH, topology.getTopology());
+        assertEquals(12, topology.getRelayCount());
+        for (String roomId : topology.getRoomIds()) {
+            assertEquals(roomId, 3, topology.relayTargetsOf(roomId).size());
+            assertEquals(roomId, 4, topology.visibleIn(roomId).size());
+        }
+        assertEquals(Arrays.asList("room_3", "room_1", "room_2", "room_4"), topology.visibleIn("room_3"));
+    }
+
+    @Test
+    public void hubIsTheSmallestRoomOnEveryClient() {
+        List<String> rooms = Arrays.asList("room_4", "room_2", "room_5", "room_3", "room_1");
+        for (int i = 0; i < rooms.size(); i++) {
+            List<String> seenByClient = new ArrayList<>(rooms);
+            Collections.rotate(seenByClient, i);
+            VideoChatPkTopology topology = VideoChatPkTopology.plan(seenByClient);
+            assertEquals(TOPOLOGY_HUB, topology.getTopology());
+            assertEquals("room_1", topology.getHubRoomId());
+        }
+
+        VideoChatPkTopology topology = VideoChatPkTopology.plan(rooms);
+        assertEquals(Arrays.asList("room_1"), topology.relayTargetsOf("room_3"));
+        assertEquals(Arrays.asList("room_2", "room_3", "room_4", "room_5"), topology.relayTargetsOf("room_1"));
+        assertEquals(Arrays.asList("room_1", "room_2", "room_3", "room_4", "room_5"), topology.visibleIn("room_1"));
+        assertEquals(Arrays.asList("room_3", "room_1"), topology.visibleIn("room_3"));
+        assertEquals(Collections.emptyList(), topology.relayTargetsOf("room_9"));
+    }
+
+    @Test
+    public void duplicateAndEmptyRoomsAreIgnored() {
+        VideoChatPkTopology topology = VideoChatPkTopology.plan(Arrays.asList("b", "a", "", null, "b"));
+        assertEquals(Arrays.asList("a", "b"), topology.getRoomIds());
+        assertEquals(TOPOLOGY_MESH, topology.getTopology());
+    }
+
+    @Test
+    public void relaysDeliverWhatEachRoomShows() {
+        for (int anchors = 2; anchors <= 6; anchors++) {
+            VideoChatPkTopology topology = VideoChatPkTopology.plan(rooms(anchors));
+            for (String roomId : topology.getRoomIds()) {
+                // Streams that land in the room: its own anchor plus every relay into it.
+                Set<String> delivered = new HashSet<>();
+                delivered.add(roomId);
+                for (String from : topology.getRoomIds()) {
+                    if (topology.relayTargetsOf(from).contains(roomId)) {
+                        delivered.add(from);
+                    }
+                }
+                assertEquals(roomId + " of " + anchors, delivered, new HashSet<>(topology.visibleIn(roomId)));
+            }
+            assertEquals("the hub shows everyone", anchors,
+                    topology.visibleIn(topology.getHubRoomId()).size());
+        }
+    }
+
+    @Test
+    public void bandwidthPerTopology() {
+        VideoChatPkTopology.Bandwidth mesh = VideoChatPkTopology.plan(rooms(3)).bandwidth(STREAM_KBPS);
+        assertEquals(6, mesh.relays);
+        assertEquals(STREAM_KBPS, mesh.anchorUplinkKbps);
+        assertEquals(2 * STREAM_KBPS, mesh.maxAnchorDownlinkKbps);
+        assertEquals(3 * STREAM_KBPS, mesh.maxAudienceDownlinkKbps);
+        assertEquals(6 * STREAM_KBPS, mesh.serverRelayKbps);
+
+        VideoChatPkTopology.Bandwidth largestMesh = VideoChatPkTopology.plan(rooms(4)).bandwidth(STREAM_KBPS);
+        assertEquals(TOPOLOGY_MESH, largestMesh.topology);
+        assertEquals(12, largestMesh.relays);
+        assertEquals(3 * STREAM_KBPS, largestMesh.maxAnchorDownlinkKbps);
+        assertEquals(4 * STREAM_KBPS, largestMesh.maxAudienceDownlinkKbps);
+        assertEquals(12 * STREAM_KBPS, largestMesh.serverRelayKbps);
+
+        VideoChatPkTopology.Bandwidth hub = VideoChatPkTopology.plan(rooms(5)).bandwidth(STREAM_KBPS);
+        assertEquals(TOPOLOGY_HUB, hub.topology);
+        assertEquals("4 into the hub, 4 out of it", 8, hub.relays);
+        assertEquals(STREAM_KBPS, hub.anchorUplinkKbps);
+        assertEquals(4 * STREAM_KBPS, hub.maxAnchorDownlinkKbps);
+        assertEquals(5 * STREAM_KBPS, hub.maxAudienceDownlinkKbps);
+        assertEquals(8 * STREAM_KBPS, hub.serverRelayKbps);
+
+        // Relays grow linearly with the hub, quadratically with the mesh.
+        for (int anchors = 2; anchors <= 8; anchors++) {
+            VideoChatPkTopology.Bandwidth bandwidth = VideoChatPkTopology.plan(rooms(anchors)).bandwidth(STREAM_KBPS);
+            assertTrue(bandwidth.relays <= anchors * (anchors - 1));
+        }
+    }
+
+    @Test
+    public void tilesCoverTheAreaWithoutOverlap() {
+        int width = 1_081;
+        int height = 607;
+        for (int count = 1; count <= 9; count++) {
+            int[] tiles = new int[count * VideoChatPkTileGrid.TILE_STRIDE];
+            VideoChatPkTileGrid.layout(count, width, height, tiles);
+            long area = 0;
+            for (int i = 0; i < count; i++) {
+                int[] tile = tile(tiles, i);
+                assertTrue(count + " tiles, #" + i, tile[0] >= 0 && tile[1] >= 0
+                        && tile[2] <= width && tile[3] <= height
+                        && tile[0] < tile[2] && tile[1] < tile[3]);
+                area += (long) (tile[2] - tile[0]) * (tile[3] - tile[1]);
+                for (int j = 0; j < i; j++) {
+                    int[] other = tile(tiles, j);
+                    boolean apart = tile[2] <= other[0] || other[2] <= tile[0]
+                            || tile[3] <= other[1] || other[3] <= tile[1];
+                    assertTrue(count + " tiles, #" + i + " overlaps #" + j, apart);
+                }
+            }
+            assertEquals(count + " tiles", (long) width * height, area);
+        }
+    }
+
+    @Test
+    public void threeTilesGiveTheFirstAnchorHalf() {
+        int[] tiles = new int[3 * VideoChatPkTileGrid.TILE_STRIDE];
+        VideoChatPkTileGrid.layout(3, 360, 270, tiles);
+        assertArrayEquals(new int[]{0, 0, 180, 270}, tile(tiles, 0));
+        assertArrayEquals(new int[]{180, 0, 360, 135}, tile(tiles, 1));
+        assertArrayEquals(new int[]{180, 135, 360, 270}, tile(tiles, 2));
+
+        tiles = new int[4 * VideoChatPkTileGrid.TILE_STRIDE];
+        VideoChatPkTileGrid.layout(4, 360, 270, tiles);
+        assertArrayEquals(new int[]{180, 135, 360, 270}, tile(tiles, 3));
+    }
+
+    private static List<String> rooms(int count) {
+        List<String> rooms = new ArrayList<>();
+        for (int i = count; i > 0; i--) {
+            rooms.add("room_" + i);
+        }
+        return rooms;
+    }
+
+    private static int[] tile(int[] tiles, int index) {
+        int offset = index * VideoChatPkTileGrid.TILE_STRIDE;
+        return Arrays.copyOfRange(tiles, offset, offset + VideoChatPkTileGrid.TILE_STRIDE);
+    }
+}
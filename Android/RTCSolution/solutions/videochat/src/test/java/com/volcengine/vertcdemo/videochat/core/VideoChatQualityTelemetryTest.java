@@ -0,0 +1,215 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static com.volcengine.vertcdemo.videochat.core.VideoChatQualityTelemetry.METRIC_AUDIO_KBPS;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatQualityTelemetry.METRIC_FPS;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatQualityTelemetry.METRIC_JITTER;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatQualityTelemetry.METRIC_LOSS;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatQualityTelemetry.METRIC_RTT;
+import static com.volcengine.vertcdemo.videochat.core.VideoChatQualityTelemetry.METRIC_VIDEO_KBPS;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import org.junit.Assume;
+import org.junit.Test;
+
+import java.lang.management.ManagementFactory;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * Windows, rates and summaries of the quality telemetry fed with synthetic stats streams, and the
+ * cost of one stats callback.
+ */
+public class VideoChatQualityTelemetryTest {
+
+    private static final String HOST = "host_1";
+    private static final String GUEST = "guest_2";
+    private static final int INTERVAL_MS = 2_000;
+
+    /**
+     * A remote stream with a base bitrate and loss that the network makes worse from some time on.
+     */
+    private static class SyntheticStream {
+        final String uid;
+        final Random random;
+        int kbps = 1_200;
+        int fps = 15;
+        float loss = 0.002f;
+        int rtt = 40;
+        int stallsPerSample;
+        int stallMs;
+
+        SyntheticStream(String uid, long seed) {
+            this.uid = uid;
+            this.random = new Random(seed);
+        }
+
+        void fill(VideoChatQualityTelemetry.Sample sample) {
+            sample.reset(uid, false, INTERVAL_MS)
+                    .set(METRIC_VIDEO_KBPS, kbps + random.nextInt(41) - 20)
+                    .set(METRIC_FPS, fps)
+                    .set(METRIC_AUDIO_KBPS, 48)
+                    .set(METRIC_RTT, rtt)
+                    .set(METRIC_JITTER, 40 + random.nextInt(20))
+                    .loss(loss)
+                    .stalls(stallsPerSample, stallMs, 0, 0);
+        }
+    }
+
+    @Test
+    public void windowFollowsTheNetworkAndTheMeanTheSession() {
+        VideoChatQualityTelemetry telemetry = new VideoChatQualityTelemetry();
+        VideoChatQualityTelemetry.Sample sample = new VideoChatQualityTelemetry.Sample();
+        SyntheticStream stream = new SyntheticStream(HOST, 48);
+        long now = 0;
+        for (int i = 0; i < 60; i++, now += INTERVAL_MS) {
+            stream.fill(sample);
+            telemetry.onStats(sample, now);
+        }
+        assertNear(1_200, telemetry.getPercentile(HOST, false, METRIC_VIDEO_KBPS, 50), 20);
+        assertEquals(2, telemetry.getPercentile(HOST, false, METRIC_LOSS, 90));
+
+        // Congestion for a full window.
+        stream.kbps = 400;
+        stream.fps = 8;
+        stream.loss = 0.08f;
+        stream.rtt = 300;
+        for (int i = 0; i < VideoChatQualityTelemetry.WINDOW_SAMPLES; i++, now += INTERVAL_MS) {
+            stream.fill(sample);
+            telemetry.onStats(sample, now);
+        }
+        assertNear(400, telemetry.getPercentile(HOST, false, METRIC_VIDEO_KBPS, 50), 20);
+        assertEquals(8, telemetry.getPercentile(HOST, false, METRIC_FPS, 10));
+        assertEquals(80, telemetry.getPercentile(HOST, false, METRIC_LOSS, 50));
+        assertEquals(300, telemetry.getPercentile(HOST, false, METRIC_RTT, 90));
+        // 60 samples of 1200 and 30 of 400.
+        assertNear(933, telemetry.getMean(HOST, false, METRIC_VIDEO_KBPS), 10);
+        assertEquals(VideoChatQualityTelemetry.UNSET, telemetry.getPercentile(GUEST, false, METRIC_RTT, 50));
+    }
+
+    @Test
+    public void stallsAndBadQualityAreRated() {
+        VideoChatQualityTelemetry telemetry = new VideoChatQualityTelemetry();
+        VideoChatQualityTelemetry.Sample sample = new VideoChatQualityTelemetry.Sample();
+        SyntheticStream stream = new SyntheticStream(GUEST, 49);
+        long now = 0;
+        for (int i = 0; i < 50; i++, now += INTERVAL_MS) {
+            // One 500ms stall in every fifth interval.
+            stream.stallsPerSample = i % 5 == 0 ? 1 : 0;
+            stream.stallMs = i % 5 == 0 ? 500 : 0;
+            stream.fill(sample);
+            telemetry.onStats(sample, now);
+            telemetry.onQuality(GUEST, false, i % 4 != 0, now);
+        }
+        telemetry.onStats(new VideoChatQualityTelemetry.Sample().reset(HOST, true, INTERVAL_MS)
+                .set(METRIC_VIDEO_KBPS, 1_500).loss(0.01f).loss(0.002f), now);
+
+        assertEquals(5f, telemetry.getVideoStallPercent(GUEST, false), 0.01f);
+        assertEquals(10, telemetry.getPercentile(HOST, true, METRIC_LOSS, 50));
+        String summary = telemetry.summary();
+        assertTrue(summary, summary.startsWith("RTC quality 100s, 2 streams"));
+        assertTrue(summary, summary.contains(" stall v10/5.0% a0/0.0% bad 26%"));
+        assertTrue(summary, summary.contains("\nlocal host_1 2s kbps 1500/1500(1500) loss‰ 10/10(10)"));
+    }
+
+    @Test
+    public void summaryIsReportedEveryInterval() {
+        VideoChatQualityTelemetry telemetry = new VideoChatQualityTelemetry();
+        List<String> reports = new ArrayList<>();
+        telemetry.setReporter(reports::add);
+        VideoChatQualityTelemetry.Sample sample = new VideoChatQualityTelemetry.Sample();
+        SyntheticStream host = new SyntheticStream(HOST, 50);
+        SyntheticStream guest = new SyntheticStream(GUEST, 51);
+        for (long now = 0; now < 5 * VideoChatQualityTelemetry.SUMMARY_INTERVAL_MS; now += INTERVAL_MS) {
+            host.fill(sample);
+            telemetry.onStats(sample, now);
+            guest.fill(sample);
+            telemetry.onStats(sample, now + 5);
+        }
+        assertEquals(4, reports.size());
+        assertTrue(reports.get(0), reports.get(0).startsWith("RTC quality 60s, 2 streams\nhost_1 62s"));
+
+        telemetry.reset();
+        assertEquals(0, telemetry.getStreamCount());
+        assertEquals("RTC quality 0s, 0 streams", telemetry.summary());
+    }
+
+    @Test
+    public void streamsUpdatedLeastRecentlyAreDropped() {
+        VideoChatQualityTelemetry telemetry = new VideoChatQualityTelemetry();
+        VideoChatQualityTelemetry.Sample sample = new VideoChatQualityTelemetry.Sample();
+        for (int i = 0; i < VideoChatQualityTelemetry.MAX_STREAMS; i++) {
+            telemetry.onStats(sample.reset("user_" + i, false, INTERVAL_MS).set(METRIC_RTT, i), i);
+        }
+        // user_0 is still reported, user_1 left.
+        telemetry.onStats(sample.reset("user_0", false, INTERVAL_MS).set(METRIC_RTT, 0), 100);
+        telemetry.onStats(sample.reset("user_new", false, INTERVAL_MS).set(METRIC_RTT, 99), 101);
+
+        assertEquals(VideoChatQualityTelemetry.MAX_STREAMS, telemetry.getStreamCount());
+        assertEquals(1, telemetry.getDroppedStreamCount());
+        assertEquals(0, telemetry.getMean("user_0", false, METRIC_RTT));
+        assertEquals(VideoChatQualityTelemetry.UNSET, telemetry.getMean("user_1", false, METRIC_RTT));
+        assertEquals(99, telemetry.getMean("user_new", false, METRIC_RTT));
+    }
+
+    /**
+     * Cost of one stats callback: a room of nine streams, timed after warm up, and the bytes the
+     * callback thread allocated on the way, which should be none.
+     */
+    @Test
+    public void callbackCostBenchmark() {
+        Assume.assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        VideoChatQualityTelemetry telemetry = new VideoChatQualityTelemetry();
+        VideoChatQualityTelemetry.Sample sample = new VideoChatQualityTelemetry.Sample();
+        String[] uids = new String[9];
+        for (int i = 0; i < uids.length; i++) {
+            uids[i] = "user_" + i;
+        }
+        final int rounds = 200_000;
+        long[] now = new long[1];
+        runCallbacks(telemetry, sample, uids, rounds, now);
+
+        java.lang.management.ThreadMXBean threads = ManagementFactory.getThreadMXBean();
+        com.sun.management.ThreadMXBean allocations = threads instanceof com.sun.management.ThreadMXBean
+                ? (com.sun.management.ThreadMXBean) threads : null;
+        long threadId = Thread.currentThread().getId();
+        long allocatedBefore = allocations == null ? 0 : allocations.getThreadAllocatedBytes(threadId);
+        long startNs = System.nanoTime();
+        runCallbacks(telemetry, sample, uids, rounds, now);
+        long elapsedNs = System.nanoTime() - startNs;
+        long allocated = allocations == null ? 0 : allocations.getThreadAllocatedBytes(threadId) - allocatedBefore;
+
+        System.out.printf("quality telemetry: %d callbacks over %d streams, %dns per callback, %d bytes allocated%n",
+                rounds, uids.length, elapsedNs / rounds, allocated);
+        Assume.assumeTrue("allocation counting not supported", allocations != null);
+        // The counter itself may allocate a little, nothing per callback.
+        assertTrue(allocated + " bytes", allocated < 4_096);
+    }
+
+    private static void runCallbacks(VideoChatQualityTelemetry telemetry, VideoChatQualityTelemetry.Sample sample,
+                                     String[] uids, int rounds, long[] now) {
+        for (int i = 0; i < rounds; i++) {
+            int stream = i % uids.length;
+            sample.reset(uids[stream], stream == 0, INTERVAL_MS)
+                    .set(METRIC_VIDEO_KBPS, 800 + (i & 255))
+                    .set(METRIC_FPS, 15)
+                    .set(METRIC_AUDIO_KBPS, 48)
+                    .set(METRIC_RTT, 40 + (i & 63))
+                    .set(METRIC_JITTER, 30 + (i & 31))
+                    .loss((i & 7) / 100f)
+                    .stalls(i & 1, (i & 1) * 200, 0, 0);
+            telemetry.onStats(sample, now[0]);
+            if (stream == uids.length - 1) {
+                now[0] += INTERVAL_MS;
+            }
+        }
+    }
+
+    private static void assertNear(int expected, int actual, int tolerance) {
+        assertTrue(actual + " vs " + expected, Math.abs(actual - expected) <= tolerance);
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import org.junit.Test;
+
+import java.util.Random;
+
+/**
+ * Particle pool bounds, staggering and retiring.
+ */
+public class VideoChatReactionParticlesTest {
+
+    @Test
+    public void poolIsBoundedAndDropsAreCounted() {
+        VideoChatReactionParticles particles = new VideoChatReactionParticles(10, new Random(1));
+        assertEquals(6, particles.spawn(VideoChatReactions.KIND_LIKE, 6, 0, 0));
+        assertEquals(4, particles.spawn(VideoChatReactions.KIND_HEART, 9, 0, 0));
+        assertEquals(0, particles.spawn(VideoChatReactions.KIND_CLAP, 3, 0, 0));
+        assertEquals(10, particles.getCount());
+        assertEquals(10, particles.getSpawnedCount());
+        assertEquals(8, particles.getDroppedCount());
+    }
+
+    @Test
+    public void burstsAreSpreadAndRetired() {
+        VideoChatReactionParticles particles = new VideoChatReactionParticles(10, new Random(1));
+        particles.spawn(VideoChatReactions.KIND_LAUGH, 4, 1_000, 1_000);
+        int started = 0;
+        for (int i = 0; i < particles.getCount(); i++) {
+            assertEquals(VideoChatReactions.KIND_LAUGH, particles.kindAt(i));
+            float lane = particles.laneAt(i);
+            assertTrue(lane >= 0 && lane < 1);
+            if (particles.progressAt(i, 1_000) >= 0 && particles.progressAt(i, 1_000) < 0.01f) {
+                started++;
+            }
+        }
+        assertEquals("one starts now, the rest one after another", 1, started);
+
+        assertEquals(4, particles.step(1_000 + VideoChatReactionParticles.LIFETIME_MS - 1));
+        assertEquals(3, particles.step(1_000 + VideoChatReactionParticles.LIFETIME_MS));
+        assertEquals(0, particles.step(2_000 + VideoChatReactionParticles.LIFETIME_MS));
+
+        assertEquals("room is freed for new bursts", 10, particles.spawn(VideoChatReactions.KIND_LIKE, 10, 5_000, 0));
+    }
+
+    @Test
+    public void steadyStreamNeverGrowsThePool() {
+        VideoChatReactionParticles particles = new VideoChatReactionParticles(48, new Random(7));
+        long now = 0;
+        for (int frame = 0; frame < 60 * 30; frame++, now += 16) {
+            if (frame % 60 == 0) {
+                particles.spawn(VideoChatReactions.KIND_HEART, 200, now, 1_000);
+            }
+            assertTrue(particles.step(now) <= particles.getCapacity());
+        }
+        // A slot takes a particle a lifetime at most, the pool refills as they retire.
+        assertTrue(particles.getSpawnedCount() <= 48 * (now / VideoChatReactionParticles.LIFETIME_MS + 1));
+        assertTrue(particles.getSpawnedCount() >= 48 * 5);
+        assertEquals(200 * 30, particles.getSpawnedCount() + particles.getDroppedCount());
+    }
+}
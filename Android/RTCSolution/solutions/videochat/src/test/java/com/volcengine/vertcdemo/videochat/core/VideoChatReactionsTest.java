@@ -0,0 +1,302 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import androidx.annotation.NonNull;
+
+import com.volcengine.vertcdemo.common.VirtualScheduler;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * Reactions against a stand-in server merging every client and broadcasting on a fixed cadence.
+ */
+public class VideoChatReactionsTest {
+
+    private static final long UPLINK_MS = 40;
+    private static final long FANOUT_MS = 60;
+    private static final long CADENCE_MS = 500;
+
+    /**
+     * viSendReactions and viOnReactionTotals as the business server runs them: submissions are
+     * added up, every cadence the totals and what was added go to every client of the room.
+     */
+    private static class StandInServer {
+        final VirtualScheduler scheduler;
+        final List<Client> clients = new ArrayList<>();
+        final long[] totals = new long[VideoChatReactions.KIND_COUNT];
+        final int[] added = new int[VideoChatReactions.KIND_COUNT];
+        long seq;
+        long ackDelayMs = UPLINK_MS;
+        int failNext;
+        long received;
+
+        final Runnable tick = new Runnable() {
+            @Override
+            public void run() {
+                boolean any = false;
+                for (int count : added) {
+                    any |= count > 0;
+                }
+                if (any) {
+                    long broadcastSeq = ++seq;
+                    for (int kind = 0; kind < totals.length; kind++) {
+                        totals[kind] += added[kind];
+                    }
+                    long[] sentTotals = totals.clone();
+                    int[] sentAdded = added.clone();
+                    Arrays.fill(added, 0);
+                    for (Client client : clients) {
+                        scheduler.schedule(() -> client.reactions.onTotals(broadcastSeq, sentTotals.clone(),
+                                sentAdded.clone()), FANOUT_MS);
+                    }
+                }
+                scheduler.schedule(this, CADENCE_MS);
+            }
+        };
+
+        StandInServer(VirtualScheduler scheduler) {
+            this.scheduler = scheduler;
+            scheduler.schedule(tick, CADENCE_MS);
+        }
+
+        Client join() {
+            Client client = new Client(this);
+            clients.add(client);
+            return client;
+        }
+
+        void submit(int[] counts, VideoChatReactions.SendCallback callback) {
+            if (failNext > 0) {
+                failNext--;
+                scheduler.schedule(() -> callback.onResult(false), UPLINK_MS);
+                return;
+            }
+            scheduler.schedule(() -> {
+                received++;
+                for (int kind = 0; kind < counts.length; kind++) {
+                    added[kind] += counts[kind];
+                }
+            }, UPLINK_MS);
+            scheduler.schedule(() -> callback.onResult(true), UPLINK_MS + ackDelayMs);
+        }
+    }
+
+    private static class Client implements VideoChatReactions.Listener {
+        final VideoChatReactions reactions;
+        final long[] shownOwn = new long[VideoChatReactions.KIND_COUNT];
+        final long[] shownOthers = new long[VideoChatReactions.KIND_COUNT];
+        final long[] tapped = new long[VideoChatReactions.KIND_COUNT];
+        long[] totals = new long[VideoChatReactions.KIND_COUNT];
+
+        Client(StandInServer server) {
+            reactions = new VideoChatReactions(server::submit, server.scheduler);
+            reactions.setListener(this);
+        }
+
+        void tap(int kind) {
+            tapped[kind]++;
+            reactions.tap(kind);
+        }
+
+        @Override
+        public void onReactions(int kind, int count, boolean own) {
+            (own ? shownOwn : shownOthers)[kind] += count;
+        }
+
+        @Override
+        public void onTotals(@NonNull long[] totals) {
+            this.totals = totals;
+        }
+
+        long[] shown() {
+            long[] shown = new long[VideoChatReactions.KIND_COUNT];
+            for (int kind = 0; kind < shown.length; kind++) {
+                shown[kind] = shownOwn[kind] + shownOthers[kind];
+            }
+            return shown;
+        }
+    }
+
+    @Test
+    public void tapsOfAnIntervalGoInOneMessage() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        StandInServer server = new StandInServer(scheduler);
+        Client alice = server.join();
+        Client bob = server.join();
+
+        for (int i = 0; i < 30; i++) {
+            alice.tap(VideoChatReactions.KIND_LIKE);
+        }
+        alice.tap(VideoChatReactions.KIND_HEART);
+        assertEquals(31, alice.shownOwn[0] + alice.shownOwn[1]);
+        scheduler.runUntil(3_000);
+
+        assertEquals(1, alice.reactions.getMessageCount());
+        assertEquals(31, alice.reactions.getTapCount());
+        assertArrayEquals(new long[]{30, 1, 0, 0}, bob.totals);
+        assertArrayEquals(new long[]{30, 1, 0, 0}, bob.shownOthers);
+        assertArrayEquals(new long[]{30, 1, 0, 0}, alice.totals);
+        assertArrayEquals("own taps are not shown twice", new long[]{0, 0, 0, 0}, alice.shownOthers);
+    }
+
+    @Test
+    public void broadcastBeforeTheAnswerIsNotShownTwice() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        StandInServer server = new StandInServer(scheduler);
+        server.ackDelayMs = 3 * CADENCE_MS;
+        Client alice = server.join();
+
+        for (int second = 0; second < 5; second++) {
+            for (int i = 0; i < 7; i++) {
+                alice.tap(VideoChatReactions.KIND_CLAP);
+            }
+            scheduler.runUntil((second + 1) * 1_000);
+        }
+        scheduler.runUntil(20_000);
+
+        assertEquals(35, alice.totals[VideoChatReactions.KIND_CLAP]);
+        assertEquals(35, alice.shownOwn[VideoChatReactions.KIND_CLAP]);
+        assertEquals(0, alice.shownOthers[VideoChatReactions.KIND_CLAP]);
+    }
+
+    @Test
+    public void failedSendsAreRetriedWithLaterTaps() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        StandInServer server = new StandInServer(scheduler);
+        Client alice = server.join();
+        Client bob = server.join();
+        server.failNext = 2;
+
+        for (int i = 0; i < 5; i++) {
+            alice.tap(VideoChatReactions.KIND_LAUGH);
+        }
+        scheduler.runUntil(1_500);
+        alice.tap(VideoChatReactions.KIND_LAUGH);
+        scheduler.runUntil(10_000);
+
+        assertEquals(2, alice.reactions.getFailedCount());
+        assertEquals(3, alice.reactions.getMessageCount());
+        assertEquals(6, bob.totals[VideoChatReactions.KIND_LAUGH]);
+        assertEquals(6, bob.shownOthers[VideoChatReactions.KIND_LAUGH]);
+        assertEquals(0, alice.shownOthers[VideoChatReactions.KIND_LAUGH]);
+    }
+
+    @Test
+    public void pausedReactionsAreCountedAndSentOnResume() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        StandInServer server = new StandInServer(scheduler);
+        Client alice = server.join();
+        Client bob = server.join();
+
+        alice.reactions.pause();
+        for (int i = 0; i < 12; i++) {
+            alice.tap(VideoChatReactions.KIND_HEART);
+        }
+        scheduler.runUntil(5_000);
+        assertEquals(0, alice.reactions.getMessageCount());
+        assertEquals(0, bob.totals[VideoChatReactions.KIND_HEART]);
+
+        alice.reactions.resume();
+        scheduler.runUntil(8_000);
+        assertEquals(1, alice.reactions.getMessageCount());
+        assertEquals(12, bob.totals[VideoChatReactions.KIND_HEART]);
+    }
+
+    @Test
+    public void unbelievableBurstsAreCut() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        StandInServer server = new StandInServer(scheduler);
+        Client alice = server.join();
+        Client bob = server.join();
+
+        for (int i = 0; i < 5 * VideoChatReactions.MAX_COUNT_PER_FLUSH; i++) {
+            alice.tap(VideoChatReactions.KIND_LIKE);
+        }
+        scheduler.runUntil(5_000);
+        assertEquals(VideoChatReactions.MAX_COUNT_PER_FLUSH, bob.totals[VideoChatReactions.KIND_LIKE]);
+    }
+
+    @Test
+    public void staleBroadcastsAndEarlierRoomsAreDropped() {
+        VirtualScheduler scheduler = new VirtualScheduler();
+        List<VideoChatReactions.SendCallback> callbacks = new ArrayList<>();
+        VideoChatReactions reactions = new VideoChatReactions((counts, callback) -> callbacks.add(callback), scheduler);
+
+        reactions.onTotals(5, new long[]{10, 0, 0, 0}, new int[]{1, 0, 0, 0});
+        reactions.onTotals(4, new long[]{9, 0, 0, 0}, new int[]{1, 0, 0, 0});
+        reactions.onTotals(5, new long[]{10, 0, 0, 0}, new int[]{1, 0, 0, 0});
+        assertEquals(1, reactions.getBroadcastCount());
+        assertArrayEquals(new long[]{10, 0, 0, 0}, reactions.getTotals());
+
+        reactions.tap(VideoChatReactions.KIND_LIKE);
+        scheduler.runUntil(VideoChatReactions.FLUSH_INTERVAL_MS);
+        assertEquals(1, callbacks.size());
+        reactions.reset();
+        callbacks.get(0).onResult(false);
+        scheduler.runUntil(10_000);
+        assertEquals("the answer of the earlier room does not resend", 1, callbacks.size());
+
+        reactions.onTotals(1, new long[]{2, 0, 0, 0}, new int[]{2, 0, 0, 0});
+        assertArrayEquals(new long[]{2, 0, 0, 0}, reactions.getTotals());
+    }
+
+    /**
+     * Load generator: a crowded room tapping as fast as people do, messages sent against taps.
+     */
+    @Test
+    public void crowdedRoomLoad() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        final int clientCount = 300;
+        final long durationMs = 20_000;
+        VirtualScheduler scheduler = new VirtualScheduler();
+        StandInServer server = new StandInServer(scheduler);
+        Random random = new Random(43);
+
+        long taps = 0;
+        long[] tapped = new long[VideoChatReactions.KIND_COUNT];
+        for (int c = 0; c < clientCount; c++) {
+            Client client = server.join();
+            // Between 0.5 and 12 taps a second, bursts of the same kind.
+            double rate = 0.5 + random.nextDouble() * 11.5;
+            int kind = random.nextInt(VideoChatReactions.KIND_COUNT);
+            for (long at = (long) (random.nextDouble() * 1000 / rate); at < durationMs;
+                 at += 1 + (long) (-Math.log(1 - random.nextDouble()) * 1000 / rate)) {
+                int tapKind = random.nextInt(10) == 0 ? random.nextInt(VideoChatReactions.KIND_COUNT) : kind;
+                scheduler.schedule(() -> client.tap(tapKind), at);
+                tapped[tapKind]++;
+                taps++;
+            }
+        }
+        scheduler.runUntil(durationMs + 5_000);
+
+        long messages = 0;
+        for (Client client : server.clients) {
+            messages += client.reactions.getMessageCount();
+            assertArrayEquals(tapped, client.totals);
+            assertArrayEquals("every reaction shown once", tapped, client.shown());
+        }
+        assertEquals(messages, server.received);
+        assertTrue(messages + " messages for " + taps + " taps", messages * 4 < taps);
+        long maxMessages = clientCount * (durationMs / VideoChatReactions.FLUSH_INTERVAL_MS + 1);
+        assertTrue(messages <= maxMessages);
+        long broadcasts = server.seq;
+        assertTrue(broadcasts <= (durationMs + 5_000) / CADENCE_MS);
+
+        System.out.printf("reactions load: %d clients, %d taps -> %d messages (%.1f taps a message), "
+                        + "%d broadcasts, %d informs delivered instead of %d%n",
+                clientCount, taps, messages, (double) taps / messages, broadcasts,
+                broadcasts * clientCount, taps * (clientCount - 1));
+    }
+}
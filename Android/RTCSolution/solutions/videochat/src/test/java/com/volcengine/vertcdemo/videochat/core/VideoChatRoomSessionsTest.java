@@ -0,0 +1,138 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotEquals;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertSame;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import com.google.gson.Gson;
+import com.volcengine.vertcdemo.videochat.bean.JoinRoomEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import org.junit.Test;
+
+import java.util.HashMap;
+
+public class VideoChatRoomSessionsTest {
+
+    @Test
+    public void handsOffTheSameInstanceOnce() {
+        VideoChatRoomSessions sessions = new VideoChatRoomSessions();
+        JoinRoomEvent data = createRoom();
+        String id = sessions.put(data);
+
+        assertSame(data, sessions.take(id, JoinRoomEvent.class));
+        assertNull("taken already", sessions.take(id, JoinRoomEvent.class));
+        assertEquals(0, sessions.getPendingCount());
+    }
+
+    @Test
+    public void unknownIdOrTypeGivesNull() {
+        VideoChatRoomSessions sessions = new VideoChatRoomSessions();
+        String id = sessions.put(createRoom());
+
+        assertNull("process restarted", new VideoChatRoomSessions().take(id, JoinRoomEvent.class));
+        assertNull(sessions.take(null, JoinRoomEvent.class));
+        assertNull(sessions.take(id, VideoChatRoomInfo.class));
+    }
+
+    @Test
+    public void untakenEntriesAreBounded() {
+        VideoChatRoomSessions sessions = new VideoChatRoomSessions();
+        String first = sessions.put(createRoom());
+        String last = null;
+        for (int i = 0; i < VideoChatRoomSessions.MAX_PENDING; i++) {
+            last = sessions.put(createRoom());
+        }
+        assertNotEquals(first, last);
+        assertEquals(VideoChatRoomSessions.MAX_PENDING, sessions.getPendingCount());
+        assertNull("oldest dropped", sessions.take(first, JoinRoomEvent.class));
+        assertEquals(createRoom().roomInfo.roomId, sessions.take(last, JoinRoomEvent.class).roomInfo.roomId);
+    }
+
+    @Test
+    public void entryTraceAddsUpFirstFramesPerHandoff() {
+        VideoChatRoomSessions sessions = new VideoChatRoomSessions();
+        // Created, shown from the registry, first local frame captured.
+        sessions.traceOpen(1_000);
+        sessions.traceShown(1_050, VideoChatRoomSessions.HANDOFF_REGISTRY);
+        sessions.traceFirstFrame(1_400);
+        // Recreated after process death.
+        sessions.traceOpen(5_000);
+        sessions.traceShown(5_300, VideoChatRoomSessions.HANDOFF_PARCEL);
+        sessions.traceFirstFrame(5_900);
+        // Later frames of the same entry are not traced again.
+        sessions.traceFirstFrame(6_500);
+
+        assertEquals(400, sessions.getFirstFrameHistogram(VideoChatRoomSessions.HANDOFF_REGISTRY).getMax());
+        assertEquals(1, sessions.getFirstFrameHistogram(VideoChatRoomSessions.HANDOFF_PARCEL).getTotalCount());
+        assertEquals(900, sessions.getFirstFrameHistogram(VideoChatRoomSessions.HANDOFF_PARCEL).getMax());
+        assertNull(sessions.getFirstFrameHistogram(VideoChatRoomSessions.HANDOFF_JOIN));
+        String dump = sessions.dumpEntries();
+        assertTrue(dump, dump.contains("\nregistry shown 1 50/50, first frame 1 400/400"));
+    }
+
+    /**
+     * Room entry cost of the handoff alone: the JSON round trip the Intent extras used to do
+     * against the registry.
+     */
+    @Test
+    public void benchmarkHandoffAgainstJson() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        Gson gson = new Gson();
+        VideoChatRoomSessions sessions = new VideoChatRoomSessions();
+        JoinRoomEvent data = createRoom();
+        int rounds = 20_000;
+        for (int i = 0; i < 2_000; i++) {
+            gson.fromJson(gson.toJson(data), JoinRoomEvent.class);
+            sessions.take(sessions.put(data), JoinRoomEvent.class);
+        }
+        long start = System.nanoTime();
+        int seats = 0;
+        for (int i = 0; i < rounds; i++) {
+            seats += gson.fromJson(gson.toJson(data), JoinRoomEvent.class).seatMap.size();
+        }
+        long jsonNs = System.nanoTime() - start;
+        start = System.nanoTime();
+        for (int i = 0; i < rounds; i++) {
+            seats -= sessions.take(sessions.put(data), JoinRoomEvent.class).seatMap.size();
+        }
+        long registryNs = System.nanoTime() - start;
+        System.out.println("room handoff x" + rounds + ": json " + jsonNs / rounds + "ns"
+                + ", registry " + registryNs / rounds + "ns");
+
+        assertEquals(0, seats);
+    }
+
+    private static JoinRoomEvent createRoom() {
+        VideoChatUserInfo host = new VideoChatUserInfo();
+        host.userId = "host";
+        host.userName = "Host";
+        host.roomId = "room_1";
+        VideoChatRoomInfo room = new VideoChatRoomInfo();
+        room.roomId = "room_1";
+        room.roomName = "Room";
+        room.hostUserId = host.userId;
+        room.hostUserName = host.userName;
+        JoinRoomEvent data = new JoinRoomEvent();
+        data.roomInfo = room;
+        data.hostInfo = host;
+        data.userInfo = host;
+        data.rtcToken = "token";
+        data.seatMap = new HashMap<>();
+        for (int i = 1; i <= 6; i++) {
+            VideoChatSeatInfo seat = new VideoChatSeatInfo();
+            seat.seatIndex = i;
+            seat.status = VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+            data.seatMap.put(i, seat);
+        }
+        return data;
+    }
+}
@@ -0,0 +1,339 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+import com.google.gson.Gson;
+import com.volcengine.vertcdemo.videochat.bean.AnchorInfo;
+import com.volcengine.vertcdemo.videochat.bean.InteractInfo;
+import com.volcengine.vertcdemo.videochat.bean.JoinRoomEvent;
+import com.volcengine.vertcdemo.videochat.bean.ReconnectRoomEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+import java.util.Set;
+
+/**
+ * Fault injection for resumable reconnect: a stand-in server mutates seats while the
+ * connection randomly drops notices and reconnect replies, the client must converge.
+ */
+public class VideoChatRoomStateSyncTest {
+
+    private static final int SEAT_COUNT = 6;
+    // Changes the stand-in server keeps for deltas, older clients get a full snapshot.
+    private static final int DELTA_HISTORY = 16;
+
+    /**
+     * Authoritative room state with a bounded change log.
+     */
+    private static class StandInServer {
+        final Map<Integer, VideoChatSeatInfo> seats = new HashMap<>();
+        final List<Integer> changeLog = new ArrayList<>(); // seat id changed at version index + 1
+        final VideoChatRoomInfo roomInfo = new VideoChatRoomInfo();
+        final VideoChatUserInfo host = user("host", VideoChatUserInfo.USER_ROLE_HOST);
+        final VideoChatUserInfo self = user("self", VideoChatUserInfo.USER_ROLE_AUDIENCE);
+        long version = 1;
+
+        StandInServer() {
+            roomInfo.roomId = "room";
+            roomInfo.status = VideoChatRoomInfo.ROOM_STATUS_CHATTING;
+            changeLog.add(-1);
+        }
+
+        /**
+         * Apply a random seat change and return it as a notice.
+         */
+        VideoChatSeatInfo mutate(Random random) {
+            int seatId = 1 + random.nextInt(SEAT_COUNT);
+            VideoChatSeatInfo seat = new VideoChatSeatInfo();
+            seat.seatIndex = seatId;
+            int op = random.nextInt(4);
+            if (op == 0) {
+                seat.status = VideoChatDataManager.SEAT_STATUS_LOCKED;
+            } else {
+                seat.status = VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+                if (op != 1) {
+                    seat.userInfo = user("guest" + random.nextInt(20), VideoChatUserInfo.USER_ROLE_AUDIENCE);
+                    seat.userInfo.mic = random.nextInt(2);
+                    seat.userInfo.camera = random.nextInt(2);
+                }
+            }
+            seats.put(seatId, seat);
+            version++;
+            changeLog.add(seatId);
+            return seat.deepCopy();
+        }
+
+        JoinRoomEvent reconnect(long clientVersion) {
+            JoinRoomEvent event = new ReconnectRoomEvent();
+            event.stateVersion = version;
+            if (clientVersion == version) {
+                event.syncType = JoinRoomEvent.SYNC_TYPE_NONE;
+                return event;
+            }
+            event.seatMap = new HashMap<>();
+            if (clientVersion > 0 && version - clientVersion <= DELTA_HISTORY) {
+                event.syncType = JoinRoomEvent.SYNC_TYPE_DELTA;
+                for (long v = clientVersion + 1; v <= version; v++) {
+                    int seatId = changeLog.get((int) v - 1);
+                    event.seatMap.put(seatId, seats.get(seatId).deepCopy());
+                }
+                return event;
+            }
+            event.syncType = JoinRoomEvent.SYNC_TYPE_FULL;
+            event.audienceCount = 3;
+            event.roomInfo = roomInfo;
+            event.hostInfo = host.deepCopy();
+            event.userInfo = self.deepCopy();
+            for (Map.Entry<Integer, VideoChatSeatInfo> entry : seats.entrySet()) {
+                event.seatMap.put(entry.getKey(), entry.getValue().deepCopy());
+            }
+            return event;
+        }
+    }
+
+    /**
+     * What the seat views show, patched the same way VideoChatRoomMainActivity does.
+     */
+    private static class Client {
+        final VideoChatRoomStateSync sync = new VideoChatRoomStateSync();
+        final Map<Integer, VideoChatSeatInfo> shown = new HashMap<>();
+        int seatBinds;
+        int rebuilds;
+
+        void join(JoinRoomEvent data) {
+            sync.reset(data);
+            rebuild(data);
+        }
+
+        void onNotice(VideoChatSeatInfo seat) {
+            if (seat.userInfo == null) {
+                sync.onSeatUserChanged(seat.seatIndex, null);
+            } else {
+                sync.onSeatUserChanged(seat.seatIndex, seat.userInfo);
+            }
+            sync.onSeatStatusChanged(seat.seatIndex, seat.status);
+            shown.put(seat.seatIndex, seat);
+            seatBinds++;
+        }
+
+        void onReconnected(JoinRoomEvent data) {
+            VideoChatRoomStateSync.Plan plan = sync.apply(data);
+            if (plan.noChange) {
+                return;
+            }
+            if (plan.needsRebuild()) {
+                rebuild(plan.snapshot);
+                return;
+            }
+            for (Map.Entry<Integer, VideoChatSeatInfo> entry : plan.changedSeats.entrySet()) {
+                shown.put(entry.getKey(), entry.getValue());
+                seatBinds++;
+            }
+        }
+
+        private void rebuild(JoinRoomEvent data) {
+            rebuilds++;
+            shown.clear();
+            for (Map.Entry<Integer, VideoChatSeatInfo> entry : data.seatMap.entrySet()) {
+                shown.put(entry.getKey(), entry.getValue());
+                seatBinds++;
+            }
+        }
+    }
+
+    @Test
+    public void convergesUnderRandomDrops() {
+        Random random = new Random(20231019);
+        StandInServer server = new StandInServer();
+        Client client = new Client();
+        client.join(server.reconnect(0));
+
+        int reconnects = 0;
+        for (int round = 0; round < 200; round++) {
+            // Connected phase: notices arrive.
+            int changes = random.nextInt(4);
+            for (int i = 0; i < changes; i++) {
+                client.onNotice(server.mutate(random));
+            }
+            // Drop the connection at a random point: changes made meanwhile are lost.
+            int lost = random.nextInt(round % 10 == 0 ? 30 : 5);
+            for (int i = 0; i < lost; i++) {
+                server.mutate(random);
+            }
+            // Reconnect, the reply itself may be lost and is retried.
+            while (true) {
+                JoinRoomEvent reply = server.reconnect(client.sync.getStateVersion());
+                if (random.nextInt(5) == 0) {
+                    continue;
+                }
+                client.onReconnected(reply);
+                break;
+            }
+            reconnects++;
+
+            assertConverged(server, client);
+            assertEquals(server.version, client.sync.getStateVersion());
+        }
+        assertTrue("full snapshot only when the delta history is exceeded", client.rebuilds < reconnects / 4);
+    }
+
+    @Test
+    public void unchangedStateReplyRebindsNothing() {
+        StandInServer server = new StandInServer();
+        Random random = new Random(1);
+        server.mutate(random);
+        Client client = new Client();
+        client.join(server.reconnect(0));
+        int binds = client.seatBinds;
+
+        JoinRoomEvent reply = server.reconnect(client.sync.getStateVersion());
+        assertEquals(JoinRoomEvent.SYNC_TYPE_NONE, reply.syncType);
+        client.onReconnected(reply);
+
+        assertEquals(binds, client.seatBinds);
+        assertEquals(1, client.rebuilds);
+    }
+
+    @Test
+    public void unchangedReplyWithANewVersionKeepsTheState() {
+        StandInServer server = new StandInServer();
+        Random random = new Random(5);
+        for (int i = 0; i < 4; i++) {
+            server.mutate(random);
+        }
+        Client client = new Client();
+        JoinRoomEvent joined = server.reconnect(0);
+        AnchorInfo anchor = new AnchorInfo();
+        anchor.roomId = "peer_room";
+        anchor.userId = "peer";
+        joined.anchorList = Collections.singletonList(anchor);
+        client.join(joined);
+        Map<Integer, VideoChatSeatInfo> seats = new HashMap<>(client.sync.getSeats());
+        int binds = client.seatBinds;
+
+        JoinRoomEvent reply = new ReconnectRoomEvent();
+        reply.syncType = JoinRoomEvent.SYNC_TYPE_NONE;
+        reply.stateVersion = server.version + 1;
+        client.onReconnected(reply);
+
+        assertEquals(server.version + 1, client.sync.getStateVersion());
+        assertEquals(seats, client.sync.getSeats());
+        assertEquals(binds, client.seatBinds);
+        assertEquals(1, client.rebuilds);
+        VideoChatRoomStateSync.Plan plan = client.sync.apply(reply);
+        assertTrue(plan.noChange);
+        assertEquals(Collections.singletonList(anchor), plan.snapshot.anchorList);
+        assertEquals(seats.keySet(), plan.snapshot.seatMap.keySet());
+    }
+
+    @Test
+    public void deltaPatchesOnlyChangedSeats() {
+        StandInServer server = new StandInServer();
+        Random random = new Random(7);
+        for (int i = 0; i < 6; i++) {
+            server.mutate(random);
+        }
+        Client client = new Client();
+        client.join(server.reconnect(0));
+        Set<Integer> changed = new HashSet<>();
+        changed.add(server.mutate(random).seatIndex);
+
+        JoinRoomEvent reply = server.reconnect(client.sync.getStateVersion());
+        VideoChatRoomStateSync.Plan plan = client.sync.apply(reply);
+
+        assertEquals(JoinRoomEvent.SYNC_TYPE_DELTA, reply.syncType);
+        assertFalse(plan.needsRebuild());
+        assertTrue(changed.containsAll(plan.changedSeats.keySet()));
+        assertTrue(plan.changedSeats.size() <= 1);
+    }
+
+    @Test
+    public void deltaKeepsFieldsItLeavesOut() {
+        StandInServer server = new StandInServer();
+        Client client = new Client();
+        JoinRoomEvent joined = server.reconnect(0);
+        joined.rtcToken = "token";
+        InteractInfo interact = new InteractInfo();
+        interact.userId = "guest";
+        joined.interactInfos = Collections.singletonList(interact);
+        client.join(joined);
+
+        server.mutate(new Random(3));
+        String json = "{\"state_version\":" + server.version + ",\"sync_type\":" + JoinRoomEvent.SYNC_TYPE_DELTA
+                + ",\"seat_list\":{\"1\":{\"status\":1}}}";
+        JoinRoomEvent reply = new Gson().fromJson(json, ReconnectRoomEvent.class);
+        VideoChatRoomStateSync.Plan plan = client.sync.apply(reply);
+
+        assertFalse(plan.audienceCountChanged);
+        assertEquals(3, plan.snapshot.audienceCount);
+        assertEquals("token", plan.snapshot.rtcToken);
+        assertEquals("guest", plan.snapshot.interactInfos.get(0).userId);
+        JoinRoomEvent unchanged = new ReconnectRoomEvent();
+        unchanged.stateVersion = server.version;
+        unchanged.syncType = JoinRoomEvent.SYNC_TYPE_NONE;
+        assertEquals("the held state kept them too", 3, client.sync.apply(unchanged).snapshot.audienceCount);
+    }
+
+    @Test
+    public void roomStatusChangeForcesRebuild() {
+        StandInServer server = new StandInServer();
+        Client client = new Client();
+        client.join(server.reconnect(0));
+        VideoChatRoomInfo living = new VideoChatRoomInfo();
+        living.roomId = "room";
+        living.status = VideoChatRoomInfo.ROOM_STATUS_LIVING;
+        JoinRoomEvent reply = server.reconnect(0);
+        reply.roomInfo = living;
+        reply.stateVersion = server.version + 1;
+
+        VideoChatRoomStateSync.Plan plan = client.sync.apply(reply);
+
+        assertTrue(plan.roomStatusChanged);
+        assertTrue(plan.needsRebuild());
+    }
+
+    private static void assertConverged(StandInServer server, Client client) {
+        for (int seatId = 1; seatId <= SEAT_COUNT; seatId++) {
+            VideoChatSeatInfo expected = server.seats.get(seatId);
+            VideoChatSeatInfo actual = client.shown.get(seatId);
+            if (expected == null) {
+                assertTrue(actual == null || (actual.userInfo == null && !actual.isLocked()));
+                continue;
+            }
+            assertEquals("seat " + seatId + " lock", expected.status, actual == null
+                    ? VideoChatDataManager.SEAT_STATUS_UNLOCKED : actual.status);
+            if (expected.userInfo == null) {
+                assertNull("seat " + seatId + " user", actual == null ? null : actual.userInfo);
+            } else {
+                assertEquals("seat " + seatId + " user", expected.userInfo.userId, actual.userInfo.userId);
+                assertEquals("seat " + seatId + " mic", expected.userInfo.mic, actual.userInfo.mic);
+                assertEquals("seat " + seatId + " camera", expected.userInfo.camera, actual.userInfo.camera);
+            }
+        }
+    }
+
+    private static VideoChatUserInfo user(String userId, int role) {
+        VideoChatUserInfo info = new VideoChatUserInfo();
+        info.roomId = "room";
+        info.userId = userId;
+        info.userName = userId;
+        info.userRole = role;
+        return info;
+    }
+}
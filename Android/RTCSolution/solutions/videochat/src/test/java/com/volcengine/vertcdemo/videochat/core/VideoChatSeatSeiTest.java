@@ -0,0 +1,220 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import org.junit.Test;
+
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+
+/**
+ * Encoding and decoding of the seat state SEI, and how the host writer and viewer reader use it.
+ */
+public class VideoChatSeatSeiTest {
+
+    @Test
+    public void roundTripKeepsEverySlot() {
+        Map<Integer, VideoChatSeatInfo> seats = new HashMap<>();
+        seats.put(1, seat(1, user("guest_1", true, true), false));
+        seats.put(2, seat(2, null, true));
+        seats.put(3, seat(3, user("观众_3", false, true), true));
+        seats.put(5, seat(5, user("guest_5", false, false), false));
+        VideoChatSeatSei sei = VideoChatSeatSei.build(42, 7, user("host", true, false), seats);
+
+        assertEquals(VideoChatMixedStreamLayout.SLOT_COUNT, sei.slots.size());
+        assertEquals(new VideoChatSeatSei.Slot(0, false, "host", true, false), sei.getSlot(0));
+        assertEquals(new VideoChatSeatSei.Slot(2, true, null, false, false), sei.getSlot(2));
+        assertEquals(new VideoChatSeatSei.Slot(4, false, null, false, false), sei.getSlot(4));
+        assertEquals(new VideoChatSeatSei.Slot(5, false, "guest_5", false, false), sei.getSlot(5));
+
+        assertEquals(sei, VideoChatSeatSei.decode(sei.encode()));
+        assertEquals(sei, VideoChatSeatSei.fromText(sei.toText()));
+        assertTrue("fits a single SEI easily", sei.encode().length < 100);
+    }
+
+    @Test
+    public void wireLayoutIsStable() {
+        VideoChatSeatSei sei = new VideoChatSeatSei(0x1234, 0x01020304L, Arrays.asList(
+                new VideoChatSeatSei.Slot(0, false, "h", true, false),
+                new VideoChatSeatSei.Slot(1, true, null, false, false)));
+        byte[] expected = {
+                'V', 'C', 1, 7,
+                0x12, 0x34, 1, 2, 3, 4, 2,
+                4, 0, (byte) (VideoChatSeatSei.FLAG_OCCUPIED | VideoChatSeatSei.FLAG_MIC), 1, 'h',
+                3, 1, (byte) VideoChatSeatSei.FLAG_LOCKED, 0,
+        };
+        assertArrayEquals(expected, sei.encode());
+        assertEquals("VkMBBxI0AQIDBAIEAAYBaAMBAQA=", sei.toText());
+    }
+
+    @Test
+    public void newerVersionFieldsAreSkipped() {
+        byte[] v2 = {
+                'V', 'C', 2, 9,
+                0x00, 0x05, 0, 0, 0, 9, 2, 0x7F, 0x7F, // two unknown header bytes
+                6, 0, (byte) (VideoChatSeatSei.FLAG_OCCUPIED | VideoChatSeatSei.FLAG_CAMERA | 0x80), 1, 'h', 0x55, 0x55,
+                3, 4, 0, 0,
+        };
+        VideoChatSeatSei sei = VideoChatSeatSei.decode(v2);
+        assertNotNull(sei);
+        assertEquals(5, sei.session);
+        assertEquals(9, sei.sequence);
+        assertEquals(Arrays.asList(
+                new VideoChatSeatSei.Slot(0, false, "h", false, true),
+                new VideoChatSeatSei.Slot(4, false, null, false, false)), sei.slots);
+    }
+
+    @Test
+    public void cutOrForeignSeiIsRejected() {
+        byte[] data = VideoChatSeatSei.build(1, 1, user("host", true, true), null).encode();
+        for (int length = 0; length < data.length; length++) {
+            assertNull("cut at " + length, VideoChatSeatSei.decode(Arrays.copyOf(data, length)));
+        }
+        byte[] foreign = data.clone();
+        foreign[0] = 'X';
+        assertNull(VideoChatSeatSei.decode(foreign));
+        byte[] badRecord = data.clone();
+        badRecord[11] = 2; // shorter than the fixed record fields
+        assertNull(VideoChatSeatSei.decode(badRecord));
+
+        assertNull(VideoChatSeatSei.decode(null));
+        assertNull(VideoChatSeatSei.fromText(null));
+        assertNull(VideoChatSeatSei.fromText(""));
+        assertNull(VideoChatSeatSei.fromText("{\"ts\":1700000000000}"));
+        assertNull(VideoChatSeatSei.fromText("VkMB====")); // padding in the middle
+        String text = VideoChatSeatSei.build(1, 1, null, null).toText();
+        assertNull(VideoChatSeatSei.fromText(text.substring(0, text.length() - 4)));
+    }
+
+    @Test
+    public void randomBytesNeverThrow() {
+        Random random = new Random(36);
+        for (int i = 0; i < 10_000; i++) {
+            byte[] data = new byte[random.nextInt(64)];
+            random.nextBytes(data);
+            if (data.length > 2) {
+                data[0] = 'V';
+                data[1] = 'C';
+            }
+            VideoChatSeatSei sei = VideoChatSeatSei.decode(data);
+            if (sei != null) {
+                assertEquals(sei, VideoChatSeatSei.decode(sei.encode()));
+            }
+        }
+    }
+
+    @Test
+    public void idTooLongForARecordIsAnUnknownOccupant() {
+        char[] chars = new char[VideoChatSeatSei.MAX_USER_ID_BYTES + 1];
+        Arrays.fill(chars, 'u');
+        VideoChatSeatSei sei = VideoChatSeatSei.build(1, 1, user(new String(chars), true, true), null);
+        VideoChatSeatSei decoded = VideoChatSeatSei.decode(sei.encode());
+        assertNotNull(decoded);
+        assertEquals(new VideoChatSeatSei.Slot(0, false, "", true, true), decoded.getSlot(0));
+        assertFalse(decoded.getSlot(0).isEmpty());
+    }
+
+    @Test
+    public void writerSendsOnlyChanges() {
+        VideoChatSeatSei.Writer writer = new VideoChatSeatSei.Writer(3);
+        VideoChatUserInfo host = user("host", true, true);
+        Map<Integer, VideoChatSeatInfo> seats = new HashMap<>();
+        byte[] first = writer.update(host, seats);
+        assertNotNull(first);
+        assertNull("unchanged state is not sent again", writer.update(host, seats));
+        assertArrayEquals(first, writer.getPayload());
+
+        seats.put(1, seat(1, user("guest", true, false), false));
+        byte[] second = writer.update(host, seats);
+        assertNotNull(second);
+        VideoChatSeatSei sent = VideoChatSeatSei.fromText(new String(second, StandardCharsets.US_ASCII));
+        assertNotNull(sent);
+        assertEquals(3, sent.session);
+        assertEquals(2, sent.sequence);
+        assertEquals("guest", sent.getSlot(1).userId);
+    }
+
+    @Test
+    public void readerReportsEachChangeOnce() {
+        VideoChatSeatSei.Writer writer = new VideoChatSeatSei.Writer(3);
+        VideoChatSeatSei.Reader reader = new VideoChatSeatSei.Reader();
+        VideoChatUserInfo host = user("host", true, true);
+        Map<Integer, VideoChatSeatInfo> seats = new HashMap<>();
+        seats.put(1, seat(1, user("guest", true, true), false));
+
+        VideoChatSeatSei baseline = read(writer.update(host, seats));
+        assertTrue("first SEI is a baseline", reader.onReceived(baseline).isEmpty());
+
+        seats.get(1).userInfo.camera = VideoChatUserInfo.CAMERA_STATUS_OFF;
+        seats.put(2, seat(2, null, true));
+        VideoChatSeatSei changed = read(writer.update(host, seats));
+        List<VideoChatSeatSei.Slot> slots = reader.onReceived(changed);
+        assertEquals(Arrays.asList(
+                new VideoChatSeatSei.Slot(1, false, "guest", true, false),
+                new VideoChatSeatSei.Slot(2, true, null, false, false)), slots);
+
+        // Repeated frames, the same SEI through the player, and a late older one.
+        assertTrue(reader.onReceived(changed).isEmpty());
+        assertTrue(reader.onReceived(VideoChatSeatSei.fromText(changed.toText())).isEmpty());
+        assertTrue(reader.onReceived(baseline).isEmpty());
+        assertEquals(3, reader.getDroppedCount());
+
+        // A host that came back starts a new session: baseline again.
+        VideoChatSeatSei restarted = new VideoChatSeatSei(4, 1, baseline.slots);
+        assertTrue(reader.onReceived(restarted).isEmpty());
+        VideoChatSeatSei next = new VideoChatSeatSei(4, 2, changed.slots);
+        assertEquals(2, reader.onReceived(next).size());
+    }
+
+    @Test
+    public void sequenceWrapsAround() {
+        VideoChatSeatSei.Reader reader = new VideoChatSeatSei.Reader();
+        List<VideoChatSeatSei.Slot> empty = Collections.singletonList(
+                new VideoChatSeatSei.Slot(0, false, "host", false, false));
+        List<VideoChatSeatSei.Slot> micOn = Collections.singletonList(
+                new VideoChatSeatSei.Slot(0, false, "host", true, false));
+        reader.onReceived(new VideoChatSeatSei(1, 0xFFFFFFFFL, empty));
+        VideoChatSeatSei wrapped = new VideoChatSeatSei(1, 0xFFFFFFFFL + 1, micOn);
+        assertEquals(0, wrapped.sequence);
+        assertEquals(micOn, reader.onReceived(wrapped));
+    }
+
+    private static VideoChatSeatSei read(byte[] payload) {
+        assertNotNull(payload);
+        VideoChatSeatSei sei = VideoChatSeatSei.fromText(new String(payload, StandardCharsets.US_ASCII));
+        assertNotNull(sei);
+        return sei;
+    }
+
+    private static VideoChatUserInfo user(String userId, boolean micOn, boolean cameraOn) {
+        VideoChatUserInfo info = new VideoChatUserInfo();
+        info.userId = userId;
+        info.mic = micOn ? VideoChatUserInfo.MIC_STATUS_ON : VideoChatUserInfo.MIC_STATUS_OFF;
+        info.camera = cameraOn ? VideoChatUserInfo.CAMERA_STATUS_ON : VideoChatUserInfo.CAMERA_STATUS_OFF;
+        return info;
+    }
+
+    private static VideoChatSeatInfo seat(int seatId, VideoChatUserInfo userInfo, boolean locked) {
+        VideoChatSeatInfo seat = new VideoChatSeatInfo();
+        seat.seatIndex = seatId;
+        seat.userInfo = userInfo;
+        seat.status = locked ? VideoChatDataManager.SEAT_STATUS_LOCKED : VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+        return seat;
+    }
+}
@@ -0,0 +1,341 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.core;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNotSame;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertSame;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import com.volcengine.vertcdemo.videochat.bean.VideoChatSeatInfo;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatUserInfo;
+
+import org.junit.Test;
+
+import java.lang.management.ManagementFactory;
+import java.lang.management.ThreadMXBean;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+
+/**
+ * Seat table semantics, and the allocations of the seat grid over a replayed hour of seat and
+ * media notices compared with copying the seat on every bind.
+ */
+public class VideoChatSeatTableTest {
+
+    private static final String ROOM_ID = "room";
+
+    @Test
+    public void mediaTogglesReuseTheSameSeats() {
+        VideoChatSeatTable table = new VideoChatSeatTable();
+        assertTrue(table.setUser(1, user("guest", true, true)));
+        VideoChatSeat bound = table.get(1);
+        long version = table.getVersion();
+
+        assertEquals(1, table.setMedia("guest", false, true));
+        VideoChatSeat muted = table.get(1);
+        assertNotSame(bound, muted);
+        assertTrue(bound.sameOccupant(muted));
+        assertFalse(muted.isMicOn());
+        assertTrue(muted.isCameraOn());
+
+        assertEquals(1, table.setMedia("guest", true, true));
+        assertSame(bound, table.get(1));
+        assertEquals(version + 2, table.getVersion());
+
+        assertEquals("no change, no new version", -1, table.setMedia("guest", true, true));
+        assertEquals(-1, table.setMedia("nobody", false, false));
+        assertEquals(version + 2, table.getVersion());
+    }
+
+    @Test
+    public void lockStatusSurvivesOccupantChanges() {
+        VideoChatSeatTable table = new VideoChatSeatTable();
+        assertTrue(table.setStatus(2, VideoChatDataManager.SEAT_STATUS_LOCKED));
+        assertTrue(table.get(2).isEmpty());
+        assertTrue(table.get(2).isLocked());
+        assertFalse(table.setStatus(2, VideoChatDataManager.SEAT_STATUS_LOCKED));
+
+        assertFalse(table.setStatus(3, VideoChatDataManager.SEAT_STATUS_UNLOCKED));
+        table.setUser(3, user("guest", true, false));
+        table.setStatus(3, VideoChatDataManager.SEAT_STATUS_LOCKED);
+        table.setUser(3, null);
+        assertTrue("leaving a locked seat keeps it locked", table.get(3).isLocked());
+        assertSame(table.get(2), table.get(3));
+
+        table.setSeat(3, null);
+        assertSame("a missing seat in a response is empty and unlocked", VideoChatSeat.EMPTY, table.get(3));
+    }
+
+    @Test
+    public void returningGuestsReuseTheirSeats() {
+        VideoChatSeatTable table = new VideoChatSeatTable();
+        table.setUser(1, user("guest", true, true));
+        VideoChatSeat first = table.get(1);
+        table.setUser(1, null);
+        table.setUser(1, user("guest", true, true)); // a new bean from the next notice
+        assertSame(first, table.get(1));
+
+        VideoChatUserInfo renamed = user("guest", true, true);
+        renamed.userName = "renamed";
+        table.setUser(1, renamed);
+        assertFalse(first.sameOccupant(table.get(1)));
+        assertEquals("renamed", table.get(1).userName);
+    }
+
+    @Test
+    public void seatIdsOutsideTheGridAreIgnored() {
+        VideoChatSeatTable table = new VideoChatSeatTable();
+        assertFalse(table.setUser(VideoChatSeatTable.SEAT_COUNT, user("overflow", true, true)));
+        assertFalse(table.setSeat(-1, seat(user("guest", true, true), false)));
+        assertFalse(table.setStatus(99, VideoChatDataManager.SEAT_STATUS_LOCKED));
+        assertEquals(0, table.getVersion());
+        assertEquals(-1, table.indexOf("overflow"));
+    }
+
+    @Test
+    public void seatInfoCopyMatchesTheSeat() {
+        VideoChatSeatTable table = new VideoChatSeatTable();
+        VideoChatUserInfo host = user("host", false, true);
+        host.userRole = VideoChatUserInfo.USER_ROLE_HOST;
+        table.setUser(0, host);
+        assertTrue(table.get(0).isHost());
+
+        VideoChatSeatInfo info = table.get(0).toSeatInfo(0);
+        assertEquals(0, info.seatIndex);
+        assertFalse(info.isLocked());
+        assertEquals("host", info.userInfo.userId);
+        assertEquals(ROOM_ID, info.userInfo.roomId);
+        assertFalse(info.userInfo.isMicOn());
+        assertTrue(info.userInfo.isCameraOn());
+        assertTrue(info.userInfo.isHost());
+
+        VideoChatSeatInfo empty = VideoChatSeat.EMPTY.withStatus(VideoChatDataManager.SEAT_STATUS_LOCKED).toSeatInfo(4);
+        assertEquals(4, empty.seatIndex);
+        assertTrue(empty.isLocked());
+        assertNull(empty.userInfo);
+    }
+
+    /**
+     * What VideoChatSeatLayout, VideoChatSeatsGroupLayout and VideoChatRoomFragment did before
+     * the table: a seat bean per interact notice, a deep copy of the user on every bind, and a
+     * scan of all seats for each one bound.
+     */
+    private static class CopyingSeats {
+        final List<VideoChatSeatInfo> seats = new ArrayList<>();
+
+        CopyingSeats() {
+            for (int i = 0; i < VideoChatSeatTable.SEAT_COUNT; i++) {
+                VideoChatSeatInfo info = new VideoChatSeatInfo();
+                info.seatIndex = i;
+                info.status = VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+                seats.add(info);
+            }
+        }
+
+        void onInteract(int seatId, VideoChatUserInfo user, boolean start) {
+            VideoChatSeatInfo info = new VideoChatSeatInfo();
+            info.userInfo = user;
+            info.status = VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+            for (VideoChatSeatInfo seat : seats) {
+                if (seat.seatIndex == seatId) {
+                    seat.status = info.status;
+                    seat.userInfo = start ? info.userInfo.deepCopy() : null;
+                    break;
+                }
+            }
+        }
+
+        void onMedia(String userId, boolean mic, boolean camera) {
+            for (VideoChatSeatInfo seat : seats) {
+                if (seat.userInfo != null && userId.equals(seat.userInfo.userId)) {
+                    seat.userInfo.mic = mic ? VideoChatUserInfo.MIC_STATUS_ON : VideoChatUserInfo.MIC_STATUS_OFF;
+                    seat.userInfo.camera = camera ? VideoChatUserInfo.CAMERA_STATUS_ON : VideoChatUserInfo.CAMERA_STATUS_OFF;
+                }
+            }
+        }
+
+        void onStatus(int seatId, int status) {
+            for (VideoChatSeatInfo seat : seats) {
+                if (seat.seatIndex == seatId) {
+                    seat.status = status;
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     * The table behind VideoChatSeatsGroupLayout, with the seats the views last bound.
+     */
+    private static class TableSeats {
+        final VideoChatSeatTable table = new VideoChatSeatTable();
+        final VideoChatSeat[] bound = new VideoChatSeat[VideoChatSeatTable.SEAT_COUNT];
+        long boundVersion = -1;
+        int binds;
+
+        void bindChanged() {
+            if (table.getVersion() == boundVersion) {
+                return;
+            }
+            boundVersion = table.getVersion();
+            for (int i = 0; i < bound.length; i++) {
+                if (bound[i] != table.get(i)) {
+                    bound[i] = table.get(i);
+                    binds++;
+                }
+            }
+        }
+    }
+
+    private static final int KIND_INTERACT = 0;
+    private static final int KIND_MEDIA = 1;
+    private static final int KIND_STATUS = 2;
+
+    private static class Notice {
+        int kind;
+        int seatId;
+        boolean start;
+        VideoChatUserInfo user;
+        int status;
+    }
+
+    @Test
+    public void replayedHourAllocatesNoSeatCopies() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        ThreadMXBean bean = ManagementFactory.getThreadMXBean();
+        assumeTrue("needs per thread allocation counters",
+                bean instanceof com.sun.management.ThreadMXBean
+                        && ((com.sun.management.ThreadMXBean) bean).isThreadAllocatedMemorySupported());
+        com.sun.management.ThreadMXBean threads = (com.sun.management.ThreadMXBean) bean;
+        long threadId = Thread.currentThread().getId();
+
+        List<Notice> hour = replayHour(new Random(37));
+
+        // Warm both paths up so the measured pass sees compiled code and settled caches.
+        for (int i = 0; i < 5; i++) {
+            replayCopying(hour);
+            replayTable(hour, new TableSeats());
+        }
+        TableSeats tableSeats = new TableSeats();
+        for (int i = 0; i < 2; i++) {
+            replayTable(hour, tableSeats); // a room that has seen these guests before
+        }
+
+        long start = threads.getThreadAllocatedBytes(threadId);
+        replayCopying(hour);
+        long copyingBytes = threads.getThreadAllocatedBytes(threadId) - start;
+
+        start = threads.getThreadAllocatedBytes(threadId);
+        replayTable(hour, tableSeats);
+        long tableBytes = threads.getThreadAllocatedBytes(threadId) - start;
+
+        System.out.println("seat notices in one hour: " + hour.size()
+                + ", copying binds: " + copyingBytes + " bytes"
+                + ", seat table: " + tableBytes + " bytes, " + tableSeats.binds + " seat binds");
+        assertTrue("copying path does allocate", copyingBytes > 16_384);
+        assertTrue("seat table allocates next to nothing, got " + tableBytes, tableBytes < 4_096);
+    }
+
+    /**
+     * An hour of a busy chat room, a notice every half a second: guests from a pool of twenty
+     * hopping on and off the five guest seats, toggling mic and camera, the host locking seats.
+     */
+    private static List<Notice> replayHour(Random random) {
+        List<VideoChatUserInfo> pool = new ArrayList<>();
+        for (int i = 0; i < 20; i++) {
+            pool.add(user("audience_" + i, true, true));
+        }
+        Map<Integer, VideoChatUserInfo> seated = new HashMap<>();
+        List<Notice> notices = new ArrayList<>();
+        for (int t = 0; t < 3600 * 2; t++) {
+            Notice notice = new Notice();
+            int seatId = 1 + random.nextInt(VideoChatSeatTable.SEAT_COUNT - 1);
+            VideoChatUserInfo sitting = seated.get(seatId);
+            int roll = random.nextInt(100);
+            notice.seatId = seatId;
+            if (roll < 15) {
+                notice.kind = KIND_INTERACT;
+                notice.start = sitting == null;
+                if (notice.start) {
+                    VideoChatUserInfo source = pool.get(random.nextInt(pool.size()));
+                    if (seated.containsValue(source)) {
+                        continue;
+                    }
+                    seated.put(seatId, source);
+                    notice.user = source.deepCopy(); // every notice carries its own bean
+                } else {
+                    seated.remove(seatId);
+                    notice.user = sitting.deepCopy();
+                }
+            } else if (roll < 25) {
+                notice.kind = KIND_STATUS;
+                notice.status = random.nextBoolean()
+                        ? VideoChatDataManager.SEAT_STATUS_LOCKED : VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+            } else {
+                if (sitting == null) {
+                    continue;
+                }
+                notice.kind = KIND_MEDIA;
+                notice.user = sitting.deepCopy();
+                notice.user.mic = random.nextInt(2);
+                notice.user.camera = random.nextInt(2);
+            }
+            notices.add(notice);
+        }
+        return notices;
+    }
+
+    private static void replayCopying(List<Notice> hour) {
+        CopyingSeats seats = new CopyingSeats();
+        for (int i = 0, size = hour.size(); i < size; i++) {
+            Notice notice = hour.get(i);
+            if (notice.kind == KIND_INTERACT) {
+                seats.onInteract(notice.seatId, notice.user, notice.start);
+            } else if (notice.kind == KIND_MEDIA) {
+                seats.onMedia(notice.user.userId, notice.user.isMicOn(), notice.user.isCameraOn());
+            } else {
+                seats.onStatus(notice.seatId, notice.status);
+            }
+        }
+    }
+
+    private static void replayTable(List<Notice> hour, TableSeats seats) {
+        for (int i = 0, size = hour.size(); i < size; i++) {
+            Notice notice = hour.get(i);
+            if (notice.kind == KIND_INTERACT) {
+                seats.table.setUser(notice.seatId, notice.start ? notice.user : null);
+            } else if (notice.kind == KIND_MEDIA) {
+                seats.table.setMedia(notice.user.userId, notice.user.isMicOn(), notice.user.isCameraOn());
+            } else {
+                seats.table.setStatus(notice.seatId, notice.status);
+            }
+            seats.bindChanged();
+        }
+    }
+
+    private static VideoChatUserInfo user(String userId, boolean micOn, boolean cameraOn) {
+        VideoChatUserInfo info = new VideoChatUserInfo();
+        info.userId = userId;
+        info.userName = userId;
+        info.roomId = ROOM_ID;
+        info.userStatus = VideoChatUserInfo.USER_STATUS_INTERACT;
+        info.mic = micOn ? VideoChatUserInfo.MIC_STATUS_ON : VideoChatUserInfo.MIC_STATUS_OFF;
+        info.camera = cameraOn ? VideoChatUserInfo.CAMERA_STATUS_ON : VideoChatUserInfo.CAMERA_STATUS_OFF;
+        return info;
+    }
+
+    private static VideoChatSeatInfo seat(VideoChatUserInfo userInfo, boolean locked) {
+        VideoChatSeatInfo seat = new VideoChatSeatInfo();
+        seat.userInfo = userInfo;
+        seat.status = locked ? VideoChatDataManager.SEAT_STATUS_LOCKED : VideoChatDataManager.SEAT_STATUS_UNLOCKED;
+        return seat;
+    }
+}
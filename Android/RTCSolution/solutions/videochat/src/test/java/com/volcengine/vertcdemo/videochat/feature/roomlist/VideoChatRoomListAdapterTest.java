@@ -0,0 +1,124 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.feature.roomlist;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotEquals;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import android.content.Context;
+import android.view.View;
+
+import androidx.annotation.NonNull;
+import androidx.recyclerview.widget.LinearLayoutManager;
+import androidx.recyclerview.widget.RecyclerView;
+
+import com.volcengine.vertcdemo.utils.AppUtil;
+
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+import org.robolectric.RobolectricTestRunner;
+import org.robolectric.RuntimeEnvironment;
+import org.robolectric.annotation.LooperMode;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+
+/**
+ * The room list adapter in a real RecyclerView, rows are inflated from the app's layout.
+ */
+@RunWith(RobolectricTestRunner.class)
+@LooperMode(LooperMode.Mode.LEGACY)
+public class VideoChatRoomListAdapterTest {
+
+    private static final int ROOM_COUNT = 500;
+    private static final int WIDTH_PX = 1080;
+    private static final int HEIGHT_PX = 1920;
+    private static final long FRAME_BUDGET_US = 16_667;
+
+    /**
+     * Times every onBindViewHolder.
+     */
+    private static class TimedAdapter extends VideoChatRoomListAdapter {
+        final List<Long> bindUs = new ArrayList<>();
+
+        TimedAdapter() {
+            super(null);
+        }
+
+        @Override
+        public void onBindViewHolder(@NonNull RecyclerView.ViewHolder holder, int position) {
+            long start = System.nanoTime();
+            super.onBindViewHolder(holder, position);
+            bindUs.add((System.nanoTime() - start) / 1000);
+        }
+    }
+
+    private Context mContext;
+
+    @Before
+    public void setUp() {
+        // Rows size their icon with Utils.dp2Px
+        AppUtil.initApp(RuntimeEnvironment.getApplication());
+        mContext = RuntimeEnvironment.getApplication();
+    }
+
+    @Test
+    public void stableIdsFollowTheRoom() {
+        TimedAdapter adapter = new TimedAdapter();
+        // The first list is applied without a diff.
+        adapter.setRoomList(VideoChatRoomListPagerTest.rooms(0, 3));
+
+        assertEquals(VideoChatRoomListAdapter.stableId("room_1"), adapter.getItemId(1));
+        assertNotEquals(adapter.getItemId(0), adapter.getItemId(1));
+        assertEquals(RecyclerView.NO_ID, VideoChatRoomListAdapter.stableId(null));
+    }
+
+    @Test
+    public void scrollThrough500RoomsBenchmark() {
+        assumeTrue("benchmark, run with -Dbenchmark=true", Boolean.getBoolean("benchmark"));
+        TimedAdapter adapter = new TimedAdapter();
+        RecyclerView recyclerView = new RecyclerView(mContext);
+        recyclerView.setLayoutManager(new LinearLayoutManager(mContext, RecyclerView.VERTICAL, false));
+        recyclerView.setAdapter(adapter);
+        // The first list is applied without a diff.
+        adapter.setRoomList(VideoChatRoomListPagerTest.rooms(0, ROOM_COUNT));
+        recyclerView.measure(View.MeasureSpec.makeMeasureSpec(WIDTH_PX, View.MeasureSpec.EXACTLY),
+                View.MeasureSpec.makeMeasureSpec(HEIGHT_PX, View.MeasureSpec.EXACTLY));
+        recyclerView.layout(0, 0, WIDTH_PX, HEIGHT_PX);
+
+        // A fling of about a third of a row a frame, until the last row is on screen.
+        int step = Math.max(1, recyclerView.getChildAt(0).getHeight() / 3);
+        List<Long> frameUs = new ArrayList<>();
+        while (recyclerView.canScrollVertically(1)) {
+            long start = System.nanoTime();
+            recyclerView.scrollBy(0, step);
+            frameUs.add((System.nanoTime() - start) / 1000);
+        }
+
+        int overBudget = 0;
+        for (long us : frameUs) {
+            if (us > FRAME_BUDGET_US) {
+                overBudget++;
+            }
+        }
+        System.out.printf("scroll through %d rooms: %d frames p50 %dus p95 %dus max %dus, %d over %dus; "
+                        + "%d binds p50 %dus p95 %dus max %dus%n",
+                ROOM_COUNT, frameUs.size(), percentile(frameUs, 50), percentile(frameUs, 95),
+                Collections.max(frameUs), overBudget, FRAME_BUDGET_US,
+                adapter.bindUs.size(), percentile(adapter.bindUs, 50), percentile(adapter.bindUs, 95),
+                Collections.max(adapter.bindUs));
+
+        assertTrue("every room was bound on its way through the screen", adapter.bindUs.size() >= ROOM_COUNT);
+    }
+
+    private static long percentile(List<Long> values, int percent) {
+        List<Long> sorted = new ArrayList<>(values);
+        Collections.sort(sorted);
+        return sorted.get(Math.min(sorted.size() - 1, sorted.size() * percent / 100));
+    }
+}
@@ -0,0 +1,228 @@
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+
+package com.volcengine.vertcdemo.videochat.feature.roomlist;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+import androidx.annotation.Nullable;
+import androidx.recyclerview.widget.DiffUtil;
+import androidx.recyclerview.widget.ListUpdateCallback;
+
+import com.volcengine.vertcdemo.core.net.IRequestCallback;
+import com.volcengine.vertcdemo.videochat.bean.GetActiveRoomListEvent;
+import com.volcengine.vertcdemo.videochat.bean.VideoChatRoomInfo;
+
+import org.junit.Before;
+import org.junit.Test;
+
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+
+public class VideoChatRoomListPagerTest {
+
+    private static final int ROOM_COUNT = 500;
+
+    private static class PendingLoad {
+        final String pageToken;
+        final String etag;
+        final IRequestCallback<GetActiveRoomListEvent> callback;
+
+        PendingLoad(String pageToken, String etag, IRequestCallback<GetActiveRoomListEvent> callback) {
+            this.pageToken = pageToken;
+            this.etag = etag;
+            this.callback = callback;
+        }
+    }
+
+    private final ArrayDeque<PendingLoad> mLoads = new ArrayDeque<>();
+    private final List<List<VideoChatRoomInfo>> mPublished = new ArrayList<>();
+    private final List<Integer> mErrors = new ArrayList<>();
+    private VideoChatRoomListPager mPager;
+
+    @Before
+    public void setUp() {
+        mPager = new VideoChatRoomListPager(
+                (pageToken, pageSize, etag, callback) -> mLoads.add(new PendingLoad(pageToken, etag, callback)),
+                VideoChatRoomListPager.DEFAULT_PAGE_SIZE);
+        mPager.setListener(new VideoChatRoomListPager.Listener() {
+            @Override
+            public void onRoomListChanged(List<VideoChatRoomInfo> roomList) {
+                mPublished.add(roomList);
+            }
+
+            @Override
+            public void onError(int errorCode, String message) {
+                mErrors.add(errorCode);
+            }
+        });
+    }
+
+    @Test
+    public void loadMoreAppendsAndDedupes() {
+        mPager.refresh(true);
+        mLoads.poll().callback.onSuccess(page(rooms(0, 20), "p1", true, "e1"));
+        assertEquals(20, mPager.getRoomList().size());
+
+        mPager.loadMore();
+        mPager.loadMore();
+        assertEquals("only one page in flight", 1, mLoads.size());
+        PendingLoad next = mLoads.poll();
+        assertEquals("p1", next.pageToken);
+        // Rooms shift between pages: 15..19 are returned again.
+        next.callback.onSuccess(page(rooms(15, 40), "p2", false, null));
+
+        assertEquals(40, mPager.getRoomList().size());
+        assertFalse(mPager.hasMore());
+    }
+
+    @Test
+    public void unchangedEtagShortCircuits() {
+        mPager.refresh(true);
+        mLoads.poll().callback.onSuccess(page(rooms(0, 20), null, false, "e1"));
+        int publishCount = mPublished.size();
+
+        mPager.refresh(false);
+        PendingLoad load = mLoads.poll();
+        assertEquals("e1", load.etag);
+        GetActiveRoomListEvent notModified = new GetActiveRoomListEvent();
+        notModified.notModified = true;
+        load.callback.onSuccess(notModified);
+
+        assertEquals(publishCount, mPublished.size());
+        assertEquals(1, mPager.getNotModifiedCount());
+        assertEquals(20, mPager.getRoomList().size());
+    }
+
+    @Test
+    public void forcedRefreshDropsAppendedPages() {
+        mPager.refresh(true);
+        mLoads.poll().callback.onSuccess(page(rooms(0, 20), "p1", true, "e1"));
+        mPager.loadMore();
+        mLoads.poll().callback.onSuccess(page(rooms(20, 40), "p2", true, null));
+        assertEquals(40, mPager.getRoomList().size());
+
+        mPager.refresh(true);
+        PendingLoad load = mLoads.poll();
+        assertNull(load.etag);
+        // Same etag echoed back, rooms 20..39 closed in the meantime.
+        load.callback.onSuccess(page(rooms(0, 20), "p1b", true, "e1"));
+
+        assertEquals(20, mPager.getRoomList().size());
+        assertEquals(0, mPager.getNotModifiedCount());
+        mPager.loadMore();
+        assertEquals("the cursor restarts from the new first page", "p1b", mLoads.poll().pageToken);
+    }
+
+    @Test
+    public void onlyForcedRefreshReportsErrors() {
+        mPager.refresh(false);
+        mLoads.poll().callback.onError(500, "background");
+        assertTrue(mErrors.isEmpty());
+
+        mPager.refresh(true);
+        mLoads.poll().callback.onError(501, "pulled");
+        assertEquals(Collections.singletonList(501), mErrors);
+    }
+
+    @Test
+    public void staleResponseIsDropped() {
+        mPager.refresh(true);
+        PendingLoad stale = mLoads.poll();
+        mPager.refresh(true);
+        PendingLoad fresh = mLoads.poll();
+
+        fresh.callback.onSuccess(page(rooms(0, 3), null, false, "e2"));
+        stale.callback.onSuccess(page(rooms(0, 10), null, false, "e1"));
+
+        assertEquals(3, mPager.getRoomList().size());
+        assertFalse(mPager.isLoading());
+    }
+
+    @Test
+    public void refreshOf500RoomsRebindsOnlyChangedRows() {
+        List<VideoChatRoomInfo> before = rooms(0, ROOM_COUNT);
+        List<VideoChatRoomInfo> after = rooms(0, ROOM_COUNT);
+        after.get(10).audienceCount++;
+        after.get(250).audienceCount++;
+        after.remove(400);
+
+        int[] counts = new int[4];
+        DiffUtil.calculateDiff(new DiffUtil.Callback() {
+            @Override
+            public int getOldListSize() {
+                return before.size();
+            }
+
+            @Override
+            public int getNewListSize() {
+                return after.size();
+            }
+
+            @Override
+            public boolean areItemsTheSame(int oldItemPosition, int newItemPosition) {
+                return VideoChatRoomListAdapter.DIFF_CALLBACK.areItemsTheSame(
+                        before.get(oldItemPosition), after.get(newItemPosition));
+            }
+
+            @Override
+            public boolean areContentsTheSame(int oldItemPosition, int newItemPosition) {
+                return VideoChatRoomListAdapter.DIFF_CALLBACK.areContentsTheSame(
+                        before.get(oldItemPosition), after.get(newItemPosition));
+            }
+        }).dispatchUpdatesTo(new ListUpdateCallback() {
+            @Override
+            public void onInserted(int position, int count) {
+                counts[0] += count;
+            }
+
+            @Override
+            public void onRemoved(int position, int count) {
+                counts[1] += count;
+            }
+
+            @Override
+            public void onMoved(int fromPosition, int toPosition) {
+                counts[2]++;
+            }
+
+            @Override
+            public void onChanged(int position, int count, @Nullable Object payload) {
+                counts[3] += count;
+            }
+        });
+
+        assertEquals(0, counts[0]);
+        assertEquals(1, counts[1]);
+        assertEquals(0, counts[2]);
+        assertEquals(2, counts[3]);
+    }
+
+    private static GetActiveRoomListEvent page(List<VideoChatRoomInfo> rooms, String nextPageToken,
+                                               boolean hasMore, String etag) {
+        GetActiveRoomListEvent event = new GetActiveRoomListEvent();
+        event.roomList = rooms;
+        event.nextPageToken = nextPageToken;
+        event.hasMore = hasMore;
+        event.etag = etag;
+        return event;
+    }
+
+    static List<VideoChatRoomInfo> rooms(int from, int to) {
+        List<VideoChatRoomInfo> list = new ArrayList<>(to - from);
+        for (int i = from; i < to; i++) {
+            VideoChatRoomInfo info = new VideoChatRoomInfo();
+            info.roomId = "room_" + i;
+            info.roomName = "Room " + i;
+            info.hostUserName = "host" + i;
+            info.audienceCount = i % 7;
+            list.add(info);
+        }
+        return list;
+    }
+}
@@ -9,7 +9,9 @@
 #import "RTCJoinModel.h"
 #import "RTSACKModel.h"
 #import "RTSNoticeModel.h"
+#import "RTSLatencyTracer.h"
 #import "RTSRequestModel.h"
+#import "RTSSessionRecorder.h"
 #import <BytePlusRTC/objc/ByteRTCRoom.h>
 #import <BytePlusRTC/objc/ByteRTCVideo.h>
 #import <Foundation/Foundation.h>
@@ -24,6 +26,12 @@ typedef void (^RTCRoomMessageBlock)(RTSNoticeModel *noticeModel);
 // Engine management
 @property (nonatomic, strong, nullable) ByteRTCVideo *rtcEngineKit;
 
+// Latency of RTS requests by event_name, see -[RTSLatencyTracer dump]
+@property (nonatomic, strong, readonly) RTSLatencyTracer *latencyTracer;
+
+// Log of the RTS messages sent and received, debug builds only, in Caches/rts_sessions
+@property (nonatomic, strong, readonly, nullable) RTSSessionRecorder *sessionRecorder;
+
 /**
  * @brief Open RTS connection
  * @param appID APPID, needed to initialize ByteRTCVideo.
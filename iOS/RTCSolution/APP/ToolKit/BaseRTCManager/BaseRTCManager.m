@@ -5,6 +5,8 @@
 
 #import "BaseRTCManager.h"
 #import "LocalizatorBundle.h"
+#import "MainThreadWatchdog.h"
+#import <QuartzCore/QuartzCore.h>
 
 typedef NSString *RTSMessageType;
 static RTSMessageType const RTSMessageTypeResponse = @"return";
@@ -16,6 +18,8 @@ static RTSMessageType const RTSMessageTypeNotice = @"inform";
 @property (nonatomic, copy) void (^rtcSetParamsBlock)(BOOL result);
 @property (nonatomic, strong) NSMutableDictionary *listenerDic;
 @property (nonatomic, strong) NSMutableDictionary *senderDic;
+@property (nonatomic, strong, readwrite) RTSLatencyTracer *latencyTracer;
+@property (nonatomic, strong, readwrite, nullable) RTSSessionRecorder *sessionRecorder;
 
 @end
 
@@ -44,6 +48,11 @@ static RTSMessageType const RTSMessageTypeNotice = @"inform";
     // Create an engine instance.
     self.rtcEngineKit = [ByteRTCVideo createRTCVideo:appID delegate:self parameters:@{}];
     [self configeRTCEngine];
+#ifdef DEBUG
+    [self.sessionRecorder close];
+    NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+    self.sessionRecorder = [RTSSessionRecorder recorderInDirectory:[caches stringByAppendingPathComponent:@"rts_sessions"]];
+#endif
 
     // Set Business ID
     [self.rtcEngineKit setBusinessId:bid];
@@ -84,11 +93,14 @@ static RTSMessageType const RTSMessageTypeNotice = @"inform";
     self.rtcEngineKit = nil;
     self.rtcLoginBlock = nil;
     self.rtcSetParamsBlock = nil;
+    [self.sessionRecorder close];
+    self.sessionRecorder = nil;
 }
 
 - (void)emitWithAck:(NSString *)event
                with:(NSDictionary *)item
               block:(RTCSendServerMessageBlock)block {
+    NSTimeInterval enqueueTime = CACurrentMediaTime();
     if (IsEmptyStr(event)) {
         [self throwErrorAck:RTSStatusCodeInvalidArgument
                     message:@"Lack EventName"
@@ -117,10 +129,13 @@ static RTSMessageType const RTSMessageTypeNotice = @"inform";
     requestModel.content = [item yy_modelToJSONString];
     requestModel.deviceID = [NetworkingTool getDeviceId];
     requestModel.requestBlock = block;
+    requestModel.enqueueTime = enqueueTime;
     NSString *json = [requestModel yy_modelToJSONString];
 
+    [self.sessionRecorder recordOutbound:json];
     // Client side sends a text message to the application server (P2Server)
     requestModel.msgid = (NSInteger)[self.rtcEngineKit sendServerMessage:json];
+    requestModel.sendTime = CACurrentMediaTime();
 
     NSString *key = requestModel.requestID;
     [self.senderDic setValue:requestModel forKey:key];
@@ -167,6 +182,12 @@ static RTSMessageType const RTSMessageTypeNotice = @"inform";
     if (error == ByteRTCUserMessageSendResultSuccess) {
         // 发送成功，等待业务回调信息
         // Successfully sent, waiting for business callback information
+        for (RTSRequestModel *model in self.senderDic.allValues) {
+            if (model.msgid == msgid) {
+                model.sendResultTime = CACurrentMediaTime();
+                break;
+            }
+        }
     } else {
         // 发送失败
         // Failed to send
@@ -174,6 +195,7 @@ static RTSMessageType const RTSMessageTypeNotice = @"inform";
         for (RTSRequestModel *model in self.senderDic.allValues) {
             if (model.msgid == msgid) {
                 key = model.requestID;
+                [self.latencyTracer recordSendFailureForRequest:model];
                 [self throwErrorAck:RTSStatusCodeSendMessageFaild
                             message:[NetworkingTool messageFromResponseCode:RTSStatusCodeSendMessageFaild]
                               block:model.requestBlock];
@@ -244,6 +266,9 @@ static RTSMessageType const RTSMessageTypeNotice = @"inform";
 #pragma mark - Private Action
 
 - (void)dispatchMessageFrom:(NSString *)uid message:(NSString *)message {
+    if (message) {
+        [self.sessionRecorder recordInbound:message from:uid];
+    }
     NSDictionary *dic = [NetworkingTool decodeJsonMessage:message];
     if (!dic || !dic.count) {
         return;
@@ -270,9 +295,12 @@ static RTSMessageType const RTSMessageTypeNotice = @"inform";
     NSString *key = ackModel.requestID;
     RTSRequestModel *model = self.senderDic[key];
     if (model && [model isKindOfClass:[RTSRequestModel class]]) {
+        [self.latencyTracer recordAnswerForRequest:model success:ackModel.result];
         if (model.requestBlock) {
             dispatch_queue_async_safe(dispatch_get_main_queue(), ^{
+                NSString *previous = [MainThreadWatchdog enter:model.eventName];
                 model.requestBlock(ackModel);
+                [MainThreadWatchdog exit:previous];
             });
         }
     }
@@ -287,7 +315,9 @@ static RTSMessageType const RTSMessageTypeNotice = @"inform";
     RTCRoomMessageBlock block = self.listenerDic[noticeModel.eventName];
     if (block) {
         dispatch_queue_async_safe(dispatch_get_main_queue(), ^{
+            NSString *previous = [MainThreadWatchdog enter:noticeModel.eventName];
             block(noticeModel);
+            [MainThreadWatchdog exit:previous];
         });
     }
 }
@@ -314,6 +344,13 @@ static RTSMessageType const RTSMessageTypeNotice = @"inform";
     return _listenerDic;
 }
 
+- (RTSLatencyTracer *)latencyTracer {
+    if (!_latencyTracer) {
+        _latencyTracer = [[RTSLatencyTracer alloc] init];
+    }
+    return _latencyTracer;
+}
+
 - (NSMutableDictionary *)senderDic {
     if (!_senderDic) {
         _senderDic = [[NSMutableDictionary alloc] init];
@@ -23,6 +23,13 @@ typedef void (^RTCSendServerMessageBlock)(RTSACKModel *ackModel);
 @property (nonatomic, assign) BOOL imChannel;
 @property (nonatomic, copy) RTCSendServerMessageBlock requestBlock;
 
+/*
+ * Local timestamps for RTSLatencyTracer, CACurrentMediaTime, 0 if not reached. Not sent.
+ */
+@property (nonatomic, assign) NSTimeInterval enqueueTime;
+@property (nonatomic, assign) NSTimeInterval sendTime;
+@property (nonatomic, assign) NSTimeInterval sendResultTime;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -19,4 +19,8 @@
     };
 }
 
++ (NSArray<NSString *> *)modelPropertyBlacklist {
+    return @[@"enqueueTime", @"sendTime", @"sendResultTime"];
+}
+
 @end
@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import <Foundation/Foundation.h>
+@class RTSRequestModel;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ * Latency histogram in the way of HdrHistogram: exact below 32ms, above that every power of two
+ * is split into 16 buckets, so any value is off by at most 1/16. Fixed size.
+ */
+@interface RTSLatencyHistogram : NSObject
+
+@property (nonatomic, assign, readonly) uint64_t totalCount;
+
+@property (nonatomic, assign, readonly) uint64_t maxValue;
+
+- (void)recordValue:(uint64_t)milliseconds;
+
+/*
+ * @param percentile 0 to 100
+ * @return The highest value equivalent to the one at the percentile in ms, never above the max
+ */
+- (uint64_t)valueAtPercentile:(double)percentile;
+
+@end
+
+/*
+ * Times every RTS request end to end: enqueued, handed to the SDK, send result of the SDK and
+ * answer of the business server, one histogram per stage and event_name.
+ */
+@interface RTSLatencyTracer : NSObject
+
+/*
+ * Call when the answer of the request arrived, with the times stamped on the request.
+ */
+- (void)recordAnswerForRequest:(RTSRequestModel *)request success:(BOOL)success;
+
+- (void)recordSendFailureForRequest:(RTSRequestModel *)request;
+
+/*
+ * @param stage queue, send, answer or total
+ */
+- (nullable RTSLatencyHistogram *)histogramForEvent:(NSString *)eventName stage:(NSString *)stage;
+
+/*
+ * Per event_name and stage: count, p50, p90, p99 and max in ms
+ */
+- (NSString *)dump;
+
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import "RTSLatencyTracer.h"
+#import "RTSRequestModel.h"
+#import <QuartzCore/QuartzCore.h>
+
+#define RTSHistogramSubBucketBits 4
+#define RTSHistogramSubBuckets (1 << RTSHistogramSubBucketBits)
+// Below this every ms has its own bucket.
+#define RTSHistogramLinearLimit (RTSHistogramSubBuckets * 2)
+// 2^24 ms is about 4.6 hours.
+#define RTSHistogramMaxExponent 23
+#define RTSHistogramBucketCount (RTSHistogramLinearLimit + (RTSHistogramMaxExponent - RTSHistogramSubBucketBits) * RTSHistogramSubBuckets)
+
+static const uint64_t RTSHistogramMaxValue = (1ULL << (RTSHistogramMaxExponent + 1)) - 1;
+static const NSUInteger RTSTracerMaxEvents = 64;
+
+static NSString *const RTSStageQueue = @"queue";
+static NSString *const RTSStageSend = @"send";
+static NSString *const RTSStageAnswer = @"answer";
+static NSString *const RTSStageTotal = @"total";
+
+@interface RTSLatencyHistogram () {
+    uint64_t _counts[RTSHistogramBucketCount];
+}
+
+@property (nonatomic, assign, readwrite) uint64_t totalCount;
+@property (nonatomic, assign, readwrite) uint64_t maxValue;
+
+@end
+
+@implementation RTSLatencyHistogram
+
+- (void)recordValue:(uint64_t)milliseconds {
+    uint64_t value = MIN(milliseconds, RTSHistogramMaxValue);
+    _counts[[RTSLatencyHistogram indexOf:value]]++;
+    self.totalCount++;
+    self.maxValue = MAX(self.maxValue, value);
+}
+
+- (uint64_t)valueAtPercentile:(double)percentile {
+    if (self.totalCount == 0) {
+        return 0;
+    }
+    double p = MAX(0, MIN(100, percentile));
+    uint64_t target = MAX(1, (uint64_t)ceil(p / 100 * self.totalCount));
+    uint64_t seen = 0;
+    for (int i = 0; i < RTSHistogramBucketCount; i++) {
+        seen += _counts[i];
+        if (seen >= target) {
+            return MIN([RTSLatencyHistogram highestEquivalent:i], self.maxValue);
+        }
+    }
+    return self.maxValue;
+}
+
++ (int)indexOf:(uint64_t)value {
+    if (value < RTSHistogramLinearLimit) {
+        return (int)value;
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - RTSHistogramSubBucketBits;
+    int subBucket = (int)(value >> shift) - RTSHistogramSubBuckets;
+    return RTSHistogramLinearLimit + (exponent - RTSHistogramSubBucketBits - 1) * RTSHistogramSubBuckets + subBucket;
+}
+
++ (uint64_t)highestEquivalent:(int)index {
+    if (index < RTSHistogramLinearLimit) {
+        return index;
+    }
+    int k = index - RTSHistogramLinearLimit;
+    int exponent = RTSHistogramSubBucketBits + 1 + k / RTSHistogramSubBuckets;
+    int shift = exponent - RTSHistogramSubBucketBits;
+    uint64_t mantissa = RTSHistogramSubBuckets + k % RTSHistogramSubBuckets;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+@end
+
+@interface RTSLatencyTracer ()
+
+// event_name -> stage -> histogram
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, RTSLatencyHistogram *> *> *eventDic;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *sendFailureDic;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *errorAnswerDic;
+
+@end
+
+@implementation RTSLatencyTracer
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _eventDic = [[NSMutableDictionary alloc] init];
+        _sendFailureDic = [[NSMutableDictionary alloc] init];
+        _errorAnswerDic = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (void)recordAnswerForRequest:(RTSRequestModel *)request success:(BOOL)success {
+    NSTimeInterval now = CACurrentMediaTime();
+    @synchronized (self) {
+        NSString *eventName = [self nameOfEvent:request.eventName];
+        NSMutableDictionary<NSString *, RTSLatencyHistogram *> *stages = [self stagesOfEvent:eventName];
+        [stages[RTSStageQueue] recordValue:[self millisecondsFrom:request.enqueueTime to:request.sendTime]];
+        if (request.sendResultTime > 0) {
+            [stages[RTSStageSend] recordValue:[self millisecondsFrom:request.sendTime to:request.sendResultTime]];
+        }
+        [stages[RTSStageAnswer] recordValue:[self millisecondsFrom:request.sendTime to:now]];
+        [stages[RTSStageTotal] recordValue:[self millisecondsFrom:request.enqueueTime to:now]];
+        if (!success) {
+            self.errorAnswerDic[eventName] = @(self.errorAnswerDic[eventName].unsignedIntegerValue + 1);
+        }
+    }
+}
+
+- (void)recordSendFailureForRequest:(RTSRequestModel *)request {
+    @synchronized (self) {
+        NSString *eventName = [self nameOfEvent:request.eventName];
+        [self stagesOfEvent:eventName];
+        self.sendFailureDic[eventName] = @(self.sendFailureDic[eventName].unsignedIntegerValue + 1);
+    }
+}
+
+- (RTSLatencyHistogram *)histogramForEvent:(NSString *)eventName stage:(NSString *)stage {
+    @synchronized (self) {
+        return self.eventDic[eventName][stage];
+    }
+}
+
+- (NSString *)dump {
+    @synchronized (self) {
+        NSMutableString *dump = [NSMutableString stringWithString:@"RTS latency ms (n p50/p90/p99/max)"];
+        if (self.eventDic.count == 0) {
+            [dump appendString:@"\nno requests"];
+        }
+        NSArray<NSString *> *names = [self.eventDic.allKeys sortedArrayUsingSelector:@selector(compare:)];
+        for (NSString *eventName in names) {
+            [dump appendFormat:@"\n%@", eventName];
+            for (NSString *stage in @[RTSStageQueue, RTSStageSend, RTSStageAnswer, RTSStageTotal]) {
+                RTSLatencyHistogram *histogram = self.eventDic[eventName][stage];
+                [dump appendFormat:@"\n  %-6s %llu %llu/%llu/%llu/%llu", stage.UTF8String, histogram.totalCount,
+                 [histogram valueAtPercentile:50], [histogram valueAtPercentile:90],
+                 [histogram valueAtPercentile:99], histogram.maxValue];
+            }
+            NSUInteger failures = self.sendFailureDic[eventName].unsignedIntegerValue;
+            NSUInteger errors = self.errorAnswerDic[eventName].unsignedIntegerValue;
+            if (failures > 0 || errors > 0) {
+                [dump appendFormat:@"\n  send failed %lu, error answers %lu", (unsigned long)failures, (unsigned long)errors];
+            }
+        }
+        return dump;
+    }
+}
+
+- (void)reset {
+    @synchronized (self) {
+        [self.eventDic removeAllObjects];
+        [self.sendFailureDic removeAllObjects];
+        [self.errorAnswerDic removeAllObjects];
+    }
+}
+
+#pragma mark - Private Action
+
+- (NSString *)nameOfEvent:(NSString *)eventName {
+    NSString *name = eventName.length > 0 ? eventName : @"other";
+    if (!self.eventDic[name] && self.eventDic.count >= RTSTracerMaxEvents) {
+        return @"other";
+    }
+    return name;
+}
+
+- (NSMutableDictionary<NSString *, RTSLatencyHistogram *> *)stagesOfEvent:(NSString *)eventName {
+    NSMutableDictionary<NSString *, RTSLatencyHistogram *> *stages = self.eventDic[eventName];
+    if (!stages) {
+        stages = [[NSMutableDictionary alloc] init];
+        for (NSString *stage in @[RTSStageQueue, RTSStageSend, RTSStageAnswer, RTSStageTotal]) {
+            stages[stage] = [[RTSLatencyHistogram alloc] init];
+        }
+        self.eventDic[eventName] = stages;
+    }
+    return stages;
+}
+
+- (uint64_t)millisecondsFrom:(NSTimeInterval)start to:(NSTimeInterval)end {
+    if (start <= 0 || end <= start) {
+        return 0;
+    }
+    return (uint64_t)llround((end - start) * 1000);
+}
+
+@end
@@ -0,0 +1,36 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ * Writes the RTS messages of a session, sent and received, into a compact append-only log, in
+ * the format of the Android RTSSessionRecorder so both can be replayed by the same tools.
+ * "RTSL" with version 1, the wall clock ms of the start, then per record one kind byte (0 sent,
+ * 1 received), the ms since the previous record, the uid for received messages and the message.
+ * Numbers are varints, strings are UTF-8 with a varint length. Write errors stop the recording.
+ */
+@interface RTSSessionRecorder : NSObject
+
+@property (nonatomic, assign, readonly) NSInteger count;
+
+/*
+ * A new log in the directory, named by the start time. Only the newest five logs are kept.
+ */
++ (nullable instancetype)recorderInDirectory:(NSString *)directory;
+
+- (nullable instancetype)initWithPath:(NSString *)path;
+
+- (void)recordOutbound:(NSString *)message;
+
+- (void)recordInbound:(NSString *)message from:(nullable NSString *)uid;
+
+- (void)close;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import "RTSSessionRecorder.h"
+#import <QuartzCore/QuartzCore.h>
+
+static const uint8_t RTSSessionMagic[] = {'R', 'T', 'S', 'L', 1};
+static const uint8_t RTSSessionKindOutbound = 0;
+static const uint8_t RTSSessionKindInbound = 1;
+static const NSUInteger RTSSessionMaxFiles = 5;
+static NSString *const RTSSessionFileExtension = @"rtslog";
+
+@interface RTSSessionRecorder ()
+
+@property (nonatomic, strong, nullable) NSFileHandle *fileHandle;
+@property (nonatomic, strong) NSMutableData *buffer;
+@property (nonatomic, assign) int64_t lastMs;
+@property (nonatomic, assign, readwrite) NSInteger count;
+
+@end
+
+@implementation RTSSessionRecorder
+
++ (nullable instancetype)recorderInDirectory:(NSString *)directory {
+    NSFileManager *manager = [NSFileManager defaultManager];
+    if (![manager createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil]) {
+        return nil;
+    }
+    NSMutableArray<NSString *> *logs = [NSMutableArray array];
+    for (NSString *name in [manager contentsOfDirectoryAtPath:directory error:nil]) {
+        if ([name.pathExtension isEqualToString:RTSSessionFileExtension]) {
+            [logs addObject:[directory stringByAppendingPathComponent:name]];
+        }
+    }
+    if (logs.count >= RTSSessionMaxFiles) {
+        [logs sortUsingComparator:^NSComparisonResult(NSString *a, NSString *b) {
+            NSDate *left = [manager attributesOfItemAtPath:a error:nil].fileModificationDate ?: [NSDate distantPast];
+            NSDate *right = [manager attributesOfItemAtPath:b error:nil].fileModificationDate ?: [NSDate distantPast];
+            return [left compare:right];
+        }];
+        for (NSUInteger i = 0; i <= logs.count - RTSSessionMaxFiles; i++) {
+            [manager removeItemAtPath:logs[i] error:nil];
+        }
+    }
+    NSString *name = [NSString stringWithFormat:@"%lld", (long long)([[NSDate date] timeIntervalSince1970] * 1000)];
+    NSString *path = [directory stringByAppendingPathComponent:[name stringByAppendingPathExtension:RTSSessionFileExtension]];
+    for (NSInteger i = 1; [manager fileExistsAtPath:path]; i++) {
+        NSString *numbered = [NSString stringWithFormat:@"%@_%ld", name, (long)i];
+        path = [directory stringByAppendingPathComponent:[numbered stringByAppendingPathExtension:RTSSessionFileExtension]];
+    }
+    return [[self alloc] initWithPath:path];
+}
+
+- (nullable instancetype)initWithPath:(NSString *)path {
+    self = [super init];
+    if (self) {
+        if (![[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil]) {
+            return nil;
+        }
+        _fileHandle = [NSFileHandle fileHandleForWritingAtPath:path];
+        if (!_fileHandle) {
+            return nil;
+        }
+        _buffer = [NSMutableData dataWithCapacity:256];
+        _lastMs = [self nowMs];
+        [_buffer appendBytes:RTSSessionMagic length:sizeof(RTSSessionMagic)];
+        [self appendVarint:(uint64_t)([[NSDate date] timeIntervalSince1970] * 1000)];
+        if (![self flushBuffer]) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)recordOutbound:(NSString *)message {
+    [self appendKind:RTSSessionKindOutbound uid:nil message:message];
+}
+
+- (void)recordInbound:(NSString *)message from:(nullable NSString *)uid {
+    [self appendKind:RTSSessionKindInbound uid:uid ?: @"" message:message];
+}
+
+- (void)close {
+    @synchronized (self) {
+        [self.fileHandle closeFile];
+        self.fileHandle = nil;
+    }
+}
+
+#pragma mark - Private Action
+
+- (void)appendKind:(uint8_t)kind uid:(nullable NSString *)uid message:(NSString *)message {
+    @synchronized (self) {
+        if (!self.fileHandle) {
+            return;
+        }
+        int64_t now = [self nowMs];
+        self.buffer.length = 0;
+        [self.buffer appendBytes:&kind length:1];
+        [self appendVarint:(uint64_t)MAX(0, now - self.lastMs)];
+        if (uid) {
+            [self appendString:uid];
+        }
+        [self appendString:message];
+        if ([self flushBuffer]) {
+            self.lastMs = MAX(self.lastMs, now);
+            self.count++;
+        } else {
+            [self close];
+        }
+    }
+}
+
+- (BOOL)flushBuffer {
+    @try {
+        // Unbuffered, a killed process loses at most the record being written.
+        [self.fileHandle writeData:self.buffer];
+    } @catch (NSException *exception) {
+        return NO;
+    }
+    self.buffer.length = 0;
+    return YES;
+}
+
+- (void)appendString:(NSString *)value {
+    NSData *data = [value dataUsingEncoding:NSUTF8StringEncoding] ?: [NSData data];
+    [self appendVarint:data.length];
+    [self.buffer appendData:data];
+}
+
+- (void)appendVarint:(uint64_t)value {
+    uint8_t bytes[10];
+    NSUInteger length = 0;
+    while (value & ~0x7FULL) {
+        bytes[length++] = (uint8_t)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (uint8_t)value;
+    [self.buffer appendBytes:bytes length:length];
+}
+
+- (int64_t)nowMs {
+    return (int64_t)(CACurrentMediaTime() * 1000);
+}
+
+@end
@@ -5,6 +5,7 @@
 
 #import "BaseIMView.h"
 #import "Masonry.h"
+#import "MainThreadWatchdog.h"
 
 @interface BaseIMView () <UITableViewDelegate, UITableViewDataSource>
 
@@ -30,7 +31,9 @@
 - (void)setDataLists:(NSArray *)dataLists {
     _dataLists = dataLists;
 
+    NSString *previous = [MainThreadWatchdog enter:@"BaseIMView reloadData"];
     [self.roomTableView reloadData];
+    [MainThreadWatchdog exit:previous];
     dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.1 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
         [self scrollToBottom:YES tableView:self.roomTableView];
     });
@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ * Stalls of one kind
+ */
+@interface MainThreadStall : NSObject
+
+@property (nonatomic, copy, readonly) NSString *kind;
+
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+@property (nonatomic, assign, readonly) NSTimeInterval totalTime;
+
+@property (nonatomic, assign, readonly) NSTimeInterval maxTime;
+
+@end
+
+/*
+ * Finds main thread stalls: a run loop observer times the work the main run loop does between
+ * two of its phases, work longer than the threshold is a stall.
+ *
+ * Stalls are added up by what caused them: the operation entered with +enter:, e.g. the vi* event
+ * of an RTS answer or a table reload, else the run loop phase. Every stall is logged as one line.
+ * Started in DEBUG builds. Call on the main thread.
+ */
+@interface MainThreadWatchdog : NSObject
+
++ (MainThreadWatchdog *)sharedWatchdog;
+
+/*
+ * Work longer than this is a stall, 0.2s by default
+ */
+@property (nonatomic, assign) NSTimeInterval threshold;
+
+- (void)start;
+
+- (void)stop;
+
+/*
+ * Name the operation the main thread runs from now on, stalls in it are counted under the name.
+ * No-op off the main thread.
+ * @return The name to give back to +exit:
+ */
++ (nullable NSString *)enter:(NSString *)operation;
+
++ (void)exit:(nullable NSString *)previous;
+
+/*
+ * Stalls by kind, the longest in total first
+ */
+- (NSArray<MainThreadStall *> *)stalls;
+
+/*
+ * Run loop passes since start, and those longer than a frame
+ */
+@property (nonatomic, assign, readonly) NSUInteger passCount;
+
+@property (nonatomic, assign, readonly) NSUInteger jankCount;
+
+/*
+ * One line per kind of stall
+ */
+- (NSString *)report;
+
+- (void)logReport;
+
+@end
+
+NS_ASSUME_NONNULL_END
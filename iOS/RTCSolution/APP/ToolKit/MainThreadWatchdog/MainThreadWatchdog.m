@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import "MainThreadWatchdog.h"
+#import <QuartzCore/QuartzCore.h>
+
+static const NSTimeInterval WatchdogDefaultThreshold = 0.2;
+// Passes longer than a frame count as jank.
+static const NSTimeInterval WatchdogFrameBudget = 1.0 / 60;
+static const NSUInteger WatchdogMaxKinds = 64;
+static NSString *const WatchdogOtherKind = @"other";
+
+@interface MainThreadStall ()
+
+@property (nonatomic, copy, readwrite) NSString *kind;
+@property (nonatomic, assign, readwrite) NSUInteger count;
+@property (nonatomic, assign, readwrite) NSTimeInterval totalTime;
+@property (nonatomic, assign, readwrite) NSTimeInterval maxTime;
+
+@end
+
+@implementation MainThreadStall
+
+@end
+
+@interface MainThreadWatchdog ()
+
+@property (nonatomic, assign) CFRunLoopObserverRef observer;
+// Start of the running pass, 0 while the run loop sleeps.
+@property (nonatomic, assign) NSTimeInterval passStart;
+@property (nonatomic, assign) CFRunLoopActivity passActivity;
+// First operation entered in the running pass.
+@property (nonatomic, copy, nullable) NSString *passLabel;
+@property (nonatomic, copy, nullable) NSString *label;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, MainThreadStall *> *stallDic;
+@property (nonatomic, assign, readwrite) NSUInteger passCount;
+@property (nonatomic, assign, readwrite) NSUInteger jankCount;
+
+@end
+
+@implementation MainThreadWatchdog
+
+#ifdef DEBUG
++ (void)load {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [[MainThreadWatchdog sharedWatchdog] start];
+    });
+}
+#endif
+
++ (MainThreadWatchdog *)sharedWatchdog {
+    static MainThreadWatchdog *watchdog = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        watchdog = [[MainThreadWatchdog alloc] init];
+    });
+    return watchdog;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _threshold = WatchdogDefaultThreshold;
+        _stallDic = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (void)start {
+    if (self.observer) {
+        return;
+    }
+    __weak __typeof(self) wself = self;
+    self.observer = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, kCFRunLoopAllActivities, YES, 0,
+                                                       ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+        [wself onActivity:activity];
+    });
+    CFRunLoopAddObserver(CFRunLoopGetMain(), self.observer, kCFRunLoopCommonModes);
+}
+
+- (void)stop {
+    if (!self.observer) {
+        return;
+    }
+    CFRunLoopRemoveObserver(CFRunLoopGetMain(), self.observer, kCFRunLoopCommonModes);
+    CFRelease(self.observer);
+    self.observer = NULL;
+    self.passStart = 0;
+}
+
++ (NSString *)enter:(NSString *)operation {
+    if (![NSThread isMainThread]) {
+        return nil;
+    }
+    MainThreadWatchdog *watchdog = [MainThreadWatchdog sharedWatchdog];
+    NSString *previous = watchdog.label;
+    watchdog.label = operation;
+    if (!watchdog.passLabel && watchdog.passStart > 0) {
+        watchdog.passLabel = operation;
+    }
+    return previous;
+}
+
++ (void)exit:(NSString *)previous {
+    if (![NSThread isMainThread]) {
+        return;
+    }
+    [MainThreadWatchdog sharedWatchdog].label = previous;
+}
+
+- (NSArray<MainThreadStall *> *)stalls {
+    return [self.stallDic.allValues sortedArrayUsingComparator:^NSComparisonResult(MainThreadStall *a, MainThreadStall *b) {
+        return [@(b.totalTime) compare:@(a.totalTime)];
+    }];
+}
+
+- (NSString *)report {
+    NSMutableString *report = [NSMutableString stringWithFormat:@"main thread: %lu passes, %lu over a frame, stalls over %.0fms:",
+                               (unsigned long)self.passCount, (unsigned long)self.jankCount, self.threshold * 1000];
+    NSArray<MainThreadStall *> *stalls = [self stalls];
+    if (stalls.count == 0) {
+        [report appendString:@" none"];
+    }
+    for (MainThreadStall *stall in stalls) {
+        [report appendFormat:@"\n%@ x%lu total %.0fms max %.0fms", stall.kind, (unsigned long)stall.count,
+         stall.totalTime * 1000, stall.maxTime * 1000];
+    }
+    return report;
+}
+
+- (void)logReport {
+    NSLog(@"[%@]-%@", [self class], [self report]);
+}
+
+#pragma mark - Private Action
+
+- (void)onActivity:(CFRunLoopActivity)activity {
+    NSTimeInterval now = CACurrentMediaTime();
+    if (self.passStart > 0) {
+        [self endPass:now - self.passStart];
+    }
+    // Work between waking up and going to sleep is timed phase by phase.
+    if (activity == kCFRunLoopBeforeWaiting || activity == kCFRunLoopExit) {
+        self.passStart = 0;
+    } else {
+        self.passStart = now;
+        self.passActivity = activity;
+    }
+}
+
+- (void)endPass:(NSTimeInterval)duration {
+    NSString *label = self.passLabel;
+    self.passLabel = nil;
+    self.passCount++;
+    if (duration > WatchdogFrameBudget) {
+        self.jankCount++;
+    }
+    if (duration < self.threshold) {
+        return;
+    }
+    NSString *kind = label ?: [self phaseName:self.passActivity];
+    MainThreadStall *stall = self.stallDic[kind];
+    if (!stall) {
+        if (self.stallDic.count >= WatchdogMaxKinds) {
+            kind = WatchdogOtherKind;
+            stall = self.stallDic[kind];
+        }
+        if (!stall) {
+            stall = [[MainThreadStall alloc] init];
+            stall.kind = kind;
+            self.stallDic[kind] = stall;
+        }
+    }
+    stall.count++;
+    stall.totalTime += duration;
+    stall.maxTime = MAX(stall.maxTime, duration);
+    NSLog(@"[%@]-stall %.0fms %@", [self class], duration * 1000, kind);
+}
+
+- (NSString *)phaseName:(CFRunLoopActivity)activity {
+    switch (activity) {
+        case kCFRunLoopEntry:
+            return @"run loop entry";
+        case kCFRunLoopBeforeTimers:
+            return @"run loop timers";
+        case kCFRunLoopBeforeSources:
+            return @"run loop sources";
+        case kCFRunLoopAfterWaiting:
+            return @"run loop wakeup";
+        default:
+            return @"run loop";
+    }
+}
+
+@end
@@ -13,6 +13,8 @@
 @interface NetworkingManager ()
 
 @property (nonatomic, strong) AFHTTPSessionManager *sessionManager;
+// Key: URL + parameters of a request in flight; value: blocks waiting for its response.
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray *> *pendingBlocks;
 
 @end
 
@@ -21,7 +23,11 @@
 - (instancetype)init {
     self = [super init];
     if (self) {
-        self.sessionManager = [AFHTTPSessionManager manager];
+        // One shared session, NSURLSession reuses connections and negotiates HTTP/2 by itself.
+        NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+        configuration.HTTPMaximumConnectionsPerHost = 4;
+        self.sessionManager = [[AFHTTPSessionManager alloc] initWithSessionConfiguration:configuration];
+        self.pendingBlocks = [[NSMutableDictionary alloc] init];
         self.sessionManager.requestSerializer = [AFJSONRequestSerializer serializer];
         self.sessionManager.requestSerializer.timeoutInterval = 15.0;
         self.sessionManager.responseSerializer.acceptableContentTypes = [NSSet setWithObjects:@"application/json",
@@ -65,34 +71,65 @@
                                  @"device_id": [NetworkingTool getDeviceId] ?: @"",
                                  @"app_id": appid ? appid : @""};
     NSString *URLString = [NSString stringWithFormat:@"%@/%@", HeadUrl, space];
-    [[self shareManager].sessionManager POST:URLString
+    NSString *key = [NSString stringWithFormat:@"%@|%@", URLString, [parameters yy_modelToJSONString]];
+    NetworkingManager *manager = [self shareManager];
+    // An identical request is already in flight, share its response.
+    @synchronized (manager.pendingBlocks) {
+        NSMutableArray *waiting = manager.pendingBlocks[key];
+        if (waiting) {
+            if (block) {
+                [waiting addObject:[block copy]];
+            }
+            return;
+        }
+        waiting = [[NSMutableArray alloc] init];
+        if (block) {
+            [waiting addObject:[block copy]];
+        }
+        manager.pendingBlocks[key] = waiting;
+    }
+    [manager.sessionManager POST:URLString
         parameters:parameters
         headers:nil
         progress:nil
         success:^(NSURLSessionDataTask *_Nonnull task,
                   id _Nullable responseObject) {
-            [self processResponse:responseObject block:block];
+            [self processResponse:responseObject blocks:[self finishRequestWithKey:key]];
             NSLog(@"[%@]-%@ %@", [self class], eventName, responseObject);
         } failure:^(NSURLSessionDataTask *_Nullable task, NSError *_Nonnull error) {
-            if (block) {
-                NetworkingResponse *response = [[NetworkingResponse alloc] init];
-                response.code = error.code;
-                response.message = error.localizedDescription;
-                block(response);
-            }
+            NetworkingResponse *response = [[NetworkingResponse alloc] init];
+            response.code = error.code;
+            response.message = error.localizedDescription;
+            [self deliverResponse:response blocks:[self finishRequestWithKey:key]];
             NSLog(@"[%@]-%@ failure %@", [self class], eventName, task.response);
         }];
 }
 
++ (NSArray *)finishRequestWithKey:(NSString *)key {
+    NetworkingManager *manager = [self shareManager];
+    @synchronized (manager.pendingBlocks) {
+        NSArray *waiting = [manager.pendingBlocks[key] copy] ?: @[];
+        [manager.pendingBlocks removeObjectForKey:key];
+        return waiting;
+    }
+}
+
 + (void)processResponse:(id _Nullable)responseObject
-                  block:(void (^__nullable)(NetworkingResponse *response))block {
+                 blocks:(NSArray *)blocks {
     NetworkingResponse *response = [NetworkingResponse dataToResponseModel:responseObject];
-    if (block) {
-        block(response);
-    }
+    [self deliverResponse:response blocks:blocks];
     if (response.code == RTSStatusCodeTokenExpired) {
         [[NSNotificationCenter defaultCenter] postNotificationName:NotificationLoginExpired object:nil];
     }
 }
 
+// Every coalesced caller gets its own copy, a caller changing its response leaves the others'
+// and the token expiry check alone.
++ (void)deliverResponse:(NetworkingResponse *)response
+                 blocks:(NSArray *)blocks {
+    for (void (^block)(NetworkingResponse *) in blocks) {
+        block([response copy]);
+    }
+}
+
 @end
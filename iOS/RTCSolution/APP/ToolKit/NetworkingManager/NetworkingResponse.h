@@ -7,7 +7,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface NetworkingResponse : NSObject
+// Copies are independent, callers sharing one request each get their own.
+@interface NetworkingResponse : NSObject <NSCopying>
 
 @property (nonatomic, assign) NSInteger code;
 
@@ -30,6 +30,17 @@
     return response;
 }
 
+- (id)copyWithZone:(NSZone *)zone {
+    NetworkingResponse *copy = [[[self class] allocWithZone:zone] init];
+    copy.code = self.code;
+    copy.message = self.message;
+    copy.timestamp = self.timestamp;
+    if (self.response) {
+        copy.response = [[NSDictionary alloc] initWithDictionary:self.response copyItems:YES];
+    }
+    return copy;
+}
+
 - (BOOL)result {
     if (self.code == RTSStatusCodeSuccess) {
         return YES;
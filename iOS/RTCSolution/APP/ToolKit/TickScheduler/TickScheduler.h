@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface TickTask : NSObject
+
+/*
+ * How late the task may run so it shares a wakeup with others.
+ * 10% of the interval for periodic tasks, 0 for one-shot tasks.
+ */
+@property (nonatomic, assign) NSTimeInterval tolerance;
+
+/*
+ * A paused task costs no wakeups. If it came due while paused it runs right after resuming.
+ */
+@property (nonatomic, assign, getter=isPaused) BOOL paused;
+
+/*
+ * NO once cancelled, once the owner is gone, or once a one-shot task has run.
+ */
+@property (nonatomic, assign, readonly, getter=isActive) BOOL active;
+
+- (void)cancel;
+
+@end
+
+/*
+ * One wakeup source on the main queue for the periodic and one-shot work of the UI, instead of a
+ * GCDTimer per component hopping from a global queue to main on every tick.
+ *
+ * Only the earliest deadline is armed. Every task may run up to its tolerance late, so the wakeup
+ * is put off to the earliest deadline plus tolerance and every task due by then runs in it.
+ * Call on the main thread.
+ */
+@interface TickScheduler : NSObject
+
+/*
+ * Scheduler of the main queue
+ */
++ (TickScheduler *)sharedScheduler;
+
+/*
+ * Run the block every interval, the first time one interval from now.
+ * @param owner Skipped while the view is not in a window, cancelled once it is released
+ */
+- (TickTask *)addPeriodicTaskWithInterval:(NSTimeInterval)interval
+                                    owner:(nullable UIView *)owner
+                                    block:(dispatch_block_t)block;
+
+/*
+ * Run the block once after the delay.
+ */
+- (TickTask *)addOnceTaskWithDelay:(NSTimeInterval)delay block:(dispatch_block_t)block;
+
+/*
+ * Wakeups and task runs since start, more runs than wakeups when tasks share them
+ */
+@property (nonatomic, assign, readonly) NSUInteger wakeupCount;
+
+@property (nonatomic, assign, readonly) NSUInteger runCount;
+
+/*
+ * Wakeups a second over the last 5 seconds
+ */
+@property (nonatomic, assign, readonly) double wakeupsPerSecond;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,225 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import "TickScheduler.h"
+#import <QuartzCore/QuartzCore.h>
+
+static const NSTimeInterval TickDefaultTolerance = 0.1;
+static const NSTimeInterval TickRateWindow = 5.0;
+
+@interface TickScheduler ()
+
+@property (nonatomic, strong) NSMutableArray<TickTask *> *tasks;
+@property (nonatomic, strong) dispatch_source_t timer;
+// Time the wakeup is armed for, 0 if none.
+@property (nonatomic, assign) NSTimeInterval armedAt;
+@property (nonatomic, assign) BOOL inWakeup;
+@property (nonatomic, assign, readwrite) NSUInteger wakeupCount;
+@property (nonatomic, assign, readwrite) NSUInteger runCount;
+@property (nonatomic, assign) NSTimeInterval windowStart;
+@property (nonatomic, assign) NSUInteger windowWakeups;
+@property (nonatomic, assign) double lastRate;
+
+- (void)arm;
+
+- (void)removeTask:(TickTask *)task;
+
+@end
+
+@interface TickTask ()
+
+@property (nonatomic, weak) TickScheduler *scheduler;
+@property (nonatomic, copy) dispatch_block_t block;
+// 0 for one-shot tasks.
+@property (nonatomic, assign) NSTimeInterval interval;
+@property (nonatomic, assign) NSTimeInterval due;
+@property (nonatomic, weak) UIView *owner;
+@property (nonatomic, assign) BOOL hasOwner;
+@property (nonatomic, assign) BOOL cancelled;
+
+@end
+
+@implementation TickTask
+
+- (void)setTolerance:(NSTimeInterval)tolerance {
+    _tolerance = MAX(0, tolerance);
+    [self.scheduler arm];
+}
+
+- (void)setPaused:(BOOL)paused {
+    if (_paused == paused || _cancelled) {
+        return;
+    }
+    _paused = paused;
+    [self.scheduler arm];
+}
+
+- (BOOL)isActive {
+    return !_cancelled && !(_hasOwner && _owner == nil);
+}
+
+- (void)cancel {
+    if (_cancelled) {
+        return;
+    }
+    _cancelled = YES;
+    [self.scheduler removeTask:self];
+}
+
+@end
+
+@implementation TickScheduler
+
++ (TickScheduler *)sharedScheduler {
+    static TickScheduler *scheduler = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        scheduler = [[TickScheduler alloc] init];
+    });
+    return scheduler;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _tasks = [[NSMutableArray alloc] init];
+        _windowStart = -1;
+        __weak __typeof(self) wself = self;
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        dispatch_source_set_event_handler(_timer, ^{
+            [wself wakeup];
+        });
+        dispatch_resume(_timer);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    dispatch_source_cancel(_timer);
+}
+
+- (TickTask *)addPeriodicTaskWithInterval:(NSTimeInterval)interval
+                                    owner:(UIView *)owner
+                                    block:(dispatch_block_t)block {
+    TickTask *task = [[TickTask alloc] init];
+    task.interval = MAX(0.001, interval);
+    task.due = CACurrentMediaTime() + task.interval;
+    task.owner = owner;
+    task.hasOwner = owner != nil;
+    task.block = block;
+    task.tolerance = task.interval * TickDefaultTolerance;
+    return [self addTask:task];
+}
+
+- (TickTask *)addOnceTaskWithDelay:(NSTimeInterval)delay block:(dispatch_block_t)block {
+    TickTask *task = [[TickTask alloc] init];
+    task.interval = 0;
+    task.due = CACurrentMediaTime() + MAX(0, delay);
+    task.block = block;
+    return [self addTask:task];
+}
+
+- (double)wakeupsPerSecond {
+    NSTimeInterval now = CACurrentMediaTime();
+    if (self.windowStart >= 0 && now - self.windowStart >= TickRateWindow) {
+        [self rollWindow:now];
+    }
+    return self.lastRate;
+}
+
+#pragma mark - Private Action
+
+- (TickTask *)addTask:(TickTask *)task {
+    task.scheduler = self;
+    [self.tasks addObject:task];
+    [self arm];
+    return task;
+}
+
+- (void)removeTask:(TickTask *)task {
+    if (self.inWakeup) {
+        return;
+    }
+    [self.tasks removeObject:task];
+    [self arm];
+}
+
+- (void)wakeup {
+    self.armedAt = 0;
+    NSTimeInterval now = CACurrentMediaTime();
+    self.wakeupCount++;
+    if (self.windowStart < 0) {
+        self.windowStart = now;
+    } else if (now - self.windowStart >= TickRateWindow) {
+        [self rollWindow:now];
+    }
+    self.windowWakeups++;
+
+    self.inWakeup = YES;
+    // Tasks added by a running task wait for the next wakeup.
+    NSUInteger count = self.tasks.count;
+    for (NSUInteger i = 0; i < count; i++) {
+        TickTask *task = self.tasks[i];
+        if (!task.isActive || task.paused || task.due > now) {
+            continue;
+        }
+        if (task.interval > 0) {
+            // Missed ticks are skipped, not run in a burst.
+            NSUInteger missed = (NSUInteger)((now - task.due) / task.interval);
+            task.due += (missed + 1) * task.interval;
+            if (task.hasOwner && task.owner.window == nil) {
+                continue;
+            }
+        } else {
+            task.cancelled = YES;
+        }
+        self.runCount++;
+        if (task.block) {
+            task.block();
+        }
+    }
+    self.inWakeup = NO;
+    NSIndexSet *gone = [self.tasks indexesOfObjectsPassingTest:^BOOL(TickTask *task, NSUInteger idx, BOOL *stop) {
+        return !task.isActive;
+    }];
+    [self.tasks removeObjectsAtIndexes:gone];
+    [self arm];
+}
+
+- (void)rollWindow:(NSTimeInterval)now {
+    self.lastRate = self.windowWakeups / (now - self.windowStart);
+    self.windowStart = now;
+    self.windowWakeups = 0;
+}
+
+- (void)arm {
+    if (self.inWakeup) {
+        return;
+    }
+    NSTimeInterval wakeAt = DBL_MAX;
+    NSTimeInterval leeway = DBL_MAX;
+    for (TickTask *task in self.tasks) {
+        if (task.isActive && !task.paused) {
+            wakeAt = MIN(wakeAt, task.due + task.tolerance);
+            leeway = MIN(leeway, task.tolerance);
+        }
+    }
+    if (wakeAt == DBL_MAX) {
+        self.armedAt = 0;
+        dispatch_source_set_timer(self.timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        return;
+    }
+    if (wakeAt == self.armedAt) {
+        return;
+    }
+    self.armedAt = wakeAt;
+    int64_t delay = (int64_t)(MAX(0, wakeAt - CACurrentMediaTime()) * NSEC_PER_SEC);
+    // The wakeup is already put off by the tolerance, a little more lets the system batch it.
+    uint64_t systemLeeway = (uint64_t)(MIN(leeway * 0.1, 0.01) * NSEC_PER_SEC);
+    dispatch_source_set_timer(self.timer, dispatch_time(DISPATCH_TIME_NOW, delay), DISPATCH_TIME_FOREVER, systemLeeway);
+}
+
+@end
@@ -30,6 +30,16 @@
  */
 #import "GCDTimer.h"
 
+/**
+ * @brief Shared tick scheduler
+ */
+#import "TickScheduler.h"
+
+/**
+ * @brief Main thread stall watchdog
+ */
+#import "MainThreadWatchdog.h"
+
 /**
  * @brief Toast wrapped
  */
@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, VideoChatQualityMetric) {
+    // Video bitrate sent or received, in kbps
+    VideoChatQualityMetricVideoKbps,
+    // Frame rate sent or rendered
+    VideoChatQualityMetricFps,
+    // Audio bitrate sent or received, in kbps
+    VideoChatQualityMetricAudioKbps,
+    // Packet loss in per mille, the worse of audio and video
+    VideoChatQualityMetricLoss,
+    // Round trip time, in ms
+    VideoChatQualityMetricRtt,
+    // Audio jitter buffer delay, in ms
+    VideoChatQualityMetricJitter,
+    VideoChatQualityMetricCount,
+};
+
+// A metric the stream did not report
+extern const NSInteger VideoChatQualityUnset;
+
+/**
+ * @brief One stats callback of one stream, filled on the stack.
+ */
+typedef struct {
+    NSInteger values[VideoChatQualityMetricCount];
+    NSInteger intervalMs;
+    NSInteger videoStallCount;
+    NSInteger videoStallMs;
+    NSInteger audioStallCount;
+    NSInteger audioStallMs;
+} VideoChatQualitySample;
+
+/**
+ * @brief Clears the sample, missing metrics stay unset.
+ * @param intervalMs The period the stats cover
+ */
+FOUNDATION_EXTERN void VideoChatQualitySampleReset(VideoChatQualitySample *sample, NSInteger intervalMs);
+
+/**
+ * @brief Keeps the loss rate if worse than the one already set.
+ * @param lossRate 0 to 1
+ */
+FOUNDATION_EXTERN void VideoChatQualitySampleSetLoss(VideoChatQualitySample *sample, float lossRate);
+
+/**
+ * @brief Keeps the stream statistics of the RTC room instead of only a good/bad badge per user.
+ * Every stream has a fixed-size window of the last samples per metric for percentiles, plus
+ * session totals for means and stall rates. Recording does not allocate, only building a summary does.
+ * A compact summary goes to reportBlock every minute of samples, and is built on leave with -summary.
+ */
+@interface VideoChatQualityTelemetry : NSObject
+
+/**
+ * @brief Gets the periodic summary, on the thread of the stats callbacks
+ */
+@property (nonatomic, copy, nullable) void (^reportBlock)(NSString *summary);
+
+- (void)recordSample:(const VideoChatQualitySample *)sample
+                 uid:(NSString *)uid
+               local:(BOOL)local
+                 now:(int64_t)nowMs;
+
+/**
+ * @brief A network quality report of the user, unknown qualities are not passed.
+ */
+- (void)recordQualityGood:(BOOL)good
+                      uid:(NSString *)uid
+                    local:(BOOL)local
+                      now:(int64_t)nowMs;
+
+/**
+ * @brief Percentile over the window of the stream, VideoChatQualityUnset if never reported.
+ */
+- (NSInteger)percentile:(double)percentile
+                 metric:(VideoChatQualityMetric)metric
+                    uid:(NSString *)uid
+                  local:(BOOL)local;
+
+/**
+ * @brief One line per stream: p50/p90 of the window (p10 for rates) with the session mean in
+ * brackets, stalls as count and percent of the time, share of bad quality reports.
+ */
+- (NSString *)summary;
+
+/**
+ * @brief Forget every stream, e.g. after leaving the room.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
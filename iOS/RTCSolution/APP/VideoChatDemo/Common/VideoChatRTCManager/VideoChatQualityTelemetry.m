@@ -0,0 +1,245 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import "VideoChatQualityTelemetry.h"
+
+// A minute of the SDK's 2 second stats
+#define VideoChatQualityWindowSamples 30
+#define VideoChatQualityMaxStreams 16
+
+const NSInteger VideoChatQualityUnset = -1;
+static const int64_t VideoChatQualitySummaryIntervalMs = 60000;
+
+static NSString *const VideoChatQualityMetricNames[VideoChatQualityMetricCount] = {
+    @"kbps", @"fps", @"akbps", @"loss‰", @"rtt", @"jitter"
+};
+// For rates the low tail is the bad one, it is reported instead of p90.
+static const BOOL VideoChatQualityLowTail[VideoChatQualityMetricCount] = {YES, YES, YES, NO, NO, NO};
+
+typedef struct {
+    BOOL used;
+    BOOL local;
+    int64_t lastUpdateMs;
+    NSInteger window[VideoChatQualityMetricCount][VideoChatQualityWindowSamples];
+    NSInteger windowSize[VideoChatQualityMetricCount];
+    NSInteger windowNext[VideoChatQualityMetricCount];
+    int64_t sum[VideoChatQualityMetricCount];
+    int64_t count[VideoChatQualityMetricCount];
+    int64_t observedMs;
+    int64_t videoStallCount;
+    int64_t videoStallMs;
+    int64_t audioStallCount;
+    int64_t audioStallMs;
+    int64_t qualityReports;
+    int64_t badQualityReports;
+} VideoChatQualityStream;
+
+void VideoChatQualitySampleReset(VideoChatQualitySample *sample, NSInteger intervalMs) {
+    memset(sample, 0, sizeof(VideoChatQualitySample));
+    for (int metric = 0; metric < VideoChatQualityMetricCount; metric++) {
+        sample->values[metric] = VideoChatQualityUnset;
+    }
+    sample->intervalMs = MAX(0, intervalMs);
+}
+
+void VideoChatQualitySampleSetLoss(VideoChatQualitySample *sample, float lossRate) {
+    NSInteger perMille = lroundf(MAX(0, MIN(1, lossRate)) * 1000);
+    sample->values[VideoChatQualityMetricLoss] = MAX(sample->values[VideoChatQualityMetricLoss], perMille);
+}
+
+static int VideoChatQualityCompare(const void *a, const void *b) {
+    NSInteger left = *(const NSInteger *)a;
+    NSInteger right = *(const NSInteger *)b;
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+@interface VideoChatQualityTelemetry () {
+    VideoChatQualityStream _streams[VideoChatQualityMaxStreams];
+    NSString *_uids[VideoChatQualityMaxStreams];
+    NSInteger _scratch[VideoChatQualityWindowSamples];
+    int64_t _firstSampleMs;
+    int64_t _lastSampleMs;
+    int64_t _lastSummaryMs;
+    NSInteger _droppedStreams;
+}
+
+@end
+
+@implementation VideoChatQualityTelemetry
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _firstSampleMs = -1;
+    }
+    return self;
+}
+
+- (void)recordSample:(const VideoChatQualitySample *)sample
+                 uid:(NSString *)uid
+               local:(BOOL)local
+                 now:(int64_t)nowMs {
+    @synchronized (self) {
+        VideoChatQualityStream *stream = [self streamOfUid:uid local:local];
+        stream->lastUpdateMs = nowMs;
+        for (int metric = 0; metric < VideoChatQualityMetricCount; metric++) {
+            NSInteger value = sample->values[metric];
+            if (value < 0) {
+                continue;
+            }
+            stream->window[metric][stream->windowNext[metric]] = value;
+            stream->windowNext[metric] = (stream->windowNext[metric] + 1) % VideoChatQualityWindowSamples;
+            stream->windowSize[metric] = MIN(VideoChatQualityWindowSamples, stream->windowSize[metric] + 1);
+            stream->sum[metric] += value;
+            stream->count[metric]++;
+        }
+        stream->observedMs += sample->intervalMs;
+        stream->videoStallCount += MAX(0, sample->videoStallCount);
+        stream->videoStallMs += MAX(0, sample->videoStallMs);
+        stream->audioStallCount += MAX(0, sample->audioStallCount);
+        stream->audioStallMs += MAX(0, sample->audioStallMs);
+        [self onSampleTime:nowMs];
+    }
+}
+
+- (void)recordQualityGood:(BOOL)good
+                      uid:(NSString *)uid
+                    local:(BOOL)local
+                      now:(int64_t)nowMs {
+    @synchronized (self) {
+        VideoChatQualityStream *stream = [self streamOfUid:uid local:local];
+        stream->lastUpdateMs = nowMs;
+        stream->qualityReports++;
+        if (!good) {
+            stream->badQualityReports++;
+        }
+        [self onSampleTime:nowMs];
+    }
+}
+
+- (NSInteger)percentile:(double)percentile
+                 metric:(VideoChatQualityMetric)metric
+                    uid:(NSString *)uid
+                  local:(BOOL)local {
+    @synchronized (self) {
+        NSInteger index = [self indexOfUid:uid local:local];
+        return index < 0 ? VideoChatQualityUnset : [self percentile:percentile metric:metric stream:&_streams[index]];
+    }
+}
+
+- (NSString *)summary {
+    @synchronized (self) {
+        NSInteger streamCount = 0;
+        for (int i = 0; i < VideoChatQualityMaxStreams; i++) {
+            streamCount += _streams[i].used ? 1 : 0;
+        }
+        NSMutableString *summary = [NSMutableString stringWithFormat:@"RTC quality %llds, %ld streams",
+                                    _firstSampleMs < 0 ? 0 : (_lastSampleMs - _firstSampleMs) / 1000, (long)streamCount];
+        if (_droppedStreams > 0) {
+            [summary appendFormat:@", %ld dropped", (long)_droppedStreams];
+        }
+        for (int i = 0; i < VideoChatQualityMaxStreams; i++) {
+            VideoChatQualityStream *stream = &_streams[i];
+            if (!stream->used) {
+                continue;
+            }
+            [summary appendFormat:@"\n%@%@ %llds", stream->local ? @"local " : @"", _uids[i], stream->observedMs / 1000];
+            for (int metric = 0; metric < VideoChatQualityMetricCount; metric++) {
+                if (stream->count[metric] == 0) {
+                    continue;
+                }
+                [summary appendFormat:@" %@ %ld/%ld(%lld)", VideoChatQualityMetricNames[metric],
+                 (long)[self percentile:50 metric:metric stream:stream],
+                 (long)[self percentile:(VideoChatQualityLowTail[metric] ? 10 : 90) metric:metric stream:stream],
+                 stream->sum[metric] / stream->count[metric]];
+            }
+            if (!stream->local && stream->observedMs > 0) {
+                [summary appendFormat:@" stall v%lld/%.1f%% a%lld/%.1f%%",
+                 stream->videoStallCount, stream->videoStallMs * 100.0 / stream->observedMs,
+                 stream->audioStallCount, stream->audioStallMs * 100.0 / stream->observedMs];
+            }
+            if (stream->qualityReports > 0) {
+                [summary appendFormat:@" bad %lld%%", stream->badQualityReports * 100 / stream->qualityReports];
+            }
+        }
+        return summary;
+    }
+}
+
+- (void)reset {
+    @synchronized (self) {
+        for (int i = 0; i < VideoChatQualityMaxStreams; i++) {
+            _streams[i].used = NO;
+            _uids[i] = nil;
+        }
+        _firstSampleMs = -1;
+        _lastSampleMs = 0;
+        _droppedStreams = 0;
+    }
+}
+
+#pragma mark - Private Action
+
+- (void)onSampleTime:(int64_t)nowMs {
+    if (_firstSampleMs < 0) {
+        _firstSampleMs = nowMs;
+        _lastSummaryMs = nowMs;
+    }
+    _lastSampleMs = nowMs;
+    if (self.reportBlock && nowMs - _lastSummaryMs >= VideoChatQualitySummaryIntervalMs) {
+        _lastSummaryMs = nowMs;
+        self.reportBlock([self summary]);
+    }
+}
+
+- (NSInteger)percentile:(double)percentile
+                 metric:(VideoChatQualityMetric)metric
+                 stream:(VideoChatQualityStream *)stream {
+    NSInteger size = stream->windowSize[metric];
+    if (size == 0) {
+        return VideoChatQualityUnset;
+    }
+    memcpy(_scratch, stream->window[metric], size * sizeof(NSInteger));
+    qsort(_scratch, size, sizeof(NSInteger), VideoChatQualityCompare);
+    NSInteger rank = (NSInteger)ceil(MAX(0, MIN(100, percentile)) / 100 * size);
+    return _scratch[MAX(0, rank - 1)];
+}
+
+- (NSInteger)indexOfUid:(NSString *)uid local:(BOOL)local {
+    for (int i = 0; i < VideoChatQualityMaxStreams; i++) {
+        if (_streams[i].used && _streams[i].local == local && [_uids[i] isEqualToString:uid]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+- (VideoChatQualityStream *)streamOfUid:(NSString *)uid local:(BOOL)local {
+    NSInteger index = [self indexOfUid:uid local:local];
+    if (index >= 0) {
+        return &_streams[index];
+    }
+    NSInteger oldest = -1;
+    for (int i = 0; i < VideoChatQualityMaxStreams; i++) {
+        if (!_streams[i].used) {
+            oldest = i;
+            break;
+        }
+        if (oldest < 0 || _streams[i].lastUpdateMs < _streams[oldest].lastUpdateMs) {
+            oldest = i;
+        }
+    }
+    if (_streams[oldest].used) {
+        _droppedStreams++;
+    }
+    VideoChatQualityStream *stream = &_streams[oldest];
+    memset(stream, 0, sizeof(VideoChatQualityStream));
+    stream->used = YES;
+    stream->local = local;
+    _uids[oldest] = [uid copy];
+    return stream;
+}
+
+@end
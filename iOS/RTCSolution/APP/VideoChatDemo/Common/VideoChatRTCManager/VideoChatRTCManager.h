@@ -4,6 +4,7 @@
 //
 
 #import "VideoChatRTCManager.h"
+#import "VideoChatQualityTelemetry.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -54,6 +55,11 @@ typedef void (^VideoChatNetworkQualityChangeBlock)(VideoChatNetworkQualityStatus
 
 @property (nonatomic, weak) id<VideoChatRTCManagerDelegate> delegate;
 
+/**
+ * @brief Stream quality of the current room, kept from the stream stats callbacks
+ */
+@property (nonatomic, strong, readonly) VideoChatQualityTelemetry *qualityTelemetry;
+
 + (VideoChatRTCManager *_Nullable)shareRtc;
 
 /**
@@ -5,6 +5,7 @@
 
 #import "VideoChatRTCManager.h"
 #import "VideoChatSettingVideoConfig.h"
+#import <QuartzCore/QuartzCore.h>
 
 @interface VideoChatRTCManager () <ByteRTCVideoDelegate>
 
@@ -15,6 +16,7 @@
 @property (nonatomic, strong) NSMutableDictionary<NSString *, UIView *> *streamViewDic;
 @property (nonatomic, copy) VideoChatNetworkQualityChangeBlock networkQualityBlock;
 @property (nonatomic, strong) ByteRTCVideoEncoderConfig *encoderConfig;
+@property (nonatomic, strong, readwrite) VideoChatQualityTelemetry *qualityTelemetry;
 
 @end
 
@@ -83,6 +85,8 @@
     [self switchFrontFacingCamera:YES];
     [self.rtcRoom leaveRoom];
     [self.streamViewDic removeAllObjects];
+    NSLog(@"%@", [self.qualityTelemetry summary]);
+    [self.qualityTelemetry reset];
 }
 
 #pragma mark - Make Guest
@@ -338,6 +342,25 @@
     } else {
         liveStatus = VideoChatNetworkQualityStatusBad;
     }
+    NSString *uid = [LocalUserComponent userModel].uid;
+    if (uid.length > 0) {
+        int64_t now = (int64_t)(CACurrentMediaTime() * 1000);
+        VideoChatQualitySample sample;
+        VideoChatQualitySampleReset(&sample, 2000);
+        sample.values[VideoChatQualityMetricVideoKbps] = lroundf(stats.videoStats.sentKBitrate);
+        sample.values[VideoChatQualityMetricFps] = stats.videoStats.sentFrameRate;
+        sample.values[VideoChatQualityMetricAudioKbps] = lroundf(stats.audioStats.sentKBitrate);
+        sample.values[VideoChatQualityMetricRtt] = stats.videoStats.rtt;
+        VideoChatQualitySampleSetLoss(&sample, stats.videoStats.videoLossRate);
+        VideoChatQualitySampleSetLoss(&sample, stats.audioStats.audioLossRate);
+        [self.qualityTelemetry recordSample:&sample uid:uid local:YES now:now];
+        if (stats.txQuality != ByteRTCNetworkQualityUnknown) {
+            [self.qualityTelemetry recordQualityGood:liveStatus == VideoChatNetworkQualityStatusGood
+                                                 uid:uid
+                                               local:YES
+                                                 now:now];
+        }
+    }
     if ([self.delegate respondsToSelector:@selector(videoChatRTCManager:didChangeNetworkQuality:uid:)]) {
         [self.delegate videoChatRTCManager:self
                    didChangeNetworkQuality:liveStatus
@@ -353,6 +376,29 @@
     } else {
         liveStatus = VideoChatNetworkQualityStatusBad;
     }
+    if (stats.uid.length > 0) {
+        int64_t now = (int64_t)(CACurrentMediaTime() * 1000);
+        VideoChatQualitySample sample;
+        VideoChatQualitySampleReset(&sample, stats.videoStats.statsInterval > 0 ? stats.videoStats.statsInterval : 2000);
+        sample.values[VideoChatQualityMetricVideoKbps] = lroundf(stats.videoStats.receivedKBitrate);
+        sample.values[VideoChatQualityMetricFps] = stats.videoStats.rendererOutputFrameRate;
+        sample.values[VideoChatQualityMetricAudioKbps] = lroundf(stats.audioStats.receivedKBitrate);
+        sample.values[VideoChatQualityMetricRtt] = stats.videoStats.rtt;
+        sample.values[VideoChatQualityMetricJitter] = stats.audioStats.jitterBufferDelay;
+        VideoChatQualitySampleSetLoss(&sample, stats.videoStats.videoLossRate);
+        VideoChatQualitySampleSetLoss(&sample, stats.audioStats.audioLossRate);
+        sample.videoStallCount = stats.videoStats.stallCount;
+        sample.videoStallMs = stats.videoStats.stallDuration;
+        sample.audioStallCount = stats.audioStats.stallCount;
+        sample.audioStallMs = stats.audioStats.stallDuration;
+        [self.qualityTelemetry recordSample:&sample uid:stats.uid local:NO now:now];
+        if (stats.txQuality != ByteRTCNetworkQualityUnknown) {
+            [self.qualityTelemetry recordQualityGood:liveStatus == VideoChatNetworkQualityStatusGood
+                                                 uid:stats.uid
+                                               local:NO
+                                                 now:now];
+        }
+    }
     if ([self.delegate respondsToSelector:@selector(videoChatRTCManager:didChangeNetworkQuality:uid:)]) {
         [self.delegate videoChatRTCManager:self
                    didChangeNetworkQuality:liveStatus
@@ -412,6 +458,16 @@
 
 #pragma mark - Getter
 
+- (VideoChatQualityTelemetry *)qualityTelemetry {
+    if (!_qualityTelemetry) {
+        _qualityTelemetry = [[VideoChatQualityTelemetry alloc] init];
+        _qualityTelemetry.reportBlock = ^(NSString *summary) {
+            NSLog(@"%@", summary);
+        };
+    }
+    return _qualityTelemetry;
+}
+
 - (NSMutableDictionary<NSString *, UIView *> *)streamViewDic {
     if (!_streamViewDic) {
         _streamViewDic = [[NSMutableDictionary alloc] init];
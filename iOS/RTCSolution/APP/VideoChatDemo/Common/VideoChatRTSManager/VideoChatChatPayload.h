@@ -0,0 +1,34 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * @brief Text of a chat message as it travels in viSendMessage and viOnMessage, the same forms
+ * the Android client reads and writes (VideoChatChatPayload.java):
+ * plain UTF-8 text;
+ * text with a leading '~' when it starts with '~', or is made of URL-encoding characters only
+ * and contains '+' or '%';
+ * "~!" and base64 of a binary message with mentions, emoji or reactions;
+ * the URL-encoded text of earlier versions.
+ */
+@interface VideoChatChatPayload : NSObject
+
+/**
+ * @brief The message field to send for plain text.
+ */
++ (NSString *)wireFromText:(NSString *)text;
+
+/**
+ * @brief The text to show for a received message field. Never fails, a field that does not parse
+ * is shown as it came.
+ */
++ (NSString *)displayTextFromWire:(nullable NSString *)wire;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2023 BytePlus Pte. Ltd.
+// SPDX-License-Identifier: MIT
+//
+
+#import "VideoChatChatPayload.h"
+
+static const unichar VideoChatChatPayloadEscape = '~';
+static NSString *const VideoChatChatPayloadRichPrefix = @"~!";
+
+typedef NS_ENUM(uint8_t, VideoChatChatPayloadKind) {
+    VideoChatChatPayloadKindText = 1,
+    VideoChatChatPayloadKindMention = 2,
+    VideoChatChatPayloadKindEmoji = 3,
+    VideoChatChatPayloadKindReaction = 4,
+};
+
+@implementation VideoChatChatPayload
+
++ (NSString *)wireFromText:(NSString *)text {
+    BOOL escape = (text.length > 0 && [text characterAtIndex:0] == VideoChatChatPayloadEscape) ||
+                  [self isEncodedText:text];
+    return escape ? [NSString stringWithFormat:@"%C%@", VideoChatChatPayloadEscape, text] : text;
+}
+
++ (NSString *)displayTextFromWire:(nullable NSString *)wire {
+    if (wire.length == 0) {
+        return @"";
+    }
+    if ([wire hasPrefix:VideoChatChatPayloadRichPrefix]) {
+        NSData *data = [[NSData alloc] initWithBase64EncodedString:[wire substringFromIndex:VideoChatChatPayloadRichPrefix.length]
+                                                           options:0];
+        NSString *text = data ? [self displayTextFromData:data] : nil;
+        return text ?: wire;
+    }
+    if ([wire characterAtIndex:0] == VideoChatChatPayloadEscape) {
+        return [wire substringFromIndex:1];
+    }
+    if ([self isEncodedText:wire]) {
+        // Sent URL-encoded by earlier versions, '+' is a space there.
+        NSString *text = [[wire stringByReplacingOccurrencesOfString:@"+" withString:@" "] stringByRemovingPercentEncoding];
+        return text ?: wire;
+    }
+    return wire;
+}
+
+#pragma mark - Private Action
+
+// Only URL-encoding characters, with at least one '+' or '%'.
++ (BOOL)isEncodedText:(NSString *)text {
+    BOOL encoded = NO;
+    for (NSUInteger i = 0; i < text.length; i++) {
+        unichar c = [text characterAtIndex:i];
+        BOOL allowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                       c == '.' || c == '*' || c == '_' || c == '-' || c == '+' || c == '%';
+        if (!allowed) {
+            return NO;
+        }
+        encoded = encoded || c == '+' || c == '%';
+    }
+    return encoded;
+}
+
+// nil if the data is cut or not a chat payload. Unknown header bytes and segment kinds are skipped.
++ (nullable NSString *)displayTextFromData:(NSData *)data {
+    const uint8_t *bytes = data.bytes;
+    NSUInteger length = data.length;
+    if (length < 2 || bytes[0] == 0) {
+        return nil;
+    }
+    NSUInteger pos = 2 + bytes[1];
+    NSMutableString *text = [NSMutableString string];
+    while (pos < length) {
+        uint8_t kind = bytes[pos++];
+        NSUInteger segmentLength = 0;
+        for (int shift = 0;; shift += 7) {
+            if (pos >= length || shift > 21) {
+                return nil;
+            }
+            uint8_t b = bytes[pos++];
+            segmentLength |= (NSUInteger)(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                break;
+            }
+        }
+        if (segmentLength > length - pos) {
+            return nil;
+        }
+        NSUInteger valueStart = pos;
+        if (kind == VideoChatChatPayloadKindMention || kind == VideoChatChatPayloadKindReaction) {
+            // u8 id length and the id come first, only the name or reaction is shown.
+            NSUInteger idLength = segmentLength == 0 ? NSUIntegerMax : bytes[pos];
+            if (idLength == NSUIntegerMax || 1 + idLength > segmentLength) {
+                return nil;
+            }
+            valueStart = pos + 1 + idLength;
+        }
+        if (kind >= VideoChatChatPayloadKindText && kind <= VideoChatChatPayloadKindReaction) {
+            NSString *value = [[NSString alloc] initWithBytes:bytes + valueStart
+                                                       length:pos + segmentLength - valueStart
+                                                     encoding:NSUTF8StringEncoding];
+            if (kind == VideoChatChatPayloadKindMention) {
+                [text appendString:@"@"];
+            }
+            [text appendString:value ?: @""];
+        }
+        pos += segmentLength;
+    }
+    return text;
+}
+
+@end
@@ -5,6 +5,7 @@
 
 #import "VideoChatRTSManager.h"
 #import "JoinRTSParams.h"
+#import "VideoChatChatPayload.h"
 
 @implementation VideoChatRTSManager
 
@@ -446,7 +447,7 @@
             message:(NSString *)message
               block:(void (^)(RTSACKModel *model))block {
     NSDictionary *dic = @{@"room_id": roomID ?: @"",
-                          @"message": message ?: @""};
+                          @"message": [VideoChatChatPayload wireFromText:message ?: @""]};
     dic = [JoinRTSParams addTokenToParams:dic];
 
     [[VideoChatRTCManager shareRtc] emitWithAck:@"viSendMessage" with:dic block:^(RTSACKModel *_Nonnull ackModel) {
@@ -662,7 +663,7 @@
         if (noticeModel.data && [noticeModel.data isKindOfClass:[NSDictionary class]]) {
             model = [VideoChatUserModel yy_modelWithJSON:noticeModel.data[@"user_info"]];
             message = [NSString stringWithFormat:@"%@", noticeModel.data[@"message"]];
-            message = [message stringByReplacingPercentEscapesUsingEncoding:NSUTF8StringEncoding];
+            message = [VideoChatChatPayload displayTextFromWire:message];
         }
         if (block) {
             block(model, message);
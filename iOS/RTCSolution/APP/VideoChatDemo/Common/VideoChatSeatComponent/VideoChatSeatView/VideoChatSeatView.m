@@ -11,7 +11,7 @@ static const NSInteger MaxNumber = 6;
 @interface VideoChatSeatView ()
 
 @property (nonatomic, strong) NSMutableArray<VideoChatSeatItemView *> *itemViewLists;
-@property (nonatomic, strong) GCDTimer *timer;
+@property (nonatomic, strong) TickTask *volumeTask;
 @property (nonatomic, copy) NSDictionary *volumeDic;
 
 @end
@@ -23,9 +23,12 @@ static const NSInteger MaxNumber = 6;
     if (self) {
         [self addSubviewAndConstraints];
         __weak __typeof(self) wself = self;
-        [self.timer startTimerWithSpace:0.6 block:^(BOOL result) {
+        self.volumeTask = [[TickScheduler sharedScheduler] addPeriodicTaskWithInterval:0.6
+                                                                                 owner:self
+                                                                                 block:^{
             [wself timerMethod];
         }];
+        self.volumeTask.paused = YES;
     }
     return self;
 }
@@ -110,6 +113,16 @@ static const NSInteger MaxNumber = 6;
     }
 }
 
+- (void)didMoveToWindow {
+    [super didMoveToWindow];
+    // No volume refresh while off screen.
+    self.volumeTask.paused = (self.window == nil);
+}
+
+- (void)dealloc {
+    [_volumeTask cancel];
+}
+
 #pragma mark - Private Action
 
 - (void)timerMethod {
@@ -187,11 +200,4 @@ static const NSInteger MaxNumber = 6;
     return _itemViewLists;
 }
 
-- (GCDTimer *)timer {
-    if (!_timer) {
-        _timer = [[GCDTimer alloc] init];
-    }
-    return _timer;
-}
-
 @end